@@ -0,0 +1,807 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLLogic includes
+#include <vtkMRMLSliceLayerLogic.h>
+#include <vtkMRMLSliceLogic.h>
+
+// MRML includes
+#include <vtkMRMLColorTableNode.h>
+#include <vtkMRMLLinearTransformNode.h>
+#include <vtkMRMLModelDisplayNode.h>
+#include <vtkMRMLModelNode.h>
+#include <vtkMRMLModelStorageNode.h>
+#include <vtkMRMLScalarVolumeDisplayNode.h>
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLSliceCompositeNode.h>
+#include <vtkMRMLSliceNode.h>
+#include <vtkMRMLVolumeArchetypeStorageNode.h>
+
+// VTK includes
+#include <vtkAlgorithmOutput.h>
+#include <vtkCellArray.h>
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkMultiThreader.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSphereSource.h>
+#include <vtkTimerLog.h>
+#include <vtkVersion.h>
+
+// ITK includes
+#include <itkConfigure.h>
+#include <itkFactoryRegistration.h>
+
+// ITKSYS includes
+#include <itksys/Process.h>
+
+// VTKSYS includes
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <list>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+/// Timings of one benchmark, in seconds.
+struct BenchmarkResult
+{
+  std::string Name;
+  /// Size of the synthetic data, e.g. number of nodes
+  std::vector<std::pair<std::string, double> > Parameters;
+  std::vector<double> Times;
+  std::string Status;
+};
+
+//-----------------------------------------------------------------------------
+class BenchmarkReport
+{
+public:
+  BenchmarkResult& AddBenchmark(const std::string& name)
+    {
+    BenchmarkResult result;
+    result.Name = name;
+    result.Status = "passed";
+    this->Results.push_back(result);
+    std::cout << "Running " << name << std::endl;
+    return this->Results.back();
+    }
+
+  void Print()const
+    {
+    for (std::list<BenchmarkResult>::const_iterator it = this->Results.begin();
+         it != this->Results.end(); ++it)
+      {
+      double minTime, meanTime, maxTime;
+      Statistics(*it, minTime, meanTime, maxTime);
+      std::cout << it->Name << ": " << it->Status
+                << " - mean " << meanTime << "s, min " << minTime
+                << "s, max " << maxTime << "s (" << it->Times.size()
+                << " iterations)" << std::endl;
+      }
+    }
+
+  bool Write(const std::string& fileName, int scale)const
+    {
+    std::ofstream file(fileName.c_str());
+    if (!file.is_open())
+      {
+      return false;
+      }
+    file.precision(9);
+    file << "{\n"
+         << "  \"version\": 1,\n"
+         << "  \"vtk\": \"" << vtkVersion::GetVTKVersion() << "\",\n"
+         << "  \"itk\": \"" << ITK_VERSION_STRING << "\",\n"
+         << "  \"threads\": " << vtkMultiThreader::GetGlobalDefaultNumberOfThreads() << ",\n"
+         << "  \"scale\": " << scale << ",\n"
+         << "  \"unit\": \"s\",\n"
+         << "  \"benchmarks\": [";
+    for (std::list<BenchmarkResult>::const_iterator it = this->Results.begin();
+         it != this->Results.end(); ++it)
+      {
+      double minTime, meanTime, maxTime;
+      Statistics(*it, minTime, meanTime, maxTime);
+      file << (it == this->Results.begin() ? "\n" : ",\n")
+           << "    {\n"
+           << "      \"name\": \"" << it->Name << "\",\n"
+           << "      \"status\": \"" << it->Status << "\",\n"
+           << "      \"parameters\": {";
+      for (size_t i = 0; i < it->Parameters.size(); ++i)
+        {
+        file << (i ? ", " : "") << "\"" << it->Parameters[i].first << "\": "
+             << it->Parameters[i].second;
+        }
+      file << "},\n"
+           << "      \"iterations\": " << it->Times.size() << ",\n"
+           << "      \"min\": " << minTime << ",\n"
+           << "      \"mean\": " << meanTime << ",\n"
+           << "      \"max\": " << maxTime << ",\n"
+           << "      \"times\": [";
+      for (size_t i = 0; i < it->Times.size(); ++i)
+        {
+        file << (i ? ", " : "") << it->Times[i];
+        }
+      file << "]\n"
+           << "    }";
+      }
+    file << "\n  ]\n"
+         << "}\n";
+    return file.good();
+    }
+
+protected:
+  static void Statistics(const BenchmarkResult& result,
+                         double& minTime, double& meanTime, double& maxTime)
+    {
+    minTime = meanTime = maxTime = 0.;
+    if (result.Times.empty())
+      {
+      return;
+      }
+    minTime = *std::min_element(result.Times.begin(), result.Times.end());
+    maxTime = *std::max_element(result.Times.begin(), result.Times.end());
+    for (size_t i = 0; i < result.Times.size(); ++i)
+      {
+      meanTime += result.Times[i];
+      }
+    meanTime /= result.Times.size();
+    }
+
+  /// std::list so that the results returned by AddBenchmark() stay valid
+  std::list<BenchmarkResult> Results;
+};
+
+//-----------------------------------------------------------------------------
+bool Failed(BenchmarkResult& result, int line, const std::string& message)
+{
+  std::cerr << "Line " << line << " - " << result.Name << ": " << message << std::endl;
+  result.Status = "failed";
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+/// Smooth blobs with some noise, like an MR head.
+vtkImageData* CreateVolume(int dimension, int seed)
+{
+  vtkImageData* imageData = vtkImageData::New();
+  imageData->SetDimensions(dimension, dimension, dimension);
+#if (VTK_MAJOR_VERSION <= 5)
+  imageData->SetScalarTypeToShort();
+  imageData->SetNumberOfScalarComponents(1);
+  imageData->AllocateScalars();
+#else
+  imageData->AllocateScalars(VTK_SHORT, 1);
+#endif
+  short* scalars = static_cast<short*>(imageData->GetScalarPointer());
+  const double center = dimension / 2.;
+  unsigned int random = static_cast<unsigned int>(seed);
+  for (int k = 0; k < dimension; ++k)
+    {
+    for (int j = 0; j < dimension; ++j)
+      {
+      for (int i = 0; i < dimension; ++i)
+        {
+        const double r = sqrt((i - center) * (i - center) +
+                              (j - center) * (j - center) +
+                              (k - center) * (k - center)) / center;
+        random = random * 1103515245u + 12345u;
+        *scalars++ = static_cast<short>(
+          (r < 1. ? 1000. * (1. - r * r) : 0.) + ((random >> 16) % 64));
+        }
+      }
+    }
+  return imageData;
+}
+
+//-----------------------------------------------------------------------------
+/// Concentric shells of labels 1 to numberOfLabels.
+vtkImageData* CreateLabelMap(int dimension, int numberOfLabels)
+{
+  vtkImageData* imageData = vtkImageData::New();
+  imageData->SetDimensions(dimension, dimension, dimension);
+#if (VTK_MAJOR_VERSION <= 5)
+  imageData->SetScalarTypeToUnsignedChar();
+  imageData->SetNumberOfScalarComponents(1);
+  imageData->AllocateScalars();
+#else
+  imageData->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+#endif
+  unsigned char* scalars = static_cast<unsigned char*>(imageData->GetScalarPointer());
+  const double center = dimension / 2.;
+  for (int k = 0; k < dimension; ++k)
+    {
+    for (int j = 0; j < dimension; ++j)
+      {
+      for (int i = 0; i < dimension; ++i)
+        {
+        const double r = sqrt((i - center) * (i - center) +
+                              (j - center) * (j - center) +
+                              (k - center) * (k - center)) / (0.8 * center);
+        *scalars++ = static_cast<unsigned char>(
+          r < 1. ? numberOfLabels - static_cast<int>(r * numberOfLabels) : 0);
+        }
+      }
+    }
+  return imageData;
+}
+
+//-----------------------------------------------------------------------------
+/// Bundle of helical polylines, like a tractography result.
+vtkPolyData* CreateFiberBundle(int numberOfFibers, int numberOfPointsPerFiber, int seed)
+{
+  vtkNew<vtkPoints> points;
+  points->SetNumberOfPoints(numberOfFibers * numberOfPointsPerFiber);
+  vtkNew<vtkCellArray> lines;
+  lines->Allocate(lines->EstimateSize(numberOfFibers, numberOfPointsPerFiber));
+  vtkIdType pointId = 0;
+  for (int fiber = 0; fiber < numberOfFibers; ++fiber)
+    {
+    const double phase = 0.1 * (fiber + seed);
+    const double radius = 5. + (fiber % 17);
+    lines->InsertNextCell(numberOfPointsPerFiber);
+    for (int p = 0; p < numberOfPointsPerFiber; ++p, ++pointId)
+      {
+      const double t = 0.05 * p;
+      points->SetPoint(pointId, radius * cos(t + phase), radius * sin(t + phase),
+                       p - numberOfPointsPerFiber / 2.);
+      lines->InsertCellPoint(pointId);
+      }
+    }
+  vtkPolyData* polyData = vtkPolyData::New();
+  polyData->SetPoints(points.GetPointer());
+  polyData->SetLines(lines.GetPointer());
+  return polyData;
+}
+
+//-----------------------------------------------------------------------------
+vtkMRMLScalarVolumeNode* AddVolume(vtkMRMLScene* scene, vtkImageData* imageData,
+                                   const char* name, const char* colorNodeID = 0)
+{
+  vtkNew<vtkMRMLScalarVolumeDisplayNode> displayNode;
+  displayNode->SetAutoWindowLevel(false);
+  displayNode->SetWindowLevel(1000., 500.);
+  displayNode->SetAndObserveColorNodeID(colorNodeID);
+  scene->AddNode(displayNode.GetPointer());
+
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  volumeNode->SetName(name);
+  volumeNode->SetAndObserveImageData(imageData);
+  volumeNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+  scene->AddNode(volumeNode.GetPointer());
+  return volumeNode.GetPointer();
+}
+
+//-----------------------------------------------------------------------------
+vtkMRMLModelNode* AddModel(vtkMRMLScene* scene, vtkPolyData* polyData,
+                           const std::string& fileName)
+{
+  vtkNew<vtkMRMLModelStorageNode> storageNode;
+  storageNode->SetFileName(fileName.c_str());
+  scene->AddNode(storageNode.GetPointer());
+  vtkNew<vtkMRMLModelDisplayNode> displayNode;
+  scene->AddNode(displayNode.GetPointer());
+
+  vtkNew<vtkMRMLModelNode> modelNode;
+  modelNode->SetName(vtksys::SystemTools::GetFilenameWithoutExtension(fileName).c_str());
+  modelNode->SetAndObservePolyData(polyData);
+  modelNode->SetAndObserveStorageNodeID(storageNode->GetID());
+  modelNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+  scene->AddNode(modelNode.GetPointer());
+  return modelNode.GetPointer();
+}
+
+//-----------------------------------------------------------------------------
+/// Scene with many transforms, surface models and fiber bundles, the data
+/// of the models being saved in \a dataDir.
+bool CreateLargeScene(vtkMRMLScene* scene, const std::string& dataDir, int scale,
+                      BenchmarkResult& result)
+{
+  const int numberOfTransforms = 200 * scale;
+  const int numberOfModels = 100 * scale;
+  const int numberOfFiberBundles = 5 * scale;
+  result.Parameters.push_back(std::make_pair(std::string("transforms"), double(numberOfTransforms)));
+  result.Parameters.push_back(std::make_pair(std::string("models"), double(numberOfModels)));
+  result.Parameters.push_back(std::make_pair(std::string("fiberBundles"), double(numberOfFiberBundles)));
+
+  vtkNew<vtkMatrix4x4> matrix;
+  vtkMRMLTransformNode* parentTransform = 0;
+  for (int i = 0; i < numberOfTransforms; ++i)
+    {
+    vtkNew<vtkMRMLLinearTransformNode> transformNode;
+    matrix->SetElement(0, 3, i);
+    transformNode->SetMatrixTransformToParent(matrix.GetPointer());
+    scene->AddNode(transformNode.GetPointer());
+    // chains of 10 transforms
+    if (parentTransform && i % 10)
+      {
+      transformNode->SetAndObserveTransformNodeID(parentTransform->GetID());
+      }
+    parentTransform = transformNode.GetPointer();
+    }
+
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(32);
+  sphere->SetPhiResolution(32);
+  sphere->Update();
+  std::vector<vtkMRMLNode*> transforms;
+  scene->GetNodesByClass("vtkMRMLLinearTransformNode", transforms);
+  for (int i = 0; i < numberOfModels; ++i)
+    {
+    std::stringstream fileName;
+    fileName << dataDir << "/Model" << i << ".vtk";
+    vtkMRMLModelNode* modelNode =
+      AddModel(scene, sphere->GetOutput(), fileName.str());
+    modelNode->SetAndObserveTransformNodeID(transforms[i % transforms.size()]->GetID());
+    }
+  for (int i = 0; i < numberOfFiberBundles; ++i)
+    {
+    vtkPolyData* fibers = CreateFiberBundle(2000, 100, i);
+    std::stringstream fileName;
+    fileName << dataDir << "/FiberBundle" << i << ".vtp";
+    AddModel(scene, fibers, fileName.str());
+    fibers->Delete();
+    }
+
+  std::vector<vtkMRMLNode*> models;
+  scene->GetNodesByClass("vtkMRMLModelNode", models);
+  for (size_t i = 0; i < models.size(); ++i)
+    {
+    vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(models[i]);
+    vtkMRMLStorageNode* storageNode = modelNode->GetStorageNode();
+    if (!storageNode->WriteData(modelNode))
+      {
+      return Failed(result, __LINE__, std::string("Failed to write ") +
+                    storageNode->GetFileName());
+      }
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool BenchmarkScene(const std::string& tempDir, int scale, int iterations,
+                    BenchmarkReport& report)
+{
+  std::string dataDir = tempDir + "/Scene";
+  vtksys::SystemTools::RemoveADirectory(dataDir.c_str());
+  vtksys::SystemTools::MakeDirectory(dataDir.c_str());
+  std::string sceneFile = dataDir + "/LargeScene.mrml";
+
+  vtkNew<vtkTimerLog> timer;
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetRootDirectory(dataDir.c_str());
+
+  BenchmarkResult& create = report.AddBenchmark("Scene.CreateAndWriteData");
+  timer->StartTimer();
+  if (!CreateLargeScene(scene.GetPointer(), dataDir, scale, create))
+    {
+    return false;
+    }
+  timer->StopTimer();
+  create.Times.push_back(timer->GetElapsedTime());
+  const int numberOfNodes = scene->GetNumberOfNodes();
+  const int numberOfModels = scene->GetNumberOfNodesByClass("vtkMRMLModelNode");
+  create.Parameters.push_back(std::make_pair(std::string("nodes"), double(numberOfNodes)));
+
+  BenchmarkResult& commit = report.AddBenchmark("Scene.Commit");
+  commit.Parameters.push_back(std::make_pair(std::string("nodes"), double(numberOfNodes)));
+  for (int i = 0; i < iterations; ++i)
+    {
+    timer->StartTimer();
+    if (!scene->Commit(sceneFile.c_str()))
+      {
+      return Failed(commit, __LINE__, "Failed to write " + sceneFile);
+      }
+    timer->StopTimer();
+    commit.Times.push_back(timer->GetElapsedTime());
+    }
+
+  BenchmarkResult& import = report.AddBenchmark("Scene.Import");
+  import.Parameters.push_back(std::make_pair(std::string("nodes"), double(numberOfNodes)));
+  for (int i = 0; i < iterations; ++i)
+    {
+    vtkNew<vtkMRMLScene> importedScene;
+    importedScene->SetURL(sceneFile.c_str());
+    timer->StartTimer();
+    importedScene->Import();
+    timer->StopTimer();
+    import.Times.push_back(timer->GetElapsedTime());
+    if (importedScene->GetNumberOfNodesByClass("vtkMRMLModelNode") != numberOfModels)
+      {
+      std::stringstream message;
+      message << importedScene->GetNumberOfNodesByClass("vtkMRMLModelNode")
+              << " models imported instead of " << numberOfModels;
+      return Failed(import, __LINE__, message.str());
+      }
+    }
+
+  BenchmarkResult& connect = report.AddBenchmark("Scene.Connect");
+  connect.Parameters.push_back(std::make_pair(std::string("nodes"), double(numberOfNodes)));
+  vtkNew<vtkMRMLScene> connectedScene;
+  connectedScene->SetURL(sceneFile.c_str());
+  for (int i = 0; i < iterations; ++i)
+    {
+    timer->StartTimer();
+    connectedScene->Connect();
+    timer->StopTimer();
+    connect.Times.push_back(timer->GetElapsedTime());
+    }
+
+  // Lookups in a pseudo random order
+  std::vector<std::string> ids;
+  for (int n = 0; n < numberOfNodes; ++n)
+    {
+    ids.push_back(scene->GetNthNode(n)->GetID());
+    }
+  const int numberOfLookups = 100000;
+  BenchmarkResult& getNodeByID = report.AddBenchmark("Scene.GetNodeByID");
+  getNodeByID.Parameters.push_back(std::make_pair(std::string("nodes"), double(numberOfNodes)));
+  getNodeByID.Parameters.push_back(std::make_pair(std::string("lookups"), double(numberOfLookups)));
+  for (int i = 0; i < iterations; ++i)
+    {
+    unsigned int random = static_cast<unsigned int>(i);
+    int found = 0;
+    timer->StartTimer();
+    for (int l = 0; l < numberOfLookups; ++l)
+      {
+      random = random * 1103515245u + 12345u;
+      found += scene->GetNodeByID(ids[(random >> 8) % ids.size()].c_str()) != 0;
+      }
+    timer->StopTimer();
+    getNodeByID.Times.push_back(timer->GetElapsedTime());
+    if (found != numberOfLookups)
+      {
+      return Failed(getNodeByID, __LINE__, "Node not found");
+      }
+    }
+
+  const char* classNames[] = {"vtkMRMLModelNode", "vtkMRMLLinearTransformNode",
+                              "vtkMRMLDisplayNode", "vtkMRMLStorageNode",
+                              "vtkMRMLVolumeNode"};
+  const int numberOfClassNames = sizeof(classNames) / sizeof(const char*);
+  const int numberOfClassLookups = 100;
+  BenchmarkResult& getNodesByClass = report.AddBenchmark("Scene.GetNodesByClass");
+  getNodesByClass.Parameters.push_back(std::make_pair(std::string("nodes"), double(numberOfNodes)));
+  getNodesByClass.Parameters.push_back(std::make_pair(std::string("lookups"),
+    double(numberOfClassLookups * numberOfClassNames)));
+  for (int i = 0; i < iterations; ++i)
+    {
+    timer->StartTimer();
+    for (int l = 0; l < numberOfClassLookups; ++l)
+      {
+      for (int c = 0; c < numberOfClassNames; ++c)
+        {
+        std::vector<vtkMRMLNode*> nodes;
+        scene->GetNodesByClass(classNames[c], nodes);
+        }
+      }
+    timer->StopTimer();
+    getNodesByClass.Times.push_back(timer->GetElapsedTime());
+    }
+
+  vtksys::SystemTools::RemoveADirectory(dataDir.c_str());
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void UpdateSlice(vtkMRMLSliceLogic* sliceLogic)
+{
+#if (VTK_MAJOR_VERSION <= 5)
+  vtkImageData* imageData = sliceLogic->GetImageData();
+  if (imageData)
+    {
+    imageData->Update();
+    }
+#else
+  vtkAlgorithmOutput* imageDataConnection = sliceLogic->GetImageDataConnection();
+  if (imageDataConnection && imageDataConnection->GetProducer())
+    {
+    imageDataConnection->GetProducer()->Update();
+    }
+#endif
+}
+
+//-----------------------------------------------------------------------------
+bool BenchmarkSliceLogic(int scale, int iterations, BenchmarkReport& report)
+{
+  const int dimension = 128 * scale;
+  const int viewSize = 512;
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLColorTableNode> colorNode;
+  colorNode->SetTypeToGrey();
+  scene->AddNode(colorNode.GetPointer());
+
+  vtkImageData* background = CreateVolume(dimension, 1);
+  vtkMRMLScalarVolumeNode* backgroundNode =
+    AddVolume(scene.GetPointer(), background, "Background", colorNode->GetID());
+  background->Delete();
+  vtkImageData* foreground = CreateVolume(dimension, 2);
+  vtkMRMLScalarVolumeNode* foregroundNode =
+    AddVolume(scene.GetPointer(), foreground, "Foreground", colorNode->GetID());
+  foreground->Delete();
+
+  vtkNew<vtkMRMLSliceLogic> sliceLogic;
+  sliceLogic->SetName("Red");
+  sliceLogic->SetMRMLScene(scene.GetPointer());
+  sliceLogic->ResizeSliceNode(viewSize, viewSize);
+  sliceLogic->GetSliceNode()->SetSliceResolutionMode(
+    vtkMRMLSliceNode::SliceResolutionMatch2DView);
+  vtkNew<vtkMRMLSliceLayerLogic> backgroundLayer;
+  sliceLogic->SetBackgroundLayer(backgroundLayer.GetPointer());
+  vtkNew<vtkMRMLSliceLayerLogic> foregroundLayer;
+  sliceLogic->SetForegroundLayer(foregroundLayer.GetPointer());
+
+  vtkMRMLSliceCompositeNode* compositeNode = sliceLogic->GetSliceCompositeNode();
+  compositeNode->SetBackgroundVolumeID(backgroundNode->GetID());
+  sliceLogic->FitSliceToAll(viewSize, viewSize);
+  double sliceBounds[6];
+  sliceLogic->GetLowestVolumeSliceBounds(sliceBounds);
+
+  vtkNew<vtkTimerLog> timer;
+  for (int blend = 0; blend < 2; ++blend)
+    {
+    BenchmarkResult& result = report.AddBenchmark(
+      blend ? "SliceLogic.ResliceBlend" : "SliceLogic.Reslice");
+    result.Parameters.push_back(std::make_pair(std::string("dimension"), double(dimension)));
+    result.Parameters.push_back(std::make_pair(std::string("viewSize"), double(viewSize)));
+    result.Parameters.push_back(std::make_pair(std::string("slices"), double(dimension)));
+    if (blend)
+      {
+      compositeNode->SetForegroundVolumeID(foregroundNode->GetID());
+      compositeNode->SetForegroundOpacity(0.5);
+      }
+    for (int i = 0; i < iterations; ++i)
+      {
+      timer->StartTimer();
+      // Scroll through the volume
+      for (int slice = 0; slice < dimension; ++slice)
+        {
+        sliceLogic->SetSliceOffset(sliceBounds[4] +
+          (sliceBounds[5] - sliceBounds[4]) * slice / dimension);
+        UpdateSlice(sliceLogic.GetPointer());
+        }
+      timer->StopTimer();
+      result.Times.push_back(timer->GetElapsedTime());
+      }
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool BenchmarkNRRD(const std::string& tempDir, int scale, int iterations,
+                   BenchmarkReport& report)
+{
+  const int dimension = 128 * scale;
+  std::string fileName = tempDir + "/Volume.nrrd";
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkImageData* imageData = CreateVolume(dimension, 3);
+  vtkMRMLScalarVolumeNode* volumeNode =
+    AddVolume(scene.GetPointer(), imageData, "Volume");
+  imageData->Delete();
+
+  vtkNew<vtkTimerLog> timer;
+  for (int compression = 0; compression < 2; ++compression)
+    {
+    BenchmarkResult& write = report.AddBenchmark(
+      compression ? "NRRD.WriteCompressed" : "NRRD.Write");
+    write.Parameters.push_back(std::make_pair(std::string("dimension"), double(dimension)));
+    BenchmarkResult& read = report.AddBenchmark(
+      compression ? "NRRD.ReadCompressed" : "NRRD.Read");
+    read.Parameters.push_back(std::make_pair(std::string("dimension"), double(dimension)));
+    for (int i = 0; i < iterations; ++i)
+      {
+      vtkNew<vtkMRMLVolumeArchetypeStorageNode> writer;
+      writer->SetFileName(fileName.c_str());
+      writer->SetUseCompression(compression);
+      timer->StartTimer();
+      if (!writer->WriteData(volumeNode))
+        {
+        return Failed(write, __LINE__, "Failed to write " + fileName);
+        }
+      timer->StopTimer();
+      write.Times.push_back(timer->GetElapsedTime());
+
+      vtkNew<vtkMRMLScalarVolumeNode> readVolumeNode;
+      vtkNew<vtkMRMLVolumeArchetypeStorageNode> reader;
+      reader->SetFileName(fileName.c_str());
+      timer->StartTimer();
+      if (!reader->ReadData(readVolumeNode.GetPointer()) ||
+          !readVolumeNode->GetImageData())
+        {
+        return Failed(read, __LINE__, "Failed to read " + fileName);
+        }
+      timer->StopTimer();
+      read.Times.push_back(timer->GetElapsedTime());
+      }
+    }
+  vtksys::SystemTools::RemoveFile(fileName.c_str());
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool RunProcess(const std::vector<std::string>& arguments, const std::string& logFile)
+{
+  std::vector<const char*> command;
+  for (size_t i = 0; i < arguments.size(); ++i)
+    {
+    command.push_back(arguments[i].c_str());
+    }
+  command.push_back(0);
+
+  itksysProcess* process = itksysProcess_New();
+  itksysProcess_SetCommand(process, &command[0]);
+  itksysProcess_SetOption(process, itksysProcess_Option_HideWindow, 1);
+  // don't let full pipes block the process
+  itksysProcess_SetPipeFile(process, itksysProcess_Pipe_STDOUT, logFile.c_str());
+  itksysProcess_SetPipeFile(process, itksysProcess_Pipe_STDERR, logFile.c_str());
+  itksysProcess_Execute(process);
+  itksysProcess_WaitForExit(process, 0);
+  bool success = itksysProcess_GetState(process) == itksysProcess_State_Exited &&
+                 itksysProcess_GetExitValue(process) == 0;
+  itksysProcess_Delete(process);
+  return success;
+}
+
+//-----------------------------------------------------------------------------
+/// Write a label map, run the ModelMaker CLI on it and load the models back.
+bool BenchmarkModelMaker(const std::string& tempDir, const std::string& modelMaker,
+                         int scale, int iterations, BenchmarkReport& report)
+{
+  const int dimension = 64 * scale;
+  const int numberOfLabels = 3;
+  std::string dataDir = tempDir + "/ModelMaker";
+
+  BenchmarkResult& run = report.AddBenchmark("CLI.ModelMaker");
+  run.Parameters.push_back(std::make_pair(std::string("dimension"), double(dimension)));
+  run.Parameters.push_back(std::make_pair(std::string("labels"), double(numberOfLabels)));
+  BenchmarkResult& roundTrip = report.AddBenchmark("CLI.ModelMakerRoundTrip");
+  roundTrip.Parameters.push_back(std::make_pair(std::string("dimension"), double(dimension)));
+  roundTrip.Parameters.push_back(std::make_pair(std::string("labels"), double(numberOfLabels)));
+  if (modelMaker.empty())
+    {
+    run.Status = roundTrip.Status = "skipped";
+    return true;
+    }
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkImageData* labelMap = CreateLabelMap(dimension, numberOfLabels);
+  vtkMRMLScalarVolumeNode* labelMapNode =
+    AddVolume(scene.GetPointer(), labelMap, "LabelMap");
+  labelMap->Delete();
+
+  vtkNew<vtkTimerLog> runTimer;
+  vtkNew<vtkTimerLog> roundTripTimer;
+  for (int i = 0; i < iterations; ++i)
+    {
+    vtksys::SystemTools::RemoveADirectory(dataDir.c_str());
+    vtksys::SystemTools::MakeDirectory(dataDir.c_str());
+    std::string labelMapFile = dataDir + "/LabelMap.nrrd";
+    std::string sceneFile = dataDir + "/Models.mrml";
+
+    roundTripTimer->StartTimer();
+    // inputs, like the CLI module logic does before running a CLI
+    vtkNew<vtkMRMLVolumeArchetypeStorageNode> writer;
+    writer->SetFileName(labelMapFile.c_str());
+    writer->SetUseCompression(0);
+    if (!writer->WriteData(labelMapNode))
+      {
+      return Failed(roundTrip, __LINE__, "Failed to write " + labelMapFile);
+      }
+
+    std::vector<std::string> arguments;
+    arguments.push_back(modelMaker);
+    arguments.push_back("--generateAll");
+    arguments.push_back("--modelSceneFile");
+    arguments.push_back(sceneFile + "#vtkMRMLModelHierarchyNode1");
+    arguments.push_back(labelMapFile);
+    runTimer->StartTimer();
+    if (!RunProcess(arguments, dataDir + "/ModelMaker.log"))
+      {
+      return Failed(run, __LINE__, "Failed to run " + modelMaker + ", see " +
+                    dataDir + "/ModelMaker.log");
+      }
+    runTimer->StopTimer();
+
+    // outputs
+    vtkNew<vtkMRMLScene> modelScene;
+    modelScene->SetURL(sceneFile.c_str());
+    modelScene->Import();
+    roundTripTimer->StopTimer();
+    if (modelScene->GetNumberOfNodesByClass("vtkMRMLModelNode") != numberOfLabels)
+      {
+      std::stringstream message;
+      message << modelScene->GetNumberOfNodesByClass("vtkMRMLModelNode")
+              << " models loaded instead of " << numberOfLabels;
+      return Failed(roundTrip, __LINE__, message.str());
+      }
+    run.Times.push_back(runTimer->GetElapsedTime());
+    roundTrip.Times.push_back(roundTripTimer->GetElapsedTime());
+    }
+  vtksys::SystemTools::RemoveADirectory(dataDir.c_str());
+  return true;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+/// Benchmarks of the core operations on synthetic data, no network access
+/// or input file is needed. The timings are written in a JSON report to
+/// track regressions between builds.
+int vtkSlicerBenchmarks(int argc, char * argv [])
+{
+  itk::itkFactoryRegistration();
+
+  if (argc < 3)
+    {
+    std::cerr << "Missing parameters !\n"
+              << "Usage: " << argv[0] << " /path/to/temp /path/to/report.json"
+              << " [--scale N] [--iterations N] [--modelmaker /path/to/ModelMaker]"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::string tempDir = std::string(argv[1]) + "/vtkSlicerBenchmarks";
+  std::string reportFile = argv[2];
+  int scale = 1;
+  int iterations = 3;
+  std::string modelMaker;
+  for (int i = 3; i + 1 < argc; i += 2)
+    {
+    std::string option = argv[i];
+    if (option == "--scale")
+      {
+      scale = std::max(1, atoi(argv[i + 1]));
+      }
+    else if (option == "--iterations")
+      {
+      iterations = std::max(1, atoi(argv[i + 1]));
+      }
+    else if (option == "--modelmaker")
+      {
+      modelMaker = argv[i + 1];
+      }
+    else
+      {
+      std::cerr << "Unknown option: " << option << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  vtksys::SystemTools::RemoveADirectory(tempDir.c_str());
+  vtksys::SystemTools::MakeDirectory(tempDir.c_str());
+
+  BenchmarkReport report;
+  bool success = BenchmarkScene(tempDir, scale, iterations, report);
+  success = BenchmarkSliceLogic(scale, iterations, report) && success;
+  success = BenchmarkNRRD(tempDir, scale, iterations, report) && success;
+  success = BenchmarkModelMaker(tempDir, modelMaker, scale, iterations, report) && success;
+  vtksys::SystemTools::RemoveADirectory(tempDir.c_str());
+
+  report.Print();
+  if (!report.Write(reportFile, scale))
+    {
+    std::cerr << "Failed to write the report " << reportFile << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Report written in " << reportFile << std::endl;
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
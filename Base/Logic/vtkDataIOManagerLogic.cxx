@@ -315,7 +315,9 @@ int vtkDataIOManagerLogic::QueueRead ( vtkMRMLNode *node )
   //--- Again, test for space to download the file.
   //--- This test has been done in MRML (DataIOManager), but with asynchIO,
   //--- Cache may have become full since the remote read was queued.
+  //--- The least recently used files are evicted first to make room.
   //---
+  cm->EvictLeastRecentlyUsedFiles();
   float bufsize = (cm->GetRemoteCacheLimit() * 1000000.0) -  (cm->GetRemoteCacheFreeBufferSize() * 1000000.0);
   if ( (cm->GetCurrentCacheSize()*1000000.0) >= bufsize )
     {
@@ -667,6 +669,18 @@ int vtkDataIOManagerLogic::QueueWrite ( vtkMRMLNode *node )
 
 
 
+//----------------------------------------------------------------------------
+std::string vtkDataIOManagerLogic::AddDownloadToCache( const char *source, const char *dest )
+{
+  vtkCacheManager *cm = this->GetDataIOManager() ?
+    this->GetDataIOManager()->GetCacheManager() : NULL;
+  if ( cm == NULL )
+    {
+    return std::string(dest);
+    }
+  return cm->AddToCache( dest, source );
+}
+
 //----------------------------------------------------------------------------
 void vtkDataIOManagerLogic::ApplyTransfer( void *clientdata )
 {
@@ -717,6 +731,8 @@ void vtkDataIOManagerLogic::ApplyTransfer( void *clientdata )
         dt->SetTransferStatusNoModify ( vtkDataTransfer::Running );
         this->GetApplicationLogic()->RequestModified( dt );
         handler->StageFileRead( source, dest);
+        // the same content may already be cached under another name
+        std::string cachedFile = this->AddDownloadToCache( source, dest );
         dt->SetTransferStatusNoModify ( vtkDataTransfer::Completed );
         this->GetApplicationLogic()->RequestModified( dt );
 
@@ -749,16 +765,32 @@ void vtkDataIOManagerLogic::ApplyTransfer( void *clientdata )
           return;
           }
         storageNode->SetDisableModifiedEvent( 1 );
+        if ( cachedFile != dest )
+          {
+          storageNode->SetFileName( cachedFile.c_str() );
+          }
         // let the storage node know that the remote transfer is done
         vtkDebugMacro("ApplyTransfer: setting storage node read state to transfer done for uri " << storageNode->GetURI());
         storageNode->SetReadStateTransferDone();
         storageNode->SetDisableModifiedEvent( 0 );
-        this->GetApplicationLogic()->RequestReadData( node->GetID(), dest, 0, 0 );
+        this->GetApplicationLogic()->RequestReadData( node->GetID(), cachedFile.c_str(), 0, 0 );
         }
       else
         {
         vtkDebugMacro("ApplyTransfer: stage file read on the handler..., source = " << source << ", dest = " << dest);
         handler->StageFileRead( source, dest);
+        std::string cachedFile = this->AddDownloadToCache( source, dest );
+        vtkMRMLStorableNode *storableNode = vtkMRMLStorableNode::SafeDownCast( node );
+        for (int i = 0; storableNode && cachedFile != dest &&
+               i < storableNode->GetNumberOfStorageNodes(); i++)
+          {
+          vtkMRMLStorageNode *storageNode = storableNode->GetNthStorageNode(i);
+          if (storageNode && storageNode->GetFileName() &&
+              strcmp(storageNode->GetFileName(), dest) == 0)
+            {
+            storageNode->SetFileName( cachedFile.c_str() );
+            }
+          }
         }
       }
     }
@@ -70,6 +70,10 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkDataIOManagerLogic : public vtkSlicerModul
   vtkObserverManager* DataIOObserverManager;
   static void DataIOManagerCallback(vtkObject *caller, unsigned long eid, void *clientData, void *callData);
   virtual void ProcessDataIOManagerEvents( vtkObject *caller, unsigned long event, void *calldata );
+
+  /// Record a downloaded file in the cache index and return the file to
+  /// read: an identical file already in cache replaces the downloaded one.
+  std::string AddDownloadToCache( const char *source, const char *dest );
 };
 
 #endif
@@ -291,7 +291,8 @@ def saveScene(filename, properties={}):
   as a MRML file, MRB file or directory.
 
   If filename ends with '.mrml', the scene is saved as a single file
-  without associated data.
+  without associated data. If it ends with '.mrmlb', the single file is a
+  binary scene.
 
   If filename ends with '.mrb', the scene is saved as a MRML bundle (Zip
   archive with scene and data files).
@@ -0,0 +1,285 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+// Slicer includes
+#include "qSlicerCoreApplication.h"
+#include "qSlicerCoreIOManager.h"
+#include "qSlicerFileWriter.h"
+
+// MRML includes
+#include <vtkMRMLModelNode.h>
+#include <vtkMRMLModelStorageNode.h>
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+
+// STD includes
+#include <iostream>
+
+// ----------------------------------------------------------------------------
+/// Writer of "*.test" files that fails to write the files named "fail.test".
+/// Nothing is written on disk.
+class qSlicerCoreIOManagerSaveNodesTestWriter : public qSlicerFileWriter
+{
+public:
+  qSlicerCoreIOManagerSaveNodesTestWriter(QObject* parent = 0)
+    : qSlicerFileWriter(parent)
+  {
+  }
+  virtual QString description()const
+  {
+    return "Test";
+  }
+  virtual IOFileType fileType()const
+  {
+    return QString("TestFile");
+  }
+  virtual QStringList extensions(vtkObject* object)const
+  {
+    Q_UNUSED(object);
+    return QStringList() << "Test (*.test)";
+  }
+  virtual bool write(const qSlicerIO::IOProperties& properties)
+  {
+    QString fileName = properties["fileName"].toString();
+    this->WrittenFiles << QFileInfo(fileName).fileName();
+    if (fileName.endsWith("fail.test"))
+      {
+      return false;
+      }
+    this->setWrittenNodes(QStringList() << properties["nodeID"].toString());
+    return true;
+  }
+  QStringList WrittenFiles;
+};
+
+// ----------------------------------------------------------------------------
+/// Stop saving after the first failure, like the save data dialog does when
+/// the user chooses not to continue.
+class qSlicerCoreIOManagerSaveNodesTester : public QObject
+{
+  Q_OBJECT
+public:
+  qSlicerCoreIOManagerSaveNodesTester(qSlicerCoreIOManager* manager)
+    : Manager(manager)
+    , CancelOnFailure(false)
+  {
+  }
+  qSlicerCoreIOManager* Manager;
+  bool CancelOnFailure;
+  QList<int> SavedFiles;
+  QList<int> FailedFiles;
+
+public slots:
+  void onFileSaved(int fileIndex, bool saved)
+  {
+    (saved ? this->SavedFiles : this->FailedFiles) << fileIndex;
+    if (!saved && this->CancelOnFailure)
+      {
+      this->Manager->cancelSaving();
+      }
+  }
+};
+
+namespace
+{
+
+// ----------------------------------------------------------------------------
+vtkMRMLModelNode* addModel(vtkMRMLScene* scene)
+{
+  vtkNew<vtkPoints> points;
+  points->InsertNextPoint(0., 0., 0.);
+  points->InsertNextPoint(1., 0., 0.);
+  points->InsertNextPoint(0., 1., 0.);
+  vtkNew<vtkCellArray> polys;
+  vtkIdType triangle[3] = {0, 1, 2};
+  polys->InsertNextCell(3, triangle);
+  vtkNew<vtkPolyData> polyData;
+  polyData->SetPoints(points.GetPointer());
+  polyData->SetPolys(polys.GetPointer());
+
+  vtkNew<vtkMRMLModelNode> modelNode;
+  modelNode->SetAndObservePolyData(polyData.GetPointer());
+  scene->AddNode(modelNode.GetPointer());
+  return modelNode.GetPointer();
+}
+
+// ----------------------------------------------------------------------------
+qSlicerIO::IOProperties testFile(vtkMRMLNode* node, const QString& fileName)
+{
+  qSlicerIO::IOProperties properties;
+  properties["nodeID"] = QString(node->GetID());
+  properties["fileName"] = QDir::temp().filePath(fileName);
+  properties["fileType"] = QString("TestFile");
+  return properties;
+}
+
+// ----------------------------------------------------------------------------
+bool testIsFileUpToDate(vtkMRMLScene* scene)
+{
+  vtkMRMLModelNode* modelNode = addModel(scene);
+  vtkNew<vtkMRMLModelStorageNode> storageNode;
+  scene->AddNode(storageNode.GetPointer());
+  modelNode->SetAndObserveStorageNodeID(storageNode->GetID());
+
+  QString fileName = QDir::temp().filePath("qSlicerCoreIOManagerSaveNodesTest.vtk");
+  storageNode->SetFileName(fileName.toLatin1());
+  storageNode->SetWriteFileFormat("vtk");
+  storageNode->SetUseCompression(1);
+  if (!storageNode->WriteData(modelNode))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to write " << qPrintable(fileName)
+              << std::endl;
+    return false;
+    }
+
+  qSlicerIO::IOProperties properties;
+  properties["fileName"] = fileName;
+  bool res = true;
+  if (!qSlicerCoreIOManager::isFileUpToDate(modelNode, properties))
+    {
+    std::cerr << "Line " << __LINE__ << " - File written not up to date" << std::endl;
+    res = false;
+    }
+  properties["useCompression"] = 1;
+  properties["fileFormat"] = QString("vtk");
+  if (!qSlicerCoreIOManager::isFileUpToDate(modelNode, properties))
+    {
+    std::cerr << "Line " << __LINE__ << " - File written with the same options"
+              << " not up to date" << std::endl;
+    res = false;
+    }
+  // Different options
+  properties["useCompression"] = 0;
+  if (qSlicerCoreIOManager::isFileUpToDate(modelNode, properties))
+    {
+    std::cerr << "Line " << __LINE__ << " - File compressed differently"
+              << " up to date" << std::endl;
+    res = false;
+    }
+  properties["useCompression"] = 1;
+  properties["fileFormat"] = QString("vtp");
+  if (qSlicerCoreIOManager::isFileUpToDate(modelNode, properties))
+    {
+    std::cerr << "Line " << __LINE__ << " - File of another format up to date"
+              << std::endl;
+    res = false;
+    }
+  properties["fileFormat"] = QString("vtk");
+  // Another file
+  properties["fileName"] = QDir::temp().filePath("qSlicerCoreIOManagerSaveNodesTest2.vtk");
+  if (qSlicerCoreIOManager::isFileUpToDate(modelNode, properties))
+    {
+    std::cerr << "Line " << __LINE__ << " - Another file up to date" << std::endl;
+    res = false;
+    }
+  properties["fileName"] = fileName;
+  // Modified data
+  modelNode->GetPolyData()->GetPoints()->SetPoint(0, 0., 0., 1.);
+  modelNode->GetPolyData()->Modified();
+  if (qSlicerCoreIOManager::isFileUpToDate(modelNode, properties))
+    {
+    std::cerr << "Line " << __LINE__ << " - Modified model up to date" << std::endl;
+    res = false;
+    }
+  QFile::remove(fileName);
+  return res;
+}
+
+// ----------------------------------------------------------------------------
+bool testSaveNodes(qSlicerCoreIOManager* manager, vtkMRMLScene* scene,
+                   qSlicerCoreIOManagerSaveNodesTestWriter* writer)
+{
+  QList<qSlicerIO::IOProperties> files;
+  files << testFile(addModel(scene), "model1.test")
+        << testFile(addModel(scene), "fail.test")
+        << testFile(addModel(scene), "model3.test");
+  qSlicerCoreIOManagerSaveNodesTester tester(manager);
+  QObject::connect(manager, SIGNAL(fileSaved(int,bool)),
+                   &tester, SLOT(onFileSaved(int,bool)));
+
+  // All the files are saved but the failing one
+  QList<bool> savedFiles;
+  bool res = true;
+  if (manager->saveNodes(files, &savedFiles) ||
+      savedFiles != (QList<bool>() << true << false << true) ||
+      writer->WrittenFiles.count() != 3 ||
+      tester.FailedFiles != (QList<int>() << 1) ||
+      tester.SavedFiles.count() != 2)
+    {
+    std::cerr << "Line " << __LINE__ << " - saveNodes failed: "
+              << qPrintable(writer->WrittenFiles.join(" ")) << std::endl;
+    res = false;
+    }
+
+  // Saving stops at the first failure
+  writer->WrittenFiles.clear();
+  tester.SavedFiles.clear();
+  tester.FailedFiles.clear();
+  tester.CancelOnFailure = true;
+  QList<qSlicerIO::IOProperties> failFirstFiles;
+  failFirstFiles << files[1] << files[0] << files[2];
+  if (manager->saveNodes(failFirstFiles, &savedFiles) ||
+      savedFiles != (QList<bool>() << false << false << false) ||
+      writer->WrittenFiles != (QStringList() << "fail.test") ||
+      tester.FailedFiles != (QList<int>() << 0) ||
+      !tester.SavedFiles.isEmpty())
+    {
+    std::cerr << "Line " << __LINE__ << " - saveNodes not canceled: "
+              << qPrintable(writer->WrittenFiles.join(" ")) << std::endl;
+    res = false;
+    }
+
+  // The next saving is not canceled
+  writer->WrittenFiles.clear();
+  if (!manager->saveNodes(QList<qSlicerIO::IOProperties>() << files[0], &savedFiles) ||
+      writer->WrittenFiles != (QStringList() << "model1.test"))
+    {
+    std::cerr << "Line " << __LINE__ << " - saveNodes failed after cancel"
+              << std::endl;
+    res = false;
+    }
+  return res;
+}
+
+} // end of anonymous namespace
+
+// ----------------------------------------------------------------------------
+int qSlicerCoreIOManagerSaveNodesTest(int argc, char * argv [])
+{
+  qSlicerCoreApplication app(argc, argv);
+
+  qSlicerCoreIOManager manager;
+  qSlicerCoreIOManagerSaveNodesTestWriter* writer =
+    new qSlicerCoreIOManagerSaveNodesTestWriter;
+  manager.registerIO(writer);
+
+  bool res = testIsFileUpToDate(app.mrmlScene());
+  res = testSaveNodes(&manager, app.mrmlScene(), writer) && res;
+  return res ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#include "moc_qSlicerCoreIOManagerSaveNodesTest.cxx"
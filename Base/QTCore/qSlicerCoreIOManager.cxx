@@ -19,8 +19,16 @@
 ==============================================================================*/
 
 // Qt includes
+#include <QAtomicInt>
+#include <QCoreApplication>
 #include <QDebug>
 #include <QFileInfo>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+#include <QTime>
+#include <QVector>
 
 // CTK includes
 #include <ctkUtils.h>
@@ -32,16 +40,175 @@
 #include "qSlicerFileWriter.h"
 
 // MRML includes
+#include <vtkCacheManager.h>
+#include <vtkDataIOManager.h>
 #include <vtkMRMLNode.h>
 #include <vtkMRMLScene.h>
 #include <vtkMRMLStorableNode.h>
 #include <vtkMRMLStorageNode.h>
 
 // VTK includes
+#include <vtkCallbackCommand.h>
 #include <vtkCollection.h>
 #include <vtkDataFileFormatHelper.h> // for GetFileExtensionFromFormatString()
 #include <vtkNew.h>
+#include <vtkSmartPointer.h>
 #include <vtkStringArray.h>
+#include <vtkTimeStamp.h>
+
+//-----------------------------------------------------------------------------
+/// Read the data of a file with qSlicerFileReader::readData(). The nodes are
+/// not in the scene, so nothing else than the worker thread accesses them.
+class qSlicerCoreIOManagerReadDataTask : public QRunnable
+{
+public:
+  qSlicerCoreIOManagerReadDataTask(const qSlicerIO::IOProperties& properties,
+                                   qSlicerFileReader* reader,
+                                   vtkMRMLStorableNode* node,
+                                   vtkMRMLStorageNode* storageNode,
+                                   QAtomicInt* canceled,
+                                   QAtomicInt* readFileCount)
+    : Properties(properties)
+    , Reader(reader)
+    , Success(false)
+    , Canceled(canceled)
+    , ReadFileCount(readFileCount)
+  {
+    this->setAutoDelete(false);
+    this->Node.TakeReference(node);
+    this->StorageNode.TakeReference(storageNode);
+  }
+
+  virtual void run()
+  {
+    if (*this->Canceled)
+      {
+      return;
+      }
+    // Errors are collected and reported from the main thread
+    vtkNew<vtkCallbackCommand> errorSink;
+    errorSink->SetCallback(qSlicerCoreIOManagerReadDataTask::collectError);
+    errorSink->SetClientData(this);
+    vtkMRMLStorableNode* node = this->Node;
+    vtkMRMLStorageNode* storageNode = this->StorageNode;
+    this->Success = this->Reader->readData(
+      this->Properties, node, storageNode, errorSink.GetPointer());
+    if (node != this->Node.GetPointer())
+      {
+      this->Node.TakeReference(node);
+      }
+    if (storageNode != this->StorageNode.GetPointer())
+      {
+      this->StorageNode.TakeReference(storageNode);
+      }
+    this->ReadFileCount->ref();
+  }
+
+  static void collectError(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+                           void* clientData, void* callData)
+  {
+    qSlicerCoreIOManagerReadDataTask* self =
+      reinterpret_cast<qSlicerCoreIOManagerReadDataTask*>(clientData);
+    self->Errors << QString(reinterpret_cast<char*>(callData));
+  }
+
+  qSlicerIO::IOProperties Properties;
+  qSlicerFileReader* Reader;
+  vtkSmartPointer<vtkMRMLStorableNode> Node;
+  vtkSmartPointer<vtkMRMLStorageNode> StorageNode;
+  bool Success;
+  QStringList Errors;
+
+protected:
+  QAtomicInt* Canceled;
+  QAtomicInt* ReadFileCount;
+};
+
+//-----------------------------------------------------------------------------
+/// Write the data of the snapshot of a node. The snapshots are not in the
+/// scene, so nothing else than the worker thread accesses them. The storage
+/// node snapshot is given a scene of its own, with cache and IO managers
+/// detached from the ones of the application scene.
+class qSlicerCoreIOManagerWriteDataTask : public QRunnable
+{
+public:
+  qSlicerCoreIOManagerWriteDataTask(qSlicerFileWriter* writer,
+                                    vtkMRMLStorableNode* node,
+                                    vtkMRMLStorageNode* storageNode,
+                                    vtkMRMLScene* scene,
+                                    QAtomicInt* canceled,
+                                    QSemaphore* finishedTasks)
+    : Writer(writer)
+    , Success(false)
+    , ElapsedTime(0)
+    , Canceled(canceled)
+    , FinishedTasks(finishedTasks)
+    , Finished(0)
+  {
+    this->setAutoDelete(false);
+    this->Scene = qSlicerCoreIOManagerWriteDataTask::createSnapshotScene(scene);
+    this->Node.TakeReference(node);
+    this->StorageNode.TakeReference(storageNode);
+    this->StorageNode->SetScene(this->Scene);
+    this->SnapshotTime.Modified();
+  }
+
+  virtual void run()
+  {
+    if (!*this->Canceled)
+      {
+      QTime time;
+      time.start();
+      // The error output window can't be used from a worker thread, failures
+      // are reported by saveNodes().
+      vtkNew<vtkCallbackCommand> errorSink;
+      this->StorageNode->AddObserver(vtkCommand::ErrorEvent, errorSink.GetPointer());
+      this->Success = this->StorageNode->WriteData(this->Node) != 0;
+      this->StorageNode->RemoveObserver(errorSink.GetPointer());
+      this->ElapsedTime = time.elapsed();
+      }
+    this->Finished.fetchAndStoreOrdered(1);
+    this->FinishedTasks->release();
+  }
+
+  bool isFinished()
+  {
+    return this->Finished.fetchAndAddOrdered(0) != 0;
+  }
+
+  /// Scene with the root directory of \a scene to resolve the relative
+  /// file names, and its own cache and IO managers. Only the file format
+  /// helper is shared, it is not modified while writing.
+  static vtkSmartPointer<vtkMRMLScene> createSnapshotScene(vtkMRMLScene* scene)
+  {
+    vtkSmartPointer<vtkMRMLScene> snapshotScene = vtkSmartPointer<vtkMRMLScene>::New();
+    snapshotScene->SetRootDirectory(scene->GetRootDirectory());
+    vtkNew<vtkCacheManager> cacheManager;
+    snapshotScene->SetCacheManager(cacheManager.GetPointer());
+    vtkNew<vtkDataIOManager> dataIOManager;
+    dataIOManager->SetCacheManager(cacheManager.GetPointer());
+    if (scene->GetDataIOManager())
+      {
+      dataIOManager->SetFileFormatHelper(
+        scene->GetDataIOManager()->GetFileFormatHelper());
+      }
+    snapshotScene->SetDataIOManager(dataIOManager.GetPointer());
+    return snapshotScene;
+  }
+
+  qSlicerFileWriter* Writer;
+  vtkSmartPointer<vtkMRMLScene> Scene;
+  vtkSmartPointer<vtkMRMLStorableNode> Node;
+  vtkSmartPointer<vtkMRMLStorageNode> StorageNode;
+  vtkTimeStamp SnapshotTime;
+  bool Success;
+  int ElapsedTime;
+
+protected:
+  QAtomicInt* Canceled;
+  QSemaphore* FinishedTasks;
+  QAtomicInt Finished;
+};
 
 //-----------------------------------------------------------------------------
 class qSlicerCoreIOManagerPrivate
@@ -60,10 +227,19 @@ public:
   QList<qSlicerFileReader*> Readers;
   QList<qSlicerFileWriter*> Writers;
   QMap<qSlicerIO::IOFileType, QStringList> FileTypes;
+
+  bool       ConcurrentLoading;
+  QAtomicInt LoadingCanceled;
+  bool       SkipUnmodifiedData;
+  QAtomicInt SavingCanceled;
 };
 
 //-----------------------------------------------------------------------------
 qSlicerCoreIOManagerPrivate::qSlicerCoreIOManagerPrivate()
+  : ConcurrentLoading(false)
+  , LoadingCanceled(0)
+  , SkipUnmodifiedData(true)
+  , SavingCanceled(0)
 {
 }
 
@@ -539,6 +715,11 @@ bool qSlicerCoreIOManager::
 loadNodes(const QList<qSlicerIO::IOProperties>& files,
           vtkCollection* loadedNodes)
 {
+  Q_D(qSlicerCoreIOManager);
+  if (d->ConcurrentLoading && files.count() > 1)
+    {
+    return this->loadNodesConcurrently(files, loadedNodes);
+    }
   bool res = true;
   foreach(qSlicerIO::IOProperties fileProperties, files)
     {
@@ -552,6 +733,154 @@ loadNodes(const QList<qSlicerIO::IOProperties>& files,
   return res;
 }
 
+//-----------------------------------------------------------------------------
+bool qSlicerCoreIOManager::
+loadNodesConcurrently(const QList<qSlicerIO::IOProperties>& files,
+                      vtkCollection* loadedNodes)
+{
+  Q_D(qSlicerCoreIOManager);
+  vtkMRMLScene* scene = d->currentScene();
+  if (!scene)
+    {
+    return false;
+    }
+  d->LoadingCanceled = 0;
+  QAtomicInt readFileCount(0);
+
+  // Create the nodes to read from the main thread. A null task means the file
+  // is loaded with qSlicerFileReader::load().
+  QList<qSlicerCoreIOManagerReadDataTask*> tasks;
+  foreach(const qSlicerIO::IOProperties& fileProperties, files)
+    {
+    qSlicerCoreIOManagerReadDataTask* task = 0;
+    QVariant fileName = fileProperties["fileName"];
+    qSlicerIO::IOFileType fileType =
+      static_cast<qSlicerIO::IOFileType>(fileProperties["fileType"].toString());
+    foreach(qSlicerFileReader* reader, this->readers(fileType))
+      {
+      if (fileName.type() == QVariant::StringList ||
+          !reader->canLoadFile(fileName.toString()))
+        {
+        continue;
+        }
+      reader->setMRMLScene(scene);
+      vtkMRMLStorableNode* node = 0;
+      vtkMRMLStorageNode* storageNode = 0;
+      if (reader->prepareLoad(fileProperties, node, storageNode))
+        {
+        task = new qSlicerCoreIOManagerReadDataTask(
+          fileProperties, reader, node, storageNode,
+          &d->LoadingCanceled, &readFileCount);
+        }
+      break;
+      }
+    tasks << task;
+    }
+
+  QThreadPool threadPool;
+  threadPool.setMaxThreadCount(QThread::idealThreadCount());
+  int taskCount = 0;
+  foreach(qSlicerCoreIOManagerReadDataTask* task, tasks)
+    {
+    if (task)
+      {
+      threadPool.start(task);
+      ++taskCount;
+      }
+    }
+  // Keep the application responsive (progress, cancel) while reading. User
+  // input events are not processed: the scene must not be modified by the
+  // user until the read nodes are added.
+  while (!threadPool.waitForDone(100))
+    {
+    emit loadingProgress(readFileCount, taskCount);
+    QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+    }
+  emit loadingProgress(readFileCount, taskCount);
+
+  // Add the nodes into the scene in the order of the files
+  bool res = true;
+  scene->StartState(vtkMRMLScene::BatchProcessState);
+  for (int i = 0; i < files.count(); ++i)
+    {
+    qSlicerCoreIOManagerReadDataTask* task = tasks[i];
+    if (!task)
+      {
+      if (d->LoadingCanceled)
+        {
+        res = false;
+        continue;
+        }
+      // Not supported, use the regular loading
+      res = this->loadNodes(
+        static_cast<qSlicerIO::IOFileType>(files[i]["fileType"].toString()),
+        files[i], loadedNodes) && res;
+      continue;
+      }
+    if (!task->Success)
+      {
+      // The file is not read again: report why it failed
+      if (!d->LoadingCanceled)
+        {
+        qWarning() << task->Reader->description() << "Reader failed to read the file"
+                   << task->Properties["fileName"].toString();
+        foreach(const QString& error, task->Errors)
+          {
+          qWarning() << error;
+          }
+        }
+      res = false;
+      continue;
+      }
+    bool success = task->Reader->finishLoad(task->Properties, task->Node, task->StorageNode);
+    QStringList nodes;
+    if (success)
+      {
+      qDebug() << task->Reader->description() << "Reader has successfully read the file"
+               << task->Properties["fileName"].toString();
+      nodes = task->Reader->loadedNodes();
+      }
+    res = success && res;
+
+    qSlicerIO::IOProperties loadedFileParameters = task->Properties;
+    loadedFileParameters.insert("nodeIDs", nodes);
+    emit newFileLoaded(loadedFileParameters);
+
+    if (loadedNodes)
+      {
+      foreach(const QString& node, nodes)
+        {
+        loadedNodes->AddItem(scene->GetNodeByID(node.toLatin1()));
+        }
+      }
+    }
+  scene->EndState(vtkMRMLScene::BatchProcessState);
+
+  qDeleteAll(tasks);
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManager::setConcurrentLoading(bool enable)
+{
+  Q_D(qSlicerCoreIOManager);
+  d->ConcurrentLoading = enable;
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerCoreIOManager::concurrentLoading()const
+{
+  Q_D(const qSlicerCoreIOManager);
+  return d->ConcurrentLoading;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManager::cancelLoading()
+{
+  Q_D(qSlicerCoreIOManager);
+  d->LoadingCanceled = 1;
+}
+
 //-----------------------------------------------------------------------------
 vtkMRMLNode* qSlicerCoreIOManager::loadNodesAndGetFirst(
   qSlicerIO::IOFileType fileType,
@@ -649,6 +978,211 @@ bool qSlicerCoreIOManager::saveScene(const QString& fileName, QImage screenShot)
   return this->saveNodes(QString("SceneFile"), properties);
 }
 
+//-----------------------------------------------------------------------------
+bool qSlicerCoreIOManager::saveNodes(const QList<qSlicerIO::IOProperties>& files,
+                                     QList<bool>* savedFiles)
+{
+  Q_D(qSlicerCoreIOManager);
+  vtkMRMLScene* scene = d->currentScene();
+  const int fileCount = files.count();
+  QVector<bool> saved(fileCount, false);
+  QVector<bool> done(fileCount, false);
+  QTime totalTime;
+  totalTime.start();
+  d->SavingCanceled = 0;
+  int doneFileCount = 0;
+  int skippedFileCount = 0;
+  emit savingProgress(doneFileCount, fileCount);
+
+  // The files are saved in order. The snapshot of a node to write
+  // concurrently is taken when a worker thread is available, and released
+  // once written: there are no more snapshots than worker threads. The
+  // other nodes are saved from the main thread meanwhile, the scene files
+  // last.
+  QThreadPool threadPool;
+  const int maximumTaskCount = qMax(1, QThread::idealThreadCount());
+  threadPool.setMaxThreadCount(maximumTaskCount);
+  QSemaphore finishedTasks;
+  QVector<qSlicerCoreIOManagerWriteDataTask*> tasks(fileCount, 0);
+  int runningTaskCount = 0;
+  int taskCount = 0;
+  int nextFile = 0;
+  while (true)
+    {
+    // Update the scene with the written snapshots
+    for (int i = 0; i < fileCount; ++i)
+      {
+      qSlicerCoreIOManagerWriteDataTask* task = tasks[i];
+      if (!task || !task->isFinished())
+        {
+        continue;
+        }
+      tasks[i] = 0;
+      --runningTaskCount;
+      done[i] = true;
+      // not written (or failed) after the saving was canceled
+      if (task->Success || !d->SavingCanceled)
+        {
+        saved[i] = task->Success &&
+          task->Writer->finishWrite(files[i], task->Node, task->StorageNode, task->SnapshotTime);
+        qDebug() << (saved[i] ? "Saved" : "Failed to save") << files[i]["fileName"].toString()
+                 << "in" << task->ElapsedTime / 1000. << "s";
+        emit savingProgress(++doneFileCount, fileCount);
+        emit fileSaved(i, saved[i]);
+        }
+      delete task;
+      }
+
+    if (nextFile < fileCount && !d->SavingCanceled &&
+        runningTaskCount < maximumTaskCount)
+      {
+      const int i = nextFile++;
+      qSlicerIO::IOFileType fileType =
+        static_cast<qSlicerIO::IOFileType>(files[i]["fileType"].toString());
+      if (fileType == QString("SceneFile"))
+        {
+        continue;
+        }
+      vtkMRMLStorableNode* node = !scene ? 0 : vtkMRMLStorableNode::SafeDownCast(
+        scene->GetNodeByID(files[i]["nodeID"].toString().toLatin1()));
+      if (node && d->SkipUnmodifiedData &&
+          qSlicerCoreIOManager::isFileUpToDate(node, files[i]))
+        {
+        qDebug() << "Skip saving unmodified" << node->GetID()
+                 << "into" << files[i]["fileName"].toString();
+        saved[i] = true;
+        done[i] = true;
+        ++skippedFileCount;
+        emit savingProgress(++doneFileCount, fileCount);
+        continue;
+        }
+      foreach(qSlicerFileWriter* writer, !node ?
+              QList<qSlicerFileWriter*>() : d->writers(fileType, files[i]))
+        {
+        writer->setMRMLScene(scene);
+        vtkMRMLStorableNode* nodeSnapshot = 0;
+        vtkMRMLStorageNode* storageNodeSnapshot = 0;
+        if (writer->prepareWrite(files[i], nodeSnapshot, storageNodeSnapshot))
+          {
+          tasks[i] = new qSlicerCoreIOManagerWriteDataTask(
+            writer, nodeSnapshot, storageNodeSnapshot, scene,
+            &d->SavingCanceled, &finishedTasks);
+          threadPool.start(tasks[i]);
+          ++runningTaskCount;
+          ++taskCount;
+          }
+        break;
+        }
+      if (!tasks[i])
+        {
+        QTime time;
+        time.start();
+        saved[i] = this->saveNodes(fileType, files[i]);
+        qDebug() << (saved[i] ? "Saved" : "Failed to save") << files[i]["fileName"].toString()
+                 << "in" << time.elapsed() / 1000. << "s";
+        done[i] = true;
+        emit savingProgress(++doneFileCount, fileCount);
+        emit fileSaved(i, saved[i]);
+        }
+      continue;
+      }
+    if (runningTaskCount == 0)
+      {
+      break;
+      }
+    // Keep the application repainting while writing, the scene must not be
+    // modified by the user in the meantime.
+    finishedTasks.tryAcquire(1, 100);
+    QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+    }
+  threadPool.waitForDone();
+
+  // The scene files refer to the data files, they are not saved if the
+  // saving is canceled.
+  for (int i = 0; i < fileCount && !d->SavingCanceled; ++i)
+    {
+    if (done[i])
+      {
+      continue;
+      }
+    QTime time;
+    time.start();
+    saved[i] = this->saveNodes(
+      static_cast<qSlicerIO::IOFileType>(files[i]["fileType"].toString()), files[i]);
+    qDebug() << (saved[i] ? "Saved" : "Failed to save") << files[i]["fileName"].toString()
+             << "in" << time.elapsed() / 1000. << "s";
+    emit savingProgress(++doneFileCount, fileCount);
+    emit fileSaved(i, saved[i]);
+    }
+
+  const int savedFileCount = saved.count(true);
+  qDebug() << "Saved" << savedFileCount << "of" << fileCount << "files in"
+           << totalTime.elapsed() / 1000. << "s:" << taskCount << "written concurrently,"
+           << skippedFileCount << "unmodified"
+           << (d->SavingCanceled ? ", canceled" : "");
+  if (savedFiles)
+    {
+    *savedFiles = saved.toList();
+    }
+  return savedFileCount == fileCount;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManager::cancelSaving()
+{
+  Q_D(qSlicerCoreIOManager);
+  d->SavingCanceled = 1;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManager::setSkipUnmodifiedData(bool skip)
+{
+  Q_D(qSlicerCoreIOManager);
+  d->SkipUnmodifiedData = skip;
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerCoreIOManager::skipUnmodifiedData()const
+{
+  Q_D(const qSlicerCoreIOManager);
+  return d->SkipUnmodifiedData;
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerCoreIOManager::isFileUpToDate(vtkMRMLStorableNode* node,
+                                          const qSlicerIO::IOProperties& properties)
+{
+  vtkMRMLStorageNode* storageNode = node ? node->GetStorageNode() : 0;
+  if (!storageNode || !storageNode->GetFileName() ||
+      node->GetModifiedSinceRead())
+    {
+    return false;
+    }
+  // Relative file names depend on the scene root directory, that is changed
+  // before saving a scene.
+  QFileInfo storedFile(QString::fromLatin1(storageNode->GetFileName()));
+  QFileInfo file(properties["fileName"].toString());
+  if (!storedFile.isAbsolute() || !file.exists() || storedFile != file)
+    {
+    return false;
+    }
+  // The file must have been written with the requested options. A storage
+  // node that only read its file has no write format, the format of the
+  // file then matches its extension.
+  if (properties.contains("useCompression") &&
+      properties["useCompression"].toInt() != storageNode->GetUseCompression())
+    {
+    return false;
+    }
+  QString storedFileFormat = QString::fromLatin1(storageNode->GetWriteFileFormat());
+  if (properties.contains("fileFormat") && !storedFileFormat.isEmpty() &&
+      properties["fileFormat"].toString() != storedFileFormat)
+    {
+    return false;
+    }
+  return true;
+}
+
 //-----------------------------------------------------------------------------
 const QList<qSlicerFileReader*>& qSlicerCoreIOManager::readers()const
 {
@@ -106,9 +106,30 @@ public:
 
   /// Utility function that loads a bunch of files. The "fileType" attribute should
   /// in the parameter map for each node to load.
+  /// If concurrentLoading is enabled, the data of the files is read on a pool
+  /// of threads.
+  /// \sa setConcurrentLoading()
   virtual bool loadNodes(const QList<qSlicerIO::IOProperties>& files,
                          vtkCollection* loadedNodes = 0);
 
+  /// Read the data of the files on a pool of threads when loading a bunch
+  /// of files with loadNodes(const QList<qSlicerIO::IOProperties>&, vtkCollection*).
+  /// Only the files supported by qSlicerFileReader::prepareLoad() are read
+  /// concurrently; once all the files are read, the nodes are added into the
+  /// scene from the main thread in a single batch process.
+  /// Other files are loaded in that same batch process. Files that fail to
+  /// be read concurrently are not read again.
+  /// False by default. The add data dialog enables it to load the files it
+  /// lists.
+  /// \sa qSlicerFileReader::prepareLoad(), loadingProgress(), cancelLoading()
+  void setConcurrentLoading(bool enable);
+  bool concurrentLoading()const;
+
+  /// Stop loading the files that are not read yet. The files being read are
+  /// still loaded.
+  /// \sa loadingProgress()
+  Q_INVOKABLE void cancelLoading();
+
   /// Load a list of node corresponding to \a fileType and return the first loaded node.
   /// This function is provided for convenience and is equivalent to call loadNodes
   /// with a vtkCollection parameter and retrieve the first element.
@@ -145,6 +166,43 @@ public:
   /// and screenShot set as properties.
   Q_INVOKABLE bool saveScene(const QString& fileName, QImage screenShot);
 
+  /// Utility function that saves a bunch of nodes. The "fileType" attribute
+  /// should be in the parameter map of each file to save.
+  /// The data of the nodes supported by qSlicerFileWriter::prepareWrite() is
+  /// written on a pool of threads from snapshots of the nodes, the other
+  /// nodes are saved from the main thread meanwhile. A snapshot is taken
+  /// only when a thread is available to write it, and released once
+  /// written. Scene files
+  /// ("SceneFile") are saved last, once all the data files are written.
+  /// If \a savedFiles is not null, it is filled with whether each file has
+  /// been saved.
+  /// Return true if all the files are saved.
+  /// \sa setSkipUnmodifiedData(), savingProgress(), fileSaved(), cancelSaving()
+  virtual bool saveNodes(const QList<qSlicerIO::IOProperties>& files,
+                         QList<bool>* savedFiles = 0);
+
+  /// Stop saving the files that are not written yet, e.g. from a slot
+  /// connected to fileSaved() when a file fails to be saved. The files being
+  /// written are still saved, the scene files are not saved.
+  /// \sa saveNodes(const QList<qSlicerIO::IOProperties>&, QList<bool>*)
+  Q_INVOKABLE void cancelSaving();
+
+  /// Don't write the nodes that have not been modified since they were read
+  /// from or written into the file to save, when saving a bunch of nodes with
+  /// saveNodes(const QList<qSlicerIO::IOProperties>&, QList<bool>*).
+  /// These files are reported as saved.
+  /// True by default.
+  /// \sa isFileUpToDate()
+  void setSkipUnmodifiedData(bool skip);
+  bool skipUnmodifiedData()const;
+
+  /// Return true if the file "fileName" of \a properties exists, is the file
+  /// the storage node of \a node has last read or written and \a node has
+  /// not been modified since. The "useCompression" and "fileFormat"
+  /// properties, if any, must match the options of the storage node.
+  Q_INVOKABLE static bool isFileUpToDate(vtkMRMLStorableNode* node,
+                                         const qSlicerIO::IOProperties& properties);
+
   /// Register the reader/writer \a io
   /// Note also that the IOManager takes ownership of \a io
   void registerIO(qSlicerIO* io);
@@ -166,8 +224,35 @@ signals:
   /// \sa loadNodes(const qSlicerIO::IOFileType&, const qSlicerIO::IOProperties&, vtkCollection*)
   void newFileLoaded(const qSlicerIO::IOProperties& loadedFileParameters);
 
+  /// This signal is emitted while files are read concurrently, with the
+  /// number of files already read.
+  /// Only the events that are not user input events are processed while the
+  /// files are read, cancelLoading() can be called from a slot connected to
+  /// this signal.
+  /// \sa setConcurrentLoading(), cancelLoading()
+  void loadingProgress(int readFileCount, int fileCount);
+
+  /// This signal is emitted while a bunch of nodes is saved, each time a
+  /// file is saved (or skipped).
+  /// Only the events that are not user input events are processed while the
+  /// files are written.
+  /// \sa saveNodes(const QList<qSlicerIO::IOProperties>&, QList<bool>*)
+  void savingProgress(int savedFileCount, int fileCount);
+
+  /// This signal is emitted each time a file of a bunch of nodes is saved
+  /// or fails to be saved. \a fileIndex is the index of the file in the
+  /// list given to saveNodes(). Unmodified files that are skipped are not
+  /// reported.
+  /// \sa saveNodes(const QList<qSlicerIO::IOProperties>&, QList<bool>*), cancelSaving()
+  void fileSaved(int fileIndex, bool saved);
+
 protected:
 
+  /// Load the files reading their data concurrently.
+  /// \sa setConcurrentLoading()
+  bool loadNodesConcurrently(const QList<qSlicerIO::IOProperties>& files,
+                             vtkCollection* loadedNodes);
+
   /// Returns the list of registered readers
   const QList<qSlicerFileReader*>& readers()const;
 
@@ -27,6 +27,11 @@
 /// QtCore includes
 #include "qSlicerFileReader.h"
 
+// MRML includes
+#include <vtkMRMLDisplayableNode.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLStorageNode.h>
+
 //-----------------------------------------------------------------------------
 class qSlicerFileReaderPrivate
 {
@@ -109,3 +114,71 @@ QStringList qSlicerFileReader::loadedNodes()const
   Q_D(const qSlicerFileReader);
   return d->LoadedNodes;
 }
+
+//----------------------------------------------------------------------------
+bool qSlicerFileReader::prepareLoad(const IOProperties& properties,
+                                    vtkMRMLStorableNode*& node,
+                                    vtkMRMLStorageNode*& storageNode)
+{
+  Q_UNUSED(properties);
+  node = 0;
+  storageNode = 0;
+  return false;
+}
+
+//----------------------------------------------------------------------------
+bool qSlicerFileReader::readData(const IOProperties& properties,
+                                 vtkMRMLStorableNode*& node,
+                                 vtkMRMLStorageNode*& storageNode,
+                                 vtkCommand* errorObserver)
+{
+  Q_UNUSED(properties);
+  if (!node || !storageNode)
+    {
+    return false;
+    }
+  if (errorObserver)
+    {
+    storageNode->AddObserver(vtkCommand::ErrorEvent, errorObserver);
+    }
+  bool success = storageNode->ReadData(node) != 0;
+  if (errorObserver)
+    {
+    storageNode->RemoveObserver(errorObserver);
+    }
+  return success;
+}
+
+//----------------------------------------------------------------------------
+bool qSlicerFileReader::finishLoad(const IOProperties& properties,
+                                   vtkMRMLStorableNode* node,
+                                   vtkMRMLStorageNode* storageNode)
+{
+  Q_D(qSlicerFileReader);
+  d->LoadedNodes.clear();
+  vtkMRMLScene* scene = this->mrmlScene();
+  if (!scene || !node || !storageNode)
+    {
+    return false;
+    }
+
+  QString name = QFileInfo(properties["fileName"].toString()).baseName();
+  if (properties.contains("name"))
+    {
+    name = properties["name"].toString();
+    }
+  node->SetName(scene->GetUniqueNameByString(name.toLatin1()).c_str());
+
+  scene->AddNode(storageNode);
+  node->SetAndObserveStorageNodeID(storageNode->GetID());
+  scene->AddNode(node);
+
+  vtkMRMLDisplayableNode* displayableNode = vtkMRMLDisplayableNode::SafeDownCast(node);
+  if (displayableNode && displayableNode->GetNumberOfDisplayNodes() == 0)
+    {
+    displayableNode->CreateDefaultDisplayNodes();
+    }
+
+  d->LoadedNodes = QStringList(QString(node->GetID()));
+  return true;
+}
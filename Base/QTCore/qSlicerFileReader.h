@@ -27,6 +27,9 @@
 
 class qSlicerFileReaderOptions;
 class qSlicerFileReaderPrivate;
+class vtkCommand;
+class vtkMRMLStorableNode;
+class vtkMRMLStorageNode;
 
 class Q_SLICER_BASE_QTCORE_EXPORT qSlicerFileReader
   : public qSlicerIO
@@ -61,6 +64,44 @@ public:
   /// \sa setLoadedNodes(), load()
   QStringList loadedNodes()const;
 
+  /// Concurrent loading: create the node and the storage node that can read
+  /// the file described by \a properties, without adding them into the scene.
+  /// readData() is then called from a worker thread and finishLoad() from
+  /// the main thread.
+  /// The caller takes the ownership of the returned nodes. They can be null
+  /// if readData() creates them.
+  /// Return false if the file can't be read that way (default), load() is
+  /// then used instead.
+  /// \sa readData(), finishLoad(), qSlicerCoreIOManager::setConcurrentLoading()
+  virtual bool prepareLoad(const IOProperties& properties,
+                           vtkMRMLStorableNode*& node,
+                           vtkMRMLStorageNode*& storageNode);
+
+  /// Read the data of the file described by \a properties. Called from a
+  /// worker thread, it must not access the scene.
+  /// By default, the storage node reads its data into the node. Readers
+  /// that only know the type of the nodes once the file is read (e.g. from a
+  /// registry of node factories) can replace \a node and \a storageNode: the
+  /// caller then takes the ownership of the new nodes and releases the
+  /// previous ones.
+  /// Errors are sent to \a errorObserver as vtkCommand::ErrorEvent. The file
+  /// is not read again if it fails.
+  /// \sa prepareLoad(), finishLoad()
+  virtual bool readData(const IOProperties& properties,
+                        vtkMRMLStorableNode*& node,
+                        vtkMRMLStorageNode*& storageNode,
+                        vtkCommand* errorObserver);
+
+  /// Add into the scene the nodes created by prepareLoad() once their data
+  /// has been read. By default, the storage node and the node are added and
+  /// the default display nodes of the node are created.
+  /// Must be called from the main thread. On success, loadedNodes() contains
+  /// the nodes added into the scene.
+  /// \sa prepareLoad()
+  virtual bool finishLoad(const IOProperties& properties,
+                          vtkMRMLStorableNode* node,
+                          vtkMRMLStorageNode* storageNode);
+
 protected:
   /// Must be called in load() on success with the list of nodes added into the
   /// scene.
@@ -56,6 +56,32 @@ bool qSlicerFileWriter::write(const qSlicerIO::IOProperties& properties)
   return false;
 }
 
+//----------------------------------------------------------------------------
+bool qSlicerFileWriter::prepareWrite(const IOProperties& properties,
+                                     vtkMRMLStorableNode*& node,
+                                     vtkMRMLStorageNode*& storageNode)
+{
+  Q_UNUSED(properties);
+  node = 0;
+  storageNode = 0;
+  return false;
+}
+
+//----------------------------------------------------------------------------
+bool qSlicerFileWriter::finishWrite(const IOProperties& properties,
+                                    vtkMRMLStorableNode* node,
+                                    vtkMRMLStorageNode* storageNode,
+                                    const vtkTimeStamp& snapshotTime)
+{
+  Q_D(qSlicerFileWriter);
+  Q_UNUSED(properties);
+  Q_UNUSED(node);
+  Q_UNUSED(storageNode);
+  Q_UNUSED(snapshotTime);
+  d->WrittenNodes.clear();
+  return false;
+}
+
 //----------------------------------------------------------------------------
 void qSlicerFileWriter::setWrittenNodes(const QStringList& nodes)
 {
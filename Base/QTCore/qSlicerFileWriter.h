@@ -25,7 +25,10 @@
 #include "qSlicerIO.h"
 class qSlicerFileWriterPrivate;
 
+class vtkMRMLStorableNode;
+class vtkMRMLStorageNode;
 class vtkObject;
+class vtkTimeStamp;
 
 class Q_SLICER_BASE_QTCORE_EXPORT qSlicerFileWriter
   : public qSlicerIO
@@ -55,6 +58,31 @@ public:
 
   QStringList writtenNodes()const;
 
+  /// Concurrent saving: return a snapshot of the node to write and of its
+  /// storage node, ready to write the file described by \a properties.
+  /// The snapshots are not in the scene, the storage node WriteData() is
+  /// called on them from a worker thread and finishWrite() from the main
+  /// thread. The storage node snapshot is given a scene with the root
+  /// directory of the application scene but its own cache and data IO
+  /// managers: nodes with remote storage can't be written that way.
+  /// The caller takes the ownership of the returned nodes.
+  /// Return false if the node can't be written that way (default), write()
+  /// is then used instead.
+  /// \sa finishWrite(), qSlicerCoreIOManager::saveNodes(const QList<qSlicerIO::IOProperties>&, QList<bool>*)
+  virtual bool prepareWrite(const IOProperties& properties,
+                            vtkMRMLStorableNode*& node,
+                            vtkMRMLStorageNode*& storageNode);
+
+  /// Update the scene once the snapshots returned by prepareWrite() have
+  /// been written. \a snapshotTime is the time the snapshots were taken.
+  /// Must be called from the main thread. On success, writtenNodes()
+  /// contains the written nodes.
+  /// \sa prepareWrite()
+  virtual bool finishWrite(const IOProperties& properties,
+                           vtkMRMLStorableNode* node,
+                           vtkMRMLStorageNode* storageNode,
+                           const vtkTimeStamp& snapshotTime);
+
 protected:
   void setWrittenNodes(const QStringList& nodes);
 
@@ -99,26 +99,42 @@ bool qSlicerSceneBundleReader::load(const qSlicerIO::IOProperties& properties)
     return false;
     }
 
-  vtkNew<vtkMRMLApplicationLogic> appLogic;
-  appLogic->SetMRMLScene( this->mrmlScene() );
-  std::string mrmlFile = appLogic->UnpackSlicerDataBundle(
-                                          file.toLatin1(), unpackPath.toLatin1() );
-
-  this->mrmlScene()->SetURL(mrmlFile.c_str());
-
   bool clear = false;
   if (properties.contains("clear"))
     {
     clear = properties["clear"].toBool();
     }
+  // by default the data files are extracted one at a time while the
+  // scene is loaded instead of unpacking the whole bundle first
+  bool streaming = true;
+  if (properties.contains("streaming"))
+    {
+    streaming = properties["streaming"].toBool();
+    }
+
+  vtkNew<vtkMRMLApplicationLogic> appLogic;
+  appLogic->SetMRMLScene( this->mrmlScene() );
   int res = 0;
-  if (clear)
+  if (streaming)
     {
-    res = this->mrmlScene()->Connect();
+    res = appLogic->LoadSlicerDataBundle(
+      file.toLatin1(), unpackPath.toLatin1(), clear);
     }
   else
     {
-    res = this->mrmlScene()->Import();
+    std::string mrmlFile = appLogic->UnpackSlicerDataBundle(
+                                            file.toLatin1(), unpackPath.toLatin1() );
+
+    this->mrmlScene()->SetURL(mrmlFile.c_str());
+
+    if (clear)
+      {
+      res = this->mrmlScene()->Connect();
+      }
+    else
+      {
+      res = this->mrmlScene()->Import();
+      }
     }
 
   if (!ctk::removeDirRecursively(unpackPath))
@@ -493,8 +493,13 @@ bool qSlicerDataDialog::exec(const qSlicerIO::IOProperties& readerProperties)
     {
     files[i].unite(readerProperties);
     }
-  res = qSlicerCoreApplication::application()->coreIOManager()
-    ->loadNodes(files);
+  // The data of the selected files is read concurrently
+  qSlicerCoreIOManager* ioManager =
+    qSlicerCoreApplication::application()->coreIOManager();
+  bool concurrentLoading = ioManager->concurrentLoading();
+  ioManager->setConcurrentLoading(true);
+  res = ioManager->loadNodes(files);
+  ioManager->setConcurrentLoading(concurrentLoading);
   d->reset();
   return res;
 }
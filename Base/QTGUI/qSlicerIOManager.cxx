@@ -435,6 +435,20 @@ bool qSlicerIOManager::loadNodes(const QList<qSlicerIO::IOProperties>& files,
 
   bool needStop = d->startProgressDialog(files.count());
   bool res = true;
+  if (this->concurrentLoading() && files.count() > 1)
+    {
+    d->ProgressDialog->setLabelText("Reading files ...");
+    this->connect(this, SIGNAL(loadingProgress(int,int)),
+                  this, SLOT(updateLoadingProgressDialog(int,int)));
+    res = this->qSlicerCoreIOManager::loadNodes(files, loadedNodes);
+    this->disconnect(this, SIGNAL(loadingProgress(int,int)),
+                     this, SLOT(updateLoadingProgressDialog(int,int)));
+    if (needStop)
+      {
+      d->stopProgressDialog();
+      }
+    return res;
+    }
   foreach(qSlicerIO::IOProperties fileProperties, files)
     {
     res = this->loadNodes(
@@ -473,6 +487,22 @@ void qSlicerIOManager::updateProgressDialog()
   //qApp->processEvents();
 }
 
+//-----------------------------------------------------------------------------
+void qSlicerIOManager::updateLoadingProgressDialog(int readFileCount, int fileCount)
+{
+  Q_D(qSlicerIOManager);
+  if (!d->ProgressDialog)
+    {
+    return;
+    }
+  d->ProgressDialog->setMaximum(fileCount + 1);
+  d->ProgressDialog->setValue(readFileCount);
+  if (d->ProgressDialog->wasCanceled())
+    {
+    this->cancelLoading();
+    }
+}
+
 //-----------------------------------------------------------------------------
 void qSlicerIOManager::openScreenshotDialog()
 {
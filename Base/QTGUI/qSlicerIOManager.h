@@ -66,7 +66,9 @@ public:
                                      vtkCollection* loadedNodes = 0);
   /// If you have a list of nodes to load, it's best to use this function
   /// in order to have a unique progress dialog instead of multiple ones.
-  /// It internally calls loadNodes() for each file.
+  /// It internally calls loadNodes() for each file, or reads the files
+  /// concurrently if concurrentLoading is enabled.
+  /// \sa setConcurrentLoading()
   virtual bool loadNodes(const QList<qSlicerIO::IOProperties>& files,
                          vtkCollection* loadedNodes = 0);
 
@@ -103,6 +105,7 @@ public slots:
 
 protected slots:
   void updateProgressDialog();
+  void updateLoadingProgressDialog(int readFileCount, int fileCount);
 
 protected:
   friend class qSlicerFileDialog;
@@ -31,15 +31,23 @@
 #include "qSlicerCoreIOManager.h"
 
 // MRML includes
+#include <vtkMRMLModelNode.h>
 #include <vtkMRMLScene.h>
 #include <vtkMRMLStorableNode.h>
 #include <vtkMRMLStorageNode.h>
 #include <vtkMRMLSceneViewNode.h>
+#include <vtkMRMLVolumeNode.h>
 
 // VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPolyData.h>
 #include <vtkStdString.h>
 #include <vtkStringArray.h>
 
+// STD includes
+#include <cstring>
+
 //-----------------------------------------------------------------------------
 class qSlicerNodeWriterPrivate
 {
@@ -48,8 +56,33 @@ public:
   qSlicerIO::IOFileType FileType;
   QStringList NodeClassNames;
   bool SupportUseCompression;
+
+  /// Set the file to write and the writing options to the storage node
+  static void setupStorageNode(vtkMRMLStorageNode* storageNode,
+                               const qSlicerIO::IOProperties& properties);
 };
 
+//----------------------------------------------------------------------------
+void qSlicerNodeWriterPrivate::setupStorageNode(vtkMRMLStorageNode* snode,
+                                                const qSlicerIO::IOProperties& properties)
+{
+  Q_ASSERT(!properties["fileName"].toString().isEmpty());
+  QString fileName = properties["fileName"].toString();
+  snode->SetFileName(fileName.toLatin1());
+
+  qSlicerCoreIOManager* coreIOManager =
+    qSlicerCoreApplication::application()->coreIOManager();
+
+  QString fileFormat =
+    properties.value("fileFormat", coreIOManager->completeSlicerWritableFileNameSuffix(fileName)).toString();
+  snode->SetWriteFileFormat(fileFormat.toLatin1());
+  snode->SetURI(0);
+  if (properties.contains("useCompression"))
+    {
+    snode->SetUseCompression(properties["useCompression"].toInt());
+    }
+}
+
 //----------------------------------------------------------------------------
 qSlicerNodeWriter::qSlicerNodeWriter(const QString& description,
                                      const qSlicerIO::IOFileType& fileIO,
@@ -142,21 +175,7 @@ bool qSlicerNodeWriter::write(const qSlicerIO::IOProperties& properties)
     return false;
     }
 
-  Q_ASSERT(!properties["fileName"].toString().isEmpty());
-  QString fileName = properties["fileName"].toString();
-  snode->SetFileName(fileName.toLatin1());
-
-  qSlicerCoreIOManager* coreIOManager =
-    qSlicerCoreApplication::application()->coreIOManager();
-
-  QString fileFormat =
-    properties.value("fileFormat", coreIOManager->completeSlicerWritableFileNameSuffix(fileName)).toString();
-  snode->SetWriteFileFormat(fileFormat.toLatin1());
-  snode->SetURI(0);
-  if (properties.contains("useCompression"))
-    {
-    snode->SetUseCompression(properties["useCompression"].toInt());
-    }
+  qSlicerNodeWriterPrivate::setupStorageNode(snode, properties);
   bool res = snode->WriteData(node);
 
   if (res)
@@ -167,6 +186,89 @@ bool qSlicerNodeWriter::write(const qSlicerIO::IOProperties& properties)
   return res;
 }
 
+//----------------------------------------------------------------------------
+bool qSlicerNodeWriter::prepareWrite(const qSlicerIO::IOProperties& properties,
+                                     vtkMRMLStorableNode*& node,
+                                     vtkMRMLStorageNode*& storageNode)
+{
+  node = 0;
+  storageNode = 0;
+  this->setWrittenNodes(QStringList());
+
+  vtkMRMLStorableNode* sceneNode = vtkMRMLStorableNode::SafeDownCast(
+    this->mrmlScene()->GetNodeByID(properties["nodeID"].toString().toLatin1()));
+  // Only volumes and models are written concurrently, other nodes are
+  // written with write().
+  if (!this->canWriteObject(sceneNode) ||
+      (!vtkMRMLVolumeNode::SafeDownCast(sceneNode) &&
+       !vtkMRMLModelNode::SafeDownCast(sceneNode)))
+    {
+    return false;
+    }
+  vtkMRMLStorageNode* sceneStorageNode =
+    qSlicerCoreIOManager::createAndAddDefaultStorageNode(sceneNode);
+  if (sceneStorageNode == 0)
+    {
+    return false;
+    }
+  qSlicerNodeWriterPrivate::setupStorageNode(sceneStorageNode, properties);
+  // Remote data is uploaded by the scene data IO manager, from the main
+  // thread.
+  if (sceneStorageNode->GetURI() && strlen(sceneStorageNode->GetURI()) > 0)
+    {
+    return false;
+    }
+
+  // Neither snapshot is in the scene: nothing in the scene refers to them.
+  // The storage node is given a scene of its own by the IO manager.
+  storageNode = vtkMRMLStorageNode::SafeDownCast(sceneStorageNode->CreateNodeInstance());
+  storageNode->CopyWithoutModifiedEvent(sceneStorageNode);
+  storageNode->SetID(sceneStorageNode->GetID());
+
+  node = vtkMRMLStorableNode::SafeDownCast(sceneNode->CreateNodeInstance());
+  node->CopyWithoutModifiedEvent(sceneNode);
+  node->SetID(sceneNode->GetID());
+  // The scene node data can be edited in place while the snapshot is
+  // written (e.g. by a script or a timer): the snapshot has its own copy.
+  vtkMRMLVolumeNode* volumeNode = vtkMRMLVolumeNode::SafeDownCast(node);
+  if (volumeNode && volumeNode->GetImageData())
+    {
+    vtkNew<vtkImageData> imageData;
+    imageData->DeepCopy(volumeNode->GetImageData());
+    volumeNode->SetAndObserveImageData(imageData.GetPointer());
+    }
+  vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(node);
+  if (modelNode && modelNode->GetPolyData())
+    {
+    vtkNew<vtkPolyData> polyData;
+    polyData->DeepCopy(modelNode->GetPolyData());
+    modelNode->SetAndObservePolyData(polyData.GetPointer());
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool qSlicerNodeWriter::finishWrite(const qSlicerIO::IOProperties& properties,
+                                    vtkMRMLStorableNode* node,
+                                    vtkMRMLStorageNode* storageNode,
+                                    const vtkTimeStamp& snapshotTime)
+{
+  Q_UNUSED(properties);
+  this->setWrittenNodes(QStringList());
+  vtkMRMLStorageNode* sceneStorageNode = vtkMRMLStorageNode::SafeDownCast(
+    this->mrmlScene()->GetNodeByID(storageNode->GetID()));
+  if (!sceneStorageNode)
+    {
+    return false;
+    }
+  // The storage node may have changed its file list while writing.
+  // Modifications of the node made after the snapshot are not saved.
+  sceneStorageNode->Copy(storageNode);
+  sceneStorageNode->SetStoredTime(snapshotTime);
+  this->setWrittenNodes(QStringList() << node->GetID());
+  return true;
+}
+
 //-----------------------------------------------------------------------------
 vtkMRMLNode* qSlicerNodeWriter::getNodeByID(const char *id)const
 {
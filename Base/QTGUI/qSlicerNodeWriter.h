@@ -64,6 +64,20 @@ public:
   /// Create a storage node if the storable node doesn't have any.
   virtual bool write(const qSlicerIO::IOProperties& properties);
 
+  /// Reimplemented to write volume and model nodes concurrently.
+  /// The snapshot of the node has its own copy of the data of the scene node.
+  /// \sa qSlicerFileWriter::prepareWrite()
+  virtual bool prepareWrite(const qSlicerIO::IOProperties& properties,
+                            vtkMRMLStorableNode*& node,
+                            vtkMRMLStorageNode*& storageNode);
+
+  /// Reimplemented to update the scene storage node with the written files.
+  /// \sa qSlicerFileWriter::finishWrite()
+  virtual bool finishWrite(const qSlicerIO::IOProperties& properties,
+                           vtkMRMLStorableNode* node,
+                           vtkMRMLStorageNode* storageNode,
+                           const vtkTimeStamp& snapshotTime);
+
   virtual vtkMRMLNode* getNodeByID(const char *id)const;
 
   /// Return a qSlicerIONodeWriterOptionsWidget
@@ -24,6 +24,7 @@
 #include <QDebug>
 #include <QLineEdit>
 #include <QMessageBox>
+#include <QProgressDialog>
 #include <QRegExp>
 #include <QRegExpValidator>
 
@@ -49,6 +50,7 @@
 #include <vtkDataFileFormatHelper.h> // for GetFileExtensionFromFormatString()
 //#include <vtkMRMLHierarchyNode.h>
 #include <vtkMRMLScene.h>
+#include <vtkMRMLStorableNode.h>
 #include <vtkMRMLStorageNode.h>
 #include <vtkMRMLSceneViewNode.h>
 
@@ -145,6 +147,7 @@ qSlicerSaveDataDialogPrivate::qSlicerSaveDataDialogPrivate(QWidget* parentWidget
   : QDialog(parentWidget)
 {
   this->MRMLScene = 0;
+  this->SavingCanceled = false;
 
   this->setupUi(this);
   this->FileWidget->setItemDelegateForColumn(
@@ -793,6 +796,10 @@ bool qSlicerSaveDataDialogPrivate::saveNodes()
 {
   QMessageBox::StandardButton forceOverwrite = QMessageBox::Ignore;
   QList<qSlicerIO::IOProperties> files;
+  QList<int> fileRows;
+  qSlicerCoreIOManager* coreIOManager =
+    qSlicerCoreApplication::application()->coreIOManager();
+  Q_ASSERT(coreIOManager);
   const int sceneRow = this->findSceneRow();
   for (int row = 0; row < this->FileWidget->rowCount(); ++row)
     {
@@ -804,7 +811,6 @@ bool qSlicerSaveDataDialogPrivate::saveNodes()
 
     QTableWidgetItem* selectItem = this->FileWidget->item(row, SelectColumn);
     QTableWidgetItem* nodeNameItem = this->FileWidget->item(row, NodeNameColumn);
-    QTableWidgetItem* nodeStatusItem = this->FileWidget->item(row, NodeStatusColumn);
 
     Q_ASSERT(selectItem);
     Q_ASSERT(nodeNameItem);
@@ -829,8 +835,25 @@ bool qSlicerSaveDataDialogPrivate::saveNodes()
       continue;
       }
 
-    // check if the file already exists
-    if (file.exists())
+    qSlicerIO::IOFileType fileType = coreIOManager->fileWriterFileType(node);
+    qSlicerIO::IOProperties savingParameters;
+    if (options)
+      {
+      // options properties nodeID and fileName will be overwritten
+      // \todo fileName is wrong as it contains an obsolete directory
+      savingParameters = options->properties();
+      }
+    savingParameters["nodeID"] = QString(node->GetID());
+    savingParameters["fileName"] = file.absoluteFilePath();
+    savingParameters["fileFormat"] = format;
+    savingParameters["fileType"] = fileType;
+
+    // check if the file already exists, unmodified nodes are not written
+    // again in the file they have been read from
+    if (file.exists() &&
+        !(coreIOManager->skipUnmodifiedData() &&
+          qSlicerCoreIOManager::isFileUpToDate(
+            vtkMRMLStorableNode::SafeDownCast(node), savingParameters)))
       {
       if (forceOverwrite == QMessageBox::NoToAll)
         {
@@ -860,42 +883,67 @@ bool qSlicerSaveDataDialogPrivate::saveNodes()
         }
       }
 
-    // save the node
-    qSlicerCoreIOManager* coreIOManager =
-      qSlicerCoreApplication::application()->coreIOManager();
-    Q_ASSERT(coreIOManager);
-    qSlicerIO::IOFileType fileType = coreIOManager->fileWriterFileType(node);
-    qSlicerIO::IOProperties savingParameters;
-    if (options)
-      {
-      // options properties nodeID and fileName will be overwritten
-      // \todo fileName is wrong as it contains an obsolete directory
-      savingParameters = options->properties();
-      }
-    savingParameters["nodeID"] = QString(node->GetID());
-    savingParameters["fileName"] = file.absoluteFilePath();
-    savingParameters["fileFormat"] = format;
-    bool res = coreIOManager->saveNodes(fileType, savingParameters);
+    files << savingParameters;
+    fileRows << row;
+    }
 
-    // node has failed to be written
-    if (!res)
+  // save the nodes, their data is written concurrently
+  QProgressDialog progress(tr("Saving data files..."), QString(), 0, files.count(), this);
+  progress.setWindowModality(Qt::WindowModal);
+  progress.setMinimumDuration(1000);
+  QObject::connect(coreIOManager, SIGNAL(savingProgress(int,int)),
+                   &progress, SLOT(setValue(int)));
+  // failures are reported while saving, to stop saving the other files
+  this->FilesToSave = files;
+  this->SavingCanceled = false;
+  QObject::connect(coreIOManager, SIGNAL(fileSaved(int,bool)),
+                   this, SLOT(onFileSaved(int,bool)));
+  QList<bool> savedFiles;
+  coreIOManager->saveNodes(files, &savedFiles);
+  QObject::disconnect(coreIOManager, SIGNAL(fileSaved(int,bool)),
+                      this, SLOT(onFileSaved(int,bool)));
+  QObject::disconnect(coreIOManager, SIGNAL(savingProgress(int,int)),
+                      &progress, SLOT(setValue(int)));
+  progress.setValue(files.count());
+  this->FilesToSave.clear();
+
+  for (int i = 0; i < files.count(); ++i)
+    {
+    // files not saved because the user stopped saving
+    if (this->SavingCanceled && !savedFiles[i])
       {
-      QMessageBox::StandardButton answer =
-        QMessageBox::question(this, tr("Saving node..."),
-                              tr("Cannot write data file: %1.\n"
-                                 "Do you want to continue saving?").arg(file.absoluteFilePath()),
-                              QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes);
-      if (answer == QMessageBox::No)
-        {
-        return false;
-        }
+      continue;
       }
+    const int row = fileRows[i];
+    QTableWidgetItem* nodeNameItem = this->FileWidget->item(row, NodeNameColumn);
+    QTableWidgetItem* nodeStatusItem = this->FileWidget->item(row, NodeStatusColumn);
 
     // clean up node after saving
     nodeNameItem->setCheckState(Qt::Unchecked);
     nodeStatusItem->setText("Not Modified");
     }
-  return true;
+  return !this->SavingCanceled;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerSaveDataDialogPrivate::onFileSaved(int fileIndex, bool saved)
+{
+  // node has failed to be written
+  if (saved || this->SavingCanceled)
+    {
+    return;
+    }
+  QMessageBox::StandardButton answer =
+    QMessageBox::question(this, tr("Saving node..."),
+                          tr("Cannot write data file: %1.\n"
+                             "Do you want to continue saving?").arg(
+                            this->FilesToSave[fileIndex]["fileName"].toString()),
+                          QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes);
+  if (answer == QMessageBox::No)
+    {
+    this->SavingCanceled = true;
+    qSlicerCoreApplication::application()->coreIOManager()->cancelSaving();
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -1287,7 +1335,8 @@ void qSlicerSaveDataDialogPrivate::onSceneFormatChanged()
   QComboBox* box = qobject_cast<QComboBox*>(
     this->FileWidget->cellWidget(sceneRow, FileFormatColumn));
   // Gray out all the nodes when saving scene as bundle
-  this->enableNodes(box->currentIndex() == 0);
+  QString extension = box->itemData(box->currentIndex()).toString();
+  this->enableNodes(extension == ".mrml" || extension == ".mrmlb");
 }
 
 //-----------------------------------------------------------------------------
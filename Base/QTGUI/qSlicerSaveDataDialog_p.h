@@ -56,6 +56,7 @@ protected slots:
   void formatChanged();
   bool saveScene();
   bool saveNodes();
+  void onFileSaved(int fileIndex, bool saved);
   QFileInfo sceneFile()const; // ### Slicer 4.4: Move as protected
   void showMoreColumns(bool);
   void updateSize();
@@ -116,6 +117,9 @@ protected:
   vtkMRMLScene* MRMLScene;
   QString MRMLSceneRootDirectoryBeforeSaving;
   QString LastMRMLSceneFileFormat;
+  /// Files being saved by saveNodes()
+  QList<qSlicerIO::IOProperties> FilesToSave;
+  bool SavingCanceled;
 
   friend class qSlicerFileNameItemDelegate;
 };
@@ -0,0 +1,201 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkCacheManager.h"
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkNew.h>
+
+// VTKSYS includes
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <cmath>
+#include <fstream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+std::string WriteFile(const std::string& dir, const char* name, int seed)
+{
+  std::string fileName = dir + "/" + name;
+  std::ofstream file(fileName.c_str(), std::ios::out | std::ios::binary);
+  for (int i = 0; i < 800000; ++i)
+    {
+    file.put(static_cast<char>((i * seed) % 251));
+    }
+  return fileName;
+}
+
+//----------------------------------------------------------------------------
+bool CheckCacheSize(vtkCacheManager* cacheManager, float expectedSize, int line)
+{
+  if (fabs(cacheManager->GetCurrentCacheSize() - expectedSize) > 1e-3)
+    {
+    std::cerr << "Line " << line << " - Wrong cache size: "
+              << cacheManager->GetCurrentCacheSize() << " MB instead of "
+              << expectedSize << " MB" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkCacheManagerTest1(int argc, char * argv[])
+{
+  if (argc != 2)
+    {
+    std::cerr << "Missing parameters !\n"
+              << "Usage: " << argv[0] << " /path/to/temp"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::string cacheDir = std::string(argv[1]) + "/vtkCacheManagerTest1";
+  vtksys::SystemTools::RemoveADirectory(cacheDir.c_str());
+
+  std::string fileA, fileB, fileC;
+  {
+  vtkNew<vtkCacheManager> cacheManager;
+  EXERCISE_BASIC_OBJECT_METHODS(cacheManager.GetPointer());
+
+  cacheManager->SetRemoteCacheDirectory(cacheDir.c_str());
+  // Evict down to 3 - 1 = 2 MB
+  cacheManager->SetRemoteCacheLimit(3);
+  cacheManager->SetRemoteCacheFreeBufferSize(1);
+  if (!CheckCacheSize(cacheManager.GetPointer(), 0.f, __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+
+  fileA = WriteFile(cacheDir, "a.nrrd", 3);
+  fileB = WriteFile(cacheDir, "b.nrrd", 5);
+  fileC = WriteFile(cacheDir, "c.nrrd", 7);
+  if (cacheManager->AddToCache(fileA.c_str(), "http://host/a.nrrd") != fileA ||
+      cacheManager->AddToCache(fileB.c_str(), "http://host/b.nrrd") != fileB ||
+      cacheManager->AddToCache(fileC.c_str(), "http://host/c.nrrd") != fileC)
+    {
+    std::cerr << "Line " << __LINE__ << " - AddToCache failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!CheckCacheSize(cacheManager.GetPointer(), 2.4f, __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // b is now the least recently used file
+  cacheManager->TouchCachedFile(fileA.c_str());
+  if (cacheManager->EvictLeastRecentlyUsedFiles() != 1 ||
+      vtksys::SystemTools::FileExists(fileB.c_str()) ||
+      !vtksys::SystemTools::FileExists(fileA.c_str()) ||
+      !vtksys::SystemTools::FileExists(fileC.c_str()) ||
+      !CheckCacheSize(cacheManager.GetPointer(), 1.6f, __LINE__))
+    {
+    std::cerr << "Line " << __LINE__ << " - EvictLeastRecentlyUsedFiles failed"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Same content as c under another URI
+  std::string fileD = WriteFile(cacheDir, "d.nrrd", 7);
+  if (cacheManager->AddToCache(fileD.c_str(), "http://mirror/d.nrrd") != fileC ||
+      vtksys::SystemTools::FileExists(fileD.c_str()) ||
+      !CheckCacheSize(cacheManager.GetPointer(), 1.6f, __LINE__))
+    {
+    std::cerr << "Line " << __LINE__ << " - Duplicate not detected" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const char* mappedFile = cacheManager->GetFilenameFromURI("http://mirror/d.nrrd");
+  if (!mappedFile || fileC != mappedFile)
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong file for duplicate URI: "
+              << (mappedFile ? mappedFile : "(null)") << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // File copied in the cache directory without the cache manager
+  WriteFile(cacheDir, "e.nrrd", 11);
+  cacheManager->UpdateCacheInformation();
+  if (!CheckCacheSize(cacheManager.GetPointer(), 2.4f, __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+  vtksys::SystemTools::RemoveFile((cacheDir + "/e.nrrd").c_str());
+  cacheManager->UpdateCacheInformation();
+
+  // Downloads in progress are not indexed
+  std::string partialFile = WriteFile(cacheDir, "f.nrrd.part", 13);
+  cacheManager->UpdateCacheInformation();
+  if (cacheManager->AddToCache(partialFile.c_str(), "http://host/f.nrrd") != partialFile ||
+      !CheckCacheSize(cacheManager.GetPointer(), 1.6f, __LINE__))
+    {
+    std::cerr << "Line " << __LINE__ << " - Partial download indexed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  vtksys::SystemTools::RemoveFile(partialFile.c_str());
+
+  // Deleting a file updates the index without rescanning the directory
+  std::string fileG = WriteFile(cacheDir, "g.nrrd", 17);
+  cacheManager->AddToCache(fileG.c_str(), "http://host/g.nrrd");
+  if (!CheckCacheSize(cacheManager.GetPointer(), 2.4f, __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+  cacheManager->DeleteFromCache("g.nrrd");
+  if (vtksys::SystemTools::FileExists(fileG.c_str()) ||
+      !CheckCacheSize(cacheManager.GetPointer(), 1.6f, __LINE__))
+    {
+    std::cerr << "Line " << __LINE__ << " - DeleteFromCache failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  }
+
+  // The index is persistent
+  {
+  vtkNew<vtkCacheManager> cacheManager;
+  cacheManager->SetRemoteCacheDirectory(cacheDir.c_str());
+  if (!CheckCacheSize(cacheManager.GetPointer(), 1.6f, __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+  const char* mappedFile = cacheManager->GetFilenameFromURI("http://mirror/d.nrrd");
+  if (!mappedFile || fileC != mappedFile)
+    {
+    std::cerr << "Line " << __LINE__ << " - Duplicate URI not restored" << std::endl;
+    return EXIT_FAILURE;
+    }
+  // a was used before c
+  cacheManager->SetRemoteCacheLimit(2);
+  cacheManager->SetRemoteCacheFreeBufferSize(1);
+  if (cacheManager->EvictLeastRecentlyUsedFiles() != 1 ||
+      vtksys::SystemTools::FileExists(fileA.c_str()) ||
+      !vtksys::SystemTools::FileExists(fileC.c_str()))
+    {
+    std::cerr << "Line " << __LINE__ << " - Access order not restored" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (!cacheManager->ClearCache() ||
+      !CheckCacheSize(cacheManager.GetPointer(), 0.f, __LINE__) ||
+      cacheManager->GetFileFromURIMap("http://mirror/d.nrrd") != NULL)
+    {
+    std::cerr << "Line " << __LINE__ << " - ClearCache failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
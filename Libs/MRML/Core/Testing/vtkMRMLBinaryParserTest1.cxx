@@ -0,0 +1,493 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLBinaryParser.h"
+#include "vtkMRMLColorTableNode.h"
+#include "vtkMRMLLinearTransformNode.h"
+#include "vtkMRMLModelDisplayNode.h"
+#include "vtkMRMLModelHierarchyNode.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLParser.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLSceneViewNode.h"
+#include "vtkMRMLViewNode.h"
+#include "vtkTagTable.h"
+
+// VTK includes
+#include <vtkCollection.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkTimerLog.h>
+
+// VTKsys includes
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+// Transformed models, each with a display node and a hierarchy node, and a
+// scene view that contains a copy of all of them.
+void PopulateScene(vtkMRMLScene* scene, int numberOfModels)
+{
+  vtkNew<vtkMRMLModelHierarchyNode> rootHierarchy;
+  rootHierarchy->SetName("Models");
+  scene->AddNode(rootHierarchy.GetPointer());
+  for (int i = 0; i < numberOfModels; ++i)
+    {
+    std::stringstream name;
+    name << "Model" << i;
+
+    vtkNew<vtkMRMLLinearTransformNode> transform;
+    vtkNew<vtkMatrix4x4> matrix;
+    matrix->SetElement(0, 3, i / 3.);
+    transform->SetMatrixTransformToParent(matrix.GetPointer());
+    scene->AddNode(transform.GetPointer());
+
+    vtkNew<vtkMRMLModelDisplayNode> display;
+    display->SetColor(i / double(numberOfModels), 0.5, 1.);
+    scene->AddNode(display.GetPointer());
+
+    vtkNew<vtkMRMLModelNode> model;
+    model->SetName(name.str().c_str());
+    model->SetDescription("Model with \t tab");
+    model->SetAttribute("Index", name.str().c_str());
+    scene->AddNode(model.GetPointer());
+    model->SetAndObserveDisplayNodeID(display->GetID());
+    model->SetAndObserveTransformNodeID(transform->GetID());
+
+    vtkNew<vtkMRMLModelHierarchyNode> hierarchy;
+    scene->AddNode(hierarchy.GetPointer());
+    hierarchy->SetParentNodeID(rootHierarchy->GetID());
+    hierarchy->SetDisplayableNodeID(model->GetID());
+    }
+
+  vtkNew<vtkMRMLSceneViewNode> sceneView;
+  sceneView->SetName("View");
+  scene->AddNode(sceneView.GetPointer());
+  sceneView->StoreScene();
+}
+
+//---------------------------------------------------------------------------
+// Time to parse the file into nodes, without adding them into the scene
+double ParseTime(vtkMRMLParser* parser, vtkMRMLScene* scene, const std::string& fileName)
+{
+  vtkNew<vtkCollection> nodes;
+  parser->SetMRMLScene(scene);
+  parser->SetNodeCollection(nodes.GetPointer());
+  parser->SetFileName(fileName.c_str());
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  int res = parser->Parse();
+  timer->StopTimer();
+  return res ? timer->GetElapsedTime() : -1.;
+}
+
+//---------------------------------------------------------------------------
+std::string SceneToXML(vtkMRMLScene* scene)
+{
+  scene->SetSaveToXMLString(1);
+  scene->Commit();
+  scene->SetSaveToXMLString(0);
+  return scene->GetSceneXMLString();
+}
+
+//---------------------------------------------------------------------------
+std::string NodeToXML(vtkMRMLNode* node)
+{
+  std::stringstream xml;
+  node->WriteXML(xml, 0);
+  return xml.str();
+}
+
+//---------------------------------------------------------------------------
+// Set a value different from the default to every attribute written by the
+// binary hooks (vtkMRMLNode::WriteBinary()) of the node classes.
+void SetNodeAttributes(vtkMRMLNode* node, const char* name)
+{
+  node->SetName(name);
+  node->SetDescription("Description with \t tab, & and \"quotes\"");
+  node->SetHideFromEditors(!node->GetHideFromEditors());
+  node->SetSelectable(0);
+  node->SetSelected(1);
+  node->SetAttribute("Attribute1", "Value 1");
+  node->SetAttribute("Attribute2", "");
+}
+
+//---------------------------------------------------------------------------
+void SetDisplayNodeAttributes(vtkMRMLDisplayNode* display,
+                              const char* colorNodeID, const char* viewNodeID)
+{
+  display->SetColor(1. / 3., 0.25, 0.75);
+  display->SetEdgeColor(0.1, 0.2, 0.3);
+  display->SetSelectedColor(0.4, 0.5, 0.6);
+  display->SetSelectedAmbient(0.7);
+  display->SetAmbient(0.2);
+  display->SetDiffuse(0.8);
+  display->SetSelectedSpecular(0.9);
+  display->SetSpecular(0.3);
+  display->SetPower(2.5);
+  display->SetOpacity(1. / 7.);
+  display->SetPointSize(3.);
+  display->SetLineWidth(4.);
+  display->SetRepresentation(vtkMRMLDisplayNode::WireframeRepresentation);
+  display->SetLighting(0);
+  display->SetInterpolation(vtkMRMLDisplayNode::PhongInterpolation);
+  display->SetShading(0);
+  display->SetVisibility(0);
+  display->SetEdgeVisibility(1);
+  display->SetClipping(1);
+  display->SetSliceIntersectionVisibility(1);
+  display->SetSliceIntersectionThickness(3);
+  display->SetFrontfaceCulling(1);
+  display->SetBackfaceCulling(0);
+  display->SetScalarVisibility(1);
+  display->SetVectorVisibility(1);
+  display->SetTensorVisibility(1);
+  display->SetInterpolateTexture(1);
+  display->SetScalarRangeFlag(vtkMRMLDisplayNode::UseDisplayNodeScalarRange);
+  display->SetAutoScalarRange(0);
+  display->SetScalarRange(-1. / 3., 250.5);
+  display->SetAndObserveColorNodeID(colorNodeID);
+  display->SetActiveScalarName("Normals");
+  display->AddViewNodeID(viewNodeID);
+}
+
+//---------------------------------------------------------------------------
+// Write a scene with non default values for all the attributes of the nodes
+// read with vtkMRMLNode::ReadBinary(), and check that the binary scene
+// restores them exactly.
+bool TestAttributesRoundTrip(const std::string& tempDir)
+{
+  const std::string fileName = tempDir + "/vtkMRMLBinaryParserTest1-attributes.mrmlb";
+
+  vtkNew<vtkMRMLScene> scene;
+
+  // Nodes read from XML attributes, referenced by the hooked nodes
+  vtkNew<vtkMRMLColorTableNode> colorNode;
+  colorNode->SetTypeToGrey();
+  scene->AddNode(colorNode.GetPointer());
+  vtkNew<vtkMRMLViewNode> viewNode;
+  scene->AddNode(viewNode.GetPointer());
+
+  vtkNew<vtkMRMLLinearTransformNode> transform;
+  SetNodeAttributes(transform.GetPointer(), "Transform");
+  vtkNew<vtkMatrix4x4> matrix;
+  for (int i = 0; i < 3; ++i)
+    {
+    for (int j = 0; j < 4; ++j)
+      {
+      matrix->SetElement(i, j, 1. / (4 * i + j + 3));
+      }
+    }
+  transform->SetMatrixTransformToParent(matrix.GetPointer());
+  scene->AddNode(transform.GetPointer());
+
+  vtkNew<vtkMRMLModelDisplayNode> display;
+  SetNodeAttributes(display.GetPointer(), "Display");
+  SetDisplayNodeAttributes(display.GetPointer(), colorNode->GetID(), viewNode->GetID());
+  scene->AddNode(display.GetPointer());
+
+  vtkNew<vtkMRMLModelNode> model;
+  SetNodeAttributes(model.GetPointer(), "Model");
+  model->GetUserTagTable()->AddOrUpdateTag("Keyword", "Tag value", 0);
+  scene->AddNode(model.GetPointer());
+  model->SetAndObserveDisplayNodeID(display->GetID());
+  model->SetAndObserveTransformNodeID(transform->GetID());
+  model->AddNodeReferenceID("custom", colorNode->GetID());
+
+  vtkNew<vtkMRMLHierarchyNode> parentHierarchy;
+  SetNodeAttributes(parentHierarchy.GetPointer(), "Parent");
+  parentHierarchy->SetAllowMultipleChildren(0);
+  scene->AddNode(parentHierarchy.GetPointer());
+
+  vtkNew<vtkMRMLHierarchyNode> hierarchy;
+  SetNodeAttributes(hierarchy.GetPointer(), "Hierarchy");
+  scene->AddNode(hierarchy.GetPointer());
+  hierarchy->SetParentNodeID(parentHierarchy->GetID());
+  hierarchy->SetAssociatedNodeID(transform->GetID());
+  hierarchy->SetSortingValue(1. / 9.);
+
+  vtkNew<vtkMRMLModelDisplayNode> hierarchyDisplay;
+  SetNodeAttributes(hierarchyDisplay.GetPointer(), "HierarchyDisplay");
+  scene->AddNode(hierarchyDisplay.GetPointer());
+  vtkNew<vtkMRMLModelHierarchyNode> modelHierarchy;
+  SetNodeAttributes(modelHierarchy.GetPointer(), "ModelHierarchy");
+  scene->AddNode(modelHierarchy.GetPointer());
+  modelHierarchy->SetParentNodeID(hierarchy->GetID());
+  modelHierarchy->SetDisplayableNodeID(model->GetID());
+  modelHierarchy->SetAndObserveDisplayNodeID(hierarchyDisplay->GetID());
+  modelHierarchy->SetExpanded(0);
+  modelHierarchy->SetSortingValue(-2.5);
+
+  if (!scene->Commit(fileName.c_str()))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to write " << fileName << std::endl;
+    return false;
+    }
+  vtkNew<vtkMRMLScene> binaryScene;
+  binaryScene->SetURL(fileName.c_str());
+  if (!binaryScene->Connect())
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to read " << fileName << std::endl;
+    return false;
+    }
+
+  // All the attributes are read back
+  vtkMRMLNode* hookedNodes[] = {
+    transform.GetPointer(), display.GetPointer(), model.GetPointer(),
+    parentHierarchy.GetPointer(), hierarchy.GetPointer(),
+    hierarchyDisplay.GetPointer(), modelHierarchy.GetPointer()};
+  for (size_t i = 0; i < sizeof(hookedNodes) / sizeof(vtkMRMLNode*); ++i)
+    {
+    vtkMRMLNode* node = hookedNodes[i];
+    vtkMRMLNode* readNode = binaryScene->GetNodeByID(node->GetID());
+    if (!readNode || strcmp(readNode->GetClassName(), node->GetClassName()) != 0 ||
+        !node->GetBinaryClassName() ||
+        strcmp(node->GetBinaryClassName(), node->GetClassName()) != 0)
+      {
+      std::cerr << "Line " << __LINE__ << " - " << node->GetID()
+                << " not read with ReadBinary()" << std::endl;
+      return false;
+      }
+    if (NodeToXML(readNode) != NodeToXML(node))
+      {
+      std::cerr << "Line " << __LINE__ << " - " << node->GetID()
+                << " attributes differ:\n" << NodeToXML(readNode)
+                << "\ninstead of:\n" << NodeToXML(node) << std::endl;
+      return false;
+      }
+    if (readNode->GetSelected() != 1 || readNode->GetSelectable() != 0 ||
+        readNode->GetHideFromEditors() != node->GetHideFromEditors() ||
+        !readNode->GetAttribute("Attribute2") ||
+        strcmp(readNode->GetAttribute("Attribute1"), "Value 1") != 0)
+      {
+      std::cerr << "Line " << __LINE__ << " - " << node->GetID()
+                << " node attributes not read" << std::endl;
+      return false;
+      }
+    }
+
+  // Values written as doubles are not rounded
+  vtkMRMLModelDisplayNode* readDisplay = vtkMRMLModelDisplayNode::SafeDownCast(
+    binaryScene->GetNodeByID(display->GetID()));
+  vtkMRMLHierarchyNode* readHierarchy = vtkMRMLHierarchyNode::SafeDownCast(
+    binaryScene->GetNodeByID(hierarchy->GetID()));
+  vtkMRMLLinearTransformNode* readTransform = vtkMRMLLinearTransformNode::SafeDownCast(
+    binaryScene->GetNodeByID(transform->GetID()));
+  vtkNew<vtkMatrix4x4> readMatrix;
+  readTransform->GetMatrixTransformToParent(readMatrix.GetPointer());
+  bool sameMatrix = true;
+  for (int i = 0; i < 4; ++i)
+    {
+    for (int j = 0; j < 4; ++j)
+      {
+      sameMatrix = sameMatrix &&
+        readMatrix->GetElement(i, j) == matrix->GetElement(i, j);
+      }
+    }
+  if (!sameMatrix ||
+      readDisplay->GetColor()[0] != 1. / 3. ||
+      readDisplay->GetOpacity() != 1. / 7. ||
+      readDisplay->GetScalarRange()[0] != -1. / 3. ||
+      readHierarchy->GetSortingValue() != 1. / 9.)
+    {
+    std::cerr << "Line " << __LINE__ << " - Doubles not read exactly" << std::endl;
+    return false;
+    }
+
+  // Storable node user tags
+  vtkMRMLModelNode* readModel = vtkMRMLModelNode::SafeDownCast(
+    binaryScene->GetNodeByID(model->GetID()));
+  const char* tagValue = readModel->GetUserTagTable()->GetTagValue("Keyword");
+  if (!tagValue || strcmp(tagValue, "Tag value") != 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - User tags not read" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLBinaryParserTest1(int argc, char * argv [])
+{
+  if (argc != 2)
+    {
+    std::cerr << "Missing parameters !\n"
+              << "Usage: " << argv[0] << " /path/to/temp"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string tempDir = argv[1];
+  const std::string xmlFileName = tempDir + "/vtkMRMLBinaryParserTest1.mrml";
+  const std::string binaryFileName = tempDir + "/vtkMRMLBinaryParserTest1.mrmlb";
+
+  const int numberOfModels = 500;
+  vtkNew<vtkMRMLScene> scene;
+  PopulateScene(scene.GetPointer(), numberOfModels);
+  const int numberOfNodes = scene->GetNumberOfNodes();
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  if (!scene->Commit(xmlFileName.c_str()))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to write "
+              << xmlFileName << std::endl;
+    return EXIT_FAILURE;
+    }
+  timer->StopTimer();
+  const double xmlSaveTime = timer->GetElapsedTime();
+
+  timer->StartTimer();
+  if (!scene->Commit(binaryFileName.c_str()))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to write "
+              << binaryFileName << std::endl;
+    return EXIT_FAILURE;
+    }
+  timer->StopTimer();
+  const double binarySaveTime = timer->GetElapsedTime();
+
+  if (!vtkMRMLBinaryParser::IsBinaryScene(binaryFileName.c_str()) ||
+      vtkMRMLBinaryParser::IsBinaryScene(xmlFileName.c_str()))
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong file format" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkMRMLScene> xmlScene;
+  xmlScene->SetURL(xmlFileName.c_str());
+  timer->StartTimer();
+  xmlScene->Connect();
+  timer->StopTimer();
+  const double xmlLoadTime = timer->GetElapsedTime();
+
+  vtkNew<vtkMRMLScene> binaryScene;
+  binaryScene->SetURL(binaryFileName.c_str());
+  timer->StartTimer();
+  binaryScene->Connect();
+  timer->StopTimer();
+  const double binaryLoadTime = timer->GetElapsedTime();
+
+  if (xmlScene->GetNumberOfNodes() < numberOfNodes ||
+      binaryScene->GetNumberOfNodes() != xmlScene->GetNumberOfNodes())
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong number of nodes: "
+              << xmlScene->GetNumberOfNodes() << " (XML) and "
+              << binaryScene->GetNumberOfNodes() << " (binary) instead of "
+              << numberOfNodes << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Both scenes must have been read the same way
+  const std::string xmlSceneXML = SceneToXML(xmlScene.GetPointer());
+  const std::string binarySceneXML = SceneToXML(binaryScene.GetPointer());
+  if (xmlSceneXML != binarySceneXML)
+    {
+    std::cerr << "Line " << __LINE__ << " - Binary scene differs from XML scene:\n"
+              << binarySceneXML << std::endl;
+    return EXIT_FAILURE;
+    }
+  vtkMRMLSceneViewNode* xmlSceneView = vtkMRMLSceneViewNode::SafeDownCast(
+    xmlScene->GetFirstNodeByName("View"));
+  vtkMRMLSceneViewNode* binarySceneView = vtkMRMLSceneViewNode::SafeDownCast(
+    binaryScene->GetFirstNodeByName("View"));
+  if (!xmlSceneView || !binarySceneView ||
+      binarySceneView->GetStoredScene()->GetNumberOfNodes() < numberOfModels ||
+      binarySceneView->GetStoredScene()->GetNumberOfNodes() !=
+        xmlSceneView->GetStoredScene()->GetNumberOfNodes())
+    {
+    std::cerr << "Line " << __LINE__ << " - Nested nodes not restored" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Values written with WriteBinary() are not rounded by a text conversion
+  vtkMRMLLinearTransformNode* binaryTransform = vtkMRMLLinearTransformNode::SafeDownCast(
+    binaryScene->GetNthNodeByClass(numberOfModels - 1, "vtkMRMLLinearTransformNode"));
+  vtkNew<vtkMatrix4x4> binaryMatrix;
+  if (binaryTransform)
+    {
+    binaryTransform->GetMatrixTransformToParent(binaryMatrix.GetPointer());
+    }
+  if (!binaryTransform ||
+      binaryMatrix->GetElement(0, 3) != (numberOfModels - 1) / 3.)
+    {
+    std::cerr << "Line " << __LINE__ << " - Transform not read exactly: "
+              << binaryMatrix->GetElement(0, 3) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Corrupted files are rejected
+  vtkNew<vtkMRMLBinaryParser> parser;
+  parser->SetMRMLScene(binaryScene.GetPointer());
+  const char truncated[] = "MRMLBIN1\x01\x00\x00\x00";
+  if (parser->Parse(truncated, sizeof(truncated) - 1) != 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Truncated scene parsed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (!TestAttributesRoundTrip(tempDir))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // The binary scene is smaller. The parse speedup is only measured: timings
+  // are not reliable enough on the test machines to be asserted.
+  vtkNew<vtkMRMLParser> xmlParser;
+  const double xmlParseTime =
+    ParseTime(xmlParser.GetPointer(), xmlScene.GetPointer(), xmlFileName);
+  vtkNew<vtkMRMLBinaryParser> binaryParser;
+  const double binaryParseTime =
+    ParseTime(binaryParser.GetPointer(), binaryScene.GetPointer(), binaryFileName);
+  const unsigned long xmlSize = vtksys::SystemTools::FileLength(xmlFileName.c_str());
+  const unsigned long binarySize = vtksys::SystemTools::FileLength(binaryFileName.c_str());
+
+  std::cout << numberOfNodes << " nodes\n"
+            << "  XML:    save " << xmlSaveTime << "s, load " << xmlLoadTime
+            << "s, parse " << xmlParseTime << "s, " << xmlSize << " bytes\n"
+            << "  binary: save " << binarySaveTime << "s, load " << binaryLoadTime
+            << "s, parse " << binaryParseTime << "s, " << binarySize << " bytes"
+            << std::endl;
+  const double parseSpeedup = binaryParseTime > 0. ? xmlParseTime / binaryParseTime : 0.;
+  std::cout << "<DartMeasurement name=\"vtkMRMLBinaryParser-ParseSpeedup\" "
+            << "type=\"numeric/double\">" << parseSpeedup << "</DartMeasurement>\n"
+            << "<DartMeasurement name=\"vtkMRMLBinaryParser-LoadSpeedup\" "
+            << "type=\"numeric/double\">"
+            << (binaryLoadTime > 0. ? xmlLoadTime / binaryLoadTime : 0.)
+            << "</DartMeasurement>\n"
+            << "<DartMeasurement name=\"vtkMRMLBinaryParser-SaveSpeedup\" "
+            << "type=\"numeric/double\">"
+            << (binarySaveTime > 0. ? xmlSaveTime / binarySaveTime : 0.)
+            << "</DartMeasurement>" << std::endl;
+
+  if (xmlParseTime < 0. || binaryParseTime < 0.)
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to parse the scene files" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (binarySize >= xmlSize)
+    {
+    std::cerr << "Line " << __LINE__ << " - Binary scene not smaller: "
+              << binarySize << " bytes instead of " << xmlSize << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
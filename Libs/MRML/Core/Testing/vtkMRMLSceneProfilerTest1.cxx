@@ -0,0 +1,114 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLScene.h"
+#include "vtkMRMLSceneProfiler.h"
+
+// VTK includes
+#include <vtkNew.h>
+
+// STD includes
+#include <cstring>
+#include <sstream>
+
+//---------------------------------------------------------------------------
+int vtkMRMLSceneProfilerTest1(int vtkNotUsed(argc), char * vtkNotUsed(argv) [])
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLSceneProfiler> profiler;
+  scene->SetProfiler(profiler.GetPointer());
+
+  const char sceneXML[] =
+    "<MRML  version=\"18916\" userTags=\"\">"
+    "  <Model id=\"vtkMRMLModelNode1\" name=\"Model1\" displayNodeRef=\"vtkMRMLModelDisplayNode1\" ></Model>"
+    "  <ModelDisplay id=\"vtkMRMLModelDisplayNode1\" name=\"Display1\" ></ModelDisplay>"
+    "  <Model id=\"vtkMRMLModelNode2\" name=\"Model2\" ></Model>"
+    "</MRML>"
+    ;
+  scene->SetSceneXMLString(sceneXML);
+  scene->SetLoadFromXMLString(1);
+  scene->Connect();
+
+  if (scene->GetNumberOfNodes() != 3)
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to load the scene: "
+              << scene->GetNumberOfNodes() << " nodes" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The first event contains all the others
+  const int numberOfEvents = profiler->GetNumberOfEvents();
+  if (numberOfEvents < 10 ||
+      strcmp(profiler->GetEventName(0), "Connect") != 0 ||
+      profiler->GetEventParent(0) != -1 ||
+      profiler->GetEventDuration(0) < profiler->GetEventSelfDuration(0))
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong first event: "
+              << numberOfEvents << " events" << std::endl;
+    return EXIT_FAILURE;
+    }
+  int createdModels = 0;
+  int readModels = 0;
+  int updatedNodes = 0;
+  for (int i = 1; i < numberOfEvents; ++i)
+    {
+    const int parent = profiler->GetEventParent(i);
+    if (parent < 0 || parent >= i ||
+        profiler->GetEventStartTime(i) < profiler->GetEventStartTime(parent) ||
+        profiler->GetEventDuration(i) > profiler->GetEventDuration(parent))
+      {
+      std::cerr << "Line " << __LINE__ << " - Event " << i << " "
+                << profiler->GetEventName(i) << " is not nested into "
+                << parent << std::endl;
+      return EXIT_FAILURE;
+      }
+    const std::string category = profiler->GetEventCategory(i);
+    const std::string name = profiler->GetEventName(i);
+    createdModels += (category == "CreateNode" && name == "vtkMRMLModelNode");
+    readModels += (category == "ReadXMLAttributes" && name == "vtkMRMLModelNode");
+    updatedNodes += (category == "UpdateScene");
+    }
+  if (createdModels != 2 || readModels != 2 || updatedNodes != 3)
+    {
+    std::cerr << "Line " << __LINE__ << " - Missing node events: "
+              << createdModels << " created models, "
+              << readModels << " read models, "
+              << updatedNodes << " updated nodes" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (profiler->GetTotalSelfDuration(0, 0) > profiler->GetEventDuration(0) + 1e-6)
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong total duration" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::stringstream trace;
+  profiler->WriteChromeTrace(trace);
+  if (trace.str().find("{\"traceEvents\":[") != 0 ||
+      trace.str().find("\"cat\":\"ReadXMLAttributes\"") == std::string::npos)
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong trace: " << trace.str() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Nothing is recorded without profiler
+  profiler->Clear();
+  scene->SetProfiler(0);
+  scene->Connect();
+  if (profiler->GetNumberOfEvents() != 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Events recorded without profiler" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
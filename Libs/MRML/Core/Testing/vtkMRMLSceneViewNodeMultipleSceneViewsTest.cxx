@@ -0,0 +1,284 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLScalarVolumeDisplayNode.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLSceneViewNode.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+
+namespace
+{
+
+bool storeAndRestore();
+bool unshare();
+bool writeAndRead();
+
+//---------------------------------------------------------------------------
+vtkMRMLScalarVolumeNode* storedVolume(vtkMRMLSceneViewNode* sceneViewNode)
+{
+  return vtkMRMLScalarVolumeNode::SafeDownCast(
+    sceneViewNode->GetStoredScene()->GetNodeByID("vtkMRMLScalarVolumeNode1"));
+}
+
+//---------------------------------------------------------------------------
+void populateScene(vtkMRMLScene* scene)
+{
+  vtkNew<vtkMRMLSceneViewNode> sceneViewtoRegister;
+  scene->RegisterNodeClass(sceneViewtoRegister.GetPointer());
+
+  vtkNew<vtkMRMLScalarVolumeDisplayNode> displayNode;
+  scene->AddNode(displayNode.GetPointer());
+
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  volumeNode->SetName("Volume");
+  volumeNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+  vtkNew<vtkImageData> imageData;
+  volumeNode->SetAndObserveImageData(imageData.GetPointer());
+  scene->AddNode(volumeNode.GetPointer());
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLSceneViewNodeMultipleSceneViewsTest(int vtkNotUsed(argc),
+                                               char * vtkNotUsed(argv)[] )
+{
+  bool res = true;
+  res = storeAndRestore() && res;
+  res = unshare() && res;
+  res = writeAndRead() && res;
+  return res ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+bool storeAndRestore()
+{
+  vtkNew<vtkMRMLScene> scene;
+  populateScene(scene.GetPointer());
+  vtkMRMLScalarVolumeNode* volumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(
+    scene->GetNodeByID("vtkMRMLScalarVolumeNode1"));
+
+  vtkNew<vtkMRMLSceneViewNode> sceneViewNode1;
+  scene->AddNode(sceneViewNode1.GetPointer());
+  sceneViewNode1->StoreScene();
+  vtkNew<vtkMRMLSceneViewNode> sceneViewNode2;
+  scene->AddNode(sceneViewNode2.GetPointer());
+  sceneViewNode2->StoreScene();
+
+  // Unchanged nodes are shared between the scene views
+  vtkMRMLScalarVolumeNode* storedVolume1 = storedVolume(sceneViewNode1.GetPointer());
+  vtkMRMLScalarVolumeNode* storedVolume2 = storedVolume(sceneViewNode2.GetPointer());
+  if (!storedVolume1 || storedVolume1 != storedVolume2 ||
+      storedVolume1->GetImageData() != volumeNode->GetImageData())
+    {
+    std::cerr << __LINE__ << ": StoreScene failed" << std::endl;
+    return false;
+    }
+
+  // Unmodified nodes are not copied again
+  sceneViewNode1->StoreScene();
+  if (storedVolume(sceneViewNode1.GetPointer()) != storedVolume1)
+    {
+    std::cerr << __LINE__ << ": StoreScene copied an unmodified node" << std::endl;
+    return false;
+    }
+
+  // Modified nodes are copied again, other scene views are not affected
+  volumeNode->SetName("Volume2");
+  sceneViewNode2->StoreScene();
+  storedVolume2 = storedVolume(sceneViewNode2.GetPointer());
+  if (!storedVolume2 || storedVolume2 == storedVolume1 ||
+      strcmp(storedVolume2->GetName(), "Volume2") != 0 ||
+      strcmp(storedVolume1->GetName(), "Volume") != 0 ||
+      storedVolume1->GetScene() != sceneViewNode1->GetStoredScene() ||
+      storedVolume2->GetScene() != sceneViewNode2->GetStoredScene())
+    {
+    std::cerr << __LINE__ << ": StoreScene failed to store a modified node"
+              << std::endl;
+    return false;
+    }
+
+  // Editing a stored node makes it out of date
+  storedVolume1->SetName("EditedVolume");
+  volumeNode->SetName("Volume");
+  sceneViewNode1->StoreScene();
+  if (!storedVolume(sceneViewNode1.GetPointer()) ||
+      strcmp(storedVolume(sceneViewNode1.GetPointer())->GetName(), "Volume") != 0)
+    {
+    std::cerr << __LINE__ << ": StoreScene kept an edited stored node"
+              << std::endl;
+    return false;
+    }
+
+  // Removing a scene view does not affect the others
+  scene->RemoveNode(sceneViewNode1.GetPointer());
+  sceneViewNode2->RestoreScene();
+  if (strcmp(volumeNode->GetName(), "Volume2") != 0 ||
+      storedVolume2->GetScene() != sceneViewNode2->GetStoredScene())
+    {
+    std::cerr << __LINE__ << ": RestoreScene failed" << std::endl;
+    return false;
+    }
+
+  // Nothing changed: restoring again leaves the node untouched
+  const unsigned long restoredTime = volumeNode->GetMTime();
+  sceneViewNode2->RestoreScene();
+  if (volumeNode->GetMTime() != restoredTime)
+    {
+    std::cerr << __LINE__ << ": RestoreScene modified an unchanged node"
+              << std::endl;
+    return false;
+    }
+
+  // A node modified after the restore is restored again
+  volumeNode->SetName("Volume3");
+  sceneViewNode2->RestoreScene();
+  if (strcmp(volumeNode->GetName(), "Volume2") != 0)
+    {
+    std::cerr << __LINE__ << ": RestoreScene failed to restore a modified node"
+              << std::endl;
+    return false;
+    }
+
+  // A node modified while its modified events are disabled keeps its MTime
+  // but is still stored and restored
+  volumeNode->DisableModifiedEventOn();
+  volumeNode->SetName("Volume4");
+  volumeNode->SetDisableModifiedEvent(0);
+  sceneViewNode2->StoreScene();
+  if (strcmp(storedVolume(sceneViewNode2.GetPointer())->GetName(), "Volume4") != 0)
+    {
+    std::cerr << __LINE__ << ": StoreScene missed a node with pending events"
+              << std::endl;
+    return false;
+    }
+  volumeNode->InvokePendingModifiedEvent();
+  sceneViewNode2->RestoreScene();
+  volumeNode->DisableModifiedEventOn();
+  volumeNode->SetName("Volume6");
+  volumeNode->SetDisableModifiedEvent(0);
+  sceneViewNode2->RestoreScene();
+  if (strcmp(volumeNode->GetName(), "Volume4") != 0)
+    {
+    std::cerr << __LINE__ << ": RestoreScene missed a node with pending events"
+              << std::endl;
+    return false;
+    }
+  volumeNode->InvokePendingModifiedEvent();
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool unshare()
+{
+  vtkNew<vtkMRMLScene> scene;
+  populateScene(scene.GetPointer());
+
+  vtkNew<vtkMRMLSceneViewNode> sceneViewNode1;
+  scene->AddNode(sceneViewNode1.GetPointer());
+  sceneViewNode1->StoreScene();
+  vtkNew<vtkMRMLSceneViewNode> sceneViewNode2;
+  scene->AddNode(sceneViewNode2.GetPointer());
+  sceneViewNode2->StoreScene();
+  vtkMRMLScalarVolumeNode* sharedVolume = storedVolume(sceneViewNode1.GetPointer());
+  if (!sharedVolume || storedVolume(sceneViewNode2.GetPointer()) != sharedVolume)
+    {
+    std::cerr << __LINE__ << ": Stored node not shared" << std::endl;
+    return false;
+    }
+
+  // Updating the stored nodes in place copies the shared ones first
+  sceneViewNode2->UpdateStoredScene();
+  vtkMRMLScalarVolumeNode* privateVolume = storedVolume(sceneViewNode2.GetPointer());
+  if (!privateVolume || privateVolume == sharedVolume ||
+      storedVolume(sceneViewNode1.GetPointer()) != sharedVolume ||
+      privateVolume->GetScene() != sceneViewNode2->GetStoredScene() ||
+      sharedVolume->GetScene() != sceneViewNode1->GetStoredScene())
+    {
+    std::cerr << __LINE__ << ": Shared stored node modified in place" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool writeAndRead()
+{
+  vtkNew<vtkMRMLScene> scene;
+  populateScene(scene.GetPointer());
+  vtkMRMLScalarVolumeNode* volumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(
+    scene->GetNodeByID("vtkMRMLScalarVolumeNode1"));
+
+  const char* names[3] = {"Volume", "Volume2", "Volume3"};
+  for (int i = 0; i < 3; ++i)
+    {
+    volumeNode->SetName(names[i]);
+    vtkNew<vtkMRMLSceneViewNode> sceneViewNode;
+    scene->AddNode(sceneViewNode.GetPointer());
+    sceneViewNode->StoreScene();
+    }
+  // Last scene view stored again without change
+  vtkMRMLSceneViewNode::SafeDownCast(
+    scene->GetNthNodeByClass(2, "vtkMRMLSceneViewNode"))->StoreScene();
+
+  scene->SetSaveToXMLString(1);
+  scene->Commit();
+  std::string xmlScene = scene->GetSceneXMLString();
+
+  vtkNew<vtkMRMLScene> scene2;
+  vtkNew<vtkMRMLSceneViewNode> sceneViewtoRegister;
+  scene2->RegisterNodeClass(sceneViewtoRegister.GetPointer());
+  scene2->SetLoadFromXMLString(1);
+  scene2->SetSceneXMLString(xmlScene);
+  scene2->Import();
+
+  if (scene2->GetNumberOfNodesByClass("vtkMRMLSceneViewNode") != 3)
+    {
+    std::cerr << __LINE__ << ": Import failed: "
+              << scene2->GetNumberOfNodesByClass("vtkMRMLSceneViewNode")
+              << " scene views instead of 3" << std::endl;
+    return false;
+    }
+  for (int i = 0; i < 3; ++i)
+    {
+    vtkMRMLSceneViewNode* sceneViewNode = vtkMRMLSceneViewNode::SafeDownCast(
+      scene2->GetNthNodeByClass(i, "vtkMRMLSceneViewNode"));
+    vtkMRMLScalarVolumeNode* readVolume = storedVolume(sceneViewNode);
+    if (!readVolume || strcmp(readVolume->GetName(), names[i]) != 0 ||
+        readVolume->GetScene() != sceneViewNode->GetStoredScene())
+      {
+      std::cerr << __LINE__ << ": Scene view " << i << " not read back"
+                << std::endl;
+      return false;
+      }
+    sceneViewNode->RestoreScene();
+    vtkMRMLNode* restoredVolume = scene2->GetNodeByID("vtkMRMLScalarVolumeNode1");
+    if (!restoredVolume || strcmp(restoredVolume->GetName(), names[i]) != 0)
+      {
+      std::cerr << __LINE__ << ": Scene view " << i << " not restored"
+                << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+} // end of anonymous namespace
@@ -10,10 +10,40 @@
 #include <vtkCallbackCommand.h>
 #include <vtkObjectFactory.h>
 
+// STD includes
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
 vtkStandardNewMacro ( vtkCacheManager );
 
 #define MB 1000000.0
 
+namespace
+{
+/// Name of the cache index, in the cache directory
+const char CacheIndexFileName[] = ".cacheindex";
+/// Suffix of the files being downloaded (see vtkHTTPHandler)
+const char PartialDownloadSuffix[] = ".part";
+
+//----------------------------------------------------------------------------
+bool vtkCacheManagerIsPartialDownload ( const std::string &fileName )
+{
+  const std::string::size_type suffixLength = sizeof(PartialDownloadSuffix) - 1;
+  return fileName.size() > suffixLength &&
+    fileName.compare ( fileName.size() - suffixLength, suffixLength,
+                       PartialDownloadSuffix ) == 0;
+}
+
+//----------------------------------------------------------------------------
+bool vtkCacheManagerCompareAccessTimes ( const std::pair< double, std::string > &a,
+                                         const std::pair< double, std::string > &b )
+{
+  return a.first < b.first;
+}
+}
+
 //----------------------------------------------------------------------------
 vtkCacheManager::vtkCacheManager()
 {
@@ -28,12 +58,18 @@ vtkCacheManager::vtkCacheManager()
   this->InsufficientFreeBufferNotificationFlag = 0;
   // this->EnableRemoteCacheOverwriting = 1;
   this->uriMap.clear();
+  this->CacheIndexSize = 0.;
+  this->CacheIndexModified = false;
 }
 
 
 //----------------------------------------------------------------------------
 vtkCacheManager::~vtkCacheManager()
 {
+  // last access times are only saved on exit
+  this->CacheIndexLock.Lock();
+  this->SaveCacheIndex();
+  this->CacheIndexLock.Unlock();
 
   this->MRMLScene = NULL;
   this->uriMap.clear();
@@ -56,14 +92,17 @@ const char* vtkCacheManager::GetFileFromURIMap (const char *uri )
 {
   std::string uriString (uri);
 
+  this->CacheIndexLock.Lock();
     //--- URI is first, local name is second
+    const char *fileName = NULL;
     std::map<std::string, std::string>::iterator iter = this->uriMap.find(uriString);
     if (iter != this->uriMap.end() )
       {
-      return iter->second.c_str();
+      fileName = iter->second.c_str();
       }
+  this->CacheIndexLock.Unlock();
 
-  return NULL;
+  return fileName;
 }
 
 
@@ -82,6 +121,7 @@ void vtkCacheManager::MapFileToURI ( const char *uri, const char *fname )
   std::map <std::string, std::string>::iterator iter;
   //--- see if it's already here and update if so.
 
+  this->CacheIndexLock.Lock();
     //--- URI is first, local name is second
   int added = 0;
   for (iter = this->uriMap.begin();
@@ -97,6 +137,10 @@ void vtkCacheManager::MapFileToURI ( const char *uri, const char *fname )
   if ( !added )
     {
     this->uriMap.insert (std::make_pair (remote, local ));
+    }
+  this->CacheIndexLock.Unlock();
+  if ( !added )
+    {
     this->Modified();
     }
 }
@@ -128,11 +172,16 @@ void vtkCacheManager::SetRemoteCacheDirectory (const char *dir )
     return;
     }
 
+  this->CacheIndexLock.Lock();
+  // save the index of the previous directory before switching
+  this->SaveCacheIndex();
   this->RemoteCacheDirectory = dirstring;
   if (!vtksys::SystemTools::FileExists(this->RemoteCacheDirectory.c_str()))
     {
     vtksys::SystemTools::MakeDirectory(this->RemoteCacheDirectory.c_str());
     }
+  this->LoadCacheIndex();
+  this->CacheIndexLock.Unlock();
   // scan files in cache, it calls Modified
   this->UpdateCacheInformation();
 }
@@ -254,6 +303,7 @@ void vtkCacheManager::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "RemoteCacheFreeBufferSize: " << this->GetRemoteCacheFreeBufferSize() << "\n";
   //os << indent << "EnableRemoteCacheOverwriting: " << this->GetEnableRemoteCacheOverwriting() << "\n";
   os << indent << "EnableForceRedownload: " << this->GetEnableForceRedownload() << "\n";
+  os << indent << "NumberOfIndexedFiles: " << this->CacheIndex.size() << "\n";
 }
 
 
@@ -288,7 +338,9 @@ int vtkCacheManager::GetCachedFileList ( const char *dirname )
       {
         {
         if (strcmp(dir.GetFile(static_cast<unsigned long>(fileNum)),".") &&
-            strcmp(dir.GetFile(static_cast<unsigned long>(fileNum)),".."))
+            strcmp(dir.GetFile(static_cast<unsigned long>(fileNum)),"..") &&
+            strcmp(dir.GetFile(static_cast<unsigned long>(fileNum)),CacheIndexFileName) &&
+            !vtkCacheManagerIsPartialDownload(dir.GetFile(static_cast<unsigned long>(fileNum))))
           {
           std::string fullName = dirname;
           //--- add backslash to end if not present.
@@ -410,6 +462,7 @@ const char* vtkCacheManager::GetFilenameFromURI ( const char *uri )
   const char *mapcheck = this->GetFileFromURIMap( uri );
   if ( mapcheck != NULL )
     {
+    this->TouchCachedFile ( mapcheck );
     return (mapcheck);
     }
 
@@ -500,6 +553,7 @@ const char* vtkCacheManager::GetFilenameFromURI ( const char *uri )
   returnString = cp1;
   do { *cp1++ = *cp2++; } while ( --n );
   vtkDebugMacro("GetFilenameFromURI: returning " << returnString);
+  this->TouchCachedFile ( returnString );
 
   return returnString;
 }
@@ -508,18 +562,210 @@ const char* vtkCacheManager::GetFilenameFromURI ( const char *uri )
 //----------------------------------------------------------------------------
 void vtkCacheManager::UpdateCacheInformation ( )
 {
-  //--- now recompute cache size
-  // this->CurrentCacheSize = ?;
+  //--- refresh the index with the files on disk: files added to the
+  //--- cache by other means are indexed, removed files are forgotten.
+  std::map< std::string, unsigned long > files;
+  this->CacheIndexLock.Lock();
+  if ( !this->RemoteCacheDirectory.empty() )
+    {
+    this->ScanCacheDirectory ( "", files );
+    }
+  std::vector< std::string > removedFiles;
+  std::map< std::string, CacheEntry >::iterator it;
+  for ( it = this->CacheIndex.begin(); it != this->CacheIndex.end(); ++it )
+    {
+    if ( files.find ( it->first ) == files.end() )
+      {
+      removedFiles.push_back ( it->first );
+      }
+    }
+  for ( size_t i = 0; i < removedFiles.size(); ++i )
+    {
+    this->RemoveCacheIndexEntry ( removedFiles[i] );
+    }
+  bool newFiles = false;
+  std::map< std::string, unsigned long >::const_iterator fileIt;
+  for ( fileIt = files.begin(); fileIt != files.end(); ++fileIt )
+    {
+    it = this->CacheIndex.find ( fileIt->first );
+    if ( it == this->CacheIndex.end() )
+      {
+      std::string fullName = this->RemoteCacheDirectory + "/" + fileIt->first;
+      this->AddCacheIndexEntry ( fileIt->first, fileIt->second,
+        static_cast<double>(vtksys::SystemTools::ModifiedTime ( fullName.c_str() )), "" );
+      newFiles = true;
+      }
+    else if ( it->second.Size != fileIt->second )
+      {
+      this->CacheIndexSize += static_cast<double>(fileIt->second) - it->second.Size;
+      it->second.Size = fileIt->second;
+      it->second.ContentHash.clear();
+      this->CacheIndexModified = true;
+      }
+    }
+  if ( newFiles )
+    {
+    this->SortLeastRecentlyUsedFiles();
+    }
+  this->RemoveStaleURIMappings();
+  this->SaveCacheIndex();
 
-  //--- recompute free buffer size
-  // this->RemoteCacheFreeBufferSize = ?;
+  //--- now recompute cache size
+  this->CurrentCacheSize = static_cast<float>(this->CacheIndexSize / MB);
 
   //--- and refresh list of cached files.
   this->CachedFileList.clear();
-  this->GetCachedFileList ( this->GetRemoteCacheDirectory() );
+  for ( fileIt = files.begin(); fileIt != files.end(); ++fileIt )
+    {
+    this->CachedFileList.push_back (
+      vtksys::SystemTools::GetFilenameName ( fileIt->first ) );
+    }
+  this->CacheIndexLock.Unlock();
   this->Modified();
 }
 
+//----------------------------------------------------------------------------
+std::string vtkCacheManager::AddToCache ( const char *filename, const char *uri )
+{
+  if ( filename == NULL )
+    {
+    return std::string();
+    }
+  std::string cachedFile = filename;
+  this->CacheIndexLock.Lock();
+  std::string relativePath;
+  if ( !this->GetRelativeCachePath ( filename, relativePath ) ||
+       vtkCacheManagerIsPartialDownload ( relativePath ) ||
+       !vtksys::SystemTools::FileExists ( filename ) ||
+       vtksys::SystemTools::FileIsDirectory ( filename ) )
+    {
+    vtkDebugMacro ( "AddToCache: " << filename << " is not a file of the cache directory." );
+    this->CacheIndexLock.Unlock();
+    return cachedFile;
+    }
+  const unsigned long size = vtksys::SystemTools::FileLength ( filename );
+  this->RemoveCacheIndexEntry ( relativePath );
+
+  //--- look for a cached file with the same content: only the files
+  //--- of the same size need to be hashed.
+  std::string contentHash;
+  std::string duplicate;
+  std::map< std::string, CacheEntry >::iterator it;
+  for ( it = this->CacheIndex.begin(); it != this->CacheIndex.end() && size > 0; ++it )
+    {
+    if ( it->second.Size != size )
+      {
+      continue;
+      }
+    std::string candidate = this->RemoteCacheDirectory + "/" + it->first;
+    if ( it->second.ContentHash.empty() )
+      {
+      it->second.ContentHash = vtkCacheManager::ComputeContentHash ( candidate.c_str() );
+      this->CacheIndexModified = true;
+      }
+    if ( contentHash.empty() )
+      {
+      contentHash = vtkCacheManager::ComputeContentHash ( filename );
+      }
+    if ( it->second.ContentHash == contentHash &&
+         !vtksys::SystemTools::FilesDiffer ( candidate.c_str(), filename ) )
+      {
+      duplicate = it->first;
+      break;
+      }
+    }
+
+  if ( !duplicate.empty() && vtksys::SystemTools::RemoveFile ( filename ) )
+    {
+    vtkDebugMacro ( "AddToCache: " << filename << " is a copy of " << duplicate );
+    cachedFile = this->RemoteCacheDirectory + "/" + duplicate;
+    this->AppendToCacheIndex ( "remove\t" + relativePath );
+    this->TouchCacheIndexEntry ( duplicate );
+    if ( uri != NULL )
+      {
+      this->uriMap[uri] = cachedFile;
+      this->AppendToCacheIndex ( "uri\t" + duplicate + "\t" + uri );
+      }
+    this->CachedFileList.erase ( std::remove (
+      this->CachedFileList.begin(), this->CachedFileList.end(),
+      vtksys::SystemTools::GetFilenameName ( relativePath ) ),
+      this->CachedFileList.end() );
+    }
+  else
+    {
+    this->AddCacheIndexEntry ( relativePath, size,
+                               vtksys::SystemTools::GetTime(), contentHash );
+    if ( std::find ( this->CachedFileList.begin(), this->CachedFileList.end(),
+                     vtksys::SystemTools::GetFilenameName ( relativePath ) ) ==
+         this->CachedFileList.end() )
+      {
+      this->CachedFileList.push_back ( vtksys::SystemTools::GetFilenameName ( relativePath ) );
+      }
+    }
+  this->CurrentCacheSize = static_cast<float>(this->CacheIndexSize / MB);
+  if ( duplicate.empty() )
+    {
+    this->AppendCacheIndexEntry ( relativePath );
+    }
+  this->CacheIndexLock.Unlock();
+  return cachedFile;
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::TouchCachedFile ( const char *filename )
+{
+  if ( filename == NULL )
+    {
+    return;
+    }
+  this->CacheIndexLock.Lock();
+  std::string relativePath;
+  if ( this->GetRelativeCachePath ( filename, relativePath ) )
+    {
+    this->TouchCacheIndexEntry ( relativePath );
+    }
+  this->CacheIndexLock.Unlock();
+}
+
+//----------------------------------------------------------------------------
+int vtkCacheManager::EvictLeastRecentlyUsedFiles ( )
+{
+  const double threshold =
+    ( this->RemoteCacheLimit - this->RemoteCacheFreeBufferSize ) * MB;
+  std::vector< std::string > evictedFiles;
+  this->CacheIndexLock.Lock();
+  while ( this->CacheIndexSize > threshold && !this->LeastRecentlyUsedFiles.empty() )
+    {
+    std::string relativePath = this->LeastRecentlyUsedFiles.front();
+    evictedFiles.push_back ( this->RemoteCacheDirectory + "/" + relativePath );
+    this->RemoveCacheIndexEntry ( relativePath );
+    this->AppendToCacheIndex ( "remove\t" + relativePath );
+    }
+  if ( !evictedFiles.empty() )
+    {
+    this->RemoveStaleURIMappings();
+    this->CurrentCacheSize = static_cast<float>(this->CacheIndexSize / MB);
+    }
+  this->CacheIndexLock.Unlock();
+
+  for ( size_t i = 0; i < evictedFiles.size(); ++i )
+    {
+    vtkDebugMacro ( "EvictLeastRecentlyUsedFiles: removing " << evictedFiles[i] );
+    this->MarkNodesBeforeDeletingDataFromCache ( evictedFiles[i].c_str() );
+    if ( !vtksys::SystemTools::RemoveFile ( evictedFiles[i].c_str() ) )
+      {
+      vtkWarningMacro ( "Unable to remove cached file " << evictedFiles[i] << " from disk." );
+      }
+    this->DeleteFromCachedFileList (
+      vtksys::SystemTools::GetFilenameName ( evictedFiles[i] ).c_str() );
+    }
+  if ( !evictedFiles.empty() )
+    {
+    this->InvokeEvent ( vtkCacheManager::CacheDeleteEvent );
+    }
+  return static_cast<int>(evictedFiles.size());
+}
+
 
 
 
@@ -580,7 +826,7 @@ void vtkCacheManager::DeleteFromCache( const char *target )
         }
       else
         {
-        this->UpdateCacheInformation ( );
+        this->RemoveFromCacheIndex ( str.c_str() );
         this->InvokeEvent ( vtkCacheManager::CacheDeleteEvent );
         }
       }
@@ -592,7 +838,7 @@ void vtkCacheManager::DeleteFromCache( const char *target )
         }
       else
         {
-        this->UpdateCacheInformation ( );
+        this->RemoveFromCacheIndex ( str.c_str() );
         this->InvokeEvent ( vtkCacheManager::CacheDeleteEvent );
         }
       }
@@ -631,6 +877,12 @@ int vtkCacheManager::ClearCacheCheck()
 //----------------------------------------------------------------------------
 int vtkCacheManager::ClearCache()
 {
+  this->CacheIndexLock.Lock();
+  this->CacheIndex.clear();
+  this->LeastRecentlyUsedFiles.clear();
+  this->CacheIndexSize = 0.;
+  this->RemoveStaleURIMappings();
+  this->CacheIndexLock.Unlock();
 
   //--- Careful! Before making this call, prompt user
   //--- with the RemoteCacheDirectory name and
@@ -658,11 +910,10 @@ int vtkCacheManager::ClearCache()
 //----------------------------------------------------------------------------
 float vtkCacheManager::GetCurrentCacheSize ()
 {
-  if ( this->RemoteCacheDirectory.c_str() == NULL )
-    {
-    return (0.0);
-    }
-  float size = this->ComputeCacheSize ( this->RemoteCacheDirectory.c_str(), 0 );
+  //--- the cache index keeps track of the size of the cached files
+  this->CacheIndexLock.Lock();
+  float size = static_cast<float>(this->CacheIndexSize / MB);
+  this->CacheIndexLock.Unlock();
   this->SetCurrentCacheSize ( size );
   return ( this->CurrentCacheSize );
 
@@ -676,6 +927,10 @@ void vtkCacheManager::MarkNode ( std::string str )
   //--- If such a node exists, mark it as modified since read,
   //--- so that a user will be prompted to save the
   //--- data elsewhere (since it'll be deleted from cache.)
+  if ( this->MRMLScene == NULL )
+    {
+    return;
+    }
   int nnodes = this->MRMLScene->GetNumberOfNodesByClass ( "vtkMRMLStorableNode" );
   vtkMRMLStorableNode *node;
   std::string uri;
@@ -831,7 +1086,7 @@ void vtkCacheManager::CacheSizeCheck()
 {
 
   //--- Compute size of the current cache
-  this->ComputeCacheSize(this->RemoteCacheDirectory.c_str(), 0);
+  this->GetCurrentCacheSize();
   //--- Invoke an event if cache size is exceeded.
   if ( this->CurrentCacheSize > (float) (this->RemoteCacheLimit) )
     {
@@ -844,7 +1099,7 @@ void vtkCacheManager::CacheSizeCheck()
 float vtkCacheManager::GetFreeCacheSpaceRemaining()
 {
 
-  float cachesize = this->ComputeCacheSize(this->RemoteCacheDirectory.c_str(), 0);
+  float cachesize = this->GetCurrentCacheSize();
   // cache limit - current cache size = total space left in cache.
   // total space in cache - free buffer size = amount that can be used.
   float diff = ( float (this->RemoteCacheLimit) - cachesize );
@@ -997,3 +1252,363 @@ const char* vtkCacheManager::FindCachedFile ( const char * target, const char *d
     }
 
 }
+
+//----------------------------------------------------------------------------
+std::string vtkCacheManager::GetCacheIndexFileName()
+{
+  return this->RemoteCacheDirectory + "/" + CacheIndexFileName;
+}
+
+//----------------------------------------------------------------------------
+bool vtkCacheManager::GetRelativeCachePath ( const char *filename,
+                                             std::string &relativePath )
+{
+  if ( filename == NULL || this->RemoteCacheDirectory.empty() )
+    {
+    return false;
+    }
+  std::string cacheDir =
+    vtksys::SystemTools::CollapseFullPath ( this->RemoteCacheDirectory.c_str() ) + "/";
+  std::string fullName = vtksys::SystemTools::CollapseFullPath ( filename );
+  if ( fullName.size() <= cacheDir.size() ||
+       fullName.compare ( 0, cacheDir.size(), cacheDir ) != 0 )
+    {
+    return false;
+    }
+  relativePath = fullName.substr ( cacheDir.size() );
+  return relativePath != CacheIndexFileName;
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::AddCacheIndexEntry ( const std::string &relativePath,
+                                           unsigned long size,
+                                           double lastAccessTime,
+                                           const std::string &contentHash )
+{
+  CacheEntry &entry = this->CacheIndex[relativePath];
+  entry.Size = size;
+  entry.LastAccessTime = lastAccessTime;
+  entry.ContentHash = contentHash;
+  entry.LeastRecentlyUsedPosition = this->LeastRecentlyUsedFiles.insert (
+    this->LeastRecentlyUsedFiles.end(), relativePath );
+  this->CacheIndexSize += size;
+  this->CacheIndexModified = true;
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::RemoveCacheIndexEntry ( const std::string &relativePath )
+{
+  std::map< std::string, CacheEntry >::iterator it =
+    this->CacheIndex.find ( relativePath );
+  if ( it == this->CacheIndex.end() )
+    {
+    return;
+    }
+  this->LeastRecentlyUsedFiles.erase ( it->second.LeastRecentlyUsedPosition );
+  this->CacheIndexSize -= it->second.Size;
+  this->CacheIndex.erase ( it );
+  if ( this->CacheIndex.empty() )
+    {
+    // no rounding errors to accumulate
+    this->CacheIndexSize = 0.;
+    }
+  this->CacheIndexModified = true;
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::TouchCacheIndexEntry ( const std::string &relativePath )
+{
+  std::map< std::string, CacheEntry >::iterator it =
+    this->CacheIndex.find ( relativePath );
+  if ( it == this->CacheIndex.end() )
+    {
+    return;
+    }
+  //--- move the file to the most recently used end of the list
+  this->LeastRecentlyUsedFiles.splice ( this->LeastRecentlyUsedFiles.end(),
+    this->LeastRecentlyUsedFiles, it->second.LeastRecentlyUsedPosition );
+  it->second.LastAccessTime = vtksys::SystemTools::GetTime();
+  this->CacheIndexModified = true;
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::SortLeastRecentlyUsedFiles()
+{
+  //--- the current order breaks the ties
+  std::vector< std::pair< double, std::string > > files;
+  std::list< std::string >::const_iterator it;
+  for ( it = this->LeastRecentlyUsedFiles.begin();
+        it != this->LeastRecentlyUsedFiles.end(); ++it )
+    {
+    files.push_back ( std::make_pair ( this->CacheIndex[*it].LastAccessTime, *it ) );
+    }
+  std::stable_sort ( files.begin(), files.end(),
+                     vtkCacheManagerCompareAccessTimes );
+  this->LeastRecentlyUsedFiles.clear();
+  for ( size_t i = 0; i < files.size(); ++i )
+    {
+    this->CacheIndex[files[i].second].LeastRecentlyUsedPosition =
+      this->LeastRecentlyUsedFiles.insert (
+        this->LeastRecentlyUsedFiles.end(), files[i].second );
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::RemoveStaleURIMappings()
+{
+  //--- forget the URIs mapped to files that are no longer in cache
+  std::map< std::string, std::string >::iterator it = this->uriMap.begin();
+  while ( it != this->uriMap.end() )
+    {
+    std::string relativePath;
+    if ( this->GetRelativeCachePath ( it->second.c_str(), relativePath ) &&
+         this->CacheIndex.find ( relativePath ) == this->CacheIndex.end() )
+      {
+      this->uriMap.erase ( it++ );
+      this->CacheIndexModified = true;
+      }
+    else
+      {
+      ++it;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::ScanCacheDirectory ( const std::string &relativeDir,
+                                           std::map< std::string, unsigned long > &files )
+{
+  std::string dirName = this->RemoteCacheDirectory;
+  if ( !relativeDir.empty() )
+    {
+    dirName += "/" + relativeDir;
+    }
+  vtksys::Directory dir;
+  if ( !dir.Load ( dirName.c_str() ) )
+    {
+    return;
+    }
+  for ( unsigned long fileNum = 0; fileNum < dir.GetNumberOfFiles(); ++fileNum )
+    {
+    const char *name = dir.GetFile ( fileNum );
+    if ( !strcmp ( name, "." ) || !strcmp ( name, ".." ) ||
+         ( relativeDir.empty() &&
+           !strncmp ( name, CacheIndexFileName, sizeof(CacheIndexFileName) - 1 ) ) )
+      {
+      continue;
+      }
+    std::string relativePath = relativeDir.empty() ? std::string(name) : relativeDir + "/" + name;
+    std::string fullName = dirName + "/" + name;
+    if ( vtksys::SystemTools::FileIsDirectory ( fullName.c_str() ) )
+      {
+      this->ScanCacheDirectory ( relativePath, files );
+      }
+    else if ( !vtkCacheManagerIsPartialDownload ( relativePath ) )
+      {
+      files[relativePath] = vtksys::SystemTools::FileLength ( fullName.c_str() );
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::LoadCacheIndex()
+{
+  this->CacheIndex.clear();
+  this->LeastRecentlyUsedFiles.clear();
+  this->CacheIndexSize = 0.;
+  this->CacheIndexModified = false;
+  if ( this->RemoteCacheDirectory.empty() )
+    {
+    return;
+    }
+
+  //--- one entry per line, tab separated, later lines override the
+  //--- previous ones (see AppendToCacheIndex()):
+  //---   file <size> <last access time> <content hash or -> <relative path>
+  //---   remove <relative path>
+  //---   uri <relative path> <uri>
+  std::ifstream index ( this->GetCacheIndexFileName().c_str() );
+  std::string line;
+  while ( std::getline ( index, line ) )
+    {
+    std::vector< std::string > fields;
+    std::string::size_type start = 0;
+    std::string::size_type tab;
+    while ( fields.size() < 4 && ( tab = line.find ( '\t', start ) ) != std::string::npos )
+      {
+      fields.push_back ( line.substr ( start, tab - start ) );
+      start = tab + 1;
+      }
+    fields.push_back ( line.substr ( start ) );
+    if ( fields.size() == 5 && fields[0] == "file" )
+      {
+      unsigned long size = 0;
+      double lastAccessTime = 0.;
+      std::istringstream ( fields[1] ) >> size;
+      std::istringstream ( fields[2] ) >> lastAccessTime;
+      this->RemoveCacheIndexEntry ( fields[4] );
+      this->AddCacheIndexEntry ( fields[4], size, lastAccessTime,
+                                 fields[3] == "-" ? std::string() : fields[3] );
+      }
+    else if ( fields.size() == 2 && fields[0] == "remove" )
+      {
+      this->RemoveCacheIndexEntry ( fields[1] );
+      }
+    else if ( fields.size() >= 3 && fields[0] == "uri" )
+      {
+      //--- the uri may contain tabs
+      this->uriMap[line.substr ( 5 + fields[1].size() )] =
+        this->RemoteCacheDirectory + "/" + fields[1];
+      }
+    }
+  this->SortLeastRecentlyUsedFiles();
+  this->CacheIndexModified = false;
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::SaveCacheIndex()
+{
+  if ( !this->CacheIndexModified || this->RemoteCacheDirectory.empty() ||
+       !vtksys::SystemTools::FileIsDirectory ( this->RemoteCacheDirectory.c_str() ) )
+    {
+    return;
+    }
+  //--- write a new index and replace the old one, so that an interrupted
+  //--- write doesn't leave a truncated index
+  std::string indexFileName = this->GetCacheIndexFileName();
+  if ( this->CacheIndex.empty() && this->uriMap.empty() )
+    {
+    //--- an empty cache directory stays empty (see ClearCacheCheck())
+    vtksys::SystemTools::RemoveFile ( indexFileName.c_str() );
+    this->CacheIndexModified = false;
+    return;
+    }
+  std::string tempFileName = indexFileName + ".tmp";
+  {
+  std::ofstream index ( tempFileName.c_str() );
+  if ( !index )
+    {
+    vtkWarningMacro ( "SaveCacheIndex: unable to write " << tempFileName );
+    return;
+    }
+  index.precision ( 15 );
+  std::list< std::string >::const_iterator it;
+  for ( it = this->LeastRecentlyUsedFiles.begin();
+        it != this->LeastRecentlyUsedFiles.end(); ++it )
+    {
+    const CacheEntry &entry = this->CacheIndex[*it];
+    index << "file\t" << entry.Size << "\t" << entry.LastAccessTime << "\t"
+          << ( entry.ContentHash.empty() ? std::string("-") : entry.ContentHash )
+          << "\t" << *it << "\n";
+    }
+  std::map< std::string, std::string >::const_iterator uriIt;
+  for ( uriIt = this->uriMap.begin(); uriIt != this->uriMap.end(); ++uriIt )
+    {
+    std::string relativePath;
+    if ( this->GetRelativeCachePath ( uriIt->second.c_str(), relativePath ) )
+      {
+      index << "uri\t" << relativePath << "\t" << uriIt->first << "\n";
+      }
+    }
+  }
+  vtksys::SystemTools::RemoveFile ( indexFileName.c_str() );
+  if ( rename ( tempFileName.c_str(), indexFileName.c_str() ) != 0 )
+    {
+    vtkWarningMacro ( "SaveCacheIndex: unable to write " << indexFileName );
+    return;
+    }
+  this->CacheIndexModified = false;
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::AppendToCacheIndex ( const std::string &line )
+{
+  if ( this->RemoteCacheDirectory.empty() )
+    {
+    return;
+    }
+  //--- the whole index is rewritten by SaveCacheIndex() when the directory
+  //--- changes or the manager is deleted, appending is enough in between
+  std::ofstream index ( this->GetCacheIndexFileName().c_str(), std::ios::app );
+  if ( !index )
+    {
+    vtkWarningMacro ( "AppendToCacheIndex: unable to write " << this->GetCacheIndexFileName() );
+    return;
+    }
+  index << line << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::AppendCacheIndexEntry ( const std::string &relativePath )
+{
+  std::map< std::string, CacheEntry >::const_iterator it =
+    this->CacheIndex.find ( relativePath );
+  if ( it == this->CacheIndex.end() )
+    {
+    return;
+    }
+  std::ostringstream line;
+  line.precision ( 15 );
+  line << "file\t" << it->second.Size << "\t" << it->second.LastAccessTime << "\t"
+       << ( it->second.ContentHash.empty() ? std::string("-") : it->second.ContentHash )
+       << "\t" << relativePath;
+  this->AppendToCacheIndex ( line.str() );
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::RemoveFromCacheIndex ( const char *target )
+{
+  this->CacheIndexLock.Lock();
+  std::string relativePath;
+  if ( this->GetRelativeCachePath ( target, relativePath ) )
+    {
+    //--- the target is a file or a directory: remove all the files in it
+    const std::string directoryPrefix = relativePath + "/";
+    std::vector< std::string > removedFiles;
+    if ( this->CacheIndex.find ( relativePath ) != this->CacheIndex.end() )
+      {
+      removedFiles.push_back ( relativePath );
+      }
+    std::map< std::string, CacheEntry >::const_iterator it;
+    for ( it = this->CacheIndex.lower_bound ( directoryPrefix );
+          it != this->CacheIndex.end() &&
+          it->first.compare ( 0, directoryPrefix.size(), directoryPrefix ) == 0; ++it )
+      {
+      removedFiles.push_back ( it->first );
+      }
+    for ( size_t i = 0; i < removedFiles.size(); ++i )
+      {
+      this->RemoveCacheIndexEntry ( removedFiles[i] );
+      this->AppendToCacheIndex ( "remove\t" + removedFiles[i] );
+      }
+    this->RemoveStaleURIMappings();
+    this->CurrentCacheSize = static_cast<float>(this->CacheIndexSize / MB);
+    }
+  this->CacheIndexLock.Unlock();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+std::string vtkCacheManager::ComputeContentHash ( const char *filename )
+{
+  //--- 64 bit FNV-1a: only used to find candidate duplicates, which are
+  //--- compared byte by byte before being merged.
+  const vtkTypeUInt64 prime = (static_cast<vtkTypeUInt64>(0x100) << 32) | 0x1b3;
+  vtkTypeUInt64 hash = (static_cast<vtkTypeUInt64>(0xcbf29ce4) << 32) | 0x84222325;
+  std::ifstream file ( filename, std::ios::in | std::ios::binary );
+  char buffer[65536];
+  while ( file )
+    {
+    file.read ( buffer, sizeof(buffer) );
+    const std::streamsize count = file.gcount();
+    for ( std::streamsize i = 0; i < count; ++i )
+      {
+      hash ^= static_cast<unsigned char>(buffer[i]);
+      hash *= prime;
+      }
+    }
+  char hex[17];
+  sprintf ( hex, "%08x%08x", static_cast<unsigned int>(hash >> 32),
+            static_cast<unsigned int>(hash & 0xffffffff) );
+  return std::string ( hex );
+}
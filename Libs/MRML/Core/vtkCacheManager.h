@@ -7,9 +7,11 @@ class vtkCallbackCommand;
 class vtkMRMLScene;
 
 // VTK includes
+#include <vtkCriticalSection.h>
 #include <vtkObject.h>
 
 // STD includes
+#include <list>
 #include <string>
 #include <vector>
 #include <map>
@@ -42,8 +44,32 @@ class VTK_MRML_EXPORT vtkCacheManager : public vtkObject
   const char *GetRemoteCacheDirectory ();
 
   ///
-  /// Called when a file is loaded or removed from the cache.
+  /// Rescans the cache directory and updates the cache index, to take into
+  /// account the files added or removed without the cache manager.
+  /// Downloads (AddToCache()) and removals (DeleteFromCache(),
+  /// EvictLeastRecentlyUsedFiles()) update the index incrementally and
+  /// don't need it. Partial downloads (*.part) are not indexed.
   void UpdateCacheInformation ( );
+
+  ///
+  /// Records a file just downloaded in the cache directory into the
+  /// cache index. If a file with the same content is already cached
+  /// (e.g. the same data under another URI), the new file is removed,
+  /// uri is mapped to the existing file and the existing file is returned.
+  /// Returns the path of the cached file.
+  /// Can be called from the networking thread.
+  std::string AddToCache ( const char *filename, const char *uri = 0 );
+
+  ///
+  /// Marks a cached file as used, making it the last to be evicted.
+  void TouchCachedFile ( const char *filename );
+
+  ///
+  /// Removes the least recently used files from the cache until its size
+  /// is below RemoteCacheLimit - RemoteCacheFreeBufferSize.
+  /// Nodes referencing the removed files are marked as modified.
+  /// Returns the number of removed files.
+  int EvictLeastRecentlyUsedFiles ( );
   ///
   /// Removes a target from the list of locally cached files and directories
   void DeleteFromCachedFileList ( const char * target );
@@ -110,7 +136,10 @@ class VTK_MRML_EXPORT vtkCacheManager : public vtkObject
 
   void CacheSizeCheck();
   void FreeCacheBufferCheck();
+  /// Traverses the directory to compute the combined size of its files.
+  /// GetCurrentCacheSize() should be preferred for the cache directory.
   float ComputeCacheSize( const char *dirname, unsigned long size );
+  /// Size of the cache in MB, maintained by the cache index.
   float GetCurrentCacheSize();
   float GetFreeCacheSpaceRemaining();
 
@@ -172,6 +201,50 @@ class VTK_MRML_EXPORT vtkCacheManager : public vtkObject
   /// with every download, remove from cache, and clearcache call.
   std::vector< std::string > CachedFileList;
 
+  /// Cache index: size, last access and content hash of the cached
+  /// files. It is saved in the cache directory to persist across sessions.
+  struct CacheEntry
+    {
+    unsigned long Size;
+    double LastAccessTime;
+    /// Computed when a file of the same size is added to the cache
+    std::string ContentHash;
+    /// Position in LeastRecentlyUsedFiles
+    std::list< std::string >::iterator LeastRecentlyUsedPosition;
+    };
+  /// Indexed files, with paths relative to RemoteCacheDirectory
+  std::map< std::string, CacheEntry > CacheIndex;
+  /// Indexed files from the least to the most recently used
+  std::list< std::string > LeastRecentlyUsedFiles;
+  /// Combined size of the indexed files, in bytes
+  double CacheIndexSize;
+  bool CacheIndexModified;
+  /// Protects the index and uriMap (downloads add files from the
+  /// networking thread)
+  vtkSimpleCriticalSection CacheIndexLock;
+
+  /// Index helpers, the lock must be held by the caller.
+  std::string GetCacheIndexFileName();
+  bool GetRelativeCachePath ( const char *filename, std::string &relativePath );
+  void AddCacheIndexEntry ( const std::string &relativePath, unsigned long size,
+                            double lastAccessTime, const std::string &contentHash );
+  void RemoveCacheIndexEntry ( const std::string &relativePath );
+  void TouchCacheIndexEntry ( const std::string &relativePath );
+  void SortLeastRecentlyUsedFiles();
+  void RemoveStaleURIMappings();
+  void ScanCacheDirectory ( const std::string &relativeDir,
+                            std::map< std::string, unsigned long > &files );
+  void LoadCacheIndex();
+  /// Rewrite the whole index file
+  void SaveCacheIndex();
+  /// Append a line (entry or removal) to the index file
+  void AppendToCacheIndex ( const std::string &line );
+  void AppendCacheIndexEntry ( const std::string &relativePath );
+  /// Forget the file or all the files of the directory target, the lock
+  /// must not be held by the caller.
+  void RemoveFromCacheIndex ( const char *target );
+  static std::string ComputeContentHash ( const char *filename );
+
  protected:
   vtkCacheManager();
   virtual ~vtkCacheManager();
@@ -396,6 +396,8 @@ void vtkDataIOManager::QueueRead ( vtkMRMLNode *node )
     //--- a large scene that consists of multiple datasets.
     //--- ***The risk with this implementation  is that they may
     //--- forget to adjust the cache size, but aren't notified again...
+    //--- The least recently used files are evicted first to make room.
+    cm->EvictLeastRecentlyUsedFiles();
     float bufsize = (cm->GetRemoteCacheLimit() * 1000000.0) -  (cm->GetRemoteCacheFreeBufferSize() * 1000000.0);
     if ( (cm->GetCurrentCacheSize()*1000000.0) >= bufsize )
       {
@@ -424,8 +426,9 @@ void vtkDataIOManager::QueueRead ( vtkMRMLNode *node )
       //--- trigger logic to download, if there's cache space.
       //--- and signal this remote read event to Logic and GUI.
       vtkDebugMacro("QueueRead: invoking a remote read event on the data io manager");
+      //--- the downloaded file is added to the cache index once
+      //--- the transfer is done (vtkCacheManager::AddToCache()).
       this->InvokeEvent ( vtkDataIOManager::RemoteReadEvent, node);
-      cm->UpdateCacheInformation();
       }
     }
   else
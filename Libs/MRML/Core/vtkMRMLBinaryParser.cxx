@@ -0,0 +1,485 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLBinaryParser.h"
+#include "vtkMRMLNode.h"
+
+// VTK includes
+#include <vtkObjectFactory.h>
+#include <vtkType.h>
+
+// VTKsys includes
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+//------------------------------------------------------------------------------
+vtkStandardNewMacro(vtkMRMLBinaryParser);
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+unsigned int DecodeUInt32(const char* value)
+{
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(value);
+  return static_cast<unsigned int>(bytes[0]) |
+         (static_cast<unsigned int>(bytes[1]) << 8) |
+         (static_cast<unsigned int>(bytes[2]) << 16) |
+         (static_cast<unsigned int>(bytes[3]) << 24);
+}
+
+//------------------------------------------------------------------------------
+double DecodeDouble(const char* value)
+{
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(value);
+  vtkTypeUInt64 bits = 0;
+  for (int i = 7; i >= 0; --i)
+    {
+    bits = (bits << 8) | bytes[i];
+    }
+  double decoded;
+  memcpy(&decoded, &bits, sizeof(decoded));
+  return decoded;
+}
+
+//------------------------------------------------------------------------------
+// Read the records of a binary scene in place: strings point into the buffer.
+class BufferReader
+{
+public:
+  BufferReader(const char* buffer, unsigned int length)
+    : Buffer(buffer), Length(length), Position(0), Valid(true)
+  {}
+
+  unsigned char ReadByte()
+  {
+    if (!this->Valid || this->Position + 1 > this->Length)
+      {
+      this->Valid = false;
+      return 0;
+      }
+    return static_cast<unsigned char>(this->Buffer[this->Position++]);
+  }
+
+  unsigned int ReadUInt32()
+  {
+    if (!this->Valid || this->Position + 4 > this->Length)
+      {
+      this->Valid = false;
+      return 0;
+      }
+    const char* bytes = this->Buffer + this->Position;
+    this->Position += 4;
+    return DecodeUInt32(bytes);
+  }
+
+  const char* ReadString()
+  {
+    unsigned int length = this->ReadUInt32();
+    if (!this->Valid || length >= this->Length - this->Position ||
+        this->Buffer[this->Position + length] != '\0')
+      {
+      this->Valid = false;
+      return 0;
+      }
+    const char* str = this->Buffer + this->Position;
+    this->Position += length + 1;
+    return str;
+  }
+
+  // Skip a value of the given type, return where it starts.
+  const char* ReadValue(unsigned char type)
+  {
+    const char* value = this->Buffer + this->Position;
+    switch (type)
+      {
+      case vtkMRMLBinaryParser::StringValue:
+        this->ReadString();
+        break;
+      case vtkMRMLBinaryParser::StringsValue:
+        {
+        unsigned int count = this->ReadUInt32();
+        for (unsigned int i = 0; i < count && this->Valid; ++i)
+          {
+          this->ReadString();
+          }
+        }
+        break;
+      case vtkMRMLBinaryParser::IntValue:
+        this->ReadUInt32();
+        break;
+      case vtkMRMLBinaryParser::DoubleValue:
+        this->Skip(8);
+        break;
+      case vtkMRMLBinaryParser::DoublesValue:
+        {
+        unsigned int count = this->ReadUInt32();
+        if (count > (this->Length - this->Position) / 8)
+          {
+          this->Valid = false;
+          }
+        this->Skip(8 * count);
+        }
+        break;
+      default:
+        this->Valid = false;
+        break;
+      }
+    return this->Valid ? value : 0;
+  }
+
+  void Skip(unsigned int length)
+  {
+    if (!this->Valid || length > this->Length - this->Position)
+      {
+      this->Valid = false;
+      return;
+      }
+    this->Position += length;
+  }
+
+  const char* Buffer;
+  unsigned int Length;
+  unsigned int Position;
+  bool Valid;
+};
+
+//------------------------------------------------------------------------------
+struct Schema
+{
+  const char* TagName;
+  unsigned char AttributesType;
+  std::vector<const char*> AttributeNames;
+  std::vector<unsigned char> AttributeTypes;
+};
+
+} // end of anonymous namespace
+
+//------------------------------------------------------------------------------
+bool vtkMRMLBinaryParser::IsBinaryScene(const char* fileName)
+{
+  if (!fileName)
+    {
+    return false;
+    }
+  std::ifstream file(fileName, std::ios::in | std::ios::binary);
+  std::vector<char> magic(vtkMRMLBinaryParser::GetMagicLength());
+  file.read(&magic[0], magic.size());
+  return file.good() &&
+    memcmp(&magic[0], vtkMRMLBinaryParser::GetMagic(), magic.size()) == 0;
+}
+
+//------------------------------------------------------------------------------
+bool vtkMRMLBinaryParser::IsBinarySceneFileName(const char* fileName)
+{
+  if (!fileName)
+    {
+    return false;
+    }
+  std::string extension = vtksys::SystemTools::LowerCase(
+    vtksys::SystemTools::GetFilenameLastExtension(fileName));
+  return extension == ".mrmlb";
+}
+
+//------------------------------------------------------------------------------
+int vtkMRMLBinaryParser::Parse()
+{
+  if (!this->FileName)
+    {
+    vtkErrorMacro("Parse: FileName is not set");
+    return 0;
+    }
+  std::ifstream file(this->FileName, std::ios::in | std::ios::binary);
+  if (!file)
+    {
+    vtkErrorMacro("Parse: can't open file " << this->FileName);
+    return 0;
+    }
+  file.seekg(0, std::ios::end);
+  std::streamoff length = file.tellg();
+  file.seekg(0, std::ios::beg);
+  if (length <= 0)
+    {
+    vtkErrorMacro("Parse: empty file " << this->FileName);
+    return 0;
+    }
+  std::vector<char> buffer(static_cast<size_t>(length));
+  file.read(&buffer[0], length);
+  if (!file)
+    {
+    vtkErrorMacro("Parse: can't read file " << this->FileName);
+    return 0;
+    }
+  return this->ParseBuffer(&buffer[0], static_cast<unsigned int>(length));
+}
+
+//------------------------------------------------------------------------------
+int vtkMRMLBinaryParser::Parse(const char* vtkNotUsed(inputString))
+{
+  vtkErrorMacro("Parse: the length of a binary scene must be given");
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+int vtkMRMLBinaryParser::Parse(const char* inputString, unsigned int length)
+{
+  if (!inputString)
+    {
+    vtkErrorMacro("Parse: no input");
+    return 0;
+    }
+  return this->ParseBuffer(inputString, length);
+}
+
+//------------------------------------------------------------------------------
+int vtkMRMLBinaryParser::ParseBuffer(const char* buffer, unsigned int length)
+{
+  const unsigned int magicLength = vtkMRMLBinaryParser::GetMagicLength();
+  if (length < magicLength ||
+      memcmp(buffer, vtkMRMLBinaryParser::GetMagic(), magicLength) != 0)
+    {
+    vtkErrorMacro("Parse: not a binary scene");
+    return 0;
+    }
+  BufferReader reader(buffer + magicLength, length - magicLength);
+  unsigned int formatVersion = reader.ReadUInt32();
+  if (formatVersion != vtkMRMLBinaryParser::FormatVersion)
+    {
+    vtkErrorMacro("Parse: unsupported binary scene version " << formatVersion);
+    return 0;
+    }
+
+  // Scene element
+  const char* version = reader.ReadString();
+  const char* userTags = reader.ReadString();
+  if (!reader.Valid)
+    {
+    vtkErrorMacro("Parse: truncated header");
+    return 0;
+    }
+  std::vector<const char*> atts;
+  if (version[0] != '\0')
+    {
+    atts.push_back("version");
+    atts.push_back(version);
+    }
+  atts.push_back("userTags");
+  atts.push_back(userTags);
+  atts.push_back(0);
+  this->StartElement("MRML", &atts[0]);
+
+  // Node elements
+  std::vector<Schema> schemas;
+  std::vector<unsigned int> elementStack;
+  while (reader.Valid)
+    {
+    unsigned char record = reader.ReadByte();
+    if (!reader.Valid)
+      {
+      break;
+      }
+    if (record == vtkMRMLBinaryParser::SchemaRecord)
+      {
+      Schema schema;
+      schema.TagName = reader.ReadString();
+      schema.AttributesType = reader.ReadByte();
+      unsigned int numberOfAttributes = reader.ReadUInt32();
+      for (unsigned int i = 0; i < numberOfAttributes && reader.Valid; ++i)
+        {
+        schema.AttributeNames.push_back(reader.ReadString());
+        schema.AttributeTypes.push_back(reader.ReadByte());
+        }
+      if (schema.AttributesType != vtkMRMLBinaryParser::XMLAttributes &&
+          schema.AttributesType != vtkMRMLBinaryParser::BinaryAttributes)
+        {
+        vtkErrorMacro("Parse: invalid schema attributes");
+        return 0;
+        }
+      schemas.push_back(schema);
+      }
+    else if (record == vtkMRMLBinaryParser::StartElementRecord)
+      {
+      unsigned int schemaIndex = reader.ReadUInt32();
+      if (schemaIndex >= schemas.size())
+        {
+        vtkErrorMacro("Parse: invalid schema " << schemaIndex);
+        return 0;
+        }
+      const Schema& schema = schemas[schemaIndex];
+      atts.clear();
+      this->Attributes.clear();
+      this->ReadingBinaryAttributes =
+        (schema.AttributesType == vtkMRMLBinaryParser::BinaryAttributes);
+      for (size_t i = 0; i < schema.AttributeNames.size(); ++i)
+        {
+        if (this->ReadingBinaryAttributes)
+          {
+          BinaryAttribute attribute;
+          attribute.Name = schema.AttributeNames[i];
+          attribute.Type = schema.AttributeTypes[i];
+          attribute.Value = reader.ReadValue(attribute.Type);
+          this->Attributes.push_back(attribute);
+          }
+        else if (schema.AttributeTypes[i] == vtkMRMLBinaryParser::StringValue)
+          {
+          atts.push_back(schema.AttributeNames[i]);
+          atts.push_back(reader.ReadString());
+          }
+        else
+          {
+          reader.Valid = false;
+          }
+        }
+      atts.push_back(0);
+      if (!reader.Valid)
+        {
+        break;
+        }
+      this->StartElement(schema.TagName, &atts[0]);
+      this->ReadingBinaryAttributes = false;
+      this->Attributes.clear();
+      elementStack.push_back(schemaIndex);
+      }
+    else if (record == vtkMRMLBinaryParser::EndElementRecord)
+      {
+      if (elementStack.empty())
+        {
+        vtkErrorMacro("Parse: unbalanced end element");
+        return 0;
+        }
+      this->EndElement(schemas[elementStack.back()].TagName);
+      elementStack.pop_back();
+      }
+    else if (record == vtkMRMLBinaryParser::EndOfSceneRecord)
+      {
+      if (!elementStack.empty())
+        {
+        vtkErrorMacro("Parse: unterminated element");
+        return 0;
+        }
+      this->EndElement("MRML");
+      return 1;
+      }
+    else
+      {
+      vtkErrorMacro("Parse: invalid record " << static_cast<int>(record));
+      return 0;
+      }
+    }
+  vtkErrorMacro("Parse: truncated binary scene");
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLBinaryParser::ReadNodeAttributes(vtkMRMLNode* node, const char** atts)
+{
+  if (!this->ReadingBinaryAttributes)
+    {
+    this->Superclass::ReadNodeAttributes(node, atts);
+    return;
+    }
+  const char* binaryClassName = node->GetBinaryClassName();
+  if (!binaryClassName || strcmp(binaryClassName, node->GetClassName()))
+    {
+    vtkWarningMacro("ReadNodeAttributes: " << node->GetClassName()
+                    << " does not read all the attributes written with WriteBinary()");
+    }
+  node->ReadBinary(this);
+}
+
+//------------------------------------------------------------------------------
+const char* vtkMRMLBinaryParser::FindAttribute(const char* name, unsigned char type)
+{
+  for (std::vector<BinaryAttribute>::const_iterator it = this->Attributes.begin();
+       it != this->Attributes.end(); ++it)
+    {
+    if (it->Type == type && !strcmp(it->Name, name))
+      {
+      return it->Value;
+      }
+    }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+const char* vtkMRMLBinaryParser::GetStringAttribute(const char* name)
+{
+  const char* value = this->FindAttribute(name, vtkMRMLBinaryParser::StringValue);
+  // skip the length
+  return value ? value + 4 : 0;
+}
+
+//------------------------------------------------------------------------------
+bool vtkMRMLBinaryParser::GetStringsAttribute(const char* name,
+                                              std::vector<std::string>& values)
+{
+  const char* value = this->FindAttribute(name, vtkMRMLBinaryParser::StringsValue);
+  if (!value)
+    {
+    return false;
+    }
+  unsigned int count = DecodeUInt32(value);
+  value += 4;
+  values.resize(count);
+  for (unsigned int i = 0; i < count; ++i)
+    {
+    unsigned int length = DecodeUInt32(value);
+    values[i].assign(value + 4, length);
+    value += 4 + length + 1;
+    }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool vtkMRMLBinaryParser::GetIntAttribute(const char* name, int& value)
+{
+  const char* encodedValue = this->FindAttribute(name, vtkMRMLBinaryParser::IntValue);
+  if (!encodedValue)
+    {
+    return false;
+    }
+  value = static_cast<int>(DecodeUInt32(encodedValue));
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool vtkMRMLBinaryParser::GetDoubleAttribute(const char* name, double& value)
+{
+  const char* encodedValue = this->FindAttribute(name, vtkMRMLBinaryParser::DoubleValue);
+  if (!encodedValue)
+    {
+    return false;
+    }
+  value = DecodeDouble(encodedValue);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool vtkMRMLBinaryParser::GetDoublesAttribute(const char* name, double* values, int count)
+{
+  const char* encodedValues = this->FindAttribute(name, vtkMRMLBinaryParser::DoublesValue);
+  if (!encodedValues ||
+      DecodeUInt32(encodedValues) != static_cast<unsigned int>(count))
+    {
+    return false;
+    }
+  encodedValues += 4;
+  for (int i = 0; i < count; ++i)
+    {
+    values[i] = DecodeDouble(encodedValues + 8 * i);
+    }
+  return true;
+}
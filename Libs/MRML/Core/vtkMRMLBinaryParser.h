@@ -0,0 +1,144 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkMRMLBinaryParser_h
+#define __vtkMRMLBinaryParser_h
+
+// MRML includes
+#include "vtkMRMLParser.h"
+
+// STD includes
+#include <string>
+#include <vector>
+
+/// \brief Parse binary scene file.
+///
+/// A binary scene (.mrmlb) contains the same elements and attributes as the
+/// XML scene written by vtkMRMLScene::Commit(), without the XML syntax:
+/// - a header: the magic string "MRMLBIN1", the format version, the scene
+/// version and user tags.
+/// - schema records: the tag name of a node class, how its attributes are
+/// read, and the name and value type of each attribute. They are written
+/// once, the first time a node of the class writes this set of attributes.
+/// - start element records: the schema index followed by the attribute
+/// values, in the order of the schema.
+/// - end element records, nested like the XML elements
+/// (e.g. the nodes stored in a scene view).
+/// Integers are 32 bits and doubles 64 bits, little endian. Strings are
+/// length-prefixed and null-terminated, values are never escaped.
+///
+/// Nodes written with vtkMRMLNode::WriteBinary() are read with
+/// vtkMRMLNode::ReadBinary(), which gets the typed values with the
+/// Get...Attribute() methods. The attributes of the other nodes are strings,
+/// read with vtkMRMLNode::ReadXMLAttributes() like in the XML scene.
+/// The parser calls the same StartElement() and EndElement() than when
+/// parsing the XML scene.
+/// \sa vtkMRMLBinaryWriter, vtkMRMLScene::Commit()
+class VTK_MRML_EXPORT vtkMRMLBinaryParser : public vtkMRMLParser
+{
+public:
+  static vtkMRMLBinaryParser *New();
+  vtkTypeMacro(vtkMRMLBinaryParser,vtkMRMLParser);
+
+  enum RecordType
+  {
+    EndOfSceneRecord = 0,
+    SchemaRecord,
+    StartElementRecord,
+    EndElementRecord
+  };
+
+  /// How the attributes of an element are read.
+  enum AttributesType
+  {
+    XMLAttributes = 0,
+    BinaryAttributes
+  };
+
+  /// Type of the attribute values.
+  enum ValueType
+  {
+    StringValue = 0,
+    StringsValue,
+    IntValue,
+    DoubleValue,
+    DoublesValue
+  };
+
+  ///
+  /// Version of the binary container, incremented when the layout changes.
+  static const unsigned int FormatVersion = 2;
+
+  ///
+  /// First bytes of a binary scene file.
+  static const char* GetMagic() {return "MRMLBIN1";}
+  static int GetMagicLength() {return 8;}
+
+  ///
+  /// Return true if the file starts with the binary scene magic string.
+  static bool IsBinaryScene(const char* fileName);
+
+  ///
+  /// Return true if the file name has the binary scene extension (.mrmlb).
+  static bool IsBinarySceneFileName(const char* fileName);
+
+  ///
+  /// Parse the binary scene file FileName.
+  virtual int Parse();
+
+  ///
+  /// Binary scenes contain null characters, the length must be given.
+  virtual int Parse(const char* inputString);
+  virtual int Parse(const char* inputString, unsigned int length);
+
+  ///
+  /// Attributes of the node being read.
+  /// To be called from vtkMRMLNode::ReadBinary() only.
+  /// Return 0 (or false) if the node did not write the attribute with
+  /// this type, the value is then left unchanged.
+  const char* GetStringAttribute(const char* name);
+  //BTX
+  bool GetStringsAttribute(const char* name, std::vector<std::string>& values);
+  //ETX
+  bool GetIntAttribute(const char* name, int& value);
+  bool GetDoubleAttribute(const char* name, double& value);
+  /// Return false if the attribute doesn't have \a count values.
+  bool GetDoublesAttribute(const char* name, double* values, int count);
+
+protected:
+  vtkMRMLBinaryParser() : ReadingBinaryAttributes(false) {};
+  ~vtkMRMLBinaryParser() {};
+  vtkMRMLBinaryParser(const vtkMRMLBinaryParser&);
+  void operator=(const vtkMRMLBinaryParser&);
+
+  int ParseBuffer(const char* buffer, unsigned int length);
+
+  ///
+  /// Read the node with vtkMRMLNode::ReadBinary() if it was written with
+  /// vtkMRMLNode::WriteBinary().
+  virtual void ReadNodeAttributes(vtkMRMLNode* node, const char** atts);
+
+  //BTX
+  /// Attribute of the element being read, the value points into the buffer.
+  struct BinaryAttribute
+  {
+    const char* Name;
+    unsigned char Type;
+    const char* Value;
+  };
+  const char* FindAttribute(const char* name, unsigned char type);
+
+  std::vector<BinaryAttribute> Attributes;
+  bool ReadingBinaryAttributes;
+  //ETX
+};
+
+#endif
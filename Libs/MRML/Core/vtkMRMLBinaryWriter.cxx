@@ -0,0 +1,519 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLBinaryParser.h"
+#include "vtkMRMLBinaryWriter.h"
+#include "vtkMRMLNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkTagTable.h"
+
+// VTK includes
+#include <vtkCollection.h>
+#include <vtkObjectFactory.h>
+#include <vtkType.h>
+
+// STD includes
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+vtkStandardNewMacro(vtkMRMLBinaryWriter);
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+void AppendByte(std::string& buffer, unsigned char value)
+{
+  buffer += static_cast<char>(value);
+}
+
+//----------------------------------------------------------------------------
+void AppendUInt32(std::string& buffer, unsigned int value)
+{
+  buffer += static_cast<char>(value & 0xff);
+  buffer += static_cast<char>((value >> 8) & 0xff);
+  buffer += static_cast<char>((value >> 16) & 0xff);
+  buffer += static_cast<char>((value >> 24) & 0xff);
+}
+
+//----------------------------------------------------------------------------
+void AppendDouble(std::string& buffer, double value)
+{
+  vtkTypeUInt64 bits;
+  memcpy(&bits, &value, sizeof(bits));
+  for (int i = 0; i < 8; ++i)
+    {
+    buffer += static_cast<char>((bits >> (8 * i)) & 0xff);
+    }
+}
+
+//----------------------------------------------------------------------------
+void AppendString(std::string& buffer, const std::string& value)
+{
+  AppendUInt32(buffer, static_cast<unsigned int>(value.size()));
+  buffer.append(value.c_str(), value.size() + 1);
+}
+
+//----------------------------------------------------------------------------
+void WriteByte(ostream& os, unsigned char value)
+{
+  os.put(static_cast<char>(value));
+}
+
+//----------------------------------------------------------------------------
+void WriteUInt32(ostream& os, unsigned int value)
+{
+  std::string buffer;
+  AppendUInt32(buffer, value);
+  os.write(buffer.c_str(), buffer.size());
+}
+
+//----------------------------------------------------------------------------
+void WriteString(ostream& os, const std::string& value)
+{
+  std::string buffer;
+  AppendString(buffer, value);
+  os.write(buffer.c_str(), buffer.size());
+}
+
+//----------------------------------------------------------------------------
+void AppendUTF8(std::string& str, unsigned long codePoint)
+{
+  if (codePoint < 0x80)
+    {
+    str += static_cast<char>(codePoint);
+    }
+  else if (codePoint < 0x800)
+    {
+    str += static_cast<char>(0xc0 | (codePoint >> 6));
+    str += static_cast<char>(0x80 | (codePoint & 0x3f));
+    }
+  else if (codePoint < 0x10000)
+    {
+    str += static_cast<char>(0xe0 | (codePoint >> 12));
+    str += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+    str += static_cast<char>(0x80 | (codePoint & 0x3f));
+    }
+  else
+    {
+    str += static_cast<char>(0xf0 | (codePoint >> 18));
+    str += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f));
+    str += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+    str += static_cast<char>(0x80 | (codePoint & 0x3f));
+    }
+}
+
+//----------------------------------------------------------------------------
+// Value of the attribute xml[begin, end[ as given by the XML parser:
+// references replaced and white spaces normalized.
+std::string DecodeAttributeValue(const std::string& xml, size_t begin, size_t end)
+{
+  if (xml.find_first_of("&\r\n\t", begin) >= end)
+    {
+    return xml.substr(begin, end - begin);
+    }
+  std::string value;
+  value.reserve(end - begin);
+  for (size_t i = begin; i < end; ++i)
+    {
+    const char c = xml[i];
+    if (c == '&')
+      {
+      size_t semicolon = xml.find(';', i);
+      if (semicolon < end)
+        {
+        std::string reference = xml.substr(i + 1, semicolon - i - 1);
+        bool known = true;
+        if (reference == "amp")
+          {
+          value += '&';
+          }
+        else if (reference == "lt")
+          {
+          value += '<';
+          }
+        else if (reference == "gt")
+          {
+          value += '>';
+          }
+        else if (reference == "quot")
+          {
+          value += '"';
+          }
+        else if (reference == "apos")
+          {
+          value += '\'';
+          }
+        else if (reference.size() > 1 && reference[0] == '#')
+          {
+          const bool hexadecimal = (reference[1] == 'x');
+          AppendUTF8(value, strtoul(reference.c_str() + (hexadecimal ? 2 : 1),
+                                    0, hexadecimal ? 16 : 10));
+          }
+        else
+          {
+          known = false;
+          }
+        if (known)
+          {
+          i = semicolon;
+          continue;
+          }
+        }
+      value += c;
+      }
+    else if (c == '\r')
+      {
+      value += ' ';
+      if (i + 1 < end && xml[i + 1] == '\n')
+        {
+        ++i;
+        }
+      }
+    else if (c == '\n' || c == '\t')
+      {
+      value += ' ';
+      }
+    else
+      {
+      value += c;
+      }
+    }
+  return value;
+}
+
+//----------------------------------------------------------------------------
+bool IsSpace(char c)
+{
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkMRMLBinaryWriter::vtkMRMLBinaryWriter()
+{
+  this->MRMLScene = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLBinaryWriter::~vtkMRMLBinaryWriter()
+{
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLBinaryWriter::Write(const char* fileName)
+{
+  if (!fileName)
+    {
+    vtkErrorMacro("Write: no file name");
+    return false;
+    }
+  std::ofstream file(fileName, std::ios::out | std::ios::binary);
+  if (!file)
+    {
+    vtkErrorMacro("Write: can't write into " << fileName);
+    return false;
+    }
+  return this->Write(file);
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLBinaryWriter::Write(ostream& os)
+{
+  if (!this->MRMLScene)
+    {
+    vtkErrorMacro("Write: no scene");
+    return false;
+    }
+  this->Schemas.clear();
+
+  os.write(vtkMRMLBinaryParser::GetMagic(), vtkMRMLBinaryParser::GetMagicLength());
+  WriteUInt32(os, vtkMRMLBinaryParser::FormatVersion);
+  const char* version = this->MRMLScene->GetVersion();
+  WriteString(os, version ? version : "");
+  std::stringstream userTags;
+  vtkTagTable* userTagTable = this->MRMLScene->GetUserTagTable();
+  if (userTagTable)
+    {
+    int numc = userTagTable->GetNumberOfTags();
+    for (int i = 0; i < numc; ++i)
+      {
+      const char* kwd = userTagTable->GetTagAttribute(i);
+      const char* val = userTagTable->GetTagValue(i);
+      if (kwd != NULL && val != NULL)
+        {
+        userTags << kwd << "=" << val;
+        if (i < (numc - 1))
+          {
+          userTags << " ";
+          }
+        }
+      }
+    }
+  WriteString(os, userTags.str());
+
+  vtkCollection* nodes = this->MRMLScene->GetNodes();
+  for (int n = 0; n < nodes->GetNumberOfItems(); ++n)
+    {
+    vtkMRMLNode* node = vtkMRMLNode::SafeDownCast(nodes->GetItemAsObject(n));
+    if (!node || !node->GetSaveWithScene())
+      {
+      continue;
+      }
+    const char* binaryClassName = node->GetBinaryClassName();
+    if (binaryClassName && !strcmp(binaryClassName, node->GetClassName()))
+      {
+      this->WriteBinaryElement(os, node);
+      continue;
+      }
+    std::stringstream xml;
+    xml << "<" << node->GetNodeTagName() << "\n";
+    node->WriteXML(xml, 1);
+    xml << ">";
+    node->WriteNodeBodyXML(xml, 1);
+    xml << "</" << node->GetNodeTagName() << ">\n";
+    if (!this->WriteElements(os, xml.str()))
+      {
+      vtkErrorMacro("Write: invalid XML written by node "
+                    << (node->GetID() ? node->GetID() : "(none)"));
+      return false;
+      }
+    }
+  WriteByte(os, vtkMRMLBinaryParser::EndOfSceneRecord);
+  return !os.fail();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLBinaryWriter::WriteBinaryElement(ostream& os, vtkMRMLNode* node)
+{
+  this->AttributeNames.clear();
+  this->AttributeTypes.clear();
+  this->AttributeValues.clear();
+  node->WriteBinary(this);
+  unsigned int schema = this->GetSchema(os, node->GetNodeTagName(),
+                                        vtkMRMLBinaryParser::BinaryAttributes);
+  WriteByte(os, vtkMRMLBinaryParser::StartElementRecord);
+  WriteUInt32(os, schema);
+  os.write(this->AttributeValues.c_str(), this->AttributeValues.size());
+  WriteByte(os, vtkMRMLBinaryParser::EndElementRecord);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLBinaryWriter::AddAttribute(const char* name, unsigned char type)
+{
+  this->AttributeNames.push_back(name);
+  this->AttributeTypes.push_back(type);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLBinaryWriter::WriteStringAttribute(const char* name, const char* value)
+{
+  if (!value)
+    {
+    return;
+    }
+  this->AddAttribute(name, vtkMRMLBinaryParser::StringValue);
+  AppendString(this->AttributeValues, value);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLBinaryWriter::WriteStringsAttribute(
+  const char* name, const std::vector<std::string>& values)
+{
+  this->AddAttribute(name, vtkMRMLBinaryParser::StringsValue);
+  AppendUInt32(this->AttributeValues, static_cast<unsigned int>(values.size()));
+  for (size_t i = 0; i < values.size(); ++i)
+    {
+    AppendString(this->AttributeValues, values[i]);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLBinaryWriter::WriteIntAttribute(const char* name, int value)
+{
+  this->AddAttribute(name, vtkMRMLBinaryParser::IntValue);
+  AppendUInt32(this->AttributeValues, static_cast<unsigned int>(value));
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLBinaryWriter::WriteDoubleAttribute(const char* name, double value)
+{
+  this->AddAttribute(name, vtkMRMLBinaryParser::DoubleValue);
+  AppendDouble(this->AttributeValues, value);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLBinaryWriter::WriteDoublesAttribute(
+  const char* name, const double* values, int count)
+{
+  this->AddAttribute(name, vtkMRMLBinaryParser::DoublesValue);
+  AppendUInt32(this->AttributeValues, static_cast<unsigned int>(count));
+  for (int i = 0; i < count; ++i)
+    {
+    AppendDouble(this->AttributeValues, values[i]);
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLBinaryWriter::WriteElements(ostream& os, const std::string& xml)
+{
+  const size_t size = xml.size();
+  int depth = 0;
+  size_t pos = xml.find('<');
+  while (pos != std::string::npos)
+    {
+    if (xml.compare(pos, 4, "<!--") == 0)
+      {
+      pos = xml.find("-->", pos + 4);
+      if (pos == std::string::npos)
+        {
+        return false;
+        }
+      pos = xml.find('<', pos + 3);
+      continue;
+      }
+    if (pos + 1 < size && xml[pos + 1] == '/')
+      {
+      pos = xml.find('>', pos);
+      if (pos == std::string::npos || --depth < 0)
+        {
+        return false;
+        }
+      WriteByte(os, vtkMRMLBinaryParser::EndElementRecord);
+      pos = xml.find('<', pos + 1);
+      continue;
+      }
+
+    // Start element: tag name then attributes until '>' or '/>'
+    size_t nameEnd = ++pos;
+    while (nameEnd < size && !IsSpace(xml[nameEnd]) &&
+           xml[nameEnd] != '>' && xml[nameEnd] != '/')
+      {
+      ++nameEnd;
+      }
+    const std::string tagName = xml.substr(pos, nameEnd - pos);
+    pos = nameEnd;
+    this->AttributeNames.clear();
+    this->AttributeTypes.clear();
+    this->AttributeValues.clear();
+    bool empty = false;
+    while (true)
+      {
+      while (pos < size && IsSpace(xml[pos]))
+        {
+        ++pos;
+        }
+      if (pos >= size)
+        {
+        return false;
+        }
+      if (xml[pos] == '>')
+        {
+        ++pos;
+        break;
+        }
+      if (xml.compare(pos, 2, "/>") == 0)
+        {
+        pos += 2;
+        empty = true;
+        break;
+        }
+      const size_t attributeNameBegin = pos;
+      size_t equal = xml.find('=', pos);
+      if (equal == std::string::npos)
+        {
+        return false;
+        }
+      size_t attributeNameEnd = equal;
+      while (attributeNameEnd > pos && IsSpace(xml[attributeNameEnd - 1]))
+        {
+        --attributeNameEnd;
+        }
+      pos = equal + 1;
+      while (pos < size && IsSpace(xml[pos]))
+        {
+        ++pos;
+        }
+      if (pos >= size || (xml[pos] != '"' && xml[pos] != '\''))
+        {
+        return false;
+        }
+      size_t valueEnd = xml.find(xml[pos], pos + 1);
+      if (valueEnd == std::string::npos)
+        {
+        return false;
+        }
+      this->AttributeNames.push_back(
+        xml.substr(attributeNameBegin, attributeNameEnd - attributeNameBegin));
+      this->AttributeTypes.push_back(vtkMRMLBinaryParser::StringValue);
+      AppendString(this->AttributeValues, DecodeAttributeValue(xml, pos + 1, valueEnd));
+      pos = valueEnd + 1;
+      }
+
+    unsigned int schema = this->GetSchema(os, tagName,
+                                          vtkMRMLBinaryParser::XMLAttributes);
+    WriteByte(os, vtkMRMLBinaryParser::StartElementRecord);
+    WriteUInt32(os, schema);
+    os.write(this->AttributeValues.c_str(), this->AttributeValues.size());
+    if (empty)
+      {
+      WriteByte(os, vtkMRMLBinaryParser::EndElementRecord);
+      }
+    else
+      {
+      ++depth;
+      }
+    pos = xml.find('<', pos);
+    }
+  return depth == 0;
+}
+
+//----------------------------------------------------------------------------
+unsigned int vtkMRMLBinaryWriter::GetSchema(
+  ostream& os, const std::string& tagName, unsigned char attributesType)
+{
+  std::string key = tagName;
+  key += static_cast<char>(attributesType);
+  for (size_t i = 0; i < this->AttributeNames.size(); ++i)
+    {
+    key += '\0';
+    key += this->AttributeNames[i];
+    key += static_cast<char>(this->AttributeTypes[i]);
+    }
+  std::map<std::string, unsigned int>::const_iterator it = this->Schemas.find(key);
+  if (it != this->Schemas.end())
+    {
+    return it->second;
+    }
+  unsigned int schema = static_cast<unsigned int>(this->Schemas.size());
+  this->Schemas[key] = schema;
+  WriteByte(os, vtkMRMLBinaryParser::SchemaRecord);
+  WriteString(os, tagName);
+  WriteByte(os, attributesType);
+  WriteUInt32(os, static_cast<unsigned int>(this->AttributeNames.size()));
+  for (size_t i = 0; i < this->AttributeNames.size(); ++i)
+    {
+    WriteString(os, this->AttributeNames[i]);
+    WriteByte(os, this->AttributeTypes[i]);
+    }
+  return schema;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLBinaryWriter::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "MRMLScene: " << this->MRMLScene << "\n";
+}
@@ -0,0 +1,108 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkMRMLBinaryWriter_h
+#define __vtkMRMLBinaryWriter_h
+
+// MRML includes
+#include "vtkMRML.h"
+class vtkMRMLNode;
+class vtkMRMLScene;
+
+// VTK includes
+#include <vtkObject.h>
+
+// STD includes
+#include <map>
+#include <string>
+#include <vector>
+
+/// \brief Write a scene into a binary scene file.
+///
+/// Nodes whose class implements the binary hooks
+/// (vtkMRMLNode::GetBinaryClassName()) write their attributes as typed values
+/// with vtkMRMLNode::WriteBinary(): numbers are written as raw 32 bits
+/// integers and 64 bits doubles, never formatted into text.
+/// Other nodes are serialized with WriteXML() and WriteNodeBodyXML() like in
+/// vtkMRMLScene::Commit(); their attributes are then unescaped and written as
+/// strings, so that the parser gives them the values the XML parser would.
+/// \sa vtkMRMLBinaryParser
+class VTK_MRML_EXPORT vtkMRMLBinaryWriter : public vtkObject
+{
+public:
+  static vtkMRMLBinaryWriter *New();
+  vtkTypeMacro(vtkMRMLBinaryWriter, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  vtkMRMLScene* GetMRMLScene() {return this->MRMLScene;};
+  void SetMRMLScene(vtkMRMLScene* scene) {this->MRMLScene = scene;};
+
+  ///
+  /// Write the nodes of the scene that are saved with the scene.
+  /// Return false if the file can't be written.
+  bool Write(const char* fileName);
+  //BTX
+  bool Write(ostream& os);
+  //ETX
+
+  ///
+  /// Write an attribute of the node being written.
+  /// To be called from vtkMRMLNode::WriteBinary() only.
+  /// Null strings are not written.
+  void WriteStringAttribute(const char* name, const char* value);
+  //BTX
+  void WriteStringsAttribute(const char* name, const std::vector<std::string>& values);
+  //ETX
+  void WriteIntAttribute(const char* name, int value);
+  void WriteDoubleAttribute(const char* name, double value);
+  void WriteDoublesAttribute(const char* name, const double* values, int count);
+
+protected:
+  vtkMRMLBinaryWriter();
+  ~vtkMRMLBinaryWriter();
+
+  //BTX
+  ///
+  /// Write the record of a node with vtkMRMLNode::WriteBinary().
+  void WriteBinaryElement(ostream& os, vtkMRMLNode* node);
+
+  ///
+  /// Write the records of the XML elements of \a xml.
+  /// Return false if \a xml is not well formed.
+  bool WriteElements(ostream& os, const std::string& xml);
+
+  ///
+  /// Start the record of an attribute of the node being written.
+  void AddAttribute(const char* name, unsigned char type);
+
+  ///
+  /// Index of the schema of the element made of the attributes added,
+  /// written into \a os if new.
+  unsigned int GetSchema(ostream& os, const std::string& tagName,
+                         unsigned char attributesType);
+
+  std::map<std::string, unsigned int> Schemas;
+
+  /// Names, types and encoded values of the attributes of the element
+  /// being written.
+  std::vector<std::string> AttributeNames;
+  std::vector<unsigned char> AttributeTypes;
+  std::string AttributeValues;
+  //ETX
+
+  vtkMRMLScene* MRMLScene;
+
+private:
+  vtkMRMLBinaryWriter(const vtkMRMLBinaryWriter&);  /// Not implemented.
+  void operator=(const vtkMRMLBinaryWriter&);  /// Not implemented.
+};
+
+#endif
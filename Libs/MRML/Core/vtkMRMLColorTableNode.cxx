@@ -18,13 +18,12 @@ Version:   $Revision: 1.0 $
 
 // VTK includes
 #include <vtkLookupTable.h>
+#include <vtkNew.h>
 #include <vtkObjectFactory.h>
 
 // STD includes
 #include <sstream>
 
-vtkCxxSetObjectMacro(vtkMRMLColorTableNode, LookupTable, vtkLookupTable);
-
 //------------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLColorTableNode);
 
@@ -34,6 +33,8 @@ vtkMRMLColorTableNode::vtkMRMLColorTableNode()
   this->SetName("");
   this->SetDescription("Color Table");
   this->LookupTable = NULL;
+  this->LookupTableDeferred = false;
+  this->UpdatingDeferredLookupTable = false;
   this->LastAddedColor = -1;
 }
 
@@ -57,7 +58,7 @@ void vtkMRMLColorTableNode::WriteXML(ostream& of, int nIndent)
 
   // only print out the look up table size so that the table can be
   // initialized properly
-  if (this->LookupTable != NULL)
+  if (this->GetLookupTable() != NULL)
     {
     of << " numcolors=\"" << this->LookupTable->GetNumberOfTableValues() << "\"";
     }
@@ -160,7 +161,21 @@ void vtkMRMLColorTableNode::Copy(vtkMRMLNode *anode)
 
   Superclass::Copy(anode);
   vtkMRMLColorTableNode *node = (vtkMRMLColorTableNode *) anode;
-  if (node->LookupTable)
+  if (node->LookupTableDeferred)
+    {
+    // the table will be built from the type when needed, don't build into
+    // a table that may be shared with other nodes
+    this->SetLookupTable(NULL);
+    this->LookupTableDeferred = true;
+    // the copy is not observed by whoever provides the colors of the
+    // source: it reads them from the file of the source
+    if (this->Type == this->File && node->GetStorageNode() &&
+        node->GetStorageNode()->GetFileName())
+      {
+      this->SetFileName(node->GetStorageNode()->GetFileName());
+      }
+    }
+  else if (node->LookupTable)
     {
     this->SetLookupTable(node->LookupTable);
     }
@@ -173,6 +188,7 @@ void vtkMRMLColorTableNode::PrintSelf(ostream& os, vtkIndent indent)
 {
   Superclass::PrintSelf(os,indent);
 
+  os << indent << "LookupTableDeferred: " << this->LookupTableDeferred << "\n";
   if (this->LookupTable != NULL)
     {
     os << indent << "Look up table:\n";
@@ -573,7 +589,8 @@ void vtkMRMLColorTableNode::ProcessMRMLEvents ( vtkObject *caller,
 //---------------------------------------------------------------------------
 void vtkMRMLColorTableNode::SetType(int type)
 {
-  if (this->GetLookupTable() != NULL &&
+  if (this->LookupTable != NULL &&
+      !this->LookupTableDeferred &&
       this->Type == type)
     {
     vtkDebugMacro("SetType: type is already set to " << type <<  " = " << this->GetTypeAsString());
@@ -581,9 +598,25 @@ void vtkMRMLColorTableNode::SetType(int type)
     }
 
     this->Type = type;
+    this->LookupTableDeferred = false;
 
     vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting Type to " << type << " = " << this->GetTypeAsString());
 
+    if (!this->BuildLookupTable())
+      {
+      return;
+      }
+
+    // invoke a modified event
+    this->Modified();
+
+    // invoke a type  modified event
+    this->InvokeEvent(vtkMRMLColorTableNode::TypeModifiedEvent);
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLColorTableNode::BuildLookupTable()
+{
     //this->LookupTable->Delete();
     if (this->GetLookupTable() == NULL)
       {
@@ -1210,14 +1243,137 @@ void vtkMRMLColorTableNode::SetType(int type)
 
     else
       {
-      vtkErrorMacro("vtkMRMLColorTableNode: SetType ERROR, unknown type " << type << endl);
-      return;
+      vtkErrorMacro("vtkMRMLColorTableNode: SetType ERROR, unknown type " << this->Type << endl);
+      return false;
       }
-    // invoke a modified event
-    this->Modified();
+    return true;
+}
 
-    // invoke a type  modified event
-    this->InvokeEvent(vtkMRMLColorTableNode::TypeModifiedEvent);
+//---------------------------------------------------------------------------
+void vtkMRMLColorTableNode::SetDeferredType(int type)
+{
+  if (type == this->User)
+    {
+    // nothing to build
+    this->SetType(type);
+    return;
+    }
+  if (this->Type == type &&
+      (this->LookupTableDeferred || this->LookupTable != NULL))
+    {
+    return;
+    }
+  this->Type = type;
+  this->LookupTableDeferred = true;
+  this->Modified();
+  this->InvokeEvent(vtkMRMLColorTableNode::TypeModifiedEvent);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLColorTableNode::UpdateDeferredLookupTable()
+{
+  if (!this->LookupTableDeferred)
+    {
+    return;
+    }
+  this->LookupTableDeferred = false;
+  // The colors of the type are not a modification of the node: don't
+  // notify the observers from a Get method (see Modified()).
+  this->UpdatingDeferredLookupTable = true;
+  if (this->Type == this->File)
+    {
+    // observers may provide the colors (e.g. from a cache), otherwise
+    // read them from the file of the storage node, or from the file of
+    // the node it was copied from
+    this->InvokeEvent(vtkMRMLColorTableNode::LoadDeferredColorsEvent);
+    if (this->LookupTable == NULL && this->GetStorageNode() != NULL)
+      {
+      this->GetStorageNode()->ReadData(this);
+      }
+    if (this->LookupTable == NULL && this->GetFileName() != NULL)
+      {
+      vtkNew<vtkMRMLColorTableNode> colors;
+      colors->SetTypeToFile();
+      vtkNew<vtkMRMLColorTableStorageNode> storageNode;
+      storageNode->SetFileName(this->GetFileName());
+      if (storageNode->ReadData(colors.GetPointer()))
+        {
+        this->CopyColors(colors.GetPointer());
+        }
+      }
+    }
+  else
+    {
+    this->BuildLookupTable();
+    }
+  this->UpdatingDeferredLookupTable = false;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLColorTableNode::Modified()
+{
+  // Discarded instead of left pending when modified events are disabled:
+  // nothing would invoke them when the colors are accessed from a Get
+  // method outside of StartModify()/EndModify().
+  if (this->UpdatingDeferredLookupTable)
+    {
+    return;
+    }
+  this->Superclass::Modified();
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLColorTableNode::CopyColors(vtkMRMLColorTableNode* node)
+{
+  if (node == NULL || node->GetLookupTable() == NULL)
+    {
+    return;
+    }
+  // the table is not shared with the source node
+  vtkLookupTable* lookupTable = vtkLookupTable::New();
+  lookupTable->DeepCopy(node->LookupTable);
+  this->SetLookupTable(lookupTable);
+  lookupTable->Delete();
+  this->SetFileName(node->GetFileName());
+  this->SetNoName(node->GetNoName());
+  this->Names = node->Names;
+  this->NamesInitialised = node->NamesInitialised;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLColorTableNode::SetLookupTable(vtkLookupTable* newLookupTable)
+{
+  // an explicit table replaces the colors of the type
+  this->LookupTableDeferred = false;
+  if (this->LookupTable == newLookupTable)
+    {
+    return;
+    }
+  vtkLookupTable* oldLookupTable = this->LookupTable;
+  this->LookupTable = newLookupTable;
+  if (this->LookupTable)
+    {
+    this->LookupTable->Register(this);
+    }
+  if (oldLookupTable)
+    {
+    oldLookupTable->UnRegister(this);
+    }
+  this->Modified();
+}
+
+//---------------------------------------------------------------------------
+vtkLookupTable* vtkMRMLColorTableNode::GetLookupTable()
+{
+  this->UpdateDeferredLookupTable();
+  return this->LookupTable;
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLColorTableNode::GetNamesInitialised()
+{
+  this->UpdateDeferredLookupTable();
+  return this->Superclass::GetNamesInitialised();
 }
 
 //---------------------------------------------------------------------------
@@ -52,13 +52,51 @@ public:
   /// Get node XML tag name (like Volume, Model)
   virtual const char* GetNodeTagName() {return "ColorTable";};
 
-  vtkGetObjectMacro(LookupTable, vtkLookupTable);
+  ///
+  /// Get/Set the look up table. If the type was set with SetDeferredType(),
+  /// the table is built here.
+  virtual vtkLookupTable* GetLookupTable();
   virtual void SetLookupTable(vtkLookupTable* newLookupTable);
 
   ///
   /// Get/Set for Type
   void SetType(int type);
   vtkGetMacro(Type,int);
+
+  ///
+  /// Set the type without building its look up table: the table is built
+  /// the first time the colors are accessed (GetLookupTable(), GetColor(),
+  /// GetColorName()...). Useful for the default color nodes that are
+  /// added to every scene but rarely all used.
+  /// For the File type, LoadDeferredColorsEvent is invoked first so that
+  /// an observer can provide the colors with CopyColors(), the file of the
+  /// storage node is read otherwise. A copy of the node (Copy()) reads the
+  /// file of the storage node of the copied node.
+  /// Building the table doesn't modify the node.
+  /// \sa SetType(), GetLookupTableDeferred()
+  void SetDeferredType(int type);
+
+  ///
+  /// Reimplemented to not invoke ModifiedEvent while the deferred look up
+  /// table is built.
+  virtual void Modified();
+
+  ///
+  /// Copy the colors and their names from \a node (the look up table is
+  /// deep copied).
+  void CopyColors(vtkMRMLColorTableNode* node);
+
+  /// LoadDeferredColorsEvent is invoked when the colors of a node with the
+  /// deferred File type are accessed for the first time.
+  enum
+    {
+      LoadDeferredColorsEvent = 20003
+    };
+
+  ///
+  /// Return true if the type was set with SetDeferredType() and the
+  /// look up table is not built yet.
+  vtkGetMacro(LookupTableDeferred, bool);
   void SetTypeToFullRainbow();
   void SetTypeToGrey();
   void SetTypeToIron();
@@ -208,6 +246,10 @@ public:
   /// Return true if the color exists, false otherwise
   virtual bool GetColor(int entry, double color[4]);
 
+  ///
+  /// Reimplemented to build the deferred look up table first
+  virtual int GetNamesInitialised();
+
   ///
   /// clear out the names list
   void ClearNames();
@@ -231,9 +273,20 @@ protected:
   vtkMRMLColorTableNode(const vtkMRMLColorTableNode&);
   void operator=(const vtkMRMLColorTableNode&);
 
+  ///
+  /// Fill the look up table with the colors of the Type.
+  /// Return false if the type is unknown.
+  bool BuildLookupTable();
+
+  ///
+  /// Build the look up table if it was deferred
+  void UpdateDeferredLookupTable();
+
   ///
   /// The look up table, constructed according to the Type
   vtkLookupTable *LookupTable;
+  bool LookupTableDeferred;
+  bool UpdatingDeferredLookupTable;
 
 };
 
@@ -14,6 +14,8 @@ Version:   $Revision: 1.3 $
 
 // MRML includes
 #include "vtkEventBroker.h"
+#include "vtkMRMLBinaryParser.h"
+#include "vtkMRMLBinaryWriter.h"
 #include "vtkMRMLColorNode.h"
 #include "vtkMRMLDisplayNode.h"
 #include "vtkMRMLDisplayableNode.h"
@@ -215,6 +217,110 @@ void vtkMRMLDisplayNode::WriteXML(ostream& of, int nIndent)
   of << " ";
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLDisplayNode::WriteBinary(vtkMRMLBinaryWriter* writer)
+{
+  Superclass::WriteBinary(writer);
+
+  writer->WriteDoublesAttribute("color", this->Color, 3);
+  writer->WriteDoublesAttribute("edgeColor", this->EdgeColor, 3);
+  writer->WriteDoublesAttribute("selectedColor", this->SelectedColor, 3);
+  writer->WriteDoubleAttribute("selectedAmbient", this->SelectedAmbient);
+  writer->WriteDoubleAttribute("ambient", this->Ambient);
+  writer->WriteDoubleAttribute("diffuse", this->Diffuse);
+  writer->WriteDoubleAttribute("selectedSpecular", this->SelectedSpecular);
+  writer->WriteDoubleAttribute("specular", this->Specular);
+  writer->WriteDoubleAttribute("power", this->Power);
+  writer->WriteDoubleAttribute("opacity", this->Opacity);
+  writer->WriteDoubleAttribute("pointSize", this->PointSize);
+  writer->WriteDoubleAttribute("lineWidth", this->LineWidth);
+  writer->WriteIntAttribute("representation", this->Representation);
+  writer->WriteIntAttribute("lighting", this->Lighting);
+  writer->WriteIntAttribute("interpolation", this->Interpolation);
+  writer->WriteIntAttribute("shading", this->Shading);
+  writer->WriteIntAttribute("visibility", this->Visibility);
+  writer->WriteIntAttribute("edgeVisibility", this->EdgeVisibility);
+  writer->WriteIntAttribute("clipping", this->Clipping);
+  writer->WriteIntAttribute("sliceIntersectionVisibility", this->SliceIntersectionVisibility);
+  writer->WriteIntAttribute("sliceIntersectionThickness", this->SliceIntersectionThickness);
+  writer->WriteIntAttribute("frontfaceCulling", this->FrontfaceCulling);
+  writer->WriteIntAttribute("backfaceCulling", this->BackfaceCulling);
+  writer->WriteIntAttribute("scalarVisibility", this->ScalarVisibility);
+  writer->WriteIntAttribute("vectorVisibility", this->VectorVisibility);
+  writer->WriteIntAttribute("tensorVisibility", this->TensorVisibility);
+  writer->WriteIntAttribute("interpolateTexture", this->InterpolateTexture);
+  writer->WriteIntAttribute("scalarRangeFlag", this->ScalarRangeFlag);
+  writer->WriteIntAttribute("autoScalarRange", this->AutoScalarRange);
+  writer->WriteDoublesAttribute("scalarRange", this->ScalarRange, 2);
+  writer->WriteStringAttribute("colorNodeID", this->ColorNodeID);
+  writer->WriteStringAttribute("activeScalarName", this->ActiveScalarName);
+  if (this->ViewNodeIDs.size() > 0)
+    {
+    writer->WriteStringsAttribute("viewNodeRef", this->ViewNodeIDs);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLDisplayNode::ReadBinary(vtkMRMLBinaryParser* parser)
+{
+  int disabledModify = this->StartModify();
+
+  Superclass::ReadBinary(parser);
+
+  parser->GetDoublesAttribute("color", this->Color, 3);
+  parser->GetDoublesAttribute("edgeColor", this->EdgeColor, 3);
+  parser->GetDoublesAttribute("selectedColor", this->SelectedColor, 3);
+  parser->GetDoubleAttribute("selectedAmbient", this->SelectedAmbient);
+  parser->GetDoubleAttribute("ambient", this->Ambient);
+  parser->GetDoubleAttribute("diffuse", this->Diffuse);
+  parser->GetDoubleAttribute("selectedSpecular", this->SelectedSpecular);
+  parser->GetDoubleAttribute("specular", this->Specular);
+  parser->GetDoubleAttribute("power", this->Power);
+  parser->GetDoubleAttribute("opacity", this->Opacity);
+  parser->GetDoubleAttribute("pointSize", this->PointSize);
+  parser->GetDoubleAttribute("lineWidth", this->LineWidth);
+  parser->GetIntAttribute("representation", this->Representation);
+  parser->GetIntAttribute("lighting", this->Lighting);
+  parser->GetIntAttribute("interpolation", this->Interpolation);
+  parser->GetIntAttribute("shading", this->Shading);
+  parser->GetIntAttribute("visibility", this->Visibility);
+  parser->GetIntAttribute("edgeVisibility", this->EdgeVisibility);
+  parser->GetIntAttribute("clipping", this->Clipping);
+  parser->GetIntAttribute("sliceIntersectionVisibility", this->SliceIntersectionVisibility);
+  parser->GetIntAttribute("sliceIntersectionThickness", this->SliceIntersectionThickness);
+  parser->GetIntAttribute("frontfaceCulling", this->FrontfaceCulling);
+  parser->GetIntAttribute("backfaceCulling", this->BackfaceCulling);
+  parser->GetIntAttribute("scalarVisibility", this->ScalarVisibility);
+  parser->GetIntAttribute("vectorVisibility", this->VectorVisibility);
+  parser->GetIntAttribute("tensorVisibility", this->TensorVisibility);
+  parser->GetIntAttribute("interpolateTexture", this->InterpolateTexture);
+  int scalarRangeFlag = 0;
+  if (parser->GetIntAttribute("scalarRangeFlag", scalarRangeFlag))
+    {
+    this->SetScalarRangeFlag(scalarRangeFlag);
+    }
+  parser->GetIntAttribute("autoScalarRange", this->AutoScalarRange);
+  parser->GetDoublesAttribute("scalarRange", this->ScalarRange, 2);
+  if (const char* colorNodeID = parser->GetStringAttribute("colorNodeID"))
+    {
+    this->SetAndObserveColorNodeID(colorNodeID);
+    }
+  if (const char* activeScalarName = parser->GetStringAttribute("activeScalarName"))
+    {
+    this->SetActiveScalarName(activeScalarName);
+    }
+  std::vector<std::string> viewNodeIDs;
+  if (parser->GetStringsAttribute("viewNodeRef", viewNodeIDs))
+    {
+    for (size_t i = 0; i < viewNodeIDs.size(); ++i)
+      {
+      this->AddViewNodeID(viewNodeIDs[i].c_str());
+      }
+    }
+
+  this->EndModify(disabledModify);
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLDisplayNode::SetSceneReferences()
 {
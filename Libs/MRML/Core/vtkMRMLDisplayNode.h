@@ -92,6 +92,14 @@ public:
   /// \sa vtkMRMLScene::Commit()
   virtual void WriteXML(ostream& of, int indent);
 
+  /// Write this node's attributes into a binary scene.
+  /// \sa vtkMRMLBinaryWriter
+  virtual void WriteBinary(vtkMRMLBinaryWriter* writer);
+
+  /// Set node attributes from a binary scene.
+  /// \sa vtkMRMLBinaryParser
+  virtual void ReadBinary(vtkMRMLBinaryParser* parser);
+
   /// Copy the node's attributes to this object.
   virtual void Copy(vtkMRMLNode *node);
 
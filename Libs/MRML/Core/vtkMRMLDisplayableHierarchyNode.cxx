@@ -13,6 +13,8 @@ Version:   $Revision: 1.3 $
 =========================================================================auto=*/
 
 // MRML includes
+#include "vtkMRMLBinaryParser.h"
+#include "vtkMRMLBinaryWriter.h"
 #include "vtkMRMLDisplayNode.h"
 #include "vtkMRMLDisplayableNode.h"
 #include "vtkMRMLDisplayableHierarchyNode.h"
@@ -62,6 +64,31 @@ void vtkMRMLDisplayableHierarchyNode::WriteXML(ostream& of, int nIndent)
   of << indent << " expanded=\"" << (this->Expanded ? "true" : "false") << "\"";
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLDisplayableHierarchyNode::WriteBinary(vtkMRMLBinaryWriter* writer)
+{
+  Superclass::WriteBinary(writer);
+
+  writer->WriteStringAttribute("displayNodeID", this->DisplayNodeID);
+  writer->WriteIntAttribute("expanded", this->Expanded);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLDisplayableHierarchyNode::ReadBinary(vtkMRMLBinaryParser* parser)
+{
+  int disabledModify = this->StartModify();
+
+  Superclass::ReadBinary(parser);
+
+  if (const char* displayNodeID = parser->GetStringAttribute("displayNodeID"))
+    {
+    this->SetDisplayNodeID(displayNodeID);
+    }
+  parser->GetIntAttribute("expanded", this->Expanded);
+
+  this->EndModify(disabledModify);
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLDisplayableHierarchyNode::SetSceneReferences()
 {
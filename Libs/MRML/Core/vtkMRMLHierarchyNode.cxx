@@ -13,6 +13,8 @@ Version:   $Revision: 1.14 $
 =========================================================================auto=*/
 
 // MRML includes
+#include "vtkMRMLBinaryParser.h"
+#include "vtkMRMLBinaryWriter.h"
 #include "vtkMRMLHierarchyNode.h"
 #include "vtkMRMLScene.h"
 #include "vtkMRMLHierarchyStorageNode.h"
@@ -99,6 +101,41 @@ void vtkMRMLHierarchyNode::WriteXML(ostream& of, int nIndent)
   of << indent << " allowMultipleChildren=\"" << (this->AllowMultipleChildren ? "true" : "false") << "\"";
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLHierarchyNode::WriteBinary(vtkMRMLBinaryWriter* writer)
+{
+  Superclass::WriteBinary(writer);
+
+  writer->WriteStringAttribute("parentNodeRef", this->ParentNodeIDReference);
+  writer->WriteStringAttribute("associatedNodeRef", this->AssociatedNodeIDReference);
+  writer->WriteDoubleAttribute("sortingValue", this->SortingValue);
+  writer->WriteIntAttribute("allowMultipleChildren", this->AllowMultipleChildren);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLHierarchyNode::ReadBinary(vtkMRMLBinaryParser* parser)
+{
+  int disabledModify = this->StartModify();
+
+  Superclass::ReadBinary(parser);
+
+  if (const char* parentNodeID = parser->GetStringAttribute("parentNodeRef"))
+    {
+    // dont reset SortingValue
+    double sortingValue = this->GetSortingValue();
+    this->SetParentNodeID(parentNodeID);
+    this->SetSortingValue(sortingValue);
+    }
+  if (const char* associatedNodeID = parser->GetStringAttribute("associatedNodeRef"))
+    {
+    this->SetAssociatedNodeID(associatedNodeID);
+    }
+  parser->GetDoubleAttribute("sortingValue", this->SortingValue);
+  parser->GetIntAttribute("allowMultipleChildren", this->AllowMultipleChildren);
+
+  this->EndModify(disabledModify);
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLHierarchyNode::UpdateReferenceID(const char *oldID, const char *newID)
 {
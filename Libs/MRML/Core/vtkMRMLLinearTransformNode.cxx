@@ -13,6 +13,8 @@ Version:   $Revision: 1.14 $
 =========================================================================auto=*/
 
 // MRML includes
+#include "vtkMRMLBinaryParser.h"
+#include "vtkMRMLBinaryWriter.h"
 #include "vtkMRMLLinearTransformNode.h"
 
 // VTK includes
@@ -71,6 +73,38 @@ void vtkMRMLLinearTransformNode::WriteXML(ostream& of, int nIndent)
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLLinearTransformNode::WriteBinary(vtkMRMLBinaryWriter* writer)
+{
+  Superclass::WriteBinary(writer);
+
+  if (this->IsLinear())
+    {
+    // Only write the matrix to the scene if the object stores a linear transform
+    vtkNew<vtkMatrix4x4> matrix;
+    this->GetMatrixTransformToParent(matrix.GetPointer());
+    writer->WriteDoublesAttribute("matrixTransformToParent", &matrix->Element[0][0], 16);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLLinearTransformNode::ReadBinary(vtkMRMLBinaryParser* parser)
+{
+  // Temporarily disable all Modified and TransformModified events to make sure that
+  // the operations are performed without interruption.
+  int disabledModify = this->StartModify();
+
+  Superclass::ReadBinary(parser);
+
+  vtkNew<vtkMatrix4x4> matrix;
+  if (parser->GetDoublesAttribute("matrixTransformToParent", &matrix->Element[0][0], 16))
+    {
+    this->SetMatrixTransformToParent(matrix.GetPointer());
+    }
+
+  this->EndModify(disabledModify);
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLLinearTransformNode::ReadXMLAttributes(const char** atts)
 {
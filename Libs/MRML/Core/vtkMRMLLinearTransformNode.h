@@ -45,6 +45,18 @@ class VTK_MRML_EXPORT vtkMRMLLinearTransformNode : public vtkMRMLTransformNode
   /// Write this node's information to a MRML file in XML format.
   virtual void WriteXML(ostream& of, int indent);
 
+  ///
+  /// Write this node's attributes into a binary scene.
+  virtual void WriteBinary(vtkMRMLBinaryWriter* writer);
+
+  ///
+  /// Set node attributes from a binary scene.
+  virtual void ReadBinary(vtkMRMLBinaryParser* parser);
+
+  ///
+  /// Nodes of this class are saved in binary scenes with WriteBinary().
+  virtual const char* GetBinaryClassName() {return "vtkMRMLLinearTransformNode";};
+
   ///
   /// Copy the node's attributes to this object
   virtual void Copy(vtkMRMLNode *node);
@@ -40,6 +40,9 @@ public:
   /// Get node XML tag name (like Volume, Model)
   virtual const char* GetNodeTagName() {return "ModelDisplay";};
 
+  /// Nodes of this class are saved in binary scenes with WriteBinary().
+  virtual const char* GetBinaryClassName() {return "vtkMRMLModelDisplayNode";};
+
   /// Set and observe poly data for this model. It should be the output
   /// polydata of the model node.
 #if (VTK_MAJOR_VERSION <= 5)
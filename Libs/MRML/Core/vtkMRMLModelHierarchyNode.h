@@ -41,6 +41,10 @@ public:
   /// Write this node's information to a MRML file in XML format.
   virtual void WriteXML(ostream& of, int indent);
 
+  ///
+  /// Nodes of this class are saved in binary scenes with WriteBinary().
+  virtual const char* GetBinaryClassName() {return "vtkMRMLModelHierarchyNode";};
+
 
   ///
   /// Copy the node's attributes to this object
@@ -52,6 +52,9 @@ public:
   /// Get node XML tag name (like Volume, Model)
   virtual const char* GetNodeTagName() {return "Model";};
 
+  /// Nodes of this class are saved in binary scenes with WriteBinary().
+  virtual const char* GetBinaryClassName() {return "vtkMRMLModelNode";};
+
  /// Description:
   /// Copy the node's attributes to this object
   virtual void Copy(vtkMRMLNode *node);
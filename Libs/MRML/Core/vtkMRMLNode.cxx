@@ -13,6 +13,8 @@ Version:   $Revision: 1.11 $
 =========================================================================auto=*/
 
 // MRML includes
+#include "vtkMRMLBinaryParser.h"
+#include "vtkMRMLBinaryWriter.h"
 #include "vtkMRMLNode.h"
 #include "vtkMRMLScene.h"
 
@@ -524,6 +526,91 @@ void vtkMRMLNode::WriteNodeBodyXML(ostream &, int )
 {
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLNode::WriteBinary(vtkMRMLBinaryWriter* writer)
+{
+  writer->WriteStringAttribute("id", this->ID);
+  writer->WriteStringAttribute("name", this->Name);
+  writer->WriteStringAttribute("description", this->Description);
+  writer->WriteIntAttribute("hideFromEditors", this->HideFromEditors);
+  writer->WriteIntAttribute("selectable", this->Selectable);
+  writer->WriteIntAttribute("selected", this->Selected);
+  if (this->Attributes.size())
+    {
+    // name and value of each attribute
+    std::vector<std::string> attributes;
+    AttributesType::const_iterator it;
+    for (it = this->Attributes.begin(); it != this->Attributes.end(); ++it)
+      {
+      attributes.push_back(it->first);
+      attributes.push_back(it->second);
+      }
+    writer->WriteStringsAttribute("attributes", attributes);
+    }
+
+  // role and ID of each node reference
+  std::vector<std::string> references;
+  NodeReferencesType::iterator it;
+  for (it = this->NodeReferences.begin(); it != this->NodeReferences.end(); it++)
+    {
+    const std::string& referenceRole = it->first;
+    int numReferencedNodes = this->GetNumberOfNodeReferences(referenceRole.c_str());
+    for (int n=0; n < numReferencedNodes; n++)
+      {
+      const char * id = this->GetNthNodeReferenceID(referenceRole.c_str(), n);
+      if (id)
+        {
+        references.push_back(referenceRole);
+        references.push_back(id);
+        }
+      }
+    }
+  if (!references.empty())
+    {
+    writer->WriteStringsAttribute("references", references);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLNode::ReadBinary(vtkMRMLBinaryParser* parser)
+{
+  int disabledModify = this->StartModify();
+
+  if (const char* id = parser->GetStringAttribute("id"))
+    {
+    this->SetID(id);
+    }
+  if (const char* name = parser->GetStringAttribute("name"))
+    {
+    this->SetName(name);
+    }
+  if (const char* description = parser->GetStringAttribute("description"))
+    {
+    this->SetDescription(description);
+    }
+  parser->GetIntAttribute("hideFromEditors", this->HideFromEditors);
+  parser->GetIntAttribute("selectable", this->Selectable);
+  parser->GetIntAttribute("selected", this->Selected);
+
+  std::vector<std::string> values;
+  if (parser->GetStringsAttribute("attributes", values))
+    {
+    for (size_t i = 0; i + 1 < values.size(); i += 2)
+      {
+      this->SetAttribute(values[i].c_str(), values[i + 1].c_str());
+      }
+    }
+  if (parser->GetStringsAttribute("references", values))
+    {
+    for (size_t i = 0; i + 1 < values.size(); i += 2)
+      {
+      this->AddNodeReferenceID(values[i].c_str(), values[i + 1].c_str());
+      }
+    }
+
+  this->EndModify(disabledModify);
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLNode::ProcessMRMLEvents (vtkObject *caller,
                                      unsigned long event,
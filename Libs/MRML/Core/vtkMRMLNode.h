@@ -21,6 +21,8 @@
 #include "vtkIdTypeArray.h"
 #include "vtkIntArray.h"
 
+class vtkMRMLBinaryParser;
+class vtkMRMLBinaryWriter;
 class vtkMRMLScene;
 
 
@@ -190,6 +192,31 @@ public:
   /// Write this node's body to a MRML file in XML format.
   virtual void WriteNodeBodyXML(ostream& of, int indent);
 
+  /// \brief Class whose WriteBinary() and ReadBinary() save all the
+  /// attributes of the node.
+  ///
+  /// A node is saved in a binary scene with WriteBinary() only if it is the
+  /// class of the node, otherwise WriteXML() is used.
+  /// \note
+  /// Subclasses that implement WriteBinary() and ReadBinary() (or have no
+  /// attribute to add) and no node body should reimplement this method.
+  /// \sa vtkMRMLBinaryWriter
+  virtual const char* GetBinaryClassName() {return 0;};
+
+  /// Write this node's attributes as typed values into a binary scene.
+  ///
+  /// \note
+  /// Subclasses should implement this method if they implement WriteXML().
+  /// Call this method in the subclass implementation.
+  virtual void WriteBinary(vtkMRMLBinaryWriter* writer);
+
+  /// Set node attributes from the typed values written by WriteBinary().
+  ///
+  /// \note
+  /// Subclasses should implement this method if they implement WriteBinary().
+  /// Call this method in the subclass implementation.
+  virtual void ReadBinary(vtkMRMLBinaryParser* parser);
+
   /// \brief Copy parameters (not including ID and Scene) from another node
   /// of the same type.
   ///
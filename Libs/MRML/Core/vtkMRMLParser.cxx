@@ -16,6 +16,7 @@ Version:   $Revision: 1.8 $
 #include "vtkMRMLParser.h"
 #include "vtkMRMLScene.h"
 #include "vtkMRMLNode.h"
+#include "vtkMRMLSceneProfiler.h"
 #include "vtkTagTable.h"
 
 // VTK includes
@@ -96,7 +97,12 @@ void vtkMRMLParser::StartElement(const char* tagName, const char** atts)
       }
     }
 
-  vtkMRMLNode* node = this->MRMLScene->CreateNodeByClass( className.c_str() );
+  vtkMRMLSceneProfiler* profiler = this->MRMLScene->GetProfiler();
+  vtkMRMLNode* node = 0;
+  {
+  vtkMRMLSceneProfilerScope profilerScope(profiler, "CreateNode", className.c_str());
+  node = this->MRMLScene->CreateNodeByClass( className.c_str() );
+  }
   if (!node)
     {
     vtkWarningMacro(<< "Failed to CreateNodeByClass: " << className);
@@ -107,7 +113,10 @@ void vtkMRMLParser::StartElement(const char* tagName, const char** atts)
   // called on storage nodes.
   node->SetScene(this->GetMRMLScene());
 
-  node->ReadXMLAttributes(atts);
+  {
+  vtkMRMLSceneProfilerScope profilerScope(profiler, "ReadXMLAttributes", className.c_str());
+  this->ReadNodeAttributes(node, atts);
+  }
 
   // Slicer3 snap shot nodes were hidden by default, show them so that
   // they show up in the tree views
@@ -165,6 +174,12 @@ void vtkMRMLParser::StartElement(const char* tagName, const char** atts)
   node->Delete();
 }
 
+//-----------------------------------------------------------------------------
+void vtkMRMLParser::ReadNodeAttributes(vtkMRMLNode* node, const char** atts)
+{
+  node->ReadXMLAttributes(atts);
+}
+
 //-----------------------------------------------------------------------------
 
 void vtkMRMLParser::EndElement (const char *name)
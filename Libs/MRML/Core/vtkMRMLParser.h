@@ -49,6 +49,10 @@ protected:
   virtual void StartElement(const char* name, const char** atts);
   virtual void EndElement (const char *name);
 
+  /// Set the attributes of a node created by StartElement().
+  /// Call vtkMRMLNode::ReadXMLAttributes() by default.
+  virtual void ReadNodeAttributes(vtkMRMLNode* node, const char** atts);
+
 private:
   vtkMRMLScene* MRMLScene;
   vtkCollection* NodeCollection;
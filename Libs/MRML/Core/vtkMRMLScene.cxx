@@ -13,7 +13,10 @@ Version:   $Revision: 1.18 $
 =========================================================================auto=*/
 
 #include "vtkMRMLScene.h"
+#include "vtkMRMLBinaryParser.h"
+#include "vtkMRMLBinaryWriter.h"
 #include "vtkMRMLParser.h"
+#include "vtkMRMLSceneProfiler.h"
 
 #include "vtkCacheManager.h"
 #include "vtkDataIOManager.h"
@@ -98,6 +101,7 @@ Version:   $Revision: 1.18 $
 vtkCxxSetObjectMacro(vtkMRMLScene, CacheManager, vtkCacheManager)
 vtkCxxSetObjectMacro(vtkMRMLScene, DataIOManager, vtkDataIOManager)
 vtkCxxSetObjectMacro(vtkMRMLScene, UserTagTable, vtkTagTable)
+vtkCxxSetObjectMacro(vtkMRMLScene, Profiler, vtkMRMLSceneProfiler)
 vtkCxxSetObjectMacro(vtkMRMLScene, URIHandlerCollection, vtkCollection)
 
 //------------------------------------------------------------------------------
@@ -122,6 +126,7 @@ vtkMRMLScene::vtkMRMLScene()
   this->DataIOManager = NULL;
   this->URIHandlerCollection = NULL;
   this->UserTagTable = NULL;
+  this->Profiler = NULL;
 
   this->ErrorCode = 0;
 
@@ -249,6 +254,7 @@ vtkMRMLScene::~vtkMRMLScene()
     this->URIHandlerCollection->Delete();
     this->URIHandlerCollection = NULL;
     }
+  this->SetProfiler(NULL);
   if ( this->UserTagTable != NULL )
     {
     this->UserTagTable->Delete();
@@ -287,6 +293,7 @@ void vtkMRMLScene::Clear(int removeSingletons)
   vtkTimerLog* timer = vtkTimerLog::New();
   timer->StartTimer();
 #endif
+  vtkMRMLSceneProfilerScope profilerScope(this->Profiler, "Scene", "Clear");
   bool undoFlag = this->GetUndoFlag();
   this->SetUndoOff();
   this->StartState(vtkMRMLScene::CloseState);
@@ -632,34 +639,24 @@ int vtkMRMLScene::Connect()
   assert(!this->IsClosing());
   assert(!this->IsImporting());
 
-#ifdef MRMLSCENE_VERBOSE
-  vtkTimerLog* timer = vtkTimerLog::New();
-  timer->StartTimer();
-#endif
+  vtkMRMLSceneProfilerScope profilerScope(this->Profiler, "Scene", "Connect");
   this->StartState(vtkMRMLScene::BatchProcessState);
   this->Clear(0);
   bool undoFlag = this->GetUndoFlag();
   int res = this->Import();
 
+  {
+  vtkMRMLSceneProfilerScope endBatchScope(this->Profiler, "Observers", "EndBatchProcessEvent");
   this->EndState(vtkMRMLScene::BatchProcessState);
+  }
   this->SetUndoFlag(undoFlag);
-#ifdef MRMLSCENE_VERBOSE
-  timer->StopTimer();
-  std::cerr << "vtkMRMLScene::Connect():" << timer->GetElapsedTime() << "\n";
-  timer->Delete();
-#endif
   return res;
 }
 
 //------------------------------------------------------------------------------
 int vtkMRMLScene::Import()
 {
-#ifdef MRMLSCENE_VERBOSE
-  vtkTimerLog* addNodesTimer = vtkTimerLog::New();
-  vtkTimerLog* updateSceneTimer = vtkTimerLog::New();
-  vtkTimerLog* timer = vtkTimerLog::New();
-  timer->StartTimer();
-#endif
+  vtkMRMLSceneProfilerScope profilerScope(this->Profiler, "Scene", "Import");
   this->SetErrorCode(0);
   this->SetErrorMessage(std::string(""));
 
@@ -688,28 +685,31 @@ int vtkMRMLScene::Import()
       {
       this->AddReservedID(node->GetID());
       }
-#ifdef MRMLSCENE_VERBOSE
-    addNodesTimer->StartTimer();
-#endif
+    {
+    vtkMRMLSceneProfilerScope addNodesScope(this->Profiler, "Scene", "AddNodes");
     for (loadedNodes->InitTraversal(it);
          (node = (vtkMRMLNode*)loadedNodes->GetNextItemAsObject(it)) ;)
       {
       this->AddNode(node);
       }
-#ifdef MRMLSCENE_VERBOSE
-    addNodesTimer->StopTimer();
-    updateSceneTimer->StartTimer();
-#endif
+    }
     // Update the node references to the changed node IDs
     // (that conflicted in the current scene and the imported scene)
+    {
+    vtkMRMLSceneProfilerScope updateReferencesScope(this->Profiler, "Scene", "UpdateNodeReferences");
     this->UpdateNodeReferences(loadedNodes);
+    }
     this->RemoveReservedIDs();
 
+    {
+    vtkMRMLSceneProfilerScope newSceneScope(this->Profiler, "Observers", "NewSceneEvent");
     this->InvokeEvent(vtkMRMLScene::NewSceneEvent, NULL);
+    }
 
     // Notify the imported nodes about that all nodes are created
     // (so the observers can be attached to referenced nodes, etc.)
     // by calling UpdateScene on each node
+    vtkMRMLSceneProfilerScope updateSceneScope(this->Profiler, "Scene", "UpdateScene");
     for (loadedNodes->InitTraversal(it);
          (node = (vtkMRMLNode*)loadedNodes->GetNextItemAsObject(it)) ;)
       {
@@ -718,6 +718,7 @@ int vtkMRMLScene::Import()
       vtkDebugMacro("Adding Node: " << node->GetName());
       if (node->GetAddToScene())
         {
+        vtkMRMLSceneProfilerScope nodeScope(this->Profiler, "UpdateScene", node->GetClassName());
         node->UpdateScene(this);
         }
       if (this->GetErrorCode() == 1)
@@ -733,9 +734,6 @@ int vtkMRMLScene::Import()
 
     this->Modified();
     this->RemoveUnusedNodeReferences();
-#ifdef MRMLSCENE_VERBOSE
-    updateSceneTimer->StopTimer();
-#endif
     }
   else
     {
@@ -746,14 +744,10 @@ int vtkMRMLScene::Import()
 
   this->SetUndoFlag(undoFlag);
 
-#ifdef MRMLSCENE_VERBOSE
-  vtkTimerLog* importingTimer = vtkTimerLog::New();
-  importingTimer->StartTimer();
-#endif
+  {
+  vtkMRMLSceneProfilerScope endImportScope(this->Profiler, "Observers", "EndImportEvent");
   this->EndState(vtkMRMLScene::ImportState);
-#ifdef MRMLSCENE_VERBOSE
-  importingTimer->StopTimer();
-#endif
+  }
 
   int returnCode = parsingSuccess; // nonzero = success
   if (this->GetErrorCode() != 0)
@@ -761,17 +755,6 @@ int vtkMRMLScene::Import()
     // error was reported, return with 0 (failure)
     returnCode = 0;
     }
-#ifdef MRMLSCENE_VERBOSE
-  timer->StopTimer();
-  std::cerr<<"vtkMRMLScene::Import()::AddNodes:" << addNodesTimer->GetElapsedTime() << "\n";
-  std::cerr<< "vtkMRMLScene::Import()::UpdateScene" << updateSceneTimer->GetElapsedTime() << "\n";
-  std::cerr<<"vtkMRMLScene::Import()::SceneImported:" << importingTimer->GetElapsedTime() << "\n";
-  std::cerr<<"vtkMRMLScene::Import():" << timer->GetElapsedTime() << "\n";
-  addNodesTimer->Delete();
-  updateSceneTimer->Delete();
-  importingTimer->Delete();
-  timer->Delete();
-#endif
   this->StoredTime.Modified();
   return returnCode;
 }
@@ -823,7 +806,16 @@ int vtkMRMLScene::LoadIntoScene(vtkCollection* nodeCollection)
     {
     this->RootDirectory = std::string("./");
     }
-  vtkMRMLParser* parser = vtkMRMLParser::New();
+  vtkMRMLParser* parser = 0;
+  if (!this->GetLoadFromXMLString() &&
+      vtkMRMLBinaryParser::IsBinaryScene(this->URL.c_str()))
+    {
+    parser = vtkMRMLBinaryParser::New();
+    }
+  else
+    {
+    parser = vtkMRMLParser::New();
+    }
   parser->SetMRMLScene(this);
   if (nodeCollection != this->Nodes)
     {
@@ -831,6 +823,7 @@ int vtkMRMLScene::LoadIntoScene(vtkCollection* nodeCollection)
     }
 
   int result = 0; // 0 means failure
+  vtkMRMLSceneProfilerScope profilerScope(this->Profiler, "Scene", "ParseXML");
   if (this->GetLoadFromXMLString())
     {
     result = parser->Parse(this->GetSceneXMLString().c_str());
@@ -865,6 +858,35 @@ int vtkMRMLScene::Commit(const char* url)
       }
     }
 
+  if (!this->GetSaveToXMLString() &&
+      vtkMRMLBinaryParser::IsBinarySceneFileName(url))
+    {
+    // set the root directory from the URL
+    this->RootDirectory = vtksys::SystemTools::GetParentDirectory(url);
+
+    vtkMRMLBinaryWriter* writer = vtkMRMLBinaryWriter::New();
+    writer->SetMRMLScene(this);
+    bool written = writer->Write(url);
+    writer->Delete();
+    if (!written)
+      {
+      vtkErrorMacro("Write: Could not write binary scene " << url);
+#if (VTK_MAJOR_VERSION <= 5)
+      this->SetErrorCode(2);
+#else
+      this->SetErrorCode(vtkErrorCode::GetErrorCodeFromString("CannotOpenFileError"));
+#endif
+      return 0;
+      }
+#if (VTK_MAJOR_VERSION <= 5)
+    this->SetErrorCode(0);
+#else
+    this->SetErrorCode(vtkErrorCode::GetErrorCodeFromString("NoError"));
+#endif
+    this->StoredTime.Modified();
+    return 1;
+    }
+
   vtkMRMLNode *node;
 
   std::stringstream oss;
@@ -1147,12 +1169,10 @@ vtkMRMLNode*  vtkMRMLScene::AddNode(vtkMRMLNode *n)
     // if the node is a singleton, then it won't be added, just replaced
     add = false;
     }
-#ifdef MRMLSCENE_VERBOSE
-  vtkTimerLog* timer = vtkTimerLog::New();
-  timer->StartTimer();
-#endif
+  vtkMRMLSceneProfilerScope profilerScope(this->Profiler, "AddNode", n->GetClassName());
   if (add)
     {
+    vtkMRMLSceneProfilerScope observersScope(this->Profiler, "Observers", "NodeAboutToBeAddedEvent");
     this->InvokeEvent(this->NodeAboutToBeAddedEvent, n);
     }
   vtkMRMLNode* node = this->AddNodeNoNotify(n);
@@ -1160,14 +1180,10 @@ vtkMRMLNode*  vtkMRMLScene::AddNode(vtkMRMLNode *n)
   assert( add || node != n);
   if (add)
     {
+    vtkMRMLSceneProfilerScope observersScope(this->Profiler, "Observers", "NodeAddedEvent");
     this->InvokeEvent(this->NodeAddedEvent, n);
     }
   this->Modified();
-#ifdef MRMLSCENE_VERBOSE
-  timer->StopTimer();
-  std::cerr << "AddNode: " << n->GetID() << " :" << timer->GetElapsedTime() << "\n";
-  timer->Delete();
-#endif
   return node;
 }
 
@@ -42,6 +42,7 @@ class vtkCollection;
 class vtkGeneralTransform;
 class vtkURIHandler;
 class vtkMRMLNode;
+class vtkMRMLSceneProfiler;
 class vtkMRMLSceneViewNode;
 
 /// \brief A set of MRML Nodes that supports serialization and undo/redo.
@@ -91,6 +92,9 @@ public:
 
   /// Save scene into URL
   /// Returns nonzero on success
+  /// The scene is saved in the binary scene format if the URL has the .mrmlb
+  /// extension, Connect() and Import() detect binary scene files.
+  /// \sa vtkMRMLBinaryWriter, vtkMRMLBinaryParser
   int Commit(const char* url=NULL);
 
   /// Remove nodes and clear undo/redo stacks
@@ -423,6 +427,12 @@ public:
   vtkGetObjectMacro ( URIHandlerCollection, vtkCollection );
   virtual void SetURIHandlerCollection(vtkCollection* );
   vtkGetObjectMacro ( UserTagTable, vtkTagTable);
+
+  /// Profiler that records the time spent in the steps of Connect() and
+  /// Import(), none by default.
+  /// \sa vtkMRMLSceneProfiler
+  vtkGetObjectMacro ( Profiler, vtkMRMLSceneProfiler );
+  virtual void SetProfiler(vtkMRMLSceneProfiler* );
   virtual void SetUserTagTable(vtkTagTable* );
 
   /// \brief Find a URI handler in the collection that can work on the
@@ -690,6 +700,7 @@ protected:
   vtkDataIOManager * DataIOManager;
   vtkCollection *    URIHandlerCollection;
   vtkTagTable *      UserTagTable;
+  vtkMRMLSceneProfiler* Profiler;
 
   std::vector<unsigned long> States;
 
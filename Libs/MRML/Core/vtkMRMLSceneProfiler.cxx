@@ -0,0 +1,264 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLSceneProfiler.h"
+
+// VTK includes
+#include <vtkObjectFactory.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <cstdio>
+#include <fstream>
+
+vtkStandardNewMacro(vtkMRMLSceneProfiler);
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+void WriteJSONString(ostream& os, const std::string& value)
+{
+  os << '"';
+  for (std::string::const_iterator it = value.begin(); it != value.end(); ++it)
+    {
+    switch (*it)
+      {
+      case '"':
+        os << "\\\"";
+        break;
+      case '\\':
+        os << "\\\\";
+        break;
+      case '\n':
+        os << "\\n";
+        break;
+      case '\t':
+        os << "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(*it) < 0x20)
+          {
+          char escaped[8];
+          sprintf(escaped, "\\u%04x", static_cast<unsigned char>(*it));
+          os << escaped;
+          }
+        else
+          {
+          os << *it;
+          }
+        break;
+      }
+    }
+  os << '"';
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkMRMLSceneProfiler::vtkMRMLSceneProfiler()
+{
+  this->CurrentEvent = -1;
+  this->StartTime = 0.;
+  this->ThreadID = vtkMultiThreader::GetCurrentThreadID();
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLSceneProfiler::~vtkMRMLSceneProfiler()
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSceneProfiler::StartEvent(const char* category, const char* name)
+{
+  if (!vtkMultiThreader::ThreadsEqual(this->ThreadID,
+                                      vtkMultiThreader::GetCurrentThreadID()))
+    {
+    return;
+    }
+  Event event;
+  event.Category = category ? category : "";
+  event.Name = name ? name : "";
+  event.Parent = this->CurrentEvent;
+  event.StartTime = vtkTimerLog::GetUniversalTime();
+  event.EndTime = -1.;
+  event.ChildrenDuration = 0.;
+  if (this->Events.empty())
+    {
+    this->StartTime = event.StartTime;
+    }
+  this->Events.push_back(event);
+  this->CurrentEvent = static_cast<int>(this->Events.size()) - 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSceneProfiler::EndEvent()
+{
+  if (this->CurrentEvent < 0 ||
+      !vtkMultiThreader::ThreadsEqual(this->ThreadID,
+                                      vtkMultiThreader::GetCurrentThreadID()))
+    {
+    return;
+    }
+  Event& event = this->Events[this->CurrentEvent];
+  event.EndTime = vtkTimerLog::GetUniversalTime();
+  if (event.Parent >= 0)
+    {
+    this->Events[event.Parent].ChildrenDuration += event.EndTime - event.StartTime;
+    }
+  this->CurrentEvent = event.Parent;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSceneProfiler::Clear()
+{
+  this->Events.clear();
+  this->CurrentEvent = -1;
+  this->StartTime = 0.;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLSceneProfiler::GetNumberOfEvents()
+{
+  return static_cast<int>(this->Events.size());
+}
+
+//----------------------------------------------------------------------------
+const char* vtkMRMLSceneProfiler::GetEventCategory(int event)
+{
+  if (event < 0 || event >= this->GetNumberOfEvents())
+    {
+    vtkErrorMacro("GetEventCategory: invalid event " << event);
+    return 0;
+    }
+  return this->Events[event].Category.c_str();
+}
+
+//----------------------------------------------------------------------------
+const char* vtkMRMLSceneProfiler::GetEventName(int event)
+{
+  if (event < 0 || event >= this->GetNumberOfEvents())
+    {
+    vtkErrorMacro("GetEventName: invalid event " << event);
+    return 0;
+    }
+  return this->Events[event].Name.c_str();
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLSceneProfiler::GetEventParent(int event)
+{
+  if (event < 0 || event >= this->GetNumberOfEvents())
+    {
+    vtkErrorMacro("GetEventParent: invalid event " << event);
+    return -1;
+    }
+  return this->Events[event].Parent;
+}
+
+//----------------------------------------------------------------------------
+double vtkMRMLSceneProfiler::GetEventStartTime(int event)
+{
+  if (event < 0 || event >= this->GetNumberOfEvents())
+    {
+    vtkErrorMacro("GetEventStartTime: invalid event " << event);
+    return 0.;
+    }
+  return this->Events[event].StartTime - this->StartTime;
+}
+
+//----------------------------------------------------------------------------
+double vtkMRMLSceneProfiler::GetEventDuration(int event)
+{
+  if (event < 0 || event >= this->GetNumberOfEvents())
+    {
+    vtkErrorMacro("GetEventDuration: invalid event " << event);
+    return 0.;
+    }
+  const Event& e = this->Events[event];
+  return e.EndTime < 0. ? 0. : e.EndTime - e.StartTime;
+}
+
+//----------------------------------------------------------------------------
+double vtkMRMLSceneProfiler::GetEventSelfDuration(int event)
+{
+  if (event < 0 || event >= this->GetNumberOfEvents())
+    {
+    vtkErrorMacro("GetEventSelfDuration: invalid event " << event);
+    return 0.;
+    }
+  const Event& e = this->Events[event];
+  return e.EndTime < 0. ? 0. : e.EndTime - e.StartTime - e.ChildrenDuration;
+}
+
+//----------------------------------------------------------------------------
+double vtkMRMLSceneProfiler::GetTotalSelfDuration(const char* category, const char* name)
+{
+  double total = 0.;
+  for (int i = 0; i < this->GetNumberOfEvents(); ++i)
+    {
+    const Event& event = this->Events[i];
+    if ((category && event.Category != category) ||
+        (name && event.Name != name))
+      {
+      continue;
+      }
+    total += this->GetEventSelfDuration(i);
+    }
+  return total;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSceneProfiler::WriteChromeTrace(const char* fileName)
+{
+  if (!fileName)
+    {
+    vtkErrorMacro("WriteChromeTrace: no file name");
+    return false;
+    }
+  std::ofstream file(fileName);
+  if (!file)
+    {
+    vtkErrorMacro("WriteChromeTrace: can't write into " << fileName);
+    return false;
+    }
+  this->WriteChromeTrace(file);
+  return !file.fail();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSceneProfiler::WriteChromeTrace(ostream& os)
+{
+  // Complete events ("X"), times in microseconds
+  os << "{\"traceEvents\":[";
+  for (int i = 0; i < this->GetNumberOfEvents(); ++i)
+    {
+    const Event& event = this->Events[i];
+    os << (i ? ",\n" : "\n") << "{\"name\":";
+    WriteJSONString(os, event.Name);
+    os << ",\"cat\":";
+    WriteJSONString(os, event.Category);
+    os << ",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+       << ",\"ts\":" << static_cast<vtkTypeInt64>(this->GetEventStartTime(i) * 1e6)
+       << ",\"dur\":" << static_cast<vtkTypeInt64>(this->GetEventDuration(i) * 1e6)
+       << "}";
+    }
+  os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSceneProfiler::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfEvents: " << this->GetNumberOfEvents() << "\n";
+  os << indent << "CurrentEvent: " << this->CurrentEvent << "\n";
+}
@@ -0,0 +1,160 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkMRMLSceneProfiler_h
+#define __vtkMRMLSceneProfiler_h
+
+// MRML includes
+#include "vtkMRML.h"
+
+// VTK includes
+#include <vtkMultiThreader.h>
+#include <vtkObject.h>
+
+// STD includes
+#include <string>
+#include <vector>
+
+/// \brief Timeline of the steps of the scene loading.
+///
+/// Once set to a scene (see vtkMRMLScene::SetProfiler()), the profiler
+/// records the time spent in each step of vtkMRMLScene::Connect() and
+/// vtkMRMLScene::Import(): XML parsing, creation and ReadXMLAttributes() of
+/// each node, AddNode() and the NodeAddedEvent observers,
+/// UpdateNodeReferences(), UpdateScene() of each node and the storage node
+/// ReadData().
+/// Events are nested: the parent of an event is the event that was running
+/// when it started. Node events are named after the class of the node,
+/// other events after the step or the scene event.
+///
+/// The events can be queried (e.g. from Python) or written into a file in
+/// the Chrome trace event format (chrome://tracing) with WriteChromeTrace().
+///
+/// Only the events of the thread that created the profiler are recorded.
+/// \sa vtkMRMLScene::SetProfiler()
+class VTK_MRML_EXPORT vtkMRMLSceneProfiler : public vtkObject
+{
+public:
+  static vtkMRMLSceneProfiler *New();
+  vtkTypeMacro(vtkMRMLSceneProfiler, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  ///
+  /// Start an event, nested into the current event if any.
+  /// Categories used by the scene: "Scene", "CreateNode",
+  /// "ReadXMLAttributes", "AddNode", "UpdateScene", "ReadData", "Observers".
+  /// \sa EndEvent()
+  void StartEvent(const char* category, const char* name);
+
+  ///
+  /// End the current event.
+  /// \sa StartEvent()
+  void EndEvent();
+
+  ///
+  /// Remove all the recorded events.
+  void Clear();
+
+  ///
+  /// Number of recorded events, in the order they started.
+  int GetNumberOfEvents();
+
+  const char* GetEventCategory(int event);
+  const char* GetEventName(int event);
+
+  ///
+  /// Index of the event that contains \a event, -1 if none.
+  int GetEventParent(int event);
+
+  ///
+  /// Time in seconds the event started, since the first recorded event.
+  double GetEventStartTime(int event);
+
+  ///
+  /// Duration of the event in seconds, nested events included.
+  /// 0 if the event is not ended.
+  double GetEventDuration(int event);
+
+  ///
+  /// Duration of the event in seconds, nested events excluded.
+  double GetEventSelfDuration(int event);
+
+  ///
+  /// Sum of the self durations of the events of a \a category (all the
+  /// categories if null) with a given \a name (any name if null).
+  /// e.g. GetTotalSelfDuration("ReadData", 0) is the time spent reading
+  /// files, GetTotalSelfDuration(0, "vtkMRMLModelNode") the time spent on
+  /// model nodes.
+  double GetTotalSelfDuration(const char* category, const char* name = 0);
+
+  ///
+  /// Write the events into \a fileName in the Chrome trace event format.
+  /// Return false if the file can't be written.
+  bool WriteChromeTrace(const char* fileName);
+  //BTX
+  void WriteChromeTrace(ostream& os);
+  //ETX
+
+protected:
+  vtkMRMLSceneProfiler();
+  ~vtkMRMLSceneProfiler();
+
+  //BTX
+  struct Event
+  {
+    std::string Category;
+    std::string Name;
+    int Parent;
+    double StartTime;
+    double EndTime;
+    double ChildrenDuration;
+  };
+  std::vector<Event> Events;
+  //ETX
+  int CurrentEvent;
+  double StartTime;
+  vtkMultiThreaderIDType ThreadID;
+
+private:
+  vtkMRMLSceneProfiler(const vtkMRMLSceneProfiler&);  /// Not implemented.
+  void operator=(const vtkMRMLSceneProfiler&);  /// Not implemented.
+};
+
+//BTX
+//----------------------------------------------------------------------------
+/// \brief Record an event into a profiler, if any, while in scope.
+/// \sa vtkMRMLSceneProfiler
+class vtkMRMLSceneProfilerScope
+{
+public:
+  vtkMRMLSceneProfilerScope(vtkMRMLSceneProfiler* profiler,
+                            const char* category, const char* name)
+    : Profiler(profiler)
+  {
+    if (this->Profiler)
+      {
+      this->Profiler->StartEvent(category, name);
+      }
+  }
+  ~vtkMRMLSceneProfilerScope()
+  {
+    if (this->Profiler)
+      {
+      this->Profiler->EndEvent();
+      }
+  }
+
+private:
+  vtkMRMLSceneProfiler* Profiler;
+};
+//ETX
+
+#endif
@@ -29,6 +29,7 @@ Version:   $Revision: 1.14 $
 
 // STD includes
 #include <cassert>
+#include <set>
 #include <sstream>
 #include <stack>
 
@@ -51,6 +52,19 @@ vtkMRMLSceneViewNode::~vtkMRMLSceneViewNode()
 {
   if (this->SnapshotScene)
     {
+    vtkCollectionSimpleIterator it;
+    vtkCollection* storedNodes = this->SnapshotScene->GetNodes();
+    vtkMRMLNode* storedNode = NULL;
+    for (storedNodes->InitTraversal(it);
+         (storedNode = vtkMRMLNode::SafeDownCast(storedNodes->GetNextItemAsObject(it))) ;)
+      {
+      // the scene views still sharing the node set their scene when they
+      // use it again
+      if (storedNode->GetScene() == this->SnapshotScene)
+        {
+        storedNode->SetScene(NULL);
+        }
+      }
     this->SnapshotScene->Delete();
     this->SnapshotScene = 0;
     }
@@ -240,6 +254,7 @@ void vtkMRMLSceneViewNode::Copy(vtkMRMLNode *anode)
   this->SetScreenShotType(vtkMRMLSceneViewNode::SafeDownCast(anode)->GetScreenShotType());
   this->SetSceneViewDescription(vtkMRMLSceneViewNode::SafeDownCast(anode)->GetSceneViewDescription());
 
+  this->StoredNodeStates.clear();
   if (this->SnapshotScene == NULL)
     {
     this->SnapshotScene = vtkMRMLScene::New();
@@ -313,7 +328,8 @@ void vtkMRMLSceneViewNode::UpdateStoredScene()
   // prevent data read in UpdateScene
   for (n=0; n<nnodesSanpshot; n++)
     {
-    node  = dynamic_cast < vtkMRMLNode *>(this->SnapshotScene->GetNodes()->GetItemAsObject(n));
+    // nodes are updated in place, they can't be shared anymore
+    node = this->UnshareStoredNode(n);
     if (node)
       {
       node->SetAddToSceneNoModify(0);
@@ -355,10 +371,6 @@ void vtkMRMLSceneViewNode::StoreScene()
     {
     this->SnapshotScene = vtkMRMLScene::New();
     }
-  else
-    {
-    this->SnapshotScene->Clear(1);
-    }
 
   if (this->GetScene())
     {
@@ -401,30 +413,198 @@ void vtkMRMLSceneViewNode::StoreScene()
       }
     }
 
-  /// \todo: GetNumberOfNodes/GetNthNode is slow, fasten by using collection
-  /// iterators.
-  for (int n=0; n < this->Scene->GetNumberOfNodes(); n++)
+  // Stored nodes are not modified in place by this scene view while they are
+  // shared (see UnshareStoredNode()), they are replaced by a new copy when
+  // the scene node changes. Unmodified nodes can then be shared between
+  // scene views (see also Copy()).
+  std::vector<vtkSmartPointer<vtkMRMLNode> > storedNodes;
+  vtkCollectionSimpleIterator it;
+  vtkCollection* sceneNodes = this->Scene->GetNodes();
+  vtkMRMLNode* node = NULL;
+  for (sceneNodes->InitTraversal(it);
+       (node = vtkMRMLNode::SafeDownCast(sceneNodes->GetNextItemAsObject(it))) ;)
     {
-    vtkMRMLNode *node = this->Scene->GetNthNode(n);
     if (this->IncludeNodeInSceneView(node) &&
         node->GetSaveWithScene() )
       {
-      vtkSmartPointer<vtkMRMLNode> newNode = vtkSmartPointer<vtkMRMLNode>::Take(node->CreateNodeInstance());
-
-      newNode->SetScene(this->SnapshotScene);
-      newNode->CopyWithoutModifiedEvent(node);
-      newNode->SetID(node->GetID());
-
-      newNode->SetAddToSceneNoModify(1);
-      this->SnapshotScene->AddNode(newNode);
-      newNode->SetAddToSceneNoModify(0);
+      vtkSmartPointer<vtkMRMLNode> storedNode = this->FindUpToDateStoredNode(node);
+      if (!storedNode)
+        {
+        storedNode = vtkSmartPointer<vtkMRMLNode>::Take(node->CreateNodeInstance());
+        storedNode->SetScene(this->SnapshotScene);
+        storedNode->CopyWithoutModifiedEvent(node);
+        storedNode->SetID(node->GetID());
+        }
+      storedNodes.push_back(storedNode);
+      }
+    }
 
-      // sanity check
-      assert(newNode->GetScene() == this->SnapshotScene);
+  std::set<vtkMRMLNode*> keptNodes;
+  for (std::vector<vtkSmartPointer<vtkMRMLNode> >::iterator storedIt = storedNodes.begin();
+       storedIt != storedNodes.end(); ++storedIt)
+    {
+    keptNodes.insert(storedIt->GetPointer());
+    }
+  vtkMRMLNode* oldStoredNode = NULL;
+  vtkCollection* oldStoredNodes = this->SnapshotScene->GetNodes();
+  for (oldStoredNodes->InitTraversal(it);
+       (oldStoredNode = vtkMRMLNode::SafeDownCast(oldStoredNodes->GetNextItemAsObject(it))) ;)
+    {
+    if (keptNodes.find(oldStoredNode) == keptNodes.end())
+      {
+      this->DetachStoredNode(oldStoredNode);
       }
     }
+  this->SnapshotScene->GetNodes()->RemoveAllItems();
+  this->SnapshotScene->ClearNodeIDs();
+  for (std::vector<vtkSmartPointer<vtkMRMLNode> >::iterator storedIt = storedNodes.begin();
+       storedIt != storedNodes.end(); ++storedIt)
+    {
+    vtkMRMLNode* storedNode = storedIt->GetPointer();
+    this->SnapshotScene->GetNodes()->vtkCollection::AddItem(storedNode);
+    this->SnapshotScene->AddNodeID(storedNode);
+    storedNode->SetScene(this->SnapshotScene);
+    }
   this->SnapshotScene->CopyNodeReferences(this->GetScene());
   this->SnapshotScene->CopyNodeChangedIDs(this->GetScene());
+
+  this->UpdateStoredNodeStates();
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSceneViewNode::IsStoredNodeUpToDate(vtkMRMLNode* sceneNode,
+                                                vtkMRMLNode* storedNode)
+{
+  if (!sceneNode || !storedNode || !sceneNode->GetID())
+    {
+    return false;
+    }
+  StoredNodeStateMap::const_iterator it =
+    this->StoredNodeStates.find(sceneNode->GetID());
+  return it != this->StoredNodeStates.end() &&
+         it->second.SceneNode == sceneNode &&
+         it->second.SceneNodeMTime == sceneNode->GetMTime() &&
+         !sceneNode->GetModifiedEventPending() &&
+         it->second.StoredNode == storedNode &&
+         it->second.StoredNodeMTime == storedNode->GetMTime();
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLNode* vtkMRMLSceneViewNode::FindUpToDateStoredNode(vtkMRMLNode* sceneNode)
+{
+  if (!sceneNode->GetID())
+    {
+    return NULL;
+    }
+  std::vector<vtkMRMLNode*> sceneViewNodes;
+  sceneViewNodes.push_back(this);
+  this->Scene->GetNodesByClass("vtkMRMLSceneViewNode", sceneViewNodes);
+  for (std::vector<vtkMRMLNode*>::iterator it = sceneViewNodes.begin();
+       it != sceneViewNodes.end(); ++it)
+    {
+    vtkMRMLSceneViewNode* sceneViewNode = vtkMRMLSceneViewNode::SafeDownCast(*it);
+    if (!sceneViewNode || !sceneViewNode->SnapshotScene)
+      {
+      continue;
+      }
+    vtkMRMLNode* storedNode =
+      sceneViewNode->SnapshotScene->GetNodeByID(sceneNode->GetID());
+    if (sceneViewNode->IsStoredNodeUpToDate(sceneNode, storedNode))
+      {
+      return storedNode;
+      }
+    }
+  return NULL;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLScene* vtkMRMLSceneViewNode::FindOtherStoredScene(vtkMRMLNode* storedNode)
+{
+  if (!this->Scene || !storedNode || !storedNode->GetID())
+    {
+    return NULL;
+    }
+  std::vector<vtkMRMLNode*> sceneViewNodes;
+  this->Scene->GetNodesByClass("vtkMRMLSceneViewNode", sceneViewNodes);
+  for (std::vector<vtkMRMLNode*>::iterator it = sceneViewNodes.begin();
+       it != sceneViewNodes.end(); ++it)
+    {
+    vtkMRMLSceneViewNode* sceneViewNode = vtkMRMLSceneViewNode::SafeDownCast(*it);
+    if (sceneViewNode && sceneViewNode != this && sceneViewNode->SnapshotScene &&
+        sceneViewNode->SnapshotScene->GetNodeByID(storedNode->GetID()) == storedNode)
+      {
+      return sceneViewNode->SnapshotScene;
+      }
+    }
+  return NULL;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSceneViewNode::DetachStoredNode(vtkMRMLNode* storedNode)
+{
+  if (storedNode && storedNode->GetScene() == this->SnapshotScene)
+    {
+    // NULL if no other scene view stores it: the node is about to be deleted
+    storedNode->SetScene(this->FindOtherStoredScene(storedNode));
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLNode* vtkMRMLSceneViewNode::UnshareStoredNode(int n)
+{
+  vtkMRMLNode* storedNode = this->SnapshotScene ? vtkMRMLNode::SafeDownCast(
+    this->SnapshotScene->GetNodes()->GetItemAsObject(n)) : NULL;
+  if (!storedNode || !this->FindOtherStoredScene(storedNode))
+    {
+    return storedNode;
+    }
+  vtkSmartPointer<vtkMRMLNode> privateNode =
+    vtkSmartPointer<vtkMRMLNode>::Take(storedNode->CreateNodeInstance());
+  privateNode->SetScene(this->SnapshotScene);
+  privateNode->CopyWithoutModifiedEvent(storedNode);
+  privateNode->SetID(storedNode->GetID());
+  // the copy is as up to date as the shared node was
+  StoredNodeStateMap::iterator it =
+    this->StoredNodeStates.find(storedNode->GetID());
+  if (it != this->StoredNodeStates.end() &&
+      it->second.StoredNode == storedNode &&
+      it->second.StoredNodeMTime == storedNode->GetMTime())
+    {
+    it->second.StoredNode = privateNode;
+    it->second.StoredNodeMTime = privateNode->GetMTime();
+    }
+  this->DetachStoredNode(storedNode);
+  this->SnapshotScene->GetNodes()->ReplaceItem(n, privateNode);
+  this->SnapshotScene->AddNodeID(privateNode);
+  return privateNode;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSceneViewNode::UpdateStoredNodeStates()
+{
+  this->StoredNodeStates.clear();
+  if (!this->Scene || !this->SnapshotScene)
+    {
+    return;
+    }
+  vtkCollectionSimpleIterator it;
+  vtkCollection* storedNodes = this->SnapshotScene->GetNodes();
+  vtkMRMLNode* storedNode = NULL;
+  for (storedNodes->InitTraversal(it);
+       (storedNode = vtkMRMLNode::SafeDownCast(storedNodes->GetNextItemAsObject(it))) ;)
+    {
+    vtkMRMLNode* sceneNode = storedNode->GetID() ?
+      this->Scene->GetNodeByID(storedNode->GetID()) : NULL;
+    if (!sceneNode)
+      {
+      continue;
+      }
+    StoredNodeState& state = this->StoredNodeStates[storedNode->GetID()];
+    state.SceneNode = sceneNode;
+    state.SceneNodeMTime = sceneNode->GetMTime();
+    state.StoredNode = storedNode;
+    state.StoredNodeMTime = storedNode->GetMTime();
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -490,6 +670,7 @@ void vtkMRMLSceneViewNode::RestoreScene()
       removedNodes.push(vtkSmartPointer<vtkMRMLNode>(node));
       }
     }
+  bool nodesRemoved = !removedNodes.empty();
   while(!removedNodes.empty())
     {
     vtkMRMLNode* nodeToRemove = removedNodes.top().GetPointer();
@@ -506,6 +687,7 @@ void vtkMRMLSceneViewNode::RestoreScene()
     }
 
   std::vector<vtkMRMLNode *> addedNodes;
+  std::vector<vtkMRMLNode *> restoredNodes;
   for (n=0; n < numNodesInSceneView; n++)
     {
     node = vtkMRMLNode::SafeDownCast(this->SnapshotScene->GetNodes()->GetItemAsObject(n));
@@ -516,8 +698,14 @@ void vtkMRMLSceneViewNode::RestoreScene()
         {
         vtkMRMLNode *snode = this->Scene->GetNodeByID(node->GetID());
 
+        if (snode && this->IsStoredNodeUpToDate(snode, node))
+          {
+          // nothing changed since the node was stored or restored
+          continue;
+          }
         if (snode)
           {
+          restoredNodes.push_back(snode);
           snode->SetScene(this->Scene);
           // to prevent copying of default info if not stored in sanpshot
           snode->CopyWithSingleModifiedEvent(node);
@@ -546,12 +734,26 @@ void vtkMRMLSceneViewNode::RestoreScene()
 
   //this->Scene->UpdateNodeReferences(this->Nodes);
 
-  for (sceneNodes->InitTraversal(it);
-       (node = vtkMRMLNode::SafeDownCast(sceneNodes->GetNextItemAsObject(it))) ;)
+  if (nodesRemoved || !addedNodes.empty())
     {
-    if (this->IncludeNodeInSceneView(node) && node->GetSaveWithScene())
+    // references to the removed and added nodes must be updated
+    for (sceneNodes->InitTraversal(it);
+         (node = vtkMRMLNode::SafeDownCast(sceneNodes->GetNextItemAsObject(it))) ;)
       {
-      node->UpdateScene(this->Scene);
+      if (this->IncludeNodeInSceneView(node) && node->GetSaveWithScene())
+        {
+        node->UpdateScene(this->Scene);
+        }
+      }
+    }
+  else
+    {
+    for (n=0; n<restoredNodes.size(); n++)
+      {
+      if (restoredNodes[n]->GetSaveWithScene())
+        {
+        restoredNodes[n]->UpdateScene(this->Scene);
+        }
       }
     }
 
@@ -564,6 +766,8 @@ void vtkMRMLSceneViewNode::RestoreScene()
 
   this->Scene->EndState(vtkMRMLScene::RestoreState);
 
+  this->UpdateStoredNodeStates();
+
 #ifndef NDEBUG
   // sanity checks
   for (sceneNodes->InitTraversal(it);
@@ -614,6 +818,8 @@ void vtkMRMLSceneViewNode::SetAbsentStorageFileNames()
           vtkMRMLStorageNode *snode1 = vtkMRMLStorageNode::SafeDownCast(node1);
           if (snode1)
             {
+            // the storage node is modified in place
+            snode = vtkMRMLStorageNode::SafeDownCast(this->UnshareStoredNode(n));
             snode->SetFileName(snode1->GetFileName());
             int numberOfFileNames = snode1->GetNumberOfFileNames();
             if (numberOfFileNames > 0)
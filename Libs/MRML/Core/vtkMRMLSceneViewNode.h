@@ -23,6 +23,10 @@ class vtkCollection;
 class vtkImageData;
 
 class vtkMRMLStorageNode;
+
+// STD includes
+#include <map>
+
 class VTK_MRML_EXPORT vtkMRMLSceneViewNode : public vtkMRMLStorableNode
 {
   public:
@@ -69,12 +73,19 @@ class VTK_MRML_EXPORT vtkMRMLSceneViewNode : public vtkMRMLStorableNode
   vtkMRMLScene* GetStoredScene();
 
   ///
-  /// Store content of the scene
+  /// Store content of the scene.
+  /// Nodes that were not modified since they were last stored or restored
+  /// are not copied again: the stored node is reused, or shared with the
+  /// other scene views that stored the same node state. Shared stored nodes
+  /// are copied before this scene view modifies them, they must not be
+  /// edited through GetStoredScene().
   /// \sa GetStoredScene() RestoreScene()
   void StoreScene();
 
   ///
-  /// Restore content of the scene from the node
+  /// Restore content of the scene from the node.
+  /// Scene nodes that were not modified since they were stored or restored
+  /// are left untouched.
   /// \sa GetStoredScene() StoreScene()
   void RestoreScene();
 
@@ -129,6 +140,46 @@ protected:
 
   vtkMRMLScene* SnapshotScene;
 
+  //BTX
+  /// MTimes of a scene node and of its stored node when they were last
+  /// known to be identical (after StoreScene() or RestoreScene()).
+  /// Pointers are only compared, never dereferenced.
+  struct StoredNodeState
+    {
+    vtkMRMLNode* SceneNode;
+    unsigned long SceneNodeMTime;
+    vtkMRMLNode* StoredNode;
+    unsigned long StoredNodeMTime;
+    };
+  typedef std::map<std::string, StoredNodeState> StoredNodeStateMap;
+  StoredNodeStateMap StoredNodeStates;
+  //ETX
+
+  /// Return true if neither the scene node nor the stored node were
+  /// modified since they were last known to be identical. A scene node
+  /// with pending modified events (modified while its events were disabled)
+  /// is never up to date: its MTime is not updated yet.
+  bool IsStoredNodeUpToDate(vtkMRMLNode* sceneNode, vtkMRMLNode* storedNode);
+
+  /// Return a node stored by this or another scene view that is identical
+  /// to the scene node, NULL if there is none.
+  vtkMRMLNode* FindUpToDateStoredNode(vtkMRMLNode* sceneNode);
+
+  /// Return the stored scene of another scene view of the scene that
+  /// shares the stored node, NULL if the node is not shared.
+  vtkMRMLScene* FindOtherStoredScene(vtkMRMLNode* storedNode);
+
+  /// Give the node a stored scene that still contains it if it points to
+  /// the stored scene of this scene view, that no longer does.
+  void DetachStoredNode(vtkMRMLNode* storedNode);
+
+  /// Replace the n-th stored node by a copy if it is shared with another
+  /// scene view, so that it can be modified. Return the node to modify.
+  vtkMRMLNode* UnshareStoredNode(int n);
+
+  /// Record the state of all the stored nodes and their scene node.
+  void UpdateStoredNodeStates();
+
   /// The associated Description
   vtkStdString SceneViewDescription;
 
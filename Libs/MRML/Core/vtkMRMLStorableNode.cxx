@@ -13,6 +13,8 @@ Version:   $Revision: 1.3 $
 =========================================================================auto=*/
 
 // MRML includes
+#include "vtkMRMLBinaryParser.h"
+#include "vtkMRMLBinaryWriter.h"
 #include "vtkMRMLStorableNode.h"
 #include "vtkMRMLScene.h"
 #include "vtkMRMLStorageNode.h"
@@ -153,6 +155,53 @@ void vtkMRMLStorableNode::WriteXML(ostream& of, int nIndent)
 
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLStorableNode::WriteBinary(vtkMRMLBinaryWriter* writer)
+{
+  Superclass::WriteBinary(writer);
+
+  //---write any user tags: keyword and value of each tag.
+  if ( this->GetUserTagTable() != NULL )
+    {
+    std::vector<std::string> userTags;
+    int numc = this->GetUserTagTable()->GetNumberOfTags();
+    for (int i=0; i < numc; i++ )
+      {
+      const char* kwd = this->GetUserTagTable()->GetTagAttribute(i);
+      const char* val = this->GetUserTagTable()->GetTagValue (i);
+      if (kwd != NULL && val != NULL)
+        {
+        userTags.push_back(kwd);
+        userTags.push_back(val);
+        }
+      }
+    writer->WriteStringsAttribute("userTags", userTags);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLStorableNode::ReadBinary(vtkMRMLBinaryParser* parser)
+{
+  int disabledModify = this->StartModify();
+
+  Superclass::ReadBinary(parser);
+
+  std::vector<std::string> userTags;
+  if (parser->GetStringsAttribute("userTags", userTags))
+    {
+    if ( this->GetUserTagTable() == NULL )
+      {
+      this->UserTagTable = vtkTagTable::New();
+      }
+    for (size_t i = 0; i + 1 < userTags.size(); i += 2)
+      {
+      this->GetUserTagTable()->AddOrUpdateTag(userTags[i].c_str(), userTags[i + 1].c_str(), 0);
+      }
+    }
+
+  this->EndModify(disabledModify);
+}
+
 
 //----------------------------------------------------------------------------
 void vtkMRMLStorableNode::ReadXMLAttributes(const char** atts)
@@ -277,6 +326,12 @@ void vtkMRMLStorableNode::UpdateScene(vtkMRMLScene *scene)
     {
     return;
     }
+  // the data is read later by whoever turned ReadDataOnLoad off, not
+  // reading it now is not an error
+  if (scene && scene->GetReadDataOnLoad() == 0)
+    {
+    return;
+    }
 
   int numStorageNodes = this->GetNumberOfNodeReferences(this->GetStorageNodeReferenceRole());
 
@@ -57,6 +57,14 @@ public:
   /// Write this node's information to a MRML file in XML format.
   virtual void WriteXML(ostream& of, int indent);
 
+  ///
+  /// Write this node's attributes into a binary scene.
+  virtual void WriteBinary(vtkMRMLBinaryWriter* writer);
+
+  ///
+  /// Set node attributes from a binary scene.
+  virtual void ReadBinary(vtkMRMLBinaryParser* parser);
+
   ///
   /// Copy the node's attributes to this object
   virtual void Copy(vtkMRMLNode *node);
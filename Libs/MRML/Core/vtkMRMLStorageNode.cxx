@@ -19,6 +19,7 @@ Version:   $Revision: 1.1.1.1 $
 #include "vtkMRMLStorableNode.h"
 #include "vtkMRMLStorageNode.h"
 #include "vtkMRMLScene.h"
+#include "vtkMRMLSceneProfiler.h"
 
 // VTK includes
 #include <vtkCommand.h>
@@ -1015,6 +1016,12 @@ vtkTimeStamp vtkMRMLStorageNode::GetStoredTime()
   return *this->StoredTime;
 }
 
+//------------------------------------------------------------------------------
+void vtkMRMLStorageNode::SetStoredTime(const vtkTimeStamp& storedTime)
+{
+  *this->StoredTime = storedTime;
+}
+
 //----------------------------------------------------------------------------
 bool vtkMRMLStorageNode::CanReadInReferenceNode(vtkMRMLNode *refNode)
 {
@@ -1069,6 +1076,8 @@ int vtkMRMLStorageNode::ReadData(vtkMRMLNode* refNode, bool temporary)
   vtkDebugMacro("ReadData: read state is ready, "
     <<  "URI = " << (this->GetURI() == NULL ? "null" : this->GetURI()) << ", "
     << "filename = " << (this->GetFileName() == NULL ? "null" : this->GetFileName()));
+  vtkMRMLSceneProfilerScope profilerScope(
+    this->GetScene() ? this->GetScene()->GetProfiler() : 0, "ReadData", this->GetClassName());
   int res = this->ReadDataInternal(refNode);
   if (res)
     {
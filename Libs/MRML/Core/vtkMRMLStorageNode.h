@@ -251,6 +251,12 @@ public:
   /// read in or written from.
   vtkTimeStamp GetStoredTime();
 
+  /// Set the time stamp of the data last read in or written from.
+  /// Use when the data has been written from a copy of the reference node
+  /// (e.g. on another thread), with the time the copy was made.
+  /// \sa GetStoredTime(), InvalidateFile()
+  void SetStoredTime(const vtkTimeStamp& storedTime);
+
   /// Return true if the node can be read in. Used by ReadData to know
   /// if the file can be read into the reference node.
   /// Subclasses must reimplement the method.
@@ -0,0 +1,176 @@
+/*=========================================================================
+
+  Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+==========================================================================*/
+
+// MRMLDisplayableManager includes
+#include <vtkMRMLModelClipCache.h>
+
+// VTK includes
+#include <vtkClipPolyData.h>
+#include <vtkImplicitBoolean.h>
+#include <vtkNew.h>
+#include <vtkPlane.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkSphereSource.h>
+#include <vtkVersion.h>
+
+// STD includes
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Number of cells of the surface clipped in one piece by vtkClipPolyData
+vtkIdType ClipWithFilter(vtkPolyData* surface, int operationType,
+                         double origin[3], double normal[3])
+{
+  vtkNew<vtkPlane> plane;
+  plane->SetOrigin(origin);
+  plane->SetNormal(normal);
+  vtkNew<vtkImplicitBoolean> planes;
+  planes->SetOperationType(operationType);
+  planes->AddFunction(plane.GetPointer());
+  vtkNew<vtkClipPolyData> clipper;
+#if (VTK_MAJOR_VERSION <= 5)
+  clipper->SetInput(surface);
+#else
+  clipper->SetInputData(surface);
+#endif
+  clipper->SetClipFunction(planes.GetPointer());
+  clipper->SetValue(0.0);
+  clipper->Update();
+  return clipper->GetOutput()->GetNumberOfCells();
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLModelClipCacheTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetRadius(50.);
+  sphere->SetThetaResolution(200);
+  sphere->SetPhiResolution(200);
+  sphere->Update();
+  vtkPolyData* surface = sphere->GetOutput();
+
+  vtkNew<vtkMRMLModelClipCache> clipCache;
+  clipCache->SetInput(surface);
+  clipCache->SetNumberOfCellsPerBlock(1000);
+  double origin[3] = {0., 0., 10.};
+  double normal[3] = {0., 0., 1.};
+  clipCache->AddClipPlane(origin, normal);
+  clipCache->Update();
+  vtkIdType expectedCells =
+    ClipWithFilter(surface, VTK_INTERSECTION, origin, normal);
+  if (clipCache->GetOutput()->GetNumberOfCells() != expectedCells ||
+      expectedCells == 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong clipped surface: "
+              << clipCache->GetOutput()->GetNumberOfCells() << " cells instead of "
+              << expectedCells << std::endl;
+    return EXIT_FAILURE;
+    }
+  const int firstClippedBlocks = clipCache->GetNumberOfClippedBlocks();
+  const unsigned long keptCellsTime = clipCache->GetKeptCells()->GetMTime();
+
+  // Moving the plane only clips the blocks it crosses
+  origin[2] = 12.;
+  clipCache->RemoveAllClipPlanes();
+  clipCache->AddClipPlane(origin, normal);
+  clipCache->Update();
+  expectedCells = ClipWithFilter(surface, VTK_INTERSECTION, origin, normal);
+  if (clipCache->GetOutput()->GetNumberOfCells() != expectedCells)
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong clipped surface: "
+              << clipCache->GetOutput()->GetNumberOfCells() << " cells instead of "
+              << expectedCells << std::endl;
+    return EXIT_FAILURE;
+    }
+  const vtkIdType blockCells = 1000;
+  if (firstClippedBlocks == 0 ||
+      clipCache->GetNumberOfClippedBlocks() * blockCells >= surface->GetNumberOfCells())
+    {
+    std::cerr << "Line " << __LINE__ << " - Too many blocks clipped: "
+              << clipCache->GetNumberOfClippedBlocks() << std::endl;
+    return EXIT_FAILURE;
+    }
+  // The blocks above both planes are kept, they are not appended again
+  if (clipCache->GetKeptCells()->GetNumberOfCells() == 0 ||
+      clipCache->GetKeptCells()->GetMTime() != keptCellsTime)
+    {
+    std::cerr << "Line " << __LINE__ << " - Kept blocks appended again"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Nothing to do if nothing changed
+  if (clipCache->PrepareUpdate())
+    {
+    std::cerr << "Line " << __LINE__ << " - Unchanged cache clipped again"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Plane outside of the surface: everything or nothing is kept
+  origin[2] = 100.;
+  clipCache->RemoveAllClipPlanes();
+  clipCache->AddClipPlane(origin, normal);
+  clipCache->Update();
+  if (clipCache->GetOutput()->GetNumberOfCells() != 0 ||
+      clipCache->GetNumberOfClippedBlocks() != 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Surface not removed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  clipCache->SetOperationType(VTK_UNION);
+  normal[2] = -1.;
+  clipCache->RemoveAllClipPlanes();
+  clipCache->AddClipPlane(origin, normal);
+  clipCache->Update();
+  if (clipCache->GetOutput()->GetNumberOfCells() != surface->GetNumberOfCells())
+    {
+    std::cerr << "Line " << __LINE__ << " - Surface not kept: "
+              << clipCache->GetOutput()->GetNumberOfCells() << " cells instead of "
+              << surface->GetNumberOfCells() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Several caches are clipped in parallel
+  std::vector<vtkSmartPointer<vtkMRMLModelClipCache> > clipCaches;
+  std::vector<vtkMRMLModelClipCache*> clipCachePointers;
+  origin[2] = -20.;
+  normal[2] = 1.;
+  for (int i = 0; i < 8; ++i)
+    {
+    vtkSmartPointer<vtkMRMLModelClipCache> modelClipCache =
+      vtkSmartPointer<vtkMRMLModelClipCache>::New();
+    modelClipCache->SetInput(surface);
+    modelClipCache->AddClipPlane(origin, normal);
+    clipCaches.push_back(modelClipCache);
+    clipCachePointers.push_back(modelClipCache);
+    }
+  vtkMRMLModelClipCache::UpdateCaches(clipCachePointers);
+  expectedCells = ClipWithFilter(surface, VTK_INTERSECTION, origin, normal);
+  for (size_t i = 0; i < clipCaches.size(); ++i)
+    {
+    if (clipCaches[i]->GetOutput()->GetNumberOfCells() != expectedCells)
+      {
+      std::cerr << "Line " << __LINE__ << " - Wrong clipped surface " << i << ": "
+                << clipCaches[i]->GetOutput()->GetNumberOfCells()
+                << " cells instead of " << expectedCells << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,158 @@
+/*=========================================================================
+
+  Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+==========================================================================*/
+
+// MRMLDisplayableManager includes
+#include <vtkMRMLModelSliceIntersectionIndex.h>
+
+// VTK includes
+#include <vtkCutter.h>
+#include <vtkNew.h>
+#include <vtkPlane.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkSphereSource.h>
+#include <vtkVersion.h>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Number of lines of the intersection of the surface with the plane
+vtkIdType CutLines(vtkPolyData* surface, double origin[3], double normal[3])
+{
+  vtkNew<vtkPlane> plane;
+  plane->SetOrigin(origin);
+  plane->SetNormal(normal);
+  vtkNew<vtkCutter> cutter;
+#if (VTK_MAJOR_VERSION <= 5)
+  cutter->SetInput(surface);
+#else
+  cutter->SetInputData(surface);
+#endif
+  cutter->SetCutFunction(plane.GetPointer());
+  cutter->SetGenerateCutScalars(0);
+  cutter->Update();
+  return cutter->GetOutput()->GetNumberOfLines();
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLModelSliceIntersectionIndexTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetRadius(50.);
+  sphere->SetThetaResolution(200);
+  sphere->SetPhiResolution(200);
+  sphere->Update();
+  vtkPolyData* surface = sphere->GetOutput();
+
+  // Slice views showing the same surface share its index
+  vtkSmartPointer<vtkMRMLModelSliceIntersectionIndex> index =
+    vtkMRMLModelSliceIntersectionIndex::GetSharedIndex(surface);
+  if (!index ||
+      vtkMRMLModelSliceIntersectionIndex::GetSharedIndex(surface) != index)
+    {
+    std::cerr << "Line " << __LINE__ << " - Index not shared" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Axial, sagittal, coronal and oblique slices
+  double normals[4][3] = {{0., 0., 1.}, {1., 0., 0.}, {0., 1., 0.}, {1., 2., 3.}};
+  vtkNew<vtkPolyData> sliceCells;
+  for (int n = 0; n < 4; ++n)
+    {
+    for (double offset = -60.; offset <= 60.; offset += 7.5)
+      {
+      double origin[3] = {offset * normals[n][0], offset * normals[n][1],
+                          offset * normals[n][2]};
+      const bool extracted =
+        index->ExtractCells(origin, normals[n], sliceCells.GetPointer());
+      // The slabs of a normal are computed the second time it is used
+      const bool firstUse = (offset == -60.);
+      if (extracted == firstUse ||
+          index->GetNumberOfDirections() != (firstUse ? n : n + 1))
+        {
+        std::cerr << "Line " << __LINE__ << " - Wrong index of normal " << n
+                  << " at " << offset << ": " << index->GetNumberOfDirections()
+                  << " directions" << std::endl;
+        return EXIT_FAILURE;
+        }
+      if (!extracted)
+        {
+        continue;
+        }
+      const vtkIdType expectedLines = CutLines(surface, origin, normals[n]);
+      const vtkIdType lines = CutLines(sliceCells.GetPointer(), origin, normals[n]);
+      if (lines != expectedLines)
+        {
+        std::cerr << "Line " << __LINE__ << " - Wrong intersection for normal "
+                  << n << " at " << offset << ": " << lines << " lines instead of "
+                  << expectedLines << std::endl;
+        return EXIT_FAILURE;
+        }
+      if (expectedLines > 0 &&
+          sliceCells->GetNumberOfCells() * 10 > surface->GetNumberOfCells())
+        {
+        std::cerr << "Line " << __LINE__ << " - Too many cells extracted: "
+                  << sliceCells->GetNumberOfCells() << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+  if (index->GetNumberOfDirections() != 4)
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong number of directions: "
+              << index->GetNumberOfDirections() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Cells overlapping more than one slab are listed apart and found by
+  // every plane
+  index->SetMaximumNumberOfCellSlabs(1);
+  sphere->Modified();
+  sphere->Update();
+  for (double offset = -60.; offset <= 60.; offset += 7.5)
+    {
+    double origin[3] = {offset * normals[3][0], offset * normals[3][1],
+                        offset * normals[3][2]};
+    if (!index->ExtractCells(origin, normals[3], sliceCells.GetPointer()) &&
+        !index->ExtractCells(origin, normals[3], sliceCells.GetPointer()))
+      {
+      std::cerr << "Line " << __LINE__ << " - Normal not indexed" << std::endl;
+      return EXIT_FAILURE;
+      }
+    const vtkIdType expectedLines = CutLines(surface, origin, normals[3]);
+    const vtkIdType lines = CutLines(sliceCells.GetPointer(), origin, normals[3]);
+    if (lines != expectedLines)
+      {
+      std::cerr << "Line " << __LINE__ << " - Wrong intersection with long cells at "
+                << offset << ": " << lines << " lines instead of "
+                << expectedLines << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  index->SetMaximumNumberOfCellSlabs(4);
+
+  // The index is computed again when the surface changes
+  sphere->SetRadius(20.);
+  sphere->Update();
+  double origin[3] = {0., 0., 30.};
+  index->ExtractCells(origin, normals[0], sliceCells.GetPointer());
+  index->ExtractCells(origin, normals[0], sliceCells.GetPointer());
+  if (sliceCells->GetNumberOfCells() != 0 || index->GetNumberOfDirections() != 1)
+    {
+    std::cerr << "Line " << __LINE__ << " - Index not updated" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
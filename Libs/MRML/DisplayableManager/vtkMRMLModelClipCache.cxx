@@ -0,0 +1,518 @@
+/*=========================================================================
+
+  Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+==========================================================================*/
+
+// MRMLDisplayableManager includes
+#include "vtkMRMLModelClipCache.h"
+
+// VTK includes
+#include <vtkAppendPolyData.h>
+#include <vtkCellData.h>
+#include <vtkCellType.h>
+#include <vtkClipPolyData.h>
+#include <vtkImplicitBoolean.h>
+#include <vtkMultiThreader.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPlane.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkVersion.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+
+//---------------------------------------------------------------------------
+vtkStandardNewMacro(vtkMRMLModelClipCache);
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+// Index of the cell array of vtkPolyData that contains the cell type. The
+// cells of a block are inserted in that order to keep the cell ids
+// consistent with the cell data.
+int GetCellArrayIndex(int cellType)
+{
+  switch (cellType)
+    {
+    case VTK_VERTEX:
+    case VTK_POLY_VERTEX:
+      return 0;
+    case VTK_LINE:
+    case VTK_POLY_LINE:
+      return 1;
+    case VTK_TRIANGLE_STRIP:
+      return 3;
+    default:
+      return 2;
+    }
+}
+
+//---------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE ExecuteUpdateThreaderCallback(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  std::vector<vtkMRMLModelClipCache*>* caches =
+    static_cast<std::vector<vtkMRMLModelClipCache*>*>(info->UserData);
+  for (size_t i = info->ThreadID; i < caches->size(); i += info->NumberOfThreads)
+    {
+    (*caches)[i]->ExecuteUpdate();
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+vtkMRMLModelClipCache::vtkMRMLModelClipCache()
+{
+  this->Input = 0;
+  this->BlocksTime = 0;
+  this->OperationType = VTK_INTERSECTION;
+  this->NumberOfCellsPerBlock = 4096;
+  this->NumberOfClippedBlocks = 0;
+  this->UpdatedOperationType = VTK_INTERSECTION;
+  this->UpToDate = false;
+  this->ClipFunction = vtkSmartPointer<vtkImplicitBoolean>::New();
+  this->KeptAppend = vtkSmartPointer<vtkAppendPolyData>::New();
+  this->HasKeptCells = false;
+  this->Append = vtkSmartPointer<vtkAppendPolyData>::New();
+  this->Output = vtkSmartPointer<vtkPolyData>::New();
+  this->EmptyOutput = true;
+}
+
+//---------------------------------------------------------------------------
+vtkMRMLModelClipCache::~vtkMRMLModelClipCache()
+{
+  this->SetInput(0);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelClipCache::SetInput(vtkPolyData* input)
+{
+  if (input == this->Input)
+    {
+    return;
+    }
+  if (this->Input)
+    {
+    this->Input->UnRegister(this);
+    }
+  this->Input = input;
+  if (this->Input)
+    {
+    this->Input->Register(this);
+    }
+  this->Blocks.clear();
+  this->BlocksTime = 0;
+  this->UpToDate = false;
+  this->Modified();
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelClipCache::RemoveAllClipPlanes()
+{
+  this->Planes.clear();
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelClipCache::AddClipPlane(const double origin[3], const double normal[3])
+{
+  this->Planes.insert(this->Planes.end(), origin, origin + 3);
+  this->Planes.insert(this->Planes.end(), normal, normal + 3);
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLModelClipCache::GetNumberOfClipPlanes()const
+{
+  return static_cast<int>(this->Planes.size() / 6);
+}
+
+//---------------------------------------------------------------------------
+vtkPolyData* vtkMRMLModelClipCache::GetOutput()
+{
+  return this->Output;
+}
+
+//---------------------------------------------------------------------------
+vtkPolyData* vtkMRMLModelClipCache::GetKeptCells()
+{
+  return this->KeptAppend->GetOutput();
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelClipCache::BuildBlocks()
+{
+  this->Blocks.clear();
+  this->BlocksTime = this->Input ? this->Input->GetMTime() : 0;
+  vtkPoints* points = this->Input ? this->Input->GetPoints() : 0;
+  const vtkIdType numberOfCells = this->Input ? this->Input->GetNumberOfCells() : 0;
+  if (!points || numberOfCells == 0)
+    {
+    return;
+    }
+
+  // Regular grid of blocks over the bounds, cells are sorted by their center
+  double bounds[6];
+  this->Input->GetBounds(bounds);
+  const int numberOfBlocks =
+    static_cast<int>(numberOfCells / std::max(this->NumberOfCellsPerBlock, 1)) + 1;
+  const int blocksPerAxis =
+    std::max(static_cast<int>(ceil(pow(static_cast<double>(numberOfBlocks), 1. / 3.))), 1);
+  int dimensions[3];
+  for (int i = 0; i < 3; ++i)
+    {
+    dimensions[i] = bounds[2*i+1] > bounds[2*i] ? blocksPerAxis : 1;
+    }
+  std::vector<std::vector<vtkIdType> > blockCells(
+    dimensions[0] * dimensions[1] * dimensions[2]);
+  for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+    {
+    vtkIdType npts = 0;
+    vtkIdType* pts = 0;
+    this->Input->GetCellPoints(cellId, npts, pts);
+    if (npts == 0)
+      {
+      continue;
+      }
+    double center[3] = {0., 0., 0.};
+    for (vtkIdType k = 0; k < npts; ++k)
+      {
+      double point[3];
+      points->GetPoint(pts[k], point);
+      center[0] += point[0];
+      center[1] += point[1];
+      center[2] += point[2];
+      }
+    int blockIndex = 0;
+    for (int i = 2; i >= 0; --i)
+      {
+      int index = 0;
+      if (dimensions[i] > 1)
+        {
+        index = static_cast<int>((center[i] / npts - bounds[2*i]) /
+          (bounds[2*i+1] - bounds[2*i]) * dimensions[i]);
+        index = std::min(std::max(index, 0), dimensions[i] - 1);
+        }
+      blockIndex = blockIndex * dimensions[i] + index;
+      }
+    blockCells[blockIndex].push_back(cellId);
+    }
+
+  // Extract the cells of each block, with their point and cell data
+  vtkPointData* inputPointData = this->Input->GetPointData();
+  vtkCellData* inputCellData = this->Input->GetCellData();
+  std::vector<vtkIdType> pointMap(this->Input->GetNumberOfPoints(), -1);
+  std::vector<vtkIdType> usedPoints;
+  std::vector<vtkIdType> cellPoints;
+  for (size_t b = 0; b < blockCells.size(); ++b)
+    {
+    const std::vector<vtkIdType>& cellIds = blockCells[b];
+    if (cellIds.empty())
+      {
+      continue;
+      }
+    vtkSmartPointer<vtkPolyData> cells = vtkSmartPointer<vtkPolyData>::New();
+    vtkNew<vtkPoints> blockPoints;
+    blockPoints->SetDataType(points->GetDataType());
+    cells->SetPoints(blockPoints.GetPointer());
+    cells->Allocate(static_cast<vtkIdType>(cellIds.size()));
+    vtkPointData* pointData = cells->GetPointData();
+    vtkCellData* cellData = cells->GetCellData();
+    pointData->CopyAllocate(inputPointData);
+    cellData->CopyAllocate(inputCellData, static_cast<vtkIdType>(cellIds.size()));
+    usedPoints.clear();
+    for (int cellArray = 0; cellArray < 4; ++cellArray)
+      {
+      for (size_t c = 0; c < cellIds.size(); ++c)
+        {
+        const int cellType = this->Input->GetCellType(cellIds[c]);
+        if (GetCellArrayIndex(cellType) != cellArray)
+          {
+          continue;
+          }
+        vtkIdType npts = 0;
+        vtkIdType* pts = 0;
+        this->Input->GetCellPoints(cellIds[c], npts, pts);
+        cellPoints.resize(npts);
+        for (vtkIdType k = 0; k < npts; ++k)
+          {
+          vtkIdType& blockPointId = pointMap[pts[k]];
+          if (blockPointId < 0)
+            {
+            blockPointId = blockPoints->InsertNextPoint(points->GetPoint(pts[k]));
+            pointData->CopyData(inputPointData, pts[k], blockPointId);
+            usedPoints.push_back(pts[k]);
+            }
+          cellPoints[k] = blockPointId;
+          }
+        const vtkIdType blockCellId = cells->InsertNextCell(cellType, npts, &cellPoints[0]);
+        cellData->CopyData(inputCellData, cellIds[c], blockCellId);
+        }
+      }
+    for (size_t p = 0; p < usedPoints.size(); ++p)
+      {
+      pointMap[usedPoints[p]] = -1;
+      }
+    cells->Squeeze();
+
+    Block block;
+    block.Cells = cells;
+    cells->GetBounds(block.Bounds);
+    block.State = UnknownState;
+    this->Blocks.push_back(block);
+    }
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLModelClipCache::ClassifyBlock(const double bounds[6])const
+{
+  // Range of the clip function over the bounding box, computed the same
+  // way vtkImplicitBoolean combines the plane functions.
+  const bool intersection = (this->OperationType == VTK_INTERSECTION);
+  double minimum = intersection ? -VTK_DOUBLE_MAX : VTK_DOUBLE_MAX;
+  double maximum = minimum;
+  for (size_t p = 0; p + 5 < this->Planes.size(); p += 6)
+    {
+    const double* origin = &this->Planes[p];
+    const double* normal = &this->Planes[p + 3];
+    double value = 0.;
+    double extent = 0.;
+    for (int i = 0; i < 3; ++i)
+      {
+      const double center = 0.5 * (bounds[2*i] + bounds[2*i+1]);
+      value += normal[i] * (center - origin[i]);
+      extent += fabs(normal[i]) * 0.5 * (bounds[2*i+1] - bounds[2*i]);
+      }
+    if (intersection)
+      {
+      minimum = std::max(minimum, value - extent);
+      maximum = std::max(maximum, value + extent);
+      }
+    else
+      {
+      minimum = std::min(minimum, value - extent);
+      maximum = std::min(maximum, value + extent);
+      }
+    }
+  if (minimum > 0.)
+    {
+    return KeptState;
+    }
+  if (maximum < 0.)
+    {
+    return RemovedState;
+    }
+  return ClippedState;
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLModelClipCache::PrepareUpdate()
+{
+  const bool inputModified =
+    (this->Input != 0 && this->Input->GetMTime() != this->BlocksTime);
+  if (this->UpToDate && !inputModified &&
+      this->OperationType == this->UpdatedOperationType &&
+      this->Planes == this->UpdatedPlanes)
+    {
+    return false;
+    }
+  if (inputModified)
+    {
+    this->BuildBlocks();
+    }
+
+  this->ClipFunction = vtkSmartPointer<vtkImplicitBoolean>::New();
+  this->ClipFunction->SetOperationType(this->OperationType);
+  for (size_t p = 0; p + 5 < this->Planes.size(); p += 6)
+    {
+    vtkNew<vtkPlane> plane;
+    plane->SetOrigin(&this->Planes[p]);
+    plane->SetNormal(&this->Planes[p + 3]);
+    this->ClipFunction->AddFunction(plane.GetPointer());
+    }
+
+  // Only the blocks crossed by a plane need to be clipped again
+  bool modified = !this->UpToDate || inputModified;
+  bool keptBlocksModified = modified;
+  bool clippedBlocksModified = modified;
+  this->NumberOfClippedBlocks = 0;
+  for (size_t b = 0; b < this->Blocks.size(); ++b)
+    {
+    Block& block = this->Blocks[b];
+    const int state = this->ClassifyBlock(block.Bounds);
+    if ((state == KeptState) != (block.State == KeptState))
+      {
+      keptBlocksModified = true;
+      }
+    if ((state == ClippedState) != (block.State == ClippedState))
+      {
+      clippedBlocksModified = true;
+      }
+    if (state == ClippedState)
+      {
+      if (!block.Clipper)
+        {
+        block.Clipper = vtkSmartPointer<vtkClipPolyData>::New();
+        block.Clipper->SetValue(0.0);
+#if (VTK_MAJOR_VERSION <= 5)
+        block.Clipper->SetInput(block.Cells);
+#else
+        block.Clipper->SetInputData(block.Cells);
+#endif
+        }
+      block.Clipper->SetClipFunction(this->ClipFunction);
+      ++this->NumberOfClippedBlocks;
+      modified = true;
+      }
+    else if (state != block.State)
+      {
+      modified = true;
+      }
+    block.State = state;
+    }
+  if (!modified)
+    {
+    // the planes moved where there is no cell
+    this->UpdatedPlanes = this->Planes;
+    this->UpdatedOperationType = this->OperationType;
+    return false;
+    }
+
+  // The kept blocks are appended once, their result is reused as long as
+  // the same blocks are kept
+  if (keptBlocksModified)
+    {
+    this->KeptAppend->RemoveAllInputs();
+    this->HasKeptCells = false;
+    for (size_t b = 0; b < this->Blocks.size(); ++b)
+      {
+      Block& block = this->Blocks[b];
+      if (block.State == KeptState)
+        {
+#if (VTK_MAJOR_VERSION <= 5)
+        this->KeptAppend->AddInput(block.Cells);
+#else
+        this->KeptAppend->AddInputData(block.Cells);
+#endif
+        this->HasKeptCells = true;
+        }
+      }
+    }
+  if (keptBlocksModified || clippedBlocksModified)
+    {
+    this->Append->RemoveAllInputs();
+    this->EmptyOutput = !this->HasKeptCells;
+    if (this->HasKeptCells)
+      {
+#if (VTK_MAJOR_VERSION <= 5)
+      this->Append->AddInput(this->KeptAppend->GetOutput());
+#else
+      this->Append->AddInputConnection(this->KeptAppend->GetOutputPort());
+#endif
+      }
+    for (size_t b = 0; b < this->Blocks.size(); ++b)
+      {
+      Block& block = this->Blocks[b];
+      if (block.State == ClippedState)
+        {
+#if (VTK_MAJOR_VERSION <= 5)
+        this->Append->AddInput(block.Clipper->GetOutput());
+#else
+        this->Append->AddInputConnection(block.Clipper->GetOutputPort());
+#endif
+        this->EmptyOutput = false;
+        }
+      }
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelClipCache::ExecuteUpdate()
+{
+  if (!this->EmptyOutput)
+    {
+    this->Append->Update();
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelClipCache::FinishUpdate()
+{
+  if (this->EmptyOutput)
+    {
+    this->Output->Initialize();
+    }
+  else
+    {
+    this->Output->ShallowCopy(this->Append->GetOutput());
+    }
+  this->Output->Modified();
+  this->UpdatedPlanes = this->Planes;
+  this->UpdatedOperationType = this->OperationType;
+  this->UpToDate = true;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelClipCache::Update()
+{
+  if (this->PrepareUpdate())
+    {
+    this->ExecuteUpdate();
+    this->FinishUpdate();
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelClipCache::UpdateCaches(const std::vector<vtkMRMLModelClipCache*>& caches)
+{
+  std::vector<vtkMRMLModelClipCache*> modifiedCaches;
+  for (size_t i = 0; i < caches.size(); ++i)
+    {
+    if (caches[i] && caches[i]->PrepareUpdate())
+      {
+      modifiedCaches.push_back(caches[i]);
+      }
+    }
+  if (modifiedCaches.size() > 1)
+    {
+    // the caches don't share any pipeline object, each thread clips
+    // its own models
+    vtkNew<vtkMultiThreader> threader;
+    threader->SetNumberOfThreads(std::min(
+      static_cast<int>(modifiedCaches.size()), threader->GetNumberOfThreads()));
+    threader->SetSingleMethod(ExecuteUpdateThreaderCallback, &modifiedCaches);
+    threader->SingleMethodExecute();
+    }
+  else if (modifiedCaches.size() == 1)
+    {
+    modifiedCaches[0]->ExecuteUpdate();
+    }
+  for (size_t i = 0; i < modifiedCaches.size(); ++i)
+    {
+    modifiedCaches[i]->FinishUpdate();
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelClipCache::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Input: " << this->Input << "\n";
+  os << indent << "OperationType: " << this->OperationType << "\n";
+  os << indent << "NumberOfClipPlanes: " << this->GetNumberOfClipPlanes() << "\n";
+  os << indent << "NumberOfCellsPerBlock: " << this->NumberOfCellsPerBlock << "\n";
+  os << indent << "NumberOfBlocks: " << this->Blocks.size() << "\n";
+  os << indent << "NumberOfClippedBlocks: " << this->NumberOfClippedBlocks << "\n";
+}
@@ -0,0 +1,177 @@
+/*=========================================================================
+
+  Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+==========================================================================*/
+
+#ifndef __vtkMRMLModelClipCache_h
+#define __vtkMRMLModelClipCache_h
+
+// MRMLDisplayableManager includes
+#include "vtkMRMLDisplayableManagerWin32Header.h"
+
+// VTK includes
+#include <vtkObject.h>
+#include <vtkSmartPointer.h>
+class vtkAppendPolyData;
+class vtkClipPolyData;
+class vtkImplicitBoolean;
+class vtkPolyData;
+
+// STD includes
+#include <vector>
+
+/// \brief Clipped surface of a model, re-clipped only where the planes moved.
+///
+/// The cells of the input are sorted into blocks of neighboring cells. Each
+/// block is kept, removed or clipped depending on the side of the clip planes
+/// its bounding box is. When the planes move, only the blocks that are
+/// crossed by a plane are clipped again; the other blocks reuse their
+/// previous result. The kept blocks are appended together only when a
+/// block becomes kept or stops being kept, the output appends that part to
+/// the clipped blocks. Nothing is done if neither the input nor the planes
+/// changed.
+///
+/// The clip function is the intersection (maximum) or the union (minimum) of
+/// the plane functions, like vtkImplicitBoolean, and the surface where it is
+/// positive is kept, like vtkClipPolyData.
+///
+/// Updating is split in 3 steps so that the caches of several models can be
+/// clipped in parallel: PrepareUpdate() and FinishUpdate() must be called
+/// from the main thread, ExecuteUpdate() can be called from any thread
+/// as long as a cache is executed by one thread only.
+/// \sa vtkMRMLModelDisplayableManager
+class VTK_MRML_DISPLAYABLEMANAGER_EXPORT vtkMRMLModelClipCache
+  : public vtkObject
+{
+public:
+  static vtkMRMLModelClipCache* New();
+  vtkTypeMacro(vtkMRMLModelClipCache, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  ///
+  /// Surface to clip. The blocks are computed again when it is modified.
+  void SetInput(vtkPolyData* input);
+  vtkGetObjectMacro(Input, vtkPolyData);
+
+  ///
+  /// Operation combining the planes: VTK_INTERSECTION (default) or VTK_UNION
+  /// as defined in vtkImplicitBoolean.
+  vtkSetMacro(OperationType, int);
+  vtkGetMacro(OperationType, int);
+
+  ///
+  /// Set the clip planes. The planes are copied, the cache is not clipped
+  /// until the next update.
+  void RemoveAllClipPlanes();
+  void AddClipPlane(const double origin[3], const double normal[3]);
+  int GetNumberOfClipPlanes()const;
+
+  ///
+  /// Approximate number of cells per block, 4096 by default.
+  vtkSetMacro(NumberOfCellsPerBlock, int);
+  vtkGetMacro(NumberOfCellsPerBlock, int);
+
+  ///
+  /// Clipped surface, modified by FinishUpdate() only.
+  vtkPolyData* GetOutput();
+
+  ///
+  /// Cells of the blocks kept entirely, appended again only when the kept
+  /// blocks change.
+  vtkPolyData* GetKeptCells();
+
+  ///
+  /// Classify the blocks with the current planes and set up the pipeline of
+  /// the blocks to clip. Return true if ExecuteUpdate() and FinishUpdate()
+  /// must be called, false if the output is up to date.
+  bool PrepareUpdate();
+
+  ///
+  /// Clip the blocks crossed by the planes and append all the blocks.
+  void ExecuteUpdate();
+
+  ///
+  /// Copy the result into the output.
+  void FinishUpdate();
+
+  ///
+  /// Call PrepareUpdate(), ExecuteUpdate() and FinishUpdate().
+  void Update();
+
+  ///
+  /// Update all the caches, executing them in parallel.
+  //BTX
+  static void UpdateCaches(const std::vector<vtkMRMLModelClipCache*>& caches);
+  //ETX
+
+  ///
+  /// Number of blocks clipped by the last update.
+  vtkGetMacro(NumberOfClippedBlocks, int);
+
+protected:
+  vtkMRMLModelClipCache();
+  virtual ~vtkMRMLModelClipCache();
+
+  enum BlockState
+  {
+    UnknownState = 0,
+    KeptState,
+    RemovedState,
+    ClippedState
+  };
+
+  //BTX
+  struct Block
+  {
+    vtkSmartPointer<vtkPolyData>     Cells;
+    vtkSmartPointer<vtkClipPolyData> Clipper;
+    double                           Bounds[6];
+    int                              State;
+  };
+  //ETX
+
+  ///
+  /// Sort the cells of the input into blocks.
+  void BuildBlocks();
+
+  ///
+  /// Return the state of a block with the given bounds.
+  int ClassifyBlock(const double bounds[6])const;
+
+  vtkPolyData* Input;
+  unsigned long BlocksTime;
+  int OperationType;
+  int NumberOfCellsPerBlock;
+  int NumberOfClippedBlocks;
+
+  //BTX
+  /// Origin and normal of each plane
+  std::vector<double> Planes;
+  /// Planes and operation of the last update
+  std::vector<double> UpdatedPlanes;
+  int UpdatedOperationType;
+  bool UpToDate;
+
+  std::vector<Block> Blocks;
+  vtkSmartPointer<vtkImplicitBoolean> ClipFunction;
+  /// Kept blocks
+  vtkSmartPointer<vtkAppendPolyData> KeptAppend;
+  bool HasKeptCells;
+  /// Kept blocks and clipped blocks
+  vtkSmartPointer<vtkAppendPolyData> Append;
+  vtkSmartPointer<vtkPolyData> Output;
+  bool EmptyOutput;
+  //ETX
+
+private:
+  vtkMRMLModelClipCache(const vtkMRMLModelClipCache&); // Not implemented
+  void operator=(const vtkMRMLModelClipCache&);       // Not implemented
+};
+
+#endif
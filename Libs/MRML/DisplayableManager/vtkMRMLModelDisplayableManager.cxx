@@ -15,6 +15,7 @@
 // MRMLLogic includes
 
 // MRMLDisplayableManager includes
+#include "vtkMRMLModelClipCache.h"
 #include "vtkMRMLModelDisplayableManager.h"
 #include "vtkThreeDViewInteractorStyle.h"
 #include "vtkMRMLApplicationLogic.h"
@@ -93,6 +94,11 @@ public:
   std::map<std::string, vtkMRMLDisplayableNode *>  DisplayableNodes;
   std::map<std::string, int>                       RegisteredModelHierarchies;
   std::map<std::string, vtkTransformPolyDataFilter *> DisplayNodeTransformPolyDataFilters;
+  std::map<std::string, vtkSmartPointer<vtkMRMLModelClipCache> > DisplayNodeClipCaches;
+
+  /// True while all the models are updated, the clip caches are then
+  /// clipped together at the end.
+  bool UpdatingModels;
 
   vtkMRMLSliceNode *   RedSliceNode;
   vtkMRMLSliceNode *   GreenSliceNode;
@@ -142,6 +148,7 @@ vtkMRMLModelDisplayableManager::vtkInternal::vtkInternal()
 
   this->ModelHierarchiesPresent = false;
   this->UpdateHierachyRequested = false;
+  this->UpdatingModels = false;
 
   // Instantiate and initialize Pickers
   this->WorldPointPicker = vtkSmartPointer<vtkWorldPointPicker>::New();
@@ -797,6 +804,7 @@ void vtkMRMLModelDisplayableManager::UpdateModelsFromMRML()
 
   // find volume slices
   bool clearDisplayedModels = scene ? false : true;
+  this->Internal->UpdatingModels = true;
 
   std::vector<vtkMRMLNode *> dnodes;
   int nnodes = scene ? scene->GetNodesByClass("vtkMRMLDisplayableNode", dnodes) : 0;
@@ -832,6 +840,7 @@ void vtkMRMLModelDisplayableManager::UpdateModelsFromMRML()
     this->Internal->DisplayedClipState.clear();
     this->Internal->DisplayedVisibility.clear();
     this->Internal->DisplayNodeTransformPolyDataFilters.clear();
+    this->Internal->DisplayNodeClipCaches.clear();
     this->UpdateModelHierarchies();
     }
 
@@ -865,6 +874,9 @@ void vtkMRMLModelDisplayableManager::UpdateModelsFromMRML()
       this->UpdateModifiedModel(model);
       }
     } // end while
+
+  this->Internal->UpdatingModels = false;
+  this->UpdateClipCaches();
 }
 
 //---------------------------------------------------------------------------
@@ -1006,6 +1018,29 @@ void vtkMRMLModelDisplayableManager
       transformFilter->SetTransform(worldTransform);
       }
 
+    // surface clipped by the clip cache of the display node, in world
+    // coordinates if the transform is non-linear
+    vtkPolyData* clipInput = 0;
+    if (this->Internal->ClippingOn && modelDisplayNode != 0 && clipping)
+      {
+#if (VTK_MAJOR_VERSION <= 5)
+      clipInput = transformFilter ? transformFilter->GetOutput() : polyData;
+      clipInput->Update();
+#else
+      vtkAlgorithmOutput* clipInputConnection =
+        transformFilter ? transformFilter->GetOutputPort() : polyDataConnection;
+      clipInputConnection->GetProducer()->Update();
+      clipInput = vtkPolyData::SafeDownCast(
+        clipInputConnection->GetProducer()->GetOutputDataObject(
+          clipInputConnection->GetIndex()));
+#endif
+      }
+    if (clipInput == 0)
+      {
+      // not clipped anymore: its cache must not be updated and reused
+      this->Internal->DisplayNodeClipCaches.erase(displayNode->GetID());
+      }
+
     std::map<std::string, vtkProp3D *>::iterator ait;
     ait = this->Internal->DisplayedActors.find(displayNode->GetID());
     if (ait == this->Internal->DisplayedActors.end() )
@@ -1053,36 +1088,47 @@ void vtkMRMLModelDisplayableManager
 #endif
             }
           }
-        vtkMRMLTransformNode* tnode = displayableNode->GetParentTransformNode();
-        // clipped model could be transformed
-        // TODO: handle non-linear transforms
-        if (clipping == 0 || tnode == 0 || !tnode->IsTransformToWorldLinear())
+        if (clipInput == 0)
           {
           continue;
           }
+        // clipped models are clipped again by their cache, only where the
+        // slice planes moved
+        vtkPolyDataMapper *clippedMapper = actor ?
+          vtkPolyDataMapper::SafeDownCast(actor->GetMapper()) : 0;
+        if (clippedMapper &&
+            this->Internal->DisplayNodeClipCaches.find(modelDisplayNode->GetID()) !=
+            this->Internal->DisplayNodeClipCaches.end())
+          {
+          vtkMRMLModelClipCache* clipCache =
+            this->UpdateClipCache(modelDisplayNode, displayableNode, clipInput);
+#if (VTK_MAJOR_VERSION <= 5)
+          clippedMapper->SetInput(clipCache->GetOutput());
+#else
+          clippedMapper->SetInputData(clipCache->GetOutput());
+#endif
+          continue;
+          }
         }
       }
 
-    vtkClipPolyData *clipper = 0;
+    vtkMRMLModelClipCache *clipCache = 0;
     vtkActor * actor = vtkActor::SafeDownCast(prop);
     if(actor)
       {
-      if (this->Internal->ClippingOn && modelDisplayNode != 0 && clipping)
+      if (clipInput)
         {
-        clipper = this->CreateTransformedClipper(displayableNode);
+        clipCache = this->UpdateClipCache(modelDisplayNode, displayableNode, clipInput);
         }
 
       vtkPolyDataMapper *mapper = vtkPolyDataMapper::New();
 
-      if (clipper)
+      if (clipCache)
         {
 #if (VTK_MAJOR_VERSION <= 5)
-        clipper->SetInput(polyData);
-        clipper->Update();
-        mapper->SetInput(clipper->GetOutput());
+        mapper->SetInput(clipCache->GetOutput());
 #else
-        clipper->SetInputConnection(polyDataConnection);
-        mapper->SetInputConnection(clipper->GetOutputPort());
+        mapper->SetInputData(clipCache->GetOutput());
 #endif
         }
       else if (transformFilter)
@@ -1122,10 +1168,9 @@ void vtkMRMLModelDisplayableManager
         this->Internal->DisplayedVisibility[modelDisplayNode->GetID()] = 1;
         }
 
-      if (clipper)
+      if (clipCache)
         {
         this->Internal->DisplayedClipState[modelDisplayNode->GetID()] = 1;
-        clipper->Delete();
         }
       else
         {
@@ -1139,10 +1184,9 @@ void vtkMRMLModelDisplayableManager
       }
     else
       {
-      if (clipper)
+      if (clipCache)
         {
         this->Internal->DisplayedClipState[modelDisplayNode->GetID()] = 1;
-        clipper->Delete();
         }
       else
         {
@@ -1157,6 +1201,10 @@ void vtkMRMLModelDisplayableManager
 void vtkMRMLModelDisplayableManager::UpdateModel(vtkMRMLDisplayableNode *model)
 {
   this->UpdateModelPolyData(model);
+  if (!this->Internal->UpdatingModels)
+    {
+    this->UpdateClipCaches();
+    }
 
   vtkEventBroker *broker = vtkEventBroker::GetInstance();
   vtkEventBroker::ObservationVector observations;
@@ -1408,6 +1456,7 @@ void vtkMRMLModelDisplayableManager::RemoveDispalyedID(std::string &id)
   this->Internal->DisplayedActors.erase(id);
   this->Internal->DisplayedClipState.erase(id);
   this->Internal->DisplayedVisibility.erase(id);
+  this->Internal->DisplayNodeClipCaches.erase(id);
   modelIter = this->Internal->DisplayedNodes.find(id);
   if(modelIter != this->Internal->DisplayedNodes.end())
     {
@@ -2287,6 +2336,68 @@ vtkClipPolyData* vtkMRMLModelDisplayableManager::CreateTransformedClipper(
   return clipper;
 }
 
+//---------------------------------------------------------------------------
+vtkMRMLModelClipCache* vtkMRMLModelDisplayableManager::UpdateClipCache(
+  vtkMRMLDisplayNode* displayNode, vtkMRMLDisplayableNode* model, vtkPolyData* polyData)
+{
+  vtkSmartPointer<vtkMRMLModelClipCache>& clipCache =
+    this->Internal->DisplayNodeClipCaches[displayNode->GetID()];
+  if (!clipCache)
+    {
+    clipCache = vtkSmartPointer<vtkMRMLModelClipCache>::New();
+    }
+  clipCache->SetInput(polyData);
+  clipCache->SetOperationType(
+    this->Internal->ClipType == vtkMRMLClipModelsNode::ClipUnion ?
+    VTK_UNION : VTK_INTERSECTION);
+
+  // Planes in the coordinates of the model if it is linearly transformed,
+  // non-linearly transformed models are clipped in world coordinates.
+  vtkNew<vtkMatrix4x4> worldToModel;
+  vtkMRMLTransformNode* tnode = model->GetParentTransformNode();
+  if (tnode != 0 && tnode->IsTransformToWorldLinear())
+    {
+    tnode->GetMatrixTransformToWorld(worldToModel.GetPointer());
+    worldToModel->Invert();
+    }
+  vtkMRMLSliceNode* sliceNodes[3] = {
+    this->Internal->RedSliceNode, this->Internal->GreenSliceNode, this->Internal->YellowSliceNode};
+  int clipStates[3] = {
+    this->Internal->RedSliceClipState, this->Internal->GreenSliceClipState,
+    this->Internal->YellowSliceClipState};
+  clipCache->RemoveAllClipPlanes();
+  for (int i = 0; i < 3; ++i)
+    {
+    if (clipStates[i] == vtkMRMLClipModelsNode::ClipOff || sliceNodes[i] == 0)
+      {
+      continue;
+      }
+    vtkNew<vtkMatrix4x4> mat;
+    vtkMatrix4x4::Multiply4x4(worldToModel.GetPointer(), sliceNodes[i]->GetSliceToRAS(),
+                              mat.GetPointer());
+    vtkNew<vtkPlane> plane;
+    this->SetClipPlaneFromMatrix(
+      mat.GetPointer(),
+      (clipStates[i] == vtkMRMLClipModelsNode::ClipNegativeSpace) ? -1 : 1,
+      plane.GetPointer());
+    clipCache->AddClipPlane(plane->GetOrigin(), plane->GetNormal());
+    }
+  return clipCache;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::UpdateClipCaches()
+{
+  std::vector<vtkMRMLModelClipCache*> clipCaches;
+  std::map<std::string, vtkSmartPointer<vtkMRMLModelClipCache> >::iterator it;
+  for (it = this->Internal->DisplayNodeClipCaches.begin();
+       it != this->Internal->DisplayNodeClipCaches.end(); ++it)
+    {
+    clipCaches.push_back(it->second);
+    }
+  vtkMRMLModelClipCache::UpdateCaches(clipCaches);
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLModelDisplayableManager::OnInteractorStyleEvent(int eventid)
 {
@@ -26,6 +26,7 @@
 class vtkMRMLClipModelsNode;
 class vtkMRMLDisplayNode;
 class vtkMRMLDisplayableNode;
+class vtkMRMLModelClipCache;
 class vtkMRMLModelHierarchyLogic;
 class vtkMRMLModelHierarchyNode;
 class vtkMRMLModelNode;
@@ -187,6 +188,15 @@ protected:
   int UpdateClipSlicesFromMRML();
   vtkClipPolyData* CreateTransformedClipper(vtkMRMLDisplayableNode *model);
 
+  /// Set the surface and the clip planes of the clip cache of a display
+  /// node, creating the cache if needed. The cache is clipped by
+  /// UpdateClipCaches().
+  vtkMRMLModelClipCache* UpdateClipCache(vtkMRMLDisplayNode* displayNode,
+                                         vtkMRMLDisplayableNode *model,
+                                         vtkPolyData* polyData);
+  /// Clip again the caches whose surface or planes changed, in parallel.
+  void UpdateClipCaches();
+
   void AddHierarchyObservers();
   void RemoveHierarchyObservers(int clearCache);
 
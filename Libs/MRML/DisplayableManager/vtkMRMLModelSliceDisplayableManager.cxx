@@ -17,6 +17,7 @@
 
 // MRMLDisplayableManager includes
 #include "vtkMRMLModelSliceDisplayableManager.h"
+#include "vtkMRMLModelSliceIntersectionIndex.h"
 
 // MRML includes
 #include <vtkMRMLColorNode.h>
@@ -39,6 +40,7 @@
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPlane.h>
+#include <vtkPolyData.h>
 #include <vtkPolyDataMapper2D.h>
 #include <vtkProperty2D.h>
 #include <vtkRenderer.h>
@@ -75,11 +77,19 @@ public:
     vtkSmartPointer<vtkPlane> Plane;
     vtkSmartPointer<vtkCutter> Cutter;
     vtkSmartPointer<vtkProp> Actor;
+    // Cells crossing the slice, in model coordinates
+    vtkSmartPointer<vtkPolyData> SliceCells;
     };
 
   typedef std::map < vtkMRMLDisplayNode*, const Pipeline* > PipelinesCacheType;
   PipelinesCacheType DisplayPipelines;
 
+  // Index of the cells of the model of each display node, shared with the
+  // other slice views
+  typedef std::map < vtkMRMLDisplayNode*,
+    vtkSmartPointer<vtkMRMLModelSliceIntersectionIndex> > IntersectionIndexesType;
+  IntersectionIndexesType IntersectionIndexes;
+
   typedef std::map < vtkMRMLDisplayableNode*, std::set< vtkMRMLDisplayNode* > > ModelToDisplayCacheType;
   ModelToDisplayCacheType ModelToDisplayNodes;
 
@@ -271,6 +281,7 @@ void vtkMRMLModelSliceDisplayableManager::vtkInternal
   this->External->GetRenderer()->RemoveActor(pipeline->Actor);
   delete pipeline;
   this->DisplayPipelines.erase(actorsIt);
+  this->IntersectionIndexes.erase(displayNode);
 }
 
 //---------------------------------------------------------------------------
@@ -308,6 +319,7 @@ void vtkMRMLModelSliceDisplayableManager::vtkInternal
   pipeline->Transformer = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
   pipeline->ModelWarper = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
   pipeline->Plane = vtkSmartPointer<vtkPlane>::New();
+  pipeline->SliceCells = vtkSmartPointer<vtkPolyData>::New();
 
   // Set up pipeline
   pipeline->Transformer->SetTransform(pipeline->TransformToSlice);
@@ -373,22 +385,83 @@ void vtkMRMLModelSliceDisplayableManager::vtkInternal
       {
       return;
       }
-#if (VTK_MAJOR_VERSION <= 5)
-    pipeline->ModelWarper->SetInput(polyData);
-    // need this to update bounds of the locator, to avoid crash in the cutter
-    polyData->Modified();
-#else
-    pipeline->ModelWarper->SetInputData(polyData);
-    // need this to update bounds of the locator, to avoid crash in the cutter
-    modelDisplayNode->GetOutputPolyDataConnection()->GetProducer()->Update();
-#endif
-
     pipeline->ModelWarper->SetTransform(pipeline->NodeToWorld);
 
     //  Set Plane Transform
     this->SetSlicePlaneFromMatrix(this->SliceXYToRAS, pipeline->Plane);
     pipeline->Plane->Modified();
 
+    vtkMRMLDisplayableNode* displayableNode = displayNode->GetDisplayableNode();
+    vtkMRMLTransformNode* tnode =
+      displayableNode ? displayableNode->GetParentTransformNode() : 0;
+    if (tnode == 0 || tnode->IsTransformToWorldLinear())
+      {
+      // Only cut the cells crossing the slice, found by the index of the
+      // model, then transform the intersection into world coordinates.
+#if (VTK_MAJOR_VERSION <= 5)
+      polyData->Update();
+#else
+      modelDisplayNode->GetOutputPolyDataConnection()->GetProducer()->Update();
+#endif
+      vtkNew<vtkMatrix4x4> nodeToWorld;
+      if (tnode)
+        {
+        tnode->GetMatrixTransformToWorld(nodeToWorld.GetPointer());
+        }
+      vtkNew<vtkMatrix4x4> worldToNode;
+      vtkMatrix4x4::Invert(nodeToWorld.GetPointer(), worldToNode.GetPointer());
+      double worldOrigin[4] = {0., 0., 0., 1.};
+      pipeline->Plane->GetOrigin(worldOrigin);
+      double nodeOrigin[4];
+      worldToNode->MultiplyPoint(worldOrigin, nodeOrigin);
+      // normals are transformed by the transpose of the inverse
+      double* worldNormal = pipeline->Plane->GetNormal();
+      double nodeNormal[3];
+      for (int i = 0; i < 3; ++i)
+        {
+        nodeNormal[i] = nodeToWorld->GetElement(0, i) * worldNormal[0] +
+                        nodeToWorld->GetElement(1, i) * worldNormal[1] +
+                        nodeToWorld->GetElement(2, i) * worldNormal[2];
+        }
+      pipeline->Plane->SetOrigin(nodeOrigin);
+      pipeline->Plane->SetNormal(nodeNormal);
+
+      vtkSmartPointer<vtkMRMLModelSliceIntersectionIndex>& index =
+        this->IntersectionIndexes[displayNode];
+      if (!index || index->GetInput() != polyData)
+        {
+        index = vtkMRMLModelSliceIntersectionIndex::GetSharedIndex(polyData);
+        }
+      // a new slice normal is not indexed yet: cut the whole model
+      vtkPolyData* cutterInput =
+        index->ExtractCells(nodeOrigin, nodeNormal, pipeline->SliceCells) ?
+        pipeline->SliceCells.GetPointer() : polyData;
+
+#if (VTK_MAJOR_VERSION <= 5)
+      pipeline->Cutter->SetInput(cutterInput);
+#else
+      pipeline->Cutter->SetInputData(cutterInput);
+#endif
+      pipeline->ModelWarper->SetInputConnection(pipeline->Cutter->GetOutputPort());
+      pipeline->Transformer->SetInputConnection(pipeline->ModelWarper->GetOutputPort());
+      }
+    else
+      {
+      // Non-linear transforms: cut the whole warped model
+      this->IntersectionIndexes.erase(displayNode);
+#if (VTK_MAJOR_VERSION <= 5)
+      pipeline->ModelWarper->SetInput(polyData);
+      // need this to update bounds of the locator, to avoid crash in the cutter
+      polyData->Modified();
+#else
+      pipeline->ModelWarper->SetInputData(polyData);
+      // need this to update bounds of the locator, to avoid crash in the cutter
+      modelDisplayNode->GetOutputPolyDataConnection()->GetProducer()->Update();
+#endif
+      pipeline->Cutter->SetInputConnection(pipeline->ModelWarper->GetOutputPort());
+      pipeline->Transformer->SetInputConnection(pipeline->Cutter->GetOutputPort());
+      }
+
     //  Set PolyData Transform
     vtkNew<vtkMatrix4x4> rasToSliceXY;
     vtkMatrix4x4::Invert(this->SliceXYToRAS, rasToSliceXY.GetPointer());
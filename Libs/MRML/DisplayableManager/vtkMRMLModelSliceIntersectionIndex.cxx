@@ -0,0 +1,452 @@
+/*=========================================================================
+
+  Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+==========================================================================*/
+
+// MRMLDisplayableManager includes
+#include "vtkMRMLModelSliceIntersectionIndex.h"
+
+// VTK includes
+#include <vtkCellData.h>
+#include <vtkCellType.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+//---------------------------------------------------------------------------
+vtkStandardNewMacro(vtkMRMLModelSliceIntersectionIndex);
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+// Indexes shared by the slice views, an index removes itself when deleted.
+typedef std::map<vtkPolyData*, vtkMRMLModelSliceIntersectionIndex*> SharedIndexesType;
+SharedIndexesType& SharedIndexes()
+{
+  static SharedIndexesType sharedIndexes;
+  return sharedIndexes;
+}
+
+//---------------------------------------------------------------------------
+// Index of the cell array of vtkPolyData that contains the cell type. The
+// cells are inserted in that order to keep the cell ids consistent with the
+// cell data.
+int GetCellArrayIndex(int cellType)
+{
+  switch (cellType)
+    {
+    case VTK_VERTEX:
+    case VTK_POLY_VERTEX:
+      return 0;
+    case VTK_LINE:
+    case VTK_POLY_LINE:
+      return 1;
+    case VTK_TRIANGLE_STRIP:
+      return 3;
+    default:
+      return 2;
+    }
+}
+
+//---------------------------------------------------------------------------
+bool SameNormal(const double normal1[3], const double normal2[3])
+{
+  return fabs(normal1[0] - normal2[0]) < 1e-9 &&
+         fabs(normal1[1] - normal2[1]) < 1e-9 &&
+         fabs(normal1[2] - normal2[2]) < 1e-9;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+vtkMRMLModelSliceIntersectionIndex::vtkMRMLModelSliceIntersectionIndex()
+{
+  this->Input = 0;
+  this->IndexTime = 0;
+  this->MaximumNumberOfDirections = 8;
+  this->MaximumNumberOfCellSlabs = 4;
+  this->Shared = false;
+  this->UseCount = 0;
+}
+
+//---------------------------------------------------------------------------
+vtkMRMLModelSliceIntersectionIndex::~vtkMRMLModelSliceIntersectionIndex()
+{
+  if (this->Shared)
+    {
+    SharedIndexes().erase(this->Input);
+    }
+  this->SetInput(0);
+}
+
+//---------------------------------------------------------------------------
+vtkSmartPointer<vtkMRMLModelSliceIntersectionIndex> vtkMRMLModelSliceIntersectionIndex
+::GetSharedIndex(vtkPolyData* polyData)
+{
+  if (!polyData)
+    {
+    return 0;
+    }
+  SharedIndexesType::iterator it = SharedIndexes().find(polyData);
+  if (it != SharedIndexes().end())
+    {
+    return it->second;
+    }
+  vtkSmartPointer<vtkMRMLModelSliceIntersectionIndex> index =
+    vtkSmartPointer<vtkMRMLModelSliceIntersectionIndex>::New();
+  index->SetInput(polyData);
+  index->Shared = true;
+  SharedIndexes()[polyData] = index;
+  return index;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelSliceIntersectionIndex::SetInput(vtkPolyData* input)
+{
+  if (input == this->Input)
+    {
+    return;
+    }
+  if (this->Input)
+    {
+    this->Input->UnRegister(this);
+    }
+  this->Input = input;
+  if (this->Input)
+    {
+    this->Input->Register(this);
+    }
+  this->Directions.clear();
+  this->UsedNormals.clear();
+  this->IndexTime = 0;
+  this->Modified();
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLModelSliceIntersectionIndex::GetNumberOfDirections()const
+{
+  return static_cast<int>(this->Directions.size());
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelSliceIntersectionIndex
+::GetCellRange(vtkIdType cellId, const double normal[3], double range[2])
+{
+  vtkIdType npts = 0;
+  vtkIdType* pts = 0;
+  this->Input->GetCellPoints(cellId, npts, pts);
+  vtkPoints* points = this->Input->GetPoints();
+  range[0] = VTK_DOUBLE_MAX;
+  range[1] = -VTK_DOUBLE_MAX;
+  for (vtkIdType k = 0; k < npts; ++k)
+    {
+    const double distance = vtkMath::Dot(normal, points->GetPoint(pts[k]));
+    range[0] = std::min(range[0], distance);
+    range[1] = std::max(range[1], distance);
+    }
+}
+
+//---------------------------------------------------------------------------
+vtkMRMLModelSliceIntersectionIndex::Direction* vtkMRMLModelSliceIntersectionIndex
+::GetDirection(const double normal[3])
+{
+  std::list<Direction>::iterator it;
+  std::list<Direction>::iterator leastRecentlyUsed = this->Directions.end();
+  for (it = this->Directions.begin(); it != this->Directions.end(); ++it)
+    {
+    if (SameNormal(it->Normal, normal))
+      {
+      it->LastUsed = ++this->UseCount;
+      return &(*it);
+      }
+    if (leastRecentlyUsed == this->Directions.end() ||
+        it->LastUsed < leastRecentlyUsed->LastUsed)
+      {
+      leastRecentlyUsed = it;
+      }
+    }
+
+  // The slabs are computed the second time the normal is used only, a
+  // normal used once would not pay for them
+  size_t usedNormal = 0;
+  while (usedNormal < this->UsedNormals.size() &&
+         !SameNormal(&this->UsedNormals[usedNormal], normal))
+    {
+    usedNormal += 3;
+    }
+  if (usedNormal >= this->UsedNormals.size())
+    {
+    if (this->UsedNormals.size() >=
+        3 * static_cast<size_t>(std::max(this->MaximumNumberOfDirections, 1)))
+      {
+      this->UsedNormals.erase(this->UsedNormals.begin(),
+                              this->UsedNormals.begin() + 3);
+      }
+    this->UsedNormals.insert(this->UsedNormals.end(), normal, normal + 3);
+    return 0;
+    }
+  this->UsedNormals.erase(this->UsedNormals.begin() + usedNormal,
+                          this->UsedNormals.begin() + usedNormal + 3);
+
+  if (leastRecentlyUsed != this->Directions.end() &&
+      this->GetNumberOfDirections() >= this->MaximumNumberOfDirections)
+    {
+    this->Directions.erase(leastRecentlyUsed);
+    }
+  this->Directions.push_back(Direction());
+  Direction& direction = this->Directions.back();
+  this->BuildDirection(normal, direction);
+  direction.LastUsed = ++this->UseCount;
+  return &direction;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelSliceIntersectionIndex
+::BuildDirection(const double normal[3], Direction& direction)
+{
+  direction.Normal[0] = normal[0];
+  direction.Normal[1] = normal[1];
+  direction.Normal[2] = normal[2];
+
+  // Range of each cell along the normal
+  const vtkIdType numberOfCells = this->Input->GetNumberOfCells();
+  std::vector<double> cellRanges(2 * numberOfCells);
+  direction.Minimum = VTK_DOUBLE_MAX;
+  direction.Maximum = -VTK_DOUBLE_MAX;
+  double sumOfRanges = 0.;
+  for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+    {
+    double* range = &cellRanges[2 * cellId];
+    this->GetCellRange(cellId, normal, range);
+    if (range[0] > range[1])
+      {
+      // cell without points
+      continue;
+      }
+    direction.Minimum = std::min(direction.Minimum, range[0]);
+    direction.Maximum = std::max(direction.Maximum, range[1]);
+    sumOfRanges += range[1] - range[0];
+    }
+
+  // Slabs about as wide as a cell: a cell is in 1 or 2 slabs on average
+  vtkIdType numberOfSlabs = 1;
+  direction.SlabWidth = 0.;
+  if (direction.Maximum > direction.Minimum)
+    {
+    const double averageRange = sumOfRanges / numberOfCells;
+    const double slabs = averageRange > 0. ?
+      (direction.Maximum - direction.Minimum) / averageRange :
+      static_cast<double>(numberOfCells);
+    numberOfSlabs = std::max(static_cast<vtkIdType>(1), std::min(
+      numberOfCells, static_cast<vtkIdType>(slabs)));
+    direction.SlabWidth = (direction.Maximum - direction.Minimum) / numberOfSlabs;
+    }
+
+  // Two passes: count the cells of each slab, then fill them. The cells
+  // overlapping too many slabs are listed once, apart.
+  const vtkIdType maximumCellSlabs =
+    std::max(this->MaximumNumberOfCellSlabs, 1);
+  direction.SlabOffsets.assign(numberOfSlabs + 1, 0);
+  direction.LongCells.clear();
+  for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+    {
+    const double* range = &cellRanges[2 * cellId];
+    if (range[0] > range[1])
+      {
+      continue;
+      }
+    vtkIdType firstSlab = 0;
+    vtkIdType lastSlab = 0;
+    if (direction.SlabWidth > 0.)
+      {
+      firstSlab = std::min(numberOfSlabs - 1, static_cast<vtkIdType>(
+        (range[0] - direction.Minimum) / direction.SlabWidth));
+      lastSlab = std::min(numberOfSlabs - 1, static_cast<vtkIdType>(
+        (range[1] - direction.Minimum) / direction.SlabWidth));
+      }
+    if (lastSlab - firstSlab >= maximumCellSlabs)
+      {
+      direction.LongCells.push_back(cellId);
+      continue;
+      }
+    for (vtkIdType slab = firstSlab; slab <= lastSlab; ++slab)
+      {
+      ++direction.SlabOffsets[slab + 1];
+      }
+    }
+  for (vtkIdType slab = 0; slab < numberOfSlabs; ++slab)
+    {
+    direction.SlabOffsets[slab + 1] += direction.SlabOffsets[slab];
+    }
+  direction.Cells.resize(direction.SlabOffsets[numberOfSlabs]);
+  std::vector<vtkIdType> slabEnds(direction.SlabOffsets.begin(),
+                                  direction.SlabOffsets.end() - 1);
+  for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+    {
+    const double* range = &cellRanges[2 * cellId];
+    if (range[0] > range[1])
+      {
+      continue;
+      }
+    vtkIdType firstSlab = 0;
+    vtkIdType lastSlab = 0;
+    if (direction.SlabWidth > 0.)
+      {
+      firstSlab = std::min(numberOfSlabs - 1, static_cast<vtkIdType>(
+        (range[0] - direction.Minimum) / direction.SlabWidth));
+      lastSlab = std::min(numberOfSlabs - 1, static_cast<vtkIdType>(
+        (range[1] - direction.Minimum) / direction.SlabWidth));
+      }
+    if (lastSlab - firstSlab >= maximumCellSlabs)
+      {
+      continue;
+      }
+    for (vtkIdType slab = firstSlab; slab <= lastSlab; ++slab)
+      {
+      direction.Cells[slabEnds[slab]++] = cellId;
+      }
+    }
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLModelSliceIntersectionIndex::ExtractCells(
+  const double origin[3], const double normal[3], vtkPolyData* output)
+{
+  if (!output)
+    {
+    return false;
+    }
+  output->Initialize();
+  vtkPoints* points = this->Input ? this->Input->GetPoints() : 0;
+  double unitNormal[3] = {normal[0], normal[1], normal[2]};
+  if (!points || this->Input->GetNumberOfCells() == 0 ||
+      vtkMath::Normalize(unitNormal) == 0.)
+    {
+    output->Modified();
+    return true;
+    }
+  if (this->Input->GetMTime() != this->IndexTime)
+    {
+    this->Directions.clear();
+    this->UsedNormals.clear();
+    this->IndexTime = this->Input->GetMTime();
+    this->PointMap.assign(this->Input->GetNumberOfPoints(), -1);
+    }
+
+  Direction* direction = this->GetDirection(unitNormal);
+  if (!direction)
+    {
+    output->Modified();
+    return false;
+    }
+
+  // Cells of the slab at the distance of the plane, and long cells, that
+  // cross the plane
+  const double distance = vtkMath::Dot(unitNormal, origin);
+  std::vector<vtkIdType> cellIds;
+  double range[2];
+  if (distance >= direction->Minimum && distance <= direction->Maximum)
+    {
+    const vtkIdType numberOfSlabs =
+      static_cast<vtkIdType>(direction->SlabOffsets.size()) - 1;
+    vtkIdType slab = 0;
+    if (direction->SlabWidth > 0.)
+      {
+      slab = std::min(numberOfSlabs - 1, static_cast<vtkIdType>(
+        (distance - direction->Minimum) / direction->SlabWidth));
+      }
+    for (vtkIdType i = direction->SlabOffsets[slab];
+         i < direction->SlabOffsets[slab + 1]; ++i)
+      {
+      this->GetCellRange(direction->Cells[i], unitNormal, range);
+      if (range[0] <= distance && distance <= range[1])
+        {
+        cellIds.push_back(direction->Cells[i]);
+        }
+      }
+    for (size_t i = 0; i < direction->LongCells.size(); ++i)
+      {
+      this->GetCellRange(direction->LongCells[i], unitNormal, range);
+      if (range[0] <= distance && distance <= range[1])
+        {
+        cellIds.push_back(direction->LongCells[i]);
+        }
+      }
+    // same order as the input cells
+    std::sort(cellIds.begin(), cellIds.end());
+    }
+
+  // Copy the cells with their point and cell data
+  vtkNew<vtkPoints> outputPoints;
+  outputPoints->SetDataType(points->GetDataType());
+  output->SetPoints(outputPoints.GetPointer());
+  output->Allocate(static_cast<vtkIdType>(cellIds.size()) + 1);
+  vtkPointData* inputPointData = this->Input->GetPointData();
+  vtkCellData* inputCellData = this->Input->GetCellData();
+  vtkPointData* outputPointData = output->GetPointData();
+  vtkCellData* outputCellData = output->GetCellData();
+  outputPointData->CopyAllocate(inputPointData);
+  outputCellData->CopyAllocate(inputCellData, static_cast<vtkIdType>(cellIds.size()));
+  std::vector<vtkIdType> usedPoints;
+  for (int cellArray = 0; cellArray < 4; ++cellArray)
+    {
+    for (size_t c = 0; c < cellIds.size(); ++c)
+      {
+      const int cellType = this->Input->GetCellType(cellIds[c]);
+      if (GetCellArrayIndex(cellType) != cellArray)
+        {
+        continue;
+        }
+      vtkIdType npts = 0;
+      vtkIdType* pts = 0;
+      this->Input->GetCellPoints(cellIds[c], npts, pts);
+      this->CellPoints.resize(npts);
+      for (vtkIdType k = 0; k < npts; ++k)
+        {
+        vtkIdType& outputPointId = this->PointMap[pts[k]];
+        if (outputPointId < 0)
+          {
+          outputPointId = outputPoints->InsertNextPoint(points->GetPoint(pts[k]));
+          outputPointData->CopyData(inputPointData, pts[k], outputPointId);
+          usedPoints.push_back(pts[k]);
+          }
+        this->CellPoints[k] = outputPointId;
+        }
+      const vtkIdType outputCellId =
+        output->InsertNextCell(cellType, npts, npts ? &this->CellPoints[0] : 0);
+      outputCellData->CopyData(inputCellData, cellIds[c], outputCellId);
+      }
+    }
+  for (size_t p = 0; p < usedPoints.size(); ++p)
+    {
+    this->PointMap[usedPoints[p]] = -1;
+    }
+  output->Modified();
+  return true;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelSliceIntersectionIndex::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Input: " << this->Input << "\n";
+  os << indent << "Shared: " << this->Shared << "\n";
+  os << indent << "MaximumNumberOfDirections: " << this->MaximumNumberOfDirections << "\n";
+  os << indent << "MaximumNumberOfCellSlabs: " << this->MaximumNumberOfCellSlabs << "\n";
+  os << indent << "NumberOfDirections: " << this->GetNumberOfDirections() << "\n";
+}
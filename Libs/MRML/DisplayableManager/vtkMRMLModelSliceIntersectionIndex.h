@@ -0,0 +1,140 @@
+/*=========================================================================
+
+  Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+==========================================================================*/
+
+#ifndef __vtkMRMLModelSliceIntersectionIndex_h
+#define __vtkMRMLModelSliceIntersectionIndex_h
+
+// MRMLDisplayableManager includes
+#include "vtkMRMLDisplayableManagerWin32Header.h"
+
+// VTK includes
+#include <vtkObject.h>
+#include <vtkSmartPointer.h>
+class vtkPolyData;
+
+// STD includes
+#include <list>
+#include <vector>
+
+/// \brief Find the cells of a surface crossed by a slice plane.
+///
+/// For each slice normal, the cells are sorted into slabs orthogonal to the
+/// normal, each cell being in all the slabs its range of distances along
+/// the normal overlaps. The slab width is about the average range of a cell.
+/// A plane only visits the cells of the slab at its distance instead of all
+/// the cells of the surface. The cells overlapping more than
+/// MaximumNumberOfCellSlabs slabs are kept in a separate list visited by
+/// every plane, so that the index is at most that many times the number of
+/// cells.
+///
+/// The slabs of a normal are only computed the second time it is used, a
+/// normal used once (e.g. while rotating a slice) is not worth them: the
+/// caller cuts the whole surface instead. The slabs of the last used normals are kept and computed again when the
+/// surface is modified. The index of a surface is shared by all the slice
+/// views showing it, use GetSharedIndex() to get it.
+/// \sa vtkMRMLModelSliceDisplayableManager
+class VTK_MRML_DISPLAYABLEMANAGER_EXPORT vtkMRMLModelSliceIntersectionIndex
+  : public vtkObject
+{
+public:
+  static vtkMRMLModelSliceIntersectionIndex* New();
+  vtkTypeMacro(vtkMRMLModelSliceIntersectionIndex, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  ///
+  /// Return the index of the surface, created if no other view uses it.
+  //BTX
+  static vtkSmartPointer<vtkMRMLModelSliceIntersectionIndex> GetSharedIndex(
+    vtkPolyData* polyData);
+  //ETX
+
+  ///
+  /// Indexed surface.
+  vtkGetObjectMacro(Input, vtkPolyData);
+
+  ///
+  /// Maximum number of normals whose slabs are kept, 8 by default.
+  vtkSetMacro(MaximumNumberOfDirections, int);
+  vtkGetMacro(MaximumNumberOfDirections, int);
+  int GetNumberOfDirections()const;
+
+  ///
+  /// Maximum number of slabs a cell is copied into, the longer cells are
+  /// visited by every plane. Used by the slabs computed afterwards, 4 by
+  /// default.
+  vtkSetMacro(MaximumNumberOfCellSlabs, int);
+  vtkGetMacro(MaximumNumberOfCellSlabs, int);
+
+  ///
+  /// Copy into \a output the cells of the input crossed by the plane, with
+  /// their point and cell data. The input must be up to date.
+  /// Return false, with an empty output, the first time the normal is used:
+  /// the input should be cut directly.
+  bool ExtractCells(const double origin[3], const double normal[3],
+                    vtkPolyData* output);
+
+protected:
+  vtkMRMLModelSliceIntersectionIndex();
+  virtual ~vtkMRMLModelSliceIntersectionIndex();
+
+  void SetInput(vtkPolyData* input);
+
+  //BTX
+  struct Direction
+  {
+    double Normal[3];
+    double Minimum;
+    double Maximum;
+    double SlabWidth;
+    /// Cells of slab i are in Cells[SlabOffsets[i], SlabOffsets[i+1][
+    std::vector<vtkIdType> SlabOffsets;
+    std::vector<vtkIdType> Cells;
+    /// Cells overlapping more than MaximumNumberOfCellSlabs slabs
+    std::vector<vtkIdType> LongCells;
+    unsigned long LastUsed;
+  };
+  //ETX
+
+  ///
+  /// Return the slabs of the unit normal, computed if it was already used
+  /// once. Return 0 the first time the normal is used.
+  Direction* GetDirection(const double normal[3]);
+
+  ///
+  /// Compute the slabs of the unit normal into \a direction.
+  void BuildDirection(const double normal[3], Direction& direction);
+
+  ///
+  /// Range of distances of the points of a cell along the unit normal.
+  void GetCellRange(vtkIdType cellId, const double normal[3], double range[2]);
+
+  vtkPolyData* Input;
+  unsigned long IndexTime;
+  int MaximumNumberOfDirections;
+  int MaximumNumberOfCellSlabs;
+  bool Shared;
+
+  //BTX
+  std::list<Direction> Directions;
+  /// Normals used once since the last change of the input, 3 values each
+  std::vector<double> UsedNormals;
+  unsigned long UseCount;
+  /// Id of each input point in the output, -1 if not used
+  std::vector<vtkIdType> PointMap;
+  std::vector<vtkIdType> CellPoints;
+  //ETX
+
+private:
+  vtkMRMLModelSliceIntersectionIndex(const vtkMRMLModelSliceIntersectionIndex&); // Not implemented
+  void operator=(const vtkMRMLModelSliceIntersectionIndex&);                    // Not implemented
+};
+
+#endif
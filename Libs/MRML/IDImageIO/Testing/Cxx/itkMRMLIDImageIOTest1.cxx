@@ -0,0 +1,204 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLIDImageIO includes
+#include "itkMRMLIDImageIO.h"
+
+// ITK includes
+#include <itkImage.h>
+
+// MRML includes
+#include <vtkMRMLDiffusionTensorVolumeNode.h>
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+// STD includes
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// IO writing a 3D image of the given pixel into the node
+itk::MRMLIDImageIO::Pointer CreateIO(vtkMRMLScene* scene, vtkMRMLNode* node,
+                                     unsigned int numberOfComponents,
+                                     const unsigned int dimensions[3])
+{
+  char fileName[256];
+  sprintf(fileName, "slicer:%p#%s", scene, node->GetID());
+
+  itk::MRMLIDImageIO::Pointer io = itk::MRMLIDImageIO::New();
+  io->SetFileName(fileName);
+  io->SetNumberOfDimensions(3);
+  for (unsigned int i = 0; i < 3; ++i)
+    {
+    io->SetDimensions(i, dimensions[i]);
+    io->SetSpacing(i, 1.0 + i);
+    io->SetOrigin(i, 10.0 * i);
+    }
+  io->SetComponentType(itk::ImageIOBase::FLOAT);
+  io->SetNumberOfComponents(numberOfComponents);
+  return io;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int itkMRMLIDImageIOTest1(int , char * [] )
+{
+  vtkNew<vtkMRMLScene> scene;
+  const unsigned int dimensions[3] = {7, 5, 3};
+  const unsigned long numberOfPixels = 7 * 5 * 3;
+
+  // Scalar volume: write to the node, read it back
+  vtkNew<vtkMRMLScalarVolumeNode> scalarNode;
+  scene->AddNode(scalarNode.GetPointer());
+  itk::MRMLIDImageIO::Pointer io =
+    CreateIO(scene.GetPointer(), scalarNode.GetPointer(), 1, dimensions);
+  if (!io->CanWriteFile(io->GetFileName()))
+    {
+    std::cerr << "Line " << __LINE__ << " - Can't write into "
+              << io->GetFileName() << std::endl;
+    return EXIT_FAILURE;
+    }
+  io->SetPixelType(itk::ImageIOBase::SCALAR);
+  std::vector<float> scalars(numberOfPixels);
+  for (unsigned long i = 0; i < numberOfPixels; ++i)
+    {
+    scalars[i] = 0.5f * i - 20.f;
+    }
+  io->Write(&scalars[0]);
+
+  vtkImageData* image = scalarNode->GetImageData();
+  if (!image ||
+      image->GetScalarType() != VTK_FLOAT ||
+      image->GetNumberOfPoints() != static_cast<vtkIdType>(numberOfPixels))
+    {
+    std::cerr << "Line " << __LINE__ << " - Image not written" << std::endl;
+    return EXIT_FAILURE;
+    }
+  for (unsigned long i = 0; i < numberOfPixels; ++i)
+    {
+    if (image->GetPointData()->GetScalars()->GetComponent(i, 0) != scalars[i])
+      {
+      std::cerr << "Line " << __LINE__ << " - Wrong scalar " << i << ": "
+                << image->GetPointData()->GetScalars()->GetComponent(i, 0)
+                << " instead of " << scalars[i] << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  itk::MRMLIDImageIO::Pointer readIO = itk::MRMLIDImageIO::New();
+  readIO->SetFileName(io->GetFileName());
+  if (!readIO->CanReadFile(readIO->GetFileName()))
+    {
+    std::cerr << "Line " << __LINE__ << " - Can't read "
+              << readIO->GetFileName() << std::endl;
+    return EXIT_FAILURE;
+    }
+  readIO->ReadImageInformation();
+  if (readIO->GetImageSizeInPixels() != numberOfPixels ||
+      readIO->GetComponentType() != itk::ImageIOBase::FLOAT ||
+      readIO->GetNumberOfComponents() != 1)
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong image information" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::vector<float> readScalars(numberOfPixels);
+  readIO->Read(&readScalars[0]);
+  if (readScalars != scalars)
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong image read" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Zero-copy: the image imports the buffer of the node, reading and
+  // writing it back in place copies nothing
+  typedef itk::Image<float, 3> ImageType;
+  ImageType::Pointer importedImage = ImageType::New();
+  if (!readIO->ImportOwnBuffer(importedImage.GetPointer()) ||
+      importedImage->GetBufferPointer() != image->GetScalarPointer() ||
+      importedImage->GetLargestPossibleRegion().GetNumberOfPixels() != numberOfPixels ||
+      importedImage->GetSpacing()[2] != 3.0 ||
+      importedImage->GetOrigin()[1] != 10.0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Node buffer not imported" << std::endl;
+    return EXIT_FAILURE;
+    }
+  readIO->Read(importedImage->GetBufferPointer());
+  importedImage->GetBufferPointer()[0] = 1000.f;
+  io->Write(importedImage->GetBufferPointer());
+  if (scalarNode->GetImageData()->GetScalarPointer() !=
+      importedImage->GetBufferPointer() ||
+      scalarNode->GetImageData()->GetPointData()->GetScalars()->GetComponent(0, 0) != 1000.)
+    {
+    std::cerr << "Line " << __LINE__ << " - Imported buffer not written in place"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  // Another pixel type can't import the buffer
+  itk::Image<short, 3>::Pointer shortImage = itk::Image<short, 3>::New();
+  if (readIO->ImportOwnBuffer(shortImage.GetPointer()))
+    {
+    std::cerr << "Line " << __LINE__ << " - Buffer imported as short" << std::endl;
+    return EXIT_FAILURE;
+    }
+  importedImage = 0;
+
+  // Tensor volume: the 6 components of the symmetric tensors written are
+  // expanded into the 9 components of the VTK tensors
+  vtkNew<vtkMRMLDiffusionTensorVolumeNode> tensorNode;
+  scene->AddNode(tensorNode.GetPointer());
+  io = CreateIO(scene.GetPointer(), tensorNode.GetPointer(), 6, dimensions);
+  io->SetPixelType(itk::ImageIOBase::DIFFUSIONTENSOR3D);
+  std::vector<float> symmetricTensors(6 * numberOfPixels);
+  for (unsigned long i = 0; i < 6 * numberOfPixels; ++i)
+    {
+    symmetricTensors[i] = 0.25f * i;
+    }
+  io->Write(&symmetricTensors[0]);
+
+  vtkDataArray* tensors = tensorNode->GetImageData() ?
+    tensorNode->GetImageData()->GetPointData()->GetTensors() : 0;
+  if (!tensors ||
+      tensors->GetNumberOfComponents() != 9 ||
+      tensors->GetNumberOfTuples() != static_cast<vtkIdType>(numberOfPixels))
+    {
+    std::cerr << "Line " << __LINE__ << " - Tensors not written" << std::endl;
+    return EXIT_FAILURE;
+    }
+  // xx, xy, xz, yy, yz, zz
+  const int symmetricComponent[9] = {0, 1, 2, 1, 3, 4, 2, 4, 5};
+  for (unsigned long i = 0; i < numberOfPixels; ++i)
+    {
+    for (int c = 0; c < 9; ++c)
+      {
+      const float expected = symmetricTensors[6 * i + symmetricComponent[c]];
+      if (tensors->GetComponent(i, c) != expected)
+        {
+        std::cerr << "Line " << __LINE__ << " - Wrong tensor " << i
+                  << " component " << c << ": " << tensors->GetComponent(i, c)
+                  << " instead of " << expected << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -360,19 +360,22 @@ MRMLIDImageIO
   node = this->FileNameToVolumeNodePtr( m_FileName.c_str() );
   if (node)
     {
-    // buffer is preallocated, memcpy the data
+    const void *nodeBuffer = 0;
     if (vtkMRMLDiffusionImageVolumeNode::SafeDownCast(node) == 0)
       {
       // Scalar, Diffusion Weighted, or Vector image
-      memcpy(buffer, node->GetImageData()->GetScalarPointer(),
-             this->GetImageSizeInBytes());
+      nodeBuffer = node->GetImageData()->GetScalarPointer();
       }
     else
       {
       // Tensor image
-      memcpy(buffer,
-             node->GetImageData()->GetPointData()->GetTensors()->GetVoidPointer(0),
-             this->GetImageSizeInBytes());
+      nodeBuffer = node->GetImageData()->GetPointData()->GetTensors()->GetVoidPointer(0);
+      }
+    // Nothing to copy if the buffer was imported (see ImportOwnBuffer())
+    if (buffer != nodeBuffer)
+      {
+      // buffer is preallocated, memcpy the data
+      memcpy(buffer, nodeBuffer, this->GetImageSizeInBytes());
       }
     }
 }
@@ -404,23 +407,19 @@ MRMLIDImageIO
   vtkMRMLVolumeNode *node;
 
   node = this->FileNameToVolumeNodePtr( m_FileName.c_str() );
-  if (node)
+  if (node && node->GetImageData())
     {
-    // buffer is preallocated, memcpy the data
     if (vtkMRMLDiffusionImageVolumeNode::SafeDownCast(node) == 0)
       {
       // Scalar, Diffusion Weighted, or Vector image
       return node->GetImageData()->GetScalarPointer();
       }
-    else
+    else if (node->GetImageData()->GetPointData()->GetTensors())
       {
       return node->GetImageData()->GetPointData()->GetTensors()->GetVoidPointer(0);
       }
     }
-
-  throw( "MRML Node does not contain image data." );
-
-  return static_cast< void * >( 0 );
+  return 0;
 }
 
 //----------------------------------------------------------------------------
@@ -616,6 +615,29 @@ MRMLIDImageIO
   rasToIjk->Delete();
 }
 
+//----------------------------------------------------------------------------
+// Tensors coming from ITK have 6 components (xx, xy, xz, yy, yz, zz),
+// VTK tensors have 9.
+template <class T>
+void MRMLIDImageIOExpandTensors(const T *symmetricTensors, T *tensors,
+                                unsigned long numberOfTensors)
+{
+  for (unsigned long i = 0; i < numberOfTensors; ++i)
+    {
+    tensors[0] = symmetricTensors[0];
+    tensors[1] = symmetricTensors[1];
+    tensors[2] = symmetricTensors[2];
+    tensors[3] = symmetricTensors[1];
+    tensors[4] = symmetricTensors[3];
+    tensors[5] = symmetricTensors[4];
+    tensors[6] = symmetricTensors[2];
+    tensors[7] = symmetricTensors[4];
+    tensors[8] = symmetricTensors[5];
+    tensors += 9;
+    symmetricTensors += 6;
+    }
+}
+
 //----------------------------------------------------------------------------
 // Write to the MRML scene
 void
@@ -676,11 +698,17 @@ MRMLIDImageIO
       img->AllocateScalars(scalarType, numberOfScalarComponents);
 #endif
 
-      memcpy(img->GetScalarPointer(), buffer,
-             img->GetPointData()->GetScalars()->GetNumberOfComponents() *
-             img->GetPointData()->GetScalars()->GetNumberOfTuples() *
-             img->GetPointData()->GetScalars()->GetDataTypeSize()
-        );
+      // AllocateScalars() keeps the scalars of the node if they already
+      // have the right type and size. If the image written imported them
+      // (see ImportOwnBuffer()), it was processed in place: nothing to copy.
+      if (img->GetScalarPointer() != buffer)
+        {
+        memcpy(img->GetScalarPointer(), buffer,
+               img->GetPointData()->GetScalars()->GetNumberOfComponents() *
+               img->GetPointData()->GetScalars()->GetNumberOfTuples() *
+               img->GetPointData()->GetScalars()->GetDataTypeSize()
+          );
+        }
       }
     else
       {
@@ -692,23 +720,16 @@ MRMLIDImageIO
 
       // Tensors comming from ITK will be 6 components.  Need to
       // convert to 9 components for VTK
-      void *mptr = img->GetPointData()->GetTensors()->GetVoidPointer(0);
-      const void *bptr = buffer;
-
-      short csize =img->GetPointData()->GetTensors()->GetDataTypeSize();
-      for (unsigned long i=0; i < imagesizeinpixels; ++i)
+      vtkDataArray *tensors = img->GetPointData()->GetTensors();
+      switch (tensors->GetDataType())
         {
-        memcpy((char*)mptr, (char*)bptr, csize);
-        memcpy((char*)mptr+csize, (char*)bptr+csize, csize);
-        memcpy((char*)mptr+2*csize, (char*)bptr+2*csize, csize);
-        memcpy((char*)mptr+3*csize, (char*)bptr+1*csize, csize);
-        memcpy((char*)mptr+4*csize, (char*)bptr+3*csize, csize);
-        memcpy((char*)mptr+5*csize, (char*)bptr+4*csize, csize);
-        memcpy((char*)mptr+6*csize, (char*)bptr+2*csize, csize);
-        memcpy((char*)mptr+7*csize, (char*)bptr+4*csize, csize);
-        memcpy((char*)mptr+8*csize, (char*)bptr+5*csize, csize);
-        mptr = (char*)mptr + 9*csize;
-        bptr = (char*)bptr + 6*csize;
+        vtkTemplateMacro(MRMLIDImageIOExpandTensors(
+          static_cast<const VTK_TT*>(buffer),
+          static_cast<VTK_TT*>(tensors->GetVoidPointer(0)),
+          imagesizeinpixels));
+        default:
+          itkWarningMacro("Unknown tensor type.");
+          break;
         }
       }
 
@@ -24,6 +24,10 @@
 #include "itkMRMLIDIOWin32Header.h"
 
 #include "itkImageIOBase.h"
+#include "itkNumericTraits.h"
+
+// STD includes
+#include <typeinfo>
 
 class vtkMRMLVolumeNode;
 class vtkMRMLDiffusionWeightedVolumeNode;
@@ -77,6 +81,51 @@ public:
   virtual void ReadUsingOwnBuffer();
   virtual void * GetOwnBuffer();
 
+  /** Make the image use the buffer of the node instead of a copy of it.
+   * ReadImageInformation() must have been called. The node keeps owning
+   * the buffer, the image is valid as long as the node image data is.
+   * Return false if the pixel type does not match or for tensors, whose 9
+   * VTK components are not the 6 ITK ones: the image must be read. */
+  template <class TImage>
+  bool ImportOwnBuffer(TImage* image)
+  {
+    typedef typename TImage::InternalPixelType InternalPixelType;
+    typedef typename NumericTraits<InternalPixelType>::ValueType ComponentType;
+    void* ownBuffer = this->GetOwnBuffer();
+    if (!image || !ownBuffer ||
+        this->GetPixelType() == DIFFUSIONTENSOR3D ||
+        this->GetComponentTypeInfo() != typeid(ComponentType) ||
+        this->GetNumberOfDimensions() > TImage::ImageDimension ||
+        this->GetImageSizeInBytes() % sizeof(InternalPixelType) != 0)
+      {
+      return false;
+      }
+    typename TImage::RegionType region;
+    typename TImage::SpacingType spacing;
+    typename TImage::PointType origin;
+    typename TImage::DirectionType direction;
+    direction.SetIdentity();
+    for (unsigned int i = 0; i < TImage::ImageDimension; ++i)
+      {
+      const bool inFile = i < this->GetNumberOfDimensions();
+      region.SetSize(i, inFile ? this->GetDimensions(i) : 1);
+      spacing[i] = inFile ? this->GetSpacing(i) : 1.0;
+      origin[i] = inFile ? this->GetOrigin(i) : 0.0;
+      for (unsigned int j = 0; inFile && j < this->GetNumberOfDimensions(); ++j)
+        {
+        direction[j][i] = this->GetDirection(i)[j];
+        }
+      }
+    image->SetRegions(region);
+    image->SetSpacing(spacing);
+    image->SetOrigin(origin);
+    image->SetDirection(direction);
+    image->GetPixelContainer()->SetImportPointer(
+      static_cast<InternalPixelType*>(ownBuffer),
+      this->GetImageSizeInBytes() / sizeof(InternalPixelType), false);
+    return true;
+  }
+
   /** Set the spacing and dimension information for the set filename. */
   virtual void ReadImageInformation();
 
@@ -0,0 +1,178 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLLogic includes
+#include "vtkImageLabelOutline.h"
+
+// VTK includes
+#include <vtkImageCast.h>
+#include <vtkImageData.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkVersion.h>
+
+// STD includes
+#include <iostream>
+#include <string>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Blocks of labels 0 to 3 with a few isolated pixels, so that there are
+// transitions in every direction, on the image border and between two labels.
+void FillLabels(vtkImageData* labels, int dimensions[3])
+{
+  labels->SetDimensions(dimensions);
+#if (VTK_MAJOR_VERSION <= 5)
+  labels->SetScalarTypeToInt();
+  labels->SetNumberOfScalarComponents(1);
+  labels->AllocateScalars();
+#else
+  labels->AllocateScalars(VTK_INT, 1);
+#endif
+  vtkMath::RandomSeed(7);
+  for (int k = 0; k < dimensions[2]; ++k)
+    {
+    for (int j = 0; j < dimensions[1]; ++j)
+      {
+      for (int i = 0; i < dimensions[0]; ++i)
+        {
+        int label = ((i / 5) + (j / 3) + k) % 4;
+        if (vtkMath::Random() < 0.05)
+          {
+          label = static_cast<int>(vtkMath::Random(0., 4.)) % 4;
+          }
+        labels->SetScalarComponentFromDouble(i, j, k, 0, label);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Outline of the labels cast to scalarType, returned as int.
+void ComputeOutline(vtkImageData* labels, int scalarType, int numberOfThreads,
+                    vtkImageData* outline)
+{
+  vtkNew<vtkImageCast> cast;
+#if (VTK_MAJOR_VERSION <= 5)
+  cast->SetInput(labels);
+#else
+  cast->SetInputData(labels);
+#endif
+  cast->SetOutputScalarType(scalarType);
+
+  vtkNew<vtkImageLabelOutline> outlineFilter;
+  outlineFilter->SetInputConnection(cast->GetOutputPort());
+  outlineFilter->SetOutline(1);
+  outlineFilter->SetBackground(0);
+  outlineFilter->SetNumberOfThreads(numberOfThreads);
+
+  vtkNew<vtkImageCast> castBack;
+  castBack->SetInputConnection(outlineFilter->GetOutputPort());
+  castBack->SetOutputScalarType(VTK_INT);
+  castBack->Update();
+  outline->DeepCopy(castBack->GetOutput());
+}
+
+//----------------------------------------------------------------------------
+bool CompareOutlines(vtkImageData* outline, vtkImageData* expectedOutline,
+                     const char* description)
+{
+  int dimensions[3];
+  expectedOutline->GetDimensions(dimensions);
+  for (int k = 0; k < dimensions[2]; ++k)
+    {
+    for (int j = 0; j < dimensions[1]; ++j)
+      {
+      for (int i = 0; i < dimensions[0]; ++i)
+        {
+        const int value = static_cast<int>(
+          outline->GetScalarComponentAsDouble(i, j, k, 0));
+        const int expectedValue = static_cast<int>(
+          expectedOutline->GetScalarComponentAsDouble(i, j, k, 0));
+        if (value != expectedValue)
+          {
+          std::cerr << "Line " << __LINE__ << " - " << description
+                    << ": outline differs at (" << i << ", " << j << ", " << k
+                    << "): " << value << " instead of " << expectedValue
+                    << std::endl;
+          return false;
+          }
+        }
+      }
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkImageLabelOutlineTest1(int vtkNotUsed(argc), char * vtkNotUsed(argv)[] )
+{
+  int dimensions[3] = {37, 23, 4};
+  vtkNew<vtkImageData> labels;
+  FillLabels(labels.GetPointer(), dimensions);
+
+  // int labelmaps are outlined by the generic kernel
+  vtkNew<vtkImageData> expectedOutline;
+  ComputeOutline(labels.GetPointer(), VTK_INT, 1, expectedOutline.GetPointer());
+
+  // unsigned char, short and unsigned short labelmaps by the fast
+  // 8-neighbor kernel, on the whole image or on the extent of each thread
+  const int scalarTypes[3] = {VTK_UNSIGNED_CHAR, VTK_SHORT, VTK_UNSIGNED_SHORT};
+  const int numberOfThreads[2] = {1, 3};
+  for (int t = 0; t < 3; ++t)
+    {
+    for (int n = 0; n < 2; ++n)
+      {
+      vtkNew<vtkImageData> outline;
+      ComputeOutline(labels.GetPointer(), scalarTypes[t], numberOfThreads[n],
+                     outline.GetPointer());
+      std::string description = vtkImageScalarTypeNameMacro(scalarTypes[t]);
+      description += numberOfThreads[n] > 1 ? " (threaded)" : "";
+      if (!CompareOutlines(outline.GetPointer(), expectedOutline.GetPointer(),
+                           description.c_str()))
+        {
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // Image of a single row and a single column
+  int rowDimensions[3] = {11, 1, 1};
+  int columnDimensions[3] = {1, 11, 1};
+  int* lineDimensions[2] = {rowDimensions, columnDimensions};
+  for (int d = 0; d < 2; ++d)
+    {
+    vtkNew<vtkImageData> lineLabels;
+    FillLabels(lineLabels.GetPointer(), lineDimensions[d]);
+    vtkNew<vtkImageData> expectedLineOutline;
+    ComputeOutline(lineLabels.GetPointer(), VTK_INT, 1,
+                   expectedLineOutline.GetPointer());
+    vtkNew<vtkImageData> lineOutline;
+    ComputeOutline(lineLabels.GetPointer(), VTK_UNSIGNED_CHAR, 1,
+                   lineOutline.GetPointer());
+    if (!CompareOutlines(lineOutline.GetPointer(), expectedLineOutline.GetPointer(),
+                         d == 0 ? "row" : "column"))
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
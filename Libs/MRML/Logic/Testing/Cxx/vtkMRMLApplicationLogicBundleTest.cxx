@@ -0,0 +1,374 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLLogic includes
+#include "vtkArchive.h"
+#include "vtkMRMLApplicationLogic.h"
+
+// MRML includes
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkTimerLog.h>
+#include <vtkVersion.h>
+
+// VTKSYS includes
+#include <vtksys/Glob.hxx>
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+unsigned long DirectorySize(const std::string& directory)
+{
+  vtksys::Glob glob;
+  glob.RecurseOn();
+  glob.FindFiles(directory + "/*");
+  std::vector<std::string> files = glob.GetFiles();
+  unsigned long size = 0;
+  for (std::vector<std::string>::const_iterator it = files.begin(); it != files.end(); ++it)
+    {
+    size += vtksys::SystemTools::FileLength(it->c_str());
+    }
+  return size;
+}
+
+//-----------------------------------------------------------------------------
+std::string FileContent(int index)
+{
+  // 1MB of not too compressible data
+  std::string content(1 << 20, '\0');
+  unsigned int value = 12345 + index;
+  for (size_t i = 0; i < content.size(); ++i)
+    {
+    value = value * 1103515245 + 12345;
+    content[i] = static_cast<char>(value >> 16);
+    }
+  return content;
+}
+
+//-----------------------------------------------------------------------------
+bool WriteFile(const std::string& fileName, const std::string& content)
+{
+  std::ofstream file(fileName.c_str(), std::ios::out | std::ios::binary);
+  file.write(content.c_str(), content.size());
+  return file.good();
+}
+
+//-----------------------------------------------------------------------------
+struct ExtractionState
+{
+  std::string Directory;
+  unsigned long PeakSize;
+  int ExtractedFiles;
+  bool Success;
+};
+
+//-----------------------------------------------------------------------------
+void ConsumeMember(const char* memberPath, void* clientData)
+{
+  ExtractionState* state = reinterpret_cast<ExtractionState*>(clientData);
+  state->PeakSize = std::max(state->PeakSize, DirectorySize(state->Directory));
+  std::string fileName = state->Directory + "/" + memberPath;
+  std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+  std::stringstream content;
+  content << file.rdbuf();
+  file.close();
+  int index = atoi(vtksys::SystemTools::GetFilenameWithoutExtension(memberPath).c_str());
+  if (content.str() != FileContent(index))
+    {
+    std::cerr << "Line " << __LINE__ << " - Bad content for " << memberPath << std::endl;
+    state->Success = false;
+    }
+  vtksys::SystemTools::RemoveFile(fileName.c_str());
+  ++state->ExtractedFiles;
+}
+
+//-----------------------------------------------------------------------------
+int TestArchiveStreaming(const std::string& tempDir)
+{
+  const int numberOfFiles = 8;
+  const unsigned long fileSize = 1 << 20;
+  vtkNew<vtkTimerLog> timer;
+
+  // zip a directory containing all the files
+  std::string fullDir = tempDir + "/Full";
+  vtksys::SystemTools::MakeDirectory((fullDir + "/Bundle/Data").c_str());
+  timer->StartTimer();
+  for (int i = 0; i < numberOfFiles; ++i)
+    {
+    std::stringstream fileName;
+    fileName << fullDir << "/Bundle/Data/" << i << ".dat";
+    WriteFile(fileName.str(), FileContent(i));
+    }
+  unsigned long fullSavePeak = DirectorySize(fullDir);
+  std::string fullZip = tempDir + "/Full.zip";
+  if (!zip(fullZip.c_str(), (fullDir + "/Bundle").c_str()))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to zip " << fullDir << std::endl;
+    return EXIT_FAILURE;
+    }
+  timer->StopTimer();
+  double fullSaveTime = timer->GetElapsedTime();
+  vtksys::SystemTools::RemoveADirectory(fullDir.c_str());
+
+  // add the files one at a time
+  std::string streamDir = tempDir + "/Stream";
+  vtksys::SystemTools::MakeDirectory((streamDir + "/Bundle/Data").c_str());
+  std::string streamZip = tempDir + "/Stream.zip";
+  unsigned long streamSavePeak = 0;
+  timer->StartTimer();
+  vtkArchiveZipWriter writer;
+  if (!writer.Open(streamZip.c_str()) || !writer.AddDirectory("Bundle"))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to create " << streamZip << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::vector<std::string> members;
+  for (int i = 0; i < numberOfFiles; ++i)
+    {
+    std::stringstream memberPath;
+    memberPath << "Bundle/Data/" << i << ".dat";
+    std::string fileName = streamDir + "/" + memberPath.str();
+    WriteFile(fileName, FileContent(i));
+    streamSavePeak = std::max(streamSavePeak, DirectorySize(streamDir));
+    if (!writer.AddFile(fileName.c_str(), memberPath.str().c_str()))
+      {
+      std::cerr << "Line " << __LINE__ << " - Failed to add " << fileName << std::endl;
+      return EXIT_FAILURE;
+      }
+    vtksys::SystemTools::RemoveFile(fileName.c_str());
+    members.push_back(memberPath.str());
+    }
+  if (!writer.Close())
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to close " << streamZip << std::endl;
+    return EXIT_FAILURE;
+    }
+  timer->StopTimer();
+  double streamSaveTime = timer->GetElapsedTime();
+
+  std::vector<std::string> listedMembers;
+  if (!list_archive(streamZip.c_str(), listedMembers) ||
+      listedMembers.size() != members.size() + 1)
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with the members of " << streamZip << "\n"
+              << "\tcount:" << listedMembers.size() << "\n"
+              << "\texpected:" << members.size() + 1 << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // unzip everything
+  std::string fullExtractDir = tempDir + "/FullExtract";
+  vtksys::SystemTools::MakeDirectory(fullExtractDir.c_str());
+  timer->StartTimer();
+  if (!unzip(streamZip.c_str(), fullExtractDir.c_str()))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to unzip " << streamZip << std::endl;
+    return EXIT_FAILURE;
+    }
+  unsigned long fullLoadPeak = DirectorySize(fullExtractDir);
+  timer->StopTimer();
+  double fullLoadTime = timer->GetElapsedTime();
+  vtksys::SystemTools::RemoveADirectory(fullExtractDir.c_str());
+
+  // extract and consume the members one at a time
+  ExtractionState state;
+  state.Directory = tempDir + "/StreamExtract";
+  state.PeakSize = 0;
+  state.ExtractedFiles = 0;
+  state.Success = true;
+  vtksys::SystemTools::MakeDirectory(state.Directory.c_str());
+  timer->StartTimer();
+  if (!unzip_members(fullZip.c_str(), state.Directory.c_str(), members,
+                     ConsumeMember, &state) ||
+      !state.Success || state.ExtractedFiles != numberOfFiles)
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with unzip_members\n"
+              << "\textracted:" << state.ExtractedFiles << "\n"
+              << "\texpected:" << numberOfFiles << std::endl;
+    return EXIT_FAILURE;
+    }
+  timer->StopTimer();
+  double streamLoadTime = timer->GetElapsedTime();
+  vtksys::SystemTools::RemoveADirectory(state.Directory.c_str());
+
+  std::cout << "Archive of " << numberOfFiles << " x " << fileSize << " bytes\n"
+            << "  save: full " << fullSavePeak << " bytes peak, " << fullSaveTime << "s"
+            << " - streaming " << streamSavePeak << " bytes peak, " << streamSaveTime << "s\n"
+            << "  load: full " << fullLoadPeak << " bytes peak, " << fullLoadTime << "s"
+            << " - streaming " << state.PeakSize << " bytes peak, " << streamLoadTime << "s"
+            << std::endl;
+
+  if (streamSavePeak != fileSize || fullSavePeak != numberOfFiles * fileSize ||
+      state.PeakSize != fileSize || fullLoadPeak != numberOfFiles * fileSize)
+    {
+    std::cerr << "Line " << __LINE__ << " - Streaming peak disk usage is not the size of one file" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int TestSceneBundle(const std::string& tempDir)
+{
+  const int numberOfVolumes = 3;
+  const int dimension = 64;
+  vtkNew<vtkTimerLog> timer;
+
+  vtkNew<vtkMRMLScene> scene;
+  for (int i = 0; i < numberOfVolumes; ++i)
+    {
+    vtkNew<vtkImageData> imageData;
+    imageData->SetDimensions(dimension, dimension, dimension);
+#if (VTK_MAJOR_VERSION <= 5)
+    imageData->SetScalarTypeToShort();
+    imageData->SetNumberOfScalarComponents(1);
+    imageData->AllocateScalars();
+#else
+    imageData->AllocateScalars(VTK_SHORT, 1);
+#endif
+    short* scalars = static_cast<short*>(imageData->GetScalarPointer());
+    for (int v = 0; v < dimension * dimension * dimension; ++v)
+      {
+      scalars[v] = static_cast<short>((v * (i + 1)) % 1024);
+      }
+    vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+    std::stringstream name;
+    name << "Volume" << i;
+    volumeNode->SetName(name.str().c_str());
+    volumeNode->SetAndObserveImageData(imageData.GetPointer());
+    scene->AddNode(volumeNode.GetPointer());
+    }
+
+  vtkNew<vtkMRMLApplicationLogic> appLogic;
+  appLogic->SetMRMLScene(scene.GetPointer());
+
+  std::string sdbDir = tempDir + "/Stage/SceneBundle";
+  vtksys::SystemTools::MakeDirectory(sdbDir.c_str());
+  std::string sdbFile = tempDir + "/SceneBundle.mrb";
+  timer->StartTimer();
+  if (!appLogic->SaveSceneToSlicerDataBundle(sdbFile.c_str(), sdbDir.c_str()))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to save " << sdbFile << std::endl;
+    return EXIT_FAILURE;
+    }
+  timer->StopTimer();
+  double saveTime = timer->GetElapsedTime();
+  // only the emptied files are left in the staging directory
+  if (DirectorySize(sdbDir) != 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Data left in " << sdbDir << "\n"
+              << "\tsize:" << DirectorySize(sdbDir) << std::endl;
+    return EXIT_FAILURE;
+    }
+  vtksys::SystemTools::RemoveADirectory((tempDir + "/Stage").c_str());
+
+  vtkNew<vtkMRMLScene> loadedScene;
+  vtkNew<vtkMRMLApplicationLogic> loadedAppLogic;
+  loadedAppLogic->SetMRMLScene(loadedScene.GetPointer());
+  std::string extractDir = tempDir + "/Extract";
+  vtksys::SystemTools::MakeDirectory(extractDir.c_str());
+  timer->StartTimer();
+  if (!loadedAppLogic->LoadSlicerDataBundle(sdbFile.c_str(), extractDir.c_str()))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to load " << sdbFile << std::endl;
+    return EXIT_FAILURE;
+    }
+  timer->StopTimer();
+  double loadTime = timer->GetElapsedTime();
+  // the data files are removed once read
+  if (DirectorySize(extractDir) != 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Data left in " << extractDir << "\n"
+              << "\tsize:" << DirectorySize(extractDir) << std::endl;
+    return EXIT_FAILURE;
+    }
+  vtksys::SystemTools::RemoveADirectory(extractDir.c_str());
+
+  std::vector<vtkMRMLNode*> volumeNodes;
+  loadedScene->GetNodesByClass("vtkMRMLScalarVolumeNode", volumeNodes);
+  if (volumeNodes.size() != static_cast<size_t>(numberOfVolumes))
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with the loaded volumes\n"
+              << "\tcount:" << volumeNodes.size() << "\n"
+              << "\texpected:" << numberOfVolumes << std::endl;
+    return EXIT_FAILURE;
+    }
+  for (size_t i = 0; i < volumeNodes.size(); ++i)
+    {
+    vtkImageData* imageData =
+      vtkMRMLScalarVolumeNode::SafeDownCast(volumeNodes[i])->GetImageData();
+    int dims[3] = {0, 0, 0};
+    if (imageData)
+      {
+      imageData->GetDimensions(dims);
+      }
+    if (dims[0] != dimension || dims[1] != dimension || dims[2] != dimension)
+      {
+      std::cerr << "Line " << __LINE__ << " - Volume " << volumeNodes[i]->GetName()
+                << " was not read from the bundle" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  std::cout << "Scene bundle of " << numberOfVolumes << " volumes ("
+            << vtksys::SystemTools::FileLength(sdbFile.c_str()) << " bytes)\n"
+            << "  save: " << saveTime << "s - load: " << loadTime << "s" << std::endl;
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int vtkMRMLApplicationLogicBundleTest(int argc, char * argv[])
+{
+  if (argc != 2)
+    {
+    std::cerr << "Line " << __LINE__ << " - Missing parameters !\n"
+              << "Usage: " << argv[0] << " /path/to/temp" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::string tempDir = std::string(argv[1]) + "/vtkMRMLApplicationLogicBundleTest";
+  vtksys::SystemTools::RemoveADirectory(tempDir.c_str());
+  vtksys::SystemTools::MakeDirectory(tempDir.c_str());
+
+  if (TestArchiveStreaming(tempDir) != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+  if (TestSceneBundle(tempDir) != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+
+  vtksys::SystemTools::RemoveADirectory(tempDir.c_str());
+  return EXIT_SUCCESS;
+}
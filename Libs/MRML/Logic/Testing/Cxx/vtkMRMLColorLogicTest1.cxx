@@ -32,9 +32,13 @@
 #include <vtkColorTransferFunction.h>
 #include <vtkLookupTable.h>
 #include <vtkNew.h>
+#include <vtkObjectFactory.h>
 #include <vtkTimerLog.h>
 
 // STD includes
+#include <cmath>
+#include <string>
+#include <vector>
 
 #include "vtkMRMLCoreTestingMacros.h"
 
@@ -46,17 +50,26 @@ bool TestNodeIDs();
 bool TestDefaults();
 bool TestCopy();
 bool TestProceduralCopy();
+bool TestDeferredFileNodes(const std::string& colorFileName);
 }
 
 //----------------------------------------------------------------------------
-int vtkMRMLColorLogicTest1(int vtkNotUsed(argc), char * vtkNotUsed(argv)[] )
+int vtkMRMLColorLogicTest1(int argc, char * argv[] )
 {
+  if (argc < 2)
+    {
+    std::cerr << "Missing parameters !\n"
+              << "Usage: " << argv[0] << " /path/to/ColorTest.ctbl"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
   bool res = true;
   res = TestPerformance() && res;
   res = TestNodeIDs() && res;
   res = TestDefaults() && res;
   res = TestCopy() && res;
   res = TestProceduralCopy() && res;
+  res = TestDeferredFileNodes(argv[1]) && res;
   return res ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 namespace
@@ -351,4 +364,116 @@ bool TestProceduralCopy()
   return true;
 }
 
+//----------------------------------------------------------------------------
+// Color logic with test files as default color files
+class vtkMRMLColorLogicWithTestFiles : public vtkMRMLColorLogic
+{
+public:
+  static vtkMRMLColorLogicWithTestFiles *New();
+  vtkTypeMacro(vtkMRMLColorLogicWithTestFiles, vtkMRMLColorLogic);
+
+  std::vector<std::string> TestColorFiles;
+
+protected:
+  vtkMRMLColorLogicWithTestFiles() {}
+  virtual std::vector<std::string> FindDefaultColorFiles()
+  {
+    return this->TestColorFiles;
+  }
+};
+vtkStandardNewMacro(vtkMRMLColorLogicWithTestFiles);
+
+//----------------------------------------------------------------------------
+bool TestDeferredColors(vtkMRMLColorTableNode* node)
+{
+  // 0 zero 0 0 0 255
+  // 1 one 255 59 21 255
+  // 2 two 41 84 255 255
+  double color[4] = {0., 0., 0., 0.};
+  if (node->GetNumberOfColors() != 3 ||
+      !node->GetColor(1, color) ||
+      fabs(color[0] - 1.) > 1e-6 ||
+      fabs(color[1] - 59. / 255.) > 1e-6 ||
+      fabs(color[2] - 21. / 255.) > 1e-6 ||
+      !node->GetColorName(2) ||
+      strcmp(node->GetColorName(2), "two") != 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong colors for "
+              << (node->GetID() ? node->GetID() : "copied node") << ": "
+              << node->GetNumberOfColors() << " colors" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool TestDeferredFileNodes(const std::string& colorFileName)
+{
+  const std::string invalidColorFileName = colorFileName + ".missing";
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLColorLogicWithTestFiles> colorLogic;
+  colorLogic->TestColorFiles.push_back(colorFileName);
+  colorLogic->TestColorFiles.push_back(invalidColorFileName);
+  colorLogic->SetMRMLScene(scene.GetPointer());
+
+  // Invalid files are not added, even to the first scene
+  if (scene->GetNodeByID(
+        vtkMRMLColorLogic::GetFileColorNodeID(invalidColorFileName.c_str())) != 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Node added for an invalid file"
+              << std::endl;
+    return false;
+    }
+
+  // Valid files are added as placeholders, loaded when first accessed
+  vtkMRMLColorTableNode* node = vtkMRMLColorTableNode::SafeDownCast(
+    scene->GetNodeByID(vtkMRMLColorLogic::GetFileColorNodeID(colorFileName.c_str())));
+  if (!node || !node->GetLookupTableDeferred() ||
+      node->GetType() != vtkMRMLColorTableNode::File)
+    {
+    std::cerr << "Line " << __LINE__ << " - No placeholder node for "
+              << colorFileName << std::endl;
+    return false;
+    }
+
+  // A copy of a placeholder loads the colors by itself
+  vtkNew<vtkMRMLColorTableNode> copiedNode;
+  copiedNode->Copy(node);
+  if (!copiedNode->GetLookupTableDeferred() || !node->GetLookupTableDeferred())
+    {
+    std::cerr << "Line " << __LINE__ << " - Copy loaded the colors" << std::endl;
+    return false;
+    }
+  if (!TestDeferredColors(copiedNode.GetPointer()))
+    {
+    return false;
+    }
+
+  // Loading the colors doesn't modify the node, even later
+  unsigned long mtime = node->GetMTime();
+  int wasModifying = node->StartModify();
+  if (!TestDeferredColors(node))
+    {
+    return false;
+    }
+  if (node->GetLookupTableDeferred() ||
+      node->GetModifiedEventPending() != 0 ||
+      node->GetMTime() != mtime)
+    {
+    std::cerr << "Line " << __LINE__ << " - Loading the colors modified the node: "
+              << node->GetModifiedEventPending() << " pending events" << std::endl;
+    return false;
+    }
+  node->EndModify(wasModifying);
+
+  // The colors of the node are not shared with the copy
+  if (node->GetLookupTable() == copiedNode->GetLookupTable())
+    {
+    std::cerr << "Line " << __LINE__ << " - Copy shares the table" << std::endl;
+    return false;
+    }
+  return true;
+}
+
 }
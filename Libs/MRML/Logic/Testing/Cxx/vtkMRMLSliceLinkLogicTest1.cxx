@@ -0,0 +1,122 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLLogic includes
+#include "vtkMRMLSliceLinkLogic.h"
+
+// MRML includes
+#include <vtkMRMLScene.h>
+#include <vtkMRMLSliceCompositeNode.h>
+#include <vtkMRMLSliceNode.h>
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+void CountModifiedEvents(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+                         void* clientData, void* vtkNotUsed(callData))
+{
+  ++(*reinterpret_cast<int*>(clientData));
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLSliceLinkLogicTest1(int vtkNotUsed(argc), char * vtkNotUsed(argv) [])
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLSliceLinkLogic> linkLogic;
+  linkLogic->SetMRMLScene(scene.GetPointer());
+
+  // Hot-linked compare views
+  const int numberOfViews = 9;
+  std::vector<vtkSmartPointer<vtkMRMLSliceNode> > sliceNodes;
+  std::vector<int> modifiedEvents(numberOfViews, 0);
+  for (int i = 0; i < numberOfViews; ++i)
+    {
+    std::stringstream name;
+    name << "Compare" << i;
+    vtkNew<vtkMRMLSliceNode> sliceNode;
+    sliceNode->SetName(name.str().c_str());
+    sliceNode->SetLayoutName(name.str().c_str());
+    sliceNode->SetFieldOfView(200., 200., 1.);
+    scene->AddNode(sliceNode.GetPointer());
+    sliceNodes.push_back(sliceNode.GetPointer());
+
+    vtkNew<vtkMRMLSliceCompositeNode> compositeNode;
+    compositeNode->SetLayoutName(name.str().c_str());
+    compositeNode->SetLinkedControl(1);
+    compositeNode->SetHotLinkedControl(1);
+    scene->AddNode(compositeNode.GetPointer());
+
+    vtkNew<vtkCallbackCommand> callback;
+    callback->SetCallback(CountModifiedEvents);
+    callback->SetClientData(&modifiedEvents[i]);
+    sliceNode->AddObserver(vtkCommand::ModifiedEvent, callback.GetPointer());
+    }
+
+  // Changing the field of view and origin of a view changes all the
+  // linked views, each of them being modified only once.
+  vtkMRMLSliceNode* interactingNode = sliceNodes[0];
+  interactingNode->InteractingOn();
+  interactingNode->SetInteractionFlags(vtkMRMLSliceNode::FieldOfViewFlag |
+                                       vtkMRMLSliceNode::XYZOriginFlag);
+  std::fill(modifiedEvents.begin(), modifiedEvents.end(), 0);
+  interactingNode->SetXYZOrigin(10., 20., 0.);
+  interactingNode->SetFieldOfView(100., 100., 1.);
+  interactingNode->InteractingOff();
+
+  for (int i = 1; i < numberOfViews; ++i)
+    {
+    if (fabs(sliceNodes[i]->GetFieldOfView()[0] - 100.) > 1e-6 ||
+        fabs(sliceNodes[i]->GetXYZOrigin()[0] - 10.) > 1e-6)
+      {
+      std::cerr << "Line " << __LINE__ << " - View " << i << " is not linked: "
+                << "field of view " << sliceNodes[i]->GetFieldOfView()[0]
+                << ", origin " << sliceNodes[i]->GetXYZOrigin()[0] << std::endl;
+      return EXIT_FAILURE;
+      }
+    // One broadcast per change of the interacting node
+    if (modifiedEvents[i] != 2)
+      {
+      std::cerr << "Line " << __LINE__ << " - View " << i << " modified "
+                << modifiedEvents[i] << " times instead of 2" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Removed views are not linked anymore
+  vtkMRMLSliceNode* removedNode = sliceNodes[numberOfViews - 1];
+  scene->RemoveNode(removedNode);
+  interactingNode->InteractingOn();
+  interactingNode->SetFieldOfView(50., 50., 1.);
+  interactingNode->InteractingOff();
+  if (fabs(sliceNodes[1]->GetFieldOfView()[0] - 50.) > 1e-6 ||
+      fabs(removedNode->GetFieldOfView()[0] - 100.) > 1e-6)
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong linked views after removal"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
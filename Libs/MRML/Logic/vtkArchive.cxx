@@ -21,6 +21,7 @@
 // STD includes
 #include <cstring>
 #include <iostream>
+#include <set>
 
 namespace
 {
@@ -357,11 +358,6 @@ bool zip(const char* zipFileName, const char* directoryToZip)
   // - close up and return success
   //
 
-// only support the libarchive version 3.0 +
-#if !defined(ARCHIVE_VERSION_NUMBER) || ARCHIVE_VERSION_NUMBER < 3000000
-  return false;
-#endif
-
   if ( !zipFileName || !directoryToZip )
     {
     vtkArchiveTools::Error("Zip:", "Invalid zipfile or directory");
@@ -384,14 +380,66 @@ bool zip(const char* zipFileName, const char* directoryToZip)
   std::vector<std::string> files = glob.GetFiles();
 
   // now zip it up using LibArchive
-  struct archive *zipArchive;
-  struct archive_entry *entry, *dirEntry;
-  char buff[BUFSIZ];
-  size_t len;
-  // have to read the contents of the files to add them to the archive
-  FILE *fd;
+  vtkArchiveZipWriter writer;
+  if (!writer.Open(zipFileName))
+    {
+    return false;
+    }
+
+  // add the data directory
+  writer.AddDirectory(directoryName.c_str());
+
+  // add the files
+  std::string parentDirectory =
+    vtksys::SystemTools::GetParentDirectory(directoryToZip);
+  std::vector<std::string>::const_iterator sit;
+  for (sit = files.begin(); sit != files.end(); ++sit)
+    {
+    vtkArchiveTools::Message("Zip: adding:", (*sit).c_str());
+    // use a relative path for the entry file name, including the top
+    // directory so it unzips into a directory of it's own
+    std::string relFileName = vtksys::SystemTools::RelativePath(
+              parentDirectory.c_str(), (*sit).c_str());
+    vtkArchiveTools::Message("Zip: adding rel:", relFileName.c_str());
+    writer.AddFile((*sit).c_str(), relFileName.c_str());
+    }
+
+  if (!writer.Close())
+    {
+    vtkArchiveTools::Error("Zip:", "error on close!");
+    return false;
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+vtkArchiveZipWriter::vtkArchiveZipWriter()
+  : Archive(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+vtkArchiveZipWriter::~vtkArchiveZipWriter()
+{
+  this->Close();
+}
 
-  zipArchive = archive_write_new();
+//-----------------------------------------------------------------------------
+bool vtkArchiveZipWriter::Open(const char* zipFileName)
+{
+// only support the libarchive version 3.0 +
+#if !defined(ARCHIVE_VERSION_NUMBER) || ARCHIVE_VERSION_NUMBER < 3000000
+  return false;
+#endif
+
+  this->Close();
+  if (!zipFileName)
+    {
+    vtkArchiveTools::Error("Zip:", "Invalid zipfile");
+    return false;
+    }
+
+  this->Archive = archive_write_new();
 
   // create a zip archive
 #ifdef HAVE_ZLIB_H
@@ -400,78 +448,102 @@ bool zip(const char* zipFileName, const char* directoryToZip)
   std::string compression_type = "store";
 #endif
 
-  archive_write_set_format_zip(zipArchive);
+  archive_write_set_format_zip(this->Archive);
 
-  archive_write_set_format_option(zipArchive, "zip", "compression", compression_type.c_str());
+  archive_write_set_format_option(this->Archive, "zip", "compression", compression_type.c_str());
 
-  archive_write_open_filename(zipArchive, zipFileName);
+  if (archive_write_open_filename(this->Archive, zipFileName) != ARCHIVE_OK)
+    {
+    vtkArchiveTools::Error("Zip: cannot create:", zipFileName);
+    archive_write_free(this->Archive);
+    this->Archive = 0;
+    return false;
+    }
+  return true;
+}
 
-  // add the data directory
-  dirEntry = archive_entry_new();
+//-----------------------------------------------------------------------------
+bool vtkArchiveZipWriter::IsOpen()const
+{
+  return this->Archive != 0;
+}
+
+//-----------------------------------------------------------------------------
+bool vtkArchiveZipWriter::AddDirectory(const char* memberPath)
+{
+  if (!this->Archive || !memberPath)
+    {
+    return false;
+    }
+  struct archive_entry* dirEntry = archive_entry_new();
   archive_entry_set_mtime(dirEntry, 11, 110);
-  archive_entry_copy_pathname(dirEntry, directoryName.c_str());
+  archive_entry_copy_pathname(dirEntry, memberPath);
   archive_entry_set_mode(dirEntry, S_IFDIR | 0755);
   archive_entry_set_size(dirEntry, 512);
-  archive_write_header(zipArchive, dirEntry);
+  int result = archive_write_header(this->Archive, dirEntry);
   archive_entry_free(dirEntry);
+  return result == ARCHIVE_OK;
+}
 
-  // add the files
-  std::vector<std::string>::const_iterator sit;
-  sit = files.begin();
-  while (sit != files.end())
+//-----------------------------------------------------------------------------
+bool vtkArchiveZipWriter::AddFile(const char* fileName, const char* memberPath)
+{
+  if (!this->Archive || !fileName || !memberPath)
     {
-    vtkArchiveTools::Message("Zip: adding:", (*sit).c_str());
-    const char *fileName = (*sit).c_str();
-    ++sit;
+    return false;
+    }
 
-    //
-    // add an entry for this file
-    //
-    entry = archive_entry_new();
-    // use a relative path for the entry file name, including the top
-    // directory so it unzips into a directory of it's own
-    std::string relFileName = vtksys::SystemTools::RelativePath(
-              vtksys::SystemTools::GetParentDirectory(directoryToZip).c_str(),
-              fileName);
-    vtkArchiveTools::Message("Zip: adding rel:", relFileName.c_str());
-    archive_entry_set_pathname(entry, relFileName.c_str());
-    // size is required, for now use the vtksys call though it uses struct stat
-    // and may not be portable
-    unsigned long fileLength = vtksys::SystemTools::FileLength(fileName);
-    archive_entry_set_size(entry, fileLength);
-    archive_entry_set_filetype(entry, AE_IFREG);
-    archive_entry_set_perm(entry, 0644);
-    archive_write_header(zipArchive, entry);
-
-    //
-    // add the data for this entry
-    //
-    fd = fopen(fileName, "rb");
-    if (!fd)
-      {
-      vtkArchiveTools::Error("Zip: cannot open:", (*sit).c_str());
-      }
-    else
-      {
-      len = fread(buff, sizeof(char), sizeof(buff), fd);
-      while ( len > 0 )
-        {
-        archive_write_data(zipArchive, buff, len);
-        len = fread(buff, sizeof(char), sizeof(buff), fd);
-        }
-      fclose(fd);
-      }
-    archive_entry_free(entry);
+  // have to read the contents of the files to add them to the archive
+  FILE *fd = fopen(fileName, "rb");
+  if (!fd)
+    {
+    vtkArchiveTools::Error("Zip: cannot open:", fileName);
+    return false;
+    }
+
+  //
+  // add an entry for this file
+  //
+  struct archive_entry* entry = archive_entry_new();
+  archive_entry_set_pathname(entry, memberPath);
+  // size is required, for now use the vtksys call though it uses struct stat
+  // and may not be portable
+  unsigned long fileLength = vtksys::SystemTools::FileLength(fileName);
+  archive_entry_set_size(entry, fileLength);
+  archive_entry_set_filetype(entry, AE_IFREG);
+  archive_entry_set_perm(entry, 0644);
+  bool success = (archive_write_header(this->Archive, entry) == ARCHIVE_OK);
+
+  //
+  // add the data for this entry
+  //
+  char buff[BUFSIZ];
+  size_t len = fread(buff, sizeof(char), sizeof(buff), fd);
+  while ( success && len > 0 )
+    {
+    success = archive_write_data(this->Archive, buff, len) >= 0;
+    len = fread(buff, sizeof(char), sizeof(buff), fd);
     }
+  fclose(fd);
+  archive_entry_free(entry);
+  if (!success)
+    {
+    vtkArchiveTools::Error("Zip: cannot add:", archive_error_string(this->Archive));
+    }
+  return success;
+}
 
-  archive_write_close(zipArchive);
-  int retval = archive_write_free(zipArchive);
-  if (retval != ARCHIVE_OK)
+//-----------------------------------------------------------------------------
+bool vtkArchiveZipWriter::Close()
+{
+  if (!this->Archive)
     {
-    vtkArchiveTools::Error("Zip:", "error on close!");
     return false;
     }
-  return true;
+  archive_write_close(this->Archive);
+  int retval = archive_write_free(this->Archive);
+  this->Archive = 0;
+  return retval == ARCHIVE_OK;
 }
 
 //-----------------------------------------------------------------------------
@@ -627,3 +699,116 @@ bool unzip(const char* zipFileName, const char* destinationDirectory)
 
   return (result == ARCHIVE_OK);
 }
+
+//-----------------------------------------------------------------------------
+// unzips the listed members of the zip file into destinationDirectory
+bool unzip_members(const char* zipFileName, const char* destinationDirectory,
+                   const std::vector<std::string>& memberPaths,
+                   vtkArchiveMemberExtractedCallback memberExtracted,
+                   void* clientData)
+{
+  if ( !zipFileName || !destinationDirectory )
+    {
+    vtkArchiveTools::Error("Unzip:", "Invalid zipfile or directory");
+    return false;
+    }
+
+  if ( !vtksys::SystemTools::FileExists(zipFileName) )
+    {
+    vtkArchiveTools::Error("Unzip:", "Zip file does not exist");
+    return false;
+    }
+
+  if ( !vtksys::SystemTools::FileIsDirectory(destinationDirectory) )
+    {
+    vtkArchiveTools::Error("Unzip:", "Destination is not a directory");
+    return false;
+    }
+
+  std::set<std::string> remainingMembers(memberPaths.begin(), memberPaths.end());
+  if (remainingMembers.empty())
+    {
+    return true;
+    }
+
+  struct archive *zipArchive = archive_read_new();
+  archive_read_support_filter_all(zipArchive);
+  archive_read_support_format_all(zipArchive);
+  if (archive_read_open_filename(zipArchive, zipFileName, 10240) != ARCHIVE_OK)
+    {
+    vtkArchiveTools::Error("Unzip:", "Cannot open archive file");
+    archive_read_free(zipArchive);
+    return false;
+    }
+
+  std::string cwd = vtksys::SystemTools::GetCurrentWorkingDirectory(true);
+  if ( vtksys::SystemTools::ChangeDirectory(destinationDirectory) )
+    {
+    vtkArchiveTools::Error("Unzip:", "could not change to destination directory");
+    archive_read_free(zipArchive);
+    return false;
+    }
+
+  struct archive *diskDestination = archive_write_disk_new();
+  archive_write_disk_set_standard_lookup(diskDestination);
+
+  bool success = true;
+  struct archive_entry *entry;
+  while (success && !remainingMembers.empty())
+    {
+    int result = archive_read_next_header(zipArchive, &entry);
+    if (result == ARCHIVE_EOF)
+      {
+      break;
+      }
+    if (result < ARCHIVE_WARN)
+      {
+      vtkArchiveTools::Error("Unzip error:", archive_error_string(zipArchive));
+      success = false;
+      break;
+      }
+    std::string memberPath = archive_entry_pathname(entry);
+    if (remainingMembers.find(memberPath) == remainingMembers.end())
+      {
+      // not requested, don't even decompress it
+      archive_read_data_skip(zipArchive);
+      continue;
+      }
+    remainingMembers.erase(memberPath);
+
+    if (archive_write_header(diskDestination, entry) < ARCHIVE_WARN ||
+        copy_data(zipArchive, diskDestination) != ARCHIVE_OK ||
+        archive_write_finish_entry(diskDestination) < ARCHIVE_WARN)
+      {
+      vtkArchiveTools::Error("Unzip error:", archive_error_string(diskDestination));
+      success = false;
+      break;
+      }
+    // the member is entirely on disk, let the caller consume it before the
+    // next one is written
+    if (memberExtracted)
+      {
+      (*memberExtracted)(memberPath.c_str(), clientData);
+      }
+    }
+
+  if (!remainingMembers.empty())
+    {
+    vtkArchiveTools::Error("Unzip: member not found in archive:",
+                           remainingMembers.begin()->c_str());
+    success = false;
+    }
+
+  archive_read_close(zipArchive);
+  archive_read_free(zipArchive);
+  archive_write_close(diskDestination);
+  archive_write_free(diskDestination);
+
+  if ( vtksys::SystemTools::ChangeDirectory(cwd.c_str()) )
+    {
+    vtkArchiveTools::Error("Unzip:", "could not change back to working directory");
+    return false;
+    }
+
+  return success;
+}
@@ -42,8 +42,56 @@ VTK_MRML_LOGIC_EXPORT bool zip(const char* zipFileName, const char* directoryToZ
 // unzips zip file into specified directory
 // (internally this supports many formats of archive, not just zip)
 VTK_MRML_LOGIC_EXPORT bool unzip(const char* zipFileName, const char *destinationDirectory);
+
+// called by unzip_members() right after a member has been written to disk,
+// memberPath is relative to the destination directory
+typedef void (*vtkArchiveMemberExtractedCallback)(const char* memberPath, void* clientData);
+
+// unzips only the listed members of the zip file into the specified directory,
+// in a single pass over the archive. If memberExtracted is set, it is called
+// after each member is extracted so that it can be consumed (and removed)
+// before the next one is written.
+VTK_MRML_LOGIC_EXPORT bool unzip_members(const char* zipFileName,
+                                         const char* destinationDirectory,
+                                         const std::vector<std::string>& memberPaths,
+                                         vtkArchiveMemberExtractedCallback memberExtracted = 0,
+                                         void* clientData = 0);
 #ifdef __cplusplus
 }
 #endif
 
+struct archive;
+
+/// \brief Write a zip file one member at a time.
+///
+/// Contrary to zip(), files don't need to be all on disk when the archive is
+/// created: each file can be added (and then discarded) as soon as it has
+/// been written. Used by zip().
+class VTK_MRML_LOGIC_EXPORT vtkArchiveZipWriter
+{
+public:
+  vtkArchiveZipWriter();
+  /// Close the archive if still open.
+  ~vtkArchiveZipWriter();
+
+  /// Create the zip file. Returns false if it can't be created.
+  bool Open(const char* zipFileName);
+  bool IsOpen()const;
+
+  /// Add a directory entry named memberPath.
+  bool AddDirectory(const char* memberPath);
+
+  /// Add the content of fileName as an entry named memberPath.
+  bool AddFile(const char* fileName, const char* memberPath);
+
+  /// Finalize the zip file. Returns false if it can't be written.
+  bool Close();
+
+private:
+  vtkArchiveZipWriter(const vtkArchiveZipWriter&); // Not implemented
+  void operator=(const vtkArchiveZipWriter&); // Not implemented
+
+  struct archive* Archive;
+};
+
 #endif
@@ -20,6 +20,9 @@
 #include <vtkStreamingDemandDrivenPipeline.h>
 #include <vtkVersion.h>
 
+// STD includes
+#include <cstring>
+
 //------------------------------------------------------------------------------
 vtkStandardNewMacro(vtkImageLabelOutline);
 
@@ -204,6 +207,70 @@ static void vtkImageLabelOutlineExecute(vtkImageLabelOutline *self,
     }//for2
 }
 
+//----------------------------------------------------------------------------
+// Description:
+// Fast path for the default outline of 1 pixel: the 8 in-slice neighbors are
+// read from the previous, current and next rows without boundary tests, the
+// pixels on the border of the image are always outline pixels. There is no
+// branch in the inner loop so the compiler can vectorize it.
+template <class T>
+static void vtkImageLabelOutlineExecute8(vtkImageLabelOutline *self,
+                     vtkImageData *inData, vtkImageData *outData,
+                     int outExt[6], int wholeExt[6], int id)
+{
+  vtkIdType inInc0, inInc1, inInc2;
+  inData->GetIncrements(inInc0, inInc1, inInc2);
+  const T backgroundLabelValue = static_cast<T>(self->GetBackground());
+  const int rowLength = outExt[1] - outExt[0] + 1;
+  // the first and last pixels of a row are on the image border
+  const int first = (outExt[0] == wholeExt[0]) ? 1 : 0;
+  const int last = (outExt[1] == wholeExt[1]) ? rowLength - 2 : rowLength - 1;
+  unsigned long count = 0;
+  unsigned long target =
+    (unsigned long)((outExt[5]-outExt[4]+1)*(outExt[3]-outExt[2]+1)/50.0);
+  target++;
+
+  for (int outIdx2 = outExt[4]; outIdx2 <= outExt[5]; ++outIdx2)
+    {
+    for (int outIdx1 = outExt[2];
+      !self->AbortExecute && outIdx1 <= outExt[3]; ++outIdx1)
+      {
+      if (!id)
+        {
+        if (!(count%target))
+          {
+          self->UpdateProgress(count/(50.0*target));
+          }
+        count++;
+        }
+      const T *inPtr = static_cast<T*>(
+        inData->GetScalarPointer(outExt[0], outIdx1, outIdx2));
+      T *outPtr = static_cast<T*>(
+        outData->GetScalarPointer(outExt[0], outIdx1, outIdx2));
+      if (outIdx1 == wholeExt[2] || outIdx1 == wholeExt[3])
+        {
+        // every label pixel of the first and last rows is an outline pixel
+        memcpy(outPtr, inPtr, rowLength * sizeof(T));
+        continue;
+        }
+      const T *prevPtr = inPtr - inInc1;
+      const T *nextPtr = inPtr + inInc1;
+      outPtr[0] = inPtr[0];
+      outPtr[rowLength - 1] = inPtr[rowLength - 1];
+      for (int i = first; i <= last; ++i)
+        {
+        const T inLabelValue = inPtr[i];
+        const bool transition =
+          (prevPtr[i-1] != inLabelValue) | (prevPtr[i] != inLabelValue) |
+          (prevPtr[i+1] != inLabelValue) | (inPtr[i-1] != inLabelValue) |
+          (inPtr[i+1] != inLabelValue) | (nextPtr[i-1] != inLabelValue) |
+          (nextPtr[i] != inLabelValue) | (nextPtr[i+1] != inLabelValue);
+        outPtr[i] = transition ? inLabelValue : backgroundLabelValue;
+        }
+      }
+    }
+}
+
 //----------------------------------------------------------------------------
 // Description:
 // This method is passed a input and output data, and executes the filter
@@ -226,6 +293,39 @@ void vtkImageLabelOutline::ThreadedExecute(vtkImageData *inData,
 
   void *inPtr = inData->GetScalarPointerForExtent(outExt);
 
+  // the fast kernel reads the neighbors of contiguous single component rows
+  if (this->Outline == 1 &&
+      inData->GetNumberOfScalarComponents() == 1 &&
+      outData->GetNumberOfScalarComponents() == 1 &&
+      (inData->GetScalarType() == VTK_UNSIGNED_CHAR ||
+       inData->GetScalarType() == VTK_SHORT ||
+       inData->GetScalarType() == VTK_UNSIGNED_SHORT))
+    {
+    int wholeExt[6];
+#if (VTK_MAJOR_VERSION <= 5)
+    this->GetInput()->GetWholeExtent(wholeExt);
+#else
+    this->GetInputInformation()->Get(
+      vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExt);
+#endif
+    switch (inData->GetScalarType())
+      {
+      case VTK_UNSIGNED_CHAR:
+        vtkImageLabelOutlineExecute8<unsigned char>(this, inData, outData,
+          outExt, wholeExt, id);
+        break;
+      case VTK_SHORT:
+        vtkImageLabelOutlineExecute8<short>(this, inData, outData,
+          outExt, wholeExt, id);
+        break;
+      case VTK_UNSIGNED_SHORT:
+        vtkImageLabelOutlineExecute8<unsigned short>(this, inData, outData,
+          outExt, wholeExt, id);
+        break;
+      }
+    return;
+    }
+
   switch (inData->GetScalarType())
     {
   case VTK_DOUBLE:
@@ -25,6 +25,8 @@ class vtkImageData;
 ///
 /// Used  in slicer for the Label layer to outline the segmented
 /// structures (instead of showing them filled-in).
+/// The default 1 pixel outline of unsigned char, short and unsigned short
+/// labelmaps is computed by a specialized 8-neighbor kernel.
 class VTK_MRML_LOGIC_EXPORT vtkImageLabelOutline : public vtkImageNeighborhoodFilter
 {
 public:
@@ -50,7 +50,11 @@
 #include <vtksys/Glob.hxx>
 
 // STD includes
+#include <algorithm>
 #include <cassert>
+#include <fstream>
+#include <map>
+#include <set>
 #include <sstream>
 
 // For LoadDefaultParameterSets
@@ -70,6 +74,11 @@ class vtkMRMLApplicationLogic::vtkInternal
 public:
   vtkInternal(vtkMRMLApplicationLogic * external);
   void PropagateVolumeSelection(int layer, int fit);
+  /// Move the file into BundleWriter if it is not in the bundle yet.
+  bool AddFileToBundle(const std::string& file);
+  /// Move the files of directory that are not in the bundle yet into
+  /// BundleWriter.
+  bool AddNewFilesToBundle(const std::string& directory);
   ~vtkInternal();
 
   vtkMRMLApplicationLogic*        External;
@@ -81,6 +90,10 @@ public:
   vtkSmartPointer<vtkMRMLColorLogic> ColorLogic;
   std::string TemporaryPath;
 
+  /// Set while saving with SaveSceneToSlicerDataBundle()
+  vtkArchiveZipWriter* BundleWriter;
+  std::string BundleRootDirectory;
+  std::set<std::string> BundledFiles;
 };
 
 //----------------------------------------------------------------------------
@@ -90,6 +103,7 @@ public:
 vtkMRMLApplicationLogic::vtkInternal::vtkInternal(vtkMRMLApplicationLogic * external)
 {
   this->External = external;
+  this->BundleWriter = 0;
   this->SliceLinkLogic = vtkSmartPointer<vtkMRMLSliceLinkLogic>::New();
   this->ModelHierarchyLogic = vtkSmartPointer<vtkMRMLModelHierarchyLogic>::New();
   this->ColorLogic = vtkSmartPointer<vtkMRMLColorLogic>::New();
@@ -100,6 +114,51 @@ vtkMRMLApplicationLogic::vtkInternal::~vtkInternal()
 {
 }
 
+//----------------------------------------------------------------------------
+bool vtkMRMLApplicationLogic::vtkInternal::AddFileToBundle(const std::string& file)
+{
+  if (!this->BundleWriter)
+    {
+    return false;
+    }
+  if (this->BundledFiles.find(file) != this->BundledFiles.end())
+    {
+    return true;
+    }
+  std::string memberPath =
+    vtksys::SystemTools::RelativePath(this->BundleRootDirectory.c_str(), file.c_str());
+  if (!this->BundleWriter->AddFile(file.c_str(), memberPath.c_str()))
+    {
+    // not marked as bundled, the final scan of the directory tries again
+    return false;
+    }
+  this->BundledFiles.insert(file);
+  // Keep an empty file so that the next unique file names are still
+  // computed against it.
+  std::ofstream truncatedFile(file.c_str(), std::ios::out | std::ios::trunc);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLApplicationLogic::vtkInternal::AddNewFilesToBundle(const std::string& directory)
+{
+  if (!this->BundleWriter)
+    {
+    return false;
+    }
+  vtksys::Glob glob;
+  glob.RecurseOn();
+  glob.RecurseThroughSymlinksOff();
+  glob.FindFiles(directory + "/*");
+  std::vector<std::string> files = glob.GetFiles();
+  bool success = true;
+  for (std::vector<std::string>::const_iterator it = files.begin(); it != files.end(); ++it)
+    {
+    success = this->AddFileToBundle(*it) && success;
+    }
+  return success;
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLApplicationLogic::vtkInternal::PropagateVolumeSelection(int layer, int fit)
 {
@@ -451,6 +510,277 @@ bool vtkMRMLApplicationLogic::OpenSlicerDataBundle(const char *sdbFilePath, cons
   return true;
 }
 
+//----------------------------------------------------------------------------
+namespace
+{
+
+//----------------------------------------------------------------------------
+struct BundlePendingRead
+{
+  vtkSmartPointer<vtkMRMLStorageNode> StorageNode;
+  vtkSmartPointer<vtkMRMLStorableNode> StorableNode;
+  std::vector<std::string> Members;
+  int MissingMembers;
+};
+
+//----------------------------------------------------------------------------
+struct BundleReader
+{
+  vtkMRMLScene* Scene;
+  std::string Directory;
+  std::vector<BundlePendingRead> Reads;
+  /// Indices in Reads of the reads waiting for a member
+  std::map<std::string, std::vector<size_t> > ReadsByMember;
+  /// Number of reads that still need a member
+  std::map<std::string, int> MemberUsers;
+  bool Success;
+};
+
+//----------------------------------------------------------------------------
+bool ReadBundleData(vtkMRMLScene* scene, const BundlePendingRead& read)
+{
+  if (read.StorageNode->ReadData(read.StorableNode))
+    {
+    return true;
+    }
+  scene->SetErrorCode(1);
+  scene->SetErrorMessage(std::string("Error reading file ") +
+                         read.StorageNode->GetFullNameFromFileName());
+  return false;
+}
+
+//----------------------------------------------------------------------------
+void ReadBundleMember(const char* memberPath, void* clientData)
+{
+  BundleReader* reader = reinterpret_cast<BundleReader*>(clientData);
+  const std::vector<size_t>& reads = reader->ReadsByMember[memberPath];
+  for (std::vector<size_t>::const_iterator it = reads.begin(); it != reads.end(); ++it)
+    {
+    BundlePendingRead& read = reader->Reads[*it];
+    if (--read.MissingMembers > 0)
+      {
+      continue;
+      }
+    reader->Success = ReadBundleData(reader->Scene, read) && reader->Success;
+    // files are not needed anymore once all their readers are done
+    for (std::vector<std::string>::const_iterator mit = read.Members.begin();
+         mit != read.Members.end(); ++mit)
+      {
+      if (--reader->MemberUsers[*mit] == 0)
+        {
+        vtksys::SystemTools::RemoveFile((reader->Directory + "/" + *mit).c_str());
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Extract from the bundle and read the data of the storable nodes of the
+/// scene that are not in \a existingNodes. Errors are reported in the scene
+/// error code and message.
+bool ReadBundleNodesData(vtkMRMLScene* scene, const char* sdbFilePath,
+                         const std::string& directory,
+                         const std::vector<std::string>& members,
+                         const std::set<vtkMRMLNode*>& existingNodes)
+{
+  // find the archive members of each data to read
+  std::set<std::string> archiveMembers(members.begin(), members.end());
+  BundleReader reader;
+  reader.Scene = scene;
+  reader.Directory = directory;
+  reader.Success = true;
+  std::vector<BundlePendingRead> directReads;
+  std::vector<vtkMRMLNode*> storableNodes;
+  scene->GetNodesByClass("vtkMRMLStorableNode", storableNodes);
+  for (std::vector<vtkMRMLNode*>::const_iterator it = storableNodes.begin();
+       it != storableNodes.end(); ++it)
+    {
+    vtkMRMLStorableNode* storableNode = vtkMRMLStorableNode::SafeDownCast(*it);
+    if (!storableNode->GetAddToScene() ||
+        existingNodes.find(storableNode) != existingNodes.end())
+      {
+      continue;
+      }
+    for (int i = 0; i < storableNode->GetNumberOfStorageNodes(); ++i)
+      {
+      vtkMRMLStorageNode* storageNode = storableNode->GetNthStorageNode(i);
+      if (!storageNode)
+        {
+        continue;
+        }
+      std::vector<std::string> fileNames;
+      if (storageNode->GetFileName())
+        {
+        fileNames.push_back(storageNode->GetFullNameFromFileName());
+        }
+      for (int n = 0; n < storageNode->GetNumberOfFileNames(); ++n)
+        {
+        fileNames.push_back(storageNode->GetFullNameFromNthFileName(n));
+        }
+      std::set<std::string> readMembers;
+      for (std::vector<std::string>::const_iterator fit = fileNames.begin();
+           fit != fileNames.end(); ++fit)
+        {
+        std::string fileName = vtksys::SystemTools::CollapseFullPath(fit->c_str());
+        if (fileName.compare(0, directory.size() + 1, directory + "/") != 0)
+          {
+          continue;
+          }
+        std::string member = fileName.substr(directory.size() + 1);
+        if (archiveMembers.find(member) == archiveMembers.end())
+          {
+          continue;
+          }
+        readMembers.insert(member);
+        // header files (e.g. .nhdr, .mhd) come with a data file of the
+        // same name that is not listed by the storage node
+        std::string memberDir = vtksys::SystemTools::GetFilenamePath(member);
+        std::string memberName = vtksys::SystemTools::GetFilenameWithoutExtension(member);
+        for (std::vector<std::string>::const_iterator mit = members.begin();
+             mit != members.end(); ++mit)
+          {
+          if (vtksys::SystemTools::GetFilenamePath(*mit) == memberDir &&
+              vtksys::SystemTools::GetFilenameWithoutExtension(*mit) == memberName &&
+              (*mit)[mit->size() - 1] != '/')
+            {
+            readMembers.insert(*mit);
+            }
+          }
+        }
+      BundlePendingRead read;
+      read.StorageNode = storageNode;
+      read.StorableNode = storableNode;
+      read.Members.assign(readMembers.begin(), readMembers.end());
+      read.MissingMembers = static_cast<int>(read.Members.size());
+      if (read.Members.empty())
+        {
+        // data is not in the bundle (e.g. remote or absolute file name)
+        directReads.push_back(read);
+        continue;
+        }
+      for (std::vector<std::string>::const_iterator mit = read.Members.begin();
+           mit != read.Members.end(); ++mit)
+        {
+        reader.ReadsByMember[*mit].push_back(reader.Reads.size());
+        ++reader.MemberUsers[*mit];
+        }
+      reader.Reads.push_back(read);
+      }
+    }
+
+  // extract and read the data one storage node at a time
+  std::vector<std::string> dataMembers;
+  for (std::map<std::string, int>::const_iterator it = reader.MemberUsers.begin();
+       it != reader.MemberUsers.end(); ++it)
+    {
+    dataMembers.push_back(it->first);
+    }
+  if (!unzip_members(sdbFilePath, directory.c_str(), dataMembers,
+                     ReadBundleMember, &reader))
+    {
+    scene->SetErrorCode(1);
+    scene->SetErrorMessage(std::string("Could not extract data from bundle file ") +
+                           sdbFilePath);
+    reader.Success = false;
+    }
+  for (std::vector<BundlePendingRead>::const_iterator it = directReads.begin();
+       it != directReads.end(); ++it)
+    {
+    reader.Success = ReadBundleData(scene, *it) && reader.Success;
+    }
+  return reader.Success;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+bool vtkMRMLApplicationLogic::LoadSlicerDataBundle(const char *sdbFilePath,
+                                                   const char *temporaryDirectory,
+                                                   bool clear)
+{
+  vtkMRMLScene* scene = this->GetMRMLScene();
+  if (!scene)
+    {
+    vtkErrorMacro("no scene");
+    return false;
+    }
+  if (!sdbFilePath || !temporaryDirectory)
+    {
+    vtkErrorMacro("no bundle file or temporary directory given");
+    return false;
+    }
+  std::vector<std::string> members;
+  if (!list_archive(sdbFilePath, members))
+    {
+    vtkErrorMacro("could not open bundle file " << sdbFilePath);
+    return false;
+    }
+  std::string mrmlMember;
+  for (std::vector<std::string>::const_iterator it = members.begin(); it != members.end(); ++it)
+    {
+    if (vtkMRMLStorageNode::GetLowercaseExtensionFromFileName(*it) == ".mrml" &&
+        (mrmlMember.empty() ||
+         std::count(it->begin(), it->end(), '/') < std::count(mrmlMember.begin(), mrmlMember.end(), '/')))
+      {
+      mrmlMember = *it;
+      }
+    }
+  if (mrmlMember.empty())
+    {
+    vtkErrorMacro("could not find mrml file in archive");
+    return false;
+    }
+  if (!unzip_members(sdbFilePath, temporaryDirectory,
+                     std::vector<std::string>(1, mrmlMember)))
+    {
+    vtkErrorMacro("could not extract " << mrmlMember << " from bundle file");
+    return false;
+    }
+
+  // storable nodes already in the scene must not be read again
+  std::set<vtkMRMLNode*> existingNodes;
+  if (!clear)
+    {
+    std::vector<vtkMRMLNode*> nodes;
+    scene->GetNodesByClass("vtkMRMLStorableNode", nodes);
+    existingNodes.insert(nodes.begin(), nodes.end());
+    }
+
+  // Load the scene without its data and read the data before the end of the
+  // import so that the EndImport observers find the nodes loaded.
+  std::string directory =
+    vtksys::SystemTools::CollapseFullPath(temporaryDirectory);
+  std::string mrmlFile = directory + "/" + mrmlMember;
+  scene->SetURL(mrmlFile.c_str());
+  bool undoFlag = scene->GetUndoFlag();
+  scene->StartState(vtkMRMLScene::BatchProcessState);
+  if (clear)
+    {
+    scene->Clear(0);
+    }
+  scene->StartState(vtkMRMLScene::ImportState);
+  int readDataOnLoad = scene->GetReadDataOnLoad();
+  scene->SetReadDataOnLoad(0);
+  bool success = scene->Import() != 0;
+  scene->SetReadDataOnLoad(readDataOnLoad);
+  vtksys::SystemTools::RemoveFile(mrmlFile.c_str());
+  if (!success)
+    {
+    vtkErrorMacro("Could not load scene " << mrmlMember << ": "
+                  << scene->GetErrorMessage());
+    }
+  else if (!ReadBundleNodesData(scene, sdbFilePath, directory, members, existingNodes))
+    {
+    vtkErrorMacro("Could not read the data of bundle file " << sdbFilePath << ": "
+                  << scene->GetErrorMessage());
+    success = false;
+    }
+  scene->EndState(vtkMRMLScene::ImportState);
+  scene->EndState(vtkMRMLScene::BatchProcessState);
+  scene->SetUndoFlag(undoFlag);
+  return success;
+}
+
 //----------------------------------------------------------------------------
 std::string vtkMRMLApplicationLogic::PercentEncode(std::string s)
 {
@@ -774,6 +1104,46 @@ bool vtkMRMLApplicationLogic::SaveSceneToSlicerDataBundleDirectory(const char *s
   return true;
 }
 
+//----------------------------------------------------------------------------
+bool vtkMRMLApplicationLogic::SaveSceneToSlicerDataBundle(const char *sdbFilePath,
+                                                          const char *sdbDir,
+                                                          vtkImageData *screenShot)
+{
+  if (!sdbFilePath || !sdbDir)
+    {
+    vtkErrorMacro("no bundle file or directory given!");
+    return false;
+    }
+  vtkArchiveZipWriter writer;
+  if (!writer.Open(sdbFilePath))
+    {
+    vtkErrorMacro("could not create bundle file " << sdbFilePath);
+    return false;
+    }
+  // the members are relative to the parent directory so that the bundle
+  // unzips into a directory of its own
+  std::string rootDir = vtksys::SystemTools::CollapseFullPath(sdbDir);
+  this->Internal->BundleRootDirectory = vtksys::SystemTools::GetParentDirectory(rootDir.c_str());
+  this->Internal->BundledFiles.clear();
+  writer.AddDirectory(vtksys::SystemTools::GetFilenameName(rootDir).c_str());
+  this->Internal->BundleWriter = &writer;
+
+  // data files are added by SaveStorableNodeToSlicerDataBundleDirectory()
+  bool success = this->SaveSceneToSlicerDataBundleDirectory(sdbDir, screenShot);
+  // the scene file, the screen shot and the data files not listed by their
+  // storage node (e.g. the .raw of a .nhdr) are added by a single scan
+  success = success && this->Internal->AddNewFilesToBundle(rootDir);
+
+  this->Internal->BundleWriter = 0;
+  this->Internal->BundledFiles.clear();
+  if (!writer.Close())
+    {
+    vtkErrorMacro("could not write bundle file " << sdbFilePath);
+    success = false;
+    }
+  return success;
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLApplicationLogic::SaveStorableNodeToSlicerDataBundleDirectory(vtkMRMLStorableNode *storableNode,
                                                                           std::string &dataDir)
@@ -865,6 +1235,26 @@ void vtkMRMLApplicationLogic::SaveStorableNodeToSlicerDataBundleDirectory(vtkMRM
 
     storageNode->WriteData(storableNode);
 
+    if (this->Internal->BundleWriter)
+      {
+      // move the written files into the bundle right away, without scanning
+      // the whole directory for each node
+      std::vector<std::string> fileNames;
+      fileNames.push_back(storageNode->GetFullNameFromFileName());
+      for (int i = 0; i < storageNode->GetNumberOfFileNames(); ++i)
+        {
+        fileNames.push_back(storageNode->GetFullNameFromNthFileName(i));
+        }
+      for (std::vector<std::string>::const_iterator it = fileNames.begin();
+           it != fileNames.end(); ++it)
+        {
+        std::string writtenFile = vtksys::SystemTools::CollapseFullPath(it->c_str());
+        if (vtksys::SystemTools::FileExists(writtenFile.c_str(), true))
+          {
+          this->Internal->AddFileToBundle(writtenFile);
+          }
+        }
+      }
     }
  }
 
@@ -148,6 +148,17 @@ public:
   /// Returns false if the save failed
   bool SaveSceneToSlicerDataBundleDirectory(const char *sdbDir, vtkImageData *screenShot = NULL);
 
+  /// Save the scene into the data bundle file sdbFilePath, using sdbDir as
+  /// staging directory (see SaveSceneToSlicerDataBundleDirectory()).
+  /// Contrary to a Zip() of the staging directory, each data file is added to
+  /// the archive as soon as it has been written and its content is discarded
+  /// from the staging directory: the disk usage stays close to the size of the
+  /// largest data set instead of the size of the whole scene.
+  /// The staging directory is not removed.
+  /// Returns false if the save failed
+  bool SaveSceneToSlicerDataBundle(const char *sdbFilePath, const char *sdbDir,
+                                   vtkImageData *screenShot = NULL);
+
   /// Open the file into a temp directory and load the scene file
   /// inside.  Note that the first mrml file found in the extracted
   /// directory will be used.
@@ -158,6 +169,21 @@ public:
   /// directory will be used.
   std::string UnpackSlicerDataBundle(const char *sdbFilePath, const char *temporaryDirectory);
 
+  /// Load the scene of the data bundle without unpacking the whole file.
+  /// The scene file is extracted and imported first, after clearing the
+  /// scene if clear is true (like Connect()), then the data files referenced
+  /// by the loaded storage nodes are extracted into temporaryDirectory in a
+  /// single pass over the archive: each storage node reads its data as soon
+  /// as its files are available and the files are removed right after. The
+  /// data of the nodes already in the scene is not read again. The data is
+  /// read before the end of the import: EndImportEvent observers find it
+  /// loaded.
+  /// Returns false if the scene can't be loaded or a data file can't be read,
+  /// the scene error code and message tell why.
+  /// \sa OpenSlicerDataBundle()
+  bool LoadSlicerDataBundle(const char *sdbFilePath, const char *temporaryDirectory,
+                            bool clear = true);
+
   /// Load any default parameter sets into the specified scene
   /// Returns the total number of loaded parameter sets
   static int LoadDefaultParameterSets(vtkMRMLScene * scene,
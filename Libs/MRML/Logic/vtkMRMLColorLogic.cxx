@@ -30,6 +30,9 @@
 
 // VTK includes
 #include <vtkColorTransferFunction.h>
+#include <vtkConditionVariable.h>
+#include <vtkIntArray.h>
+#include <vtkMutexLock.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 
@@ -44,11 +47,30 @@ vtkStandardNewMacro(vtkMRMLColorLogic);
 vtkMRMLColorLogic::vtkMRMLColorLogic()
 {
   this->UserColorFilePaths = NULL;
+  this->AbortReadingColorFiles = false;
+  this->ColorFileTablesLock = vtkMutexLock::New();
+  this->ColorFileTableRead = vtkConditionVariable::New();
+  this->ColorFilesThreader = vtkMultiThreader::New();
+  this->ColorFilesThreadID = -1;
 }
 
 //----------------------------------------------------------------------------
 vtkMRMLColorLogic::~vtkMRMLColorLogic()
 {
+  this->StopReadingColorFiles(true);
+  this->ColorFilesThreader->Delete();
+  for (std::map<std::string, ColorFileTable>::iterator it = this->ColorFileTables.begin();
+       it != this->ColorFileTables.end(); ++it)
+    {
+    if (it->second.Table)
+      {
+      it->second.Table->Delete();
+      }
+    }
+  this->ColorFileTables.clear();
+  this->ColorFileTableRead->Delete();
+  this->ColorFileTablesLock->Delete();
+
   // remove the default color nodes
   this->RemoveDefaultColorNodes();
 
@@ -85,6 +107,27 @@ void vtkMRMLColorLogic::OnMRMLSceneNewEvent()
   this->AddDefaultColorNodes();
 }
 
+//------------------------------------------------------------------------------
+void vtkMRMLColorLogic::ProcessMRMLNodesEvents(vtkObject* caller,
+                                               unsigned long event,
+                                               void* callData)
+{
+  vtkMRMLColorTableNode* colorNode = vtkMRMLColorTableNode::SafeDownCast(caller);
+  if (event == vtkMRMLColorTableNode::LoadDeferredColorsEvent && colorNode)
+    {
+    // colors of a default color file, read once for all the scenes
+    vtkMRMLStorageNode* storageNode = colorNode->GetStorageNode();
+    vtkMRMLColorTableNode* colors = (storageNode && storageNode->GetFileName()) ?
+      this->GetColorFileTable(storageNode->GetFileName()) : 0;
+    if (colors)
+      {
+      colorNode->CopyColors(colors);
+      }
+    return;
+    }
+  this->Superclass::ProcessMRMLNodesEvents(caller, event, callData);
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLColorLogic::PrintSelf(ostream& os, vtkIndent indent)
 {
@@ -103,6 +146,7 @@ void vtkMRMLColorLogic::PrintSelf(ostream& os, vtkIndent indent)
     {
     os << indent.GetNextIndent() << i << " " << this->UserColorFiles[i].c_str() << "\n";
     }
+  os << indent << "Color File Tables: " << this->ColorFileTables.size() << "\n";
 }
 
 //----------------------------------------------------------------------------
@@ -119,6 +163,17 @@ void vtkMRMLColorLogic::AddDefaultColorNodes()
 
   this->GetMRMLScene()->StartState(vtkMRMLScene::BatchProcessState);
 
+  // start reading the color files while the other nodes are added
+  this->ColorFiles = this->FindDefaultColorFiles();
+  this->UserColorFiles = this->FindUserColorFiles();
+  std::vector<std::string> colorFiles(this->ColorFiles);
+  vtkNew<vtkMRMLFreeSurferProceduralColorNode> freeSurferNode;
+  if (freeSurferNode->GetLabelsFileName())
+    {
+    colorFiles.push_back(freeSurferNode->GetLabelsFileName());
+    }
+  this->StartReadingColorFiles(colorFiles);
+
   // add the labels first
   this->AddLabelsNode();
 
@@ -468,7 +523,7 @@ vtkMRMLColorNode* vtkMRMLColorLogic::LoadColorFile(const char *fileName, const c
 vtkMRMLColorTableNode* vtkMRMLColorLogic::CreateLabelsNode()
 {
   vtkMRMLColorTableNode *labelsNode = vtkMRMLColorTableNode::New();
-  labelsNode->SetTypeToLabels();
+  labelsNode->SetDeferredType(vtkMRMLColorTableNode::Labels);
   labelsNode->SetAttribute("Category", "Discrete");
   labelsNode->SaveWithSceneOff();
   labelsNode->SetName(labelsNode->GetTypeAsString());
@@ -480,7 +535,8 @@ vtkMRMLColorTableNode* vtkMRMLColorLogic::CreateLabelsNode()
 vtkMRMLColorTableNode* vtkMRMLColorLogic::CreateDefaultTableNode(int type)
 {
   vtkMRMLColorTableNode *node = vtkMRMLColorTableNode::New();
-  node->SetType(type);
+  // most tables are never used, build them on demand
+  node->SetDeferredType(type);
   const char* typeName = node->GetTypeAsString();
   if (strstr(typeName, "Tint") != NULL)
     {
@@ -590,7 +646,7 @@ vtkMRMLColorTableNode* vtkMRMLColorLogic::CreateFreeSurferFileNode(const char* f
     return 0;
     }
 
-  vtkMRMLColorTableNode* node = this->CreateFileNode(fileName);
+  vtkMRMLColorTableNode* node = this->CreateCachedFileNode(fileName);
 
   if (!node)
     {
@@ -653,7 +709,7 @@ vtkMRMLdGEMRICProceduralColorNode* vtkMRMLColorLogic::CreatedGEMRICColorNode(int
 //---------------------------------------------------------------------------------
 vtkMRMLColorTableNode* vtkMRMLColorLogic::CreateDefaultFileNode(const std::string& colorFileName)
 {
-  vtkMRMLColorTableNode* ctnode = this->CreateFileNode(colorFileName.c_str());
+  vtkMRMLColorTableNode* ctnode = this->CreateCachedFileNode(colorFileName.c_str());
 
   if (!ctnode)
     {
@@ -704,9 +760,24 @@ std::vector<std::string> vtkMRMLColorLogic::FindUserColorFiles()
 
 //--------------------------------------------------------------------------------
 vtkMRMLColorTableNode* vtkMRMLColorLogic::CreateFileNode(const char* fileName)
+{
+  return this->CreateFileNode(fileName, false);
+}
+
+//--------------------------------------------------------------------------------
+vtkMRMLColorTableNode* vtkMRMLColorLogic::CreateFileNode(const char* fileName,
+                                                         bool deferRead)
 {
   vtkMRMLColorTableNode * ctnode =  vtkMRMLColorTableNode::New();
-  ctnode->SetTypeToFile();
+  if (deferRead)
+    {
+    // the colors are loaded when first accessed
+    ctnode->SetDeferredType(vtkMRMLColorTableNode::File);
+    }
+  else
+    {
+    ctnode->SetTypeToFile();
+    }
   ctnode->SaveWithSceneOff();
   ctnode->HideFromEditorsOn();
   ctnode->SetScene(this->GetMRMLScene());
@@ -727,7 +798,8 @@ vtkMRMLColorTableNode* vtkMRMLColorLogic::CreateFileNode(const char* fileName)
 
   vtkDebugMacro("CreateFileNode: About to read user file " << fileName);
 
-  if (ctnode->GetStorageNode()->ReadData(ctnode) == 0)
+  if (!deferRead &&
+      ctnode->GetStorageNode()->ReadData(ctnode) == 0)
     {
     vtkErrorMacro("Unable to read file as color table " << (ctnode->GetFileName() ? ctnode->GetFileName() : ""));
 
@@ -748,6 +820,28 @@ vtkMRMLColorTableNode* vtkMRMLColorLogic::CreateFileNode(const char* fileName)
   return ctnode;
 }
 
+//--------------------------------------------------------------------------------
+vtkMRMLColorTableNode* vtkMRMLColorLogic::CreateCachedFileNode(const char* fileName)
+{
+  // Invalid files are not added. The validity of the files is known once
+  // they are read (by the background thread or now), only the colors of
+  // the node are loaded when first accessed.
+  if (!fileName || !this->GetColorFileTable(fileName))
+    {
+    vtkErrorMacro("Unable to read file as color table " << (fileName ? fileName : ""));
+    return 0;
+    }
+  vtkMRMLColorTableNode* ctnode = this->CreateFileNode(fileName, true);
+  if (ctnode)
+    {
+    // provide the colors read by the background thread when needed
+    vtkNew<vtkIntArray> events;
+    events->InsertNextValue(vtkMRMLColorTableNode::LoadDeferredColorsEvent);
+    vtkObserveMRMLNodeEventsMacro(ctnode, events.GetPointer());
+    }
+  return ctnode;
+}
+
 //--------------------------------------------------------------------------------
 vtkMRMLProceduralColorNode* vtkMRMLColorLogic::CreateProceduralFileNode(const char* fileName)
 {
@@ -796,6 +890,11 @@ vtkMRMLProceduralColorNode* vtkMRMLColorLogic::CreateProceduralFileNode(const ch
 //----------------------------------------------------------------------------------------
 void vtkMRMLColorLogic::AddLabelsNode()
 {
+  if (this->IsDefaultColorNodeInScene(
+        this->GetColorTableNodeID(vtkMRMLColorTableNode::Labels)))
+    {
+    return;
+    }
   vtkMRMLColorTableNode* labelsNode = this->CreateLabelsNode();
   //if (this->GetMRMLScene()->GetNodeByID(labelsNode->GetSingletonTag()) == NULL)
     {
@@ -808,6 +907,10 @@ void vtkMRMLColorLogic::AddLabelsNode()
 //----------------------------------------------------------------------------------------
 void vtkMRMLColorLogic::AddDefaultTableNode(int i)
 {
+  if (this->IsDefaultColorNodeInScene(this->GetColorTableNodeID(i)))
+    {
+    return;
+    }
   vtkMRMLColorTableNode* node = this->CreateDefaultTableNode(i);
   //if (node->GetSingletonTag())
     {
@@ -830,19 +933,29 @@ void vtkMRMLColorLogic::AddDefaultTableNode(int i)
 void vtkMRMLColorLogic::AddDefaultProceduralNodes()
 {
   // random one
-  vtkMRMLProceduralColorNode* randomNode = this->CreateRandomNode();
-  this->GetMRMLScene()->AddNode(randomNode);
-  randomNode->Delete();
+  if (!this->IsDefaultColorNodeInScene(this->GetProceduralColorNodeID("RandomIntegers")))
+    {
+    vtkMRMLProceduralColorNode* randomNode = this->CreateRandomNode();
+    this->GetMRMLScene()->AddNode(randomNode);
+    randomNode->Delete();
+    }
 
   // red green blue one
-  vtkMRMLProceduralColorNode* rgbNode = this->CreateRedGreenBlueNode();
-  this->GetMRMLScene()->AddNode(rgbNode);
-  rgbNode->Delete();
+  if (!this->IsDefaultColorNodeInScene(this->GetProceduralColorNodeID("RedGreenBlue")))
+    {
+    vtkMRMLProceduralColorNode* rgbNode = this->CreateRedGreenBlueNode();
+    this->GetMRMLScene()->AddNode(rgbNode);
+    rgbNode->Delete();
+    }
 }
 
 //----------------------------------------------------------------------------------------
 void vtkMRMLColorLogic::AddFreeSurferNode(int type)
 {
+  if (this->IsDefaultColorNodeInScene(this->GetFreeSurferColorNodeID(type)))
+    {
+    return;
+    }
   vtkMRMLFreeSurferProceduralColorNode* node = this->CreateFreeSurferNode(type);
   //if (this->GetMRMLScene()->GetNodeByID(node->GetSingletonTag()) == NULL)
     {
@@ -860,6 +973,11 @@ void vtkMRMLColorLogic::AddFreeSurferNode(int type)
 //----------------------------------------------------------------------------------------
 void vtkMRMLColorLogic::AddFreeSurferFileNode(vtkMRMLFreeSurferProceduralColorNode* basicFSNode)
 {
+  if (this->IsDefaultColorNodeInScene(
+        this->GetColorTableNodeID(vtkMRMLColorTableNode::File)))
+    {
+    return;
+    }
   vtkMRMLColorTableNode* node = this->CreateFreeSurferFileNode(basicFSNode->GetLabelsFileName());
   if (node)
     {
@@ -882,6 +1000,10 @@ void vtkMRMLColorLogic::AddFreeSurferFileNode(vtkMRMLFreeSurferProceduralColorNo
 //----------------------------------------------------------------------------------------
 void vtkMRMLColorLogic::AddPETNode(int type)
 {
+  if (this->IsDefaultColorNodeInScene(this->GetPETColorNodeID(type)))
+    {
+    return;
+    }
   vtkDebugMacro("AddDefaultColorNodes: adding PET nodes");
   vtkMRMLPETProceduralColorNode *nodepcn = this->CreatePETColorNode(type);
   //if (this->GetMRMLScene()->GetNodeByID( nodepcn->GetSingletonTag() ) == NULL)
@@ -895,6 +1017,10 @@ void vtkMRMLColorLogic::AddPETNode(int type)
 //----------------------------------------------------------------------------------------
 void vtkMRMLColorLogic::AddDGEMRICNode(int type)
 {
+  if (this->IsDefaultColorNodeInScene(this->GetdGEMRICColorNodeID(type)))
+    {
+    return;
+    }
   vtkDebugMacro("AddDefaultColorNodes: adding dGEMRIC nodes");
   vtkMRMLdGEMRICProceduralColorNode *pcnode = this->CreatedGEMRICColorNode(type);
   //if (this->GetMRMLScene()->GetNodeByID(pcnode->GetSingletonTag()) == NULL)
@@ -908,6 +1034,10 @@ void vtkMRMLColorLogic::AddDGEMRICNode(int type)
 //----------------------------------------------------------------------------------------
 void vtkMRMLColorLogic::AddDefaultFileNode(int i)
 {
+  if (this->IsDefaultColorNodeInScene(this->GetFileColorNodeID(this->ColorFiles[i].c_str())))
+    {
+    return;
+    }
   vtkMRMLColorTableNode* ctnode =  this->CreateDefaultFileNode(this->ColorFiles[i]);
   if (ctnode)
     {
@@ -932,6 +1062,10 @@ void vtkMRMLColorLogic::AddDefaultFileNode(int i)
 //----------------------------------------------------------------------------------------
 void vtkMRMLColorLogic::AddUserFileNode(int i)
 {
+  if (this->IsDefaultColorNodeInScene(this->GetFileColorNodeID(this->UserColorFiles[i].c_str())))
+    {
+    return;
+    }
   vtkMRMLColorTableNode* ctnode = this->CreateUserFileNode(this->UserColorFiles[i]);
   if (ctnode)
     {
@@ -945,12 +1079,12 @@ void vtkMRMLColorLogic::AddUserFileNode(int i)
     //  {
     //  vtkDebugMacro("AddDefaultColorFiles: node " << ctnode->GetSingletonTag() << " already in scene");
     //  }
+    ctnode->Delete();
     }
   else
     {
     vtkWarningMacro("Unable to read user color file " << this->UserColorFiles[i].c_str());
     }
-  ctnode->Delete();
 }
 
 //----------------------------------------------------------------------------------------
@@ -1013,7 +1147,6 @@ void vtkMRMLColorLogic::AddDGEMRICNodes()
 //----------------------------------------------------------------------------------------
 void vtkMRMLColorLogic::AddDefaultFileNodes()
 {
-  this->ColorFiles = this->FindDefaultColorFiles();
   vtkDebugMacro("AddDefaultColorNodes: found " <<  this->ColorFiles.size() << " default color files");
   for (unsigned int i = 0; i < this->ColorFiles.size(); i++)
     {
@@ -1024,7 +1157,6 @@ void vtkMRMLColorLogic::AddDefaultFileNodes()
 //----------------------------------------------------------------------------------------
 void vtkMRMLColorLogic::AddUserFileNodes()
 {
-  this->UserColorFiles = this->FindUserColorFiles();
   vtkDebugMacro("AddDefaultColorNodes: found " <<  this->UserColorFiles.size() << " user color files");
   for (unsigned int i = 0; i < this->UserColorFiles.size(); i++)
     {
@@ -1033,6 +1165,166 @@ void vtkMRMLColorLogic::AddUserFileNodes()
 
 }
 
+//----------------------------------------------------------------------------------------
+bool vtkMRMLColorLogic::IsDefaultColorNodeInScene(const char* nodeID)
+{
+  // default nodes are singletons, they are kept when the scene is cleared
+  return this->GetMRMLScene() && nodeID &&
+         this->GetMRMLScene()->GetNodeByID(nodeID) != NULL;
+}
+
+//----------------------------------------------------------------------------------------
+void vtkMRMLColorLogic::StartReadingColorFiles(const std::vector<std::string>& fileNames)
+{
+  this->StopReadingColorFiles(false);
+
+  this->ColorFileTablesLock->Lock();
+  this->ColorFilesToRead.clear();
+  for (unsigned int i = 0; i < fileNames.size(); ++i)
+    {
+    long int fileTime = vtksys::SystemTools::ModifiedTime(fileNames[i].c_str());
+    std::map<std::string, ColorFileTable>::iterator it =
+      this->ColorFileTables.find(fileNames[i]);
+    if (it != this->ColorFileTables.end())
+      {
+      if (it->second.State == ColorFileTable::Done &&
+          it->second.FileTime == fileTime)
+        {
+        // already read and unchanged since
+        continue;
+        }
+      if (it->second.Table)
+        {
+        it->second.Table->Delete();
+        }
+      }
+    ColorFileTable& table = this->ColorFileTables[fileNames[i]];
+    table.State = ColorFileTable::Pending;
+    table.FileTime = fileTime;
+    table.Table = 0;
+    this->ColorFilesToRead.push_back(fileNames[i]);
+    }
+  this->AbortReadingColorFiles = false;
+  bool read = !this->ColorFilesToRead.empty();
+  this->ColorFileTablesLock->Unlock();
+
+  if (read)
+    {
+    this->ColorFilesThreadID = this->ColorFilesThreader->SpawnThread(
+      vtkMRMLColorLogic::ReadColorFilesThreaderCallback, this);
+    }
+}
+
+//----------------------------------------------------------------------------------------
+void vtkMRMLColorLogic::StopReadingColorFiles(bool abort)
+{
+  if (this->ColorFilesThreadID < 0)
+    {
+    return;
+    }
+  if (abort)
+    {
+    this->ColorFileTablesLock->Lock();
+    this->AbortReadingColorFiles = true;
+    this->ColorFileTablesLock->Unlock();
+    }
+  // wait for the thread to finish
+  this->ColorFilesThreader->TerminateThread(this->ColorFilesThreadID);
+  this->ColorFilesThreadID = -1;
+}
+
+//----------------------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkMRMLColorLogic::ReadColorFilesThreaderCallback(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkMRMLColorLogic* self = static_cast<vtkMRMLColorLogic*>(info->UserData);
+
+  self->ColorFileTablesLock->Lock();
+  // the list is not modified while the thread is running
+  std::vector<std::string> fileNames = self->ColorFilesToRead;
+  self->ColorFileTablesLock->Unlock();
+
+  for (unsigned int i = 0; i < fileNames.size(); ++i)
+    {
+    self->ColorFileTablesLock->Lock();
+    ColorFileTable& table = self->ColorFileTables[fileNames[i]];
+    if (self->AbortReadingColorFiles)
+      {
+      self->ColorFileTablesLock->Unlock();
+      break;
+      }
+    if (table.State != ColorFileTable::Pending)
+      {
+      // already read by the main thread
+      self->ColorFileTablesLock->Unlock();
+      continue;
+      }
+    table.State = ColorFileTable::Reading;
+    self->ColorFileTablesLock->Unlock();
+
+    vtkMRMLColorTableNode* colors = vtkMRMLColorLogic::ReadColorFileTable(fileNames[i]);
+
+    self->ColorFileTablesLock->Lock();
+    table.Table = colors;
+    table.State = ColorFileTable::Done;
+    self->ColorFileTableRead->Broadcast();
+    self->ColorFileTablesLock->Unlock();
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------------------
+vtkMRMLColorTableNode* vtkMRMLColorLogic::GetColorFileTable(const std::string& fileName)
+{
+  this->ColorFileTablesLock->Lock();
+  std::map<std::string, ColorFileTable>::iterator it =
+    this->ColorFileTables.find(fileName);
+  if (it == this->ColorFileTables.end())
+    {
+    ColorFileTable newTable;
+    newTable.State = ColorFileTable::Pending;
+    newTable.FileTime = vtksys::SystemTools::ModifiedTime(fileName.c_str());
+    newTable.Table = 0;
+    it = this->ColorFileTables.insert(std::make_pair(fileName, newTable)).first;
+    }
+  ColorFileTable& table = it->second;
+  if (table.State == ColorFileTable::Pending)
+    {
+    // not read yet by the thread, don't wait for it
+    table.State = ColorFileTable::Reading;
+    this->ColorFileTablesLock->Unlock();
+    vtkMRMLColorTableNode* colors = vtkMRMLColorLogic::ReadColorFileTable(fileName);
+    this->ColorFileTablesLock->Lock();
+    table.Table = colors;
+    table.State = ColorFileTable::Done;
+    this->ColorFileTableRead->Broadcast();
+    }
+  while (table.State != ColorFileTable::Done)
+    {
+    // being read by the thread, woken up when it is done
+    this->ColorFileTableRead->Wait(this->ColorFileTablesLock);
+    }
+  vtkMRMLColorTableNode* colors = table.Table;
+  this->ColorFileTablesLock->Unlock();
+  return colors;
+}
+
+//----------------------------------------------------------------------------------------
+vtkMRMLColorTableNode* vtkMRMLColorLogic::ReadColorFileTable(const std::string& fileName)
+{
+  // no scene: the node is only used as a template for the scene nodes
+  vtkMRMLColorTableNode* colors = vtkMRMLColorTableNode::New();
+  colors->SetTypeToFile();
+  vtkNew<vtkMRMLColorTableStorageNode> storageNode;
+  storageNode->SetFileName(fileName.c_str());
+  if (storageNode->ReadData(colors) == 0)
+    {
+    colors->Delete();
+    return 0;
+    }
+  return colors;
+}
+
 //----------------------------------------------------------------------------------------
 vtkMRMLColorTableNode* vtkMRMLColorLogic::CopyNode(vtkMRMLColorNode* nodeToCopy, const char* copyName)
 {
@@ -28,8 +28,14 @@ class vtkMRMLPETProceduralColorNode;
 class vtkMRMLdGEMRICProceduralColorNode;
 class vtkMRMLColorTableNode;
 
+// VTK includes
+#include <vtkMultiThreader.h>
+class vtkConditionVariable;
+class vtkMutexLock;
+
 // STD includes
 #include <cstdlib>
+#include <map>
 #include <vector>
 
 /// \brief MRML logic class for color manipulation.
@@ -49,6 +55,10 @@ public:
   /// Each node is a singleton and is not included in a saved scene. The color
   /// node singleton tags are the same as the node IDs:
   /// vtkMRMLColorTableNodeGrey, vtkMRMLPETProceduralColorNodeHeat, etc.
+  /// The nodes already in the scene (singletons are kept when the scene is
+  /// cleared) are not created again. The tables of the built-in types are
+  /// only built when first used and the color files are read once, in a
+  /// background thread, then shared by all the scenes.
   virtual void AddDefaultColorNodes();
 
   /// Remove the colour nodes that were added
@@ -139,6 +149,13 @@ protected:
   /// We add the default LUTs.
   virtual void OnMRMLSceneNewEvent();
 
+  /// Reimplemented to provide the colors of the default color file nodes
+  /// when they are first accessed.
+  /// \sa CreateCachedFileNode()
+  virtual void ProcessMRMLNodesEvents(vtkObject* caller,
+                                      unsigned long event,
+                                      void* callData);
+
   vtkMRMLColorTableNode* CreateLabelsNode();
   vtkMRMLColorTableNode* CreateDefaultTableNode(int type);
   vtkMRMLProceduralColorNode* CreateRandomNode();
@@ -150,6 +167,15 @@ protected:
   vtkMRMLColorTableNode* CreateDefaultFileNode(const std::string& colorname);
   vtkMRMLColorTableNode* CreateUserFileNode(const std::string& colorname);
   vtkMRMLColorTableNode* CreateFileNode(const char* fileName);
+  /// Create a color table node for the file like CreateFileNode(). If
+  /// \a deferRead is true, the file is read when the colors are first
+  /// accessed instead.
+  vtkMRMLColorTableNode* CreateFileNode(const char* fileName, bool deferRead);
+  /// Create a placeholder color table node for the file: the colors are
+  /// copied from GetColorFileTable() when first accessed. Return 0 if the
+  /// file is not a valid color table, which waits for the file to be read
+  /// the first time. Used for the default color files.
+  vtkMRMLColorTableNode* CreateCachedFileNode(const char* fileName);
   vtkMRMLProceduralColorNode* CreateProceduralFileNode(const char* fileName);
 
   void AddLabelsNode();
@@ -172,6 +198,23 @@ protected:
   virtual std::vector<std::string> FindDefaultColorFiles();
   virtual std::vector<std::string> FindUserColorFiles();
 
+  /// Return true if the default color node \a nodeID is already in the
+  /// scene and doesn't need to be created again.
+  bool IsDefaultColorNodeInScene(const char* nodeID);
+
+  /// Start reading the color files in a background thread. The files
+  /// already read are skipped unless they were modified since.
+  void StartReadingColorFiles(const std::vector<std::string>& fileNames);
+  /// Wait for the background thread to finish (or stop it if \a abort).
+  void StopReadingColorFiles(bool abort);
+  /// Return the color table read from the file (read now if the background
+  /// thread didn't get to it yet), 0 if the file is not a valid color table.
+  /// The table is owned by the logic and must not be modified.
+  vtkMRMLColorTableNode* GetColorFileTable(const std::string& fileName);
+  /// Read a color table file without scene. Thread safe.
+  static vtkMRMLColorTableNode* ReadColorFileTable(const std::string& fileName);
+  static VTK_THREAD_RETURN_TYPE ReadColorFilesThreaderCallback(void* arg);
+
   /// Return the ID of a node that doesn't belong to a scene.
   /// It is the concatenation of the node class name and its type.
   static const char * GetColorNodeID(vtkMRMLColorNode* colorNode);
@@ -190,6 +233,32 @@ protected:
   char *UserColorFilePaths;
 
   static std::string TempColorNodeID;
+
+  /// Color table read from a color file
+  struct ColorFileTable
+  {
+    enum
+    {
+      Pending = 0,
+      Reading,
+      Done
+    };
+    int State;
+    /// Modification time of the file when it was read
+    long int FileTime;
+    /// NULL if the file is not a valid color table
+    vtkMRMLColorTableNode* Table;
+  };
+  /// Tables of the color files, kept while the logic exists so that a new
+  /// scene doesn't read the files again. Guarded by ColorFileTablesLock.
+  std::map<std::string, ColorFileTable> ColorFileTables;
+  std::vector<std::string> ColorFilesToRead;
+  bool AbortReadingColorFiles;
+  vtkMutexLock* ColorFileTablesLock;
+  /// Signaled each time a color file is read
+  vtkConditionVariable* ColorFileTableRead;
+  vtkMultiThreader* ColorFilesThreader;
+  int ColorFilesThreadID;
 };
 
 #endif
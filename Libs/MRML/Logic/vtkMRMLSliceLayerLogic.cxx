@@ -683,6 +683,13 @@ void vtkMRMLSliceLayerLogic::UpdateImageDisplay()
   unsigned long oldAssign = this->AssignAttributeTensorsToScalars->GetMTime();
   unsigned long oldLabel = this->LabelOutline->GetMTime();
   unsigned long oldLabelUVW = this->LabelOutlineUVW->GetMTime();
+#if (VTK_MAJOR_VERSION <= 5)
+  vtkImageData* oldSliceImage =
+    volumeDisplayNode ? volumeDisplayNode->GetInputImageData() : 0;
+#else
+  vtkAlgorithmOutput* oldSliceImage =
+    volumeDisplayNode ? volumeDisplayNode->GetInputImageDataConnection() : 0;
+#endif
 
   if ( (this->VolumeNode->GetImageData() && labelMapVolumeDisplayNode) ||
        (scalarVolumeDisplayNode && scalarVolumeDisplayNode->GetInterpolate() == 0))
@@ -860,14 +867,16 @@ void vtkMRMLSliceLayerLogic::UpdateImageDisplay()
     this->Reslice->SetInputData(volumeNode->GetImageData());
     this->ResliceUVW->SetInputData(volumeNode->GetImageData());
 #endif
-    // use the label outline if we have a label map volume, this is the label
-    // layer (turned on in slice logic when the label layer is instantiated)
-    // and the slice node is set to use it.
+    // connect the label outline if we have a label map volume and this is the
+    // label layer (turned on in slice logic when the label layer is
+    // instantiated). The outline stays connected when the slice node doesn't
+    // use it: it is not executed then, and its output is still up-to-date
+    // when the outline is turned back on.
     if (this->GetIsLabelLayer() &&
         labelMapVolumeDisplayNode &&
-        this->SliceNode && this->SliceNode->GetUseLabelOutline() )
+        this->SliceNode)
       {
-      vtkDebugMacro("UpdateImageDisplay: volume node (not diff tensor), using label outline");
+      vtkDebugMacro("UpdateImageDisplay: volume node (not diff tensor), connecting label outline");
 #if (VTK_MAJOR_VERSION <= 5)
       this->LabelOutline->SetInput( this->Reslice->GetOutput() );
 #else
@@ -948,6 +957,11 @@ void vtkMRMLSliceLayerLogic::UpdateImageDisplay()
        oldAssign != this->AssignAttributeTensorsToScalars->GetMTime() ||
        oldLabel != this->LabelOutline->GetMTime() ||
        oldLabelUVW != this->LabelOutlineUVW->GetMTime() ||
+#if (VTK_MAJOR_VERSION <= 5)
+       (volumeDisplayNode != 0 && oldSliceImage != volumeDisplayNode->GetInputImageData()) ||
+#else
+       (volumeDisplayNode != 0 && oldSliceImage != volumeDisplayNode->GetInputImageDataConnection()) ||
+#endif
        (volumeNode != 0 && (volumeNode->GetMTime() > oldReSliceMTime)) ||
        (volumeDisplayNode != 0 && (volumeDisplayNode->GetMTime() > oldReSliceMTime)) ||
        (volumeDisplayNodeUVW != 0 && (volumeDisplayNodeUVW->GetMTime() > oldReSliceUVWMTime))
@@ -34,6 +34,7 @@
 #include <vtkTransform.h>
 
 // STD includes
+#include <algorithm>
 #include <cassert>
 
 
@@ -105,6 +106,28 @@ void vtkMRMLSliceLinkLogic::SetMRMLSceneInternal(vtkMRMLScene * newScene)
 
   this->SetAndObserveMRMLSceneEventsInternal(newScene, events.GetPointer(), priorities.GetPointer());
 
+  this->SliceNodes.clear();
+  this->SliceCompositeNodes.clear();
+  if (newScene)
+    {
+    vtkMRMLNode* node;
+    vtkCollectionSimpleIterator it;
+    vtkCollection* nodes = newScene->GetNodes();
+    for (nodes->InitTraversal(it);
+        (node=vtkMRMLNode::SafeDownCast(nodes->GetNextItemAsObject(it)));)
+      {
+      if (vtkMRMLSliceNode::SafeDownCast(node))
+        {
+        this->SliceNodes.push_back(vtkMRMLSliceNode::SafeDownCast(node));
+        }
+      else if (vtkMRMLSliceCompositeNode::SafeDownCast(node))
+        {
+        this->SliceCompositeNodes.push_back(
+          vtkMRMLSliceCompositeNode::SafeDownCast(node));
+        }
+      }
+    }
+
   this->ProcessMRMLSceneEvents(newScene, vtkCommand::ModifiedEvent, 0);
 }
 
@@ -121,8 +144,22 @@ void vtkMRMLSliceLinkLogic::OnMRMLSceneNodeAdded(vtkMRMLNode* node)
     vtkEventBroker::GetInstance()->AddObservation(
       node, vtkCommand::ModifiedEvent, this, this->GetMRMLNodesCallbackCommand());
 
-    // If sliceNode we insert in our map the current status of the node
     vtkMRMLSliceNode* sliceNode = vtkMRMLSliceNode::SafeDownCast(node);
+    vtkMRMLSliceCompositeNode* compositeNode = vtkMRMLSliceCompositeNode::SafeDownCast(node);
+    if (sliceNode &&
+        std::find(this->SliceNodes.begin(), this->SliceNodes.end(), sliceNode)
+          == this->SliceNodes.end())
+      {
+      this->SliceNodes.push_back(sliceNode);
+      }
+    if (compositeNode &&
+        std::find(this->SliceCompositeNodes.begin(), this->SliceCompositeNodes.end(),
+                  compositeNode) == this->SliceCompositeNodes.end())
+      {
+      this->SliceCompositeNodes.push_back(compositeNode);
+      }
+
+    // If sliceNode we insert in our map the current status of the node
     SliceNodeStatusMap::iterator it = this->SliceNodeInteractionStatus.find(node->GetID());
     if (sliceNode && it == this->SliceNodeInteractionStatus.end())
       {
@@ -145,6 +182,15 @@ void vtkMRMLSliceLinkLogic::OnMRMLSceneNodeRemoved(vtkMRMLNode* node)
     vtkEventBroker::GetInstance()->RemoveObservations(
       node, vtkCommand::ModifiedEvent, this, this->GetMRMLNodesCallbackCommand());
 
+    this->SliceNodes.erase(
+      std::remove(this->SliceNodes.begin(), this->SliceNodes.end(),
+                  vtkMRMLSliceNode::SafeDownCast(node)),
+      this->SliceNodes.end());
+    this->SliceCompositeNodes.erase(
+      std::remove(this->SliceCompositeNodes.begin(), this->SliceCompositeNodes.end(),
+                  vtkMRMLSliceCompositeNode::SafeDownCast(node)),
+      this->SliceCompositeNodes.end());
+
     // Update the map
     vtkMRMLSliceNode* sliceNode = vtkMRMLSliceNode::SafeDownCast(node);
     if (sliceNode)
@@ -319,13 +365,20 @@ void vtkMRMLSliceLinkLogic::BroadcastSliceNodeEvent(vtkMRMLSliceNode *sliceNode)
     {
     this->BroadcastingEventsOn();
 
-    vtkMRMLSliceNode* sNode;
-    vtkCollectionSimpleIterator it;
-    vtkSmartPointer<vtkCollection> nodes;
-    nodes.TakeReference(this->GetMRMLScene()->GetNodesByClass("vtkMRMLSliceNode"));
-    for (nodes->InitTraversal(it);
-        (sNode=vtkMRMLSliceNode::SafeDownCast(nodes->GetNextItemAsObject(it)));)
+    // All the linked nodes are updated before any of them notifies its
+    // observers, and each of them fires a single ModifiedEvent: the slice
+    // logics update their pipeline and request a render once per node.
+    std::vector<vtkSmartPointer<vtkMRMLSliceNode> > nodes(
+      this->SliceNodes.begin(), this->SliceNodes.end());
+    std::vector<int> wasModifying(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i)
       {
+      wasModifying[i] = (nodes[i] != sliceNode ? nodes[i]->StartModify() : 0);
+      }
+
+    for (size_t i = 0; i < nodes.size(); ++i)
+      {
+      vtkMRMLSliceNode* sNode = nodes[i];
       if (sNode != sliceNode)
         {
         // Link slice parameters whenever the reformation is consistent
@@ -475,6 +528,14 @@ void vtkMRMLSliceLinkLogic::BroadcastSliceNodeEvent(vtkMRMLSliceNode *sliceNode)
         }
       }
 
+    for (size_t i = 0; i < nodes.size(); ++i)
+      {
+      if (nodes[i] != sliceNode)
+        {
+        nodes[i]->EndModify(wasModifying[i]);
+        }
+      }
+
     // Update SliceNodeInteractionStatus after MultiplanarReformat interaction
     this->UpdateSliceNodeInteractionStatus(sliceNode);
     this->BroadcastingEventsOff();
@@ -493,14 +554,18 @@ void vtkMRMLSliceLinkLogic::BroadcastSliceCompositeNodeEvent(vtkMRMLSliceComposi
     {
     this->BroadcastingEventsOn();
 
-    vtkMRMLSliceCompositeNode* cNode;
-    vtkCollectionSimpleIterator it;
-    vtkSmartPointer<vtkCollection> nodes;
-    nodes.TakeReference(this->GetMRMLScene()->GetNodesByClass("vtkMRMLSliceCompositeNode"));
+    // Update all the linked nodes before any of them notifies its observers
+    std::vector<vtkSmartPointer<vtkMRMLSliceCompositeNode> > nodes(
+      this->SliceCompositeNodes.begin(), this->SliceCompositeNodes.end());
+    std::vector<int> wasModifying(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i)
+      {
+      wasModifying[i] = (nodes[i] != sliceCompositeNode ? nodes[i]->StartModify() : 0);
+      }
 
-    for (nodes->InitTraversal(it);
-        (cNode=vtkMRMLSliceCompositeNode::SafeDownCast(nodes->GetNextItemAsObject(it)));)
+    for (size_t i = 0; i < nodes.size(); ++i)
       {
+      vtkMRMLSliceCompositeNode* cNode = nodes[i];
       if (cNode != sliceCompositeNode)
         {
         // Foreground selection
@@ -542,6 +607,14 @@ void vtkMRMLSliceLinkLogic::BroadcastSliceCompositeNodeEvent(vtkMRMLSliceComposi
         }
       }
 
+    for (size_t i = 0; i < nodes.size(); ++i)
+      {
+      if (nodes[i] != sliceCompositeNode)
+        {
+        nodes[i]->EndModify(wasModifying[i]);
+        }
+      }
+
     this->BroadcastingEventsOff();
     }
 }
@@ -549,25 +622,18 @@ void vtkMRMLSliceLinkLogic::BroadcastSliceCompositeNodeEvent(vtkMRMLSliceComposi
 //----------------------------------------------------------------------------
 vtkMRMLSliceCompositeNode* vtkMRMLSliceLinkLogic::GetCompositeNode(vtkMRMLSliceNode* sliceNode)
 {
-  vtkMRMLSliceCompositeNode* compositeNode = 0;
-
-  vtkCollectionSimpleIterator it;
-  vtkSmartPointer<vtkCollection> nodes;
-  nodes.TakeReference(this->GetMRMLScene()->GetNodesByClass("vtkMRMLSliceCompositeNode"));
-
-  for (nodes->InitTraversal(it);
-      (compositeNode=vtkMRMLSliceCompositeNode::SafeDownCast(nodes->GetNextItemAsObject(it)));)
+  std::vector<vtkMRMLSliceCompositeNode*>::const_iterator it;
+  for (it = this->SliceCompositeNodes.begin(); it != this->SliceCompositeNodes.end(); ++it)
     {
+    vtkMRMLSliceCompositeNode* compositeNode = *it;
     if (compositeNode->GetLayoutName()
         && !strcmp(compositeNode->GetLayoutName(), sliceNode->GetName()))
       {
-      break;
+      return compositeNode;
       }
-
-    compositeNode = 0;
     }
 
-  return compositeNode;
+  return 0;
 }
 
 //----------------------------------------------------------------------------
@@ -31,6 +31,8 @@
 #include "vtkMRMLAbstractLogic.h"
 
 // STD includes
+#include <map>
+#include <string>
 #include <vector>
 
 class vtkMRMLSliceNode;
@@ -100,6 +102,12 @@ private:
   typedef std::map<std::string, SliceNodeInfos> SliceNodeStatusMap;
   SliceNodeStatusMap SliceNodeInteractionStatus;
 
+  // Slice and slice composite nodes of the scene, maintained on node
+  // added/removed events so that broadcasting does not search the
+  // scene on every interaction event.
+  std::vector<vtkMRMLSliceNode*> SliceNodes;
+  std::vector<vtkMRMLSliceCompositeNode*> SliceCompositeNodes;
+
 };
 
 #endif
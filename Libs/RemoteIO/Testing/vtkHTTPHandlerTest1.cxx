@@ -0,0 +1,491 @@
+// RemoteIO includes
+#include <vtkHTTPHandler.h>
+
+// VTK includes
+#include <vtkClientSocket.h>
+#include <vtkCriticalSection.h>
+#include <vtkMultiThreader.h>
+#include <vtkNew.h>
+#include <vtkServerSocket.h>
+
+// VTKSYS includes
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <cctype>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Minimal HTTP/1.1 server answering GET requests with a single file, one
+// connection at a time. The requests are recorded to check the headers sent
+// by vtkHTTPHandler.
+class vtkHTTPTestServer
+{
+public:
+  enum ModeType
+    {
+    /// 206 for every range, 200 if If-Range doesn't match the ETag
+    SupportRanges,
+    /// 206 for the ranges starting at 0 only, 200 for the others
+    FirstRangeOnly,
+    /// 200 for every request
+    NoRanges,
+    /// like SupportRanges, but the connection is closed in the middle of
+    /// the ranges not starting at 0
+    TruncateRanges
+    };
+
+  struct Request
+    {
+    std::string Range;
+    std::string IfRange;
+    };
+
+  vtkHTTPTestServer()
+    : Mode(SupportRanges), Stopped(false), ThreadID(-1)
+  {}
+
+  bool Start()
+  {
+    if (this->Socket->CreateServer(0) != 0)
+      {
+      return false;
+      }
+    this->ThreadID = this->Threader->SpawnThread(&vtkHTTPTestServer::Run, this);
+    return this->ThreadID >= 0;
+  }
+
+  void Stop()
+  {
+    this->Lock.Lock();
+    this->Stopped = true;
+    this->Lock.Unlock();
+    if (this->ThreadID >= 0)
+      {
+      this->Threader->TerminateThread(this->ThreadID);
+      this->ThreadID = -1;
+      }
+    this->Socket->CloseSocket();
+  }
+
+  std::string URL()
+  {
+    std::stringstream url;
+    url << "http://127.0.0.1:" << this->Socket->GetServerPort() << "/file.raw";
+    return url.str();
+  }
+
+  void SetFile(const std::string& content, const std::string& eTag, int mode)
+  {
+    this->Lock.Lock();
+    this->Content = content;
+    this->ETag = eTag;
+    this->Mode = mode;
+    this->Requests.clear();
+    this->Lock.Unlock();
+  }
+
+  std::vector<Request> GetRequests()
+  {
+    this->Lock.Lock();
+    std::vector<Request> requests = this->Requests;
+    this->Lock.Unlock();
+    return requests;
+  }
+
+protected:
+  static VTK_THREAD_RETURN_TYPE Run(void* arg)
+  {
+    vtkHTTPTestServer* self = static_cast<vtkHTTPTestServer*>(
+      static_cast<vtkMultiThreader::ThreadInfo*>(arg)->UserData);
+    while (true)
+      {
+      self->Lock.Lock();
+      const bool stopped = self->Stopped;
+      self->Lock.Unlock();
+      if (stopped)
+        {
+        break;
+        }
+      vtkClientSocket* client = self->Socket->WaitForConnection(100);
+      if (client)
+        {
+        self->Serve(client);
+        client->CloseSocket();
+        client->Delete();
+        }
+      }
+    return VTK_THREAD_RETURN_VALUE;
+  }
+
+  static std::string HeaderValue(const std::string& request, const std::string& name)
+  {
+    std::istringstream lines(request);
+    std::string line;
+    while (std::getline(lines, line))
+      {
+      const std::string::size_type colon = line.find(':');
+      if (colon == std::string::npos || colon != name.size())
+        {
+        continue;
+        }
+      std::string lineName = line.substr(0, colon);
+      for (size_t i = 0; i < lineName.size(); ++i)
+        {
+        lineName[i] = static_cast<char>(tolower(lineName[i]));
+        }
+      if (lineName != name)
+        {
+        continue;
+        }
+      const std::string::size_type first = line.find_first_not_of(" \t", colon + 1);
+      const std::string::size_type last = line.find_last_not_of(" \t\r");
+      return (first == std::string::npos || last < first) ?
+        std::string() : line.substr(first, last - first + 1);
+      }
+    return std::string();
+  }
+
+  void Serve(vtkClientSocket* client)
+  {
+    std::string requestHeaders;
+    char buffer[1024];
+    while (requestHeaders.find("\r\n\r\n") == std::string::npos)
+      {
+      const int received = client->Receive(buffer, sizeof(buffer), 0);
+      if (received <= 0)
+        {
+        return;
+        }
+      requestHeaders.append(buffer, received);
+      }
+    Request request;
+    request.Range = HeaderValue(requestHeaders, "range");
+    request.IfRange = HeaderValue(requestHeaders, "if-range");
+
+    this->Lock.Lock();
+    this->Requests.push_back(request);
+    const std::string content = this->Content;
+    const std::string eTag = this->ETag;
+    const int mode = this->Mode;
+    this->Lock.Unlock();
+
+    // "bytes=start-" or "bytes=start-end"
+    const long size = static_cast<long>(content.size());
+    long start = 0;
+    long end = size - 1;
+    bool ranged = false;
+    if (request.Range.compare(0, 6, "bytes=") == 0)
+      {
+      std::string range = request.Range.substr(6);
+      const std::string::size_type dash = range.find('-');
+      std::istringstream startStream(range.substr(0, dash));
+      ranged = dash != std::string::npos && (startStream >> start);
+      std::istringstream endStream(
+        dash != std::string::npos ? range.substr(dash + 1) : std::string());
+      if (!(endStream >> end) || end >= size)
+        {
+        end = size - 1;
+        }
+      }
+    ranged = ranged && mode != NoRanges &&
+      (mode != FirstRangeOnly || start == 0) &&
+      (request.IfRange.empty() || request.IfRange == eTag);
+
+    std::stringstream response;
+    std::string body = content;
+    if (ranged && start >= size)
+      {
+      response << "HTTP/1.1 416 Requested Range Not Satisfiable\r\n"
+               << "Content-Range: bytes */" << size << "\r\n";
+      body.clear();
+      }
+    else if (ranged)
+      {
+      response << "HTTP/1.1 206 Partial Content\r\n"
+               << "Content-Range: bytes " << start << "-" << end << "/" << size << "\r\n";
+      body = content.substr(start, end - start + 1);
+      }
+    else
+      {
+      response << "HTTP/1.1 200 OK\r\n";
+      }
+    response << "Content-Length: " << body.size() << "\r\n"
+             << "ETag: " << eTag << "\r\n"
+             << "Accept-Ranges: " << (mode == NoRanges ? "none" : "bytes") << "\r\n"
+             << "Connection: close\r\n\r\n";
+    if (ranged && start > 0 && mode == TruncateRanges)
+      {
+      // the client receives half of the announced body
+      body.resize(body.size() / 2);
+      }
+    const std::string headers = response.str();
+    client->Send(headers.c_str(), static_cast<int>(headers.size()));
+    if (!body.empty())
+      {
+      client->Send(body.c_str(), static_cast<int>(body.size()));
+      }
+  }
+
+  vtkNew<vtkServerSocket> Socket;
+  vtkNew<vtkMultiThreader> Threader;
+  vtkSimpleCriticalSection Lock;
+  std::string Content;
+  std::string ETag;
+  int Mode;
+  bool Stopped;
+  int ThreadID;
+  std::vector<Request> Requests;
+};
+
+//----------------------------------------------------------------------------
+std::string createContent(size_t size, int seed)
+{
+  std::string content(size, '\0');
+  for (size_t i = 0; i < size; ++i)
+    {
+    content[i] = static_cast<char>((i * 7 + seed) % 251);
+    }
+  return content;
+}
+
+//----------------------------------------------------------------------------
+std::string readFile(const std::string& fileName)
+{
+  std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>());
+}
+
+//----------------------------------------------------------------------------
+bool checkDownloadedFile(int line, const std::string& fileName,
+                         const std::string& expectedContent)
+{
+  if (!vtksys::SystemTools::FileExists(fileName.c_str()) ||
+      readFile(fileName) != expectedContent)
+    {
+    std::cerr << "Line " << line << " - " << fileName
+              << " is not downloaded correctly" << std::endl;
+    return false;
+    }
+  if (vtksys::SystemTools::FileExists((fileName + ".part").c_str()) ||
+      vtksys::SystemTools::FileExists((fileName + ".part.ranges").c_str()))
+    {
+    std::cerr << "Line " << line << " - The partial download of " << fileName
+              << " is not removed" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void removeFiles(const std::string& fileName)
+{
+  vtksys::SystemTools::RemoveFile(fileName.c_str());
+  vtksys::SystemTools::RemoveFile((fileName + ".part").c_str());
+  vtksys::SystemTools::RemoveFile((fileName + ".part.ranges").c_str());
+}
+
+//----------------------------------------------------------------------------
+// 1 request of the first 10000 bytes, then 4 parallel ranges with If-Range
+bool testRangedDownload(vtkHTTPTestServer& server, vtkHTTPHandler* handler,
+                        const std::string& fileName)
+{
+  const std::string content = createContent(100000, 1);
+  server.SetFile(content, "\"v1\"", vtkHTTPTestServer::SupportRanges);
+  removeFiles(fileName);
+  handler->StageFileRead(server.URL().c_str(), fileName.c_str());
+  if (!checkDownloadedFile(__LINE__, fileName, content))
+    {
+    return false;
+    }
+  std::vector<vtkHTTPTestServer::Request> requests = server.GetRequests();
+  if (requests.size() != 5 ||
+      requests[0].Range != "bytes=0-9999" || !requests[0].IfRange.empty())
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong first request: "
+              << requests.size() << " requests, first range "
+              << (requests.empty() ? std::string() : requests[0].Range) << std::endl;
+    return false;
+    }
+  for (size_t i = 1; i < requests.size(); ++i)
+    {
+    if (requests[i].Range.compare(0, 6, "bytes=") != 0 ||
+        requests[i].Range == "bytes=0-9999" ||
+        requests[i].IfRange != "\"v1\"")
+      {
+      std::cerr << "Line " << __LINE__ << " - Wrong ranged request: Range: "
+                << requests[i].Range << ", If-Range: " << requests[i].IfRange << std::endl;
+      return false;
+      }
+    }
+
+  // Files smaller than the first range are downloaded at once
+  const std::string smallContent = createContent(5000, 2);
+  server.SetFile(smallContent, "\"v1\"", vtkHTTPTestServer::SupportRanges);
+  removeFiles(fileName);
+  handler->StageFileRead(server.URL().c_str(), fileName.c_str());
+  if (!checkDownloadedFile(__LINE__, fileName, smallContent) ||
+      server.GetRequests().size() != 1)
+    {
+    std::cerr << "Line " << __LINE__ << " - Small file not downloaded at once" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool testServerWithoutRanges(vtkHTTPTestServer& server, vtkHTTPHandler* handler,
+                             const std::string& fileName)
+{
+  // The whole file comes with the first request
+  const std::string content = createContent(100000, 3);
+  server.SetFile(content, "\"v1\"", vtkHTTPTestServer::NoRanges);
+  removeFiles(fileName);
+  handler->StageFileRead(server.URL().c_str(), fileName.c_str());
+  if (!checkDownloadedFile(__LINE__, fileName, content) ||
+      server.GetRequests().size() != 1)
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong download without ranges: "
+              << server.GetRequests().size() << " requests" << std::endl;
+    return false;
+    }
+
+  // The other ranges are answered with the whole file: the file is
+  // downloaded again with a plain request
+  server.SetFile(content, "\"v1\"", vtkHTTPTestServer::FirstRangeOnly);
+  removeFiles(fileName);
+  handler->StageFileRead(server.URL().c_str(), fileName.c_str());
+  std::vector<vtkHTTPTestServer::Request> requests = server.GetRequests();
+  if (!checkDownloadedFile(__LINE__, fileName, content) ||
+      requests.size() < 3 || !requests.back().Range.empty())
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong download with the first range only: "
+              << requests.size() << " requests" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool testResume(vtkHTTPTestServer& server, vtkHTTPHandler* handler,
+                const std::string& fileName)
+{
+  const std::string content = createContent(100000, 4);
+  removeFiles(fileName);
+
+  // The connections are closed in the middle of the ranges
+  server.SetFile(content, "\"v1\"", vtkHTTPTestServer::TruncateRanges);
+  vtkObject::GlobalWarningDisplayOff();
+  handler->StageFileRead(server.URL().c_str(), fileName.c_str());
+  vtkObject::GlobalWarningDisplayOn();
+  if (vtksys::SystemTools::FileExists(fileName.c_str()) ||
+      !vtksys::SystemTools::FileExists((fileName + ".part").c_str()) ||
+      !vtksys::SystemTools::FileExists((fileName + ".part.ranges").c_str()))
+    {
+    std::cerr << "Line " << __LINE__ << " - Partial download not kept" << std::endl;
+    return false;
+    }
+
+  // Only the missing bytes are requested, with If-Range
+  server.SetFile(content, "\"v1\"", vtkHTTPTestServer::SupportRanges);
+  handler->StageFileRead(server.URL().c_str(), fileName.c_str());
+  if (!checkDownloadedFile(__LINE__, fileName, content))
+    {
+    return false;
+    }
+  std::vector<vtkHTTPTestServer::Request> requests = server.GetRequests();
+  if (requests.size() != 4)
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong number of requests to resume: "
+              << requests.size() << std::endl;
+    return false;
+    }
+  for (size_t i = 0; i < requests.size(); ++i)
+    {
+    // the first half of the ranges was received: none starts at a multiple
+    // of the chunk size (10000 + k * 22500)
+    std::istringstream startStream(requests[i].Range.substr(6));
+    long start = 0;
+    startStream >> start;
+    if (requests[i].Range.compare(0, 6, "bytes=") != 0 ||
+        start <= 10000 || (start - 10000) % 22500 == 0 ||
+        requests[i].IfRange != "\"v1\"")
+      {
+      std::cerr << "Line " << __LINE__ << " - Wrong resume request: Range: "
+                << requests[i].Range << ", If-Range: " << requests[i].IfRange << std::endl;
+      return false;
+      }
+    }
+
+  // The file changed since the partial download: If-Range doesn't match
+  // and the new file is downloaded from the start
+  removeFiles(fileName);
+  server.SetFile(content, "\"v1\"", vtkHTTPTestServer::TruncateRanges);
+  vtkObject::GlobalWarningDisplayOff();
+  handler->StageFileRead(server.URL().c_str(), fileName.c_str());
+  vtkObject::GlobalWarningDisplayOn();
+  const std::string modifiedContent = createContent(100000, 5);
+  server.SetFile(modifiedContent, "\"v2\"", vtkHTTPTestServer::SupportRanges);
+  handler->StageFileRead(server.URL().c_str(), fileName.c_str());
+  if (!checkDownloadedFile(__LINE__, fileName, modifiedContent))
+    {
+    return false;
+    }
+  requests = server.GetRequests();
+  if (requests.empty() || requests[0].IfRange != "\"v1\"" ||
+      requests.back().IfRange != "\"v2\"")
+    {
+    std::cerr << "Line " << __LINE__ << " - Modified file not downloaded again"
+              << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int main(int argc, char * argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: vtkHTTPHandlerTest1 temporaryDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+#if !defined(_WIN32)
+  // the server writes to connections closed by the client
+  signal(SIGPIPE, SIG_IGN);
+#endif
+  vtksys::SystemTools::MakeDirectory(argv[1]);
+  const std::string fileName = std::string(argv[1]) + "/vtkHTTPHandlerTest1.raw";
+
+  vtkHTTPTestServer server;
+  if (!server.Start())
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to start the server" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkHTTPHandler> handler;
+  handler->SetNumberOfConnections(4);
+  handler->SetMinimumChunkedFileSize(10000);
+
+  bool res = testRangedDownload(server, handler.GetPointer(), fileName);
+  res = testServerWithoutRanges(server, handler.GetPointer(), fileName) && res;
+  res = testResume(server, handler.GetPointer(), fileName) && res;
+
+  server.Stop();
+  removeFiles(fileName);
+  return res ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,17 +1,235 @@
-
 // RemoteIO includes
 #include "vtkHTTPHandler.h"
 
 // MRML includes
 #include <vtkPermissionPrompter.h>
 
+// VTK includes
+#include <vtkCriticalSection.h>
+
+// VTKSYS includes
+#include <vtksys/SystemTools.hxx>
+
 // CURL includes
 #include <curl/curl.h>
 
+// STD includes
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/select.h>
+#include <sys/time.h>
+#endif
+
 #if defined(_MSC_VER)
 #pragma warning ( disable : 4786 )
 #endif
 
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Byte range of a file downloaded by one request.
+struct vtkHTTPChunk
+{
+  vtkHTTPChunk(vtkTypeInt64 start, vtkTypeInt64 end)
+    : Start(start), End(end), Offset(start), Ranged(false), Probe(false),
+      RangeIgnored(false), TotalSize(-1), Handle(NULL), Headers(NULL),
+      File(NULL), Result(CURLE_OK)
+  {}
+  vtkTypeInt64 Start;
+  /// Last byte of the chunk, -1 if the size of the file is unknown
+  vtkTypeInt64 End;
+  /// Position of the next byte to write
+  vtkTypeInt64 Offset;
+  /// True if a Range header is sent
+  bool Ranged;
+  /// True for the first request of a download: the server may answer it
+  /// with the whole file.
+  bool Probe;
+  /// True if the server answered a ranged request with the whole file
+  bool RangeIgnored;
+  /// Size of the file from the Content-Range header, -1 if unknown
+  vtkTypeInt64 TotalSize;
+  /// ETag header of the response
+  std::string ETag;
+  CURL* Handle;
+  curl_slist* Headers;
+  FILE* File;
+  CURLcode Result;
+
+  bool IsComplete()const
+  {
+    return this->End >= 0 ? this->Offset > this->End : this->Result == CURLE_OK;
+  }
+};
+
+//----------------------------------------------------------------------------
+bool SeekFile(FILE* file, vtkTypeInt64 offset)
+{
+#if defined(_MSC_VER)
+  return _fseeki64(file, offset, SEEK_SET) == 0;
+#elif defined(_WIN32)
+  return fseeko64(file, offset, SEEK_SET) == 0;
+#else
+  return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+//----------------------------------------------------------------------------
+// Chunks share the output file but are written from the thread running the
+// multi handle only, so seeking before writing is safe.
+size_t WriteChunkCallback(void *ptr, size_t size, size_t nmemb, void *data)
+{
+  vtkHTTPChunk* chunk = static_cast<vtkHTTPChunk*>(data);
+  if (chunk->Ranged)
+    {
+    long responseCode = 0;
+    curl_easy_getinfo(chunk->Handle, CURLINFO_RESPONSE_CODE, &responseCode);
+    if (responseCode == 200 && chunk->Probe && chunk->Offset == 0)
+      {
+      // no range support: the whole file comes with the first request
+      chunk->Ranged = false;
+      chunk->End = -1;
+      }
+    else if (responseCode == 416 && chunk->Probe)
+      {
+      // error page of an empty file, see DownloadChunks()
+      return size * nmemb;
+      }
+    else if (responseCode != 206)
+      {
+      // a whole file (or another version of it if If-Range did not match)
+      // would be written at the offset of the chunk
+      chunk->RangeIgnored = (responseCode == 200);
+      return 0;
+      }
+    }
+  const size_t bytes = size * nmemb;
+  if (!SeekFile(chunk->File, chunk->Offset))
+    {
+    return 0;
+    }
+  const size_t written = fwrite(ptr, 1, bytes, chunk->File);
+  chunk->Offset += written;
+  return written;
+}
+
+//----------------------------------------------------------------------------
+size_t HeaderCallback(void *ptr, size_t size, size_t nmemb, void *data)
+{
+  vtkHTTPChunk* chunk = static_cast<vtkHTTPChunk*>(data);
+  const size_t bytes = size * nmemb;
+  const std::string header(static_cast<char*>(ptr), bytes);
+  const std::string::size_type colon = header.find(':');
+  std::string name = header.substr(0, colon);
+  for (size_t i = 0; i < name.size(); ++i)
+    {
+    name[i] = static_cast<char>(tolower(name[i]));
+    }
+  if (name.compare(0, 5, "http/") == 0)
+    {
+    // status line of a new response (e.g. after a redirection)
+    chunk->TotalSize = -1;
+    chunk->ETag.clear();
+    return bytes;
+    }
+  if (colon == std::string::npos)
+    {
+    return bytes;
+    }
+  const std::string::size_type first = header.find_first_not_of(" \t", colon + 1);
+  const std::string::size_type last = header.find_last_not_of(" \t\r\n");
+  const std::string value = (first == std::string::npos || last < first) ?
+    std::string() : header.substr(first, last - first + 1);
+  if (name == "etag")
+    {
+    chunk->ETag = value;
+    }
+  else if (name == "content-range")
+    {
+    // "bytes first-last/size" or "bytes */size", size is "*" if unknown
+    const std::string::size_type slash = value.find('/');
+    std::istringstream totalSizeStream(
+      slash != std::string::npos ? value.substr(slash + 1) : std::string());
+    vtkTypeInt64 totalSize = -1;
+    if ((totalSizeStream >> totalSize) && totalSize >= 0)
+      {
+      chunk->TotalSize = totalSize;
+      if (chunk->End >= totalSize)
+        {
+        chunk->End = totalSize - 1;
+        }
+      }
+    }
+  return bytes;
+}
+
+//----------------------------------------------------------------------------
+// Run the transfers of the multi handle until they are all done.
+bool PerformMulti(CURLM* multi)
+{
+  int running = 1;
+  while (running)
+    {
+    if (curl_multi_perform(multi, &running) != CURLM_OK)
+      {
+      return false;
+      }
+    if (!running)
+      {
+      break;
+      }
+#if LIBCURL_VERSION_NUM >= 0x071C00
+    int numberOfFds = 0;
+    if (curl_multi_wait(multi, NULL, 0, 1000, &numberOfFds) != CURLM_OK)
+      {
+      return false;
+      }
+#else
+    fd_set readFds, writeFds, exceptionFds;
+    FD_ZERO(&readFds);
+    FD_ZERO(&writeFds);
+    FD_ZERO(&exceptionFds);
+    int maxFd = -1;
+    long timeout = -1;
+    curl_multi_timeout(multi, &timeout);
+    if (timeout < 0 || timeout > 1000)
+      {
+      timeout = 1000;
+      }
+    curl_multi_fdset(multi, &readFds, &writeFds, &exceptionFds, &maxFd);
+    if (maxFd == -1)
+      {
+      // nothing to wait on yet (e.g. name resolution)
+#if defined(_WIN32)
+      Sleep(timeout < 100 ? timeout : 100);
+#else
+      struct timeval wait = {0, (timeout < 100 ? timeout : 100) * 1000};
+      select(0, NULL, NULL, NULL, &wait);
+#endif
+      }
+    else
+      {
+      struct timeval wait;
+      wait.tv_sec = timeout / 1000;
+      wait.tv_usec = (timeout % 1000) * 1000;
+      select(maxFd + 1, &readFds, &writeFds, &exceptionFds, &wait);
+      }
+#endif
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 class vtkHTTPHandler::vtkInternal
 {
@@ -19,9 +237,35 @@ public:
   vtkInternal(vtkHTTPHandler* external);
   ~vtkInternal();
 
+  /// Multi handles keep the connections open between transfers. Each
+  /// thread downloading a file takes one from the pool and gives it back.
+  CURLM* AcquireMultiHandle();
+  void ReleaseMultiHandle(CURLM* multi);
+
+  CURL* NewEasyHandle(const char* url);
+
+  /// Download the chunks (all at once) and return the first error.
+  /// Ranged requests are sent with If-Range: eTag if eTag is not empty.
+  CURLcode DownloadChunks(CURLM* multi, const char* url, FILE* file,
+                          const std::string& eTag,
+                          std::vector<vtkHTTPChunk>& chunks);
+
+  /// Chunks of a partial download: "size numberOfChunks", the ETag of the
+  /// file, then "start end offset" per chunk.
+  static bool ReadChunks(const std::string& fileName, vtkTypeInt64& size,
+                         std::string& eTag, std::vector<vtkHTTPChunk>& chunks);
+  static void WriteChunks(const std::string& fileName, vtkTypeInt64 size,
+                          const std::string& eTag,
+                          const std::vector<vtkHTTPChunk>& chunks);
+
   vtkHTTPHandler* External;
   CURL* CurlHandle;
   int ForbidReuse;
+  int NumberOfConnections;
+  double MinimumChunkedFileSize;
+
+  vtkSimpleCriticalSection MultiHandlesLock;
+  std::vector<CURLM*> MultiHandles;
 };
 
 //----------------------------------------------------------------------------
@@ -32,12 +276,210 @@ vtkHTTPHandler::vtkInternal::vtkInternal(vtkHTTPHandler* external):External(exte
 {
   this->CurlHandle = NULL;
   this->ForbidReuse = 0;
+  this->NumberOfConnections = 4;
+  this->MinimumChunkedFileSize = 8 * 1024 * 1024;
+  // not thread safe, done once here instead of for each transfer
+  curl_global_init(CURL_GLOBAL_ALL);
 }
 
 //-----------------------------------------------------------------------------
 vtkHTTPHandler::vtkInternal::~vtkInternal()
 {
   this->CurlHandle = NULL;
+  for (size_t i = 0; i < this->MultiHandles.size(); ++i)
+    {
+    curl_multi_cleanup(this->MultiHandles[i]);
+    }
+}
+
+//----------------------------------------------------------------------------
+CURLM* vtkHTTPHandler::vtkInternal::AcquireMultiHandle()
+{
+  CURLM* multi = NULL;
+  this->MultiHandlesLock.Lock();
+  if (!this->MultiHandles.empty())
+    {
+    multi = this->MultiHandles.back();
+    this->MultiHandles.pop_back();
+    }
+  this->MultiHandlesLock.Unlock();
+  if (multi == NULL)
+    {
+    multi = curl_multi_init();
+    }
+  return multi;
+}
+
+//----------------------------------------------------------------------------
+void vtkHTTPHandler::vtkInternal::ReleaseMultiHandle(CURLM* multi)
+{
+  this->MultiHandlesLock.Lock();
+  this->MultiHandles.push_back(multi);
+  this->MultiHandlesLock.Unlock();
+}
+
+//----------------------------------------------------------------------------
+CURL* vtkHTTPHandler::vtkInternal::NewEasyHandle(const char* url)
+{
+  CURL* handle = curl_easy_init();
+  if (handle == NULL)
+    {
+    return NULL;
+    }
+  if (this->ForbidReuse)
+    {
+    curl_easy_setopt(handle, CURLOPT_FORBID_REUSE, 1L);
+    }
+  curl_easy_setopt(handle, CURLOPT_URL, url);
+  curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L);
+  // quick timeout during connection phase if URL is not accessible (e.g. blocked by a firewall)
+  curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT, 3L); // in seconds (type long)
+  // signals can't be used from the networking threads
+  curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+  return handle;
+}
+
+//----------------------------------------------------------------------------
+CURLcode vtkHTTPHandler::vtkInternal::DownloadChunks(CURLM* multi, const char* url,
+                                                     FILE* file,
+                                                     const std::string& eTag,
+                                                     std::vector<vtkHTTPChunk>& chunks)
+{
+  std::vector<vtkHTTPChunk*> running;
+  for (size_t i = 0; i < chunks.size(); ++i)
+    {
+    vtkHTTPChunk& chunk = chunks[i];
+    if (chunk.IsComplete() && chunk.End >= 0)
+      {
+      continue;
+      }
+    chunk.File = file;
+    chunk.Result = CURLE_OK;
+    chunk.Handle = this->NewEasyHandle(url);
+    if (chunk.Handle == NULL)
+      {
+      chunk.Result = CURLE_FAILED_INIT;
+      continue;
+      }
+    curl_easy_setopt(chunk.Handle, CURLOPT_HTTPGET, 1L);
+    curl_easy_setopt(chunk.Handle, CURLOPT_WRITEFUNCTION, WriteChunkCallback);
+    curl_easy_setopt(chunk.Handle, CURLOPT_WRITEDATA, &chunk);
+    curl_easy_setopt(chunk.Handle, CURLOPT_HEADERFUNCTION, HeaderCallback);
+    curl_easy_setopt(chunk.Handle, CURLOPT_HEADERDATA, &chunk);
+    curl_easy_setopt(chunk.Handle, CURLOPT_PRIVATE, &chunk);
+    if (chunk.Ranged)
+      {
+      std::stringstream range;
+      range << chunk.Offset << "-";
+      if (chunk.End >= 0)
+        {
+        range << chunk.End;
+        }
+      curl_easy_setopt(chunk.Handle, CURLOPT_RANGE, range.str().c_str());
+      if (!eTag.empty())
+        {
+        // the server sends the whole file instead of the range if the file
+        // changed since the download started
+        chunk.Headers = curl_slist_append(NULL, ("If-Range: " + eTag).c_str());
+        curl_easy_setopt(chunk.Handle, CURLOPT_HTTPHEADER, chunk.Headers);
+        }
+      }
+    curl_multi_add_handle(multi, chunk.Handle);
+    running.push_back(&chunk);
+    }
+
+  CURLcode error = PerformMulti(multi) ? CURLE_OK : CURLE_RECV_ERROR;
+  int numberOfMessages = 0;
+  while (CURLMsg* message = curl_multi_info_read(multi, &numberOfMessages))
+    {
+    if (message->msg != CURLMSG_DONE)
+      {
+      continue;
+      }
+    vtkHTTPChunk* chunk = NULL;
+    curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, reinterpret_cast<char**>(&chunk));
+    if (chunk)
+      {
+      chunk->Result = message->data.result;
+      long responseCode = 0;
+      curl_easy_getinfo(message->easy_handle, CURLINFO_RESPONSE_CODE, &responseCode);
+      if (responseCode == 416 && chunk->Probe && chunk->TotalSize == 0)
+        {
+        // no range can be satisfied in an empty file
+        chunk->End = -1;
+        }
+      else if (chunk->Result == CURLE_OK && responseCode >= 400)
+        {
+        chunk->Result = CURLE_HTTP_RETURNED_ERROR;
+        }
+      }
+    }
+  for (size_t i = 0; i < running.size(); ++i)
+    {
+    curl_multi_remove_handle(multi, running[i]->Handle);
+    curl_easy_cleanup(running[i]->Handle);
+    running[i]->Handle = NULL;
+    curl_slist_free_all(running[i]->Headers);
+    running[i]->Headers = NULL;
+    if (error == CURLE_OK && running[i]->Result != CURLE_OK)
+      {
+      error = running[i]->Result;
+      }
+    else if (error == CURLE_OK && !running[i]->IsComplete())
+      {
+      error = CURLE_PARTIAL_FILE;
+      }
+    }
+  return error;
+}
+
+//----------------------------------------------------------------------------
+bool vtkHTTPHandler::vtkInternal::ReadChunks(const std::string& fileName,
+                                             vtkTypeInt64& size, std::string& eTag,
+                                             std::vector<vtkHTTPChunk>& chunks)
+{
+  std::ifstream input(fileName.c_str());
+  vtkTypeInt64 savedSize = -1;
+  size_t numberOfChunks = 0;
+  std::string savedETag;
+  if (!(input >> savedSize >> numberOfChunks) || savedSize <= 0 ||
+      !std::getline(input, savedETag) || !std::getline(input, savedETag) ||
+      savedETag.empty())
+    {
+    // without an ETag, the .part file may not belong to the current file
+    return false;
+    }
+  std::vector<vtkHTTPChunk> savedChunks;
+  for (size_t i = 0; i < numberOfChunks; ++i)
+    {
+    vtkTypeInt64 start = 0, end = 0, offset = 0;
+    if (!(input >> start >> end >> offset) || offset < start || offset > end + 1 ||
+        end >= savedSize)
+      {
+      return false;
+      }
+    savedChunks.push_back(vtkHTTPChunk(start, end));
+    savedChunks.back().Offset = offset;
+    savedChunks.back().Ranged = true;
+    }
+  size = savedSize;
+  eTag = savedETag;
+  chunks = savedChunks;
+  return !chunks.empty();
+}
+
+//----------------------------------------------------------------------------
+void vtkHTTPHandler::vtkInternal::WriteChunks(const std::string& fileName,
+                                              vtkTypeInt64 size,
+                                              const std::string& eTag,
+                                              const std::vector<vtkHTTPChunk>& chunks)
+{
+  std::ofstream output(fileName.c_str());
+  output << size << " " << chunks.size() << "\n" << eTag << "\n";
+  for (size_t i = 0; i < chunks.size(); ++i)
+    {
+    output << chunks[i].Start << " " << chunks[i].End << " " << chunks[i].Offset << "\n";
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -107,6 +549,9 @@ vtkHTTPHandler::~vtkHTTPHandler()
 void vtkHTTPHandler::PrintSelf(ostream& os, vtkIndent indent)
 {
   Superclass::PrintSelf ( os, indent );
+  os << indent << "ForbidReuse: " << this->Internal->ForbidReuse << "\n";
+  os << indent << "NumberOfConnections: " << this->Internal->NumberOfConnections << "\n";
+  os << indent << "MinimumChunkedFileSize: " << this->Internal->MinimumChunkedFileSize << "\n";
 }
 
 //----------------------------------------------------------------------------
@@ -183,54 +628,175 @@ int vtkHTTPHandler::CloseTransfer( )
 
 
 //----------------------------------------------------------------------------
-void vtkHTTPHandler::StageFileRead(const char * source, const char * destination)
+void vtkHTTPHandler::SetNumberOfConnections(int value)
 {
-  if (source == NULL || destination == NULL)
+  value = value < 1 ? 1 : value;
+  if (this->Internal->NumberOfConnections == value)
     {
-    vtkErrorMacro("StageFileRead: source or dest is null!");
     return;
     }
-  /*
-  if (this->LocalFile)
+  this->Internal->NumberOfConnections = value;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkHTTPHandler::GetNumberOfConnections()
+{
+  return this->Internal->NumberOfConnections;
+}
+
+//----------------------------------------------------------------------------
+void vtkHTTPHandler::SetMinimumChunkedFileSize(double value)
+{
+  if (this->Internal->MinimumChunkedFileSize == value)
     {
-    this->LocalFile->close();
-    delete this->LocalFile;
-    this->LocalFile = NULL;
+    return;
     }
-  this->LocalFile = new std::ofstream(destination, std::ios::binary);
-  */
-  this->InitTransfer( );
+  this->Internal->MinimumChunkedFileSize = value;
+  this->Modified();
+}
 
+//----------------------------------------------------------------------------
+double vtkHTTPHandler::GetMinimumChunkedFileSize()
+{
+  return this->Internal->MinimumChunkedFileSize;
+}
 
-  if ( this->Internal->ForbidReuse )
+//----------------------------------------------------------------------------
+void vtkHTTPHandler::StageFileRead(const char * source, const char * destination)
+{
+  if (source == NULL || destination == NULL)
     {
-    curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_FORBID_REUSE, 1);
+    vtkErrorMacro("StageFileRead: source or dest is null!");
+    return;
     }
-  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_HTTPGET, 1);
-  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_URL, source);
-//  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_NOPROGRESS, false);
-  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_FOLLOWLOCATION, true);
-  // use the default curl write call back
-  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_WRITEFUNCTION, NULL); // write_callback);
-  this->LocalFile = fopen(destination, "wb");
-  // output goes into LocalFile, must be  FILE*
-  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_WRITEDATA, this->LocalFile);
-//  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_PROGRESSDATA, NULL);
-//  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_PROGRESSFUNCTION, ProgressCallback);
-
-  // quick timeout during connection phase if URL is not accessible (e.g. blocked by a firewall)
-  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_CONNECTTIMEOUT, 3); // in seconds (type long)
+  // Several networking threads may download at the same time: all the
+  // state of the transfer is local.
+  CURLM* multi = this->Internal->AcquireMultiHandle();
+  if (multi == NULL)
+    {
+    vtkErrorMacro("StageFileRead: unable to initialise");
+    return;
+    }
+  const int numberOfConnections = this->Internal->NumberOfConnections;
+  curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, static_cast<long>(numberOfConnections));
+
+  const std::string partFileName = std::string(destination) + ".part";
+  const std::string rangesFileName = partFileName + ".ranges";
+
+  // The first request asks for the first MinimumChunkedFileSize bytes:
+  // smaller files are downloaded at once, Content-Range gives the size of
+  // the others whose remaining bytes are downloaded in parallel.
+  vtkTypeInt64 firstChunkSize =
+    static_cast<vtkTypeInt64>(this->Internal->MinimumChunkedFileSize);
+  firstChunkSize = firstChunkSize < 1 ? 1 : firstChunkSize;
+
+  CURLcode retval = CURLE_OK;
+  bool resume = vtksys::SystemTools::FileExists(partFileName.c_str());
+  bool useRanges = true;
+  for (int attempt = 0; attempt < 3; ++attempt)
+    {
+    vtkTypeInt64 size = -1;
+    std::string eTag;
+    std::vector<vtkHTTPChunk> chunks;
+    resume = resume && vtkInternal::ReadChunks(rangesFileName, size, eTag, chunks);
+    vtksys::SystemTools::RemoveFile(rangesFileName.c_str());
+
+    FILE* partFile = fopen(partFileName.c_str(), resume ? "r+b" : "wb");
+    if (partFile == NULL)
+      {
+      vtkErrorMacro("StageFileRead: unable to open " << partFileName);
+      this->Internal->ReleaseMultiHandle(multi);
+      return;
+      }
+    vtkDebugMacro("StageFileRead: about to do the curl download... source = " << source
+                  << ", dest = " << destination << (resume ? ", resuming" : ""));
+    retval = CURLE_OK;
+    if (!resume)
+      {
+      chunks.push_back(vtkHTTPChunk(0, useRanges ? firstChunkSize - 1 : -1));
+      chunks.back().Ranged = useRanges;
+      chunks.back().Probe = true;
+      retval = this->Internal->DownloadChunks(multi, source, partFile, std::string(), chunks);
+      const vtkHTTPChunk firstChunk = chunks.back();
+      size = firstChunk.TotalSize;
+      // weak ETags can't be used with If-Range
+      eTag = firstChunk.ETag.compare(0, 2, "W/") == 0 ? std::string() : firstChunk.ETag;
+      if (retval == CURLE_OK && firstChunk.Ranged && firstChunk.End >= 0 &&
+          (size < 0 || size > firstChunk.End + 1))
+        {
+        const vtkTypeInt64 start = firstChunk.End + 1;
+        const vtkTypeInt64 remaining = size - start;
+        const int numberOfChunks = (size < 0 || remaining < numberOfConnections) ?
+          1 : numberOfConnections;
+        const vtkTypeInt64 chunkSize = remaining / numberOfChunks;
+        for (int i = 0; i < numberOfChunks; ++i)
+          {
+          const vtkTypeInt64 end = size < 0 ? -1 :
+            (i == numberOfChunks - 1) ? size - 1 : start + (i + 1) * chunkSize - 1;
+          chunks.push_back(vtkHTTPChunk(start + i * chunkSize, end));
+          chunks.back().Ranged = true;
+          }
+        }
+      }
+    if (retval == CURLE_OK && (resume || chunks.size() > 1))
+      {
+      // complete chunks are skipped
+      vtkDebugMacro("StageFileRead: downloading the remaining ranges of " << source);
+      retval = this->Internal->DownloadChunks(multi, source, partFile, eTag, chunks);
+      }
+    fclose(partFile);
 
-  vtkDebugMacro("StageFileRead: about to do the curl download... source = " << source << ", dest = " << destination);
-  CURLcode retval = curl_easy_perform(this->Internal->CurlHandle);
+    bool rangeIgnored = false;
+    for (size_t i = 0; i < chunks.size(); ++i)
+      {
+      rangeIgnored = rangeIgnored || chunks[i].RangeIgnored;
+      }
+    if (rangeIgnored)
+      {
+      vtksys::SystemTools::RemoveFile(partFileName.c_str());
+      if (resume)
+        {
+        // the file changed since the partial download: start over
+        vtkDebugMacro("StageFileRead: " << source << " was modified, downloading it again");
+        resume = false;
+        }
+      else
+        {
+        // the server accepts the first range only: start over with a
+        // single plain request
+        vtkDebugMacro("StageFileRead: range requests not honored, downloading " << source
+                      << " sequentially");
+        useRanges = false;
+        }
+      continue;
+      }
+    if (retval != CURLE_OK && size > 0 && !eTag.empty())
+      {
+      vtkInternal::WriteChunks(rangesFileName, size, eTag, chunks);
+      }
+    else if (retval != CURLE_OK)
+      {
+      // without the size and the ETag of the file, the download can't be
+      // safely resumed
+      vtksys::SystemTools::RemoveFile(partFileName.c_str());
+      }
+    break;
+    }
+  this->Internal->ReleaseMultiHandle(multi);
 
   if (retval == CURLE_OK)
     {
     vtkDebugMacro("StageFileRead: successful return from curl");
+    vtksys::SystemTools::RemoveFile(destination);
+    if (rename(partFileName.c_str(), destination) != 0)
+      {
+      vtkErrorMacro("StageFileRead: unable to rename " << partFileName << " into " << destination);
+      }
     }
   else if (retval == CURLE_BAD_FUNCTION_ARGUMENT)
     {
-    vtkErrorMacro("StageFileRead: bad function argument to curl, did you init CurlHandle?");
+    vtkErrorMacro("StageFileRead: bad function argument to curl");
     }
   else if (retval == CURLE_OUT_OF_MEMORY)
     {
@@ -249,17 +815,6 @@ void vtkHTTPHandler::StageFileRead(const char * source, const char * destination
       this->GetPermissionPrompter()->SetRemember ( 0 );
       }
     }
-  this->CloseTransfer();
-
-  /*
-  this->LocalFile->close();
-  delete this->LocalFile;
-  this->LocalFile = NULL;
-  */
-  if (this->LocalFile)
-    {
-    fclose(this->LocalFile);
-    }
 }
 
 
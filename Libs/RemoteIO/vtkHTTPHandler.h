@@ -32,7 +32,26 @@ public:
   void SetForbidReuse(int value);
   int GetForbidReuse();
 
+  /// Number of parallel HTTP range requests used to download a large file
+  /// from a server that accepts ranges. 4 by default.
+  void SetNumberOfConnections(int value);
+  int GetNumberOfConnections();
+
+  /// Size (in bytes) of the first range requested: files smaller than this
+  /// size are downloaded with a single request. 8MB by default.
+  void SetMinimumChunkedFileSize(double value);
+  double GetMinimumChunkedFileSize();
+
   /// This function wraps curl functionality to download a specified URL to a specified dir
+  /// The first request is a ranged GET whose Content-Range header gives the
+  /// size of the file, the rest is downloaded in parallel ranges. Servers
+  /// ignoring ranges send the whole file in answer to the first request.
+  /// The data is downloaded in destination.part, renamed destination once
+  /// complete. If the download fails, the next call resumes it where it
+  /// stopped if the server sent an ETag: the ranges are requested with
+  /// If-Range and the download starts over if the file was modified.
+  /// Connections are kept open between calls and it can be called from
+  /// several threads at once.
   void StageFileRead(const char * source, const char * destination);
   using vtkURIHandler::StageFileRead;
   void StageFileWrite(const char * source, const char * destination);
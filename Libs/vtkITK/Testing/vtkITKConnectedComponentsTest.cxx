@@ -0,0 +1,251 @@
+
+// vtkITK includes
+#include <vtkITKConnectedComponents.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMultiThreader.h>
+#include <vtkNew.h>
+#include <vtkTimerLog.h>
+#include <vtkTypeUInt32Array.h>
+#include <vtkVersion.h>
+
+// STD includes
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+void AllocateImage(vtkImageData* image, int dim, int scalarType)
+{
+  image->SetDimensions(dim, dim, dim);
+#if (VTK_MAJOR_VERSION <= 5)
+  image->SetScalarType(scalarType);
+  image->SetNumberOfScalarComponents(1);
+  image->AllocateScalars();
+#else
+  image->AllocateScalars(scalarType, 1);
+#endif
+}
+
+//----------------------------------------------------------------------------
+// Straightforward flood fill seeded in raster order: gives the labels
+// vtkITKConnectedComponents must output. Slices are orthogonal to
+// sliceAxis, -1 for 3D connectivity.
+void ReferenceLabels(unsigned char* values, int dim, bool fullyConnected,
+                     int sliceAxis, std::vector<vtkTypeUInt32>& labels,
+                     std::vector<vtkIdType>& sizes)
+{
+  const vtkIdType numberOfVoxels = static_cast<vtkIdType>(dim) * dim * dim;
+  labels.assign(numberOfVoxels, 0);
+  sizes.assign(1, 0);
+  std::vector<vtkIdType> stack;
+  for (vtkIdType seed = 0; seed < numberOfVoxels; ++seed)
+    {
+    if (values[seed] == 0 || labels[seed] != 0)
+      {
+      continue;
+      }
+    const vtkTypeUInt32 label = static_cast<vtkTypeUInt32>(sizes.size());
+    sizes.push_back(0);
+    labels[seed] = label;
+    stack.push_back(seed);
+    while (!stack.empty())
+      {
+      const vtkIdType voxel = stack.back();
+      stack.pop_back();
+      ++sizes[label];
+      const int x = voxel % dim;
+      const int y = (voxel / dim) % dim;
+      const int z = voxel / (static_cast<vtkIdType>(dim) * dim);
+      for (int dz = -1; dz <= 1; ++dz)
+        {
+        for (int dy = -1; dy <= 1; ++dy)
+          {
+          for (int dx = -1; dx <= 1; ++dx)
+            {
+            const int distance = abs(dx) + abs(dy) + abs(dz);
+            const int offset[3] = {dx, dy, dz};
+            if (distance == 0 || (!fullyConnected && distance > 1) ||
+                (sliceAxis >= 0 && offset[sliceAxis] != 0))
+              {
+              continue;
+              }
+            const int nx = x + dx, ny = y + dy, nz = z + dz;
+            if (nx < 0 || ny < 0 || nz < 0 || nx >= dim || ny >= dim || nz >= dim)
+              {
+              continue;
+              }
+            const vtkIdType neighbor = (static_cast<vtkIdType>(nz) * dim + ny) * dim + nx;
+            if (values[neighbor] != 0 && labels[neighbor] == 0)
+              {
+              labels[neighbor] = label;
+              stack.push_back(neighbor);
+              }
+            }
+          }
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+bool TestRandomImage(int dim, bool fullyConnected, int sliceAxis,
+                     int numberOfThreads)
+{
+  vtkNew<vtkImageData> image;
+  AllocateImage(image.GetPointer(), dim, VTK_UNSIGNED_CHAR);
+  unsigned char* values = static_cast<unsigned char*>(image->GetScalarPointer());
+  const vtkIdType numberOfVoxels = static_cast<vtkIdType>(dim) * dim * dim;
+  for (vtkIdType i = 0; i < numberOfVoxels; ++i)
+    {
+    values[i] = (rand() % 10 < 4) ? 0 : static_cast<unsigned char>(1 + rand() % 3);
+    }
+
+  std::vector<vtkTypeUInt32> expectedLabels;
+  std::vector<vtkIdType> expectedSizes;
+  ReferenceLabels(values, dim, fullyConnected, sliceAxis,
+                  expectedLabels, expectedSizes);
+
+  vtkNew<vtkITKConnectedComponents> labeler;
+  labeler->SetFullyConnected(fullyConnected);
+  labeler->SetSliceBySlice(sliceAxis >= 0);
+  labeler->SetSliceAxis(sliceAxis >= 0 ? sliceAxis : 2);
+  labeler->SetNumberOfThreads(numberOfThreads);
+  if (!labeler->Label(image.GetPointer()))
+    {
+    std::cerr << "Line " << __LINE__ << " - Label() failed" << std::endl;
+    return false;
+    }
+  if (labeler->GetNumberOfLabels() != expectedSizes.size() - 1)
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong number of labels: "
+              << labeler->GetNumberOfLabels() << " instead of "
+              << expectedSizes.size() - 1 << std::endl;
+    return false;
+    }
+  const vtkTypeUInt32* labels = labeler->GetLabels()->GetPointer(0);
+  for (vtkIdType i = 0; i < numberOfVoxels; ++i)
+    {
+    if (labels[i] != expectedLabels[i])
+      {
+      std::cerr << "Line " << __LINE__ << " - Wrong label at voxel " << i
+                << ": " << labels[i] << " instead of " << expectedLabels[i]
+                << " (fully connected: " << fullyConnected
+                << ", slice axis: " << sliceAxis
+                << ", threads: " << numberOfThreads << ")" << std::endl;
+      return false;
+      }
+    }
+  vtkIdType largestSize = 0;
+  for (size_t label = 1; label < expectedSizes.size(); ++label)
+    {
+    if (labeler->GetLabelSize(static_cast<vtkTypeUInt32>(label)) != expectedSizes[label])
+      {
+      std::cerr << "Line " << __LINE__ << " - Wrong size for label " << label
+                << ": " << labeler->GetLabelSize(static_cast<vtkTypeUInt32>(label))
+                << " instead of " << expectedSizes[label] << std::endl;
+      return false;
+      }
+    largestSize = std::max(largestSize, expectedSizes[label]);
+    }
+  if (labeler->GetLargestLabelSize() != largestSize)
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong largest size: "
+              << labeler->GetLargestLabelSize() << " instead of "
+              << largestSize << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Labelmap of dim^3 voxels made of axis aligned slabs of alternating labels
+// and small islands, similar to an edited segmentation.
+bool BenchmarkLabelmap(int dim)
+{
+  vtkNew<vtkImageData> image;
+  AllocateImage(image.GetPointer(), dim, VTK_SHORT);
+  short* values = static_cast<short*>(image->GetScalarPointer());
+  for (int z = 0; z < dim; ++z)
+    {
+    for (int y = 0; y < dim; ++y)
+      {
+      for (int x = 0; x < dim; ++x)
+        {
+        short value = static_cast<short>(((x / 64) + (y / 64) + (z / 64)) % 4);
+        if (rand() % 100 == 0)
+          {
+          value = 0;
+          }
+        *values++ = value;
+        }
+      }
+    }
+
+  vtkNew<vtkTimerLog> timer;
+  std::vector<vtkTypeUInt32> serialLabels;
+  const int numberOfThreads[2] =
+    {1, vtkMultiThreader::GetGlobalDefaultNumberOfThreads()};
+  for (int run = 0; run < 2; ++run)
+    {
+    const int threads = numberOfThreads[run];
+    vtkNew<vtkITKConnectedComponents> labeler;
+    labeler->SetNumberOfThreads(threads);
+    timer->StartTimer();
+    if (!labeler->Label(image.GetPointer()))
+      {
+      std::cerr << "Line " << __LINE__ << " - Label() failed" << std::endl;
+      return false;
+      }
+    timer->StopTimer();
+    std::cout << dim << "^3 labelmap, " << threads << " thread(s): "
+              << timer->GetElapsedTime() << "s, "
+              << labeler->GetNumberOfLabels() << " islands, largest: "
+              << labeler->GetLargestLabelSize() << " voxels" << std::endl;
+    const vtkTypeUInt32* labels = labeler->GetLabels()->GetPointer(0);
+    if (run == 0)
+      {
+      serialLabels.assign(labels, labels + labeler->GetLabels()->GetNumberOfTuples());
+      }
+    else if (!std::equal(serialLabels.begin(), serialLabels.end(), labels))
+      {
+      std::cerr << "Line " << __LINE__ << " - Labels depend on the number of threads"
+                << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+  srand(1);
+  for (int fullyConnected = 0; fullyConnected < 2; ++fullyConnected)
+    {
+    for (int sliceAxis = -1; sliceAxis < 3; ++sliceAxis)
+      {
+      for (int threads = 1; threads <= 8; threads *= 2)
+        {
+        if (!TestRandomImage(24 + threads, fullyConnected, sliceAxis, threads))
+          {
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+  // Optional benchmark: vtkITKConnectedComponentsTest <dimension>
+  if (argc > 1 && !BenchmarkLabelmap(atoi(argv[1])))
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,561 @@
+/*=========================================================================
+
+  Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+==========================================================================*/
+
+#include "vtkITKConnectedComponents.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMultiThreader.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkTypeUInt32Array.h>
+
+// STD includes
+#include <algorithm>
+#include <map>
+
+vtkStandardNewMacro(vtkITKConnectedComponents);
+
+namespace
+{
+
+/// Parent of the voxels that are not foreground
+const vtkTypeUInt32 NotForeground = VTK_TYPE_UINT32_MAX;
+
+//----------------------------------------------------------------------------
+struct vtkITKConnectedComponentsData
+{
+  enum Pass
+  {
+    InitializePass = 0,
+    FindRootsPass,
+    NumberRootsPass,
+    RelabelPass
+  };
+
+  int Pass;
+
+  // input
+  void* InputPointer;
+  int InputScalarType;
+  vtkIdType InputIncrements[3];
+  double Background;
+  bool ExcludeBackground;
+  double MinForeground;
+  double MaxForeground;
+
+  // connectivity: backward neighbors of a voxel
+  std::vector<int> NeighborOffsets[3];
+  std::vector<vtkIdType> LinearNeighborOffsets;
+  /// True if some backward neighbors are in the previous XY slice
+  bool PreviousSliceNeighbors;
+  vtkIdType Dimensions[3];
+  vtkIdType SliceSize;
+
+  // Blocks of rows processed by the threads. The first voxel of block b is
+  // BlockBegin[b], the last one is BlockBegin[b + 1] - 1.
+  int NumberOfBlocks;
+  std::vector<vtkIdType> BlockBegin;
+  std::vector<vtkTypeUInt32> BlockRoots;
+  // Sizes of the components within a block: the components rooted in the
+  // block have consecutive labels (BlockRoots[b] once numbered) and are
+  // counted in a vector, the few components coming from the previous blocks
+  // in a map.
+  std::vector<std::vector<vtkTypeUInt32> > BlockLabelSizes;
+  std::vector<std::map<vtkTypeUInt32, vtkTypeUInt32> > BlockPreviousLabelSizes;
+  vtkTypeUInt32 NumberOfLabels;
+
+  // union-find forest, the root of a component is its first voxel
+  vtkTypeUInt32* Parents;
+  vtkTypeUInt32* Labels;
+};
+
+//----------------------------------------------------------------------------
+inline vtkTypeUInt32 FindRoot(vtkTypeUInt32* parents, vtkTypeUInt32 voxel)
+{
+  while (parents[voxel] != voxel)
+    {
+    // path halving
+    parents[voxel] = parents[parents[voxel]];
+    voxel = parents[voxel];
+    }
+  return voxel;
+}
+
+//----------------------------------------------------------------------------
+inline vtkTypeUInt32 FindRootConst(const vtkTypeUInt32* parents, vtkTypeUInt32 voxel)
+{
+  while (parents[voxel] != voxel)
+    {
+    voxel = parents[voxel];
+    }
+  return voxel;
+}
+
+//----------------------------------------------------------------------------
+inline void Union(vtkTypeUInt32* parents, vtkTypeUInt32 voxel1, vtkTypeUInt32 voxel2)
+{
+  vtkTypeUInt32 root1 = FindRoot(parents, voxel1);
+  vtkTypeUInt32 root2 = FindRoot(parents, voxel2);
+  // keep the smallest voxel index as root
+  if (root1 < root2)
+    {
+    parents[root2] = root1;
+    }
+  else if (root2 < root1)
+    {
+    parents[root1] = root2;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Connect voxel to its foreground backward neighbors that are not before
+// firstVoxel.
+inline void ConnectNeighbors(vtkITKConnectedComponentsData* data,
+                             vtkIdType voxel, vtkIdType x, vtkIdType y, vtkIdType z,
+                             vtkIdType firstVoxel)
+{
+  if (x > 0 && x < data->Dimensions[0] - 1 &&
+      y > 0 && y < data->Dimensions[1] - 1 && (z > 0 || !data->PreviousSliceNeighbors))
+    {
+    // no need to check the bounds for the voxels inside the image
+    const std::vector<vtkIdType>& linearOffsets = data->LinearNeighborOffsets;
+    for (size_t n = 0; n < linearOffsets.size(); ++n)
+      {
+      const vtkIdType neighbor = voxel + linearOffsets[n];
+      if (neighbor >= firstVoxel && data->Parents[neighbor] != NotForeground)
+        {
+        Union(data->Parents, static_cast<vtkTypeUInt32>(voxel),
+              static_cast<vtkTypeUInt32>(neighbor));
+        }
+      }
+    return;
+    }
+  const std::vector<int>* offsets = data->NeighborOffsets;
+  for (size_t n = 0; n < offsets[0].size(); ++n)
+    {
+    const vtkIdType nx = x + offsets[0][n];
+    const vtkIdType ny = y + offsets[1][n];
+    if (nx < 0 || nx >= data->Dimensions[0] ||
+        ny < 0 || ny >= data->Dimensions[1] || z + offsets[2][n] < 0)
+      {
+      continue;
+      }
+    vtkIdType neighbor = voxel + offsets[0][n]
+      + offsets[1][n] * data->Dimensions[0] + offsets[2][n] * data->SliceSize;
+    if (neighbor < firstVoxel ||
+        data->Parents[neighbor] == NotForeground)
+      {
+      continue;
+      }
+    Union(data->Parents, static_cast<vtkTypeUInt32>(voxel),
+          static_cast<vtkTypeUInt32>(neighbor));
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkITKConnectedComponentsInitialize(vtkITKConnectedComponentsData* data, int block)
+{
+  const vtkIdType nx = data->Dimensions[0];
+  const vtkIdType ny = data->Dimensions[1];
+  const vtkIdType firstVoxel = data->BlockBegin[block];
+  const vtkIdType lastVoxel = data->BlockBegin[block + 1] - 1;
+  for (vtkIdType row = firstVoxel / nx; row <= lastVoxel / nx; ++row)
+    {
+    const vtkIdType y = row % ny;
+    const vtkIdType z = row / ny;
+    const T* inPtr = static_cast<const T*>(data->InputPointer)
+      + y * data->InputIncrements[1] + z * data->InputIncrements[2];
+    vtkIdType voxel = row * nx;
+    for (vtkIdType x = 0; x < nx; ++x, ++voxel, inPtr += data->InputIncrements[0])
+      {
+      const double value = static_cast<double>(*inPtr);
+      if (value < data->MinForeground || value > data->MaxForeground ||
+          (data->ExcludeBackground && value == data->Background))
+        {
+        data->Parents[voxel] = NotForeground;
+        continue;
+        }
+      data->Parents[voxel] = static_cast<vtkTypeUInt32>(voxel);
+      ConnectNeighbors(data, voxel, x, y, z, firstVoxel);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkITKConnectedComponentsInitializeBlock(vtkITKConnectedComponentsData* data, int block)
+{
+  switch (data->InputScalarType)
+    {
+    vtkTemplateMacroCase(VTK_LONG, long, vtkITKConnectedComponentsInitialize<VTK_TT>(data, block));
+    vtkTemplateMacroCase(VTK_UNSIGNED_LONG, unsigned long, vtkITKConnectedComponentsInitialize<VTK_TT>(data, block));
+#if defined(VTK_TYPE_USE_LONG_LONG)
+    vtkTemplateMacroCase(VTK_LONG_LONG, long long, vtkITKConnectedComponentsInitialize<VTK_TT>(data, block));
+    vtkTemplateMacroCase(VTK_UNSIGNED_LONG_LONG, unsigned long long, vtkITKConnectedComponentsInitialize<VTK_TT>(data, block));
+#endif
+    vtkTemplateMacroCase(VTK_INT, int, vtkITKConnectedComponentsInitialize<VTK_TT>(data, block));
+    vtkTemplateMacroCase(VTK_UNSIGNED_INT, unsigned int, vtkITKConnectedComponentsInitialize<VTK_TT>(data, block));
+    vtkTemplateMacroCase(VTK_SHORT, short, vtkITKConnectedComponentsInitialize<VTK_TT>(data, block));
+    vtkTemplateMacroCase(VTK_UNSIGNED_SHORT, unsigned short, vtkITKConnectedComponentsInitialize<VTK_TT>(data, block));
+    vtkTemplateMacroCase(VTK_CHAR, char, vtkITKConnectedComponentsInitialize<VTK_TT>(data, block));
+    vtkTemplateMacroCase(VTK_SIGNED_CHAR, signed char, vtkITKConnectedComponentsInitialize<VTK_TT>(data, block));
+    vtkTemplateMacroCase(VTK_UNSIGNED_CHAR, unsigned char, vtkITKConnectedComponentsInitialize<VTK_TT>(data, block));
+    default:
+      break;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkITKConnectedComponentsExecuteBlock(vtkITKConnectedComponentsData* data, int block)
+{
+  const vtkIdType firstVoxel = data->BlockBegin[block];
+  const vtkIdType endVoxel = data->BlockBegin[block + 1];
+  vtkTypeUInt32* parents = data->Parents;
+  vtkTypeUInt32* labels = data->Labels;
+  switch (data->Pass)
+    {
+    case vtkITKConnectedComponentsData::InitializePass:
+      vtkITKConnectedComponentsInitializeBlock(data, block);
+      break;
+    case vtkITKConnectedComponentsData::FindRootsPass:
+      {
+      // parents are only read: other blocks are also walking up the trees
+      vtkTypeUInt32 roots = 0;
+      for (vtkIdType voxel = firstVoxel; voxel < endVoxel; ++voxel)
+        {
+        if (parents[voxel] == NotForeground)
+          {
+          labels[voxel] = 0;
+          continue;
+          }
+        labels[voxel] = FindRootConst(parents, static_cast<vtkTypeUInt32>(voxel));
+        if (labels[voxel] == voxel)
+          {
+          ++roots;
+          }
+        }
+      data->BlockRoots[block] = roots;
+      break;
+      }
+    case vtkITKConnectedComponentsData::NumberRootsPass:
+      {
+      // the roots of the block are numbered in order, their parent is
+      // replaced by their label (the roots are only read by the next pass)
+      vtkTypeUInt32 label = data->BlockRoots[block];
+      for (vtkIdType voxel = firstVoxel; voxel < endVoxel; ++voxel)
+        {
+        if (parents[voxel] == voxel)
+          {
+          parents[voxel] = label++;
+          }
+        }
+      break;
+      }
+    case vtkITKConnectedComponentsData::RelabelPass:
+      {
+      const vtkTypeUInt32 firstLabel = data->BlockRoots[block];
+      const vtkTypeUInt32 endLabel = block + 1 < data->NumberOfBlocks ?
+        data->BlockRoots[block + 1] : data->NumberOfLabels + 1;
+      std::vector<vtkTypeUInt32>& sizes = data->BlockLabelSizes[block];
+      sizes.assign(endLabel - firstLabel, 0);
+      std::map<vtkTypeUInt32, vtkTypeUInt32>& previousSizes =
+        data->BlockPreviousLabelSizes[block];
+      previousSizes.clear();
+      for (vtkIdType voxel = firstVoxel; voxel < endVoxel; ++voxel)
+        {
+        if (parents[voxel] == NotForeground)
+          {
+          continue;
+          }
+        const vtkTypeUInt32 label = parents[labels[voxel]];
+        labels[voxel] = label;
+        if (label >= firstLabel)
+          {
+          ++sizes[label - firstLabel];
+          }
+        else
+          {
+          ++previousSizes[label];
+          }
+        }
+      break;
+      }
+    default:
+      break;
+    }
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkITKConnectedComponentsThreadedExecute(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkITKConnectedComponentsData* data =
+    static_cast<vtkITKConnectedComponentsData*>(info->UserData);
+  for (int block = info->ThreadID; block < data->NumberOfBlocks; block += info->NumberOfThreads)
+    {
+    vtkITKConnectedComponentsExecuteBlock(data, block);
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkITKConnectedComponents::vtkITKConnectedComponents()
+{
+  this->FullyConnected = 0;
+  this->SliceBySlice = 0;
+  this->SliceAxis = 2;
+  this->Background = 0.;
+  this->ExcludeBackground = 1;
+  this->MinForeground = VTK_DOUBLE_MIN;
+  this->MaxForeground = VTK_DOUBLE_MAX;
+  this->NumberOfThreads = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  this->MultiThreader = vtkMultiThreader::New();
+  this->Labels = vtkTypeUInt32Array::New();
+}
+
+//----------------------------------------------------------------------------
+vtkITKConnectedComponents::~vtkITKConnectedComponents()
+{
+  this->MultiThreader->Delete();
+  this->Labels->Delete();
+}
+
+//----------------------------------------------------------------------------
+void vtkITKConnectedComponents::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "FullyConnected: " << this->FullyConnected << std::endl;
+  os << indent << "SliceBySlice: " << this->SliceBySlice << std::endl;
+  os << indent << "SliceAxis: " << this->SliceAxis << std::endl;
+  os << indent << "Background: " << this->Background << std::endl;
+  os << indent << "ExcludeBackground: " << this->ExcludeBackground << std::endl;
+  os << indent << "MinForeground: " << this->MinForeground << std::endl;
+  os << indent << "MaxForeground: " << this->MaxForeground << std::endl;
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << std::endl;
+  os << indent << "NumberOfLabels: " << this->GetNumberOfLabels() << std::endl;
+}
+
+//----------------------------------------------------------------------------
+bool vtkITKConnectedComponents::Label(vtkImageData* input, int extent[6])
+{
+  this->Labels->SetNumberOfTuples(0);
+  this->LabelSizes.assign(1, 0);
+
+  if (!input || !input->GetPointData()->GetScalars())
+    {
+    vtkErrorMacro(<< "Label: no input scalars");
+    return false;
+    }
+  if (input->GetNumberOfScalarComponents() != 1)
+    {
+    vtkErrorMacro(<< "Label: only single component images are supported");
+    return false;
+    }
+  int scalarType = input->GetScalarType();
+  switch (scalarType)
+    {
+    case VTK_LONG: case VTK_UNSIGNED_LONG:
+#if defined(VTK_TYPE_USE_LONG_LONG)
+    case VTK_LONG_LONG: case VTK_UNSIGNED_LONG_LONG:
+#endif
+    case VTK_INT: case VTK_UNSIGNED_INT:
+    case VTK_SHORT: case VTK_UNSIGNED_SHORT:
+    case VTK_CHAR: case VTK_SIGNED_CHAR: case VTK_UNSIGNED_CHAR:
+      break;
+    default:
+      vtkErrorMacro(<< "Label: scalars must be integers, not " << input->GetScalarTypeAsString());
+      return false;
+    }
+
+  int labelExtent[6];
+  if (extent)
+    {
+    std::copy(extent, extent + 6, labelExtent);
+    }
+  else
+    {
+    input->GetExtent(labelExtent);
+    }
+
+  vtkITKConnectedComponentsData data;
+  vtkIdType numberOfVoxels = 1;
+  for (int i = 0; i < 3; ++i)
+    {
+    data.Dimensions[i] = labelExtent[2*i+1] - labelExtent[2*i] + 1;
+    numberOfVoxels *= std::max(data.Dimensions[i], vtkIdType(0));
+    }
+  if (numberOfVoxels <= 0)
+    {
+    return true;
+    }
+  // the voxel indices must fit in the labels, NotForeground excluded
+  if (static_cast<double>(numberOfVoxels) >= static_cast<double>(NotForeground))
+    {
+    vtkErrorMacro(<< "Label: too many voxels (" << numberOfVoxels << ")");
+    return false;
+    }
+  data.SliceSize = data.Dimensions[0] * data.Dimensions[1];
+
+  data.InputPointer = input->GetScalarPointerForExtent(labelExtent);
+  data.InputScalarType = scalarType;
+  input->GetIncrements(data.InputIncrements);
+  data.Background = this->Background;
+  data.ExcludeBackground = this->ExcludeBackground != 0;
+  data.MinForeground = this->MinForeground;
+  data.MaxForeground = this->MaxForeground;
+  data.PreviousSliceNeighbors = false;
+
+  // backward neighbors (already visited when scanning x fastest)
+  for (int dz = -1; dz <= 0; ++dz)
+    {
+    for (int dy = -1; dy <= (dz < 0 ? 1 : 0); ++dy)
+      {
+      for (int dx = -1; dx <= ((dz < 0 || dy < 0) ? 1 : -1); ++dx)
+        {
+        const int offset[3] = {dx, dy, dz};
+        if ((!this->FullyConnected && (dx != 0) + (dy != 0) + (dz != 0) != 1) ||
+            (this->SliceBySlice && offset[this->SliceAxis] != 0))
+          {
+          continue;
+          }
+        data.PreviousSliceNeighbors = data.PreviousSliceNeighbors || dz != 0;
+        data.NeighborOffsets[0].push_back(dx);
+        data.NeighborOffsets[1].push_back(dy);
+        data.NeighborOffsets[2].push_back(dz);
+        data.LinearNeighborOffsets.push_back(
+          dx + dy * data.Dimensions[0] + dz * data.SliceSize);
+        }
+      }
+    }
+
+  // blocks of rows
+  vtkIdType numberOfRows = data.Dimensions[1] * data.Dimensions[2];
+  data.NumberOfBlocks = static_cast<int>(
+    std::min(vtkIdType(this->NumberOfThreads), numberOfRows));
+  data.BlockBegin.resize(data.NumberOfBlocks + 1);
+  for (int block = 0; block <= data.NumberOfBlocks; ++block)
+    {
+    data.BlockBegin[block] =
+      (numberOfRows * block / data.NumberOfBlocks) * data.Dimensions[0];
+    }
+  data.BlockRoots.resize(data.NumberOfBlocks);
+  data.BlockLabelSizes.resize(data.NumberOfBlocks);
+  data.BlockPreviousLabelSizes.resize(data.NumberOfBlocks);
+  data.NumberOfLabels = 0;
+
+  std::vector<vtkTypeUInt32> parents(numberOfVoxels);
+  this->Labels->SetNumberOfTuples(numberOfVoxels);
+  data.Parents = &parents[0];
+  data.Labels = this->Labels->GetPointer(0);
+
+  this->MultiThreader->SetNumberOfThreads(data.NumberOfBlocks);
+  this->MultiThreader->SetSingleMethod(vtkITKConnectedComponentsThreadedExecute, &data);
+
+  // label each block independently
+  data.Pass = vtkITKConnectedComponentsData::InitializePass;
+  this->MultiThreader->SingleMethodExecute();
+
+  // merge the blocks: only the voxels close to the beginning of a block
+  // have neighbors in the previous blocks
+  const vtkIdType maximumOffset = data.SliceSize + data.Dimensions[0] + 1;
+  for (int block = 1; block < data.NumberOfBlocks; ++block)
+    {
+    const vtkIdType firstVoxel = data.BlockBegin[block];
+    const vtkIdType endVoxel = std::min(data.BlockBegin[block + 1], firstVoxel + maximumOffset);
+    for (vtkIdType voxel = firstVoxel; voxel < endVoxel; ++voxel)
+      {
+      if (parents[voxel] == NotForeground)
+        {
+        continue;
+        }
+      const vtkIdType x = voxel % data.Dimensions[0];
+      const vtkIdType y = (voxel / data.Dimensions[0]) % data.Dimensions[1];
+      const vtkIdType z = voxel / data.SliceSize;
+      ConnectNeighbors(&data, voxel, x, y, z, 0);
+      }
+    }
+
+  // number the components in the order of their first voxel
+  data.Pass = vtkITKConnectedComponentsData::FindRootsPass;
+  this->MultiThreader->SingleMethodExecute();
+  vtkTypeUInt32 firstLabel = 1;
+  for (int block = 0; block < data.NumberOfBlocks; ++block)
+    {
+    vtkTypeUInt32 roots = data.BlockRoots[block];
+    data.BlockRoots[block] = firstLabel;
+    firstLabel += roots;
+    }
+  data.NumberOfLabels = firstLabel - 1;
+  data.Pass = vtkITKConnectedComponentsData::NumberRootsPass;
+  this->MultiThreader->SingleMethodExecute();
+  data.Pass = vtkITKConnectedComponentsData::RelabelPass;
+  this->MultiThreader->SingleMethodExecute();
+
+  // the label ranges of the blocks are disjoint, in order
+  this->LabelSizes.assign(1, 0);
+  for (int block = 0; block < data.NumberOfBlocks; ++block)
+    {
+    const std::vector<vtkTypeUInt32>& sizes = data.BlockLabelSizes[block];
+    this->LabelSizes.insert(this->LabelSizes.end(), sizes.begin(), sizes.end());
+    }
+  for (int block = 1; block < data.NumberOfBlocks; ++block)
+    {
+    const std::map<vtkTypeUInt32, vtkTypeUInt32>& sizes = data.BlockPreviousLabelSizes[block];
+    for (std::map<vtkTypeUInt32, vtkTypeUInt32>::const_iterator it = sizes.begin();
+         it != sizes.end(); ++it)
+      {
+      this->LabelSizes[it->first] += it->second;
+      }
+    }
+
+  this->Modified();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+vtkTypeUInt32Array* vtkITKConnectedComponents::GetLabels()
+{
+  return this->Labels;
+}
+
+//----------------------------------------------------------------------------
+vtkTypeUInt32 vtkITKConnectedComponents::GetNumberOfLabels()const
+{
+  return static_cast<vtkTypeUInt32>(this->LabelSizes.size() - 1);
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkITKConnectedComponents::GetLabelSize(vtkTypeUInt32 label)const
+{
+  return label < this->LabelSizes.size() ? this->LabelSizes[label] : 0;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkITKConnectedComponents::GetLargestLabelSize()const
+{
+  return this->GetLabelSize(this->GetLargestLabel());
+}
+
+//----------------------------------------------------------------------------
+vtkTypeUInt32 vtkITKConnectedComponents::GetLargestLabel()const
+{
+  vtkTypeUInt32 largestLabel = 0;
+  for (vtkTypeUInt32 label = 1; label < this->LabelSizes.size(); ++label)
+    {
+    if (this->LabelSizes[label] > this->LabelSizes[largestLabel])
+      {
+      largestLabel = label;
+      }
+    }
+  return largestLabel;
+}
@@ -0,0 +1,137 @@
+/*=========================================================================
+
+  Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+==========================================================================*/
+
+#ifndef __vtkITKConnectedComponents_h
+#define __vtkITKConnectedComponents_h
+
+#include "vtkITK.h"
+
+// VTK includes
+#include <vtkObject.h>
+#include <vtkType.h>
+
+// STD includes
+#include <vector>
+
+class vtkImageData;
+class vtkMultiThreader;
+class vtkTypeUInt32Array;
+
+/// \brief Multi-threaded connected component labeling of integer images.
+///
+/// A voxel is foreground if its value is in [MinForeground, MaxForeground]
+/// and, unless ExcludeBackground is off, different from Background.
+/// Foreground voxels are labeled with 32-bit component labels 1..N numbered
+/// in the order of the first voxel of each component (x fastest), background
+/// voxels are labeled 0. The size of each component is computed while
+/// labeling.
+///
+/// The image is split into blocks of rows labeled in parallel with a
+/// union-find, then the blocks are merged along their boundaries.
+/// All the state is kept in the instance: different instances can be used
+/// concurrently.
+class VTK_ITK_EXPORT vtkITKConnectedComponents : public vtkObject
+{
+public:
+  static vtkITKConnectedComponents *New();
+  vtkTypeMacro(vtkITKConnectedComponents, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  ///
+  /// If non-zero, voxels touching by an edge or a vertex are connected.
+  /// If zero (default), only voxels sharing a face are connected.
+  vtkGetMacro(FullyConnected, int);
+  vtkSetMacro(FullyConnected, int);
+  vtkBooleanMacro(FullyConnected, int);
+
+  ///
+  /// If non-zero, components are computed independently in each slice
+  /// orthogonal to SliceAxis.
+  vtkGetMacro(SliceBySlice, int);
+  vtkSetMacro(SliceBySlice, int);
+  vtkBooleanMacro(SliceBySlice, int);
+
+  ///
+  /// Axis orthogonal to the slices when SliceBySlice is on: 2 (XY slices,
+  /// default), 1 (XZ slices) or 0 (YZ slices).
+  vtkGetMacro(SliceAxis, int);
+  vtkSetClampMacro(SliceAxis, int, 0, 2);
+
+  ///
+  /// Value of the background voxels. 0 by default.
+  vtkGetMacro(Background, double);
+  vtkSetMacro(Background, double);
+  vtkGetMacro(ExcludeBackground, int);
+  vtkSetMacro(ExcludeBackground, int);
+  vtkBooleanMacro(ExcludeBackground, int);
+
+  ///
+  /// Range of the foreground values. All values by default.
+  vtkGetMacro(MinForeground, double);
+  vtkSetMacro(MinForeground, double);
+  vtkGetMacro(MaxForeground, double);
+  vtkSetMacro(MaxForeground, double);
+
+  ///
+  /// Number of threads used to label. Defaults to the global default number
+  /// of threads of vtkMultiThreader.
+  vtkGetMacro(NumberOfThreads, int);
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_INT_MAX);
+
+  ///
+  /// Label the voxels of the single component integer image input within
+  /// extent (the whole extent of the input if extent is null).
+  /// Returns false if the image can't be labeled.
+  bool Label(vtkImageData* input, int extent[6] = 0);
+
+  ///
+  /// Component label of each voxel of the labeled extent, x fastest.
+  vtkTypeUInt32Array* GetLabels();
+
+  ///
+  /// Number of components found by the last Label().
+  vtkTypeUInt32 GetNumberOfLabels()const;
+
+  ///
+  /// Number of voxels of the component label, 0 for the background
+  /// label or an invalid label.
+  vtkIdType GetLabelSize(vtkTypeUInt32 label)const;
+
+  ///
+  /// Size of the largest component, 0 if there is no component.
+  vtkIdType GetLargestLabelSize()const;
+
+  ///
+  /// Label of the largest component, 0 if there is no component.
+  vtkTypeUInt32 GetLargestLabel()const;
+
+protected:
+  vtkITKConnectedComponents();
+  ~vtkITKConnectedComponents();
+
+  int FullyConnected;
+  int SliceBySlice;
+  int SliceAxis;
+  double Background;
+  int ExcludeBackground;
+  double MinForeground;
+  double MaxForeground;
+  int NumberOfThreads;
+
+  vtkMultiThreader* MultiThreader;
+  vtkTypeUInt32Array* Labels;
+  /// Number of voxels of each label, index 0 is unused.
+  std::vector<vtkIdType> LabelSizes;
+
+private:
+  vtkITKConnectedComponents(const vtkITKConnectedComponents&);  /// Not implemented.
+  void operator=(const vtkITKConnectedComponents&);  /// Not implemented.
+};
+
+#endif
@@ -21,9 +21,14 @@
 #include "vtkAlgorithm.h"
 #include <vtkVersion.h>
 
-#include "itkConnectedComponentImageFilter.h"
-#include "itkRelabelComponentImageFilter.h"
-#include "itkCommand.h"
+#include "vtkITKConnectedComponents.h"
+#include <vtkNew.h>
+#include <vtkTypeTraits.h>
+#include <vtkTypeUInt32Array.h>
+
+// STD includes
+#include <algorithm>
+#include <vector>
 
 vtkStandardNewMacro(vtkITKIslandMath);
 
@@ -58,76 +63,87 @@ void vtkITKIslandMath::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "OriginalNumberOfIslands: " << OriginalNumberOfIslands << std::endl;
 }
 
-// Note: local function not method - conforms to signature in itkCommand.h
-void vtkITKIslandMathHandleProgressEvent (itk::Object *caller,
-                                          const itk::EventObject& vtkNotUsed(eventObject),
-                                          void *clientdata)
+namespace
+{
+// Sort labels by decreasing size, ties keep the labeling order
+// (same order as itk::RelabelComponentImageFilter).
+struct vtkITKIslandMathLargerLabel
 {
-  itk::ProcessObject *itkFilter = dynamic_cast<itk::ProcessObject*>(caller);
-  vtkAlgorithm *vtkFilter = reinterpret_cast<vtkAlgorithm*>(clientdata);
-  if ( itkFilter && vtkFilter )
+  vtkITKIslandMathLargerLabel(vtkITKConnectedComponents* labeler)
+    : Labeler(labeler) {}
+  bool operator()(vtkTypeUInt32 a, vtkTypeUInt32 b)const
     {
-    vtkFilter->UpdateProgress ( itkFilter->GetProgress() );
+    vtkIdType sizeA = this->Labeler->GetLabelSize(a);
+    vtkIdType sizeB = this->Labeler->GetLabelSize(b);
+    return sizeA > sizeB || (sizeA == sizeB && a < b);
     }
+  vtkITKConnectedComponents* Labeler;
 };
+}
 
 template <class T>
 void vtkITKIslandMathExecute(vtkITKIslandMath *self, vtkImageData* input,
                 vtkImageData* vtkNotUsed(output),
-                T* inPtr, T* outPtr)
+                T* vtkNotUsed(inPtr), T* outPtr)
 {
-
-  int dims[3];
-  input->GetDimensions(dims);
-  double spacing[3];
-  input->GetSpacing(spacing);
-
-  // Wrap scalars into an ITK image
-  // - mostly rely on defaults for spacing, origin etc for this filter
-  typedef itk::Image<T, 3> ImageType;
-  typename ImageType::Pointer inImage = ImageType::New();
-  typename ImageType::RegionType region;
-  typename ImageType::IndexType index;
-  typename ImageType::SizeType size;
-
-  inImage->GetPixelContainer()->SetImportPointer(inPtr, dims[0]*dims[1]*dims[2], false);
-  index[0] = index[1] = index[2] = 0;
-  region.SetIndex(index);
-  size[0] = dims[0]; size[1] = dims[1]; size[2] = dims[2];
-  region.SetSize(size);
-  inImage->SetLargestPossibleRegion(region);
-  inImage->SetBufferedRegion(region);
-  inImage->SetSpacing(spacing);
-
-  // set up the progress callback
-  itk::CStyleCommand::Pointer progressCommand = itk::CStyleCommand::New();
-  progressCommand->SetClientData( static_cast<void *>(self) );
-  progressCommand->SetCallback( vtkITKIslandMathHandleProgressEvent );
-
-
   // Calculate the island operation
-  // ccfilter - identifies the islands
+  // labeler - identifies the islands and measure their size
   // relabel - sorts them by size
-  typedef itk::ConnectedComponentImageFilter<ImageType, ImageType> ConnectedComponentType;
-  typename ConnectedComponentType::Pointer ccfilter = ConnectedComponentType::New();
-  typedef itk::RelabelComponentImageFilter<ImageType, ImageType> RelabelComponentType;
-  typename RelabelComponentType::Pointer relabel = RelabelComponentType::New();
-
-  ccfilter->AddObserver(itk::ProgressEvent(), progressCommand);
-  relabel->AddObserver(itk::ProgressEvent(), progressCommand);
-
-  ccfilter->SetFullyConnected(self->GetFullyConnected());
-  ccfilter->SetInput( inImage );
-  relabel->SetInput( ccfilter->GetOutput() );
-  relabel->SetMinimumObjectSize( self->GetMinimumSize() );
-  relabel->Update();
-  self->SetNumberOfIslands(relabel->GetNumberOfObjects());
-  self->SetOriginalNumberOfIslands(relabel->GetOriginalNumberOfObjects());
+  vtkNew<vtkITKConnectedComponents> labeler;
+  labeler->SetFullyConnected(self->GetFullyConnected());
+  // IJ=3, IK=2, JK=1: the slices are orthogonal to K, J or I
+  const int sliceBySlice = self->GetSliceBySlice();
+  labeler->SetSliceBySlice(sliceBySlice >= 1 && sliceBySlice <= 3);
+  labeler->SetSliceAxis(sliceBySlice - 1);
+  labeler->SetBackground(0.);
+  if (!labeler->Label(input))
+    {
+    return;
+    }
+  self->UpdateProgress(0.5);
 
-  // Copy to the output
-  memcpy(outPtr, relabel->GetOutput()->GetBufferPointer(),
-         relabel->GetOutput()->GetBufferedRegion().GetNumberOfPixels() * sizeof(T));
+  const vtkTypeUInt32 numberOfLabels = labeler->GetNumberOfLabels();
+  std::vector<vtkTypeUInt32> sortedLabels(numberOfLabels);
+  for (vtkTypeUInt32 label = 0; label < numberOfLabels; ++label)
+    {
+    sortedLabels[label] = label + 1;
+    }
+  std::stable_sort(sortedLabels.begin(), sortedLabels.end(),
+                   vtkITKIslandMathLargerLabel(labeler.GetPointer()));
+
+  // Islands smaller than the minimum size are removed. The islands that
+  // don't fit in the output scalar type get its largest value.
+  const double maximumLabel = vtkTypeTraits<T>::Max();
+  std::vector<T> newLabels(numberOfLabels + 1, static_cast<T>(0));
+  vtkTypeUInt32 numberOfIslands = 0;
+  for (; numberOfIslands < numberOfLabels; ++numberOfIslands)
+    {
+    vtkTypeUInt32 label = sortedLabels[numberOfIslands];
+    if (labeler->GetLabelSize(label) < self->GetMinimumSize())
+      {
+      break;
+      }
+    newLabels[label] = static_cast<T>(
+      std::min(static_cast<double>(numberOfIslands + 1), maximumLabel));
+    }
+  if (numberOfIslands > maximumLabel)
+    {
+    vtkWarningWithObjectMacro(self, << numberOfIslands << " islands don't fit in the "
+                              << "output scalar type, islands smaller than island "
+                              << maximumLabel << " are all labeled " << maximumLabel);
+    numberOfIslands = static_cast<vtkTypeUInt32>(maximumLabel);
+    }
+  self->SetNumberOfIslands(numberOfIslands);
+  self->SetOriginalNumberOfIslands(numberOfLabels);
 
+  // Copy to the output
+  const vtkTypeUInt32* labels = labeler->GetLabels()->GetPointer(0);
+  const vtkIdType numberOfVoxels = labeler->GetLabels()->GetNumberOfTuples();
+  for (vtkIdType i = 0; i < numberOfVoxels; ++i)
+    {
+    outPtr[i] = newLabels[labels[i]];
+    }
+  self->UpdateProgress(1.0);
 }
 
 
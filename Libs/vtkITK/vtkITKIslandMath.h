@@ -38,7 +38,6 @@ class VTK_ITK_EXPORT vtkITKIslandMath : public vtkSimpleImageToImageFilter
   vtkSetMacro(MaximumSize, vtkIdType);
 
   ///
-  /// TODO: Not yet implemented
   /// If zero, islands are defined by 3D connectivity
   /// If non-zero, islands are evaluated in a sequence of 2D planes
   /// (IJ=3, IK=2, JK=1)
@@ -49,7 +48,10 @@ class VTK_ITK_EXPORT vtkITKIslandMath : public vtkSimpleImageToImageFilter
   void SetSliceBySliceToJK() {this->SetSliceBySlice(1);}
 
   ///
-  /// Accessors to describe result of calculations
+  /// Accessors to describe result of calculations.
+  /// The islands are labeled by decreasing size: when there are more islands
+  /// than values of the scalar type, the smallest islands share its largest
+  /// value (a warning is reported) and NumberOfIslands is that value.
   vtkGetMacro(NumberOfIslands, unsigned long);
   vtkSetMacro(NumberOfIslands, unsigned long);
   vtkGetMacro(OriginalNumberOfIslands, unsigned long);
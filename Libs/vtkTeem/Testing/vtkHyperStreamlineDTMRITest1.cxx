@@ -0,0 +1,156 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// vtkTeem includes
+#include <vtkHyperStreamlineDTMRI.h>
+#include <vtkTractographyTensorCache.h>
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkVersion.h>
+
+// STD includes
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Fibers turning around the z axis going through (10, 10)
+void CreateCircularTensorField(vtkImageData* image)
+{
+  const int size = 21;
+  image->SetDimensions(size, size, size);
+  image->SetSpacing(1., 1., 1.);
+  image->SetOrigin(0., 0., 0.);
+
+  vtkNew<vtkFloatArray> tensors;
+  tensors->SetName("tensors");
+  tensors->SetNumberOfComponents(9);
+  tensors->SetNumberOfTuples(size * size * size);
+  vtkIdType pointId = 0;
+  for (int z = 0; z < size; ++z)
+    {
+    for (int y = 0; y < size; ++y)
+      {
+      for (int x = 0; x < size; ++x, ++pointId)
+        {
+        double e[3] = {-(y - 10.), x - 10., 0.};
+        if (vtkMath::Normalize(e) == 0.)
+          {
+          e[0] = 1.;
+          }
+        // major eigenvalue 1 along e, 0.2 in the other directions
+        double tensor[9];
+        for (int i = 0; i < 3; ++i)
+          {
+          for (int j = 0; j < 3; ++j)
+            {
+            tensor[i + 3 * j] = 0.8 * e[i] * e[j] + (i == j ? 0.2 : 0.);
+            }
+          }
+        tensors->SetTuple(pointId, tensor);
+        }
+      }
+    }
+  image->GetPointData()->SetTensors(tensors.GetPointer());
+}
+
+//----------------------------------------------------------------------------
+void Track(vtkImageData* image, vtkTractographyTensorCache* cache,
+           vtkPolyData* fibers)
+{
+  vtkNew<vtkHyperStreamlineDTMRI> streamer;
+#if (VTK_MAJOR_VERSION <= 5)
+  streamer->SetInput(image);
+#else
+  streamer->SetInputData(image);
+#endif
+  streamer->SetStartPosition(15., 10., 10.);
+  streamer->SetMaximumPropagationDistance(20.);
+  streamer->SetIntegrationStepLength(0.5);
+  streamer->SetTensorCache(cache);
+  streamer->Update();
+  fibers->DeepCopy(streamer->GetOutput());
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkHyperStreamlineDTMRITest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkImageData> image;
+  CreateCircularTensorField(image.GetPointer());
+
+  vtkNew<vtkPolyData> referenceFibers;
+  Track(image.GetPointer(), 0, referenceFibers.GetPointer());
+  vtkNew<vtkTractographyTensorCache> cache;
+  vtkNew<vtkPolyData> cachedFibers;
+  Track(image.GetPointer(), cache.GetPointer(), cachedFibers.GetPointer());
+  // Second run reuses the cached eigen systems
+  vtkNew<vtkPolyData> cachedFibers2;
+  Track(image.GetPointer(), cache.GetPointer(), cachedFibers2.GetPointer());
+
+  if (referenceFibers->GetNumberOfLines() != 2 ||
+      cachedFibers->GetNumberOfLines() != 2 ||
+      cachedFibers2->GetNumberOfPoints() != cachedFibers->GetNumberOfPoints())
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong number of fibers: "
+              << referenceFibers->GetNumberOfLines() << " and "
+              << cachedFibers->GetNumberOfLines() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The fibers must follow the same path, within a tolerance
+  const double tolerance = 0.25;
+  vtkCellArray* referenceLines = referenceFibers->GetLines();
+  vtkCellArray* cachedLines = cachedFibers->GetLines();
+  referenceLines->InitTraversal();
+  cachedLines->InitTraversal();
+  vtkIdType referenceCount, cachedCount;
+  vtkIdType *referencePointIds, *cachedPointIds;
+  while (referenceLines->GetNextCell(referenceCount, referencePointIds) &&
+         cachedLines->GetNextCell(cachedCount, cachedPointIds))
+    {
+    if (referenceCount < 10 ||
+        abs(static_cast<int>(referenceCount - cachedCount)) > referenceCount / 10)
+      {
+      std::cerr << "Line " << __LINE__ << " - Wrong number of points: "
+                << referenceCount << " instead of " << cachedCount << std::endl;
+      return EXIT_FAILURE;
+      }
+    vtkIdType count = referenceCount < cachedCount ? referenceCount : cachedCount;
+    for (vtkIdType i = 0; i < count; ++i)
+      {
+      double referencePoint[3], cachedPoint[3];
+      referenceFibers->GetPoint(referencePointIds[i], referencePoint);
+      cachedFibers->GetPoint(cachedPointIds[i], cachedPoint);
+      double distance = sqrt(
+        vtkMath::Distance2BetweenPoints(referencePoint, cachedPoint));
+      if (distance > tolerance)
+        {
+        std::cerr << "Line " << __LINE__ << " - Point " << i << " differs: "
+                  << distance << " mm from the reference" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -12,6 +12,7 @@
 
 =========================================================================auto=*/
 #include "vtkHyperStreamlineDTMRI.h"
+#include "vtkTractographyTensorCache.h"
 
 #include "vtkCellArray.h"
 #include "vtkFloatArray.h"
@@ -59,12 +60,17 @@ vtkHyperStreamlineDTMRI::vtkHyperStreamlineDTMRI()
 
   this->OutputTensors = 0;
   this->OneTrajectoryPerSeedPoint = 0;
+
+  this->TensorCache = NULL;
 }
 
 vtkHyperStreamlineDTMRI::~vtkHyperStreamlineDTMRI()
 {
+  this->SetTensorCache(NULL);
 }
 
+vtkCxxSetObjectMacro(vtkHyperStreamlineDTMRI, TensorCache, vtkTractographyTensorCache);
+
 // copied from superclass
 // Make sure coordinate systems are consistent
 static void FixVectors(double **prev, double **current, int iv, int ix, int iy)
@@ -143,9 +149,8 @@ vtkPolyData *output = vtkPolyData::SafeDownCast(
   vtkPointData *pd=input->GetPointData();
   vtkDataArray *inScalars;
   vtkDataArray *inTensors;
-  double *tensor;
   vtkTractographyPoint *sNext, *sPtr;
-  int i, j, k, ptId, subId, iv, ix, iy;
+  int i, j, ptId, subId, iv, ix, iy;
   vtkCell *cell;
   double ev[3];
   double xNext[3];
@@ -207,6 +212,14 @@ vtkPolyData *output = vtkPolyData::SafeDownCast(
   iv = this->IntegrationEigenvector;
   ix = (iv + 1) % 3;
   iy = (iv + 2) % 3;
+
+  // the cache only has the major eigenvectors
+  bool useTensorCache = (this->TensorCache != NULL &&
+                         iv == VTK_INTEGRATE_MAJOR_EIGENVECTOR);
+  if (useTensorCache)
+    {
+    this->TensorCache->Prepare(inTensors, this->StoppingMode);
+    }
   //
   // Create starting points
   //
@@ -250,25 +263,8 @@ vtkPolyData *output = vtkPolyData::SafeDownCast(
     inTensors->GetTuples(cell->PointIds, cellTensors);
 
     // interpolate tensor, compute eigenfunctions
-    for (j=0; j<3; j++)
-      {
-      for (i=0; i<3; i++)
-        {
-        m[i][j] = 0.0;
-        }
-      }
-    for (k=0; k < cell->GetNumberOfPoints(); k++)
-      {
-      tensor = cellTensors->GetTuple(k);
-      for (j=0; j<3; j++)
-        {
-        for (i=0; i<3; i++)
-          {
-          m[i][j] += tensor[i+3*j] * w[k];
-
-          }
-        }
-      }
+    this->EvaluateEigenSystem(cell, cellTensors, w, NULL,
+                              m, sPtr->W, sPtr->V, useTensorCache);
 
     // store tensor at start point
     for (j=0; j<3; j++)
@@ -279,9 +275,6 @@ vtkPolyData *output = vtkPolyData::SafeDownCast(
         }
       }
 
-    //vtkMath::Jacobi(m, sPtr->W, sPtr->V);
-    vtkDiffusionTensorMathematics::TeemEigenSolver(m,sPtr->W,sPtr->V);
-    FixVectors(NULL, sPtr->V, iv, ix, iy);
 
     if ( inScalars )
       {
@@ -408,28 +401,8 @@ vtkPolyData *output = vtkPolyData::SafeDownCast(
       cell->EvaluatePosition(xNext, closestPoint, subId, p, dist2, w);
 
       //interpolate tensor
-      for (j=0; j<3; j++)
-        {
-        for (i=0; i<3; i++)
-          {
-          m[i][j] = 0.0;
-          }
-        }
-      for (k=0; k < cell->GetNumberOfPoints(); k++)
-        {
-        tensor = cellTensors->GetTuple(k);
-        for (j=0; j<3; j++)
-          {
-          for (i=0; i<3; i++)
-            {
-            m[i][j] += tensor[i+3*j] * w[k];
-            }
-          }
-        }
-
-      //vtkMath::Jacobi(m, ev, v);
-      vtkDiffusionTensorMathematics::TeemEigenSolver(m,ev,v);
-      FixVectors(sPtr->V, v, iv, ix, iy);
+      this->EvaluateEigenSystem(cell, cellTensors, w, sPtr->V,
+                                m, ev, v, useTensorCache);
 
       //now compute final position
       for (i=0; i<3; i++)
@@ -469,46 +442,10 @@ vtkPolyData *output = vtkPolyData::SafeDownCast(
       if ( sNext->CellId >= 0 )
         {
         cell->EvaluateLocation(sNext->SubId, sNext->P, xNext, w);
-        for (j=0; j<3; j++)
-          {
-          for (i=0; i<3; i++)
-            {
-            m[i][j] = 0.0;
-            }
-          }
-        for (k=0; k < cell->GetNumberOfPoints(); k++)
-          {
-          tensor = cellTensors->GetTuple(k);
-          for (j=0; j<3; j++)
-            {
-            for (i=0; i<3; i++)
-              {
-              m[i][j] += tensor[i+3*j] * w[k];
-              }
-            }
-          }
 
-        //vtkMath::Jacobi(m, sNext->W, sNext->V);
-        vtkDiffusionTensorMathematics::TeemEigenSolver(m,sNext->W,sNext->V);
-        FixVectors(sPtr->V, sNext->V, iv, ix, iy);
-
-        // compute invariants at final position
-        switch (this->GetStoppingMode()) {
-        case vtkDiffusionTensorMathematics::VTK_TENS_FRACTIONAL_ANISOTROPY:
-            stop = vtkDiffusionTensorMathematics::FractionalAnisotropy(sNext->W);
-            break;
-        case vtkDiffusionTensorMathematics::VTK_TENS_LINEAR_MEASURE:
-            stop = vtkDiffusionTensorMathematics::LinearMeasure(sNext->W);
-            break;
-        case vtkDiffusionTensorMathematics::VTK_TENS_PLANAR_MEASURE:
-            stop = vtkDiffusionTensorMathematics::PlanarMeasure(sNext->W);
-            break;
-        case vtkDiffusionTensorMathematics::VTK_TENS_SPHERICAL_MEASURE:
-            stop =  vtkDiffusionTensorMathematics::SphericalMeasure(sNext->W);
-            break;
-        default:
-            vtkErrorMacro( << "Should not happen" );
-        }
+        // compute eigenfunctions and invariants at final position
+        stop = this->EvaluateEigenSystem(cell, cellTensors, w, sPtr->V,
+                                         m, sNext->W, sNext->V, useTensorCache);
 
         // test FA cutoff
         if (stop < this->StoppingThreshold)
@@ -568,6 +505,104 @@ vtkPolyData *output = vtkPolyData::SafeDownCast(
   return 1;
 }
 
+double vtkHyperStreamlineDTMRI::EvaluateEigenSystem(
+  vtkCell *cell, vtkDataArray *cellTensors, double *w, double **previousV,
+  double **m, double *W, double **V, bool useTensorCache)
+{
+  int i, j, k;
+  double *tensor;
+  int iv = this->IntegrationEigenvector;
+  int ix = (iv + 1) % 3;
+  int iy = (iv + 2) % 3;
+
+  // interpolate tensor, only needed for the output when using the cache
+  for (j=0; j<3; j++)
+    {
+    for (i=0; i<3; i++)
+      {
+      m[i][j] = 0.0;
+      }
+    }
+  if (!useTensorCache || this->OutputTensors)
+    {
+    for (k=0; k < cell->GetNumberOfPoints(); k++)
+      {
+      tensor = cellTensors->GetTuple(k);
+      for (j=0; j<3; j++)
+        {
+        for (i=0; i<3; i++)
+          {
+          m[i][j] += tensor[i+3*j] * w[k];
+          }
+        }
+      }
+    }
+
+  if (!useTensorCache)
+    {
+    //vtkMath::Jacobi(m, W, V);
+    vtkDiffusionTensorMathematics::TeemEigenSolver(m,W,V);
+    FixVectors(previousV, V, iv, ix, iy);
+    return vtkTractographyTensorCache::ComputeMeasure(this->StoppingMode, W);
+    }
+
+  // interpolate the cached values of the cell points, the eigenvectors are
+  // flipped to point in the direction of the reference vector first.
+  double reference[3] = {0.0, 0.0, 0.0};
+  if (previousV)
+    {
+    for (i=0; i<3; i++)
+      {
+      reference[i] = previousV[i][iv];
+      }
+    }
+  double vector[3] = {0.0, 0.0, 0.0};
+  double eigenvalue = 0.0;
+  double measure = 0.0;
+  for (k=0; k < cell->GetNumberOfPoints(); k++)
+    {
+    const float *values = this->TensorCache->GetPointValues(cell->GetPointId(k));
+    if (!previousV && k == 0)
+      {
+      for (i=0; i<3; i++)
+        {
+        reference[i] = values[i];
+        }
+      }
+    double weight = w[k];
+    if (reference[0] * values[0] + reference[1] * values[1] +
+        reference[2] * values[2] < 0.0)
+      {
+      weight = -weight;
+      }
+    for (i=0; i<3; i++)
+      {
+      vector[i] += values[i] * weight;
+      }
+    eigenvalue += values[vtkTractographyTensorCache::EigenvalueIndex] * w[k];
+    measure += values[vtkTractographyTensorCache::MeasureIndex] * w[k];
+    }
+  if (vtkMath::Normalize(vector) == 0.0)
+    {
+    for (i=0; i<3; i++)
+      {
+      vector[i] = reference[i];
+      }
+    }
+  double vectorX[3], vectorY[3];
+  vtkMath::Perpendiculars(vector, vectorX, vectorY, 0.0);
+  for (i=0; i<3; i++)
+    {
+    V[i][iv] = vector[i];
+    V[i][ix] = vectorX[i];
+    V[i][iy] = vectorY[i];
+    }
+  W[0] = eigenvalue;
+  W[1] = W[2] = 0.0;
+  FixVectors(previousV, V, iv, ix, iy);
+  return measure;
+}
+
 void vtkHyperStreamlineDTMRI::BuildLines(vtkDataSet *input, vtkPolyData *output)
 {
 
@@ -911,6 +946,7 @@ void vtkHyperStreamlineDTMRI::PrintSelf(ostream& os, vtkIndent indent)
 
   os << indent << "Radius of Curvature "
     << this->RadiusOfCurvature << "\n";
+  os << indent << "TensorCache: " << this->TensorCache << "\n";
 }
 
 
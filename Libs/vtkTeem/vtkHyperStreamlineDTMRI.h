@@ -20,6 +20,10 @@
 #include "vtkDiffusionTensorMathematics.h" /// for VTK_TENS_FRACTIONAL_ANISOTROPY
 #include "vtkTractographyPointAndArray.h"
 
+class vtkCell;
+class vtkDataArray;
+class vtkTractographyTensorCache;
+
 /// \brief Generate hyperstreamline in arbitrary dataset.
 ///
 /// vtkHyperStreamlineDTMRI is a filter that integrates through a tensor field to
@@ -100,6 +104,17 @@ public:
   vtkSetMacro(OneTrajectoryPerSeedPoint, int);
   vtkBooleanMacro(OneTrajectoryPerSeedPoint, int);
 
+  ///
+  /// Eigen systems of the input tensors, computed once per point and
+  /// shared by all the streamlines using the same cache.
+  /// When set, the major eigenvector, major eigenvalue and stopping
+  /// measure of the cell points are interpolated at each step instead of
+  /// solving the eigen system of the interpolated tensor, which is much
+  /// faster but slightly different. Only used when integrating along the
+  /// major eigenvector. NULL by default.
+  void SetTensorCache(vtkTractographyTensorCache* cache);
+  vtkGetObjectMacro(TensorCache, vtkTractographyTensorCache);
+
 protected:
   vtkHyperStreamlineDTMRI();
   ~vtkHyperStreamlineDTMRI();
@@ -110,6 +125,14 @@ protected:
   void BuildLinesForSingleTrajectory(vtkDataSet *input, vtkPolyData *output);
   void BuildLinesForTwoTrajectories(vtkDataSet *input, vtkPolyData *output);
 
+  /// Compute the eigen system at the location given by the interpolation
+  /// weights w in the cell, and the interpolated tensor m.
+  /// Return the stopping measure at the location.
+  double EvaluateEigenSystem(vtkCell *cell, vtkDataArray *cellTensors,
+                             double *w, double **previousV,
+                             double **m, double *W, double **V,
+                             bool useTensorCache);
+
   double RadiusOfCurvature;
   int StoppingMode;
   double StoppingThreshold;
@@ -120,6 +143,8 @@ protected:
 
   vtkTractographyArray *Streamers;
 
+  vtkTractographyTensorCache *TensorCache;
+
 private:
   vtkHyperStreamlineDTMRI(const vtkHyperStreamlineDTMRI&);  /// Not implemented.
   void operator=(const vtkHyperStreamlineDTMRI&);  /// Not implemented.
@@ -346,6 +346,9 @@ void vtkSeedTracts::UpdateHyperStreamlinePointsSettings( vtkHyperStreamlineDTMRI
 
   currHSP->SetIntegrationStepLength(this->VtkHyperStreamlinePointsSettings->GetIntegrationStepLength());
 
+  // Eigen systems shared by all the streamlines
+  currHSP->SetTensorCache(this->VtkHyperStreamlinePointsSettings->GetTensorCache());
+
 }
 
 // Update settings of one hyper streamline:
@@ -0,0 +1,125 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+#include "vtkTractographyTensorCache.h"
+#include "vtkDiffusionTensorMathematics.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkObjectFactory.h>
+
+vtkStandardNewMacro(vtkTractographyTensorCache);
+
+//----------------------------------------------------------------------------
+vtkTractographyTensorCache::vtkTractographyTensorCache()
+{
+  this->Tensors = NULL;
+  this->TensorsMTime = 0;
+  this->StoppingMode = vtkDiffusionTensorMathematics::VTK_TENS_LINEAR_MEASURE;
+}
+
+//----------------------------------------------------------------------------
+vtkTractographyTensorCache::~vtkTractographyTensorCache()
+{
+  this->Initialize();
+}
+
+//----------------------------------------------------------------------------
+void vtkTractographyTensorCache::Initialize()
+{
+  if (this->Tensors)
+    {
+    this->Tensors->UnRegister(this);
+    this->Tensors = NULL;
+    }
+  this->TensorsMTime = 0;
+  this->Values.clear();
+  this->ComputedPoints.clear();
+}
+
+//----------------------------------------------------------------------------
+void vtkTractographyTensorCache::Prepare(vtkDataArray* tensors, int stoppingMode)
+{
+  if (tensors == this->Tensors &&
+      (!tensors || tensors->GetMTime() == this->TensorsMTime) &&
+      stoppingMode == this->StoppingMode)
+    {
+    return;
+    }
+  this->Initialize();
+  this->StoppingMode = stoppingMode;
+  if (!tensors)
+    {
+    return;
+    }
+  this->Tensors = tensors;
+  this->Tensors->Register(this);
+  this->TensorsMTime = tensors->GetMTime();
+  this->Values.resize(tensors->GetNumberOfTuples() * NumberOfValuesPerPoint);
+  this->ComputedPoints.assign(tensors->GetNumberOfTuples(), false);
+}
+
+//----------------------------------------------------------------------------
+void vtkTractographyTensorCache::ComputePointValues(vtkIdType pointId)
+{
+  double m0[3], m1[3], m2[3];
+  double v0[3], v1[3], v2[3];
+  double *m[3] = {m0, m1, m2};
+  double *v[3] = {v0, v1, v2};
+  double w[3];
+  double *tensor = this->Tensors->GetTuple(pointId);
+  for (int j=0; j<3; j++)
+    {
+    for (int i=0; i<3; i++)
+      {
+      m[i][j] = tensor[i+3*j];
+      }
+    }
+  vtkDiffusionTensorMathematics::TeemEigenSolver(m, w, v);
+
+  float *values = &this->Values[pointId * NumberOfValuesPerPoint];
+  for (int i=0; i<3; i++)
+    {
+    values[i] = static_cast<float>(v[i][0]);
+    }
+  values[EigenvalueIndex] = static_cast<float>(w[0]);
+  values[MeasureIndex] = static_cast<float>(
+    vtkTractographyTensorCache::ComputeMeasure(this->StoppingMode, w));
+  this->ComputedPoints[pointId] = true;
+}
+
+//----------------------------------------------------------------------------
+double vtkTractographyTensorCache::ComputeMeasure(int stoppingMode, double w[3])
+{
+  switch (stoppingMode)
+    {
+    case vtkDiffusionTensorMathematics::VTK_TENS_FRACTIONAL_ANISOTROPY:
+      return vtkDiffusionTensorMathematics::FractionalAnisotropy(w);
+    case vtkDiffusionTensorMathematics::VTK_TENS_LINEAR_MEASURE:
+      return vtkDiffusionTensorMathematics::LinearMeasure(w);
+    case vtkDiffusionTensorMathematics::VTK_TENS_PLANAR_MEASURE:
+      return vtkDiffusionTensorMathematics::PlanarMeasure(w);
+    case vtkDiffusionTensorMathematics::VTK_TENS_SPHERICAL_MEASURE:
+      return vtkDiffusionTensorMathematics::SphericalMeasure(w);
+    default:
+      break;
+    }
+  return 0.;
+}
+
+//----------------------------------------------------------------------------
+void vtkTractographyTensorCache::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "Tensors: " << this->Tensors << "\n";
+  os << indent << "StoppingMode: " << this->StoppingMode << "\n";
+  os << indent << "NumberOfPoints: " << this->ComputedPoints.size() << "\n";
+}
@@ -0,0 +1,102 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkTractographyTensorCache_h
+#define __vtkTractographyTensorCache_h
+
+#include "vtkTeemConfigure.h"
+
+// VTK includes
+#include <vtkObject.h>
+
+// STD includes
+#include <vector>
+
+class vtkDataArray;
+
+/// \brief Per point eigen system of a tensor field, for tractography.
+///
+/// Stores for each point of the tensor field the major eigenvector, the
+/// major eigenvalue and the anisotropy measure used as stopping criterion.
+/// A point is computed the first time it is accessed, and never again until
+/// the tensors are modified. Streamlines that share the cache (see
+/// vtkHyperStreamlineDTMRI::SetTensorCache) interpolate these values instead
+/// of solving the eigen system of the interpolated tensor at each step.
+///
+/// The cache is not thread safe.
+/// \sa vtkHyperStreamlineDTMRI
+class VTK_Teem_EXPORT vtkTractographyTensorCache : public vtkObject
+{
+public:
+  static vtkTractographyTensorCache *New();
+  vtkTypeMacro(vtkTractographyTensorCache,vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  ///
+  /// Make the cache ready for the tensors and stopping mode
+  /// (see vtkDiffusionTensorMathematics::VTK_TENS_LINEAR_MEASURE...).
+  /// The cache is emptied if any of them changed since the last call.
+  void Prepare(vtkDataArray* tensors, int stoppingMode);
+
+  ///
+  /// Empty the cache.
+  void Initialize();
+
+  ///
+  /// Number of values stored per point: the 3 components of the major
+  /// eigenvector, the major eigenvalue and the stopping measure.
+  enum
+    {
+    EigenvalueIndex = 3,
+    MeasureIndex = 4,
+    NumberOfValuesPerPoint = 5
+    };
+
+  ///
+  /// Values of a point of the tensors given to Prepare().
+  inline const float* GetPointValues(vtkIdType pointId);
+
+  ///
+  /// Anisotropy measure of the eigenvalues for the stopping mode,
+  /// 0 if the mode is unknown.
+  static double ComputeMeasure(int stoppingMode, double w[3]);
+
+protected:
+  vtkTractographyTensorCache();
+  ~vtkTractographyTensorCache();
+
+  void ComputePointValues(vtkIdType pointId);
+
+  vtkDataArray* Tensors;
+  unsigned long TensorsMTime;
+  int StoppingMode;
+
+  //BTX
+  std::vector<float> Values;
+  std::vector<bool> ComputedPoints;
+  //ETX
+
+private:
+  vtkTractographyTensorCache(const vtkTractographyTensorCache&);  /// Not implemented.
+  void operator=(const vtkTractographyTensorCache&);  /// Not implemented.
+};
+
+//----------------------------------------------------------------------------
+const float* vtkTractographyTensorCache::GetPointValues(vtkIdType pointId)
+{
+  if (!this->ComputedPoints[pointId])
+    {
+    this->ComputePointValues(pointId);
+    }
+  return &this->Values[pointId * NumberOfValuesPerPoint];
+}
+
+#endif
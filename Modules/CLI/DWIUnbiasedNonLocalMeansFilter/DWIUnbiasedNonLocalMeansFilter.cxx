@@ -216,6 +216,16 @@ int DoIt( int argc, char * argv[], PixelType )
     iNumNeighbors = 5;
     }
   filter->SetNeighbours( iNumNeighbors );
+  filter->SetUseFastAlgorithm( iFast );
+  unsigned int blockStep = ( iFast && iBlockStep > 1 ? iBlockStep : 1 );
+  for( unsigned int d = 0; d < DIMENSION; ++d )
+    {
+    if( blockStep > indexRadiusC[d] + 1 )
+      {
+      blockStep = indexRadiusC[d] + 1;
+      }
+    }
+  filter->SetBlockStep( blockStep );
 // ======================================================================================================
 // Noise estimation
   typedef itk::Image<float, DiffusionImageType::ImageDimension>           NoiseImageType;
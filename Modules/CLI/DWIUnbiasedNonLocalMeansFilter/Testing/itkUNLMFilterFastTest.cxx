@@ -0,0 +1,162 @@
+/*=========================================================================
+
+  Program:   Slicer
+  Language:  C++
+  Module:    $HeadURL$
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See License.txt or http://www.slicer.org/copyright/copyright.txt for details.
+
+==========================================================================*/
+
+// DWIUnbiasedNonLocalMeansFilter includes
+#include "itkUNLMFilter.h"
+
+// ITK includes
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+#include <itkVectorImage.h>
+
+// STD includes
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+
+typedef itk::VectorImage<unsigned short, 3>                 DiffusionImageType;
+typedef itk::VectorImage<double, 3>                         OutputImageType;
+typedef itk::UNLMFilter<DiffusionImageType, OutputImageType> FilterType;
+
+const unsigned int NumberOfBaselines = 1;
+const unsigned int NumberOfGradients = 6;
+const float        Sigma = 10.0f;
+
+// Deterministic pseudo-random noise, uniform with standard deviation sigma
+double Noise( unsigned long seed, double sigma )
+{
+  const double value = std::sin( seed * 12.9898 ) * 43758.5453;
+  return ( value - std::floor( value ) - 0.5 ) * std::sqrt( 12.0 ) * sigma;
+}
+
+// Piecewise constant synthetic DWI with Rician-like noise
+DiffusionImageType::Pointer CreateDWI()
+{
+  DiffusionImageType::SizeType size;
+  size[0] = 24;
+  size[1] = 20;
+  size[2] = 10;
+  DiffusionImageType::Pointer image = DiffusionImageType::New();
+  image->SetRegions( size );
+  image->SetVectorLength( NumberOfBaselines + NumberOfGradients );
+  image->Allocate();
+
+  itk::ImageRegionIterator<DiffusionImageType> it( image, image->GetLargestPossibleRegion() );
+  DiffusionImageType::PixelType                pixel( image->GetVectorLength() );
+  unsigned long                                seed = 1;
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const DiffusionImageType::IndexType idx = it.GetIndex();
+    const double                        inside = ( idx[0] > 6 && idx[0] < 18 && idx[1] > 4 && idx[1] < 16 ) ? 1.0 : 0.3;
+    for( unsigned int c = 0; c < image->GetVectorLength(); ++c )
+      {
+      const double signal = 400.0 * inside * ( c < NumberOfBaselines ? 1.0 : 0.5 + 0.05 * c );
+      const double real = signal + Noise( seed++, Sigma );
+      const double imag = Noise( seed++, Sigma );
+      pixel[c] = static_cast<unsigned short>( std::sqrt( real * real + imag * imag ) );
+      }
+    it.Set( pixel );
+    }
+  return image;
+}
+
+OutputImageType::Pointer RunFilter( DiffusionImageType * input, bool fast, unsigned int blockStep )
+{
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( input );
+  FilterType::InputImageSizeType radiusSearch;
+  radiusSearch.Fill( 2 );
+  FilterType::InputImageSizeType radiusComp;
+  radiusComp.Fill( 1 );
+  filter->SetRSearch( radiusSearch );
+  filter->SetRComp( radiusComp );
+  unsigned int baselines[NumberOfBaselines] = { 0 };
+  unsigned int dwi[NumberOfGradients];
+  for( unsigned int g = 0; g < NumberOfGradients; ++g )
+    {
+    FilterType::GradientType grad;
+    grad[0] = std::cos( 0.5 * g );
+    grad[1] = std::sin( 0.5 * g );
+    grad[2] = 0.1 * g;
+    grad.Normalize();
+    filter->AddGradientDirection( grad );
+    dwi[g] = NumberOfBaselines + g;
+    }
+  filter->SetNDWI( NumberOfGradients );
+  filter->SetNBaselines( NumberOfBaselines );
+  filter->SetDWI( dwi );
+  filter->SetBaselines( baselines );
+  filter->SetNeighbours( 3 );
+  filter->SetSigma( Sigma );
+  filter->SetH( Sigma );
+  filter->SetUseFastAlgorithm( fast );
+  filter->SetBlockStep( blockStep );
+  filter->Update();
+  return filter->GetOutput();
+}
+
+// Largest absolute difference, and mean absolute difference relative to the mean of the reference
+void Compare( OutputImageType * reference, OutputImageType * test, double & maxError, double & meanError )
+{
+  itk::ImageRegionConstIterator<OutputImageType> rit( reference, reference->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator<OutputImageType> tit( test, test->GetLargestPossibleRegion() );
+  double                                         sumError = 0.0;
+  double                                         sumReference = 0.0;
+  maxError = 0.0;
+  for( rit.GoToBegin(), tit.GoToBegin(); !rit.IsAtEnd(); ++rit, ++tit )
+    {
+    for( unsigned int c = 0; c < reference->GetNumberOfComponentsPerPixel(); ++c )
+      {
+      const double error = std::fabs( rit.Get()[c] - tit.Get()[c] );
+      maxError = ( error > maxError ? error : maxError );
+      sumError += error;
+      sumReference += std::fabs( rit.Get()[c] );
+      }
+    }
+  meanError = ( sumReference > 0.0 ? sumError / sumReference : 0.0 );
+}
+
+} // end of anonymous namespace
+
+int main( int, char * [] )
+{
+  DiffusionImageType::Pointer input = CreateDWI();
+
+  OutputImageType::Pointer exact = RunFilter( input, false, 1 );
+  OutputImageType::Pointer fast = RunFilter( input, true, 1 );
+  double                   maxError;
+  double                   meanError;
+  Compare( exact, fast, maxError, meanError );
+  std::cout << "Fast algorithm: max error " << maxError << ", mean relative error " << meanError << std::endl;
+  // Only rounding differences are expected
+  if( maxError > 1e-2 )
+    {
+    std::cerr << "Fast algorithm differs from the exact one" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  OutputImageType::Pointer blockwise = RunFilter( input, true, 2 );
+  Compare( exact, blockwise, maxError, meanError );
+  std::cout << "Blockwise algorithm: max error " << maxError << ", mean relative error " << meanError << std::endl;
+  // Different estimator: only check it stays close to the voxelwise one
+  if( meanError > 0.05 )
+    {
+    std::cerr << "Blockwise algorithm differs too much from the voxelwise one" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -76,6 +76,7 @@ public:
   typedef typename InputImageType::RegionType  InputImageRegionType;
   typedef typename InputImageType::SizeType    InputImageSizeType;
   typedef typename InputImageType::IndexType   InputImageIndexType;
+  typedef typename InputImageType::OffsetType  InputImageOffsetType;
   typedef typename OutputImageType::RegionType OutputImageRegionType;
   typedef typename OutputPixelType::ValueType  ScalarType;
 
@@ -109,6 +110,25 @@ public:
   itkSetMacro( RComp,      InputImageSizeType );
   itkGetMacro( RComp,      InputImageSizeType );
 
+  /** Use the accelerated implementation. Instead of comparing each patch
+   *  with ConstNeighborhoodIterators, the squared differences between the
+   *  image and its translated version are computed once per search offset
+   *  over the whole region of each thread, and the Gaussian-weighted patch
+   *  distances are obtained with separable running sums. The result only
+   *  differs from the exact implementation by floating point rounding. */
+  itkSetMacro( UseFastAlgorithm, bool );
+  itkGetMacro( UseFastAlgorithm, bool );
+  itkBooleanMacro( UseFastAlgorithm );
+
+  /** Blockwise aggregation (fast implementation only): patch distances and
+   *  weights are only computed for block centers taken every BlockStep
+   *  voxels, each block is restored as a whole in a single pass over its
+   *  search window and the estimates of overlapping blocks are averaged. A
+   *  value of 1 (default) means voxelwise filtering. BlockStep must not be
+   *  greater than RComp + 1 along any axis so that every voxel is covered. */
+  itkSetMacro( BlockStep, unsigned int );
+  itkGetMacro( BlockStep, unsigned int );
+
   /** Add a new gradient direction: */
   void AddGradientDirection( GradientType grad )
   {
@@ -167,10 +187,39 @@ protected:
 
   void GenerateInputRequestedRegion();
 
+  // Accelerated implementation of ThreadedGenerateData
+  void FastThreadedGenerateData( const OutputImageRegionType & outputRegionForThread );
+
 private:
   UNLMFilter(const Self &);        // purposely not implemented
   void operator=(const Self &);    // purposely not implemented
 
+  // Offset of the given index in a buffer laid out over the given region
+  static unsigned long BufferOffset( const InputImageIndexType & index, const InputImageRegionType & region );
+
+  // Copy one channel of the input over an arbitrary region into a float
+  // buffer, replicating the border values outside the buffered region
+  void ExtractChannel( unsigned int channel, const InputImageRegionType & region, float* buffer ) const;
+
+  // Weighted sum of a buffer along one axis; the output is shrunk by
+  // kernel.size() - 1 samples along that axis
+  static void WeightedSumAlongAxis( const float* in, const InputImageSizeType & inSize, unsigned int axis,
+                                    const std::vector<float> & kernel, float* out );
+
+  // Restore the squared values of the block of the given center, weighting
+  // the translated blocks of its search window by the distances between the
+  // patches of the block center
+  void RestoreBlock( const InputImageIndexType & center, const std::vector<const float *> & compared,
+                     unsigned int numCompared, const InputImageRegionType & values,
+                     const std::vector<float> & window, const std::vector<long> & windowShifts,
+                     float weightScale, float* block ) const;
+
+  // Add a restored block to the estimates of the voxels of the output region
+  // it overlaps
+  void AddBlock( const InputImageIndexType & center, const std::vector<float> & block,
+                 const std::vector<InputImageOffsetType> & blockOffsets, const OutputImageRegionType & outputRegion,
+                 float* estimate, float* coverage ) const;
+
   // The list of gradient directions:
   GradientListType m_GradientList;
   // The number of DWI and baselines to use:
@@ -189,6 +238,9 @@ private:
   float              m_H;
   InputImageSizeType m_RSearch;
   InputImageSizeType m_RComp;
+  // Accelerated implementation:
+  bool         m_UseFastAlgorithm;
+  unsigned int m_BlockStep;
 };
 
 } // end namespace itk
@@ -19,10 +19,12 @@
 #include "itkUNLMFilter.h"
 
 #include "itkConstNeighborhoodIterator.h"
+#include "itkImageRegionConstIterator.h"
 #include "itkImageRegionIterator.h"
 #include "itkNeighborhoodAlgorithm.h"
 #include "itkZeroFluxNeumannBoundaryCondition.h"
 #include "math.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -41,6 +43,8 @@ UNLMFilter<TInputImage, TOutputImage>
   m_H             = 1.0f;
   m_RSearch.Fill(3);
   m_RComp.Fill(1);
+  m_UseFastAlgorithm = false;
+  m_BlockStep     = 1;
 }
 
 template <class TInputImage, class TOutputImage>
@@ -57,6 +61,18 @@ void UNLMFilter<TInputImage, TOutputImage>
     {
     itkExceptionMacro( << "Bad iniialisation of the filter!!! Check parameters, please" );
     }
+  if( m_BlockStep < 1 )
+    {
+    m_BlockStep = 1;
+    }
+  for( unsigned int d = 0; d < TInputImage::ImageDimension && m_BlockStep > 1; ++d )
+    {
+    if( !m_UseFastAlgorithm || m_BlockStep > m_RComp[d] + 1 )
+      {
+      itkExceptionMacro( << "Blockwise aggregation needs the fast algorithm and a block step not greater than "
+                         << "the comparison radius + 1 along each axis" );
+      }
+    }
   m_NeighboursInd = NeighboursIndType( m_NDWI, m_Neighbours );
 
   // Vectors to compute the distance from each gradient direction to each other gradient direction; we need to sort to
@@ -121,6 +137,11 @@ void UNLMFilter<TInputImage, TOutputImage>
   // Pad the input requested region by the operator radius
   InputImageSizeType radius;
   radius = m_RSearch + m_RComp;
+  if( m_UseFastAlgorithm && m_BlockStep > 1 )
+    {
+    // Blocks centered outside the output region overlap it
+    radius = radius + m_RComp;
+    }
   inputRequestedRegion.PadByRadius( radius );
 
   // Crop the input requested region at the input's largest possible region
@@ -134,6 +155,11 @@ void UNLMFilter<TInputImage, TOutputImage>
 ::ThreadedGenerateData( const OutputImageRegionType& outputRegionForThread,
                         ThreadIdType itkNotUsed(threadId) )
 {
+  if( m_UseFastAlgorithm )
+    {
+    this->FastThreadedGenerateData( outputRegionForThread );
+    return;
+    }
   // Boundary conditions for this filter; Neumann conditions are fine
   ZeroFluxNeumannBoundaryCondition<InputImageType> nbc;
   // Iterators:
@@ -395,6 +421,538 @@ void UNLMFilter<TInputImage, TOutputImage>
   delete[] valsD;
 }
 
+
+template <class TInputImage, class TOutputImage>
+unsigned long UNLMFilter<TInputImage, TOutputImage>
+::BufferOffset( const InputImageIndexType & index, const InputImageRegionType & region )
+{
+  unsigned long offset = 0;
+  unsigned long stride = 1;
+  for( unsigned int d = 0; d < TInputImage::ImageDimension; ++d )
+    {
+    offset += ( index[d] - region.GetIndex()[d] ) * stride;
+    stride *= region.GetSize()[d];
+    }
+  return offset;
+}
+
+template <class TInputImage, class TOutputImage>
+void UNLMFilter<TInputImage, TOutputImage>
+::ExtractChannel( unsigned int channel, const InputImageRegionType & region, float* buffer ) const
+{
+  InputImageConstPointer     input    = this->GetInput();
+  const InputImageRegionType buffered = input->GetBufferedRegion();
+  InputImageIndexType        idx      = region.GetIndex();
+  InputImageIndexType        clamped;
+  const unsigned long        numberOfPixels = region.GetNumberOfPixels();
+  for( unsigned long p = 0; p < numberOfPixels; ++p )
+    {
+    // Zero flux Neumann boundary condition, as in the exact implementation
+    for( unsigned int d = 0; d < TInputImage::ImageDimension; ++d )
+      {
+      const long lo = buffered.GetIndex()[d];
+      const long hi = lo + static_cast<long>( buffered.GetSize()[d] ) - 1;
+      clamped[d] = ( idx[d] < lo ? lo : ( idx[d] > hi ? hi : idx[d] ) );
+      }
+    buffer[p] = static_cast<float>( input->GetPixel( clamped )[channel] );
+    for( unsigned int d = 0; d < TInputImage::ImageDimension; ++d )
+      {
+      if( ++idx[d] < region.GetIndex()[d] + static_cast<long>( region.GetSize()[d] ) )
+        {
+        break;
+        }
+      idx[d] = region.GetIndex()[d];
+      }
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void UNLMFilter<TInputImage, TOutputImage>
+::WeightedSumAlongAxis( const float* in, const InputImageSizeType & inSize, unsigned int axis,
+                        const std::vector<float> & kernel, float* out )
+{
+  const unsigned long width = kernel.size();
+  unsigned long       inner = 1;
+  unsigned long       outer = 1;
+  for( unsigned int d = 0; d < TInputImage::ImageDimension; ++d )
+    {
+    if( d < axis )
+      {
+      inner *= inSize[d];
+      }
+    else if( d > axis )
+      {
+      outer *= inSize[d];
+      }
+    }
+  const unsigned long inLength  = inSize[axis];
+  const unsigned long outLength = inLength - width + 1;
+  for( unsigned long o = 0; o < outer; ++o )
+    {
+    const float* inLine  = in  + o * inLength * inner;
+    float*       outLine = out + o * outLength * inner;
+    for( unsigned long i = 0; i < outLength; ++i )
+      {
+      float* dst = outLine + i * inner;
+      for( unsigned long j = 0; j < inner; ++j )
+        {
+        dst[j] = 0.0f;
+        }
+      for( unsigned long t = 0; t < width; ++t )
+        {
+        const float  w   = kernel[t];
+        const float* src = inLine + ( i + t ) * inner;
+        // Contiguous loop, vectorised by the compiler for all axes but the first one
+        for( unsigned long j = 0; j < inner; ++j )
+          {
+          dst[j] += w * src[j];
+          }
+        }
+      }
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void UNLMFilter<TInputImage, TOutputImage>
+::FastThreadedGenerateData( const OutputImageRegionType& outputRegionForThread )
+{
+  const unsigned int     Dimension = TInputImage::ImageDimension;
+  InputImageConstPointer input     = this->GetInput();
+  OutputImagePointer     output    = this->GetOutput();
+  const InputImageRegionType largest = input->GetLargestPossibleRegion();
+  if( outputRegionForThread.GetNumberOfPixels() == 0 )
+    {
+    return;
+    }
+  // -------------------------------------------------------------------------------------------------------------
+  // REGIONS:
+  // - the patch centers whose weights are needed: the output region (plus the blocks overlapping it)
+  // - the squared differences needed to compute the distances of these patches
+  // - the input values needed for all the search offsets
+  const unsigned int   step = m_BlockStep;
+  InputImageRegionType centers = outputRegionForThread;
+  if( step > 1 )
+    {
+    centers.PadByRadius( m_RComp );
+    centers.Crop( largest );
+    }
+  InputImageRegionType differences = centers;
+  differences.PadByRadius( m_RComp );
+  InputImageRegionType values = differences;
+  values.PadByRadius( m_RSearch );
+  const unsigned long numCenters     = centers.GetNumberOfPixels();
+  const unsigned long numDifferences = differences.GetNumberOfPixels();
+  const unsigned long numValues      = values.GetNumberOfPixels();
+  const unsigned long numOutput      = outputRegionForThread.GetNumberOfPixels();
+  // Stride of each axis in the buffer of input values:
+  long valuesStride[TInputImage::ImageDimension];
+  valuesStride[0] = 1;
+  for( unsigned int d = 1; d < Dimension; ++d )
+    {
+    valuesStride[d] = valuesStride[d - 1] * values.GetSize()[d - 1];
+    }
+  // -------------------------------------------------------------------------------------------------------------
+  // SEPARABLE GAUSSIAN WINDOW (std=1):
+  // The window of the exact implementation is the product of 1D Gaussians except at its center, where it
+  // takes the value of the closest pixel; this is corrected after the separable sums.
+  std::vector<std::vector<float> > kernels( Dimension );
+  for( unsigned int d = 0; d < Dimension; ++d )
+    {
+    for( long t = -static_cast<long>( m_RComp[d] ); t <= static_cast<long>( m_RComp[d] ); ++t )
+      {
+      kernels[d].push_back( ::exp( -static_cast<float>( t * t ) / 2 ) );
+      }
+    }
+  // The blockwise aggregation uses the whole (non-separable) window, and its offsets in the buffer of input
+  // values which are also the voxels of a block.
+  float        sum = itk::NumericTraits<float>::ZeroValue();
+  float        previous = 1.0f;
+  float        centerWeight = 1.0f;
+  unsigned int windowSize = 1;
+  for( unsigned int d = 0; d < Dimension; ++d )
+    {
+    windowSize *= kernels[d].size();
+    }
+  std::vector<float>                window( windowSize );
+  std::vector<InputImageOffsetType> windowOffsets( windowSize );
+  std::vector<long>                 windowShifts( windowSize );
+  for( unsigned int k = 0; k < windowSize; ++k )
+    {
+    float        dist = itk::NumericTraits<float>::ZeroValue();
+    unsigned int aux = k;
+    windowShifts[k] = 0;
+    for( unsigned int d = 0; d < Dimension; ++d )
+      {
+      const long t = static_cast<long>( aux % kernels[d].size() ) - static_cast<long>( m_RComp[d] );
+      aux /= kernels[d].size();
+      dist += static_cast<float>( t * t );
+      windowOffsets[k][d] = t;
+      windowShifts[k] += t * valuesStride[d];
+      }
+    float w = ::exp( -dist / 2 );
+    if( k == windowSize / 2 )
+      {
+      w = ( k > 0 ? previous : 1.0f );
+      centerWeight = w;
+      }
+    previous = w;
+    window[k] = w;
+    sum += w;
+    }
+  for( unsigned int t = 0; t < kernels[0].size(); ++t )
+    {
+    kernels[0][t] /= sum;
+    }
+  for( unsigned int k = 0; k < windowSize; ++k )
+    {
+    window[k] /= sum;
+    }
+  const float centerCorrection = ( centerWeight - 1.0f ) / sum;
+  // -------------------------------------------------------------------------------------------------------------
+  // BUFFERS (local to this thread); the voxelwise buffers are not needed for blockwise aggregation:
+  const unsigned long              numVoxelwise = ( step > 1 ? 0 : numDifferences );
+  std::vector<std::vector<float> > channelValues( m_Neighbours, std::vector<float>( numValues ) );
+  std::vector<const float *>       compared( m_Neighbours );
+  std::vector<float>               squaredDiff( numVoxelwise );
+  std::vector<float>               partial( numVoxelwise );
+  std::vector<float>               distances( numVoxelwise );
+  std::vector<float>               sumW( step > 1 ? 0 : numCenters );
+  std::vector<float>               maxW( step > 1 ? 0 : numCenters );
+  std::vector<float>               sumWV( step > 1 ? 0 : numCenters );
+  std::vector<float>               block( step > 1 ? windowSize : 0 );
+  std::vector<float>               estimate( step > 1 ? numOutput : 0 );
+  std::vector<float>               coverage( step > 1 ? numOutput : 0 );
+  const float                      sqh = 1.0f / (m_H * m_H);
+  // Copy the input to the output; the channels which are neither baselines nor DWI are not filtered
+  ImageRegionConstIterator<InputImageType> init( input, outputRegionForThread );
+  ImageRegionIterator<OutputImageType>     it( output, outputRegionForThread );
+  for( init.GoToBegin(), it.GoToBegin(); !it.IsAtEnd(); ++init, ++it )
+    {
+    OutputPixelType op = init.Get();
+    it.Set( op );
+    }
+  // Lines (along the first axis) of the regions of centers and output:
+  const unsigned long centerLines  = numCenters / centers.GetSize()[0];
+  const unsigned long outputLines  = numOutput / outputRegionForThread.GetSize()[0];
+  const long          largestBegin = largest.GetIndex()[0];
+  const long          largestEnd   = largestBegin + static_cast<long>( largest.GetSize()[0] );
+  // -------------------------------------------------------------------------------------------------------------
+  // FILTER EACH CHANNEL: baselines first, then gradient images
+  for( unsigned int c = 0; c < m_NBaselines + m_NDWI; ++c )
+    {
+    const bool         isBaseline = ( c < m_NBaselines );
+    const unsigned int j          = ( isBaseline ? c : c - m_NBaselines );
+    const unsigned int channel    = ( isBaseline ? m_Baselines[j] : m_DWI[j] );
+    // Baselines are compared only with themselves; gradient images with their closest gradient directions too:
+    const unsigned int numCompared = ( isBaseline ? 1 : m_Neighbours );
+    const float        scale       = ( isBaseline ? 0.0625f : 1.0f );
+    for( unsigned int g = 0; g < numCompared; ++g )
+      {
+      this->ExtractChannel( ( g == 0 ? channel : m_NeighboursInd[j][g] ), values, &channelValues[g][0] );
+      compared[g] = &channelValues[g][0];
+      }
+    const float* own = &channelValues[0][0];
+    std::fill( estimate.begin(), estimate.end(), 0.0f );
+    std::fill( coverage.begin(), coverage.end(), 0.0f );
+    if( step > 1 )
+      {
+      // ---------------------------------------------------------------------------------------------------------
+      // Blockwise aggregation: the patch distances are only computed at the centers of the block grid, and each
+      // block is restored in a single pass over its search window. The estimates of overlapping blocks are
+      // averaged.
+      InputImageIndexType center = centers.GetIndex();
+      for( unsigned long k = 0; k < numCenters; ++k )
+        {
+        bool onGrid = true;
+        for( unsigned int d = 0; d < Dimension; ++d )
+          {
+          onGrid = onGrid && ( ( center[d] - largest.GetIndex()[d] ) % step == 0 );
+          }
+        if( onGrid )
+          {
+          this->RestoreBlock( center, compared, numCompared, values, window, windowShifts, sqh * scale,
+                              &block[0] );
+          this->AddBlock( center, block, windowOffsets, outputRegionForThread, &estimate[0], &coverage[0] );
+          }
+        for( unsigned int d = 0; d < Dimension; ++d )
+          {
+          if( ++center[d] < centers.GetIndex()[d] + static_cast<long>( centers.GetSize()[d] ) )
+            {
+            break;
+            }
+          center[d] = centers.GetIndex()[d];
+          }
+        }
+      }
+    else
+      {
+      std::fill( sumW.begin(), sumW.end(), 0.0f );
+      std::fill( maxW.begin(), maxW.end(), -100.0f );
+      std::fill( sumWV.begin(), sumWV.end(), 0.0f );
+      for( unsigned int g = 0; g < numCompared; ++g )
+        {
+        const float*        comparedValues = compared[g];
+        InputImageIndexType offset;
+        for( unsigned int d = 0; d < Dimension; ++d )
+          {
+          offset[d] = -static_cast<long>( m_RSearch[d] );
+          }
+        bool searchDone = false;
+        while( !searchDone )
+          {
+          bool isCenter = true;
+          long shift = 0;
+          for( unsigned int d = 0; d < Dimension; ++d )
+            {
+            isCenter = isCenter && ( offset[d] == 0 );
+            shift += offset[d] * valuesStride[d];
+            }
+          // The center of the search window is weighted separately for the same gradient direction
+          if( !( isCenter && g == 0 ) )
+            {
+            // ---------------------------------------------------------------------------------------------------
+            // Squared differences between the image and its translated version:
+            InputImageIndexType line = differences.GetIndex();
+            const unsigned long lineLength = differences.GetSize()[0];
+            const unsigned long numLines   = numDifferences / lineLength;
+            for( unsigned long l = 0; l < numLines; ++l )
+              {
+              const unsigned long base = BufferOffset( line, values );
+              const float*        a = own + base;
+              const float*        b = comparedValues + base + shift;
+              float*              dst = &squaredDiff[l * lineLength];
+              for( unsigned long i = 0; i < lineLength; ++i )
+                {
+                const float aux = a[i] - b[i];
+                dst[i] = aux * aux;
+                }
+              for( unsigned int d = 1; d < Dimension; ++d )
+                {
+                if( ++line[d] < differences.GetIndex()[d] + static_cast<long>( differences.GetSize()[d] ) )
+                  {
+                  break;
+                  }
+                line[d] = differences.GetIndex()[d];
+                }
+              }
+            // ---------------------------------------------------------------------------------------------------
+            // Gaussian-weighted patch distances with separable sums:
+            InputImageSizeType size = differences.GetSize();
+            const float*       in = &squaredDiff[0];
+            for( unsigned int d = 0; d < Dimension; ++d )
+              {
+              float* out = ( in == &partial[0] ? &distances[0] : &partial[0] );
+              WeightedSumAlongAxis( in, size, d, kernels[d], out );
+              size[d] -= kernels[d].size() - 1;
+              in = out;
+              }
+            if( in != &distances[0] )
+              {
+              std::copy( in, in + numCenters, distances.begin() );
+              }
+            // ---------------------------------------------------------------------------------------------------
+            // Weights of the valid offsets (translated patch center inside the image):
+            line = centers.GetIndex();
+            for( unsigned long l = 0; l < centerLines; ++l )
+              {
+              bool inside = true;
+              for( unsigned int d = 1; d < Dimension; ++d )
+                {
+                const long pos = line[d] + offset[d];
+                inside = inside && pos >= largest.GetIndex()[d]
+                  && pos < largest.GetIndex()[d] + static_cast<long>( largest.GetSize()[d] );
+                }
+              const long    centersLength = static_cast<long>( centers.GetSize()[0] );
+              long          first = largestBegin - line[0] - offset[0];
+              long          last  = largestEnd - line[0] - offset[0];
+              first = ( first < 0 ? 0 : first );
+              last  = ( last > centersLength ? centersLength : last );
+              const unsigned long centerBase = l * centersLength;
+              const unsigned long valueBase  = BufferOffset( line, values );
+              const unsigned long diffBase   = BufferOffset( line, differences );
+              for( long i = ( inside ? first : centersLength ); i < last; ++i )
+                {
+                float dist = distances[centerBase + i] + centerCorrection * squaredDiff[diffBase + i];
+                const float w = ::exp( -dist * sqh * scale );
+                const float v = comparedValues[valueBase + shift + i];
+                sumW[centerBase + i] += w;
+                maxW[centerBase + i] = ( w > maxW[centerBase + i] ? w : maxW[centerBase + i] );
+                sumWV[centerBase + i] += w * v * v;
+                }
+              for( unsigned int d = 1; d < Dimension; ++d )
+                {
+                if( ++line[d] < centers.GetIndex()[d] + static_cast<long>( centers.GetSize()[d] ) )
+                  {
+                  break;
+                  }
+                line[d] = centers.GetIndex()[d];
+                }
+              }
+            }
+          // Next search offset:
+          searchDone = true;
+          for( unsigned int d = 0; d < Dimension; ++d )
+            {
+            if( ++offset[d] <= static_cast<long>( m_RSearch[d] ) )
+              {
+              searchDone = false;
+              break;
+              }
+            offset[d] = -static_cast<long>( m_RSearch[d] );
+            }
+          }
+        }
+      // ---------------------------------------------------------------------------------------------------------
+      // Weight of the center of the search window (avoid over-weighting), and normalization:
+      for( unsigned long k = 0; k < numCenters; ++k )
+        {
+        const float wc = ( maxW[k] > 1e-6 ? maxW[k] : 1.0f );
+        sumW[k] += wc;
+        maxW[k]  = wc;
+        }
+      }
+    InputImageIndexType line = outputRegionForThread.GetIndex();
+    const unsigned long lineLength = outputRegionForThread.GetSize()[0];
+    it.GoToBegin();
+    for( unsigned long l = 0; l < outputLines; ++l )
+      {
+      const unsigned long centerBase = BufferOffset( line, centers );
+      const unsigned long valueBase  = BufferOffset( line, values );
+      for( unsigned long i = 0; i < lineLength; ++i, ++it )
+        {
+        float value;
+        if( step > 1 )
+          {
+          value = estimate[l * lineLength + i] / coverage[l * lineLength + i];
+          }
+        else
+          {
+          const float v = own[valueBase + i];
+          value = ( sumWV[centerBase + i] + maxW[centerBase + i] * v * v ) / sumW[centerBase + i];
+          }
+        // Remove Rician bias:
+        value -= 2.0f * m_Sigma * m_Sigma;
+        value = ( value > 1e-10 ? ::sqrt(value) : itk::NumericTraits<float>::ZeroValue() );
+        OutputPixelType op = it.Get();
+        op[channel] = static_cast<ScalarType>(value);
+        it.Set( op );
+        }
+      for( unsigned int d = 1; d < Dimension; ++d )
+        {
+        if( ++line[d] < outputRegionForThread.GetIndex()[d]
+            + static_cast<long>( outputRegionForThread.GetSize()[d] ) )
+          {
+          break;
+          }
+        line[d] = outputRegionForThread.GetIndex()[d];
+        }
+      }
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void UNLMFilter<TInputImage, TOutputImage>
+::RestoreBlock( const InputImageIndexType & center, const std::vector<const float *> & compared,
+                unsigned int numCompared, const InputImageRegionType & values, const std::vector<float> & window,
+                const std::vector<long> & windowShifts, float weightScale, float* block ) const
+{
+  const unsigned int         Dimension = TInputImage::ImageDimension;
+  const InputImageRegionType largest = this->GetInput()->GetLargestPossibleRegion();
+  const unsigned long        windowSize = window.size();
+  const float*               own = compared[0];
+  const unsigned long        base = BufferOffset( center, values );
+  long                       valuesStride[TInputImage::ImageDimension];
+  valuesStride[0] = 1;
+  for( unsigned int d = 1; d < Dimension; ++d )
+    {
+    valuesStride[d] = valuesStride[d - 1] * values.GetSize()[d - 1];
+    }
+  std::fill( block, block + windowSize, 0.0f );
+  float sumW = itk::NumericTraits<float>::ZeroValue();
+  float maxW = -100.0f;
+  for( unsigned int g = 0; g < numCompared; ++g )
+    {
+    const float*        comparedValues = compared[g];
+    InputImageIndexType offset;
+    for( unsigned int d = 0; d < Dimension; ++d )
+      {
+      offset[d] = -static_cast<long>( m_RSearch[d] );
+      }
+    bool searchDone = false;
+    while( !searchDone )
+      {
+      bool isCenter = true;
+      bool inside = true;
+      long shift = 0;
+      for( unsigned int d = 0; d < Dimension; ++d )
+        {
+        const long pos = center[d] + offset[d];
+        isCenter = isCenter && ( offset[d] == 0 );
+        inside = inside && pos >= largest.GetIndex()[d]
+          && pos < largest.GetIndex()[d] + static_cast<long>( largest.GetSize()[d] );
+        shift += offset[d] * valuesStride[d];
+        }
+      // The center of the search window is weighted separately for the same gradient direction
+      if( inside && !( isCenter && g == 0 ) )
+        {
+        // Gaussian-weighted distance between the patches of the block center only:
+        float dist = itk::NumericTraits<float>::ZeroValue();
+        for( unsigned long k = 0; k < windowSize; ++k )
+          {
+          const float aux = own[base + windowShifts[k]] - comparedValues[base + shift + windowShifts[k]];
+          dist += window[k] * aux * aux;
+          }
+        const float w = ::exp( -dist * weightScale );
+        sumW += w;
+        maxW = ( w > maxW ? w : maxW );
+        for( unsigned long k = 0; k < windowSize; ++k )
+          {
+          const float v = comparedValues[base + shift + windowShifts[k]];
+          block[k] += w * v * v;
+          }
+        }
+      // Next search offset:
+      searchDone = true;
+      for( unsigned int d = 0; d < Dimension; ++d )
+        {
+        if( ++offset[d] <= static_cast<long>( m_RSearch[d] ) )
+          {
+          searchDone = false;
+          break;
+          }
+        offset[d] = -static_cast<long>( m_RSearch[d] );
+        }
+      }
+    }
+  // Weight of the center of the search window (avoid over-weighting), and normalization:
+  const float wc = ( maxW > 1e-6 ? maxW : 1.0f );
+  sumW += wc;
+  for( unsigned long k = 0; k < windowSize; ++k )
+    {
+    const float v = own[base + windowShifts[k]];
+    block[k] = ( block[k] + wc * v * v ) / sumW;
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void UNLMFilter<TInputImage, TOutputImage>
+::AddBlock( const InputImageIndexType & center, const std::vector<float> & block,
+            const std::vector<InputImageOffsetType> & blockOffsets, const OutputImageRegionType & outputRegion,
+            float* estimate, float* coverage ) const
+{
+  for( unsigned long k = 0; k < block.size(); ++k )
+    {
+    const InputImageIndexType idx = center + blockOffsets[k];
+    // Only the voxels in the output region of the thread
+    if( outputRegion.IsInside( idx ) )
+      {
+      const unsigned long o = BufferOffset( idx, outputRegion );
+      estimate[o] += block[k];
+      coverage[o] += 1.0f;
+      }
+    }
+}
+
 } // end namespace itk
 
 #endif
@@ -28,6 +28,7 @@
 
 // ResampleScalarVectorDWIVolume includes
 #include "ResampleScalarVectorDWIVolumeCLP.h"
+#include "itkVectorComponentInterpolateImageFunction.h"
 
 // ResampleDTIVolume includes
 #include "dtiprocessFiles/deformationfieldio.h"
@@ -656,91 +657,6 @@ SetAllTransform( parameters & list,
   return transform;
 }
 
-// Write back the vector of images into a image vector
-template <class PixelType>
-int AddImage( typename itk::VectorImage<PixelType, 3>
-              ::Pointer & imagePile,
-              const std::vector<typename itk::Image<PixelType, 3>::Pointer> & vectorImage
-              )
-{
-  typedef itk::Image<PixelType, 3> ImageType;
-  imagePile->SetRegions( vectorImage.at( 0 )->GetLargestPossibleRegion().GetSize() );
-  imagePile->SetOrigin( vectorImage.at( 0 )->GetOrigin() );
-  imagePile->SetDirection( vectorImage.at( 0 )->GetDirection() );
-  imagePile->SetSpacing( vectorImage.at( 0 )->GetSpacing() );
-  imagePile->SetVectorLength( vectorImage.size() );
-  imagePile->Allocate();
-  typename itk::ImageRegionIterator<itk::VectorImage<PixelType, 3> > out( imagePile,
-                                                                          imagePile->GetLargestPossibleRegion()
-                                                                          );
-  typedef typename itk::ImageRegionIterator<ImageType> IteratorImageType;
-  std::vector<IteratorImageType> in;
-  for( unsigned int i = 0; i < imagePile->GetVectorLength(); i++ )
-    {
-    IteratorImageType intemp( vectorImage.at( i ), vectorImage.at( i )->GetLargestPossibleRegion() );
-    intemp.GoToBegin();
-    in.push_back( intemp );
-    }
-  itk::VariableLengthVector<PixelType> value;
-  value.SetSize( vectorImage.size() );
-  for( out.GoToBegin(); !out.IsAtEnd(); ++out )
-    {
-    for( unsigned int i = 0; i < imagePile->GetVectorLength(); i++ )
-      {
-      value.SetElement( i, in.at( i ).Get() );
-      ++in[i];
-      }
-    out.Set( value );
-    }
-  return EXIT_SUCCESS;
-}
-
-// Separate the vector image into a vector of images
-template <class PixelType>
-int SeparateImages( const typename itk::VectorImage<PixelType, 3>
-                    ::Pointer & imagePile,
-                    std::vector<typename itk::Image<PixelType, 3>::Pointer> & vectorImage
-                    )
-{
-  typedef itk::Image<PixelType, 3>       ImageType;
-  typedef itk::VectorImage<PixelType, 3> VectorImageType;
-  typename itk::VectorImage<PixelType, 3>::SizeType size;
-  typename itk::VectorImage<PixelType, 3>::DirectionType direction;
-  typename itk::VectorImage<PixelType, 3>::PointType origin;
-  typename itk::VectorImage<PixelType, 3>::SpacingType spacing;
-  size = imagePile->GetLargestPossibleRegion().GetSize();
-  direction = imagePile->GetDirection();
-  origin = imagePile->GetOrigin();
-  spacing = imagePile->GetSpacing();
-  typename itk::ImageRegionIterator<VectorImageType> in( imagePile,
-                                                         imagePile->GetLargestPossibleRegion() );
-  typedef typename itk::ImageRegionIterator<ImageType> IteratorImageType;
-  std::vector<IteratorImageType> out;
-  for( unsigned int i = 0; i < imagePile->GetVectorLength(); i++ )
-    {
-    typename ImageType::Pointer imageTemp = ImageType::New();
-    imageTemp->SetRegions( size );
-    imageTemp->SetOrigin( origin );
-    imageTemp->SetDirection( direction );
-    imageTemp->SetSpacing( spacing );
-    imageTemp->Allocate();
-    vectorImage.push_back( imageTemp );
-    IteratorImageType outtemp( imageTemp, imageTemp->GetLargestPossibleRegion() );
-    outtemp.GoToBegin();
-    out.push_back( outtemp );
-    }
-  for( in.GoToBegin(); !in.IsAtEnd(); ++in )
-    {
-    itk::VariableLengthVector<PixelType> value = in.Get();
-    for( unsigned int i = 0; i < imagePile->GetVectorLength(); i++ )
-      {
-      out[i].Set( value[i] );
-      ++out[i];
-      }
-    }
-  return EXIT_SUCCESS;
-}
-
 // Verify if some input parameters are null
 bool VectorIsNul( std::vector<double> vec )
 {
@@ -876,7 +792,6 @@ void SetOutputParameters( const parameters & list,
   resampler->SetSize( m_Size );
   resampler->SetOutputOrigin( m_Origin );
   resampler->SetOutputDirection( m_Direction );
-  resampler->SetDefaultPixelValue( static_cast<typename ImageType::PixelType>( list.defaultPixelValue ) );
 }
 
 // typedef to avoid a compilation issue with VS7
@@ -1171,14 +1086,13 @@ SetInterpolator( const parameters & list )
 template <class PixelType>
 int Rotate( parameters & list )
 {
-  typedef itk::Image<PixelType, 3>                         ImageType;
-  typedef itk::InterpolateImageFunction<ImageType, double> InterpolatorType;
-  typedef itk::ResampleImageFilter<ImageType, ImageType>   ResampleType;
-  typedef itk::Transform<double, 3, 3>                     TransformType;
-  typedef itk::VectorImage<PixelType, 3>                   VectorImageType;
-  typename ImageType::Pointer image;
-  std::vector<typename ImageType::Pointer> vectorOfImage;
-  itk::MetaDataDictionary                  dico;
+  typedef itk::VectorImage<PixelType, 3>                                        VectorImageType;
+  typedef itk::VectorComponentInterpolateImageFunction<VectorImageType, double> InterpolatorType;
+  typedef typename InterpolatorType::ComponentImageType                         ComponentImageType;
+  typedef itk::ResampleImageFilter<VectorImageType, VectorImageType>            ResampleType;
+  typedef itk::Transform<double, 3, 3>                                          TransformType;
+  typename VectorImageType::Pointer image;
+  itk::MetaDataDictionary           dico;
   try
     {
     // open image file
@@ -1186,48 +1100,69 @@ int Rotate( parameters & list )
     reader = itk::ImageFileReader<VectorImageType>::New();
     reader->SetFileName( list.inputVolume.c_str() );
     reader->Update();
+    image = reader->GetOutput();
+    image->DisconnectPipeline();
     if( list.space )  // && list.transformationFile.compare( "" ) )
       {
-      RASLPS<VectorImageType>( reader->GetOutput() );
+      RASLPS<VectorImageType>( image );
       }
     // Save metadata dictionary
-    dico = reader->GetOutput()->GetMetaDataDictionary();
-    // Separate the vector image into a vector of images
-    SeparateImages<PixelType>( reader->GetOutput(), vectorOfImage );
+    dico = image->GetMetaDataDictionary();
     }
   catch( itk::ExceptionObject exception )
     {
     std::cerr << exception << std::endl;
     return EXIT_FAILURE;
     }
-  // Set interpolator
-  typename InterpolatorType::Pointer interpol;
-  interpol = SetInterpolator<ImageType>( list );
+  const unsigned int numberOfComponents = image->GetNumberOfComponentsPerPixel();
+  // Set interpolator: one scalar interpolator per component, all evaluated at the
+  // same continuous index so that the transform is only computed once per voxel
+  typename InterpolatorType::Pointer interpol = InterpolatorType::New();
+  for( unsigned int i = 0; i < numberOfComponents; i++ )
+    {
+    typename itk::InterpolateImageFunction<ComponentImageType, double>::Pointer componentInterpolator;
+    componentInterpolator = SetInterpolator<ComponentImageType>( list );
+    if( !componentInterpolator )
+      {
+      std::cerr << "Unknown interpolation type" << std::endl;
+      return EXIT_FAILURE;
+      }
+    interpol->AddComponentInterpolator( componentInterpolator );
+    }
   // Create resampler and initialize its output parameters
   typename ResampleType::Pointer resample = ResampleType::New();
-  SetOutputParameters<ImageType>( list, resample, vectorOfImage[0] );
+  SetOutputParameters<VectorImageType>( list, resample, image );
+  typename VectorImageType::PixelType defaultPixel;
+  defaultPixel.SetSize( numberOfComponents );
+  defaultPixel.Fill( static_cast<PixelType>( list.defaultPixelValue ) );
+  resample->SetDefaultPixelValue( defaultPixel );
   TransformType::Pointer transform;
   // Load transforms and compute a merged transform
-  transform = SetAllTransform<ImageType>( list, resample, vectorOfImage[0] );
+  transform = SetAllTransform<VectorImageType>( list, resample, image );
   if( !transform )
     {
     return EXIT_FAILURE;
     }
+  if( list.numberOfThread )
+    {
+    resample->SetNumberOfThreads( list.numberOfThread );
+    }
   resample->SetTransform( transform );
   resample->SetInterpolator( interpol );
-  std::vector<typename ImageType::Pointer> vectorOutputImage;
-  // Resample all the images separately
-  for( ::size_t idx = 0; idx < vectorOfImage.size(); idx++ )
+  resample->SetInput( image );
+  // Resample all the components in a single pass over the output image
+  typename VectorImageType::Pointer outputImage;
+  try
     {
-    resample->SetInput( vectorOfImage[idx] );
     resample->Update();
-    vectorOutputImage.push_back( resample->GetOutput() );
-    vectorOutputImage[idx]->DisconnectPipeline();
+    outputImage = resample->GetOutput();
+    outputImage->DisconnectPipeline();
+    }
+  catch( itk::ExceptionObject exception )
+    {
+    std::cerr << exception << std::endl;
+    return EXIT_FAILURE;
     }
-  typename itk::VectorImage<PixelType, 3>::Pointer outputImage;
-  outputImage = itk::VectorImage<PixelType, 3>::New();
-  AddImage<PixelType>( outputImage, vectorOutputImage );
-  vectorOutputImage.clear();
   // If necessary, transform gradient vectors with the loaded transformations
   int dwmriProblem = CheckDWMRI( dico, transform );
   if( list.space ) // && list.transformationFile.compare( "" ) )
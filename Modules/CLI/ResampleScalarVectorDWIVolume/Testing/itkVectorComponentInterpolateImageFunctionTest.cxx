@@ -0,0 +1,236 @@
+/*=========================================================================
+
+  Program:   Slicer
+  Language:  C++
+  Module:    $HeadURL$
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See License.txt or http://www.slicer.org/copyright/copyright.txt for details.
+
+==========================================================================*/
+
+// ResampleScalarVectorDWIVolume includes
+#include "itkVectorComponentInterpolateImageFunction.h"
+
+// ITK includes
+#include <itkAffineTransform.h>
+#include <itkBSplineInterpolateImageFunction.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+#include <itkLinearInterpolateImageFunction.h>
+#include <itkNearestNeighborInterpolateImageFunction.h>
+#include <itkResampleImageFilter.h>
+#include <itkWindowedSincInterpolateImageFunction.h>
+
+// STD includes
+#include <iostream>
+
+namespace
+{
+
+typedef short                                   PixelType;
+typedef itk::Image<PixelType, 3>                ImageType;
+typedef itk::VectorImage<PixelType, 3>          VectorImageType;
+typedef itk::AffineTransform<double, 3>         TransformType;
+typedef itk::VectorComponentInterpolateImageFunction<VectorImageType, double>
+                                                VectorInterpolatorType;
+typedef VectorInterpolatorType::ComponentImageType ComponentImageType;
+
+const unsigned int NumberOfComponents = 4;
+
+enum InterpolationType
+{
+  NearestNeighbor = 0,
+  Linear,
+  BSpline,
+  WindowedSinc,
+  NumberOfInterpolationTypes
+};
+
+const char * InterpolationNames[NumberOfInterpolationTypes] =
+{
+  "nn", "linear", "bs", "ws"
+};
+
+// Same interpolators as SetInterpolator() in ResampleScalarVectorDWIVolume
+template <class TImage>
+typename itk::InterpolateImageFunction<TImage, double>::Pointer
+CreateInterpolator( int interpolationType )
+{
+  typename itk::InterpolateImageFunction<TImage, double>::Pointer interpolator;
+  switch( interpolationType )
+    {
+    case NearestNeighbor:
+      interpolator = itk::NearestNeighborInterpolateImageFunction<TImage, double>::New();
+      break;
+    case Linear:
+      interpolator = itk::LinearInterpolateImageFunction<TImage, double>::New();
+      break;
+    case BSpline:
+      {
+      typename itk::BSplineInterpolateImageFunction<TImage, double, double>::Pointer bSpline =
+        itk::BSplineInterpolateImageFunction<TImage, double, double>::New();
+      bSpline->SetSplineOrder( 3 );
+      interpolator = bSpline;
+      }
+      break;
+    case WindowedSinc:
+      interpolator = itk::WindowedSincInterpolateImageFunction<TImage, 3,
+        itk::Function::CosineWindowFunction<3, double, double>,
+        itk::ConstantBoundaryCondition<TImage>, double>::New();
+      break;
+    }
+  return interpolator;
+}
+
+VectorImageType::Pointer CreateInputImage()
+{
+  VectorImageType::SizeType size;
+  size[0] = 17;
+  size[1] = 13;
+  size[2] = 11;
+  VectorImageType::SpacingType spacing;
+  spacing[0] = 1.0;
+  spacing[1] = 1.5;
+  spacing[2] = 2.0;
+  VectorImageType::Pointer image = VectorImageType::New();
+  image->SetRegions( size );
+  image->SetSpacing( spacing );
+  image->SetVectorLength( NumberOfComponents );
+  image->Allocate();
+
+  // Deterministic pseudo-random values, different for each component
+  unsigned long                 seed = 12345;
+  VectorImageType::PixelType    value;
+  value.SetSize( NumberOfComponents );
+  itk::ImageRegionIterator<VectorImageType> it( image, image->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    for( unsigned int c = 0; c < NumberOfComponents; c++ )
+      {
+      seed = seed * 1103515245UL + 12345UL;
+      value[c] = static_cast<PixelType>( ( seed >> 16 ) % 2000 ) - 1000;
+      }
+    it.Set( value );
+    }
+  return image;
+}
+
+template <class TResampler, class TImage>
+void SetOutputParameters( TResampler * resampler, const TImage * input,
+                          TransformType * transform )
+{
+  resampler->SetInput( input );
+  resampler->SetTransform( transform );
+  resampler->SetSize( input->GetLargestPossibleRegion().GetSize() );
+  resampler->SetOutputSpacing( input->GetSpacing() );
+  resampler->SetOutputOrigin( input->GetOrigin() );
+  resampler->SetOutputDirection( input->GetDirection() );
+}
+
+// Previous implementation: separate the components into scalar images and
+// resample each of them
+ImageType::Pointer ResampleComponent( const VectorImageType * input, unsigned int component,
+                                      TransformType * transform, int interpolationType )
+{
+  ImageType::Pointer scalarImage = ImageType::New();
+  scalarImage->SetRegions( input->GetLargestPossibleRegion() );
+  scalarImage->SetSpacing( input->GetSpacing() );
+  scalarImage->SetOrigin( input->GetOrigin() );
+  scalarImage->SetDirection( input->GetDirection() );
+  scalarImage->Allocate();
+  itk::ImageRegionConstIterator<VectorImageType> in( input, input->GetLargestPossibleRegion() );
+  itk::ImageRegionIterator<ImageType>            out( scalarImage, scalarImage->GetLargestPossibleRegion() );
+  for( in.GoToBegin(), out.GoToBegin(); !in.IsAtEnd(); ++in, ++out )
+    {
+    out.Set( in.Get()[component] );
+    }
+
+  typedef itk::ResampleImageFilter<ImageType, ImageType> ResampleType;
+  ResampleType::Pointer resampler = ResampleType::New();
+  SetOutputParameters( resampler.GetPointer(), scalarImage.GetPointer(), transform );
+  resampler->SetInterpolator( CreateInterpolator<ImageType>( interpolationType ) );
+  resampler->SetDefaultPixelValue( 0 );
+  resampler->Update();
+  return resampler->GetOutput();
+}
+
+// Current implementation: resample all the components in a single pass
+VectorImageType::Pointer ResampleVector( const VectorImageType * input,
+                                         TransformType * transform, int interpolationType )
+{
+  VectorInterpolatorType::Pointer interpolator = VectorInterpolatorType::New();
+  for( unsigned int c = 0; c < NumberOfComponents; c++ )
+    {
+    interpolator->AddComponentInterpolator( CreateInterpolator<ComponentImageType>( interpolationType ) );
+    }
+  typedef itk::ResampleImageFilter<VectorImageType, VectorImageType> ResampleType;
+  ResampleType::Pointer resampler = ResampleType::New();
+  SetOutputParameters( resampler.GetPointer(), input, transform );
+  resampler->SetInterpolator( interpolator );
+  VectorImageType::PixelType defaultPixel;
+  defaultPixel.SetSize( NumberOfComponents );
+  defaultPixel.Fill( 0 );
+  resampler->SetDefaultPixelValue( defaultPixel );
+  resampler->Update();
+  return resampler->GetOutput();
+}
+
+} // end of anonymous namespace
+
+int main( int, char * [] )
+{
+  VectorImageType::Pointer input = CreateInputImage();
+
+  // Small rotation, scaling and translation so that every interpolator
+  // evaluates between voxels and some output voxels fall outside the input
+  TransformType::Pointer       transform = TransformType::New();
+  TransformType::OutputVectorType axis;
+  axis[0] = 1.0;
+  axis[1] = 2.0;
+  axis[2] = 3.0;
+  transform->Rotate3D( axis, 0.2 );
+  transform->Scale( 0.9 );
+  TransformType::OutputVectorType translation;
+  translation[0] = 1.3;
+  translation[1] = -0.7;
+  translation[2] = 2.1;
+  transform->Translate( translation );
+
+  try
+    {
+    for( int interpolationType = 0; interpolationType < NumberOfInterpolationTypes; interpolationType++ )
+      {
+      VectorImageType::Pointer vectorOutput = ResampleVector( input, transform, interpolationType );
+      for( unsigned int c = 0; c < NumberOfComponents; c++ )
+        {
+        ImageType::Pointer componentOutput = ResampleComponent( input, c, transform, interpolationType );
+        itk::ImageRegionConstIterator<VectorImageType> vectorIt( vectorOutput,
+                                                                 vectorOutput->GetLargestPossibleRegion() );
+        itk::ImageRegionConstIterator<ImageType> componentIt( componentOutput,
+                                                              componentOutput->GetLargestPossibleRegion() );
+        for( vectorIt.GoToBegin(), componentIt.GoToBegin(); !vectorIt.IsAtEnd(); ++vectorIt, ++componentIt )
+          {
+          // Bit-identical: no tolerance
+          if( vectorIt.Get()[c] != componentIt.Get() )
+            {
+            std::cerr << "Interpolation " << InterpolationNames[interpolationType]
+                      << ", component " << c << " differs at " << vectorIt.GetIndex()
+                      << ": " << vectorIt.Get()[c] << " instead of " << componentIt.Get()
+                      << std::endl;
+            return EXIT_FAILURE;
+            }
+          }
+        }
+      }
+    }
+  catch( itk::ExceptionObject & exception )
+    {
+    std::cerr << exception << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,102 @@
+/*=========================================================================
+
+  Program:   Slicer
+  Language:  C++
+  Module:    $HeadURL$
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See License.txt or http://www.slicer.org/copyright/copyright.txt for details.
+
+==========================================================================*/
+#ifndef __itkVectorComponentInterpolateImageFunction_h
+#define __itkVectorComponentInterpolateImageFunction_h
+
+#include <itkInterpolateImageFunction.h>
+#include <itkVectorImage.h>
+#include <itkVectorImageToImageAdaptor.h>
+
+// STD includes
+#include <vector>
+
+namespace itk
+{
+/**
+ * \class VectorComponentInterpolateImageFunction
+ *
+ * Interpolates all the components of an itk::VectorImage at once.
+ *
+ * Each component is seen through a VectorImageToImageAdaptor (no copy of
+ * the input buffer) and interpolated with its own scalar interpolator,
+ * so the result of each component is identical to the one obtained by
+ * interpolating the separated scalar image with the same interpolator.
+ * Used with itk::ResampleImageFilter, the transform is evaluated only once
+ * per output voxel for all the components.
+ *
+ */
+template <class TInputImage, class TCoordRep = double>
+class VectorComponentInterpolateImageFunction :
+  public InterpolateImageFunction<TInputImage, TCoordRep>
+{
+public:
+  typedef VectorComponentInterpolateImageFunction          Self;
+  typedef InterpolateImageFunction<TInputImage, TCoordRep> Superclass;
+  typedef SmartPointer<Self>                               Pointer;
+  typedef SmartPointer<const Self>                         ConstPointer;
+
+  itkNewMacro( Self );
+  itkTypeMacro( VectorComponentInterpolateImageFunction, InterpolateImageFunction );
+
+  typedef typename Superclass::InputImageType      InputImageType;
+  typedef typename Superclass::OutputType          OutputType;
+  typedef typename Superclass::ContinuousIndexType ContinuousIndexType;
+  typedef typename Superclass::IndexType           IndexType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, Superclass::ImageDimension );
+
+  typedef typename InputImageType::InternalPixelType ComponentType;
+  typedef VectorImageToImageAdaptor<ComponentType,
+                                    itkGetStaticConstMacro( ImageDimension )> ComponentImageType;
+  typedef InterpolateImageFunction<ComponentImageType, TCoordRep> ComponentInterpolatorType;
+  typedef typename ComponentInterpolatorType::Pointer             ComponentInterpolatorPointer;
+
+  /** Add the scalar interpolator used for the next component. One
+   * interpolator has to be added per component of the input image,
+   * before calling SetInputImage() */
+  void AddComponentInterpolator( ComponentInterpolatorType * interpolator );
+
+  unsigned int GetNumberOfComponentInterpolators() const
+  {
+    return static_cast<unsigned int>( m_ComponentInterpolators.size() );
+  }
+
+  /** Set the input image and connect each component interpolator to an
+   * adaptor extracting its component */
+  virtual void SetInputImage( const InputImageType * ptr );
+
+  /** Evaluate all the components at the given continuous index.
+   * No bounds checking is done. */
+  virtual OutputType EvaluateAtContinuousIndex( const ContinuousIndexType & index ) const;
+
+protected:
+  VectorComponentInterpolateImageFunction() {}
+  ~VectorComponentInterpolateImageFunction() {}
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+private:
+  VectorComponentInterpolateImageFunction( const Self & ); // purposely not implemented
+  void operator=( const Self & );                          // purposely not implemented
+
+  std::vector<ComponentInterpolatorPointer>          m_ComponentInterpolators;
+  std::vector<typename ComponentImageType::Pointer> m_ComponentImages;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkVectorComponentInterpolateImageFunction.txx"
+#endif
+
+#endif
@@ -0,0 +1,92 @@
+/*=========================================================================
+
+  Program:   Slicer
+  Language:  C++
+  Module:    $HeadURL$
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See License.txt or http://www.slicer.org/copyright/copyright.txt for details.
+
+==========================================================================*/
+#ifndef __itkVectorComponentInterpolateImageFunction_txx
+#define __itkVectorComponentInterpolateImageFunction_txx
+
+#include "itkVectorComponentInterpolateImageFunction.h"
+
+namespace itk
+{
+
+template <class TInputImage, class TCoordRep>
+void
+VectorComponentInterpolateImageFunction<TInputImage, TCoordRep>
+::AddComponentInterpolator( ComponentInterpolatorType * interpolator )
+{
+  m_ComponentInterpolators.push_back( interpolator );
+  this->Modified();
+}
+
+template <class TInputImage, class TCoordRep>
+void
+VectorComponentInterpolateImageFunction<TInputImage, TCoordRep>
+::SetInputImage( const InputImageType * ptr )
+{
+  this->Superclass::SetInputImage( ptr );
+  m_ComponentImages.clear();
+  if( !ptr )
+    {
+    return;
+    }
+  if( m_ComponentInterpolators.size() != ptr->GetNumberOfComponentsPerPixel() )
+    {
+    itkExceptionMacro( << "Number of component interpolators ("
+                       << m_ComponentInterpolators.size()
+                       << ") does not match the number of components of the input image ("
+                       << ptr->GetNumberOfComponentsPerPixel() << ")" );
+    }
+  for( unsigned int i = 0; i < m_ComponentInterpolators.size(); i++ )
+    {
+    // The adaptor only reads the buffer of the input image
+    typename ComponentImageType::Pointer component = ComponentImageType::New();
+    component->SetImage( const_cast<InputImageType *>( ptr ) );
+    component->SetExtractComponentIndex( i );
+    m_ComponentImages.push_back( component );
+    m_ComponentInterpolators[i]->SetInputImage( component );
+    }
+}
+
+template <class TInputImage, class TCoordRep>
+typename VectorComponentInterpolateImageFunction<TInputImage, TCoordRep>
+::OutputType
+VectorComponentInterpolateImageFunction<TInputImage, TCoordRep>
+::EvaluateAtContinuousIndex( const ContinuousIndexType & index ) const
+{
+  const unsigned int numberOfComponents = static_cast<unsigned int>( m_ComponentInterpolators.size() );
+  OutputType         output;
+
+  output.SetSize( numberOfComponents );
+  for( unsigned int i = 0; i < numberOfComponents; i++ )
+    {
+    output[i] = m_ComponentInterpolators[i]->EvaluateAtContinuousIndex( index );
+    }
+  return output;
+}
+
+template <class TInputImage, class TCoordRep>
+void
+VectorComponentInterpolateImageFunction<TInputImage, TCoordRep>
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  this->Superclass::PrintSelf( os, indent );
+  os << indent << "Number of component interpolators: " << m_ComponentInterpolators.size() << std::endl;
+  if( !m_ComponentInterpolators.empty() )
+    {
+    os << indent << "Component interpolator: " << m_ComponentInterpolators[0]->GetNameOfClass() << std::endl;
+    }
+}
+
+} // end namespace itk
+
+#endif
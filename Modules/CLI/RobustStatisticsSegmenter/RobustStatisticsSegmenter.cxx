@@ -6,12 +6,14 @@
 
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 
 #include "labelMapPreprocessor.h"
 
 template <typename TPixel>
 itk::Image<short, 3>::Pointer
-getFinalMask(typename itk::Image<TPixel, 3>::Pointer img, unsigned char l, TPixel thod = 0);
+getFinalMask(typename itk::Image<TPixel, 3>::Pointer img, const typename itk::Image<TPixel, 3>::RegionType& region,
+             unsigned char l, TPixel thod = 0);
 
 int main(int argc, char* * argv)
 {
@@ -77,6 +79,11 @@ int main(int argc, char* * argv)
   seg.setIntensityHomogeneity(intensityHomogeneity);
   seg.setCurvatureWeight(curvatureWeight / 1.5);
 
+  if( numberOfThreads > 0 )
+    {
+    seg.setNumberOfThreads(numberOfThreads);
+    }
+
   seg.doSegmenation();
 
 //   typedef int PixelType;
@@ -120,7 +127,14 @@ int main(int argc, char* * argv)
 
   typedef itk::Image<short, 3> MaskImageType;
 
-  MaskImageType::Pointer finalMask = getFinalMask<float>(seg.mp_phi, labelValue, 2.0);
+  // The front only reached the working region, unless it is empty (e.g. no
+  // seed): all the level set function is thresholded then.
+  SFLSRobustStatSegmentor3DLabelMap_c::TRegion workingRegion = seg.getWorkingRegion();
+  if( workingRegion.GetNumberOfPixels() == 0 )
+    {
+    workingRegion = seg.mp_phi->GetBufferedRegion();
+    }
+  MaskImageType::Pointer finalMask = getFinalMask<float>(seg.mp_phi, workingRegion, labelValue, 2.0);
   finalMask->CopyInformation(img);
 
   typedef itk::ImageFileWriter<MaskImageType> WriterType;
@@ -145,42 +159,27 @@ int main(int argc, char* * argv)
 
 template <typename TPixel>
 itk::Image<short, 3>::Pointer
-getFinalMask(typename itk::Image<TPixel, 3>::Pointer img, unsigned char l, TPixel thod)
+getFinalMask(typename itk::Image<TPixel, 3>::Pointer img, const typename itk::Image<TPixel, 3>::RegionType& region,
+             unsigned char l, TPixel thod)
 {
   typedef itk::Image<short, 3> MaskType;
 
-  MaskType::SizeType size = img->GetLargestPossibleRegion().GetSize();
+  MaskType::Pointer mask = MaskType::New();
 
-  long nx = size[0];
-  long ny = size[1];
-  long nz = size[2];
-
-  MaskType::Pointer   mask = MaskType::New();
-  MaskType::IndexType start = {{0, 0, 0}};
-
-  MaskType::RegionType region;
-  region.SetSize( size );
-  region.SetIndex( start );
-
-  mask->SetRegions( region );
+  mask->SetRegions( img->GetLargestPossibleRegion() );
 
   mask->SetSpacing(img->GetSpacing() );
   mask->SetOrigin(img->GetOrigin() );
 
   mask->Allocate();
   mask->FillBuffer(0);
-  for( long ix = 0; ix < nx; ++ix )
+
+  // the level set function is far outside (3) everywhere out of the region
+  // visited by the front, only this region has to be thresholded
+  itk::ImageRegionConstIteratorWithIndex<itk::Image<TPixel, 3> > it(img, region);
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
     {
-    for( long iy = 0; iy < ny; ++iy )
-      {
-      for( long iz = 0; iz < nz; ++iz )
-        {
-        MaskType::IndexType idx = {{ix, iy, iz}};
-        TPixel              v = img->GetPixel(idx);
-
-        mask->SetPixel(idx, v <= thod ? l : 0);
-        }
-      }
+    mask->SetPixel(it.GetIndex(), it.Get() <= thod ? l : 0);
     }
 
   return mask;
@@ -86,9 +86,13 @@ protected:
      1: interquartile range (IRQ)
      2. median absolute deviation (MAD)
   */
+  /* Features cached on the region allocated by the superclass, they are
+     computed without caching elsewhere (e.g. at seeds far from the mask) */
   TLabelImagePointer              m_featureComputed; // if feature at this point is computed, then is 1
   std::vector<TFloatImagePointer> m_featureImageList;
 
+  virtual void reallocateWorkingImages(const TRegion& region);
+
   double m_kernelWidthFactor; // kernel_width = empirical_std/m_kernelWidthFactor, Eric has it at 10.0
 
   /* fn */
@@ -128,6 +132,11 @@ protected:
 
   double kernelEvaluationUsingPDF(const std::vector<double>& newFeature);
 
+  // force on the zero level set, computed concurrently
+  std::vector<double> m_kappaOnZeroLS;
+  std::vector<double> m_cvForce;
+  void computeForceOnRange(long begin, long end, int threadId);
+
 };
 
 #include "SFLSRobustStatSegmentor3DLabelMap_single.txx"
@@ -82,45 +82,20 @@ CSFLSRobustStatSegmentor3DLabelMap<TPixel>
   double fmax = std::numeric_limits<double>::min();
   double kappaMax = std::numeric_limits<double>::min();
 
-  long    n = this->m_lz.size();
-  double* kappaOnZeroLS = new double[n];
-  double* cvForce = new double[n];
+  long n = this->m_lz.size();
 
-  std::vector<typename CSFLSLayer::iterator> m_lzIterVct( n );
-    {
-    long iiizzz = 0;
-    for( typename CSFLSLayer::iterator itz = this->m_lz.begin(); itz != this->m_lz.end(); ++itz )
-      {
-      m_lzIterVct[iiizzz++] = itz;
-      }
-    }
+  this->m_layerNodes.assign(this->m_lz.begin(), this->m_lz.end() );
+  m_kappaOnZeroLS.resize(n);
+  m_cvForce.resize(n);
+
+  /* Each node only writes its own voxel of the feature images, so the
+     nodes of the zero level set can be processed concurrently. */
+  this->parallelFor(n, static_cast<typename SuperClassType::RangeMethod>(&Self::computeForceOnRange) );
 
-// #ifndef NDEBUG
-//     std::ofstream ff("/tmp/force.txt");
-// #endif
   for( long i = 0; i < n; ++i )
     {
-    typename CSFLSLayer::iterator itz = m_lzIterVct[i];
-
-    long ix = (*itz)[0];
-    long iy = (*itz)[1];
-    long iz = (*itz)[2];
-
-    TIndex idx = {{ix, iy, iz}};
-
-    kappaOnZeroLS[i] = this->computeKappa(ix, iy, iz);
-
-    std::vector<double> f(m_numberOfFeature);
-
-    computeFeatureAt(idx, f);
-
-    // double a = -kernelEvaluation(f);
-    double a = -kernelEvaluationUsingPDF(f);
-
-    fmax = fmax > fabs(a) ? fmax : fabs(a);
-    kappaMax = kappaMax > fabs(kappaOnZeroLS[i]) ? kappaMax : fabs(kappaOnZeroLS[i]);
-
-    cvForce[i] = a;
+    fmax = fmax > fabs(m_cvForce[i]) ? fmax : fabs(m_cvForce[i]);
+    kappaMax = kappaMax > fabs(m_kappaOnZeroLS[i]) ? kappaMax : fabs(m_kappaOnZeroLS[i]);
     }
 
   // std::cout<<"fmax = "<<fmax<<std::endl;
@@ -129,12 +104,37 @@ CSFLSRobustStatSegmentor3DLabelMap<TPixel>
   for( long i = 0; i < n; ++i )
     {
     // this->m_force.push_back(cvForce[i]/(fmax + 1e-10) +  (this->m_curvatureWeight)*kappaOnZeroLS[i]);
-    this->m_force[i] = (1 - (this->m_curvatureWeight) ) * cvForce[i] / (fmax + 1e-10) \
-      +  (this->m_curvatureWeight) * kappaOnZeroLS[i] / (kappaMax + 1e-10);
+    this->m_force[i] = (1 - (this->m_curvatureWeight) ) * m_cvForce[i] / (fmax + 1e-10) \
+      +  (this->m_curvatureWeight) * m_kappaOnZeroLS[i] / (kappaMax + 1e-10);
     }
+}
 
-  delete[] kappaOnZeroLS;
-  delete[] cvForce;
+/* ============================================================
+   computeForceOnRange    */
+template <typename TPixel>
+void
+CSFLSRobustStatSegmentor3DLabelMap<TPixel>
+::computeForceOnRange(long begin, long end, int itkNotUsed(threadId) )
+{
+  std::vector<double> f(m_numberOfFeature);
+
+  for( long i = begin; i < end; ++i )
+    {
+    const NodeType& node = this->m_layerNodes[i];
+
+    long ix = node[0];
+    long iy = node[1];
+    long iz = node[2];
+
+    TIndex idx = {{ix, iy, iz}};
+
+    m_kappaOnZeroLS[i] = this->computeKappa(ix, iy, iz);
+
+    computeFeatureAt(idx, f);
+
+    // m_cvForce[i] = -kernelEvaluation(f);
+    m_cvForce[i] = -kernelEvaluationUsingPDF(f);
+    }
 }
 
 /* ============================================================  */
@@ -213,17 +213,9 @@ CSFLSRobustStatSegmentor3DLabelMap<TPixel>
     std::cerr << "Error: set input image first.\n";
     raise(SIGABRT);
     }
-  for( long ifeature = 0; ifeature < m_numberOfFeature; ++ifeature )
-    {
-    // TDoubleImagePointer fimg = TDoubleImage::New();
 
-    TFloatImagePointer fimg = TFloatImage::New();
-    fimg->SetRegions(this->mp_img->GetLargestPossibleRegion() );
-    fimg->Allocate();
-    fimg->CopyInformation(this->mp_img);
-
-    m_featureImageList.push_back(fimg);
-    }
+  // allocated with phi, see reallocateWorkingImages()
+  m_featureImageList.assign(m_numberOfFeature, TFloatImagePointer() );
 
   return;
 }
@@ -240,11 +232,25 @@ CSFLSRobustStatSegmentor3DLabelMap<TPixel>
     raise(SIGABRT);
     }
 
-  m_featureComputed = TLabelImage::New();
-  m_featureComputed->SetRegions(this->mp_img->GetLargestPossibleRegion() );
-  m_featureComputed->Allocate();
-  m_featureComputed->CopyInformation(this->mp_img);
-  m_featureComputed->FillBuffer(0);
+  // allocated with phi, see reallocateWorkingImages()
+  m_featureComputed = NULL;
+
+  return;
+}
+
+/* ============================================================ */
+template <typename TPixel>
+void
+CSFLSRobustStatSegmentor3DLabelMap<TPixel>
+::reallocateWorkingImages(const TRegion& region)
+{
+  SuperClassType::reallocateWorkingImages(region);
+
+  for( long ifeature = 0; ifeature < m_numberOfFeature; ++ifeature )
+    {
+    this->template reallocateImage<TFloatImage>(m_featureImageList[ifeature], region, 0);
+    }
+  this->template reallocateImage<TLabelImage>(m_featureComputed, region, 0);
 
   return;
 }
@@ -257,7 +263,8 @@ CSFLSRobustStatSegmentor3DLabelMap<TPixel>
 {
   f.resize(m_numberOfFeature);
 
-  if( m_featureComputed->GetPixel(idx) )
+  const bool cached = m_featureComputed && m_featureComputed->GetBufferedRegion().IsInside(idx);
+  if( cached && m_featureComputed->GetPixel(idx) )
     {
     // the feature at this pixel is computed, just retrive
     for( long i = 0; i < m_numberOfFeature; ++i )
@@ -291,12 +298,15 @@ CSFLSRobustStatSegmentor3DLabelMap<TPixel>
       }
 
     getRobustStatistics(neighborIntensities, f);
-    for( long ifeature = 0; ifeature < m_numberOfFeature; ++ifeature )
+    if( cached )
       {
-      m_featureImageList[ifeature]->SetPixel(idx, f[ifeature]);
-      }
+      for( long ifeature = 0; ifeature < m_numberOfFeature; ++ifeature )
+        {
+        m_featureImageList[ifeature]->SetPixel(idx, f[ifeature]);
+        }
 
-    m_featureComputed->SetPixel(idx, 1);   // mark as computed
+      m_featureComputed->SetPixel(idx, 1);   // mark as computed
+      }
     }
 
   return;
@@ -602,9 +612,9 @@ void
 CSFLSRobustStatSegmentor3DLabelMap<TPixel>
 ::getFeatureAroundSeeds()
 {
-  if( !m_featureImageList[m_numberOfFeature - 1] )
+  if( static_cast<long>(m_featureImageList.size() ) != m_numberOfFeature )
     {
-    // last feature image is not constructed
+    // feature images are not constructed
     std::cerr << "Error: construct feature images first.\n";
     raise(SIGABRT);
     }
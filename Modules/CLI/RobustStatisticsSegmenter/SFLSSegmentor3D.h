@@ -11,6 +11,7 @@
 
 // itk
 #include "itkImage.h"
+#include "itkMultiThreader.h"
 
 template <typename TPixel>
 class CSFLSSegmentor3D : public CSFLS
@@ -102,8 +103,20 @@ public:
 
   void setCurvatureWeight(double a);
 
+  void setNumberOfThreads(int n);
+
   LSImageType::Pointer getLevelSetFunction();
 
+  /* Bounding box of all the voxels visited by the front since the
+     initialization. Outside of it, label and phi are 3 (far outside).
+     phi and label are only allocated around it (their buffered region),
+     the region grows with the front. Empty if the mask has no voxel:
+     phi and label then cover the whole image. */
+  TRegion getWorkingRegion() const
+  {
+    return m_workingRegion;
+  }
+
   /* ============================================================
    * data     */
   // CSFLS::Pointer mp_sfls;
@@ -157,6 +170,60 @@ protected:
   bool                    m_keepZeroLayerHistory;
   std::vector<CSFLSLayer> m_zeroLayerHistory;
 
+  /*----------------------------------------------------------------------
+    Multi-threading
+
+    parallelFor calls (this->*method)(begin, end, threadId) on contiguous
+    chunks of [0, n), one chunk per thread. Methods write their results
+    per index (or per thread for reductions), and the layers are then
+    updated sequentially in the original order, so the evolution does not
+    depend on the number of threads. */
+  typedef void (Self::*RangeMethod)(long begin, long end, int threadId);
+  void parallelFor(long n, RangeMethod method);
+
+  static ITK_THREAD_RETURN_TYPE parallelForCallback(void* arg);
+
+  struct ParallelForArgs
+    {
+    Self* self;
+    RangeMethod method;
+    long n;
+    };
+
+  int                         m_numberOfThreads;
+  itk::MultiThreader::Pointer m_threader;
+
+  /* Nodes of the layer being updated, with the phi of their closest
+     neighbor in the layer closer to the zero level, computed in parallel
+     before the sequential update of the layer */
+  std::vector<NodeType> m_layerNodes;
+  std::vector<double>   m_layerPhi;
+  std::vector<char>     m_layerFound;
+  void computeLayerNeighborPhi(const CSFLSLayer& layer);
+
+  void computeLayerNeighborPhiOnRange(long begin, long end, int threadId);
+
+  void addForceOnRange(long begin, long end, int threadId);
+
+  TRegion m_workingRegion;
+  void growWorkingRegion(const CSFLSLayer& layer);
+
+  /* Buffered region of phi, label (and of the images of the subclasses
+     sampled along the front). It contains the working region and its
+     neighbors within a few voxels, the layers can move for an iteration
+     without leaving it. */
+  TRegion m_allocatedRegion;
+  void allocateWorkingRegion();
+
+  /* Reallocate the images on region, keeping their values on the
+     previous buffered region. Subclasses reallocating other images call
+     the superclass implementation. */
+  virtual void reallocateWorkingImages(const TRegion& region);
+
+  template <typename TImageType>
+  void reallocateImage(typename TImageType::Pointer& image, const TRegion& region,
+                       typename TImageType::PixelType fillValue);
+
 };
 
 #include "SFLSSegmentor3D.txx"
@@ -10,6 +10,9 @@
 
 #include <fstream>
 
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
 #include "itkImageRegionIteratorWithIndex.h"
 
 template <typename TPixel>
@@ -48,6 +51,270 @@ CSFLSSegmentor3D<TPixel>
   m_keepZeroLayerHistory = false;
 
   m_done = false;
+
+  m_threader = itk::MultiThreader::New();
+  m_numberOfThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+}
+
+/* ============================================================
+   setNumberOfThreads    */
+template <typename TPixel>
+void
+CSFLSSegmentor3D<TPixel>
+::setNumberOfThreads(int n)
+{
+  m_numberOfThreads = n > 0 ? n : 1;
+}
+
+/* ============================================================
+   parallelFor    */
+template <typename TPixel>
+void
+CSFLSSegmentor3D<TPixel>
+::parallelFor(long n, RangeMethod method)
+{
+  if( n <= 0 )
+    {
+    return;
+    }
+
+  long numberOfThreads = m_numberOfThreads < n ? m_numberOfThreads : n;
+  if( numberOfThreads <= 1 )
+    {
+    (this->*method)(0, n, 0);
+    return;
+    }
+
+  ParallelForArgs args;
+  args.self = this;
+  args.method = method;
+  args.n = n;
+
+  m_threader->SetNumberOfThreads(numberOfThreads);
+  m_threader->SetSingleMethod(parallelForCallback, &args);
+  m_threader->SingleMethodExecute();
+
+  return;
+}
+
+template <typename TPixel>
+ITK_THREAD_RETURN_TYPE
+CSFLSSegmentor3D<TPixel>
+::parallelForCallback(void* arg)
+{
+  itk::MultiThreader::ThreadInfoStruct* info = static_cast<itk::MultiThreader::ThreadInfoStruct *>(arg);
+  ParallelForArgs*                      args = static_cast<ParallelForArgs *>(info->UserData);
+
+  // the threader may run less threads than requested
+  long threadId = info->ThreadID;
+  long numberOfThreads = info->NumberOfThreads;
+
+  long begin = args->n * threadId / numberOfThreads;
+  long end = args->n * (threadId + 1) / numberOfThreads;
+
+  ( (args->self)->*(args->method) )(begin, end, threadId);
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+/* ============================================================
+   computeLayerNeighborPhi    */
+template <typename TPixel>
+void
+CSFLSSegmentor3D<TPixel>
+::computeLayerNeighborPhi(const CSFLSLayer& layer)
+{
+  m_layerNodes.assign(layer.begin(), layer.end() );
+
+  long n = m_layerNodes.size();
+  m_layerPhi.resize(n);
+  m_layerFound.resize(n);
+
+  parallelFor(n, &Self::computeLayerNeighborPhiOnRange);
+
+  return;
+}
+
+template <typename TPixel>
+void
+CSFLSSegmentor3D<TPixel>
+::computeLayerNeighborPhiOnRange(long begin, long end, int itkNotUsed(threadId) )
+{
+  for( long i = begin; i < end; ++i )
+    {
+    const NodeType& node = m_layerNodes[i];
+
+    double thePhi = 0;
+    m_layerFound[i] = getPhiOfTheNbhdWhoIsClosestToZeroLevelInLayerCloserToZeroLevel(node[0], node[1], node[2], thePhi);
+    m_layerPhi[i] = thePhi;
+    }
+
+  return;
+}
+
+/* ============================================================
+   addForceOnRange
+   Add F to phi on the zero layer, keep the old phi in m_layerPhi */
+template <typename TPixel>
+void
+CSFLSSegmentor3D<TPixel>
+::addForceOnRange(long begin, long end, int itkNotUsed(threadId) )
+{
+  for( long i = begin; i < end; ++i )
+    {
+    const NodeType& node = m_layerNodes[i];
+
+    TIndex idx = {{node[0], node[1], node[2]}};
+
+    double phi_old = mp_phi->GetPixel(idx);
+    m_layerPhi[i] = phi_old;
+
+    mp_phi->SetPixel(idx, phi_old + m_force[i]);
+    }
+
+  return;
+}
+
+/* ============================================================
+   growWorkingRegion    */
+template <typename TPixel>
+void
+CSFLSSegmentor3D<TPixel>
+::growWorkingRegion(const CSFLSLayer& layer)
+{
+  if( layer.empty() )
+    {
+    return;
+    }
+
+  TIndex lower = m_workingRegion.GetIndex();
+  TIndex upper = m_workingRegion.GetUpperIndex();
+
+  bool empty = (m_workingRegion.GetNumberOfPixels() == 0);
+  for( CSFLSLayer::const_iterator it = layer.begin(); it != layer.end(); ++it )
+    {
+    for( int d = 0; d < 3; ++d )
+      {
+      if( empty || (*it)[d] < lower[d] )
+        {
+        lower[d] = (*it)[d];
+        }
+      if( empty || (*it)[d] > upper[d] )
+        {
+        upper[d] = (*it)[d];
+        }
+      }
+    empty = false;
+    }
+
+  m_workingRegion.SetIndex(lower);
+  m_workingRegion.SetUpperIndex(upper);
+
+  return;
+}
+
+/* ============================================================
+   allocateWorkingRegion
+   Make sure the layers and their neighbors stay in the buffered region
+   during the next iteration */
+template <typename TPixel>
+void
+CSFLSSegmentor3D<TPixel>
+::allocateWorkingRegion()
+{
+  if( m_workingRegion.GetNumberOfPixels() == 0 )
+    {
+    return;
+    }
+
+  const TRegion& largestRegion = mp_img->GetLargestPossibleRegion();
+
+  TRegion neededRegion = m_workingRegion;
+  neededRegion.PadByRadius(3);
+  neededRegion.Crop(largestRegion);
+  if( m_allocatedRegion.GetNumberOfPixels() > 0 && m_allocatedRegion.IsInside(neededRegion) )
+    {
+    return;
+    }
+
+  /* the margin grows with the front, so that the images are reallocated
+     a few times only */
+  TRegion region = m_workingRegion;
+  TSize   radius;
+  for( int d = 0; d < 3; ++d )
+    {
+    radius[d] = std::max(static_cast<typename TSize::SizeValueType>(8), m_workingRegion.GetSize(d) / 4);
+    }
+  region.PadByRadius(radius);
+  region.Crop(largestRegion);
+
+  if( m_allocatedRegion.GetNumberOfPixels() > 0 )
+    {
+    TIndex lower = region.GetIndex();
+    TIndex upper = region.GetUpperIndex();
+    for( int d = 0; d < 3; ++d )
+      {
+      lower[d] = std::min(lower[d], m_allocatedRegion.GetIndex(d) );
+      upper[d] = std::max(upper[d], m_allocatedRegion.GetUpperIndex()[d]);
+      }
+    region.SetIndex(lower);
+    region.SetUpperIndex(upper);
+    }
+
+  reallocateWorkingImages(region);
+
+  return;
+}
+
+/* ============================================================
+   reallocateWorkingImages    */
+template <typename TPixel>
+void
+CSFLSSegmentor3D<TPixel>
+::reallocateWorkingImages(const TRegion& region)
+{
+  // far outside
+  reallocateImage<LSImageType>(mp_phi, region, 3);
+  reallocateImage<LabelImageType>(mp_label, region, 3);
+
+  m_allocatedRegion = region;
+
+  return;
+}
+
+/* ============================================================
+   reallocateImage    */
+template <typename TPixel>
+template <typename TImageType>
+void
+CSFLSSegmentor3D<TPixel>
+::reallocateImage(typename TImageType::Pointer& image, const TRegion& region,
+                  typename TImageType::PixelType fillValue)
+{
+  typename TImageType::Pointer newImage = TImageType::New();
+  newImage->CopyInformation(mp_img);
+  newImage->SetBufferedRegion(region);
+  newImage->SetRequestedRegion(region);
+  newImage->Allocate();
+  newImage->FillBuffer(fillValue);
+
+  if( image )
+    {
+    TRegion overlap = image->GetBufferedRegion();
+    if( overlap.Crop(region) )
+      {
+      itk::ImageRegionConstIterator<TImageType> oldIt(image, overlap);
+      itk::ImageRegionIterator<TImageType>      newIt(newImage, overlap);
+      for( ; !oldIt.IsAtEnd(); ++oldIt, ++newIt )
+        {
+        newIt.Set(oldIt.Get() );
+        }
+      }
+    }
+
+  image = newImage;
+
+  return;
 }
 
 /* ============================================================
@@ -421,32 +688,23 @@ CSFLSSegmentor3D<TPixel>
     scan Lz values [-2.5 -1.5)[-1.5 -.5)[-.5 .5](.5 1.5](1.5 2.5]
     ========                */
     {
-    // std::list<double>::const_iterator itf = m_force.begin();
+    /* phi is updated in parallel, the status changes are then recorded
+       sequentially in the order of the zero layer */
+    m_layerNodes.assign(m_lz.begin(), m_lz.end() );
 
-    long                              nz = m_lz.size();
-    std::vector<CSFLSLayer::iterator> m_lzIterVct( nz );
-      {
-      long iiizzz = 0;
-      for( CSFLSLayer::iterator itz = m_lz.begin(); itz != m_lz.end(); ++itz )
-        {
-        m_lzIterVct[iiizzz++] = itz;
-        }
-      }
-    //    for (CSFLSLayer::iterator itz = m_lz.begin(); itz != m_lz.end(); ++itf)
-    // #pragma omp parallel for
-    for( long iiizzz = 0; iiizzz < nz; ++iiizzz )
-      {
-      long itf = iiizzz;
+    long nz = m_layerNodes.size();
+    m_layerPhi.resize(nz);
 
-      CSFLSLayer::iterator itz = m_lzIterVct[iiizzz];
+    parallelFor(nz, &Self::addForceOnRange);
 
+    long itf = 0;
+    for( CSFLSLayer::iterator itz = m_lz.begin(); itz != m_lz.end(); ++itf )
+      {
       long ix = (*itz)[0];
       long iy = (*itz)[1];
       long iz = (*itz)[2];
 
-      TIndex idx = {{ix, iy, iz}};
-
-      double phi_old = mp_phi->GetPixel(idx);
+      double phi_old = m_layerPhi[itf];
       double phi_new = phi_old + m_force[itf];
 
       /*----------------------------------------------------------------------
@@ -462,18 +720,6 @@ CSFLSSegmentor3D<TPixel>
         m_lOut2in.push_back(NodeType(ix, iy, iz) );
         }
 
-      //           // DEBUG
-      //           if (phi_new > 3.1 || phi_new < -3.1)
-      //             {
-      //               std::cout<<"phi_old = "<<phi_old<<std::endl;
-      //               std::cout<<"its lbl = "<<(int)mp_label->get(ix, iy)<<std::endl;
-
-      //               std::cerr<<"phi_new > 3.1 || phi_new < -3.1\n";
-      //               raise(SIGABRT);
-      //             }
-
-      mp_phi->SetPixel(idx, phi_new);
-
       if( phi_new > 0.5 )
         {
         Sp1.push_back(*itz);
@@ -502,7 +748,10 @@ CSFLSSegmentor3D<TPixel>
 
     2.1 scan Ln1 values [-2.5 -1.5)[-1.5 -.5)[-.5 .5](.5 1.5](1.5 2.5]
     ==========                     */
-  for( CSFLSLayer::iterator itn1 = m_ln1.begin(); itn1 != m_ln1.end(); )
+  computeLayerNeighborPhi(m_ln1);
+
+  long iitn1 = 0;
+  for( CSFLSLayer::iterator itn1 = m_ln1.begin(); itn1 != m_ln1.end(); ++iitn1 )
     {
     long ix = (*itn1)[0];
     long iy = (*itn1)[1];
@@ -510,8 +759,8 @@ CSFLSSegmentor3D<TPixel>
 
     TIndex idx = {{ix, iy, iz}};
 
-    double thePhi;
-    bool   found = getPhiOfTheNbhdWhoIsClosestToZeroLevelInLayerCloserToZeroLevel(ix, iy, iz, thePhi);
+    double thePhi = m_layerPhi[iitn1];
+    bool   found = m_layerFound[iitn1];
 
     if( found )
       {
@@ -551,7 +800,10 @@ CSFLSSegmentor3D<TPixel>
   /*--------------------------------------------------
     2.2 scan Lp1 values [-2.5 -1.5)[-1.5 -.5)[-.5 .5](.5 1.5](1.5 2.5]
     ========          */
-  for( CSFLSLayer::iterator itp1 = m_lp1.begin(); itp1 != m_lp1.end(); )
+  computeLayerNeighborPhi(m_lp1);
+
+  long iitp1 = 0;
+  for( CSFLSLayer::iterator itp1 = m_lp1.begin(); itp1 != m_lp1.end(); ++iitp1 )
     {
     long ix = (*itp1)[0];
     long iy = (*itp1)[1];
@@ -559,8 +811,8 @@ CSFLSSegmentor3D<TPixel>
 
     TIndex idx = {{ix, iy, iz}};
 
-    double thePhi;
-    bool   found = getPhiOfTheNbhdWhoIsClosestToZeroLevelInLayerCloserToZeroLevel(ix, iy, iz, thePhi);
+    double thePhi = m_layerPhi[iitp1];
+    bool   found = m_layerFound[iitp1];
 
     if( found )
       {
@@ -601,7 +853,10 @@ CSFLSSegmentor3D<TPixel>
   /*--------------------------------------------------
     2.3 scan Ln2 values [-2.5 -1.5)[-1.5 -.5)[-.5 .5](.5 1.5](1.5 2.5]
     ==========                                      */
-  for( CSFLSLayer::iterator itn2 = m_ln2.begin(); itn2 != m_ln2.end(); )
+  computeLayerNeighborPhi(m_ln2);
+
+  long iitn2 = 0;
+  for( CSFLSLayer::iterator itn2 = m_ln2.begin(); itn2 != m_ln2.end(); ++iitn2 )
     {
     long ix = (*itn2)[0];
     long iy = (*itn2)[1];
@@ -609,8 +864,8 @@ CSFLSSegmentor3D<TPixel>
 
     TIndex idx = {{ix, iy, iz}};
 
-    double thePhi;
-    bool   found = getPhiOfTheNbhdWhoIsClosestToZeroLevelInLayerCloserToZeroLevel(ix, iy, iz, thePhi);
+    double thePhi = m_layerPhi[iitn2];
+    bool   found = m_layerFound[iitn2];
 
     if( found )
       {
@@ -646,15 +901,18 @@ CSFLSSegmentor3D<TPixel>
   /*--------------------------------------------------
     2.4 scan Lp2 values [-2.5 -1.5)[-1.5 -.5)[-.5 .5](.5 1.5](1.5 2.5]
     ========= */
-  for( CSFLSLayer::iterator itp2 = m_lp2.begin(); itp2 != m_lp2.end(); )
+  computeLayerNeighborPhi(m_lp2);
+
+  long iitp2 = 0;
+  for( CSFLSLayer::iterator itp2 = m_lp2.begin(); itp2 != m_lp2.end(); ++iitp2 )
     {
     long   ix = (*itp2)[0];
     long   iy = (*itp2)[1];
     long   iz = (*itp2)[2];
     TIndex idx = {{ix, iy, iz}};
 
-    double thePhi;
-    bool   found = getPhiOfTheNbhdWhoIsClosestToZeroLevelInLayerCloserToZeroLevel(ix, iy, iz, thePhi);
+    double thePhi = m_layerPhi[iitp2];
+    bool   found = m_layerFound[iitp2];
 
     if( found )
       {
@@ -858,6 +1116,14 @@ CSFLSSegmentor3D<TPixel>
     mp_label->SetPixel(idx, 2);
     }
 
+  /* nodes which enter the layers may extend the working region */
+  growWorkingRegion(Sz);
+  growWorkingRegion(Sn1);
+  growWorkingRegion(Sp1);
+  growWorkingRegion(Sn2);
+  growWorkingRegion(Sp2);
+  allocateWorkingRegion();
+
   //     // debug
   //     labelsCoherentCheck1();
 
@@ -935,25 +1201,48 @@ CSFLSSegmentor3D<TPixel>
     raise(SIGABRT);
     }
 
-  initializePhi();
-  initializeLabel();
+  m_workingRegion = TRegion();
 
-//   //debug//
-//   //  std::cout<<"[m_nx, m_ny, m_nz] = "<<"[ "<<m_nx<<", "<<m_ny<<", "<<m_nz<<"]\n";
-//   typedef itk::ImageRegionIteratorWithIndex<MaskImageType> TImageRegionIteratorWithIndex;
-//   TImageRegionIteratorWithIndex it(mp_mask, mp_mask->GetLargestPossibleRegion() );
-//   it.GoToBegin();
-//   std::cout<<it.GetIndex()<<std::endl;
+  TIndex maskLower = {{m_nx, m_ny, m_nz}};
+  TIndex maskUpper = {{-1, -1, -1}};
+    {
+    typedef itk::ImageRegionConstIteratorWithIndex<MaskImageType> MaskIteratorType;
+    MaskIteratorType it(mp_mask, mp_mask->GetLargestPossibleRegion() );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      if( it.Get() != 0 )
+        {
+        const TIndex& idx = it.GetIndex();
+        for( int d = 0; d < 3; ++d )
+          {
+          maskLower[d] = std::min(maskLower[d], idx[d]);
+          maskUpper[d] = std::max(maskUpper[d], idx[d]);
+          }
+        }
+      }
+    }
 
-//   exit(0);
-//   //DEBUG//
+  /* Only the bounding box of the mask has to be scanned, everything
+     outside of it is outside of the object: phi and label are allocated
+     around it. */
+  TRegion region = mp_img->GetLargestPossibleRegion();
+  if( maskUpper[0] >= 0 )
+    {
+    region.SetIndex(maskLower);
+    region.SetUpperIndex(maskUpper);
+    region.PadByRadius(8);
+    region.Crop(mp_img->GetLargestPossibleRegion() );
+    }
+  mp_phi = NULL;
+  mp_label = NULL;
+  m_allocatedRegion = TRegion();
+  reallocateWorkingImages(region);
 
-//   typename MaskImageType::IndexType start = mp_mask->GetLargestPossibleRegion().GetIndex();
-  for( long iz = 0; iz < m_nz; ++iz )
+  for( long iz = maskLower[2]; iz <= maskUpper[2]; ++iz )
     {
-    for( long iy = 0; iy < m_ny; ++iy )
+    for( long iy = maskLower[1]; iy <= maskUpper[1]; ++iy )
       {
-      for( long ix = 0; ix < m_nx; ++ix )
+      for( long ix = maskLower[0]; ix <= maskUpper[0]; ++ix )
         {
         TIndex idx = {{ix, iy, iz}};
         TIndex idx1 = {{ix - 1, iy, iz}};
@@ -964,12 +1253,7 @@ CSFLSSegmentor3D<TPixel>
         TIndex idx6 = {{ix, iy, iz + 1}};
 
         // mark the inside and outside of label and phi
-        if( mp_mask->GetPixel(idx) == 0 )
-          {
-          mp_label->SetPixel(idx, 3);
-          mp_phi->SetPixel(idx, 3);
-          }
-        else
+        if( mp_mask->GetPixel(idx) != 0 )
           {
           mp_label->SetPixel(idx, -3);
           mp_phi->SetPixel(idx, -3);
@@ -1250,6 +1534,13 @@ CSFLSSegmentor3D<TPixel>
       m_lp2.push_back( NodeType(ix, iy, iz - 1) );
       }
     }
+
+  growWorkingRegion(m_lz);
+  growWorkingRegion(m_ln1);
+  growWorkingRegion(m_lp1);
+  growWorkingRegion(m_ln2);
+  growWorkingRegion(m_lp2);
+  allocateWorkingRegion();
 }
 
 // /* ============================================================
@@ -5,6 +5,7 @@
 // ITK includes
 #include <itkImageFileReader.h>
 #include <itkImageFileWriter.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
 
 // ITK includes
 #include <itkConfigure.h>
@@ -131,10 +132,6 @@ getFinalMask(typename itk::Image<TPixel, 3>::Pointer img, unsigned char l, TPixe
 
   MaskType::SizeType size = img->GetLargestPossibleRegion().GetSize();
 
-  long nx = size[0];
-  long ny = size[1];
-  long nz = size[2];
-
   MaskType::Pointer   mask = MaskType::New();
   MaskType::IndexType start = {{0, 0, 0}};
 
@@ -149,18 +146,12 @@ getFinalMask(typename itk::Image<TPixel, 3>::Pointer img, unsigned char l, TPixe
 
   mask->Allocate();
   mask->FillBuffer(0);
-  for( long ix = 0; ix < nx; ++ix )
+
+  // the level set function is only allocated around the front
+  itk::ImageRegionConstIteratorWithIndex<itk::Image<TPixel, 3> > it(img, img->GetBufferedRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
     {
-    for( long iy = 0; iy < ny; ++iy )
-      {
-      for( long iz = 0; iz < nz; ++iz )
-        {
-        MaskType::IndexType idx = {{ix, iy, iz}};
-        TPixel              v = img->GetPixel(idx);
-
-        mask->SetPixel(idx, v <= thod ? l : 0);
-        }
-      }
+    mask->SetPixel(it.GetIndex(), it.Get() <= thod ? l : 0);
     }
 
   return mask;
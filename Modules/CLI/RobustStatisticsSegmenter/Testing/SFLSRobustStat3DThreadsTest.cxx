@@ -0,0 +1,105 @@
+#include "SFLSRobustStatSegmentor3DLabelMap_single.h"
+
+// ITK includes
+#include <itkImageFileReader.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <itkMultiThreader.h>
+
+// ITK includes
+#include <itkConfigure.h>
+#include <itkFactoryRegistration.h>
+
+
+#include "labelMapPreprocessor.h"
+
+typedef short                                         PixelType;
+typedef CSFLSRobustStatSegmentor3DLabelMap<PixelType> SegmentorType;
+
+/* Segment with the given number of threads, keep the level set function
+   and the working region */
+void segment(SegmentorType::TImage::Pointer img, SegmentorType::TLabelImage::Pointer labelMap,
+             double expectedVolume, int numberOfThreads,
+             SegmentorType::LSImageType::Pointer& phi, SegmentorType::TRegion& workingRegion)
+{
+  SegmentorType seg;
+
+  seg.setImage(img);
+  seg.setNumIter(10000);
+  seg.setMaxVolume(expectedVolume);
+  seg.setInputLabelImage(labelMap);
+  seg.setMaxRunningTime(10000);
+  seg.setIntensityHomogeneity(0.1);
+  seg.setCurvatureWeight(0.2 / 1.5);
+  seg.setNumberOfThreads(numberOfThreads);
+
+  seg.doSegmenation();
+
+  phi = seg.mp_phi;
+  workingRegion = seg.getWorkingRegion();
+}
+
+int main(int argc, char* * argv)
+{
+  itk::itkFactoryRegistration();
+
+  if( argc != 4 )
+    {
+    std::cerr << "Parameters: inputImage labelImageName expectedVolume\n";
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::ImageFileReader<SegmentorType::TImage> ImageReaderType;
+  ImageReaderType::Pointer reader = ImageReaderType::New();
+  reader->SetFileName(argv[1]);
+
+  typedef itk::ImageFileReader<SegmentorType::TLabelImage> LabelImageReaderType;
+  LabelImageReaderType::Pointer readerLabel = LabelImageReaderType::New();
+  readerLabel->SetFileName(argv[2]);
+
+  try
+    {
+    reader->Update();
+    readerLabel->Update();
+    }
+  catch( itk::ExceptionObject & err )
+    {
+    std::cerr << "ExceptionObject caught !" << std::endl;
+    std::cerr << err << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  double expectedVolume = atof(argv[3]);
+  int    numberOfThreads = std::max(2, itk::MultiThreader::GetGlobalDefaultNumberOfThreads() );
+
+  SegmentorType::LSImageType::Pointer singleThreadPhi;
+  SegmentorType::TRegion              singleThreadRegion;
+  segment(reader->GetOutput(), preprocessLabelMap<short>(readerLabel->GetOutput(), 1),
+          expectedVolume, 1, singleThreadPhi, singleThreadRegion);
+
+  SegmentorType::LSImageType::Pointer multiThreadPhi;
+  SegmentorType::TRegion              multiThreadRegion;
+  segment(reader->GetOutput(), preprocessLabelMap<short>(readerLabel->GetOutput(), 1),
+          expectedVolume, numberOfThreads, multiThreadPhi, multiThreadRegion);
+
+  if( singleThreadRegion.GetNumberOfPixels() == 0 || singleThreadRegion != multiThreadRegion )
+    {
+    std::cerr << "Different working regions with 1 and " << numberOfThreads << " threads: "
+              << singleThreadRegion << multiThreadRegion << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // the evolution does not depend on the number of threads
+  itk::ImageRegionConstIteratorWithIndex<SegmentorType::LSImageType> it(singleThreadPhi, singleThreadRegion);
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    if( it.Get() != multiThreadPhi->GetPixel(it.GetIndex() ) )
+      {
+      std::cerr << "Different level set functions with 1 and " << numberOfThreads
+                << " threads at " << it.GetIndex() << ": " << it.Get() << " and "
+                << multiThreadPhi->GetPixel(it.GetIndex() ) << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -2,6 +2,7 @@
 #include "TractographyLabelMapSeedingCLP.h"
 #include "vtkDiffusionTensorMathematics.h"
 #include "vtkSeedTracts.h"
+#include "vtkTractographyTensorCache.h"
 
 // ITK includes
 #include <itkConfigure.h>
@@ -277,6 +278,11 @@ int main( int argc, char * argv[] )
     streamer->SetMaximumPropagationDistance(MaximumLength);
     streamer->SetRadiusOfCurvature(StoppingCurvature);
     streamer->SetIntegrationStepLength(IntegrationStepLength);
+    vtkNew<vtkTractographyTensorCache> tensorCache;
+    if( UseTensorCache )
+      {
+      streamer->SetTensorCache(tensorCache.GetPointer());
+      }
 
     // 5. Run the thing
     seed->SeedStreamlinesInROI();
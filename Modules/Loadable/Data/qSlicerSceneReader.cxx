@@ -66,7 +66,7 @@ qSlicerIO::IOFileType qSlicerSceneReader::fileType()const
 //-----------------------------------------------------------------------------
 QStringList qSlicerSceneReader::extensions()const
 {
-  return QStringList() << "*.mrml";
+  return QStringList() << "*.mrml" << "*.mrmlb";
 }
 
 //-----------------------------------------------------------------------------
@@ -83,7 +83,8 @@ QStringList qSlicerSceneWriter::extensions(vtkObject* object)const
   return QStringList()
     << tr("MRML Scene (.mrml)")
     << tr("Medical Reality Bundle (.mrb)")
-    << tr("Slicer Data Bundle (*)");
+    << tr("Slicer Data Bundle (*)")
+    << tr("Binary MRML Scene (.mrmlb)");
 }
 
 //----------------------------------------------------------------------------
@@ -94,8 +95,9 @@ bool qSlicerSceneWriter::write(const qSlicerIO::IOProperties& properties)
   Q_ASSERT(!properties["fileName"].toString().isEmpty());
   QFileInfo fileInfo(properties["fileName"].toString());
   bool res = false;
-  if (fileInfo.suffix() == "mrml")
+  if (fileInfo.suffix() == "mrml" || fileInfo.suffix() == "mrmlb")
     {
+    // vtkMRMLScene::Commit() writes a binary scene for the .mrmlb extension
     res = this->writeToMRML(properties);
     }
   else if (fileInfo.suffix() == "mrb")
@@ -230,6 +232,14 @@ bool qSlicerSceneWriter::writeToMRB(const qSlicerIO::IOProperties& properties)
     qMRMLUtils::qImageToVtkImageData(screenShot.toImage(), imageData);
     }
 
+  // by default the files are moved into the mrb file as soon as they are
+  // written instead of zipping the bundle directory at the end
+  bool streaming = true;
+  if (properties.contains("streaming"))
+    {
+    streaming = properties["streaming"].toBool();
+    }
+
   //
   // Now save the scene into the bundle directory and then make a zip (mrb) file
   // in the user's selected file location
@@ -237,21 +247,35 @@ bool qSlicerSceneWriter::writeToMRB(const qSlicerIO::IOProperties& properties)
   vtkSlicerApplicationLogic* applicationLogic =
     qSlicerCoreApplication::application()->applicationLogic();
   Q_ASSERT(this->mrmlScene() == applicationLogic->GetMRMLScene());
-  bool retval =
-    applicationLogic->SaveSceneToSlicerDataBundleDirectory(bundlePath.toLatin1(),
-                                                           imageData);
-  if (!retval)
+  if (streaming)
     {
-    QMessageBox::critical(0, tr("Save scene as MRB"), tr("Failed to create bundle"));
-    return false;
+    qDebug() << "zipping to " << fileInfo.absoluteFilePath();
+    if (!applicationLogic->SaveSceneToSlicerDataBundle(fileInfo.absoluteFilePath().toLatin1(),
+                                                       bundlePath.toLatin1(),
+                                                       imageData))
+      {
+      QMessageBox::critical(0, tr("Save scene as MRB"), tr("Failed to create bundle"));
+      return false;
+      }
     }
-
-  qDebug() << "zipping to " << fileInfo.absoluteFilePath();
-  if ( !applicationLogic->Zip(fileInfo.absoluteFilePath().toLatin1(),
-                              bundlePath.toLatin1()) )
+  else
     {
-    QMessageBox::critical(0, tr("Save scene as MRB"), tr("Could not compress bundle"));
-    return false;
+    bool retval =
+      applicationLogic->SaveSceneToSlicerDataBundleDirectory(bundlePath.toLatin1(),
+                                                             imageData);
+    if (!retval)
+      {
+      QMessageBox::critical(0, tr("Save scene as MRB"), tr("Failed to create bundle"));
+      return false;
+      }
+
+    qDebug() << "zipping to " << fileInfo.absoluteFilePath();
+    if ( !applicationLogic->Zip(fileInfo.absoluteFilePath().toLatin1(),
+                                bundlePath.toLatin1()) )
+      {
+      QMessageBox::critical(0, tr("Save scene as MRB"), tr("Could not compress bundle"));
+      return false;
+      }
     }
 
   //
@@ -28,10 +28,15 @@
 #include "vtkSlicerModelsLogic.h"
 
 // MRML includes
+#include <vtkCacheManager.h>
+#include "vtkMRMLModelDisplayNode.h"
 #include "vtkMRMLModelNode.h"
+#include "vtkMRMLModelStorageNode.h"
 #include <vtkMRMLScene.h>
 
 // VTK includes
+#include <vtkNew.h>
+#include <vtkPolyData.h>
 #include <vtkSmartPointer.h>
 
 //-----------------------------------------------------------------------------
@@ -116,3 +121,56 @@ bool qSlicerModelsReader::load(const IOProperties& properties)
     }
   return true;
 }
+
+//-----------------------------------------------------------------------------
+bool qSlicerModelsReader::prepareLoad(const IOProperties& properties,
+                                      vtkMRMLStorableNode*& node,
+                                      vtkMRMLStorageNode*& storageNode)
+{
+  Q_ASSERT(properties.contains("fileName"));
+  QString fileName = properties["fileName"].toString();
+
+  node = 0;
+  storageNode = 0;
+  vtkMRMLScene* scene = this->mrmlScene();
+  if (!scene ||
+      (scene->GetCacheManager() &&
+       scene->GetCacheManager()->IsRemoteReference(fileName.toLatin1())))
+    {
+    return false;
+    }
+  vtkMRMLModelStorageNode* modelStorageNode = vtkMRMLModelStorageNode::New();
+  // FreeSurfer surfaces are read by load()
+  if (!modelStorageNode->SupportedFileType(fileName.toLatin1()))
+    {
+    modelStorageNode->Delete();
+    return false;
+    }
+  modelStorageNode->SetFileName(fileName.toLatin1());
+  storageNode = modelStorageNode;
+  node = vtkMRMLModelNode::New();
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerModelsReader::finishLoad(const IOProperties& properties,
+                                     vtkMRMLStorableNode* node,
+                                     vtkMRMLStorageNode* storageNode)
+{
+  vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(node);
+  if (!modelNode || !this->mrmlScene())
+    {
+    this->setLoadedNodes(QStringList());
+    return false;
+    }
+  vtkNew<vtkMRMLModelDisplayNode> displayNode;
+  // The model had no display node when its data was read, set the scalar
+  // range as vtkMRMLModelStorageNode::ReadData() does.
+  if (modelNode->GetPolyData())
+    {
+    displayNode->SetScalarRange(modelNode->GetPolyData()->GetScalarRange());
+    }
+  this->mrmlScene()->AddNode(displayNode.GetPointer());
+  modelNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+  return this->Superclass::finishLoad(properties, node, storageNode);
+}
@@ -48,6 +48,15 @@ public:
 
   virtual bool load(const IOProperties& properties);
 
+  /// Models supported by vtkMRMLModelStorageNode can be read concurrently.
+  /// \sa qSlicerFileReader::prepareLoad()
+  virtual bool prepareLoad(const IOProperties& properties,
+                           vtkMRMLStorableNode*& node,
+                           vtkMRMLStorageNode*& storageNode);
+  virtual bool finishLoad(const IOProperties& properties,
+                          vtkMRMLStorableNode* node,
+                          vtkMRMLStorageNode* storageNode);
+
 protected:
   QScopedPointer<qSlicerModelsReaderPrivate> d_ptr;
 
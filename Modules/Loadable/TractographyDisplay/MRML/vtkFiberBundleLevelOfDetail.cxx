@@ -0,0 +1,90 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+// TractographyMRML includes
+#include "vtkFiberBundleLevelOfDetail.h"
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPolyData.h>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkFiberBundleLevelOfDetail);
+
+//----------------------------------------------------------------------------
+vtkFiberBundleLevelOfDetail::vtkFiberBundleLevelOfDetail()
+{
+  this->PointStride = 1;
+}
+
+//----------------------------------------------------------------------------
+vtkFiberBundleLevelOfDetail::~vtkFiberBundleLevelOfDetail()
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkFiberBundleLevelOfDetail::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "PointStride: " << this->PointStride << "\n";
+}
+
+//----------------------------------------------------------------------------
+int vtkFiberBundleLevelOfDetail::RequestData(
+  vtkInformation *vtkNotUsed(request),
+  vtkInformationVector **inputVector,
+  vtkInformationVector *outputVector)
+{
+  // get the info objects
+  vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+
+  // get the input and output
+  vtkPolyData *input = vtkPolyData::SafeDownCast(
+    inInfo->Get(vtkDataObject::DATA_OBJECT()));
+  vtkPolyData *output = vtkPolyData::SafeDownCast(
+    outInfo->Get(vtkDataObject::DATA_OBJECT()));
+
+  output->ShallowCopy(input);
+  vtkCellArray* inputLines = input->GetLines();
+  if (this->PointStride <= 1 || !inputLines || input->GetNumberOfLines() == 0)
+    {
+    return 1;
+    }
+
+  vtkDebugMacro(<< "Keeping 1 fiber point out of " << this->PointStride);
+
+  // Same lines in the same order: the cell data is still valid.
+  vtkNew<vtkCellArray> outputLines;
+  outputLines->Allocate(inputLines->GetNumberOfConnectivityEntries() / this->PointStride
+                        + 2 * input->GetNumberOfLines());
+  vtkIdType npts = 0;
+  vtkIdType* pts = 0;
+  for (inputLines->InitTraversal(); inputLines->GetNextCell(npts, pts);)
+    {
+    const vtkIdType numberOfKeptPoints = npts > 0 ? (npts - 1) / this->PointStride + 1 +
+      ((npts - 1) % this->PointStride ? 1 : 0) : 0;
+    outputLines->InsertNextCell(numberOfKeptPoints);
+    for (vtkIdType i = 0; i < npts; i += this->PointStride)
+      {
+      outputLines->InsertCellPoint(pts[i]);
+      }
+    if (npts > 0 && (npts - 1) % this->PointStride)
+      {
+      outputLines->InsertCellPoint(pts[npts - 1]);
+      }
+    }
+  output->SetLines(outputLines.GetPointer());
+
+  return 1;
+}
@@ -0,0 +1,52 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+///  vtkFiberBundleLevelOfDetail - Display fibers with fewer points
+///
+/// Keeps 1 point out of PointStride along each line (fiber) of the input,
+/// plus the last point of the line. The output shares the points, the
+/// point data and the cell data of the input: only the line connectivity
+/// is rebuilt. With a stride of 1 the input is passed through.
+//
+
+#ifndef __vtkFiberBundleLevelOfDetail_h
+#define __vtkFiberBundleLevelOfDetail_h
+
+// Tractography includes
+#include "vtkSlicerTractographyDisplayModuleMRMLExport.h"
+
+// VTK includes
+#include <vtkPolyDataAlgorithm.h>
+
+class VTK_SLICER_TRACTOGRAPHYDISPLAY_MODULE_MRML_EXPORT vtkFiberBundleLevelOfDetail
+  : public vtkPolyDataAlgorithm
+{
+public:
+  static vtkFiberBundleLevelOfDetail *New();
+  vtkTypeMacro(vtkFiberBundleLevelOfDetail, vtkPolyDataAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  ///
+  /// Stride between the points kept along the lines. 1 by default.
+  vtkSetClampMacro(PointStride, int, 1, VTK_INT_MAX);
+  vtkGetMacro(PointStride, int);
+
+protected:
+  vtkFiberBundleLevelOfDetail();
+  ~vtkFiberBundleLevelOfDetail();
+
+  virtual int RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *);
+
+  int PointStride;
+
+private:
+  vtkFiberBundleLevelOfDetail(const vtkFiberBundleLevelOfDetail&); /// Not implemented.
+  void operator=(const vtkFiberBundleLevelOfDetail&); /// Not implemented.
+};
+
+#endif
@@ -0,0 +1,169 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+// TractographyMRML includes
+#include "vtkFiberBundleROISelection.h"
+#include "vtkFiberBundleSpatialIndex.h"
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkIdTypeArray.h>
+#include <vtkImplicitFunction.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkUnsignedCharArray.h>
+
+// STD includes
+#include <algorithm>
+#include <vector>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkFiberBundleROISelection);
+vtkCxxSetObjectMacro(vtkFiberBundleROISelection, ImplicitFunction, vtkImplicitFunction);
+vtkCxxSetObjectMacro(vtkFiberBundleROISelection, LineIds, vtkIdTypeArray);
+
+//----------------------------------------------------------------------------
+vtkFiberBundleROISelection::vtkFiberBundleROISelection()
+{
+  this->ImplicitFunction = 0;
+  for (int i = 0; i < 3; ++i)
+    {
+    this->Bounds[2*i] = VTK_DOUBLE_MIN;
+    this->Bounds[2*i+1] = VTK_DOUBLE_MAX;
+    }
+  this->ExtractInside = 1;
+  this->LineIds = 0;
+  this->SpatialIndex = vtkFiberBundleSpatialIndex::New();
+}
+
+//----------------------------------------------------------------------------
+vtkFiberBundleROISelection::~vtkFiberBundleROISelection()
+{
+  this->SetImplicitFunction(0);
+  this->SetLineIds(0);
+  this->SpatialIndex->Delete();
+}
+
+//----------------------------------------------------------------------------
+void vtkFiberBundleROISelection::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "ImplicitFunction: " << this->ImplicitFunction << "\n";
+  os << indent << "Bounds: " << this->Bounds[0] << " " << this->Bounds[1] << " "
+     << this->Bounds[2] << " " << this->Bounds[3] << " "
+     << this->Bounds[4] << " " << this->Bounds[5] << "\n";
+  os << indent << "ExtractInside: " << this->ExtractInside << "\n";
+  os << indent << "LineIds: " << this->LineIds << "\n";
+  os << indent << "SpatialIndex:\n";
+  this->SpatialIndex->PrintSelf(os, indent.GetNextIndent());
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkFiberBundleROISelection::GetMTime()
+{
+  unsigned long mTime = this->Superclass::GetMTime();
+  if (this->ImplicitFunction)
+    {
+    mTime = std::max(mTime, this->ImplicitFunction->GetMTime());
+    }
+  if (this->LineIds)
+    {
+    mTime = std::max(mTime, this->LineIds->GetMTime());
+    }
+  return mTime;
+}
+
+//----------------------------------------------------------------------------
+int vtkFiberBundleROISelection::RequestData(
+  vtkInformation *vtkNotUsed(request),
+  vtkInformationVector **inputVector,
+  vtkInformationVector *outputVector)
+{
+  // get the info objects
+  vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+
+  // get the input and output
+  vtkPolyData *input = vtkPolyData::SafeDownCast(
+    inInfo->Get(vtkDataObject::DATA_OBJECT()));
+  vtkPolyData *output = vtkPolyData::SafeDownCast(
+    outInfo->Get(vtkDataObject::DATA_OBJECT()));
+
+  vtkDebugMacro(<< "Selecting fibers with ROI");
+
+  // The points are shared: unused points are simply not referenced by the
+  // output lines.
+  output->SetPoints(input->GetPoints());
+  output->GetPointData()->PassData(input->GetPointData());
+
+  vtkCellArray* inputLines = input->GetLines();
+  const vtkIdType numberOfLines = input->GetNumberOfLines();
+  if (!input->GetPoints() || numberOfLines == 0)
+    {
+    return 1;
+    }
+
+  vtkNew<vtkUnsignedCharArray> lineFlags;
+  const unsigned char* flags = 0;
+  if (this->ImplicitFunction)
+    {
+    this->SpatialIndex->SetPolyData(input);
+    this->SpatialIndex->EvaluateLines(this->ImplicitFunction, this->Bounds,
+                                      lineFlags.GetPointer());
+    flags = lineFlags->GetPointer(0);
+    }
+
+  // Location of each line in the connectivity array
+  vtkIdType* connectivity = inputLines->GetPointer();
+  std::vector<vtkIdType> lineLocations(numberOfLines);
+  vtkIdType location = 0;
+  for (vtkIdType line = 0; line < numberOfLines; ++line)
+    {
+    lineLocations[line] = location;
+    location += connectivity[location] + 1;
+    }
+
+  const vtkIdType numberOfLineIds =
+    this->LineIds ? this->LineIds->GetNumberOfTuples() : numberOfLines;
+  vtkNew<vtkCellArray> outputLines;
+  outputLines->Allocate(inputLines->GetNumberOfConnectivityEntries());
+  vtkCellData* inputCellData = input->GetCellData();
+  vtkCellData* outputCellData = output->GetCellData();
+  outputCellData->CopyAllocate(inputCellData, numberOfLineIds);
+  const vtkIdType firstLineCellId = input->GetNumberOfVerts();
+
+  for (vtkIdType i = 0; i < numberOfLineIds; ++i)
+    {
+    const vtkIdType line = this->LineIds ? this->LineIds->GetValue(i) : i;
+    if (line < 0 || line >= numberOfLines)
+      {
+      continue;
+      }
+    const bool keep = !flags || (this->ExtractInside ?
+      (flags[line] & vtkFiberBundleSpatialIndex::PointInsideOrOnBoundary) != 0 :
+      (flags[line] & vtkFiberBundleSpatialIndex::PointInside) == 0);
+    if (!keep)
+      {
+      continue;
+      }
+    vtkIdType* lineConnectivity = connectivity + lineLocations[line];
+    const vtkIdType newCellId =
+      outputLines->InsertNextCell(lineConnectivity[0], lineConnectivity + 1);
+    outputCellData->CopyData(inputCellData, firstLineCellId + line, newCellId);
+    }
+  outputLines->Squeeze();
+  output->SetLines(outputLines.GetPointer());
+
+  return 1;
+}
@@ -0,0 +1,94 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+///  vtkFiberBundleROISelection - Select the fibers of a bundle with an ROI
+///
+/// Keeps the lines (fibers) of the input that have at least one point
+/// inside or on the boundary of the implicit function (ExtractInside on),
+/// or the lines that have no point inside (ExtractInside off), like
+/// vtkExtractPolyDataGeometry with ExtractBoundaryCells respectively on
+/// and off.
+/// Without implicit function, all the lines are kept: the filter then only
+/// extracts the lines listed in LineIds (e.g. subsampling).
+/// The fibers are found with a vtkFiberBundleSpatialIndex built once per
+/// input, and the output shares the points and point data of the input:
+/// only the line connectivity is copied.
+//
+
+#ifndef __vtkFiberBundleROISelection_h
+#define __vtkFiberBundleROISelection_h
+
+// Tractography includes
+#include "vtkSlicerTractographyDisplayModuleMRMLExport.h"
+
+// VTK includes
+#include <vtkPolyDataAlgorithm.h>
+
+class vtkFiberBundleSpatialIndex;
+class vtkIdTypeArray;
+class vtkImplicitFunction;
+
+class VTK_SLICER_TRACTOGRAPHYDISPLAY_MODULE_MRML_EXPORT vtkFiberBundleROISelection
+  : public vtkPolyDataAlgorithm
+{
+public:
+  static vtkFiberBundleROISelection *New();
+  vtkTypeMacro(vtkFiberBundleROISelection, vtkPolyDataAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  ///
+  /// Function defining the ROI, a point is inside when the function is < 0.
+  /// NULL by default: all the lines are kept.
+  virtual void SetImplicitFunction(vtkImplicitFunction* function);
+  vtkGetObjectMacro(ImplicitFunction, vtkImplicitFunction);
+
+  ///
+  /// Bounds containing the region where the implicit function is <= 0.
+  /// Infinite by default.
+  vtkSetVector6Macro(Bounds, double);
+  vtkGetVector6Macro(Bounds, double);
+
+  ///
+  /// Keep the fibers touching the ROI (on, default) or the fibers
+  /// outside of the ROI (off).
+  vtkSetMacro(ExtractInside, int);
+  vtkGetMacro(ExtractInside, int);
+  vtkBooleanMacro(ExtractInside, int);
+
+  ///
+  /// Indices of the lines to consider, in the order of the output.
+  /// All the lines of the input if NULL (default).
+  virtual void SetLineIds(vtkIdTypeArray* lineIds);
+  vtkGetObjectMacro(LineIds, vtkIdTypeArray);
+
+  ///
+  /// Spatial index of the input fibers.
+  vtkGetObjectMacro(SpatialIndex, vtkFiberBundleSpatialIndex);
+
+  ///
+  /// Take the implicit function and the line ids into account
+  unsigned long GetMTime();
+
+protected:
+  vtkFiberBundleROISelection();
+  ~vtkFiberBundleROISelection();
+
+  virtual int RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *);
+
+  vtkImplicitFunction* ImplicitFunction;
+  double Bounds[6];
+  int ExtractInside;
+  vtkIdTypeArray* LineIds;
+  vtkFiberBundleSpatialIndex* SpatialIndex;
+
+private:
+  vtkFiberBundleROISelection(const vtkFiberBundleROISelection&); /// Not implemented.
+  void operator=(const vtkFiberBundleROISelection&); /// Not implemented.
+};
+
+#endif
@@ -0,0 +1,263 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+// TractographyMRML includes
+#include "vtkFiberBundleSpatialIndex.h"
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkImplicitFunction.h>
+#include <vtkObjectFactory.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkUnsignedCharArray.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkFiberBundleSpatialIndex);
+vtkCxxSetObjectMacro(vtkFiberBundleSpatialIndex, PolyData, vtkPolyData);
+
+//----------------------------------------------------------------------------
+vtkFiberBundleSpatialIndex::vtkFiberBundleSpatialIndex()
+{
+  this->PolyData = 0;
+  this->NumberOfPointsPerBin = 32;
+  for (int i = 0; i < 3; ++i)
+    {
+    this->Origin[i] = 0.;
+    this->BinSize[i] = 1.;
+    this->Dimensions[i] = 0;
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkFiberBundleSpatialIndex::~vtkFiberBundleSpatialIndex()
+{
+  this->SetPolyData(0);
+}
+
+//----------------------------------------------------------------------------
+void vtkFiberBundleSpatialIndex::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "PolyData: " << this->PolyData << "\n";
+  os << indent << "NumberOfPointsPerBin: " << this->NumberOfPointsPerBin << "\n";
+  os << indent << "Dimensions: " << this->Dimensions[0] << " "
+     << this->Dimensions[1] << " " << this->Dimensions[2] << "\n";
+  os << indent << "NumberOfRuns: " << this->Runs.size() << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkFiberBundleSpatialIndex::ComputeBin(const double x[3], int bin[3])const
+{
+  for (int i = 0; i < 3; ++i)
+    {
+    double index = (x[i] - this->Origin[i]) / this->BinSize[i];
+    bin[i] = index <= 0. ? 0 : (index >= this->Dimensions[i] - 1 ?
+      this->Dimensions[i] - 1 : static_cast<int>(index));
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkFiberBundleSpatialIndex::BuildIndex()
+{
+  if (this->PolyData &&
+      this->BuildTime > this->PolyData->GetMTime() &&
+      this->BuildTime > this->GetMTime())
+    {
+    return;
+    }
+
+  this->BinOffsets.clear();
+  this->Runs.clear();
+  this->Dimensions[0] = this->Dimensions[1] = this->Dimensions[2] = 0;
+  this->BuildTime.Modified();
+
+  vtkPoints* points = this->PolyData ? this->PolyData->GetPoints() : 0;
+  vtkCellArray* lines = this->PolyData ? this->PolyData->GetLines() : 0;
+  if (!points || !lines || points->GetNumberOfPoints() == 0 ||
+      lines->GetNumberOfCells() == 0)
+    {
+    return;
+    }
+
+  // Grid resolution: about NumberOfPointsPerBin points per bin, with cubic
+  // bins as much as possible.
+  const vtkIdType* connectivity = lines->GetPointer();
+  const vtkIdType connectivitySize = lines->GetNumberOfConnectivityEntries();
+  const vtkIdType numberOfPoints = connectivitySize - lines->GetNumberOfCells();
+  double bounds[6];
+  points->GetBounds(bounds);
+  double length[3];
+  double maxLength = 0.;
+  for (int i = 0; i < 3; ++i)
+    {
+    length[i] = bounds[2*i+1] - bounds[2*i];
+    maxLength = std::max(maxLength, length[i]);
+    }
+  for (int i = 0; i < 3; ++i)
+    {
+    // flat bundles
+    length[i] = std::max(length[i], maxLength > 0. ? maxLength * 1e-3 : 1.);
+    }
+  const double numberOfBins = std::max(
+    1., static_cast<double>(numberOfPoints) / this->NumberOfPointsPerBin);
+  const double binEdge =
+    pow(length[0] * length[1] * length[2] / numberOfBins, 1. / 3.);
+  for (int i = 0; i < 3; ++i)
+    {
+    this->Dimensions[i] = std::min(
+      1024, std::max(1, static_cast<int>(ceil(length[i] / binEdge))));
+    this->Origin[i] = bounds[2*i];
+    this->BinSize[i] = length[i] / this->Dimensions[i];
+    }
+  const vtkIdType dimX = this->Dimensions[0];
+  const vtkIdType dimXY = dimX * this->Dimensions[1];
+  const vtkIdType totalNumberOfBins = dimXY * this->Dimensions[2];
+
+  // First pass: count the runs of each bin
+  this->BinOffsets.assign(totalNumberOfBins + 1, 0);
+  double x[3];
+  int bin[3];
+  for (vtkIdType location = 0; location < connectivitySize;
+       location += connectivity[location] + 1)
+    {
+    const vtkIdType npts = connectivity[location];
+    vtkIdType previousBin = -1;
+    for (vtkIdType j = 0; j < npts; ++j)
+      {
+      points->GetPoint(connectivity[location + 1 + j], x);
+      this->ComputeBin(x, bin);
+      const vtkIdType binIndex = bin[0] + bin[1] * dimX + bin[2] * dimXY;
+      if (binIndex != previousBin)
+        {
+        ++this->BinOffsets[binIndex + 1];
+        previousBin = binIndex;
+        }
+      }
+    }
+  for (vtkIdType b = 0; b < totalNumberOfBins; ++b)
+    {
+    this->BinOffsets[b + 1] += this->BinOffsets[b];
+    }
+
+  // Second pass: fill the runs
+  this->Runs.resize(this->BinOffsets[totalNumberOfBins]);
+  std::vector<vtkIdType> nextRun(this->BinOffsets.begin(),
+                                 this->BinOffsets.end() - 1);
+  vtkIdType line = 0;
+  for (vtkIdType location = 0; location < connectivitySize;
+       location += connectivity[location] + 1, ++line)
+    {
+    const vtkIdType npts = connectivity[location];
+    vtkIdType previousBin = -1;
+    Run* run = 0;
+    for (vtkIdType j = 0; j < npts; ++j)
+      {
+      points->GetPoint(connectivity[location + 1 + j], x);
+      this->ComputeBin(x, bin);
+      const vtkIdType binIndex = bin[0] + bin[1] * dimX + bin[2] * dimXY;
+      if (binIndex != previousBin)
+        {
+        run = &this->Runs[nextRun[binIndex]++];
+        run->Line = line;
+        run->Location = location + 1 + j;
+        run->NumberOfPoints = 0;
+        previousBin = binIndex;
+        }
+      ++run->NumberOfPoints;
+      }
+    }
+  vtkDebugMacro(<< "Indexed " << line << " lines in "
+                << this->Dimensions[0] << "x" << this->Dimensions[1] << "x"
+                << this->Dimensions[2] << " bins, " << this->Runs.size()
+                << " runs");
+}
+
+//----------------------------------------------------------------------------
+void vtkFiberBundleSpatialIndex::EvaluateLines(vtkImplicitFunction* function,
+                                               const double bounds[6],
+                                               vtkUnsignedCharArray* lineFlags)
+{
+  if (!lineFlags)
+    {
+    return;
+    }
+  this->BuildIndex();
+
+  const vtkIdType numberOfLines =
+    this->PolyData ? this->PolyData->GetNumberOfLines() : 0;
+  lineFlags->SetNumberOfComponents(1);
+  lineFlags->SetNumberOfTuples(numberOfLines);
+  if (numberOfLines == 0)
+    {
+    return;
+    }
+  unsigned char* flags = lineFlags->GetPointer(0);
+  memset(flags, 0, numberOfLines * sizeof(unsigned char));
+  if (!function || this->Runs.empty())
+    {
+    return;
+    }
+
+  // Range of bins overlapping the bounds
+  int minBin[3], maxBin[3];
+  for (int i = 0; i < 3; ++i)
+    {
+    if (bounds[2*i+1] < this->Origin[i] ||
+        bounds[2*i] > this->Origin[i] + this->Dimensions[i] * this->BinSize[i])
+      {
+      return;
+      }
+    }
+  const double minPoint[3] = {bounds[0], bounds[2], bounds[4]};
+  const double maxPoint[3] = {bounds[1], bounds[3], bounds[5]};
+  this->ComputeBin(minPoint, minBin);
+  this->ComputeBin(maxPoint, maxBin);
+
+  const unsigned char allFlags = PointInsideOrOnBoundary | PointInside;
+  const vtkIdType* connectivity = this->PolyData->GetLines()->GetPointer();
+  vtkPoints* points = this->PolyData->GetPoints();
+  const vtkIdType dimX = this->Dimensions[0];
+  const vtkIdType dimXY = dimX * this->Dimensions[1];
+  double x[3];
+  for (int k = minBin[2]; k <= maxBin[2]; ++k)
+    {
+    for (int j = minBin[1]; j <= maxBin[1]; ++j)
+      {
+      for (int i = minBin[0]; i <= maxBin[0]; ++i)
+        {
+        const vtkIdType binIndex = i + j * dimX + k * dimXY;
+        for (vtkIdType r = this->BinOffsets[binIndex];
+             r < this->BinOffsets[binIndex + 1]; ++r)
+          {
+          const Run& run = this->Runs[r];
+          unsigned char& lineFlag = flags[run.Line];
+          for (vtkIdType p = 0; p < run.NumberOfPoints && lineFlag != allFlags; ++p)
+            {
+            points->GetPoint(connectivity[run.Location + p], x);
+            const double value = function->FunctionValue(x);
+            if (value < 0.)
+              {
+              lineFlag = allFlags;
+              }
+            else if (value == 0.)
+              {
+              lineFlag |= PointInsideOrOnBoundary;
+              }
+            }
+          }
+        }
+      }
+    }
+}
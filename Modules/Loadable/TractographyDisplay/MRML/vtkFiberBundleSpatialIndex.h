@@ -0,0 +1,106 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+///  vtkFiberBundleSpatialIndex - Uniform grid of the fiber segments of a bundle
+///
+/// The points of each line (fiber) of the polydata are binned in a uniform
+/// grid. Consecutive points of a fiber falling in the same bin are stored as
+/// a single run, so the index is much smaller than the bundle itself.
+/// Finding the fibers with points inside an implicit function (e.g. the
+/// planes of an ROI) only evaluates the points of the bins overlapping the
+/// bounds of the region instead of every point of the bundle.
+//
+
+#ifndef __vtkFiberBundleSpatialIndex_h
+#define __vtkFiberBundleSpatialIndex_h
+
+// Tractography includes
+#include "vtkSlicerTractographyDisplayModuleMRMLExport.h"
+
+// VTK includes
+#include <vtkObject.h>
+
+// STD includes
+#include <vector>
+
+class vtkImplicitFunction;
+class vtkPolyData;
+class vtkUnsignedCharArray;
+
+class VTK_SLICER_TRACTOGRAPHYDISPLAY_MODULE_MRML_EXPORT vtkFiberBundleSpatialIndex : public vtkObject
+{
+public:
+  static vtkFiberBundleSpatialIndex *New();
+  vtkTypeMacro(vtkFiberBundleSpatialIndex, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  ///
+  /// Polydata whose lines are indexed. The index is rebuilt when the
+  /// polydata is modified.
+  void SetPolyData(vtkPolyData* polyData);
+  vtkGetObjectMacro(PolyData, vtkPolyData);
+
+  ///
+  /// Average number of points per bin used to choose the grid resolution.
+  /// 32 by default.
+  vtkSetClampMacro(NumberOfPointsPerBin, int, 1, VTK_INT_MAX);
+  vtkGetMacro(NumberOfPointsPerBin, int);
+
+  ///
+  /// Build the index if it is not up to date with the polydata.
+  void BuildIndex();
+
+  enum
+  {
+    /// At least one point of the line is inside or on the boundary (f <= 0)
+    PointInsideOrOnBoundary = 0x1,
+    /// At least one point of the line is strictly inside (f < 0)
+    PointInside = 0x2
+  };
+
+  ///
+  /// Set lineFlags (one value per line of the polydata) to the
+  /// combination of PointInsideOrOnBoundary and PointInside describing
+  /// the points of the line.
+  /// Only the points in the bins overlapping bounds are evaluated: the
+  /// region where the function is <= 0 must be contained in bounds.
+  void EvaluateLines(vtkImplicitFunction* function, const double bounds[6],
+                     vtkUnsignedCharArray* lineFlags);
+
+protected:
+  vtkFiberBundleSpatialIndex();
+  ~vtkFiberBundleSpatialIndex();
+
+  /// Run of consecutive points of a line in the same bin
+  struct Run
+  {
+    vtkIdType Line;
+    /// Position of the first point id in the connectivity of the lines
+    vtkIdType Location;
+    vtkIdType NumberOfPoints;
+  };
+
+  void ComputeBin(const double x[3], int bin[3])const;
+
+  vtkPolyData* PolyData;
+  int NumberOfPointsPerBin;
+  vtkTimeStamp BuildTime;
+
+  double Origin[3];
+  double BinSize[3];
+  int Dimensions[3];
+  /// Runs of bin b are Runs[BinOffsets[b]] to Runs[BinOffsets[b+1]-1]
+  std::vector<vtkIdType> BinOffsets;
+  std::vector<Run> Runs;
+
+private:
+  vtkFiberBundleSpatialIndex(const vtkFiberBundleSpatialIndex&); /// Not implemented.
+  void operator=(const vtkFiberBundleSpatialIndex&); /// Not implemented.
+};
+
+#endif
@@ -28,6 +28,8 @@ Version:   $Revision: 1.3 $
 #include <vtkPointData.h>
 
 // STD includes
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 
 //----------------------------------------------------------------------------
@@ -49,6 +51,9 @@ vtkMRMLFiberBundleDisplayNode::vtkMRMLFiberBundleDisplayNode()
   this->ScalarRange[0] = 0.;
   this->ScalarRange[1] = 1.;
 
+  this->LevelOfDetailDistance = 0.;
+  this->LevelOfDetailPointStride = 1;
+
   this->SetColor(250.0/255,250.0/255,210.0/255);
 }
 
@@ -68,6 +73,7 @@ void vtkMRMLFiberBundleDisplayNode::WriteXML(ostream& of, int nIndent)
   vtkIndent indent(nIndent);
 
   of << indent << " colorMode =\"" << this->ColorMode << "\"";
+  of << indent << " levelOfDetailDistance =\"" << this->LevelOfDetailDistance << "\"";
 
   if (this->ActiveTensorName != NULL)
     {
@@ -106,6 +112,12 @@ void vtkMRMLFiberBundleDisplayNode::ReadXMLAttributes(const char** atts)
       {
       this->SetActiveTensorName(attValue);
       }
+    else if (!strcmp(attName, "levelOfDetailDistance"))
+      {
+      std::stringstream ss;
+      ss << attValue;
+      ss >> this->LevelOfDetailDistance;
+      }
     else if (!strcmp(attName, "DiffusionTensorDisplayPropertiesNodeRef"))
       {
       this->SetDiffusionTensorDisplayPropertiesNodeID(attValue);
@@ -129,6 +141,7 @@ void vtkMRMLFiberBundleDisplayNode::Copy(vtkMRMLNode *anode)
 
   this->SetDiffusionTensorDisplayPropertiesNodeID(node->DiffusionTensorDisplayPropertiesNodeID);
   this->SetActiveTensorName(node->ActiveTensorName);
+  this->SetLevelOfDetailDistance(node->LevelOfDetailDistance);
 
   this->EndModify(disabledModify);
   }
@@ -142,6 +155,42 @@ void vtkMRMLFiberBundleDisplayNode::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "ColorMode:             " << this->ColorMode << "\n";
   os << indent<< "ActiveTensorName: " <<
     (this->ActiveTensorName ? this->ActiveTensorName : "(none)") << "\n";
+  os << indent << "LevelOfDetailDistance: " << this->LevelOfDetailDistance << "\n";
+  os << indent << "LevelOfDetailPointStride: " << this->LevelOfDetailPointStride << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLFiberBundleDisplayNode::SetLevelOfDetailPointStride(int stride)
+{
+  // Runtime property: no Modified() to not trigger a new render
+  this->LevelOfDetailPointStride = stride < 1 ? 1 : stride;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLFiberBundleDisplayNode::ComputeLevelOfDetailPointStride(const double cameraPosition[3])
+{
+  const int maximumPointStride = 8;
+  vtkMRMLFiberBundleNode* fiberBundleNode =
+    vtkMRMLFiberBundleNode::SafeDownCast(this->GetDisplayableNode());
+  vtkPolyData* polyData = fiberBundleNode ? fiberBundleNode->GetPolyData() : 0;
+  if (!polyData || polyData->GetNumberOfPoints() == 0 ||
+      this->LevelOfDetailDistance <= 0.)
+    {
+    return 1;
+    }
+  // Distance between the camera and the bounding box of the fibers
+  double bounds[6];
+  polyData->GetBounds(bounds);
+  double squaredDistance = 0.;
+  for (int i = 0; i < 3; ++i)
+    {
+    const double delta = std::max(0., std::max(bounds[2*i] - cameraPosition[i],
+                                               cameraPosition[i] - bounds[2*i+1]));
+    squaredDistance += delta * delta;
+    }
+  const double levels = sqrt(squaredDistance) / this->LevelOfDetailDistance;
+  return levels >= maximumPointStride - 1 ?
+    maximumPointStride : 1 + static_cast<int>(floor(levels));
 }
 
 //-----------------------------------------------------------
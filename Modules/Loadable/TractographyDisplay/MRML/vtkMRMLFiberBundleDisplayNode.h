@@ -161,6 +161,35 @@ class VTK_SLICER_TRACTOGRAPHYDISPLAY_MODULE_MRML_EXPORT vtkMRMLFiberBundleDispla
   /// Display Information: ColorMode for glyphs
   //--------------------------------------------------------------------------
 
+  //--------------------------------------------------------------------------
+  /// Display Information: Level of detail (tubes and glyphs)
+  //--------------------------------------------------------------------------
+
+  ///
+  /// Distance (in mm) between the camera and the fiber bundle for each
+  /// level of detail: beyond N * LevelOfDetailDistance, 1 point out of N+1
+  /// is displayed along the fibers. 0 (default) disables the level of detail.
+  vtkGetMacro(LevelOfDetailDistance, double);
+  vtkSetMacro(LevelOfDetailDistance, double);
+
+  ///
+  /// Return the stride between the displayed points of the fibers seen
+  /// from a camera at cameraPosition, according to the distance between the
+  /// camera and the bounding box of the fibers. Returns 1 if
+  /// LevelOfDetailDistance is 0, and at most 8.
+  int ComputeLevelOfDetailPointStride(const double cameraPosition[3]);
+
+  ///
+  /// Stride between the displayed points of the fibers. The display
+  /// pipeline is shared by all the views: the displayable managers set the
+  /// smallest stride computed for the cameras of the views where the node is
+  /// displayed, so that the pipeline is not updated at each render. It is
+  /// not saved and doesn't modify the node.
+  /// Only used by the display nodes generating geometry per point.
+  /// \sa ComputeLevelOfDetailPointStride()
+  virtual void SetLevelOfDetailPointStride(int stride);
+  vtkGetMacro(LevelOfDetailPointStride, int);
+
   //--------------------------------------------------------------------------
   /// MRML nodes that are observed
   //--------------------------------------------------------------------------
@@ -209,6 +238,10 @@ class VTK_SLICER_TRACTOGRAPHYDISPLAY_MODULE_MRML_EXPORT vtkMRMLFiberBundleDispla
   /// Active Tensor Name
   char *ActiveTensorName;
 
+  /// Level of detail
+  double LevelOfDetailDistance;
+  int LevelOfDetailPointStride;
+
   /// Arrays
   //double ScalarRange[2];
   //
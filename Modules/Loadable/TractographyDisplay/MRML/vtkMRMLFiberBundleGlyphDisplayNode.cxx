@@ -13,6 +13,7 @@ Version:   $Revision: 1.3 $
 =========================================================================auto=*/
 
 // MRML includes
+#include "vtkFiberBundleLevelOfDetail.h"
 #include "vtkMRMLDiffusionTensorDisplayPropertiesNode.h"
 #include "vtkMRMLFiberBundleGlyphDisplayNode.h"
 #include "vtkMRMLScene.h"
@@ -24,6 +25,7 @@ Version:   $Revision: 1.3 $
 #include <vtkAlgorithmOutput.h>
 #include <vtkAssignAttribute.h>
 #include <vtkCallbackCommand.h>
+#include <vtkCleanPolyData.h>
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
 #include <vtkVersion.h>
@@ -34,7 +36,16 @@ vtkMRMLNodeNewMacro(vtkMRMLFiberBundleGlyphDisplayNode);
 //----------------------------------------------------------------------------
 vtkMRMLFiberBundleGlyphDisplayNode::vtkMRMLFiberBundleGlyphDisplayNode()
 {
+  this->LevelOfDetail = vtkFiberBundleLevelOfDetail::New();
+  this->CleanPolyData = vtkCleanPolyData::New();
+  this->CleanPolyData->SetInputConnection(this->LevelOfDetail->GetOutputPort());
+  this->CleanPolyData->ConvertLinesToPointsOff();
+  this->CleanPolyData->ConvertPolysToLinesOff();
+  this->CleanPolyData->ConvertStripsToPolysOff();
+  this->CleanPolyData->PointMergingOff();
   this->DiffusionTensorGlyphFilter = vtkDiffusionTensorGlyph::New();
+  this->DiffusionTensorGlyphFilter->SetInputConnection(
+    this->CleanPolyData->GetOutputPort());
 
   this->TwoDimensionalVisibility = 0;
   this->ColorMode = vtkMRMLFiberBundleDisplayNode::colorModeScalar;
@@ -45,6 +56,15 @@ vtkMRMLFiberBundleGlyphDisplayNode::~vtkMRMLFiberBundleGlyphDisplayNode()
 {
   this->RemoveObservers ( vtkCommand::ModifiedEvent, this->MRMLCallbackCommand );
   this->DiffusionTensorGlyphFilter->Delete();
+  this->CleanPolyData->Delete();
+  this->LevelOfDetail->Delete();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLFiberBundleGlyphDisplayNode::SetLevelOfDetailPointStride(int stride)
+{
+  this->Superclass::SetLevelOfDetailPointStride(stride);
+  this->LevelOfDetail->SetPointStride(this->LevelOfDetailPointStride);
 }
 
 //----------------------------------------------------------------------------
@@ -121,7 +141,7 @@ void vtkMRMLFiberBundleGlyphDisplayNode::UpdatePolyDataPipeline()
 {
   this->Superclass::UpdatePolyDataPipeline();
 
-  this->DiffusionTensorGlyphFilter->SetInputConnection(
+  this->LevelOfDetail->SetInputConnection(
     this->Superclass::GetOutputPolyDataConnection());
 
   // set display properties according to the tensor-specific display properties node for glyphs
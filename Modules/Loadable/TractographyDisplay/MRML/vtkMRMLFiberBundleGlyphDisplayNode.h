@@ -26,6 +26,7 @@
 
 class vtkDiffusionTensorGlyph;
 class vtkCleanPolyData;
+class vtkFiberBundleLevelOfDetail;
 class vtkPolyData;
 
 class VTK_SLICER_TRACTOGRAPHYDISPLAY_MODULE_MRML_EXPORT vtkMRMLFiberBundleGlyphDisplayNode : public vtkMRMLFiberBundleDisplayNode
@@ -72,6 +73,10 @@ class VTK_SLICER_TRACTOGRAPHYDISPLAY_MODULE_MRML_EXPORT vtkMRMLFiberBundleGlyphD
   vtkGetMacro ( TwoDimensionalVisibility , int );
   vtkBooleanMacro ( TwoDimensionalVisibility , int );
 
+  ///
+  /// Reimplemented to glyph fewer points along the fibers
+  virtual void SetLevelOfDetailPointStride(int stride);
+
  protected:
   vtkMRMLFiberBundleGlyphDisplayNode ( );
   ~vtkMRMLFiberBundleGlyphDisplayNode ( );
@@ -87,6 +92,10 @@ class VTK_SLICER_TRACTOGRAPHYDISPLAY_MODULE_MRML_EXPORT vtkMRMLFiberBundleGlyphD
 
 
   /// dispaly pipeline
+  /// The fibers may not use all the points of the polydata (ROI selection):
+  /// unused points are removed before glyphing.
+  vtkFiberBundleLevelOfDetail *LevelOfDetail;
+  vtkCleanPolyData *CleanPolyData;
   vtkDiffusionTensorGlyph *DiffusionTensorGlyphFilter;
 };
 
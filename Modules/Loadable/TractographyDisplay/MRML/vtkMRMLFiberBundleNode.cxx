@@ -13,6 +13,7 @@ Version:   $Revision: 1.3 $
 =========================================================================auto=*/
 
 // TractographyMRML includes
+#include "vtkFiberBundleROISelection.h"
 #include "vtkMRMLFiberBundleGlyphDisplayNode.h"
 #include "vtkMRMLFiberBundleLineDisplayNode.h"
 #include "vtkMRMLFiberBundleNode.h"
@@ -24,25 +25,22 @@ Version:   $Revision: 1.3 $
 #include <vtkMRMLScene.h>
 #include <vtkMRMLAnnotationNode.h>
 #include <vtkMRMLAnnotationROINode.h>
+#include <vtkMRMLTransformNode.h>
 
 // VTK includes
 #include <vtkAlgorithmOutput.h>
-#include <vtkCleanPolyData.h>
 #include <vtkCommand.h>
-#include <vtkExtractPolyDataGeometry.h>
-#include <vtkExtractSelectedPolyDataIds.h>
 #include <vtkIdTypeArray.h>
 #include <vtkInformation.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPlanes.h>
-#include <vtkSelection.h>
-#include <vtkSelectionNode.h>
 #include <vtkVersion.h>
 
 // STD includes
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <math.h>
 #include <vector>
 
@@ -59,15 +57,13 @@ vtkIdType vtkMRMLFiberBundleNode::MaxNumberOfFibersToShowByDefault = 10000;
 vtkMRMLFiberBundleNode::vtkMRMLFiberBundleNode()
 {
   this->ShuffledIds = 0;
-  this->ExtractSelectedPolyDataIds = 0;
-  this->CleanPolyDataPostSubsampling = 0;
-  this->CleanPolyDataPostROISelection = 0;
+  this->SubsampledIds = 0;
   this->SubsamplingRatio = 0;
   this->SelectWithAnnotationNode = 0;
   this->SelectionWithAnnotationNodeMode = vtkMRMLFiberBundleNode::PositiveAnnotationNodeSelection;
   this->AnnotationNode = 0;
   this->AnnotationNodeID = 0;
-  this->ExtractPolyDataGeometry = 0;
+  this->ROISelection = 0;
   this->Planes = 0;
   this->SelectWithAnnotationNode = 0;
   this->EnableShuffleIDs = 1;
@@ -259,26 +255,12 @@ void vtkMRMLFiberBundleNode::UpdateReferenceID(const char *oldID, const char *ne
 #if (VTK_MAJOR_VERSION <= 5)
 vtkPolyData* vtkMRMLFiberBundleNode::GetFilteredPolyData()
 {
-  if (this->SelectWithAnnotationNode)
-    {
-    return this->CleanPolyDataPostROISelection->GetOutput();
-    }
-  else
-    {
-    return this->CleanPolyDataPostSubsampling->GetOutput();
-    }
+  return this->ROISelection->GetOutput();
 }
 #else
 vtkAlgorithmOutput* vtkMRMLFiberBundleNode::GetFilteredPolyDataConnection()
 {
-  if (this->SelectWithAnnotationNode)
-    {
-    return this->CleanPolyDataPostROISelection->GetOutputPort();
-    }
-  else
-    {
-    return this->CleanPolyDataPostSubsampling->GetOutputPort();
-    }
+  return this->ROISelection->GetOutputPort();
 }
 
 //----------------------------------------------------------------------------
@@ -415,12 +397,12 @@ vtkMRMLFiberBundleDisplayNode* vtkMRMLFiberBundleNode::AddGlyphDisplayNode()
 #if (VTK_MAJOR_VERSION <= 5)
 void vtkMRMLFiberBundleNode::SetAndObservePolyData(vtkPolyData* polyData)
 {
-  this->ExtractSelectedPolyDataIds->SetInput(0, polyData);
+  this->ROISelection->SetInput(polyData);
   this->Superclass::SetAndObservePolyData(polyData);
 #else
 void vtkMRMLFiberBundleNode::SetPolyDataConnection(vtkAlgorithmOutput *inputPort)
 {
-  this->ExtractSelectedPolyDataIds->SetInputConnection(0, inputPort);
+  this->ROISelection->SetInputConnection(inputPort);
   this->Superclass::SetPolyDataConnection(inputPort);
   vtkPolyData* polyData = this->GetPolyData();
 #endif
@@ -500,8 +482,10 @@ void vtkMRMLFiberBundleNode::SetSelectWithAnnotationNode(int _arg)
   if (this->SelectWithAnnotationNode != _arg)
     {
     this->SelectWithAnnotationNode = _arg;
+    this->UpdateROISelection();
     this->SetPolyDataToDisplayNodes();
     this->Modified();
+    this->InvokeEvent(vtkMRMLModelNode::PolyDataModifiedEvent, this);
     }
 }
 
@@ -515,11 +499,9 @@ void vtkMRMLFiberBundleNode::SetSelectionWithAnnotationNodeMode(int _arg)
 
     if (_arg == vtkMRMLFiberBundleNode::PositiveAnnotationNodeSelection)
     {
-      this->ExtractPolyDataGeometry->ExtractInsideOn();
-      this->ExtractPolyDataGeometry->ExtractBoundaryCellsOn();
+      this->ROISelection->ExtractInsideOn();
     } else if (_arg == vtkMRMLFiberBundleNode::NegativeAnnotationNodeSelection) {
-      this->ExtractPolyDataGeometry->ExtractInsideOff();
-      this->ExtractPolyDataGeometry->ExtractBoundaryCellsOff();
+      this->ROISelection->ExtractInsideOff();
     }
 
     this->Modified();
@@ -569,88 +551,34 @@ void vtkMRMLFiberBundleNode::SetAndObserveAnnotationNodeID ( const char *id )
 //----------------------------------------------------------------------------
 void vtkMRMLFiberBundleNode::PrepareSubsampling()
 {
-  vtkNew<vtkSelection> sel;
-  vtkNew<vtkSelectionNode> node;
-  vtkNew<vtkIdTypeArray> arr;
-
   this->SubsamplingRatio = 1.;
 
   this->ShuffledIds = vtkIdTypeArray::New();
-
-  this->ExtractSelectedPolyDataIds = vtkExtractSelectedPolyDataIds::New();
-
-  sel->AddNode(node.GetPointer());
-
-  node->GetProperties()->Set(vtkSelectionNode::CONTENT_TYPE(), vtkSelectionNode::INDICES);
-  node->GetProperties()->Set(vtkSelectionNode::FIELD_TYPE(), vtkSelectionNode::CELL);
-
-  arr->SetNumberOfTuples(0);
-  node->SetSelectionList(arr.GetPointer());
-
-#if (VTK_MAJOR_VERSION <= 5)
-  this->ExtractSelectedPolyDataIds->SetInput(1, sel.GetPointer());
-#else
-  this->ExtractSelectedPolyDataIds->SetInputData(1, sel.GetPointer());
-#endif
-
-  this->CleanPolyDataPostSubsampling = vtkCleanPolyData::New();
-  this->CleanPolyDataPostSubsampling->ConvertLinesToPointsOff();
-  this->CleanPolyDataPostSubsampling->ConvertPolysToLinesOff();
-  this->CleanPolyDataPostSubsampling->ConvertStripsToPolysOff();
-  this->CleanPolyDataPostSubsampling->PointMergingOff();
-
-  this->CleanPolyDataPostSubsampling->SetInputConnection(
-    this->ExtractSelectedPolyDataIds->GetOutputPort());
+  this->SubsampledIds = vtkIdTypeArray::New();
 }
 
 //----------------------------------------------------------------------------
 void vtkMRMLFiberBundleNode::UpdateSubsampling()
 {
   vtkDebugMacro(<< this->GetClassName() << "Updating the subsampling");
-  vtkSelection* sel = vtkSelection::SafeDownCast(this->ExtractSelectedPolyDataIds->GetInput(1));
   vtkPolyData* polyData = this->GetPolyData();
-  if (sel && polyData)
+  if (polyData)
     {
-    vtkSelectionNode* node = sel->GetNode(0);
-
-    vtkIdTypeArray* arr = vtkIdTypeArray::SafeDownCast(node->GetSelectionList());
-    vtkIdType numberOfCellsToKeep = vtkIdType(floor(this->GetPolyData()->GetNumberOfLines() * this->SubsamplingRatio));
+    vtkIdType numberOfCellsToKeep = vtkIdType(floor(polyData->GetNumberOfLines() * this->SubsamplingRatio));
+    numberOfCellsToKeep = std::min(numberOfCellsToKeep, this->ShuffledIds->GetNumberOfTuples());
 
-    arr->Initialize();
-    arr->SetNumberOfTuples(numberOfCellsToKeep);
+    // Only the ids are copied, the fibers are extracted from the shared
+    // points by the selection filter.
+    this->SubsampledIds->SetNumberOfTuples(numberOfCellsToKeep);
     if (numberOfCellsToKeep > 0)
       {
-      for (vtkIdType i=0; i<numberOfCellsToKeep; i++)
-        {
-        arr->SetValue(i, this->ShuffledIds->GetValue(i));
-        }
+      memcpy(this->SubsampledIds->GetPointer(0), this->ShuffledIds->GetPointer(0),
+             numberOfCellsToKeep * sizeof(vtkIdType));
       }
-
-    arr->Modified();
-    node->Modified();
-    sel->Modified();
+    this->SubsampledIds->Modified();
     }
 
-  /*
-  vtkMRMLFiberBundleDisplayNode *node = this->GetLineDisplayNode();
-  if (node != NULL)
-    {
-      node->SetPolyData(this->GetFilteredPolyData());
-    }
-
-  node = this->GetTubeDisplayNode();
-  if (node != NULL)
-    {
-      node->SetPolyData(this->GetFilteredPolyData());
-    }
-  node = this->GetGlyphDisplayNode();
-  if (node != NULL)
-    {
-      node->SetPolyData(this->GetFilteredPolyData());
-    }
-  }
-    */
-    // \tbd why not Modified() instead ?
+  // \tbd why not Modified() instead ?
   this->InvokeEvent(vtkMRMLModelNode::PolyDataModifiedEvent, this);
   //this->Modified();
 }
@@ -658,8 +586,7 @@ void vtkMRMLFiberBundleNode::UpdateSubsampling()
 //----------------------------------------------------------------------------
 void vtkMRMLFiberBundleNode::CleanSubsampling()
 {
-  this->CleanPolyDataPostSubsampling->Delete();
-  this->ExtractSelectedPolyDataIds->Delete();
+  this->SubsampledIds->Delete();
   this->ShuffledIds->Delete();
 }
 
@@ -669,25 +596,15 @@ void vtkMRMLFiberBundleNode::PrepareROISelection()
   this->AnnotationNode = NULL;
   this->AnnotationNodeID = NULL;
 
-  this->ExtractPolyDataGeometry = vtkExtractPolyDataGeometry::New();
+  this->ROISelection = vtkFiberBundleROISelection::New();
   this->Planes = vtkPlanes::New();
 
-  this->ExtractPolyDataGeometry->ExtractInsideOn();
-  this->ExtractPolyDataGeometry->ExtractBoundaryCellsOn();
-  this->ExtractPolyDataGeometry->SetInputConnection(
-    this->CleanPolyDataPostSubsampling->GetOutputPort());
+  this->ROISelection->ExtractInsideOn();
+  // Only the subsampled fibers are selected
+  this->ROISelection->SetLineIds(this->SubsampledIds);
 
   this->SelectionWithAnnotationNodeMode = vtkMRMLFiberBundleNode::PositiveAnnotationNodeSelection;
 
-  this->CleanPolyDataPostROISelection = vtkCleanPolyData::New();
-  this->CleanPolyDataPostROISelection->ConvertLinesToPointsOff();
-  this->CleanPolyDataPostROISelection->ConvertPolysToLinesOff();
-  this->CleanPolyDataPostROISelection->ConvertStripsToPolysOff();
-  this->CleanPolyDataPostROISelection->PointMergingOff();
-
-  this->CleanPolyDataPostROISelection->SetInputConnection(
-    this->ExtractPolyDataGeometry->GetOutputPort());
-
   this->SelectWithAnnotationNode = 0;
 }
 
@@ -699,8 +616,21 @@ void vtkMRMLFiberBundleNode::UpdateROISelection()
   if (AnnotationROI)
     {
     AnnotationROI->GetTransformedPlanes(this->Planes);
-    this->ExtractPolyDataGeometry->SetImplicitFunction(this->Planes);
+
+    // Only the fibers in the bounds of the ROI are tested with the planes
+    double bounds[6] = {VTK_DOUBLE_MIN, VTK_DOUBLE_MAX,
+                        VTK_DOUBLE_MIN, VTK_DOUBLE_MAX,
+                        VTK_DOUBLE_MIN, VTK_DOUBLE_MAX};
+    vtkMRMLTransformNode* transformNode = AnnotationROI->GetParentTransformNode();
+    if (!transformNode || transformNode->IsTransformToWorldLinear())
+      {
+      AnnotationROI->GetRASBounds(bounds);
+      }
+    this->ROISelection->SetBounds(bounds);
     }
+  // Without selection, the filter only keeps the subsampled fibers
+  this->ROISelection->SetImplicitFunction(
+    (this->SelectWithAnnotationNode && AnnotationROI) ? this->Planes : 0);
   if (this->GetSelectWithAnnotationNode())
     {
     this->InvokeEvent(vtkMRMLModelNode::PolyDataModifiedEvent, this);
@@ -712,8 +642,7 @@ void vtkMRMLFiberBundleNode::UpdateROISelection()
 void vtkMRMLFiberBundleNode::CleanROISelection()
 {
   this->SetAndObserveAnnotationNodeID(NULL);
-  this->CleanPolyDataPostROISelection->Delete();
-  this->ExtractPolyDataGeometry->Delete();
+  this->ROISelection->Delete();
   this->Planes->Delete();
 }
 
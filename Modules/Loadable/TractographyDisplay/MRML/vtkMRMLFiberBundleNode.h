@@ -29,12 +29,10 @@
 #include "vtkSlicerTractographyDisplayModuleMRMLExport.h"
 
 class vtkMRMLFiberBundleDisplayNode;
-class vtkExtractSelectedPolyDataIds;
 class vtkMRMLAnnotationNode;
 class vtkIdTypeArray;
-class vtkExtractPolyDataGeometry;
+class vtkFiberBundleROISelection;
 class vtkPlanes;
-class vtkCleanPolyData;
 
 class VTK_SLICER_TRACTOGRAPHYDISPLAY_MODULE_MRML_EXPORT vtkMRMLFiberBundleNode : public vtkMRMLModelNode
 {
@@ -229,10 +227,10 @@ protected:
   // Maximum number of fibers to show per bundle when it is loaded.
   static vtkIdType MaxNumberOfFibersToShowByDefault;
   vtkIdTypeArray* ShuffledIds;
-
-  vtkExtractSelectedPolyDataIds* ExtractSelectedPolyDataIds;
-  vtkCleanPolyData* CleanPolyDataPostSubsampling;
-  vtkCleanPolyData* CleanPolyDataPostROISelection;
+  /// First SubsamplingRatio ids of ShuffledIds: the fibers to display.
+  /// The filtered polydata is made of these fibers only, its points are
+  /// the points of the input polydata (no copy).
+  vtkIdTypeArray* SubsampledIds;
   float SubsamplingRatio;
 
   virtual void PrepareSubsampling();
@@ -246,7 +244,9 @@ protected:
 
   vtkMRMLAnnotationNode *AnnotationNode;
   char *AnnotationNodeID;
-  vtkExtractPolyDataGeometry *ExtractPolyDataGeometry;
+  /// Selects the subsampled fibers, and those touching (or not) the ROI
+  /// using a spatial index of the fibers built once per polydata.
+  vtkFiberBundleROISelection *ROISelection;
   vtkPlanes *Planes;
 
   virtual void PrepareROISelection();
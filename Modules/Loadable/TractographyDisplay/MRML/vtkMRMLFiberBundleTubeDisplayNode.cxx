@@ -12,6 +12,7 @@ Version:   $Revision: 1.3 $
 =========================================================================auto=*/
 
 // MRML includes
+#include "vtkFiberBundleLevelOfDetail.h"
 #include "vtkMRMLDiffusionTensorDisplayPropertiesNode.h"
 #include "vtkMRMLFiberBundleTubeDisplayNode.h"
 #include "vtkMRMLScene.h"
@@ -39,9 +40,13 @@ vtkMRMLNodeNewMacro(vtkMRMLFiberBundleTubeDisplayNode);
 vtkMRMLFiberBundleTubeDisplayNode::vtkMRMLFiberBundleTubeDisplayNode()
 {
   this->ColorMode = vtkMRMLFiberBundleDisplayNode::colorModeScalar;
+  this->LevelOfDetail = vtkFiberBundleLevelOfDetail::New();
+  this->LevelOfDetail->SetInputConnection(
+    this->Superclass::GetOutputPolyDataConnection());
+
   this->ColorLinesByOrientation = vtkPolyDataColorLinesByOrientation::New();
   this->ColorLinesByOrientation->SetInputConnection(
-    this->Superclass::GetOutputPolyDataConnection());
+    this->LevelOfDetail->GetOutputPort());
 
   this->TubeFilter = vtkTubeFilter::New();
   this->TubeNumberOfSides = 6;
@@ -50,7 +55,7 @@ vtkMRMLFiberBundleTubeDisplayNode::vtkMRMLFiberBundleTubeDisplayNode()
   this->TubeFilter->SetNumberOfSides(this->GetTubeNumberOfSides());
   this->TubeFilter->SetRadius(this->GetTubeRadius());
   this->TubeFilter->SetInputConnection(
-    this->Superclass::GetOutputPolyDataConnection());
+    this->LevelOfDetail->GetOutputPort());
 
   this->TensorToColor = vtkPolyDataTensorToColor::New();
   this->TensorToColor->SetInputConnection(this->TubeFilter->GetOutputPort());
@@ -70,6 +75,7 @@ vtkMRMLFiberBundleTubeDisplayNode::~vtkMRMLFiberBundleTubeDisplayNode()
   this->TubeFilter->Delete();
   this->TensorToColor->Delete();
   this->ColorLinesByOrientation->Delete();
+  this->LevelOfDetail->Delete();
 }
 
 //----------------------------------------------------------------------------
@@ -149,15 +155,24 @@ vtkAlgorithmOutput* vtkMRMLFiberBundleTubeDisplayNode::GetOutputPolyDataConnecti
   return this->TensorToColor->GetOutputPort();
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLFiberBundleTubeDisplayNode::SetLevelOfDetailPointStride(int stride)
+{
+  this->Superclass::SetLevelOfDetailPointStride(stride);
+  this->LevelOfDetail->SetPointStride(this->LevelOfDetailPointStride);
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLFiberBundleTubeDisplayNode::UpdatePolyDataPipeline()
 {
   this->Superclass::UpdatePolyDataPipeline();
 
-  this->ColorLinesByOrientation->SetInputConnection(
+  this->LevelOfDetail->SetInputConnection(
     this->Superclass::GetOutputPolyDataConnection());
+  this->ColorLinesByOrientation->SetInputConnection(
+    this->LevelOfDetail->GetOutputPort());
   this->TubeFilter->SetInputConnection(
-    this->Superclass::GetOutputPolyDataConnection());
+    this->LevelOfDetail->GetOutputPort());
 
   if (!this->Visibility)
     {
@@ -24,6 +24,7 @@
 
 #include "vtkMRMLFiberBundleDisplayNode.h"
 
+class vtkFiberBundleLevelOfDetail;
 class vtkPolyData;
 class vtkPolyDataTensorToColor;
 class vtkTubeFilter;
@@ -77,6 +78,10 @@ class VTK_SLICER_TRACTOGRAPHYDISPLAY_MODULE_MRML_EXPORT vtkMRMLFiberBundleTubeDi
   vtkSetMacro ( TubeNumberOfSides , int );
   vtkGetMacro ( TubeNumberOfSides , int );
 
+  ///
+  /// Reimplemented to decimate the fibers before generating the tubes
+  virtual void SetLevelOfDetailPointStride(int stride);
+
 
  protected:
   vtkMRMLFiberBundleTubeDisplayNode ( );
@@ -94,6 +99,7 @@ class VTK_SLICER_TRACTOGRAPHYDISPLAY_MODULE_MRML_EXPORT vtkMRMLFiberBundleTubeDi
   double TubeRadius;
 
   /// dispaly pipeline
+  vtkFiberBundleLevelOfDetail *LevelOfDetail;
   vtkTubeFilter *TubeFilter;
   vtkPolyDataTensorToColor *TensorToColor;
   vtkPolyDataColorLinesByOrientation *ColorLinesByOrientation;
@@ -24,6 +24,7 @@
 
 // MRML includes
 #include "vtkEventBroker.h"
+#include "vtkMRMLCameraNode.h"
 #include "vtkMRMLInteractionNode.h"
 #include "vtkMRMLViewNode.h"
 #include "vtkMRMLFiberBundleNode.h"
@@ -39,6 +40,8 @@
 // VTK includes
 
 #include "vtkInteractorStyle.h"
+#include <vtkCallbackCommand.h>
+#include <vtkCamera.h>
 #include <vtkNew.h>
 #include "vtkObjectFactory.h"
 #include "vtkRenderWindow.h"
@@ -47,6 +50,11 @@
 #include "vtkPolyData.h"
 #include "vtkPointData.h"
 
+// STD includes
+#include <algorithm>
+#include <cstring>
+#include <string>
+
 // ITKSys includes
 //#include <itksys/SystemTools.hxx>
 //#include <itksys/Directory.hxx>
@@ -62,6 +70,11 @@ vtkMRMLTractographyDisplayDisplayableManager::vtkMRMLTractographyDisplayDisplaya
   this->EnableFiberEdit = 0;
   this->SelectedFiberBundleNode = 0;
 
+  this->RenderCallbackCommand = vtkCallbackCommand::New();
+  this->RenderCallbackCommand->SetClientData(this);
+  this->RenderCallbackCommand->SetCallback(
+    vtkMRMLTractographyDisplayDisplayableManager::RenderCallback);
+
   this->RemoveInteractorStyleObservableEvent(vtkCommand::LeftButtonPressEvent);
   this->RemoveInteractorStyleObservableEvent(vtkCommand::LeftButtonReleaseEvent);
   this->RemoveInteractorStyleObservableEvent(vtkCommand::RightButtonPressEvent);
@@ -78,6 +91,11 @@ vtkMRMLTractographyDisplayDisplayableManager::vtkMRMLTractographyDisplayDisplaya
 //---------------------------------------------------------------------------
 vtkMRMLTractographyDisplayDisplayableManager::~vtkMRMLTractographyDisplayDisplayableManager()
 {
+  if (this->ObservedRenderer)
+    {
+    this->ObservedRenderer->RemoveObserver(this->RenderCallbackCommand);
+    }
+  this->RenderCallbackCommand->Delete();
 }
 
 //---------------------------------------------------------------------------
@@ -93,6 +111,107 @@ int vtkMRMLTractographyDisplayDisplayableManager::ActiveInteractionModes()
 }
 
 
+//---------------------------------------------------------------------------
+void vtkMRMLTractographyDisplayDisplayableManager::Create()
+{
+  this->Superclass::Create();
+  if (this->ObservedRenderer)
+    {
+    this->ObservedRenderer->RemoveObserver(this->RenderCallbackCommand);
+    }
+  this->ObservedRenderer = this->GetRenderer();
+  if (this->ObservedRenderer)
+    {
+    this->ObservedRenderer->AddObserver(vtkCommand::StartEvent,
+                                        this->RenderCallbackCommand);
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLTractographyDisplayDisplayableManager::RenderCallback(
+  vtkObject *vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+  void *clientData, void *vtkNotUsed(callData))
+{
+  vtkMRMLTractographyDisplayDisplayableManager* self =
+    reinterpret_cast<vtkMRMLTractographyDisplayDisplayableManager*>(clientData);
+  self->UpdateLevelOfDetail();
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLTractographyDisplayDisplayableManager::UpdateLevelOfDetail()
+{
+  vtkMRMLScene* scene = this->GetMRMLScene();
+  vtkCamera* camera = this->GetRenderer() ? this->GetRenderer()->GetActiveCamera() : 0;
+  if (!scene || !camera || scene->IsBatchProcessing())
+    {
+    return;
+    }
+  const char* viewNodeID =
+    this->GetMRMLViewNode() ? this->GetMRMLViewNode()->GetID() : 0;
+
+  // Camera positions of the displayed 3D views. The camera node of the view
+  // being rendered may not be updated yet: its camera is used instead.
+  std::vector<std::string> viewNodeIDs;
+  std::vector<double> cameraPositions;
+  viewNodeIDs.push_back(viewNodeID ? viewNodeID : "");
+  cameraPositions.resize(3);
+  camera->GetPosition(&cameraPositions[0]);
+  std::vector<vtkMRMLNode*> cameraNodes;
+  scene->GetNodesByClass("vtkMRMLCameraNode", cameraNodes);
+  for (std::vector<vtkMRMLNode*>::iterator it = cameraNodes.begin();
+       it != cameraNodes.end(); ++it)
+    {
+    vtkMRMLCameraNode* cameraNode = vtkMRMLCameraNode::SafeDownCast(*it);
+    const char* cameraViewNodeID = cameraNode ? cameraNode->GetActiveTag() : 0;
+    if (!cameraViewNodeID ||
+        (viewNodeID && !strcmp(cameraViewNodeID, viewNodeID)))
+      {
+      continue;
+      }
+    vtkMRMLViewNode* cameraViewNode =
+      vtkMRMLViewNode::SafeDownCast(scene->GetNodeByID(cameraViewNodeID));
+    if (!cameraViewNode || !cameraViewNode->GetVisibility() ||
+        !cameraViewNode->IsMappedInLayout())
+      {
+      continue;
+      }
+    viewNodeIDs.push_back(cameraViewNodeID);
+    cameraPositions.resize(cameraPositions.size() + 3);
+    cameraNode->GetPosition(&cameraPositions[cameraPositions.size() - 3]);
+    }
+
+  std::vector<vtkMRMLNode*> nodes;
+  scene->GetNodesByClass("vtkMRMLFiberBundleDisplayNode", nodes);
+  for (std::vector<vtkMRMLNode*>::iterator it = nodes.begin(); it != nodes.end(); ++it)
+    {
+    vtkMRMLFiberBundleDisplayNode* displayNode =
+      vtkMRMLFiberBundleDisplayNode::SafeDownCast(*it);
+    // Line display nodes don't generate geometry per point
+    if (!displayNode || vtkMRMLFiberBundleLineDisplayNode::SafeDownCast(displayNode) ||
+        !displayNode->GetVisibility() ||
+        (viewNodeID && !displayNode->IsDisplayableInView(viewNodeID)))
+      {
+      continue;
+      }
+    // The display pipeline is shared by the views: use the finest level of
+    // detail needed by the views displaying the node. Every view computes
+    // the same stride, the pipeline is only updated when it changes.
+    int stride = displayNode->ComputeLevelOfDetailPointStride(&cameraPositions[0]);
+    for (size_t i = 1; i < viewNodeIDs.size(); ++i)
+      {
+      if (displayNode->IsDisplayableInView(viewNodeIDs[i].c_str()))
+        {
+        stride = std::min(stride,
+          displayNode->ComputeLevelOfDetailPointStride(&cameraPositions[3*i]));
+        }
+      }
+    if (stride != displayNode->GetLevelOfDetailPointStride())
+      {
+      displayNode->SetLevelOfDetailPointStride(stride);
+      }
+    }
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLTractographyDisplayDisplayableManager::OnInteractorStyleEvent(int eventid)
 {
@@ -26,10 +26,15 @@
 
 class vtkMRMLFiberBundleDisplayNode;
 class vtkMRMLFiberBundleNode;
+class vtkCallbackCommand;
+class vtkRenderer;
 
 // MRML DisplayableManager includes
 #include <vtkMRMLAbstractThreeDViewDisplayableManager.h>
 
+// VTK includes
+#include <vtkWeakPointer.h>
+
 // STD includes
 #include <vector>
 
@@ -53,6 +58,9 @@ protected:
 
   virtual int ActiveInteractionModes();
 
+  /// Observe the renderer to update the level of detail before rendering
+  virtual void Create();
+
   virtual void SetMRMLSceneInternal(vtkMRMLScene* newScene);
   virtual void ProcessMRMLNodesEvents(vtkObject *caller, unsigned long event, void *callData);
 
@@ -65,11 +73,22 @@ protected:
   void DeletePickedFibers(vtkMRMLFiberBundleNode *fiberBundleNode, std::vector<vtkIdType> &cellIDs);
   void SelectPickedFibers(vtkMRMLFiberBundleNode *fiberBundleNode, std::vector<vtkIdType> &cellIDs);
 
+  /// Set the point stride of the tube and glyph display nodes visible in the
+  /// view according to the distance between the fibers and the cameras of
+  /// the 3D views displaying them. Called before each render of the view.
+  /// \sa vtkMRMLFiberBundleDisplayNode::ComputeLevelOfDetailPointStride()
+  void UpdateLevelOfDetail();
+  static void RenderCallback(vtkObject *caller, unsigned long eid,
+                             void *clientData, void *callData);
+
 protected:
 
   int EnableFiberEdit;
   vtkMRMLFiberBundleNode* SelectedFiberBundleNode;
   std::map <vtkIdType, std::vector<double> > SelectedCells;
+
+  vtkCallbackCommand* RenderCallbackCommand;
+  vtkWeakPointer<vtkRenderer> ObservedRenderer;
 };
 
 #endif
@@ -0,0 +1,265 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include <vtkFiberBundleROISelection.h>
+#include <vtkFiberBundleSpatialIndex.h>
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkPlanes.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkUnsignedCharArray.h>
+
+// STD includes
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+// Random walks in [-50,50]^3, and a fiber that only touches the face x=10 of
+// the ROIs ending at x=10.
+void createFibers(vtkPolyData* polyData)
+{
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkCellArray> lines;
+  vtkMath::RandomSeed(32);
+  for (int fiber = 0; fiber < 300; ++fiber)
+    {
+    const int numberOfPoints = static_cast<int>(vtkMath::Random(2., 80.));
+    double x[3] = {vtkMath::Random(-50., 50.),
+                   vtkMath::Random(-50., 50.),
+                   vtkMath::Random(-50., 50.)};
+    lines->InsertNextCell(numberOfPoints);
+    for (int i = 0; i < numberOfPoints; ++i)
+      {
+      for (int c = 0; c < 3; ++c)
+        {
+        x[c] = std::max(-50., std::min(50., x[c] + vtkMath::Random(-2., 2.)));
+        }
+      lines->InsertCellPoint(points->InsertNextPoint(x));
+      }
+    }
+  lines->InsertNextCell(3);
+  lines->InsertCellPoint(points->InsertNextPoint(20., 0., 0.));
+  lines->InsertCellPoint(points->InsertNextPoint(10., 0., 0.));
+  lines->InsertCellPoint(points->InsertNextPoint(20., 1., 0.));
+  polyData->SetPoints(points.GetPointer());
+  polyData->SetLines(lines.GetPointer());
+}
+
+//-----------------------------------------------------------------------------
+// Flags of each line computed by evaluating the function on every point.
+std::vector<unsigned char> bruteForceLineFlags(vtkPolyData* polyData,
+                                               vtkImplicitFunction* function)
+{
+  std::vector<unsigned char> lineFlags;
+  vtkCellArray* lines = polyData->GetLines();
+  vtkIdType npts = 0;
+  vtkIdType* pts = 0;
+  double x[3];
+  lines->InitTraversal();
+  while (lines->GetNextCell(npts, pts))
+    {
+    unsigned char flags = 0;
+    for (vtkIdType i = 0; i < npts; ++i)
+      {
+      polyData->GetPoints()->GetPoint(pts[i], x);
+      const double value = function->FunctionValue(x);
+      if (value <= 0.)
+        {
+        flags |= vtkFiberBundleSpatialIndex::PointInsideOrOnBoundary;
+        }
+      if (value < 0.)
+        {
+        flags |= vtkFiberBundleSpatialIndex::PointInside;
+        }
+      }
+    lineFlags.push_back(flags);
+    }
+  return lineFlags;
+}
+
+//-----------------------------------------------------------------------------
+bool testEvaluateLines(vtkPolyData* fibers, const double roiBounds[6],
+                       int numberOfPointsPerBin)
+{
+  vtkNew<vtkPlanes> roi;
+  roi->SetBounds(const_cast<double*>(roiBounds));
+  std::vector<unsigned char> expectedFlags =
+    bruteForceLineFlags(fibers, roi.GetPointer());
+
+  vtkNew<vtkFiberBundleSpatialIndex> spatialIndex;
+  spatialIndex->SetPolyData(fibers);
+  spatialIndex->SetNumberOfPointsPerBin(numberOfPointsPerBin);
+  vtkNew<vtkUnsignedCharArray> lineFlags;
+  spatialIndex->EvaluateLines(roi.GetPointer(), roiBounds, lineFlags.GetPointer());
+  if (lineFlags->GetNumberOfTuples() != static_cast<vtkIdType>(expectedFlags.size()))
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong number of lines: "
+              << lineFlags->GetNumberOfTuples() << " instead of "
+              << expectedFlags.size() << std::endl;
+    return false;
+    }
+  for (size_t line = 0; line < expectedFlags.size(); ++line)
+    {
+    if (lineFlags->GetValue(line) != expectedFlags[line])
+      {
+      std::cerr << "Line " << __LINE__ << " - Wrong flags for fiber " << line
+                << " with " << numberOfPointsPerBin << " points per bin and ROI ["
+                << roiBounds[0] << "," << roiBounds[1] << "]x["
+                << roiBounds[2] << "," << roiBounds[3] << "]x["
+                << roiBounds[4] << "," << roiBounds[5] << "]: "
+                << static_cast<int>(lineFlags->GetValue(line)) << " instead of "
+                << static_cast<int>(expectedFlags[line]) << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool testROISelection(vtkPolyData* fibers, const double roiBounds[6])
+{
+  vtkNew<vtkPlanes> roi;
+  roi->SetBounds(const_cast<double*>(roiBounds));
+  std::vector<unsigned char> expectedFlags =
+    bruteForceLineFlags(fibers, roi.GetPointer());
+
+  vtkNew<vtkFiberBundleROISelection> selection;
+#if (VTK_MAJOR_VERSION <= 5)
+  selection->SetInput(fibers);
+#else
+  selection->SetInputData(fibers);
+#endif
+  selection->SetImplicitFunction(roi.GetPointer());
+  selection->SetBounds(const_cast<double*>(roiBounds));
+  for (int extractInside = 0; extractInside < 2; ++extractInside)
+    {
+    selection->SetExtractInside(extractInside);
+    selection->Update();
+
+    // Same fibers, in the same order, as the fibers with a point inside or
+    // on the ROI (ExtractInside on) or without any point inside (off)
+    vtkCellArray* selectedLines = selection->GetOutput()->GetLines();
+    vtkCellArray* lines = fibers->GetLines();
+    vtkIdType npts = 0, selectedNpts = 0;
+    vtkIdType *pts = 0, *selectedPts = 0;
+    lines->InitTraversal();
+    selectedLines->InitTraversal();
+    for (size_t line = 0; line < expectedFlags.size(); ++line)
+      {
+      lines->GetNextCell(npts, pts);
+      const bool expectedSelected = extractInside ?
+        (expectedFlags[line] & vtkFiberBundleSpatialIndex::PointInsideOrOnBoundary) != 0 :
+        (expectedFlags[line] & vtkFiberBundleSpatialIndex::PointInside) == 0;
+      if (!expectedSelected)
+        {
+        continue;
+        }
+      if (!selectedLines->GetNextCell(selectedNpts, selectedPts) ||
+          selectedNpts != npts || selectedPts[0] != pts[0])
+        {
+        std::cerr << "Line " << __LINE__ << " - Fiber " << line
+                  << " not selected with ExtractInside " << extractInside
+                  << std::endl;
+        return false;
+        }
+      }
+    if (selectedLines->GetNextCell(selectedNpts, selectedPts))
+      {
+      std::cerr << "Line " << __LINE__ << " - Too many fibers selected with "
+                << "ExtractInside " << extractInside << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int vtkFiberBundleSpatialIndexTest1(int vtkNotUsed(argc), char * vtkNotUsed(argv)[])
+{
+  vtkNew<vtkPolyData> fibers;
+  createFibers(fibers.GetPointer());
+
+  // Small, large, crossing the bundle bounds, outside of the bundle,
+  // containing the whole bundle, and ending on a fiber point (x=10)
+  const double roiBounds[6][6] = {
+    {-5., 5., -5., 5., -5., 5.},
+    {-40., 30., -20., 45., -35., 0.},
+    {40., 70., -70., -30., 20., 80.},
+    {60., 80., 60., 80., 60., 80.},
+    {-100., 100., -100., 100., -100., 100.},
+    {0., 10., -1., 1., -1., 1.}};
+  const int numberOfPointsPerBin[3] = {1, 32, 100000};
+  for (int r = 0; r < 6; ++r)
+    {
+    for (int n = 0; n < 3; ++n)
+      {
+      if (!testEvaluateLines(fibers.GetPointer(), roiBounds[r], numberOfPointsPerBin[n]))
+        {
+        return EXIT_FAILURE;
+        }
+      }
+    if (!testROISelection(fibers.GetPointer(), roiBounds[r]))
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  // The index is rebuilt when the fibers are moved
+  vtkNew<vtkPlanes> roi;
+  roi->SetBounds(const_cast<double*>(roiBounds[0]));
+  vtkNew<vtkFiberBundleSpatialIndex> spatialIndex;
+  spatialIndex->SetPolyData(fibers.GetPointer());
+  vtkNew<vtkUnsignedCharArray> lineFlags;
+  spatialIndex->EvaluateLines(roi.GetPointer(), roiBounds[0], lineFlags.GetPointer());
+  vtkPoints* points = fibers->GetPoints();
+  for (vtkIdType i = 0; i < points->GetNumberOfPoints(); ++i)
+    {
+    double x[3];
+    points->GetPoint(i, x);
+    points->SetPoint(i, x[1], x[2], x[0]);
+    }
+  points->Modified();
+  if (!testEvaluateLines(fibers.GetPointer(), roiBounds[0], 32))
+    {
+    return EXIT_FAILURE;
+    }
+  std::vector<unsigned char> expectedFlags =
+    bruteForceLineFlags(fibers.GetPointer(), roi.GetPointer());
+  spatialIndex->EvaluateLines(roi.GetPointer(), roiBounds[0], lineFlags.GetPointer());
+  for (size_t line = 0; line < expectedFlags.size(); ++line)
+    {
+    if (lineFlags->GetValue(line) != expectedFlags[line])
+      {
+      std::cerr << "Line " << __LINE__ << " - Index not rebuilt, wrong flags for fiber "
+                << line << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
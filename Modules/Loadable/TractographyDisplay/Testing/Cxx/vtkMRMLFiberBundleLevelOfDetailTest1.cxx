@@ -0,0 +1,237 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include <vtkFiberBundleLevelOfDetail.h>
+#include <vtkMRMLFiberBundleNode.h>
+#include <vtkMRMLFiberBundleTubeDisplayNode.h>
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkAlgorithmOutput.h>
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+
+// STD includes
+#include <iostream>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+// Two fibers of 21 points along X, from 0 to 20mm
+void createFibers(vtkPolyData* polyData)
+{
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkCellArray> lines;
+  vtkNew<vtkFloatArray> scalars;
+  scalars->SetName("scalars");
+  for (int fiber = 0; fiber < 2; ++fiber)
+    {
+    lines->InsertNextCell(21);
+    for (int i = 0; i < 21; ++i)
+      {
+      lines->InsertCellPoint(points->InsertNextPoint(i, 5. * fiber, 0.));
+      scalars->InsertNextValue(i);
+      }
+    }
+  polyData->SetPoints(points.GetPointer());
+  polyData->SetLines(lines.GetPointer());
+  polyData->GetPointData()->SetScalars(scalars.GetPointer());
+}
+
+//-----------------------------------------------------------------------------
+vtkPolyData* updateOutput(vtkMRMLFiberBundleDisplayNode* displayNode)
+{
+#if (VTK_MAJOR_VERSION <= 5)
+  displayNode->GetOutputPolyData()->Update();
+#else
+  displayNode->GetOutputPolyDataConnection()->GetProducer()->Update();
+#endif
+  return displayNode->GetOutputPolyData();
+}
+
+//-----------------------------------------------------------------------------
+bool testLevelOfDetailFilter()
+{
+  vtkNew<vtkPolyData> fibers;
+  createFibers(fibers.GetPointer());
+
+  vtkNew<vtkFiberBundleLevelOfDetail> levelOfDetail;
+#if (VTK_MAJOR_VERSION <= 5)
+  levelOfDetail->SetInput(fibers.GetPointer());
+#else
+  levelOfDetail->SetInputData(fibers.GetPointer());
+#endif
+  // 1 point out of 4: 0, 4, 8, 12, 16 and 20
+  // 1 point out of 3: 0, 3, 6, 9, 12, 15, 18 and the last point 20
+  const int strides[3] = {1, 4, 3};
+  const int expectedPointCounts[3] = {21, 6, 8};
+  for (int i = 0; i < 3; ++i)
+    {
+    levelOfDetail->SetPointStride(strides[i]);
+    levelOfDetail->Update();
+    vtkPolyData* output = levelOfDetail->GetOutput();
+    if (output->GetNumberOfLines() != 2 ||
+        output->GetNumberOfPoints() != fibers->GetNumberOfPoints() ||
+        output->GetLines()->GetNumberOfConnectivityEntries() !=
+          2 * (expectedPointCounts[i] + 1))
+      {
+      std::cerr << "Line " << __LINE__ << " - Wrong fibers with a stride of "
+                << strides[i] << ": " << output->GetNumberOfLines() << " lines, "
+                << output->GetLines()->GetNumberOfConnectivityEntries()
+                << " connectivity entries" << std::endl;
+      return false;
+      }
+    vtkIdType npts = 0;
+    vtkIdType* pts = 0;
+    output->GetLines()->InitTraversal();
+    output->GetLines()->GetNextCell(npts, pts);
+    if (pts[0] != 0 || pts[npts - 1] != 20 ||
+        (npts > 1 && pts[1] != strides[i]))
+      {
+      std::cerr << "Line " << __LINE__ << " - Wrong points kept with a stride of "
+                << strides[i] << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool testComputeLevelOfDetailPointStride(vtkMRMLFiberBundleTubeDisplayNode* displayNode)
+{
+  // The fibers are in [0,20]x[0,5]x[0,0]
+  const double insidePosition[3] = {10., 2., 0.};
+  const double nearPosition[3] = {10., 2., 90.};
+  const double farPosition[3] = {-300., 2., 0.};
+  const double fartherPosition[3] = {10., 2., 10000.};
+
+  displayNode->SetLevelOfDetailDistance(0.);
+  if (displayNode->ComputeLevelOfDetailPointStride(fartherPosition) != 1)
+    {
+    std::cerr << "Line " << __LINE__ << " - Level of detail not disabled" << std::endl;
+    return false;
+    }
+  displayNode->SetLevelOfDetailDistance(100.);
+  if (displayNode->ComputeLevelOfDetailPointStride(insidePosition) != 1 ||
+      displayNode->ComputeLevelOfDetailPointStride(nearPosition) != 1 ||
+      displayNode->ComputeLevelOfDetailPointStride(farPosition) != 4 ||
+      displayNode->ComputeLevelOfDetailPointStride(fartherPosition) != 8)
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong strides: "
+              << displayNode->ComputeLevelOfDetailPointStride(insidePosition) << " "
+              << displayNode->ComputeLevelOfDetailPointStride(nearPosition) << " "
+              << displayNode->ComputeLevelOfDetailPointStride(farPosition) << " "
+              << displayNode->ComputeLevelOfDetailPointStride(fartherPosition) << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool testTubeLevelOfDetail(vtkMRMLFiberBundleTubeDisplayNode* displayNode)
+{
+  displayNode->SetLevelOfDetailPointStride(1);
+  vtkIdType fullPointCount = updateOutput(displayNode)->GetNumberOfPoints();
+
+  // The stride is a runtime property that doesn't modify the node
+  unsigned long displayNodeMTime = displayNode->GetMTime();
+  displayNode->SetLevelOfDetailPointStride(4);
+  if (displayNode->GetLevelOfDetailPointStride() != 4 ||
+      displayNode->GetMTime() != displayNodeMTime)
+    {
+    std::cerr << "Line " << __LINE__ << " - SetLevelOfDetailPointStride failed"
+              << std::endl;
+    return false;
+    }
+  vtkPolyData* output = updateOutput(displayNode);
+  vtkIdType decimatedPointCount = output->GetNumberOfPoints();
+  if (fullPointCount == 0 || decimatedPointCount >= fullPointCount)
+    {
+    std::cerr << "Line " << __LINE__ << " - Tubes not decimated: "
+              << decimatedPointCount << " points instead of "
+              << fullPointCount << std::endl;
+    return false;
+    }
+
+  // Setting the same stride again, as every view does before rendering,
+  // doesn't update the pipeline
+  unsigned long outputMTime = output->GetMTime();
+  displayNode->SetLevelOfDetailPointStride(4);
+  output = updateOutput(displayNode);
+  if (output->GetMTime() != outputMTime)
+    {
+    std::cerr << "Line " << __LINE__ << " - Tubes updated for the same stride"
+              << std::endl;
+    return false;
+    }
+
+  displayNode->SetLevelOfDetailPointStride(1);
+  if (updateOutput(displayNode)->GetNumberOfPoints() != fullPointCount)
+    {
+    std::cerr << "Line " << __LINE__ << " - Tubes not restored" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool testCopy(vtkMRMLFiberBundleTubeDisplayNode* displayNode)
+{
+  displayNode->SetLevelOfDetailDistance(150.);
+  vtkNew<vtkMRMLFiberBundleTubeDisplayNode> copy;
+  copy->Copy(displayNode);
+  if (copy->GetLevelOfDetailDistance() != 150.)
+    {
+    std::cerr << "Line " << __LINE__ << " - LevelOfDetailDistance not copied"
+              << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int vtkMRMLFiberBundleLevelOfDetailTest1(int vtkNotUsed(argc), char * vtkNotUsed(argv)[])
+{
+  if (!testLevelOfDetailFilter())
+    {
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkPolyData> fibers;
+  createFibers(fibers.GetPointer());
+  vtkNew<vtkMRMLFiberBundleNode> fiberBundleNode;
+  scene->AddNode(fiberBundleNode.GetPointer());
+  vtkNew<vtkMRMLFiberBundleTubeDisplayNode> displayNode;
+  displayNode->SetColorMode(vtkMRMLFiberBundleDisplayNode::colorModeScalarData);
+  scene->AddNode(displayNode.GetPointer());
+  fiberBundleNode->AddAndObserveDisplayNodeID(displayNode->GetID());
+  fiberBundleNode->SetAndObservePolyData(fibers.GetPointer());
+
+  bool res = testComputeLevelOfDetailPointStride(displayNode.GetPointer());
+  res = testTubeLevelOfDetail(displayNode.GetPointer()) && res;
+  res = testCopy(displayNode.GetPointer()) && res;
+  return res ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -89,6 +89,8 @@ void qSlicerTractographyDisplayWidgetPrivate::init()
   QObject::connect( this->ColorByPointFiberOrientationRadioButton, SIGNAL(clicked()), q, SLOT(setColorByPointFiberOrientation()) );
 
   QObject::connect( this->OpacitySlider, SIGNAL(valueChanged(double)), q, SLOT(setOpacity(double)) );
+  QObject::connect( this->LevelOfDetailDistanceSpinBox, SIGNAL(valueChanged(double)),
+                    q, SLOT(setLevelOfDetailDistance(double)) );
 
   QObject::connect(this->MaterialPropertyWidget, SIGNAL(colorChanged(QColor)),
                    q, SLOT(setColor(QColor)));
@@ -521,6 +523,18 @@ void qSlicerTractographyDisplayWidget::setOpacity(double opacity)
   d->FiberBundleDisplayNode->SetOpacity(opacity);
 }
 
+//------------------------------------------------------------------------------
+void qSlicerTractographyDisplayWidget::setLevelOfDetailDistance(double distance)
+{
+  Q_D(qSlicerTractographyDisplayWidget);
+
+  if (!d->FiberBundleDisplayNode || this->m_updating)
+    {
+    return;
+    }
+  d->FiberBundleDisplayNode->SetLevelOfDetailDistance(distance);
+}
+
 //------------------------------------------------------------------------------
 QColor qSlicerTractographyDisplayWidget::color()const
 {
@@ -691,6 +705,13 @@ void qSlicerTractographyDisplayWidget::updateWidgetFromMRML()
 
   d->VisibilityCheckBox->setChecked( d->FiberBundleDisplayNode->GetVisibility() );
   d->OpacitySlider->setValue( d->FiberBundleDisplayNode->GetOpacity() );
+  // Lines don't generate geometry per point
+  const bool hasLevelOfDetail =
+    !vtkMRMLFiberBundleLineDisplayNode::SafeDownCast(d->FiberBundleDisplayNode);
+  d->LevelOfDetailDistanceLabel->setEnabled(hasLevelOfDetail);
+  d->LevelOfDetailDistanceSpinBox->setEnabled(hasLevelOfDetail);
+  d->LevelOfDetailDistanceSpinBox->setValue(
+    d->FiberBundleDisplayNode->GetLevelOfDetailDistance());
 
   d->ColorByScalarsColorTableComboBox->setCurrentNodeID
     (d->FiberBundleDisplayNode->GetColorNodeID());
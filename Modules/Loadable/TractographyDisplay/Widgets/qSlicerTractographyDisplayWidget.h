@@ -64,6 +64,7 @@ public slots:
   void onColorBySolidChanged(const QColor&);
   void setColorByCellScalarsColorTable(vtkMRMLNode*);
   void setOpacity(double);
+  void setLevelOfDetailDistance(double);
 
   void setAutoWindowLevel(bool);
   void setWindowLevel(double, double);
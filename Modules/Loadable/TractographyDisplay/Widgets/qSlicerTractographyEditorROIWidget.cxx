@@ -20,8 +20,11 @@
 
 // VTK includes
 #include "vtkPolyData.h"
+#include <vtkCleanPolyData.h>
 #include <vtkMatrix4x4.h>
+#include <vtkNew.h>
 #include <vtkSmartPointer.h>
+#include <vtkVersion.h>
 
 //------------------------------------------------------------------------------
 class qSlicerTractographyEditorROIWidgetPrivate:
@@ -35,6 +38,9 @@ protected:
 public:
   qSlicerTractographyEditorROIWidgetPrivate(qSlicerTractographyEditorROIWidget& object);
   void init();
+  /// Copy the fibers selected in FiberBundleNode without the points they
+  /// don't use.
+  void copySelectedFibers(vtkPolyData* polyData);
 
   vtkMRMLFiberBundleNode* FiberBundleNode;
   vtkMRMLAnnotationNode* AnnotationMRMLNodeForFiberSelection;
@@ -49,6 +55,24 @@ qSlicerTractographyEditorROIWidgetPrivate::qSlicerTractographyEditorROIWidgetPri
   this->AnnotationMRMLNodeForFiberSelection = NULL;
 }
 
+//------------------------------------------------------------------------------
+void qSlicerTractographyEditorROIWidgetPrivate::copySelectedFibers(vtkPolyData* polyData)
+{
+  // The ROI selection shares the points of the whole bundle
+  vtkNew<vtkCleanPolyData> cleanPolyData;
+  cleanPolyData->ConvertLinesToPointsOff();
+  cleanPolyData->ConvertPolysToLinesOff();
+  cleanPolyData->ConvertStripsToPolysOff();
+  cleanPolyData->PointMergingOff();
+#if (VTK_MAJOR_VERSION <= 5)
+  cleanPolyData->SetInput(this->FiberBundleNode->GetFilteredPolyData());
+#else
+  cleanPolyData->SetInputConnection(this->FiberBundleNode->GetFilteredPolyDataConnection());
+#endif
+  cleanPolyData->Update();
+  polyData->DeepCopy(cleanPolyData->GetOutput());
+}
+
 //------------------------------------------------------------------------------
 void qSlicerTractographyEditorROIWidgetPrivate::init()
 {
@@ -343,7 +367,7 @@ void qSlicerTractographyEditorROIWidget::createNewBundleFromSelection()
   {
     // Detach polydata from pipeline
     vtkPolyData *filteredPolyData = vtkPolyData::New();
-    filteredPolyData->DeepCopy(d->FiberBundleNode->GetFilteredPolyData());
+    d->copySelectedFibers(filteredPolyData);
     fiberBundleFromSelection->SetAndObservePolyData(filteredPolyData);
     filteredPolyData->Delete();
 
@@ -400,7 +424,7 @@ void qSlicerTractographyEditorROIWidget::updateBundleFromSelection()
       d->FiberBundleNode->GetScene()->SaveStateForUndo();
       // Detach polydata from pipeline
       vtkPolyData *filteredPolyData = vtkPolyData::New();
-      filteredPolyData->DeepCopy(d->FiberBundleNode->GetFilteredPolyData());
+      d->copySelectedFibers(filteredPolyData);
       d->FiberBundleNode->SetAndObservePolyData(filteredPolyData);
       filteredPolyData->Delete();
       d->FiberBundleNode->SetSubsamplingRatio(1);
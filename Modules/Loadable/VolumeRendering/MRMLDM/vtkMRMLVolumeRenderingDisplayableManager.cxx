@@ -84,6 +84,7 @@ int vtkMRMLVolumeRenderingDisplayableManager::DefaultGPUMemorySize = 256;
 vtkMRMLVolumeRenderingDisplayableManager::vtkMRMLVolumeRenderingDisplayableManager()
 {
   this->MapperRaycast = NULL;
+  this->MapperSlicerRaycast = NULL;
   this->MapperGPURaycast3 = NULL;
   this->Volume = NULL;
   //this->Histograms = vtkKWHistogramSet::New();
@@ -109,6 +110,11 @@ vtkMRMLVolumeRenderingDisplayableManager::vtkMRMLVolumeRenderingDisplayableManag
   // 0fps is a special value that means it hasn't been set.
   this->OriginalDesiredUpdateRate = 0.;
 
+  this->RenderCallbackCommand = vtkCallbackCommand::New();
+  this->RenderCallbackCommand->SetClientData(this);
+  this->RenderCallbackCommand->SetCallback(
+    vtkMRMLVolumeRenderingDisplayableManager::RenderCallback);
+
   this->RemoveInteractorStyleObservableEvent(vtkCommand::LeftButtonPressEvent);
   this->RemoveInteractorStyleObservableEvent(vtkCommand::LeftButtonReleaseEvent);
   this->RemoveInteractorStyleObservableEvent(vtkCommand::RightButtonPressEvent);
@@ -137,9 +143,15 @@ vtkMRMLVolumeRenderingDisplayableManager::~vtkMRMLVolumeRenderingDisplayableMana
     {
     this->DisplayObservedEvents->Delete();
     }
+  if (this->ObservedRenderer)
+    {
+    this->ObservedRenderer->RemoveObserver(this->RenderCallbackCommand);
+    }
+  this->RenderCallbackCommand->Delete();
 
   //delete instances
   vtkSetMRMLNodeMacro(this->MapperRaycast, NULL);
+  vtkSetMRMLNodeMacro(this->MapperSlicerRaycast, NULL);
   vtkSetMRMLNodeMacro(this->MapperGPURaycast3, NULL);
   vtkSetMRMLNodeMacro(this->Volume, NULL);
   /**
@@ -182,6 +194,8 @@ void vtkMRMLVolumeRenderingDisplayableManager::SetGUICallbackCommand(vtkCommand*
   //cpu ray casting
   this->MapperRaycast->AddObserver(vtkCommand::VolumeMapperComputeGradientsProgressEvent, callback);
   this->MapperRaycast->AddObserver(vtkCommand::ProgressEvent,callback);
+  this->MapperSlicerRaycast->AddObserver(vtkCommand::VolumeMapperComputeGradientsProgressEvent, callback);
+  this->MapperSlicerRaycast->AddObserver(vtkCommand::ProgressEvent,callback);
 
   //hook up the gpu mapper
 
@@ -207,6 +221,10 @@ void vtkMRMLVolumeRenderingDisplayableManager::Reset()
   vtkSetAndObserveMRMLNodeEventsMacro(this->MapperRaycast,
                                       newMapperRaycast.GetPointer(),
                                       mapperEventsWithProgress.GetPointer());
+  vtkNew<vtkSlicerFixedPointVolumeRayCastMapper> newMapperSlicerRaycast;
+  vtkSetAndObserveMRMLNodeEventsMacro(this->MapperSlicerRaycast,
+                                      newMapperSlicerRaycast.GetPointer(),
+                                      mapperEventsWithProgress.GetPointer());
 
   // GPU raycast 3
   vtkNew<vtkGPUVolumeRayCastMapper> newMapperGPURaycast3;
@@ -369,6 +387,24 @@ void vtkMRMLVolumeRenderingDisplayableManager
   transform->Delete();
 }
 
+//---------------------------------------------------------------------------
+namespace
+{
+// vtkFixedPointVolumeRayCastMapper and vtkSlicerFixedPointVolumeRayCastMapper
+// have the same sample distance settings but no common superclass for them.
+template <class TMapper>
+void UpdateCPURaycastMapperSampleDistances(TMapper* mapper, bool highDef,
+                                           double sampleDistance)
+{
+  // AutoAdjustSampleDistances is ignored while progressive refinement is on
+  mapper->SetAutoAdjustSampleDistances( highDef ? 0 : 1);
+  mapper->SetSampleDistance(sampleDistance);
+  mapper->SetInteractiveSampleDistance(sampleDistance);
+  // final image sample distance of the progressive refinement
+  mapper->SetImageSampleDistance(highDef ? 0.5 : 1.);
+}
+}
+
 //---------------------------------------------------------------------------
 double vtkMRMLVolumeRenderingDisplayableManager
 ::GetFramerate(vtkMRMLVolumeRenderingDisplayNode* vspNode)
@@ -415,16 +451,28 @@ void vtkMRMLVolumeRenderingDisplayableManager
 //---------------------------------------------------------------------------
 void vtkMRMLVolumeRenderingDisplayableManager
 ::UpdateCPURaycastMapper(
-  vtkFixedPointVolumeRayCastMapper* mapper,
+  vtkVolumeMapper* mapper,
   vtkMRMLCPURayCastVolumeRenderingDisplayNode* vspNode)
 {
   this->UpdateMapper(mapper, vspNode);
   const bool highDef = vspNode->GetPerformanceControl() ==
     vtkMRMLVolumeRenderingDisplayNode::MaximumQuality;
-  mapper->SetAutoAdjustSampleDistances( highDef ? 0 : 1);
-  mapper->SetSampleDistance(this->GetSampleDistance(vspNode));
-  mapper->SetInteractiveSampleDistance(this->GetSampleDistance(vspNode));
-  mapper->SetImageSampleDistance(highDef ? 0.5 : 1.);
+  const double sampleDistance = this->GetSampleDistance(vspNode);
+  vtkSlicerFixedPointVolumeRayCastMapper* slicerMapper =
+    vtkSlicerFixedPointVolumeRayCastMapper::SafeDownCast(mapper);
+  vtkFixedPointVolumeRayCastMapper* fixedPointMapper =
+    vtkFixedPointVolumeRayCastMapper::SafeDownCast(mapper);
+  if (slicerMapper)
+    {
+    // a coarse image first, refined when idle (see RequestRefinementRender()),
+    // unless the maximum quality is requested for every render
+    slicerMapper->SetProgressiveRefinement(highDef ? 0 : 1);
+    UpdateCPURaycastMapperSampleDistances(slicerMapper, highDef, sampleDistance);
+    }
+  else if (fixedPointMapper)
+    {
+    UpdateCPURaycastMapperSampleDistances(fixedPointMapper, highDef, sampleDistance);
+    }
 
   switch(vspNode->GetRaycastTechnique())
     {
@@ -432,11 +480,13 @@ void vtkMRMLVolumeRenderingDisplayableManager
       mapper->SetBlendMode(vtkVolumeMapper::MAXIMUM_INTENSITY_BLEND);
       break;
     case vtkMRMLVolumeRenderingDisplayNode::MinimumIntensityProjection:
+      // not supported by vtkSlicerFixedPointVolumeRayCastMapper
       mapper->SetBlendMode(vtkVolumeMapper::MINIMUM_INTENSITY_BLEND);
       break;
     case vtkMRMLVolumeRenderingDisplayNode::Composite:
     default:
       mapper->SetBlendMode(vtkVolumeMapper::COMPOSITE_BLEND);
+      break;
     }
 }
 
@@ -494,7 +544,8 @@ int vtkMRMLVolumeRenderingDisplayableManager
                            vspNode->GetVolumeNode())->GetImageData() );
 #endif
   int supported = 0;
-  if (volumeMapper->IsA("vtkFixedPointVolumeRayCastMapper"))
+  if (volumeMapper->IsA("vtkFixedPointVolumeRayCastMapper") ||
+      volumeMapper->IsA("vtkSlicerFixedPointVolumeRayCastMapper"))
     {
     supported = 1;
     }
@@ -517,7 +568,11 @@ vtkVolumeMapper* vtkMRMLVolumeRenderingDisplayableManager
     }
   if (vspNode->IsA("vtkMRMLCPURayCastVolumeRenderingDisplayNode"))
     {
-    return this->MapperRaycast;
+    // The Slicer mapper doesn't support the minimum intensity projection
+    return vspNode->GetRaycastTechnique() ==
+      vtkMRMLVolumeRenderingDisplayNode::MinimumIntensityProjection ?
+      static_cast<vtkVolumeMapper*>(this->MapperRaycast) :
+      static_cast<vtkVolumeMapper*>(this->MapperSlicerRaycast);
     }
   else if (vspNode->IsA("vtkMRMLGPURayCastVolumeRenderingDisplayNode"))
     {
@@ -608,7 +663,7 @@ bool vtkMRMLVolumeRenderingDisplayableManager::UpdateMapper(
   vtkVolumeMapper* volumeMapper = this->GetVolumeMapper(vspNode);
   if (vspNode->IsA("vtkMRMLCPURayCastVolumeRenderingDisplayNode"))
     {
-    this->UpdateCPURaycastMapper(vtkFixedPointVolumeRayCastMapper::SafeDownCast(volumeMapper),
+    this->UpdateCPURaycastMapper(volumeMapper,
                                  vtkMRMLCPURayCastVolumeRenderingDisplayNode::SafeDownCast(vspNode));
     }
   else if (vspNode->IsA("vtkMRMLGPURayCastVolumeRenderingDisplayNode"))
@@ -834,9 +889,42 @@ void vtkMRMLVolumeRenderingDisplayableManager::Create()
 //  this->ProcessingMRMLFlag = 0;
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLVolumeRenderingDisplayableManager::RenderCallback(
+  vtkObject *vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+  void *clientData, void *vtkNotUsed(callData))
+{
+  vtkMRMLVolumeRenderingDisplayableManager* self =
+    reinterpret_cast<vtkMRMLVolumeRenderingDisplayableManager*>(clientData);
+  self->RequestRefinementRender();
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLVolumeRenderingDisplayableManager::RequestRefinementRender()
+{
+  if (this->Volume->GetMapper() == this->MapperSlicerRaycast &&
+      this->Volume->GetVisibility() &&
+      this->MapperSlicerRaycast->GetRefinementPending())
+    {
+    // RequestRender() only schedules the render
+    this->RequestRender();
+    }
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLVolumeRenderingDisplayableManager::OnCreate()
 {
+  if (this->ObservedRenderer)
+    {
+    this->ObservedRenderer->RemoveObserver(this->RenderCallbackCommand);
+    }
+  this->ObservedRenderer = this->GetRenderer();
+  if (this->ObservedRenderer)
+    {
+    this->ObservedRenderer->AddObserver(vtkCommand::EndEvent,
+                                        this->RenderCallbackCommand);
+    }
+
   vtkMRMLViewNode* viewNode = this->GetMRMLViewNode();
   assert(viewNode);
   if (viewNode && !vtkIsObservedMRMLNodeEventMacro(
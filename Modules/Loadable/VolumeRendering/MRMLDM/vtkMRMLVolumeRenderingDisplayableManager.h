@@ -30,6 +30,7 @@ class vtkMRMLGPURayCastVolumeRenderingDisplayNode;
 class vtkMRMLVolumeNode;
 class vtkMRMLVolumeRenderingDisplayNode;
 class vtkMRMLVolumeRenderingScenarioNode;
+class vtkSlicerFixedPointVolumeRayCastMapper;
 class vtkSlicerVolumeRenderingLogic;
 class vtkVolumeProperty;
 
@@ -37,9 +38,12 @@ class vtkVolumeProperty;
 #include <vtkMRMLAbstractThreeDViewDisplayableManager.h>
 
 // VTK includes
+#include <vtkWeakPointer.h>
+class vtkCallbackCommand;
 class vtkIntArray;
 class vtkMatrix4x4;
 class vtkPlanes;
+class vtkRenderer;
 class vtkTimerLog;
 class vtkVolume;
 class vtkVolumeMapper;
@@ -95,7 +99,10 @@ public:
 
   void UpdateMapper(vtkVolumeMapper* mapper,
                     vtkMRMLVolumeRenderingDisplayNode* vspNode);
-  void UpdateCPURaycastMapper(vtkFixedPointVolumeRayCastMapper* mapper,
+  /// Update vtkFixedPointVolumeRayCastMapper or
+  /// vtkSlicerFixedPointVolumeRayCastMapper. Progressive refinement is
+  /// disabled for the maximum quality.
+  void UpdateCPURaycastMapper(vtkVolumeMapper* mapper,
                               vtkMRMLCPURayCastVolumeRenderingDisplayNode* vspNode);
   void UpdateGPURaycastMapper(vtkGPUVolumeRayCastMapper* mapper,
                               vtkMRMLGPURayCastVolumeRenderingDisplayNode* vspNode);
@@ -160,14 +167,29 @@ protected:
 
   void OnCreate();
 
+  /// Called after each render of the view
+  static void RenderCallback(vtkObject *caller, unsigned long eid,
+                             void *clientData, void *callData);
+
+  /// Request another render if the progressive refinement of the CPU
+  /// ray cast image is not finished. The render happens when the
+  /// application is idle, an interaction restarts from the coarse image.
+  void RequestRefinementRender();
+
   static bool First;
 
   vtkSlicerVolumeRenderingLogic *VolumeRenderingLogic;
 
   // Description:
-  // The software accelerated software mapper
+  // The software accelerated software mapper, only used for minimum
+  // intensity projection
   vtkFixedPointVolumeRayCastMapper *MapperRaycast;
 
+  // Description:
+  // The software mapper with space leaping and progressive refinement,
+  // used for composite and maximum intensity projection
+  vtkSlicerFixedPointVolumeRayCastMapper *MapperSlicerRaycast;
+
   // Description:
   // The gpu ray cast mapper.
   vtkGPUVolumeRayCastMapper *MapperGPURaycast3;
@@ -199,6 +221,9 @@ protected:
   int Interaction;
   double OriginalDesiredUpdateRate;
 
+  vtkWeakPointer<vtkRenderer> ObservedRenderer;
+  vtkCallbackCommand* RenderCallbackCommand;
+
 protected:
   void OnScenarioNodeModified();
   void OnVolumeRenderingDisplayNodeModified(vtkMRMLVolumeRenderingDisplayNode* dnode);
@@ -0,0 +1,244 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// VolumeRenderingReplacements includes
+#include <vtkSlicerFixedPointVolumeRayCastMapper.h>
+
+// VTK includes
+#include <vtkCamera.h>
+#include <vtkColorTransferFunction.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPiecewiseFunction.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkTimerLog.h>
+#include <vtkVersion.h>
+#include <vtkVolume.h>
+#include <vtkVolumeProperty.h>
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Empty volume with a few small spheres: most of the rays only go through
+// empty space, which the min max pyramid leaps over.
+void CreateSparseVolume(vtkImageData* imageData, int dimension)
+{
+  imageData->SetDimensions(dimension, dimension, dimension);
+#if (VTK_MAJOR_VERSION <= 5)
+  imageData->SetScalarTypeToUnsignedChar();
+  imageData->SetNumberOfScalarComponents(1);
+  imageData->AllocateScalars();
+#else
+  imageData->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+#endif
+  const double radius = dimension / 16.;
+  const double centers[3][3] = {
+    {dimension / 2., dimension / 2., dimension / 2.},
+    {dimension / 4., dimension / 4., dimension / 2.},
+    {3. * dimension / 4., dimension / 2., dimension / 4.}};
+  unsigned char* ptr = static_cast<unsigned char*>(imageData->GetScalarPointer());
+  for (int z = 0; z < dimension; ++z)
+    {
+    for (int y = 0; y < dimension; ++y)
+      {
+      for (int x = 0; x < dimension; ++x)
+        {
+        unsigned char value = 0;
+        for (int i = 0; i < 3; ++i)
+          {
+          const double dx = x - centers[i][0];
+          const double dy = y - centers[i][1];
+          const double dz = z - centers[i][2];
+          if (dx * dx + dy * dy + dz * dz < radius * radius)
+            {
+            value = 200;
+            }
+          }
+        *(ptr++) = value;
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Average time of a frame, -1 if nothing is rendered where the center
+// sphere is.
+double RenderFrames(vtkRenderWindow* renderWindow, int numberOfFrames)
+{
+  renderWindow->Render();
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  for (int i = 0; i < numberOfFrames; ++i)
+    {
+    renderWindow->Render();
+    }
+  timer->StopTimer();
+
+  int* size = renderWindow->GetSize();
+  unsigned char* center = renderWindow->GetPixelData(
+    size[0] / 2, size[1] / 2, size[0] / 2, size[1] / 2, 1);
+  unsigned char* corner = renderWindow->GetPixelData(0, 0, 0, 0, 1);
+  const bool rendered = center[0] != corner[0] ||
+                        center[1] != corner[1] ||
+                        center[2] != corner[2];
+  delete [] center;
+  delete [] corner;
+  return rendered ? timer->GetElapsedTime() / numberOfFrames : -1.;
+}
+
+//----------------------------------------------------------------------------
+// RGB values of the last rendered image
+void GetPixels(vtkRenderWindow* renderWindow, std::vector<unsigned char>& pixels)
+{
+  int* size = renderWindow->GetSize();
+  unsigned char* data = renderWindow->GetPixelData(
+    0, 0, size[0] - 1, size[1] - 1, 1);
+  pixels.assign(data, data + 3 * size[0] * size[1]);
+  delete [] data;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkSlicerFixedPointVolumeRayCastMapperTest1(int vtkNotUsed(argc),
+                                                char* vtkNotUsed(argv)[])
+{
+  const int dimension = 256;
+  const int numberOfFrames = 5;
+
+  vtkNew<vtkImageData> imageData;
+  CreateSparseVolume(imageData.GetPointer(), dimension);
+
+  vtkNew<vtkSlicerFixedPointVolumeRayCastMapper> mapper;
+#if (VTK_MAJOR_VERSION <= 5)
+  mapper->SetInput(imageData.GetPointer());
+#else
+  mapper->SetInputData(imageData.GetPointer());
+#endif
+  mapper->AutoAdjustSampleDistancesOff();
+  mapper->SetImageSampleDistance(1.);
+  mapper->SetSampleDistance(0.5);
+
+  vtkNew<vtkPiecewiseFunction> opacity;
+  opacity->AddPoint(0., 0.);
+  opacity->AddPoint(100., 0.);
+  opacity->AddPoint(200., 0.8);
+  vtkNew<vtkColorTransferFunction> color;
+  color->AddRGBPoint(0., 0., 0., 0.);
+  color->AddRGBPoint(200., 1., 1., 1.);
+  vtkNew<vtkVolumeProperty> property;
+  property->SetScalarOpacity(opacity.GetPointer());
+  property->SetColor(color.GetPointer());
+  property->SetInterpolationTypeToLinear();
+
+  vtkNew<vtkVolume> volume;
+  volume->SetMapper(mapper.GetPointer());
+  volume->SetProperty(property.GetPointer());
+
+  vtkNew<vtkRenderer> renderer;
+  renderer->AddVolume(volume.GetPointer());
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->SetSize(400, 400);
+  renderWindow->SetMultiSamples(0);
+  renderWindow->AddRenderer(renderer.GetPointer());
+  renderer->ResetCamera();
+
+  const char* names[4] = {"composite", "composite shaded", "MIP", "composite reclassified"};
+  for (int test = 0; test < 4; ++test)
+    {
+    switch (test)
+      {
+      case 1:
+        property->ShadeOn();
+        break;
+      case 2:
+        property->ShadeOff();
+        mapper->SetBlendModeToMaximumIntensity();
+        break;
+      case 3:
+        // Changing the transfer function only reclassifies the min max volume
+        mapper->SetBlendModeToComposite();
+        opacity->AddPoint(150., 0.2);
+        break;
+      default:
+        break;
+      }
+    mapper->SpaceLeapingOn();
+    const double frameTime = RenderFrames(renderWindow.GetPointer(), numberOfFrames);
+    if (frameTime < 0.)
+      {
+      std::cerr << "Line " << __LINE__ << " - Nothing rendered in "
+                << names[test] << " mode" << std::endl;
+      return EXIT_FAILURE;
+      }
+    std::vector<unsigned char> leapingPixels;
+    GetPixels(renderWindow.GetPointer(), leapingPixels);
+
+    // Leaping only skips samples that don't contribute: the image must be
+    // the same as when every sample is taken.
+    mapper->SpaceLeapingOff();
+    const double noLeapingFrameTime = RenderFrames(renderWindow.GetPointer(), numberOfFrames);
+    std::vector<unsigned char> pixels;
+    GetPixels(renderWindow.GetPointer(), pixels);
+    mapper->SpaceLeapingOn();
+    if (pixels.size() != leapingPixels.size())
+      {
+      std::cerr << "Line " << __LINE__ << " - Images of different sizes in "
+                << names[test] << " mode" << std::endl;
+      return EXIT_FAILURE;
+      }
+    for (size_t i = 0; i < pixels.size(); ++i)
+      {
+      if (pixels[i] != leapingPixels[i])
+        {
+        const int width = renderWindow->GetSize()[0];
+        std::cerr << "Line " << __LINE__ << " - Pixel (" << (i / 3) % width
+                  << ", " << (i / 3) / width << ") differs with space leaping in "
+                  << names[test] << " mode: " << static_cast<int>(leapingPixels[i])
+                  << " instead of " << static_cast<int>(pixels[i]) << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    std::cout << names[test] << ": " << frameTime << "s per frame with space leaping, "
+              << noLeapingFrameTime << "s without (" << dimension
+              << "^3 sparse volume)" << std::endl;
+    }
+
+  // Progressive refinement: coarse first, then refined over the next renders
+  // of the same view, and coarse again when the camera moves.
+  mapper->ProgressiveRefinementOn();
+  for (int move = 0; move < 2; ++move)
+    {
+    renderer->GetActiveCamera()->Azimuth(10.);
+    renderWindow->Render();
+    int refinements = 0;
+    while (mapper->GetRefinementPending() && refinements < 10)
+      {
+      renderWindow->Render();
+      ++refinements;
+      }
+    if (refinements != 2)
+      {
+      std::cerr << "Line " << __LINE__ << " - Progressive refinement took "
+                << refinements << " renders instead of 2" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -672,6 +672,7 @@
 
 #define VTKKWRCHelper_InitializeVariables()                                                     \
   int i, j;                                                                                     \
+  int tileRows[2];                                                                              \
   unsigned short *imagePtr;                                                                     \
                                                                                                 \
   int imageInUseSize[2];                                                                        \
@@ -805,10 +806,6 @@
   unsigned int dDHinc = dim[0]*dirOffset + dirOffset;
 
 #define VTKKWRCHelper_OuterInitialization()                             \
-    if ( j%threadCount != threadID )                                    \
-      {                                                                 \
-      continue;                                                         \
-      }                                                                 \
      if ( !threadID )                                                   \
       {                                                                 \
       if ( renWin->CheckAbortStatus() )                                 \
@@ -971,7 +968,8 @@
 
 #define VTKKWRCHelper_InitializationAndLoopStartNN()            \
   VTKKWRCHelper_InitializeVariables();                          \
-  for ( j = 0; j < imageInUseSize[1]; j++ )                     \
+  while ( mapper->GetNextImageTile( threadID, threadCount, tileRows ) ) \
+  for ( j = tileRows[0]; j < tileRows[1]; j++ )                 \
     {                                                           \
     VTKKWRCHelper_OuterInitialization();                        \
     for ( i = rowBounds[j*2]; i <= rowBounds[j*2+1]; i++ )      \
@@ -981,7 +979,8 @@
 #define VTKKWRCHelper_InitializationAndLoopStartGONN()          \
   VTKKWRCHelper_InitializeVariables();                          \
   VTKKWRCHelper_InitializeVariablesGO();                        \
-  for ( j = 0; j < imageInUseSize[1]; j++ )                     \
+  while ( mapper->GetNextImageTile( threadID, threadCount, tileRows ) ) \
+  for ( j = tileRows[0]; j < tileRows[1]; j++ )                 \
     {                                                           \
     VTKKWRCHelper_OuterInitialization();                        \
     for ( i = rowBounds[j*2]; i <= rowBounds[j*2+1]; i++ )      \
@@ -991,7 +990,8 @@
 #define VTKKWRCHelper_InitializationAndLoopStartShadeNN()       \
   VTKKWRCHelper_InitializeVariables();                          \
   VTKKWRCHelper_InitializeVariablesShade();                     \
-  for ( j = 0; j < imageInUseSize[1]; j++ )                     \
+  while ( mapper->GetNextImageTile( threadID, threadCount, tileRows ) ) \
+  for ( j = tileRows[0]; j < tileRows[1]; j++ )                 \
     {                                                           \
     VTKKWRCHelper_OuterInitialization();                        \
     for ( i = rowBounds[j*2]; i <= rowBounds[j*2+1]; i++ )      \
@@ -1002,7 +1002,8 @@
   VTKKWRCHelper_InitializeVariables();                          \
   VTKKWRCHelper_InitializeVariablesGO();                        \
   VTKKWRCHelper_InitializeVariablesShade();                     \
-  for ( j = 0; j < imageInUseSize[1]; j++ )                     \
+  while ( mapper->GetNextImageTile( threadID, threadCount, tileRows ) ) \
+  for ( j = tileRows[0]; j < tileRows[1]; j++ )                 \
     {                                                           \
     VTKKWRCHelper_OuterInitialization();                        \
     for ( i = rowBounds[j*2]; i <= rowBounds[j*2+1]; i++ )      \
@@ -1012,7 +1013,8 @@
 #define VTKKWRCHelper_InitializationAndLoopStartTrilin()        \
   VTKKWRCHelper_InitializeVariables();                          \
   VTKKWRCHelper_InitializeTrilinVariables();                    \
-  for ( j = 0; j < imageInUseSize[1]; j++ )                     \
+  while ( mapper->GetNextImageTile( threadID, threadCount, tileRows ) ) \
+  for ( j = tileRows[0]; j < tileRows[1]; j++ )                 \
     {                                                           \
     VTKKWRCHelper_OuterInitialization();                        \
     for ( i = rowBounds[j*2]; i <= rowBounds[j*2+1]; i++ )      \
@@ -1024,7 +1026,8 @@
   VTKKWRCHelper_InitializeVariablesGO();                        \
   VTKKWRCHelper_InitializeTrilinVariables();                    \
   VTKKWRCHelper_InitializeTrilinVariablesGO();                  \
-  for ( j = 0; j < imageInUseSize[1]; j++ )                     \
+  while ( mapper->GetNextImageTile( threadID, threadCount, tileRows ) ) \
+  for ( j = tileRows[0]; j < tileRows[1]; j++ )                 \
     {                                                           \
     VTKKWRCHelper_OuterInitialization();                        \
     for ( i = rowBounds[j*2]; i <= rowBounds[j*2+1]; i++ )      \
@@ -1036,7 +1039,8 @@
   VTKKWRCHelper_InitializeVariablesShade();                     \
   VTKKWRCHelper_InitializeTrilinVariables();                    \
   VTKKWRCHelper_InitializeTrilinVariablesShade();               \
-  for ( j = 0; j < imageInUseSize[1]; j++ )                     \
+  while ( mapper->GetNextImageTile( threadID, threadCount, tileRows ) ) \
+  for ( j = tileRows[0]; j < tileRows[1]; j++ )                 \
     {                                                           \
     VTKKWRCHelper_OuterInitialization();                        \
     for ( i = rowBounds[j*2]; i <= rowBounds[j*2+1]; i++ )      \
@@ -1050,7 +1054,8 @@
   VTKKWRCHelper_InitializeTrilinVariables();                    \
   VTKKWRCHelper_InitializeTrilinVariablesShade();               \
   VTKKWRCHelper_InitializeTrilinVariablesGO();                  \
-  for ( j = 0; j < imageInUseSize[1]; j++ )                     \
+  while ( mapper->GetNextImageTile( threadID, threadCount, tileRows ) ) \
+  for ( j = tileRows[0]; j < tileRows[1]; j++ )                 \
     {                                                           \
     VTKKWRCHelper_OuterInitialization();                        \
     for ( i = rowBounds[j*2]; i <= rowBounds[j*2+1]; i++ )      \
@@ -1101,6 +1106,19 @@
   int mmvalid[4] = {0,0,0,0};
 
 
+// Skip the samples that stay in the empty node of the min max pyramid
+// around pos, the loop moves to the first sample after the node.
+#define VTKKWRCHelper_SpaceLeap( LEAP )                         \
+  {                                                             \
+  unsigned int leap = LEAP;                                     \
+  if ( leap > numSteps - 1 - k )                                \
+    {                                                           \
+    leap = numSteps - 1 - k;                                    \
+    }                                                           \
+  mapper->FixedPointLeap( pos, dir, leap );                     \
+  k += leap;                                                    \
+  }
+
 #define VTKKWRCHelper_SpaceLeapCheck()                          \
   if ( pos[0] >> VTKKW_FPMM_SHIFT != mmpos[0] ||                \
        pos[1] >> VTKKW_FPMM_SHIFT != mmpos[1] ||                \
@@ -1114,6 +1132,8 @@
                                                                 \
   if ( !mmvalid )                                               \
     {                                                           \
+    VTKKWRCHelper_SpaceLeap(                                    \
+      mapper->ComputeSpaceLeap( pos, dir ) );                   \
     continue;                                                   \
     }
 
@@ -1131,6 +1151,8 @@
                                                                         \
   if ( !mmvalid )                                                       \
     {                                                                   \
+    VTKKWRCHelper_SpaceLeap(                                            \
+      mapper->ComputeMIPSpaceLeap( pos, dir, MAXIDX ) );                \
     continue;                                                           \
     }
 
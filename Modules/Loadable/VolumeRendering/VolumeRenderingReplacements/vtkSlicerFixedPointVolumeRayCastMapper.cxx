@@ -29,6 +29,7 @@ PURPOSE.  See the above copyright notice for more information.
 #include "vtkSlicerFixedPointVolumeRayCastMIPHelper.h"
 #include "vtkMath.h"
 #include "vtkMultiThreader.h"
+#include "vtkMutexLock.h"
 #include "vtkObjectFactory.h"
 #include "vtkPiecewiseFunction.h"
 #include "vtkPlaneCollection.h"
@@ -41,6 +42,9 @@ PURPOSE.  See the above copyright notice for more information.
 #include "vtkSlicerFixedPointRayCastImage.h"
 #include <vtkVersion.h>
 
+#include <algorithm>
+#include <string.h>
+
 
 vtkStandardNewMacro(vtkSlicerFixedPointVolumeRayCastMapper);
 vtkCxxSetObjectMacro(vtkSlicerFixedPointVolumeRayCastMapper, RayCastImage, vtkSlicerFixedPointRayCastImage);
@@ -412,6 +416,18 @@ vtkSlicerFixedPointVolumeRayCastMapper::vtkSlicerFixedPointVolumeRayCastMapper()
     this->OldSampleDistance          =  1.0;
     this->OldImageSampleDistance     =  1.0;
 
+    this->SpaceLeaping                  = 1;
+    this->ProgressiveRefinement         = 0;
+    this->RefinementImageSampleDistance = 1.0;
+    this->RefinementViewMTime           = 0;
+    this->RefinementViewSize[0]         = 0;
+    this->RefinementViewSize[1]         = 0;
+
+    this->ImageTileSize       = 4;
+    this->ImageTileRanges     = NULL;
+    this->ImageTileRangesSize = 0;
+    this->ImageTileLock       = vtkMutexLock::New();
+
     this->PerspectiveMatrix      = vtkMatrix4x4::New();
     this->ViewToWorldMatrix      = vtkMatrix4x4::New();
     this->ViewToVoxelsMatrix     = vtkMatrix4x4::New();
@@ -506,6 +522,16 @@ vtkSlicerFixedPointVolumeRayCastMapper::vtkSlicerFixedPointVolumeRayCastMapper()
     this->MinMaxVolumeSize[3] = 0;
     this->SavedMinMaxInput = NULL;
 
+    // Pyramid of empty nodes on top of the min max volume, built with the flags
+    for ( int level = 0; level < VTKKW_FPMM_LEVELS; level++ )
+    {
+        this->MinMaxPyramidFlags[level] = NULL;
+        this->MinMaxPyramidMax[level] = NULL;
+        this->MinMaxPyramidSize[level][0] = 0;
+        this->MinMaxPyramidSize[level][1] = 0;
+        this->MinMaxPyramidSize[level][2] = 0;
+    }
+
     this->Volume = NULL;
     //SLICERADD
     this->ManualInteractive=0;
@@ -571,6 +597,9 @@ vtkSlicerFixedPointVolumeRayCastMapper::~vtkSlicerFixedPointVolumeRayCastMapper(
     delete [] this->RowBounds;
     delete [] this->OldRowBounds;
 
+    delete [] this->ImageTileRanges;
+    this->ImageTileLock->Delete();
+
     int i;
     if ( this->GradientNormal )
     {
@@ -620,6 +649,11 @@ vtkSlicerFixedPointVolumeRayCastMapper::~vtkSlicerFixedPointVolumeRayCastMapper(
 
     // Delete storage used by min/max volume
     delete [] this->MinMaxVolume;
+    for ( int level = 0; level < VTKKW_FPMM_LEVELS; level++ )
+    {
+        delete [] this->MinMaxPyramidFlags[level];
+        delete [] this->MinMaxPyramidMax[level];
+    }
 }
 
 float vtkSlicerFixedPointVolumeRayCastMapper::ComputeRequiredImageSampleDistance( float desiredTime,
@@ -1004,6 +1038,21 @@ void vtkSlicerFixedPointVolumeRayCastMapper::UpdateMinMaxVolume( vtkVolume *vol
         minNonZeroGradientMagnitudeIndex[c] = i;
     }
 
+    // Number of scalar indices with non-zero opacity below each index, so
+    // that looking for non-zero opacity between the min and max scalar
+    // indices of a cell takes constant time when the transfer function changes
+    unsigned int **nonZeroScalarCount = new unsigned int *[this->MinMaxVolumeSize[3]];
+    for ( c = 0; c < this->MinMaxVolumeSize[3]; c++ )
+    {
+        nonZeroScalarCount[c] = new unsigned int [this->TableSize[c] + 1];
+        nonZeroScalarCount[c][0] = 0;
+        for ( i = 0; i < this->TableSize[c]; i++ )
+        {
+            nonZeroScalarCount[c][i+1] = nonZeroScalarCount[c][i] +
+                ( this->ScalarOpacityTable[c][i] ? 1 : 0 );
+        }
+    }
+
     unsigned short *tmpPtr = this->MinMaxVolume;
     int zero = 0;
     int nonZero = 0;
@@ -1049,15 +1098,11 @@ void vtkSlicerFixedPointVolumeRayCastMapper::UpdateMinMaxVolume( vtkVolume *vol
                     // threshold so we don't have information in this area
                     else
                     {
-                        int loop;
-                        for ( loop = tmpPtr[0]; loop <= tmpPtr[1]; loop++ )
-                        {
-                            if ( this->ScalarOpacityTable[c][loop] )
-                            {
-                                break;
-                            }
-                        }
-                        if ( loop <= tmpPtr[1] )
+                        int maxIndex = ( tmpPtr[1] < this->TableSize[c] ) ?
+                            ( tmpPtr[1] ) : ( this->TableSize[c] - 1 );
+                        if ( tmpPtr[0] <= maxIndex &&
+                            nonZeroScalarCount[c][maxIndex + 1] >
+                            nonZeroScalarCount[c][tmpPtr[0]] )
                         {
                             tmpPtr[2] &= 0xff00;
                             tmpPtr[2] |= 0x0001;
@@ -1075,10 +1120,87 @@ void vtkSlicerFixedPointVolumeRayCastMapper::UpdateMinMaxVolume( vtkVolume *vol
         }
     }
 
+    for ( c = 0; c < this->MinMaxVolumeSize[3]; c++ )
+    {
+        delete [] nonZeroScalarCount[c];
+    }
+    delete [] nonZeroScalarCount;
+    delete [] minNonZeroScalarIndex;
+    delete [] minNonZeroGradientMagnitudeIndex;
+
+    this->UpdateMinMaxPyramid();
+
     this->SavedMinMaxFlagTime.Modified();
 
 }
 
+void vtkSlicerFixedPointVolumeRayCastMapper::UpdateMinMaxPyramid()
+{
+    int level, i, j, k;
+
+    // Each level halves the size of the level below, the first level
+    // is built from the flags of the first component of the min max volume
+    int *previousSize = this->MinMaxVolumeSize;
+    for ( level = 0; level < VTKKW_FPMM_LEVELS; level++ )
+    {
+        int size[3];
+        for ( i = 0; i < 3; i++ )
+        {
+            size[i] = ( previousSize[i] + 1 ) / 2;
+        }
+        if ( !this->MinMaxPyramidFlags[level] ||
+            size[0] != this->MinMaxPyramidSize[level][0] ||
+            size[1] != this->MinMaxPyramidSize[level][1] ||
+            size[2] != this->MinMaxPyramidSize[level][2] )
+        {
+            delete [] this->MinMaxPyramidFlags[level];
+            delete [] this->MinMaxPyramidMax[level];
+            this->MinMaxPyramidFlags[level] = new unsigned char [size[0]*size[1]*size[2]];
+            this->MinMaxPyramidMax[level] = new unsigned short [size[0]*size[1]*size[2]];
+            this->MinMaxPyramidSize[level][0] = size[0];
+            this->MinMaxPyramidSize[level][1] = size[1];
+            this->MinMaxPyramidSize[level][2] = size[2];
+        }
+        memset( this->MinMaxPyramidFlags[level], 0, size[0]*size[1]*size[2]*sizeof(unsigned char) );
+        memset( this->MinMaxPyramidMax[level], 0, size[0]*size[1]*size[2]*sizeof(unsigned short) );
+
+        unsigned char *flags = this->MinMaxPyramidFlags[level];
+        unsigned short *maxs = this->MinMaxPyramidMax[level];
+        for ( k = 0; k < previousSize[2]; k++ )
+        {
+            for ( j = 0; j < previousSize[1]; j++ )
+            {
+                for ( i = 0; i < previousSize[0]; i++ )
+                {
+                    unsigned char flag;
+                    unsigned short max;
+                    if ( level == 0 )
+                    {
+                        unsigned short *cell = this->MinMaxVolume + 3 * this->MinMaxVolumeSize[3] *
+                            ( k*previousSize[0]*previousSize[1] + j*previousSize[0] + i );
+                        flag = static_cast<unsigned char>( cell[2]&0x00ff );
+                        max = cell[1];
+                    }
+                    else
+                    {
+                        int child = k*previousSize[0]*previousSize[1] + j*previousSize[0] + i;
+                        flag = this->MinMaxPyramidFlags[level-1][child];
+                        max = this->MinMaxPyramidMax[level-1][child];
+                    }
+                    if ( !flag )
+                    {
+                        continue;
+                    }
+                    int node = (k/2)*size[0]*size[1] + (j/2)*size[0] + (i/2);
+                    flags[node] = 1;
+                    maxs[node] = ( max > maxs[node] ) ? ( max ) : ( maxs[node] );
+                }
+            }
+        }
+        previousSize = this->MinMaxPyramidSize[level];
+    }
+}
+
 void vtkSlicerFixedPointVolumeRayCastMapper::UpdateCroppingRegions()
 {
     this->ConvertCroppingRegionPlanesToVoxels();
@@ -1128,7 +1250,12 @@ int vtkSlicerFixedPointVolumeRayCastMapper::PerImageInitialization( vtkRenderer
     // on the previous one and the previous render time. Don't let
     // the adjusted image sample distance be less than the minimum image sample
     // distance or more than the maximum image sample distance.
-    if ( this->AutoAdjustSampleDistances )
+    if ( this->ProgressiveRefinement )
+    {
+        this->ImageSampleDistance =
+            this->ComputeRefinementImageSampleDistance( ren, vol );
+    }
+    else if ( this->AutoAdjustSampleDistances )
     {
         //SLICERADD
         if(this->ManualInteractive==1)
@@ -1268,6 +1395,8 @@ void vtkSlicerFixedPointVolumeRayCastMapper::PerSubVolumeInitialization( vtkRend
 // This is the render method for the subvolume
 void vtkSlicerFixedPointVolumeRayCastMapper::RenderSubVolume()
 {
+    this->InitializeImageTiles();
+
     // Set the number of threads to use for ray casting,
     // then set the execution method and do it.
     this->Threader->SetSingleMethod( SlicerFixedPointVolumeRayCastMapper_CastRays,
@@ -1303,6 +1432,117 @@ void vtkSlicerFixedPointVolumeRayCastMapper::AbortRender()
     // Restore values
     this->ImageSampleDistance = this->OldImageSampleDistance;
     this->SampleDistance      = this->OldSampleDistance;
+
+    // The view is changing, start again from a coarse image
+    this->RefinementViewMTime = 0;
+}
+
+float vtkSlicerFixedPointVolumeRayCastMapper::ComputeRefinementImageSampleDistance( vtkRenderer *ren,
+                                                                                   vtkVolume *vol )
+{
+    unsigned long viewMTime = vol->GetMTime();
+    viewMTime = std::max( viewMTime, ren->GetActiveCamera()->GetMTime() );
+    viewMTime = std::max( viewMTime, this->GetMTime() );
+    viewMTime = std::max( viewMTime, this->GetInput()->GetMTime() );
+    int *size = ren->GetSize();
+
+    if ( viewMTime != this->RefinementViewMTime ||
+        size[0] != this->RefinementViewSize[0] ||
+        size[1] != this->RefinementViewSize[1] )
+    {
+        this->RefinementViewMTime = viewMTime;
+        this->RefinementViewSize[0] = size[0];
+        this->RefinementViewSize[1] = size[1];
+        this->RefinementImageSampleDistance = std::min(
+            4.0f * this->ImageSampleDistance, this->MaximumImageSampleDistance );
+    }
+    else
+    {
+        this->RefinementImageSampleDistance /= 2.0f;
+    }
+
+    if ( this->RefinementImageSampleDistance < this->ImageSampleDistance )
+    {
+        this->RefinementImageSampleDistance = this->ImageSampleDistance;
+    }
+    return this->RefinementImageSampleDistance;
+}
+
+int vtkSlicerFixedPointVolumeRayCastMapper::GetRefinementPending()
+{
+    return ( this->ProgressiveRefinement &&
+        this->RefinementViewMTime != 0 &&
+        this->RefinementImageSampleDistance > this->ImageSampleDistance );
+}
+
+void vtkSlicerFixedPointVolumeRayCastMapper::InitializeImageTiles()
+{
+    int threadCount = this->Threader->GetNumberOfThreads();
+    int imageInUseSize[2];
+    this->RayCastImage->GetImageInUseSize( imageInUseSize );
+    int tileCount = ( imageInUseSize[1] + this->ImageTileSize - 1 ) / this->ImageTileSize;
+
+    if ( this->ImageTileRangesSize < threadCount )
+    {
+        delete [] this->ImageTileRanges;
+        this->ImageTileRanges = new int [2*threadCount];
+        this->ImageTileRangesSize = threadCount;
+    }
+
+    // Each thread starts with a contiguous range of tiles
+    for ( int i = 0; i < threadCount; i++ )
+    {
+        this->ImageTileRanges[2*i]   = tileCount * i / threadCount;
+        this->ImageTileRanges[2*i+1] = tileCount * (i+1) / threadCount;
+    }
+}
+
+int vtkSlicerFixedPointVolumeRayCastMapper::GetNextImageTile( int threadID, int threadCount,
+                                                             int rows[2] )
+{
+    if ( this->RenderWindow->GetAbortRender() ||
+        threadID >= this->ImageTileRangesSize )
+    {
+        return 0;
+    }
+    threadCount = std::min( threadCount, this->ImageTileRangesSize );
+
+    this->ImageTileLock->Lock();
+    int tile = -1;
+    int *range = this->ImageTileRanges + 2*threadID;
+    if ( range[0] < range[1] )
+    {
+        tile = range[0]++;
+    }
+    else
+    {
+        // Steal the last tile of the thread that has the most tiles left
+        int victim = -1;
+        int victimTiles = 0;
+        for ( int i = 0; i < threadCount; i++ )
+        {
+            int tiles = this->ImageTileRanges[2*i+1] - this->ImageTileRanges[2*i];
+            if ( tiles > victimTiles )
+            {
+                victim = i;
+                victimTiles = tiles;
+            }
+        }
+        if ( victim >= 0 )
+        {
+            tile = --this->ImageTileRanges[2*victim+1];
+        }
+    }
+    this->ImageTileLock->Unlock();
+
+    if ( tile < 0 )
+    {
+        return 0;
+    }
+    rows[0] = tile * this->ImageTileSize;
+    rows[1] = std::min( rows[0] + this->ImageTileSize,
+        this->RayCastImage->GetImageInUseSize()[1] );
+    return 1;
 }
 
 // Capture the ZBuffer to use for intermixing with opaque geometry
@@ -1425,6 +1665,10 @@ void vtkSlicerFixedPointVolumeRayCastMapper::Render( vtkRenderer *ren, vtkVolume
         this->OldSampleDistance ) );
 
     this->SampleDistance = this->OldSampleDistance;
+    if ( this->ProgressiveRefinement )
+    {
+        this->ImageSampleDistance = this->OldImageSampleDistance;
+    }
 }
 
 VTK_THREAD_RETURN_TYPE SlicerFixedPointVolumeRayCastMapper_CastRays( void *arg )
@@ -3120,6 +3364,11 @@ void vtkSlicerFixedPointVolumeRayCastMapper::PrintSelf(ostream& os, vtkIndent in
         << this->MaximumImageSampleDistance << endl;
     os << indent << "Auto Adjust Sample Distances: "
         << this->AutoAdjustSampleDistances << endl;
+    os << indent << "Space Leaping: "
+        << (this->SpaceLeaping ? "On\n" : "Off\n");
+    os << indent << "Progressive Refinement: "
+        << (this->ProgressiveRefinement ? "On\n" : "Off\n");
+    os << indent << "Image Tile Size: " << this->ImageTileSize << endl;
     os << indent << "Intermix Intersecting Geometry: "
         << (this->IntermixIntersectingGeometry ? "On\n" : "Off\n");
 
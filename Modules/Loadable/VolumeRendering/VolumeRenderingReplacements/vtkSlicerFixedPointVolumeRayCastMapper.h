@@ -59,11 +59,13 @@
 
 #define VTKKW_FP_SHIFT       15
 #define VTKKW_FPMM_SHIFT     17
+#define VTKKW_FPMM_LEVELS    4
 #define VTKKW_FP_MASK        0x7fff
 #define VTKKW_FP_SCALE       32767.0
 
 class vtkMatrix4x4;
 class vtkMultiThreader;
+class vtkMutexLock;
 class vtkPlaneCollection;
 class vtkRenderer;
 class vtkTimerLog;
@@ -152,6 +154,42 @@ public:
   vtkGetMacro( AutoAdjustSampleDistances, int );
   vtkBooleanMacro( AutoAdjustSampleDistances, int );
 
+  // Description:
+  // If SpaceLeaping is on (default), rays skip the empty nodes of the min
+  // max pyramid in one step instead of sampling them. Turning it off
+  // samples every empty min max cell like the original mapper, which is
+  // only useful to compare the renders and their time.
+  vtkSetClampMacro( SpaceLeaping, int, 0, 1 );
+  vtkGetMacro( SpaceLeaping, int );
+  vtkBooleanMacro( SpaceLeaping, int );
+
+  // Description:
+  // If ProgressiveRefinement is on, the first render after the camera,
+  // the volume, its property or the input changed uses an image sample
+  // distance four times larger than ImageSampleDistance (at most
+  // MaximumImageSampleDistance). Each following render of the same view
+  // halves it until ImageSampleDistance is reached. A refinement render
+  // is aborted like any other render when the render window has pending
+  // events, and the next render starts coarse again.
+  // AutoAdjustSampleDistances is ignored while ProgressiveRefinement is on.
+  vtkSetClampMacro( ProgressiveRefinement, int, 0, 1 );
+  vtkGetMacro( ProgressiveRefinement, int );
+  vtkBooleanMacro( ProgressiveRefinement, int );
+
+  // Description:
+  // Return 1 if the last render was not rendered with the final image
+  // sample distance: the application should render again when idle to
+  // refine the image.
+  int GetRefinementPending();
+
+  // Description:
+  // Number of image rows in a tile. The threads render their own range
+  // of tiles, then take the last tiles of the threads that have the most
+  // tiles left, so that all the threads finish at the same time even when
+  // the volume covers only part of the image.
+  vtkSetClampMacro( ImageTileSize, int, 1, VTK_INT_MAX );
+  vtkGetMacro( ImageTileSize, int );
+
   // Description:
   // Set/Get the number of threads to use. This by default is equal to
   // the number of available processors detected.
@@ -187,12 +225,23 @@ public:
   unsigned int ToSlicerFixedPointDirection( float dir );
   void ToSlicerFixedPointDirection( float in[3], unsigned int out[3] );
   void FixedPointIncrement( unsigned int position[3], unsigned int increment[3] );
+  void FixedPointLeap( unsigned int position[3], unsigned int increment[3],
+                       unsigned int steps );
   void GetFloatTripleFromPointer( float v[3], float *ptr );
   void GetUIntTripleFromPointer( unsigned int v[3], unsigned int *ptr );
   void ShiftVectorDown( unsigned int in[3], unsigned int out[3] );
   int CheckMinMaxVolumeFlag( unsigned int pos[3], int c );
   int CheckMIPMinMaxVolumeFlag( unsigned int pos[3], int c, unsigned short maxIdx );
 
+  // Description:
+  // Number of steps along the direction that can be skipped from pos
+  // without leaving the largest empty node of the min max pyramid that
+  // contains pos. The min max volume cell containing pos must be empty.
+  // Return 0 if SpaceLeaping is off.
+  unsigned int ComputeSpaceLeap( unsigned int pos[3], unsigned int dir[3] );
+  unsigned int ComputeMIPSpaceLeap( unsigned int pos[3], unsigned int dir[3],
+                                    unsigned short maxIdx );
+
   void LookupColorUC( unsigned short *colorTable,
                       unsigned short *scalarOpacityTable,
                       unsigned short index,
@@ -224,6 +273,11 @@ public:
   vtkGetMacro( GradientOpacityRequired, int );
 
   int             *GetRowBounds()                 {return this->RowBounds;}
+
+  // Description:
+  // Rows [rows[0], rows[1]) of the next tile to render by the thread.
+  // Return 0 when all the tiles are rendered or the render is aborted.
+  int GetNextImageTile( int threadID, int threadCount, int rows[2] );
   unsigned short  *GetColorTable(int c)           {return this->ColorTable[c];}
   unsigned short  *GetScalarOpacityTable(int c)   {return this->ScalarOpacityTable[c];}
   unsigned short  *GetGradientOpacityTable(int c) {return this->GradientOpacityTable[c];}
@@ -286,6 +340,24 @@ protected:
   float                        OldSampleDistance;
   float                        OldImageSampleDistance;
 
+  int                          SpaceLeaping;
+
+  // Progressive refinement of the image sample distance
+  int                          ProgressiveRefinement;
+  float                        RefinementImageSampleDistance;
+  unsigned long                RefinementViewMTime;
+  int                          RefinementViewSize[2];
+
+  float ComputeRefinementImageSampleDistance( vtkRenderer *ren, vtkVolume *vol );
+
+  // Tiles of image rows left to render by each thread, [begin, end) pairs
+  int                          ImageTileSize;
+  int                         *ImageTileRanges;
+  int                          ImageTileRangesSize;
+  vtkMutexLock                *ImageTileLock;
+
+  void InitializeImageTiles();
+
   // Internal method for computing matrices needed during
   // ray casting
   void ComputeMatrices( double volumeOrigin[3],
@@ -439,6 +511,19 @@ protected:
   vtkTimeStamp    SavedMinMaxFlagTime;
 
   void            UpdateMinMaxVolume( vtkVolume *vol );
+
+  // Pyramid built on top of the min max volume flags of the first component.
+  // A node of level l groups 2^(l+1) x 2^(l+1) x 2^(l+1) cells of the min
+  // max volume, it is flagged if any of its cells is flagged and it keeps
+  // the maximum scalar index of its flagged cells (for MIP). Rays leap over
+  // whole empty nodes instead of stepping through the 4x4x4 cells.
+  unsigned char  *MinMaxPyramidFlags[VTKKW_FPMM_LEVELS];
+  unsigned short *MinMaxPyramidMax[VTKKW_FPMM_LEVELS];
+  int             MinMaxPyramidSize[VTKKW_FPMM_LEVELS][3];
+
+  void            UpdateMinMaxPyramid();
+  unsigned int    ComputeStepsInNode( unsigned int pos[3], unsigned int dir[3],
+                                      unsigned int shift );
   void            FillInMaxGradientMagnitudes( int fullDim[3],
                                                int smallDim[3] );
 
@@ -512,6 +597,24 @@ inline void vtkSlicerFixedPointVolumeRayCastMapper::FixedPointIncrement( unsigne
 }
 
 
+inline void vtkSlicerFixedPointVolumeRayCastMapper::FixedPointLeap( unsigned int position[3],
+                                                                   unsigned int increment[3],
+                                                                   unsigned int steps )
+{
+  // Same as calling FixedPointIncrement() steps times
+  for ( int i = 0; i < 3; i++ )
+    {
+    if ( increment[i]&0x80000000 )
+      {
+      position[i] += steps*(increment[i]&0x7fffffff);
+      }
+    else
+      {
+      position[i] -= steps*increment[i];
+      }
+    }
+}
+
 inline void vtkSlicerFixedPointVolumeRayCastMapper::GetFloatTripleFromPointer( float v[3], float *ptr )
 {
   v[0] = *(ptr);
@@ -564,6 +667,74 @@ inline int vtkSlicerFixedPointVolumeRayCastMapper::CheckMIPMinMaxVolumeFlag( uns
     }
 }
 
+inline unsigned int vtkSlicerFixedPointVolumeRayCastMapper::ComputeStepsInNode( unsigned int pos[3],
+                                                                               unsigned int dir[3],
+                                                                               unsigned int shift )
+{
+  unsigned int steps = 0xffffffff;
+  for ( int i = 0; i < 3; i++ )
+    {
+    unsigned int d = dir[i]&0x7fffffff;
+    if ( !d )
+      {
+      continue;
+      }
+    unsigned int nodeStart = (pos[i]>>shift)<<shift;
+    unsigned int axisSteps = ( dir[i]&0x80000000 ) ?
+      ( (nodeStart + ((1u<<shift) - 1) - pos[i]) / d ) :
+      ( (pos[i] - nodeStart) / d );
+    steps = ( axisSteps < steps ) ? (axisSteps) : (steps);
+    }
+  return steps;
+}
+
+inline unsigned int vtkSlicerFixedPointVolumeRayCastMapper::ComputeSpaceLeap( unsigned int pos[3],
+                                                                             unsigned int dir[3] )
+{
+  if ( !this->SpaceLeaping )
+    {
+    return 0;
+    }
+  int level;
+  for ( level = 0; level < VTKKW_FPMM_LEVELS && this->MinMaxPyramidFlags[level]; level++ )
+    {
+    unsigned int shift = VTKKW_FPMM_SHIFT + level + 1;
+    unsigned int offset =
+      (pos[2]>>shift)*this->MinMaxPyramidSize[level][0]*this->MinMaxPyramidSize[level][1] +
+      (pos[1]>>shift)*this->MinMaxPyramidSize[level][0] +
+      (pos[0]>>shift);
+    if ( this->MinMaxPyramidFlags[level][offset] )
+      {
+      break;
+      }
+    }
+  return this->ComputeStepsInNode( pos, dir, VTKKW_FPMM_SHIFT + level );
+}
+
+inline unsigned int vtkSlicerFixedPointVolumeRayCastMapper::ComputeMIPSpaceLeap( unsigned int pos[3],
+                                                                                unsigned int dir[3],
+                                                                                unsigned short maxIdx )
+{
+  if ( !this->SpaceLeaping )
+    {
+    return 0;
+    }
+  int level;
+  for ( level = 0; level < VTKKW_FPMM_LEVELS && this->MinMaxPyramidMax[level]; level++ )
+    {
+    unsigned int shift = VTKKW_FPMM_SHIFT + level + 1;
+    unsigned int offset =
+      (pos[2]>>shift)*this->MinMaxPyramidSize[level][0]*this->MinMaxPyramidSize[level][1] +
+      (pos[1]>>shift)*this->MinMaxPyramidSize[level][0] +
+      (pos[0]>>shift);
+    if ( this->MinMaxPyramidMax[level][offset] > maxIdx )
+      {
+      break;
+      }
+    }
+  return this->ComputeStepsInNode( pos, dir, VTKKW_FPMM_SHIFT + level );
+}
+
 inline void vtkSlicerFixedPointVolumeRayCastMapper::LookupColorUC( unsigned short *colorTable,
                                                      unsigned short *scalarOpacityTable,
                                                      unsigned short index,
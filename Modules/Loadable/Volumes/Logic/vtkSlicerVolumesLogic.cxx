@@ -637,17 +637,9 @@ vtkMRMLVolumeNode* vtkSlicerVolumesLogic::AddArchetypeVolume (
     }
   this->GetMRMLScene()->StartState(vtkMRMLScene::BatchProcessState);
 
-  bool labelMap = false;
-  if ( loadingOptions & 1 )    // labelMap is true
-    {
-    labelMap = true;
-    }
-
   this->GetMRMLScene()->SaveStateForUndo();
 
   vtkSmartPointer<vtkMRMLVolumeNode> volumeNode;
-  vtkSmartPointer<vtkMRMLVolumeDisplayNode> displayNode;
-  vtkSmartPointer<vtkMRMLStorageNode> storageNode;
 
   // Compute volume name
   std::string volumeName = volname != NULL ? volname : vtksys::SystemTools::GetFilenameName(filename);
@@ -677,10 +669,72 @@ vtkMRMLVolumeNode* vtkSlicerVolumesLogic::AddArchetypeVolume (
                                                   remoteIOLogic, dataIOManagerLogic);
 
   // Run through the factory list and test each factory until success
+  ArchetypeVolumeNodeSet nodeSet = this->ReadArchetypeVolumeNodeSet(
+    volumeRegistry, testScene.GetPointer(), filename, volumeName, loadingOptions,
+    fileList, errorSink.GetPointer(), this->GetMRMLNodesCallbackCommand());
+
+  // display any errors
+  if (nodeSet.Node == 0)
+    {
+    errorSink->DisplayErrors();
+    }
+
+  bool modified = false;
+  if (nodeSet.Node != NULL)
+    {
+    volumeNode = this->AddArchetypeVolumeNodeSet(nodeSet, filename);
+    modified = true;
+    }
+
+  // clean up the test scene
+  remoteIOLogic->RemoveDataIOFromScene();
+  if (testScene->GetCacheManager())
+    {
+    testScene->SetCacheManager(0);
+    }
+  if (testScene->GetDataIOManager())
+    {
+    testScene->SetDataIOManager(0);
+    }
+
+  this->GetMRMLScene()->EndState(vtkMRMLScene::BatchProcessState);
+  if (modified)
+    {
+    // since added the node to the test scene, let the scene know now that it
+    // has a new node
+    this->GetMRMLScene()->InvokeEvent(vtkMRMLScene::NodeAddedEvent, volumeNode);
+
+    this->Modified();
+    }
+  return volumeNode;
+}
+
+//----------------------------------------------------------------------------
+ArchetypeVolumeNodeSet vtkSlicerVolumesLogic::ReadArchetypeVolume(
+    vtkMRMLScene* scene, const char* filename, const char* volname,
+    int loadingOptions, vtkCommand* errorObserver)
+{
+  std::string volumeName = volname != NULL ? volname : vtksys::SystemTools::GetFilenameName(filename);
+  return this->ReadArchetypeVolumeNodeSet(this->VolumeRegistry, scene, filename, volumeName,
+                                          loadingOptions, NULL, errorObserver, NULL);
+}
+
+//----------------------------------------------------------------------------
+ArchetypeVolumeNodeSet vtkSlicerVolumesLogic::ReadArchetypeVolumeNodeSet(
+    const NodeSetFactoryRegistry& volumeRegistry, vtkMRMLScene* scene,
+    const char* filename, std::string& volumeName, int loadingOptions,
+    vtkStringArray *fileList, vtkCommand* errorObserver, vtkCommand* progressObserver)
+{
+  bool labelMap = false;
+  if ( loadingOptions & 1 )    // labelMap is true
+    {
+    labelMap = true;
+    }
+
   for (NodeSetFactoryRegistry::const_iterator fit = volumeRegistry.begin();
        fit != volumeRegistry.end(); ++fit)
     {
-    ArchetypeVolumeNodeSet nodeSet( (*fit)(volumeName, testScene.GetPointer(), loadingOptions) );
+    ArchetypeVolumeNodeSet nodeSet( (*fit)(volumeName, scene, loadingOptions) );
 
     // if the labelMap flags for reader and factory are consistent
     // (both true or both false)
@@ -688,10 +742,21 @@ vtkMRMLVolumeNode* vtkSlicerVolumesLogic::AddArchetypeVolume (
       {
 
       // connect the observers
-      nodeSet.StorageNode->AddObserver(vtkCommand::ErrorEvent, errorSink.GetPointer());
-      nodeSet.StorageNode->AddObserver(vtkCommand::ProgressEvent,  this->GetMRMLNodesCallbackCommand());
-
-      this->InitializeStorageNode(nodeSet.StorageNode, filename, fileList, testScene.GetPointer());
+      if (errorObserver)
+        {
+        nodeSet.StorageNode->AddObserver(vtkCommand::ErrorEvent, errorObserver);
+        }
+      if (progressObserver)
+        {
+        nodeSet.StorageNode->AddObserver(vtkCommand::ProgressEvent, progressObserver);
+        this->InitializeStorageNode(nodeSet.StorageNode, filename, fileList, scene);
+        }
+      else
+        {
+        // Local file, possibly read from another thread than the one of the
+        // logic: the progress is not forwarded to the logic observers
+        nodeSet.StorageNode->SetFileName(filename);
+        }
 
       vtkDebugMacro("Attempt to read file as a volume of type "
                     << nodeSet.Node->GetNodeTagName() << " using "
@@ -699,17 +764,20 @@ vtkMRMLVolumeNode* vtkSlicerVolumesLogic::AddArchetypeVolume (
       bool success = nodeSet.StorageNode->ReadData(nodeSet.Node);
 
       // disconnect the observers
-      nodeSet.StorageNode->RemoveObservers(vtkCommand::ErrorEvent, errorSink.GetPointer());
-      nodeSet.StorageNode->RemoveObservers(vtkCommand::ProgressEvent,  this->GetMRMLNodesCallbackCommand());
+      if (errorObserver)
+        {
+        nodeSet.StorageNode->RemoveObservers(vtkCommand::ErrorEvent, errorObserver);
+        }
+      if (progressObserver)
+        {
+        nodeSet.StorageNode->RemoveObservers(vtkCommand::ProgressEvent, progressObserver);
+        }
 
       if (success)
         {
-        displayNode = nodeSet.DisplayNode;
-        volumeNode =  nodeSet.Node;
-        storageNode = nodeSet.StorageNode;
         vtkDebugMacro(<< "File successfully read as " << nodeSet.Node->GetNodeTagName()
                       << " [filename = " << filename << "]");
-        break;
+        return nodeSet;
         }
       }
 
@@ -720,64 +788,47 @@ vtkMRMLVolumeNode* vtkSlicerVolumesLogic::AddArchetypeVolume (
     // clean up the scene
     nodeSet.Node->SetAndObserveDisplayNodeID(NULL);
     nodeSet.Node->SetAndObserveStorageNodeID(NULL);
-    testScene->RemoveNode(nodeSet.DisplayNode);
-    testScene->RemoveNode(nodeSet.StorageNode);
-    testScene->RemoveNode(nodeSet.Node);
+    scene->RemoveNode(nodeSet.DisplayNode);
+    scene->RemoveNode(nodeSet.StorageNode);
+    scene->RemoveNode(nodeSet.Node);
     }
+  return ArchetypeVolumeNodeSet(scene);
+}
 
-  // display any errors
-  if (volumeNode == 0)
+//----------------------------------------------------------------------------
+vtkMRMLVolumeNode* vtkSlicerVolumesLogic::AddArchetypeVolumeNodeSet(
+    ArchetypeVolumeNodeSet& nodeSet, const char* filename)
+{
+  if (this->GetMRMLScene() == 0 || nodeSet.Node == 0)
     {
-    errorSink->DisplayErrors();
+    return 0;
     }
+  vtkMRMLVolumeNode* volumeNode = nodeSet.Node;
+  vtkMRMLVolumeDisplayNode* displayNode = nodeSet.DisplayNode;
+  vtkMRMLStorageNode* storageNode = nodeSet.StorageNode;
 
-
-  bool modified = false;
-  if (volumeNode != NULL)
+  // move the nodes from the test scene to the main one, removing from the
+  // test scene first to avoid missing ID/reference errors and to fix a
+  // problem found in testing an extension where the RAS to IJK matrix
+  /// was reset to identity.
+  if (nodeSet.Scene)
     {
-    // move the nodes from the test scene to the main one, removing from the
-    // test scene first to avoid missing ID/reference errors and to fix a
-    // problem found in testing an extension where the RAS to IJK matrix
-    /// was reset to identity.
-    testScene->RemoveNode(displayNode);
-    testScene->RemoveNode(storageNode);
-    testScene->RemoveNode(volumeNode);
-    this->GetMRMLScene()->AddNode(displayNode);
-    this->GetMRMLScene()->AddNode(storageNode);
-    this->GetMRMLScene()->AddNode(volumeNode);
-    volumeNode->SetAndObserveDisplayNodeID(displayNode->GetID());
-    volumeNode->SetAndObserveStorageNodeID(storageNode->GetID());
-
-    this->SetAndObserveColorToDisplayNode(displayNode, labelMap, filename);
-
-    vtkDebugMacro("Name vol node "<<volumeNode->GetClassName());
-    vtkDebugMacro("Display node "<<displayNode->GetClassName());
-
-    this->SetActiveVolumeNode(volumeNode);
-
-    modified = true;
+    nodeSet.Scene->RemoveNode(displayNode);
+    nodeSet.Scene->RemoveNode(storageNode);
+    nodeSet.Scene->RemoveNode(volumeNode);
     }
+  this->GetMRMLScene()->AddNode(displayNode);
+  this->GetMRMLScene()->AddNode(storageNode);
+  this->GetMRMLScene()->AddNode(volumeNode);
+  volumeNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+  volumeNode->SetAndObserveStorageNodeID(storageNode->GetID());
 
-  // clean up the test scene
-  remoteIOLogic->RemoveDataIOFromScene();
-  if (testScene->GetCacheManager())
-    {
-    testScene->SetCacheManager(0);
-    }
-  if (testScene->GetDataIOManager())
-    {
-    testScene->SetDataIOManager(0);
-    }
+  this->SetAndObserveColorToDisplayNode(displayNode, nodeSet.LabelMap, filename);
 
-  this->GetMRMLScene()->EndState(vtkMRMLScene::BatchProcessState);
-  if (modified)
-    {
-    // since added the node to the test scene, let the scene know now that it
-    // has a new node
-    this->GetMRMLScene()->InvokeEvent(vtkMRMLScene::NodeAddedEvent, volumeNode);
+  vtkDebugMacro("Name vol node "<<volumeNode->GetClassName());
+  vtkDebugMacro("Display node "<<displayNode->GetClassName());
 
-    this->Modified();
-    }
+  this->SetActiveVolumeNode(volumeNode);
   return volumeNode;
 }
 
@@ -35,6 +35,7 @@
 
 #include "vtkSlicerVolumesModuleLogicExport.h"
 
+class vtkCommand;
 class vtkMRMLLabelMapVolumeNode;
 class vtkMRMLScalarVolumeNode;
 class vtkMRMLScalarVolumeDisplayNode;
@@ -90,6 +91,11 @@ public:
   /// freesurfer volume formats. Used to assign the proper colour node to label maps.
   int IsFreeSurferVolume(const char* filename);
 
+  /// Observe the default color node of scalar volumes or label maps
+  /// (FreeSurfer label maps have their own colors).
+  void SetAndObserveColorToDisplayNode(vtkMRMLDisplayNode* displayNode,
+                                       int labelmap, const char* filename);
+
   /// The currently active mrml volume node
   void SetActiveVolumeNode(vtkMRMLVolumeNode *ActiveVolumeNode);
   vtkMRMLVolumeNode* GetActiveVolumeNode()const;
@@ -137,6 +143,27 @@ public:
   /// \sa AddArchetypeVolume(const NodeSetFactoryRegistry& volumeRegistry, const char* filename, const char* volname, int loadingOptions, vtkStringArray *fileList)
   vtkMRMLScalarVolumeNode* AddArchetypeScalarVolume(const char* filename, const char* volname, int loadingOptions, vtkStringArray *fileList);
 
+  /// Read a local file with the registered factories as AddArchetypeVolume()
+  /// does, but into nodes created in \a scene instead of the scene of the
+  /// logic. Neither the scene of the logic nor its observers are accessed:
+  /// it can be called from a worker thread with a scene only used by that
+  /// thread. The nodes are then moved into the scene of the logic with
+  /// AddArchetypeVolumeNodeSet().
+  /// The node set has no node if no factory could read the file. Errors are
+  /// sent to \a errorObserver if any.
+  ArchetypeVolumeNodeSet ReadArchetypeVolume(vtkMRMLScene* scene,
+                                             const char* filename,
+                                             const char* volname,
+                                             int loadingOptions,
+                                             vtkCommand* errorObserver = 0);
+
+  /// Move the nodes of a node set read by ReadArchetypeVolume() into the
+  /// scene of the logic, observe the default color node and make the volume
+  /// the active volume.
+  /// \sa ReadArchetypeVolume()
+  vtkMRMLVolumeNode* AddArchetypeVolumeNodeSet(ArchetypeVolumeNodeSet& nodeSet,
+                                               const char* filename);
+
   /// Write volume's image data to a specified file
   int SaveArchetypeVolume (const char* filename, vtkMRMLVolumeNode *volumeNode);
 
@@ -271,9 +298,6 @@ protected:
                              vtkStringArray *fileList,
                              vtkMRMLScene * mrmlScene = NULL);
 
-  void SetAndObserveColorToDisplayNode(vtkMRMLDisplayNode* displayNode,
-                                       int labelmap, const char* filename);
-
   typedef std::list<ArchetypeVolumeNodeSetFactory> NodeSetFactoryRegistry;
 
   /// Convenience function allowing to try to load a volume using a given
@@ -283,6 +307,15 @@ protected:
       const char* filename, const char* volname, int loadingOptions,
       vtkStringArray *fileList);
 
+  /// Test the factories of \a volumeRegistry in order until one of them
+  /// reads \a filename into nodes created in \a scene. The node set has no
+  /// node if none succeeded.
+  ArchetypeVolumeNodeSet ReadArchetypeVolumeNodeSet(
+      const NodeSetFactoryRegistry& volumeRegistry, vtkMRMLScene* scene,
+      const char* filename, std::string& volumeName, int loadingOptions,
+      vtkStringArray *fileList, vtkCommand* errorObserver,
+      vtkCommand* progressObserver);
+
   vtkSmartPointer<vtkMRMLVolumeNode> ActiveVolumeNode;
   vtkSmartPointer<vtkMRMLColorLogic> ColorLogic;
 
@@ -0,0 +1,241 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QStringList>
+
+// SlicerQt includes
+#include <qSlicerCoreApplication.h>
+#include <qSlicerCoreIOManager.h>
+
+// Volumes includes
+#include "qSlicerVolumesReader.h"
+#include "vtkSlicerVolumesLogic.h"
+
+// Slicer includes
+#include <vtkSlicerApplicationLogic.h>
+
+// MRML includes
+#include <vtkMRMLScene.h>
+#include <vtkMRMLStorageNode.h>
+#include <vtkMRMLVolumeDisplayNode.h>
+#include <vtkMRMLVolumeNode.h>
+
+// VTK includes
+#include <vtkCollection.h>
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+// ITK includes
+#include <itkConfigure.h>
+#include <itkFactoryRegistration.h>
+
+// STD includes
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+bool compareImageData(vtkImageData* image, vtkImageData* expected)
+{
+  if (!image || !expected)
+    {
+    return image == expected;
+    }
+  int dims[3];
+  int expectedDims[3];
+  image->GetDimensions(dims);
+  expected->GetDimensions(expectedDims);
+  if (dims[0] != expectedDims[0] ||
+      dims[1] != expectedDims[1] ||
+      dims[2] != expectedDims[2])
+    {
+    return false;
+    }
+  vtkDataArray* scalars = image->GetPointData()->GetScalars();
+  vtkDataArray* expectedScalars = expected->GetPointData()->GetScalars();
+  if (!scalars || !expectedScalars)
+    {
+    return scalars == expectedScalars;
+    }
+  if (scalars->GetDataType() != expectedScalars->GetDataType() ||
+      scalars->GetNumberOfComponents() != expectedScalars->GetNumberOfComponents() ||
+      scalars->GetNumberOfTuples() != expectedScalars->GetNumberOfTuples())
+    {
+    return false;
+    }
+  size_t size = static_cast<size_t>(scalars->GetDataTypeSize()) *
+    scalars->GetNumberOfComponents() * scalars->GetNumberOfTuples();
+  return memcmp(scalars->GetVoidPointer(0),
+                expectedScalars->GetVoidPointer(0), size) == 0;
+}
+
+//-----------------------------------------------------------------------------
+bool compareVolumes(vtkMRMLVolumeNode* volume, vtkMRMLVolumeNode* expected)
+{
+  if (!volume || !expected ||
+      strcmp(volume->GetClassName(), expected->GetClassName()) != 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Volumes of different types: "
+              << (volume ? volume->GetClassName() : "null") << " and "
+              << (expected ? expected->GetClassName() : "null") << std::endl;
+    return false;
+    }
+  vtkNew<vtkMatrix4x4> ijkToRAS;
+  vtkNew<vtkMatrix4x4> expectedIJKToRAS;
+  volume->GetIJKToRASMatrix(ijkToRAS.GetPointer());
+  expected->GetIJKToRASMatrix(expectedIJKToRAS.GetPointer());
+  for (int i = 0; i < 4; ++i)
+    {
+    for (int j = 0; j < 4; ++j)
+      {
+      if (ijkToRAS->GetElement(i, j) != expectedIJKToRAS->GetElement(i, j))
+        {
+        std::cerr << "Line " << __LINE__ << " - Volumes " << volume->GetID()
+                  << " and " << expected->GetID()
+                  << " have different IJKToRAS matrices" << std::endl;
+        return false;
+        }
+      }
+    }
+  if (!compareImageData(volume->GetImageData(), expected->GetImageData()))
+    {
+    std::cerr << "Line " << __LINE__ << " - Volumes " << volume->GetID()
+              << " and " << expected->GetID()
+              << " have different image data" << std::endl;
+    return false;
+    }
+  vtkMRMLVolumeDisplayNode* displayNode = volume->GetVolumeDisplayNode();
+  vtkMRMLVolumeDisplayNode* expectedDisplayNode = expected->GetVolumeDisplayNode();
+  if (!displayNode || !expectedDisplayNode ||
+      strcmp(displayNode->GetClassName(), expectedDisplayNode->GetClassName()) != 0 ||
+      !displayNode->GetColorNodeID() || !expectedDisplayNode->GetColorNodeID() ||
+      strcmp(displayNode->GetColorNodeID(), expectedDisplayNode->GetColorNodeID()) != 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Volumes " << volume->GetID()
+              << " and " << expected->GetID()
+              << " have different display nodes" << std::endl;
+    return false;
+    }
+  if (!volume->GetStorageNode() || !expected->GetStorageNode() ||
+      strcmp(volume->GetStorageNode()->GetClassName(),
+             expected->GetStorageNode()->GetClassName()) != 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Volumes " << volume->GetID()
+              << " and " << expected->GetID()
+              << " have different storage nodes" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int qSlicerVolumesReaderConcurrentLoadingTest( int argc, char * argv[] )
+{
+  itk::itkFactoryRegistration();
+
+  qSlicerCoreApplication app(argc, argv);
+
+  if (argc < 3)
+    {
+    std::cerr << "Usage: qSlicerVolumesReaderConcurrentLoadingTest"
+              << " volumeName [volumeName...] labelMapName" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkMRMLScene* scene = app.mrmlScene();
+  vtkNew<vtkSlicerVolumesLogic> logic;
+  logic->SetMRMLApplicationLogic(app.applicationLogic());
+  logic->SetMRMLScene(scene);
+
+  qSlicerCoreIOManager manager;
+  qSlicerVolumesReader* reader = new qSlicerVolumesReader(logic.GetPointer());
+  manager.registerIO(reader);
+
+  // The last file is loaded as a label map
+  QList<qSlicerIO::IOProperties> files;
+  for (int i = 1; i < argc; ++i)
+    {
+    qSlicerIO::IOProperties properties;
+    properties["fileName"] = QString(argv[i]);
+    properties["fileType"] = QString("VolumeFile");
+    properties["labelmap"] = (i == argc - 1);
+    files << properties;
+    }
+
+  // Local files are read concurrently
+  reader->setMRMLScene(scene);
+  foreach(const qSlicerIO::IOProperties& properties, files)
+    {
+    vtkMRMLStorableNode* node = 0;
+    vtkMRMLStorageNode* storageNode = 0;
+    if (!reader->prepareLoad(properties, node, storageNode))
+      {
+      std::cerr << "Line " << __LINE__ << " - "
+                << qPrintable(properties["fileName"].toString())
+                << " can't be read concurrently" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  vtkNew<vtkCollection> loadedVolumes;
+  manager.setConcurrentLoading(false);
+  if (!manager.loadNodes(files, loadedVolumes.GetPointer()) ||
+      loadedVolumes->GetNumberOfItems() != files.count())
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to load the volumes: "
+              << loadedVolumes->GetNumberOfItems() << " volumes loaded" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkCollection> concurrentlyLoadedVolumes;
+  manager.setConcurrentLoading(true);
+  if (!manager.concurrentLoading() ||
+      !manager.loadNodes(files, concurrentlyLoadedVolumes.GetPointer()) ||
+      concurrentlyLoadedVolumes->GetNumberOfItems() != files.count())
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to load the volumes concurrently: "
+              << concurrentlyLoadedVolumes->GetNumberOfItems() << " volumes loaded"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The volumes are added in the order of the files, with the same content
+  for (int i = 0; i < files.count(); ++i)
+    {
+    vtkMRMLVolumeNode* volume = vtkMRMLVolumeNode::SafeDownCast(
+      concurrentlyLoadedVolumes->GetItemAsObject(i));
+    vtkMRMLVolumeNode* expectedVolume = vtkMRMLVolumeNode::SafeDownCast(
+      loadedVolumes->GetItemAsObject(i));
+    if (!compareVolumes(volume, expectedVolume))
+      {
+      std::cerr << "Line " << __LINE__ << " - "
+                << qPrintable(files[i]["fileName"].toString())
+                << " is loaded differently when read concurrently" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -20,6 +20,8 @@
 
 // Qt includes
 #include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
 
 // SlicerQt includes
 #include "qSlicerVolumesIOOptionsWidget.h"
@@ -30,21 +32,85 @@
 #include "vtkSlicerVolumesLogic.h"
 
 // MRML includes
+#include <vtkCacheManager.h>
 #include <vtkMRMLLabelMapVolumeNode.h>
-#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
 #include <vtkMRMLSelectionNode.h>
 
 // VTK includes
 #include <vtkSmartPointer.h>
 #include <vtkStringArray.h>
 
+// STD includes
+#include <map>
+
 //-----------------------------------------------------------------------------
 class qSlicerVolumesReaderPrivate
 {
   public:
+  static int loadingOptions(const qSlicerIO::IOProperties& properties);
+  void propagateVolumeSelection(vtkMRMLVolumeNode* node);
+
   vtkSmartPointer<vtkSlicerVolumesLogic> Logic;
+
+  /// Node sets read by readData(), until finishLoad() adds them into the
+  /// scene. Indexed by volume node.
+  typedef std::map<vtkMRMLStorableNode*, ArchetypeVolumeNodeSet> NodeSetMap;
+  NodeSetMap ReadNodeSets;
+  QMutex ReadNodeSetsMutex;
 };
 
+//-----------------------------------------------------------------------------
+int qSlicerVolumesReaderPrivate::loadingOptions(const qSlicerIO::IOProperties& properties)
+{
+  int options = 0;
+  if (properties.contains("labelmap"))
+    {
+    options |= properties["labelmap"].toBool() ? 0x1 : 0x0;
+    }
+  if (properties.contains("center"))
+    {
+    options |= properties["center"].toBool() ? 0x2 : 0x0;
+    }
+  if (properties.contains("singleFile"))
+    {
+    options |= properties["singleFile"].toBool() ? 0x4 : 0x0;
+    }
+  if (properties.contains("autoWindowLevel"))
+    {
+    options |= properties["autoWindowLevel"].toBool() ? 0x8: 0x0;
+    }
+  if (properties.contains("discardOrientation"))
+    {
+    options |= properties["discardOrientation"].toBool() ? 0x10 : 0x0;
+    }
+  return options;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerVolumesReaderPrivate::propagateVolumeSelection(vtkMRMLVolumeNode* node)
+{
+  vtkSlicerApplicationLogic* appLogic =
+    this->Logic->GetApplicationLogic();
+  vtkMRMLSelectionNode* selectionNode =
+    appLogic ? appLogic->GetSelectionNode() : 0;
+  if (selectionNode)
+    {
+    if (vtkMRMLLabelMapVolumeNode::SafeDownCast(node))
+      {
+      selectionNode->SetReferenceActiveLabelVolumeID(node->GetID());
+      }
+    else
+      {
+      selectionNode->SetReferenceActiveVolumeID(node->GetID());
+      }
+    if (appLogic)
+      {
+      appLogic->PropagateVolumeSelection(); // includes FitSliceToAll by default
+      }
+    }
+}
+
 //-----------------------------------------------------------------------------
 qSlicerVolumesReader::qSlicerVolumesReader(QObject* _parent)
   : Superclass(_parent)
@@ -120,27 +186,7 @@ bool qSlicerVolumesReader::load(const IOProperties& properties)
     {
     name = properties["name"].toString();
     }
-  int options = 0;
-  if (properties.contains("labelmap"))
-    {
-    options |= properties["labelmap"].toBool() ? 0x1 : 0x0;
-    }
-  if (properties.contains("center"))
-    {
-    options |= properties["center"].toBool() ? 0x2 : 0x0;
-    }
-  if (properties.contains("singleFile"))
-    {
-    options |= properties["singleFile"].toBool() ? 0x4 : 0x0;
-    }
-  if (properties.contains("autoWindowLevel"))
-    {
-    options |= properties["autoWindowLevel"].toBool() ? 0x8: 0x0;
-    }
-  if (properties.contains("discardOrientation"))
-    {
-    options |= properties["discardOrientation"].toBool() ? 0x10 : 0x0;
-    }
+  int options = qSlicerVolumesReaderPrivate::loadingOptions(properties);
   vtkSmartPointer<vtkStringArray> fileList;
   if (properties.contains("fileNames"))
     {
@@ -158,25 +204,7 @@ bool qSlicerVolumesReader::load(const IOProperties& properties)
     fileList.GetPointer());
   if (node)
     {
-    vtkSlicerApplicationLogic* appLogic =
-      d->Logic->GetApplicationLogic();
-    vtkMRMLSelectionNode* selectionNode =
-      appLogic ? appLogic->GetSelectionNode() : 0;
-    if (selectionNode)
-      {
-      if (vtkMRMLLabelMapVolumeNode::SafeDownCast(node))
-        {
-        selectionNode->SetReferenceActiveLabelVolumeID(node->GetID());
-        }
-      else
-        {
-        selectionNode->SetReferenceActiveVolumeID(node->GetID());
-        }
-      if (appLogic)
-        {
-        appLogic->PropagateVolumeSelection(); // includes FitSliceToAll by default
-        }
-      }
+    d->propagateVolumeSelection(node);
     this->setLoadedNodes(QStringList(QString(node->GetID())));
     }
   else
@@ -185,3 +213,99 @@ bool qSlicerVolumesReader::load(const IOProperties& properties)
     }
   return node != 0;
 }
+
+//-----------------------------------------------------------------------------
+bool qSlicerVolumesReader::prepareLoad(const IOProperties& properties,
+                                       vtkMRMLStorableNode*& node,
+                                       vtkMRMLStorageNode*& storageNode)
+{
+  Q_D(qSlicerVolumesReader);
+  Q_ASSERT(properties.contains("fileName"));
+  QString fileName = properties["fileName"].toString();
+
+  // The nodes are created by readData() with the volume registry of the logic
+  node = 0;
+  storageNode = 0;
+  vtkMRMLScene* scene = this->mrmlScene();
+  // Remote files and explicit lists of files are only supported by load()
+  if (!d->Logic || !scene ||
+      properties.contains("fileNames") ||
+      (scene->GetCacheManager() &&
+       scene->GetCacheManager()->IsRemoteReference(fileName.toLatin1())))
+    {
+    return false;
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerVolumesReader::readData(const IOProperties& properties,
+                                    vtkMRMLStorableNode*& node,
+                                    vtkMRMLStorageNode*& storageNode,
+                                    vtkCommand* errorObserver)
+{
+  Q_D(qSlicerVolumesReader);
+  QString fileName = properties["fileName"].toString();
+  QString name = QFileInfo(fileName).baseName();
+  if (properties.contains("name"))
+    {
+    name = properties["name"].toString();
+    }
+
+  // The factories of the registry are tested in a scene only used by this
+  // thread, the file is read by the first one that supports it.
+  vtkSmartPointer<vtkMRMLScene> readScene = vtkSmartPointer<vtkMRMLScene>::New();
+  ArchetypeVolumeNodeSet nodeSet = d->Logic->ReadArchetypeVolume(
+    readScene, fileName.toLatin1(), name.toLatin1(),
+    qSlicerVolumesReaderPrivate::loadingOptions(properties), errorObserver);
+  if (!nodeSet.Node)
+    {
+    return false;
+    }
+  node = nodeSet.Node;
+  node->Register(0);
+  storageNode = nodeSet.StorageNode;
+  storageNode->Register(0);
+
+  QMutexLocker locker(&d->ReadNodeSetsMutex);
+  d->ReadNodeSets.insert(std::make_pair(node, nodeSet));
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerVolumesReader::finishLoad(const IOProperties& properties,
+                                      vtkMRMLStorableNode* node,
+                                      vtkMRMLStorageNode* storageNode)
+{
+  Q_D(qSlicerVolumesReader);
+  Q_UNUSED(storageNode);
+  this->setLoadedNodes(QStringList());
+
+  ArchetypeVolumeNodeSet nodeSet(0);
+  {
+  QMutexLocker locker(&d->ReadNodeSetsMutex);
+  qSlicerVolumesReaderPrivate::NodeSetMap::iterator it = d->ReadNodeSets.find(node);
+  if (it == d->ReadNodeSets.end())
+    {
+    return false;
+    }
+  nodeSet = it->second;
+  d->ReadNodeSets.erase(it);
+  }
+  vtkMRMLScene* scene = this->mrmlScene();
+  if (!d->Logic || !scene)
+    {
+    return false;
+    }
+
+  nodeSet.Node->SetName(scene->GetUniqueNameByString(nodeSet.Node->GetName()));
+  vtkMRMLVolumeNode* volumeNode = d->Logic->AddArchetypeVolumeNodeSet(
+    nodeSet, properties["fileName"].toString().toLatin1());
+  if (!volumeNode)
+    {
+    return false;
+    }
+  d->propagateVolumeSelection(volumeNode);
+  this->setLoadedNodes(QStringList(QString(volumeNode->GetID())));
+  return true;
+}
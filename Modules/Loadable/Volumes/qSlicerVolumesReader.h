@@ -47,6 +47,22 @@ public:
   virtual qSlicerIOOptions* options()const;
 
   virtual bool load(const IOProperties& properties);
+
+  /// Local volumes can be read concurrently. readData() reads the file with
+  /// the volume registry of the logic, as load() does, in a scene only used
+  /// by the worker thread.
+  /// \sa qSlicerFileReader::prepareLoad(), vtkSlicerVolumesLogic::ReadArchetypeVolume()
+  virtual bool prepareLoad(const IOProperties& properties,
+                           vtkMRMLStorableNode*& node,
+                           vtkMRMLStorageNode*& storageNode);
+  virtual bool readData(const IOProperties& properties,
+                        vtkMRMLStorableNode*& node,
+                        vtkMRMLStorageNode*& storageNode,
+                        vtkCommand* errorObserver);
+  virtual bool finishLoad(const IOProperties& properties,
+                          vtkMRMLStorableNode* node,
+                          vtkMRMLStorageNode* storageNode);
+
 protected:
   QScopedPointer<qSlicerVolumesReaderPrivate> d_ptr;
 
@@ -8,14 +8,19 @@
 =========================================================================auto=*/
 #include "vtkImageConnectivity.h"
 
+// vtkITK includes
+#include <vtkITKConnectedComponents.h>
+
 #include "vtkObjectFactory.h"
 #include "vtkImageData.h"
 #include <vtkInformation.h>
+#include <vtkNew.h>
 #include <vtkStreamingDemandDrivenPipeline.h>
+#include <vtkTypeTraits.h>
+#include <vtkTypeUInt32Array.h>
 
-#include <limits.h>
-#include <assert.h>
-#include <stddef.h>
+// STD includes
+#include <algorithm>
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkImageConnectivity);
@@ -56,134 +61,11 @@ const char* vtkImageConnectivity::GetFunctionString()
     }
 }
 
-//************************************************************************
-// The following procedures were written by Andre Robatino
-// in November, 1999
-//
-// connect
-// recursive_copy
-//************************************************************************
-
-int connect(unsigned int, size_t *, char *, char, size_t *, size_t *);
-static void recursive_copy(int, size_t);
-
-static size_t *g_axis_len, *g_outimagep, num_stride_index_bits;
-static char *g_inimagep, g_inbackground;
-
-int connect(
-     unsigned int rank,
-     size_t *axis_len,
-     char *inimage,
-     char inbackground,
-     size_t *outimage,
-     size_t *num_components) /* set to NULL if not interested */
-{
-  unsigned int i;
-  register unsigned int axisv;
-  size_t data_len;
-  register size_t label, *outimagep, *outimage_end, *imagep, *new_imagep, boundary_mask_start, component_mask, axis_mask;
-  register ptrdiff_t *stride, stridev;
-
-  //assert(rank >= 0); // Note: Always true !
-  if (rank == 0) {
-    *outimage = (*inimage != inbackground);
-    if (num_components) *num_components = *outimage;
-    return 0;
-  }
-  label = 2*rank;
-  num_stride_index_bits = 1;
-  while (label >>= 1) num_stride_index_bits++;
-  assert(num_stride_index_bits + 2*rank + 1 <= CHAR_BIT*sizeof(size_t));
-  boundary_mask_start = 1<<num_stride_index_bits;
-  axis_mask = boundary_mask_start - 1;
-  stride = (ptrdiff_t *)malloc((2*rank + 1)*sizeof(ptrdiff_t));
-  assert(stride);
-  data_len = 1;
-  for (i=0; i<rank; i++) {
-    assert(axis_len[i] > 1);
-    stride[2*i + 1] = -(stride[2*i] = data_len);
-    data_len *= axis_len[i];
-  }
-  stride[2*rank] = 0;
-  g_axis_len = axis_len;
-  g_inimagep = inimage;
-  g_inbackground = inbackground;
-  g_outimagep = outimage;
-  component_mask = 0;
-  component_mask = ~(~component_mask>>1);
-  recursive_copy(rank-1, component_mask);
-  outimagep = outimage;
-  outimage_end = outimage + data_len;
-  label = 0;
-  do {
-    if (!(*outimagep & component_mask)) continue;
-    imagep = outimagep;
-    *imagep ^= component_mask;
-    axisv = 0;
-    label++;
-    while (1) {
-      while ( (stridev = stride[axisv]) ) {
-        if ((*imagep & boundary_mask_start<<axisv) && (*(new_imagep = imagep + stridev) & component_mask)) {
-          imagep = new_imagep;
-          *imagep ^= component_mask;
-          *imagep |= axisv;
-          axisv = 0;
-          continue;
-        }
-        axisv++;
-      }
-      if (imagep == outimagep) break;
-      axisv = *imagep & axis_mask;
-      *imagep = label;
-      imagep -= stride[axisv++];
-    }
-    *outimagep = label;
-  } while (++outimagep < outimage_end);
-  if (num_components) *num_components = label;
-  free(stride);
-  return 0;
-}
-
-static void recursive_copy(
-     int axis,
-     register size_t mask)
-{
-  register size_t len = g_axis_len[axis] - 2;
-
-  if (axis == 0) {
-    register size_t *outimagep;
-    register char *inimagep, inbackground;
-
-    inimagep = g_inimagep;
-    inbackground = g_inbackground;
-    outimagep = g_outimagep;
-    mask |= 1<<num_stride_index_bits;
-    *outimagep++ = (*inimagep++ == inbackground)? 0 : mask;
-    mask |= 2<<num_stride_index_bits;
-    while (len--) *outimagep++ = (*inimagep++ == inbackground)? 0 : mask;
-    mask ^= 1<<num_stride_index_bits;
-    *outimagep++ = (*inimagep++ == inbackground)? 0 : mask;
-    g_outimagep = outimagep;
-    g_inimagep = inimagep;
-  } else {
-    mask |= 1<<(num_stride_index_bits + 2*axis);
-    recursive_copy(axis-1, mask);
-    mask |= 2<<(num_stride_index_bits + 2*axis);
-    while (len--) recursive_copy(axis-1, mask);
-    mask ^= 1<<(num_stride_index_bits + 2*axis);
-    recursive_copy(axis-1, mask);
-  }
-  return;
-}
-
-//***********************************************************************
-// End Andre's cool routines.
-//************************************************************************
-
-
+//----------------------------------------------------------------------------
+template <class T>
 static void vtkImageConnectivityExecute(vtkImageConnectivity *self,
-                     vtkImageData *inData, short *inPtr,
-                     vtkImageData *outData, short *outPtr,
+                     vtkImageData *inData, T *inPtr,
+                     vtkImageData *outData, T *outPtr,
                      int outExt[6])
 {
   // For looping though output (and input) pixels.
@@ -191,54 +73,33 @@ static void vtkImageConnectivityExecute(vtkImageConnectivity *self,
   int outIdx0, outIdx1, outIdx2;
   vtkIdType inInc0, inInc1, inInc2;
   vtkIdType outInc0, outInc1, outInc2;
-  short *inPtr0, *outPtr0, *outPtr1;
+  T *inPtr0, *outPtr0;
   short minForegnd = (short)self->GetMinForeground();
   short maxForegnd = (short)self->GetMaxForeground();
-  short newLabel = (short)self->GetOutputLabel();
-  short seedLabel = 0;
-  int largest, len=1, nxy, z, nz = 0, j;
-  int *census = NULL;
+  T newLabel = (T)self->GetOutputLabel();
+  T seedLabel = 0;
   int seed[3];
   int minSize = self->GetMinSize();
-  short pix;
+  T pix;
   int identifyIslands = self->GetFunction() == CONNECTIVITY_IDENTIFY;
   int removeIslands   = self->GetFunction() == CONNECTIVITY_REMOVE;
   int changeIsland    = self->GetFunction() == CONNECTIVITY_CHANGE;
   int saveIsland      = self->GetFunction() == CONNECTIVITY_SAVE;
   int measureIsland   = self->GetFunction() == CONNECTIVITY_MEASURE;
   int sliceBySlice    = self->GetSliceBySlice();
+  // the [min,max] threshold is optional
+  bool threshold = (minForegnd > VTK_SHORT_MIN || maxForegnd < VTK_SHORT_MAX);
 
-  // connect
-  size_t conSeedLabel = 0, i, idx, dz;
-  int rank;
-  size_t *axis_len=NULL;
-  unsigned short bg = self->GetBackground();
-  short bgMask = 0;
-  short fgMask = 1;
-  char inbackground = (char)bgMask;
-  char *conInput=NULL;
-  size_t *conOutput=NULL;
-  size_t *numIslands=NULL;
+  // connectivity
+  vtkTypeUInt32 conSeedLabel = 0, *conOutput;
+  vtkIdType i;
+  T bg = (T)self->GetBackground();
 
   // Image bounds
   outMin0 = outExt[0];   outMax0 = outExt[1];
   outMin1 = outExt[2];   outMax1 = outExt[3];
   outMin2 = outExt[4];   outMax2 = outExt[5];
 
-  // Computer Parameters for connect().
-  rank = (outExt[5]==outExt[4]) ? 2 : 3;
-  axis_len = new size_t[rank+1];
-  axis_len[0] = outExt[1]-outExt[0]+1;
-  axis_len[1] = outExt[3]-outExt[2]+1;
-  axis_len[2] = outExt[5]-outExt[4]+1;
-  for (j=0; j<rank; j++)
-  {
-    len *= axis_len[j];
-  }
-  conInput = new char[len];
-  conOutput = new size_t[len];
-  numIslands = new size_t[axis_len[2]];
-
   // Get increments to march through data continuously
   outData->GetContinuousIncrements(outExt, outInc0, outInc1, outInc2);
   inData->GetContinuousIncrements(outExt, inInc0, inInc1, inInc2);
@@ -294,149 +155,49 @@ static void vtkImageConnectivityExecute(vtkImageConnectivity *self,
     //
     // In bounds!
     //
-    outPtr1 = (short*)inData->GetScalarPointer(seed[0], seed[1], seed[2]);
-    seedLabel = *outPtr1;
+    seedLabel = *(T*)inData->GetScalarPointer(seed[0], seed[1], seed[2]);
     }
 
   ///////////////////////////////////////////////////////////////
-  // Remove, Identify:
-  // ----------------------
-  // Create a mask where everything outside [min,max] or in the
-  // sea (bg) is in the background.
+  // Save, Change, Measure, Remove, Identify
+  // ---------------------------------------
+  // Run Connectivity
+  //
+  // Remove, Identify: the foreground is everything not in the
+  // sea (bg), and optionally on [min,max].
+  // Save, Change, Measure: the foreground is everything equal to
+  // seedLabel.
   //
-  //   conInput[i] = fgMask,   inData[i] != bg
-  //               = bgMask,   else
+  // The size of each island is computed at the same time:
   //
-  //   conInput[i] = unchanged
-  //               = bgMask,   where inData[i] not on [min,max]
+  //   census(c) = COUNT(conOutput[c]),  forall c on [1,numIslands]
   //
   ///////////////////////////////////////////////////////////////
 
+  vtkNew<vtkITKConnectedComponents> connectivity;
   if (removeIslands || identifyIslands)
     {
-    inPtr0 = inPtr;
-    i = 0;
-    for (outIdx2 = outMin2; outIdx2 <= outMax2; outIdx2++)
-      {
-      for (outIdx1 = outMin1; outIdx1 <= outMax1; outIdx1++)
-        {
-        for (outIdx0 = outMin0; outIdx0 <= outMax0; outIdx0++)
-          {
-          if (*inPtr0 != bg)
-            {
-            conInput[i] = fgMask;
-            }
-          else
-            {
-            conInput[i] = bgMask;
-            }
-          inPtr0++;
-          i++;
-          }//for0
-        inPtr0 += inInc1;
-        }//for1
-      inPtr0 += inInc2;
-      }//for2
-
-    // Optionally threshold [min,max]
-    if(minForegnd > VTK_SHORT_MIN || maxForegnd < VTK_SHORT_MAX)
+    connectivity->SetBackground(bg);
+    connectivity->ExcludeBackgroundOn();
+    if (threshold)
       {
-      inPtr0 = inPtr;
-      i=0;
-      for (outIdx2 = outMin2; outIdx2 <= outMax2; outIdx2++)
-        {
-        for (outIdx1 = outMin1; outIdx1 <= outMax1; outIdx1++)
-          {
-          for (outIdx0 = outMin0; outIdx0 <= outMax0; outIdx0++)
-            {
-            pix = *inPtr0;
-            if (pix < minForegnd || pix > maxForegnd)
-              {
-              conInput[i] = bgMask;
-              }
-            i++;
-            inPtr0++;
-            }//for0
-          inPtr0 += inInc1;
-          }//for1
-        inPtr0 += inInc2;
-        }//for2
+      connectivity->SetMinForeground(minForegnd);
+      connectivity->SetMaxForeground(maxForegnd);
       }
+    // If SliceBySlice, then islands are computed in each slice
+    connectivity->SetSliceBySlice(sliceBySlice && removeIslands);
     }
-
-
-  ///////////////////////////////////////////////////////////////
-  // Save, Change, Measure:
-  // ----------------------
-  //
-  // Create a mask where everything not equal to seedLabel is
-  // in the background.
-  //
-  //     conInput[i] = fgMask,  inData[i] == seedLabel
-  //                 = bgMask,  else
-  //
-  ///////////////////////////////////////////////////////////////
-
-  if (saveIsland || changeIsland || measureIsland)
+  else
     {
-    inPtr0 = inPtr;
-    i = 0;
-    for (outIdx2 = outMin2; outIdx2 <= outMax2; outIdx2++)
-      {
-      for (outIdx1 = outMin1; outIdx1 <= outMax1; outIdx1++)
-        {
-        for (outIdx0 = outMin0; outIdx0 <= outMax0; outIdx0++)
-          {
-          if (*inPtr0 == seedLabel)
-            {
-            conInput[i] = fgMask;
-            }
-          else
-            {
-            conInput[i] = bgMask;
-            }
-          inPtr0++;
-          i++;
-          }//for0
-        inPtr0 += inInc1;
-        }//for1
-      inPtr0 += inInc2;
-      }//for2
+    connectivity->ExcludeBackgroundOff();
+    connectivity->SetMinForeground(seedLabel);
+    connectivity->SetMaxForeground(seedLabel);
     }
-
-
-  ///////////////////////////////////////////////////////////////
-  // Save, Change, Measure, Remove, Identify
-  // ---------------------------------------
-  // Run Connectivity
-  //
-  ///////////////////////////////////////////////////////////////
-
-  if (saveIsland || changeIsland || measureIsland || removeIslands || identifyIslands)
+  if (!connectivity->Label(inData, outExt))
     {
-    nz = 1;
-    if (sliceBySlice && removeIslands)
-      {
-      // If SliceBySlice, then call connect() for each slice
-      nxy = axis_len[0] * axis_len[1];
-      nz = axis_len[2];
-      rank = 2;
-      int axis_len2 = axis_len[2];
-      axis_len[2] = 1;
-
-      for (z=0; z < nz; z++)
-        {
-        connect(rank, axis_len, &conInput[nxy*z], inbackground,
-          &conOutput[nxy*z], &numIslands[z]);
-        }
-      axis_len[2] = axis_len2;
-      }
-    else
-      {
-      connect(rank, axis_len, conInput, inbackground, conOutput, &numIslands[0]);
-      }
+    return;
     }
-
+  conOutput = connectivity->GetLabels()->GetPointer(0);
 
   ///////////////////////////////////////////////////////////////
   // Save, Change, Measure
@@ -449,187 +210,70 @@ static void vtkImageConnectivityExecute(vtkImageConnectivity *self,
 
   if (saveIsland || changeIsland || measureIsland)
     {
-    i = seed[2]*axis_len[1]*axis_len[0] + seed[1]*axis_len[0] + seed[0];
+    i = ((vtkIdType)(seed[2] - outMin2) * (outMax1 - outMin1 + 1) + (seed[1] - outMin1))
+      * (outMax0 - outMin0 + 1) + (seed[0] - outMin0);
     conSeedLabel = conOutput[i];
     }
 
-
-  ///////////////////////////////////////////////////////////////
-  // Measure, Remove
-  // -----------------------------
-  // Count size of each island in conOutput
-  //
-  //   census[c] = COUNT(conOutput[c]),  forall c on [0,numIslands]
-  //
-  ///////////////////////////////////////////////////////////////
-
-  if (removeIslands || measureIsland)
-    {
-    // For each label value, count the number of pixels with that label
-    // If SliceBySlice, then work on each slice one at a time
-    len = 0;
-    for (z=0; z<nz; z++)
-      {
-      len += numIslands[z] + 1;
-      }
-    census = new int[len];
-    memset(census, 0, len*sizeof(int));
-
-    if (nz == 1)
-      {
-      i = 0;
-      for (outIdx2 = outMin2; outIdx2 <= outMax2; outIdx2++)
-        {
-        for (outIdx1 = outMin1; outIdx1 <= outMax1; outIdx1++)
-          {
-          for (outIdx0 = outMin0; outIdx0 <= outMax0; outIdx0++)
-            {
-            idx = conOutput[i];
-            // Note: Since 'idx' is defined as 'size_t' it's of type 'unsigned'
-            // It means 'idx >= 0' is always true.
-            if (/*idx >= 0 && */idx <= numIslands[0])
-              {
-              census[idx] = census[idx] + 1;
-              }
-            i++;
-            }//for0
-          }//for1
-        }//for2
-      }
-    else
-      {
-      dz = 0;
-      i = 0;
-      for (z=0; z < nz; z++)
-        {
-        for (outIdx1 = outMin1; outIdx1 <= outMax1; outIdx1++)
-          {
-          for (outIdx0 = outMin0; outIdx0 <= outMax0; outIdx0++)
-            {
-            idx = conOutput[i];
-            // Note: Since 'idx' is defined as 'size_t' it's of type 'unsigned'
-            // It means 'idx >= 0' is always true.
-            if (/*idx >= 0 && */idx <= numIslands[z])
-              {
-              census[dz+idx] = census[dz+idx] + 1;
-              }
-            i++;
-            }//for0
-          }//for1
-
-        dz += numIslands[z]+1;
-        }//forz
-      }
-    }
-
-
   ///////////////////////////////////////////////////////////////
   // Remove
   // -----------------------------
   // Output gets input except where islands too small
   //
-  //   outData[i] = inData[i],  census[conOutput[i]] >= minIslandSize
+  //   outData[i] = inData[i],  census(conOutput[i]) >= minIslandSize
   //              = bg,    else
   //
   ///////////////////////////////////////////////////////////////
 
   if (removeIslands)
     {
-    if (nz == 1)
+    inPtr0 = inPtr;
+    outPtr0 = outPtr;
+    i = 0;
+    for (outIdx2 = outMin2; outIdx2 <= outMax2; outIdx2++)
       {
-      inPtr0 = inPtr;
-      outPtr0 = outPtr;
-      i = 0;
-      for (outIdx2 = outMin2; outIdx2 <= outMax2; outIdx2++)
+      for (outIdx1 = outMin1; outIdx1 <= outMax1; outIdx1++)
         {
-        for (outIdx1 = outMin1; outIdx1 <= outMax1; outIdx1++)
+        for (outIdx0 = outMin0; outIdx0 <= outMax0; outIdx0++)
           {
-          for (outIdx0 = outMin0; outIdx0 <= outMax0; outIdx0++)
+          if (conOutput[i] == 0 ||
+              connectivity->GetLabelSize(conOutput[i]) >= minSize)
             {
-            if (census[conOutput[i]] >= minSize)
-              {
-              *outPtr0 = *inPtr0;
-              }
-            else
-              {
-              *outPtr0 = bg;
-              }
-            i++;
-            outPtr0++;
-            inPtr0++;
-            }//for0
-          outPtr0 += outInc1;
-          inPtr0 += inInc1;
-          }//for1
-        outPtr0 += outInc2;
-        inPtr0 += inInc2;
-        }//for2
-      }
-    else
-      {
-      dz = 0;
-      i = 0;
-      inPtr0 = inPtr;
-      outPtr0 = outPtr;
-      for (z=0; z < nz; z++)
-        {
-        for (outIdx1 = outMin1; outIdx1 <= outMax1; outIdx1++)
-          {
-          for (outIdx0 = outMin0; outIdx0 <= outMax0; outIdx0++)
+            *outPtr0 = *inPtr0;
+            }
+          else
             {
-            if (census[dz+conOutput[i]] >= minSize)
-              {
-              *outPtr0 = *inPtr0;
-              }
-            else
-              {
-              *outPtr0 = bg;
-              }
-            i++;
-            outPtr0++;
-            inPtr0++;
-            }//for0
-          outPtr0 += outInc1;
-          inPtr0 += inInc1;
-          }//for1
-        outPtr0 += outInc2;
-        inPtr0 += inInc2;
-
-        dz += numIslands[z] + 1;
-        }//z
-      }//else
+            *outPtr0 = bg;
+            }
+          i++;
+          outPtr0++;
+          inPtr0++;
+          }//for0
+        outPtr0 += outInc1;
+        inPtr0 += inInc1;
+        }//for1
+      outPtr0 += outInc2;
+      inPtr0 += inInc2;
+      }//for2
     }
 
-
   ///////////////////////////////////////////////////////////////
   // Measure
   // -----------------------------
   // Store statistics, and return output = input.
   //
-  //   islandSize = census[conSeedLabel]
-  //   largest    = MAX(census[c])
+  //   islandSize = census(conSeedLabel)
+  //   largest    = MAX(census(c))
   //   outData[i] = inData[i]
   //
   ///////////////////////////////////////////////////////////////
 
   if (measureIsland)
     {
-    // Find largest island
-    largest = 0;
-    for (i=0; i<=numIslands[0]; i++)
-      {
-      if (i != bg)
-        {
-        if (census[i] > largest)
-          {
-          largest = census[i];
-          }
-        }
-      }
-    self->SetLargestIslandSize(largest);
+    self->SetLargestIslandSize(connectivity->GetLargestLabelSize());
 
     // Measure island at seed
-    self->SetIslandSize(census[conSeedLabel]);
+    self->SetIslandSize(connectivity->GetLabelSize(conSeedLabel));
 
     // Return output values to be the inputs
     inPtr0 = inPtr;
@@ -652,18 +296,32 @@ static void vtkImageConnectivityExecute(vtkImageConnectivity *self,
       }//for2
     }
 
-
   ///////////////////////////////////////////////////////////////
   // Identify
   // -----------------------------
-  // Output gets the output of connect()
+  // Output gets the island labels, and the input where the input
+  // was thresholded away
   //
-  //   outData[i] = conOutput[i]
+  //   outData[i] = inData[i],     inData[i] outside [min,max]
+  //              = conOutput[i],  else
   //
+  // The labels that don't fit in the scalar type are clamped to its
+  // largest value.
   ///////////////////////////////////////////////////////////////
 
   if (identifyIslands)
     {
+    const double maxTypeLabel = vtkTypeTraits<T>::Max();
+    const vtkTypeUInt32 maxLabel = static_cast<vtkTypeUInt32>(
+      std::min(maxTypeLabel, static_cast<double>(VTK_TYPE_UINT32_MAX)));
+    if (connectivity->GetNumberOfLabels() > maxLabel)
+      {
+      vtkWarningWithObjectMacro(self, << "IdentifyIslands: "
+        << connectivity->GetNumberOfLabels() << " islands don't fit in the "
+        << "scalar type, islands after island " << maxLabel << " are all labeled "
+        << maxLabel);
+      }
+    inPtr0 = inPtr;
     outPtr0 = outPtr;
     i = 0;
     for (outIdx2 = outMin2; outIdx2 <= outMax2; outIdx2++)
@@ -672,61 +330,28 @@ static void vtkImageConnectivityExecute(vtkImageConnectivity *self,
         {
         for (outIdx0 = outMin0; outIdx0 <= outMax0; outIdx0++)
           {
-          *outPtr0 = (short)conOutput[i];
+          pix = *inPtr0;
+          if (threshold && (static_cast<double>(pix) < minForegnd ||
+                            static_cast<double>(pix) > maxForegnd))
+            {
+            *outPtr0 = pix;
+            }
+          else
+            {
+            *outPtr0 = static_cast<T>(std::min(conOutput[i], maxLabel));
+            }
           i++;
+          inPtr0++;
           outPtr0++;
           }//for0
+        inPtr0 += inInc1;
         outPtr0 += outInc1;
         }//for1
+      inPtr0 += inInc2;
       outPtr0 += outInc2;
       }//for2
     }
 
-  ///////////////////////////////////////////////////////////////
-  // Remove, Identify
-  // -----------------------------
-  // Output gets input where the input was thresholded away
-  //
-  //   outData[i] = inData[i],  inData[i] outside [min,max]
-  //              = do nothing, else
-  //
-  ///////////////////////////////////////////////////////////////
-
-  if (removeIslands || identifyIslands)
-    {
-    if(minForegnd > VTK_SHORT_MIN || maxForegnd < VTK_SHORT_MAX)
-      {
-      inPtr0 = inPtr;
-      outPtr0 = outPtr;
-      for (outIdx2 = outMin2; outIdx2 <= outMax2; outIdx2++)
-        {
-        for (outIdx1 = outMin1; outIdx1 <= outMax1; outIdx1++)
-          {
-          for (outIdx0 = outMin0; outIdx0 <= outMax0; outIdx0++)
-            {
-            pix = *inPtr0;
-            if (pix < minForegnd || pix > maxForegnd)
-              {
-              *outPtr0 = pix;
-              }
-            inPtr0++;
-            outPtr0++;
-            }//for0
-          inPtr0 += inInc1;
-          outPtr0 += outInc1;
-          }//for1
-        inPtr0 += inInc2;
-        outPtr0 += outInc2;
-        }//for2
-      }
-    }
-
-  if (removeIslands || measureIsland)
-    {
-    delete [] census;
-    }
-
-
   ///////////////////////////////////////////////////////////////
   // Save
   // -----------------------------
@@ -768,7 +393,6 @@ static void vtkImageConnectivityExecute(vtkImageConnectivity *self,
       }//for2
     }
 
-
   ///////////////////////////////////////////////////////////////
   // Change
   // -----------------------------
@@ -809,15 +433,6 @@ static void vtkImageConnectivityExecute(vtkImageConnectivity *self,
       inPtr0 += inInc2;
       }//for2
     }
-
-  ///////////////////////////////////////////////////////////////
-  // Cleanup
-  ///////////////////////////////////////////////////////////////
-
-  delete [] axis_len;
-  delete [] numIslands;
-  delete [] conInput;
-  delete [] conOutput;
 }
 
 
@@ -858,17 +473,24 @@ void vtkImageConnectivity::ExecuteDataWithInformation(vtkDataObject *output, vtk
     return;
     }
 
-  /* Need short data */
+  /* Need integer data */
   s = inData->GetScalarType();
-  if (s != VTK_SHORT)
+  switch (s)
     {
-    vtkErrorMacro("Warning: Input scalars are type "<<s
-      << " instead of "<<VTK_SHORT);
-    return;
+    vtkTemplateMacroCase(VTK_LONG, long, vtkImageConnectivityExecute(this, inData, static_cast<VTK_TT *>(inPtr), outData, static_cast<VTK_TT *>(outPtr), outExt));
+    vtkTemplateMacroCase(VTK_UNSIGNED_LONG, unsigned long, vtkImageConnectivityExecute(this, inData, static_cast<VTK_TT *>(inPtr), outData, static_cast<VTK_TT *>(outPtr), outExt));
+    vtkTemplateMacroCase(VTK_INT, int, vtkImageConnectivityExecute(this, inData, static_cast<VTK_TT *>(inPtr), outData, static_cast<VTK_TT *>(outPtr), outExt));
+    vtkTemplateMacroCase(VTK_UNSIGNED_INT, unsigned int, vtkImageConnectivityExecute(this, inData, static_cast<VTK_TT *>(inPtr), outData, static_cast<VTK_TT *>(outPtr), outExt));
+    vtkTemplateMacroCase(VTK_SHORT, short, vtkImageConnectivityExecute(this, inData, static_cast<VTK_TT *>(inPtr), outData, static_cast<VTK_TT *>(outPtr), outExt));
+    vtkTemplateMacroCase(VTK_UNSIGNED_SHORT, unsigned short, vtkImageConnectivityExecute(this, inData, static_cast<VTK_TT *>(inPtr), outData, static_cast<VTK_TT *>(outPtr), outExt));
+    vtkTemplateMacroCase(VTK_CHAR, char, vtkImageConnectivityExecute(this, inData, static_cast<VTK_TT *>(inPtr), outData, static_cast<VTK_TT *>(outPtr), outExt));
+    vtkTemplateMacroCase(VTK_SIGNED_CHAR, signed char, vtkImageConnectivityExecute(this, inData, static_cast<VTK_TT *>(inPtr), outData, static_cast<VTK_TT *>(outPtr), outExt));
+    vtkTemplateMacroCase(VTK_UNSIGNED_CHAR, unsigned char, vtkImageConnectivityExecute(this, inData, static_cast<VTK_TT *>(inPtr), outData, static_cast<VTK_TT *>(outPtr), outExt));
+    default:
+      vtkErrorMacro("Warning: Input scalars are type "<<s
+        << " instead of an integer type");
+      return;
     }
-
-  vtkImageConnectivityExecute(this, inData, (short *)inPtr,
-    outData, (short *)(outPtr), outExt);
 }
 
 //----------------------------------------------------------------------------
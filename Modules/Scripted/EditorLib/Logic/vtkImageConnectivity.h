@@ -8,7 +8,8 @@
 =========================================================================auto=*/
 ///  vtkImageConnectivity - Identify and process islands of similar pixels
 ///
-///  The input data type must be shorts.
+///  The input data type must be an integer type. Islands are labeled in
+///  parallel by vtkITKConnectedComponents.
 /// .SECTION Warning
 /// You need to explicitely call Update
 
@@ -156,19 +156,30 @@ class LabelStatisticsWidget:
     volumesLogic = slicer.modules.volumes.logic()
     warnings = volumesLogic.CheckForLabelVolumeValidity(self.grayscaleNode, self.labelNode)
     resampledLabelNode = None
-    if warnings != "":
-      if 'mismatch' in warnings:
-        resampledLabelNode = volumesLogic.ResampleVolumeToReferenceVolume(self.labelNode, self.grayscaleNode)
-        self.logic = LabelStatisticsLogic(self.grayscaleNode, resampledLabelNode)
+    try:
+      if warnings != "":
+        if 'mismatch' in warnings:
+          resampledLabelNode = volumesLogic.ResampleVolumeToReferenceVolume(self.labelNode, self.grayscaleNode)
+          self.logic = LabelStatisticsLogic(self.grayscaleNode, resampledLabelNode)
+        else:
+          qt.QMessageBox.warning(slicer.util.mainWindow(),
+              "Label Statistics", "Volumes do not have the same geometry.\n%s" % warnings)
+          self.applyButton.text = "Apply"
+          return
       else:
-        qt.QMessageBox.warning(slicer.util.mainWindow(),
-            "Label Statistics", "Volumes do not have the same geometry.\n%s" % warnings)
-        return
-    else:
-      self.logic = LabelStatisticsLogic(self.grayscaleNode, self.labelNode)
+        self.logic = LabelStatisticsLogic(self.grayscaleNode, self.labelNode)
+    except ValueError as e:
+      qt.QMessageBox.critical(slicer.util.mainWindow(),
+          "Label Statistics", str(e))
+      self.applyButton.text = "Apply"
+      return
+    finally:
+      if resampledLabelNode:
+        slicer.mrmlScene.RemoveNode(resampledLabelNode)
     self.populateStats()
-    if resampledLabelNode:
-      slicer.mrmlScene.RemoveNode(resampledLabelNode)
+    if self.logic.warnings:
+      qt.QMessageBox.warning(slicer.util.mainWindow(),
+          "Label Statistics", "\n".join(self.logic.warnings))
     self.chartFrame.enabled = True
     self.saveButton.enabled = True
     self.applyButton.text = "Apply"
@@ -251,94 +262,70 @@ class LabelStatisticsLogic:
   """Implement the logic to calculate label statistics.
   Nodes are passed in as arguments.
   Results are stored as 'statistics' instance variable.
+  The label volume is resampled on the grayscale volume if their
+  dimensions differ. Problems that don't prevent the computation are
+  stored as 'warnings', a ValueError is raised if it fails.
   """
 
   def __init__(self, grayscaleNode, labelNode, fileName=None):
     #import numpy
 
     self.keys = ("Index", "Count", "Volume mm^3", "Volume cc", "Min", "Max", "Mean", "StdDev")
-    cubicMMPerVoxel = reduce(lambda x,y: x*y, labelNode.GetSpacing())
     ccPerCubicMM = 0.001
 
-    # TODO: progress and status updates
-    # this->InvokeEvent(vtkLabelStatisticsLogic::StartLabelStats, (void*)"start label stats")
-    
     self.labelNode = labelNode
 
     self.labelStats = {}
     self.labelStats['Labels'] = []
+    self.warnings = []
 
-    stataccum = vtk.vtkImageAccumulate()
-    if vtk.VTK_MAJOR_VERSION <= 5:
-      stataccum.SetInput(labelNode.GetImageData())
-    else:
-      stataccum.SetInputConnection(labelNode.GetImageDataConnection())
-    stataccum.Update()
-    lo = int(stataccum.GetMin()[0])
-    hi = int(stataccum.GetMax()[0])
-
-    for i in xrange(lo,hi+1):
-
-      # this->SetProgress((float)i/hi);
-      # std::string event_message = "Label "; std::stringstream s; s << i; event_message.append(s.str());
-      # this->InvokeEvent(vtkLabelStatisticsLogic::LabelStatsOuterLoop, (void*)event_message.c_str());
-
-      # logic copied from slicer3 LabelStatistics
-      # to create the binary volume of the label
-      # //logic copied from slicer2 LabelStatistics MaskStat
-      # // create the binary volume of the label
-      thresholder = vtk.vtkImageThreshold()
-      if vtk.VTK_MAJOR_VERSION <= 5:
-        thresholder.SetInput(labelNode.GetImageData())
-      else:
-        thresholder.SetInputConnection(labelNode.GetImageDataConnection())
-      thresholder.SetInValue(1)
-      thresholder.SetOutValue(0)
-      thresholder.ReplaceOutOn()
-      thresholder.ThresholdBetween(i,i)
-      thresholder.SetOutputScalarType(grayscaleNode.GetImageData().GetScalarType())
-      thresholder.Update()
-
-      # this.InvokeEvent(vtkLabelStatisticsLogic::LabelStatsInnerLoop, (void*)"0.25");
-
-      #  use vtk's statistics class with the binary labelmap as a stencil
-      stencil = vtk.vtkImageToImageStencil()
-      if vtk.VTK_MAJOR_VERSION <= 5:
-        stencil.SetInput(thresholder.GetOutput())
-      else:
-        stencil.SetInputConnection(thresholder.GetOutputPort())
-      stencil.ThresholdBetween(1, 1)
-
-      # this.InvokeEvent(vtkLabelStatisticsLogic::LabelStatsInnerLoop, (void*)"0.5")
-
-      stat1 = vtk.vtkImageAccumulate()
-      if vtk.VTK_MAJOR_VERSION <= 5:
-        stat1.SetInput(grayscaleNode.GetImageData())
-        stat1.SetStencil(stencil.GetOutput())
-      else:
-        stat1.SetInputConnection(grayscaleNode.GetImageDataConnection())
-        stencil.Update()
-        stat1.SetStencilData(stencil.GetOutput())
+    grayscaleImage = grayscaleNode.GetImageData()
+    labelImage = labelNode.GetImageData()
+    if not grayscaleImage or not labelImage:
+      raise ValueError("Label statistics need a grayscale and a label volume with images.")
 
-      stat1.Update()
-
-      # this.InvokeEvent(vtkLabelStatisticsLogic::LabelStatsInnerLoop, (void*)"0.75")
+    # the statistics are computed voxel by voxel
+    resampledLabelNode = None
+    if grayscaleImage.GetDimensions() != labelImage.GetDimensions():
+      volumesLogic = slicer.modules.volumes.logic()
+      resampledLabelNode = volumesLogic.ResampleVolumeToReferenceVolume(labelNode, grayscaleNode)
+      if not resampledLabelNode or not resampledLabelNode.GetImageData():
+        raise ValueError("Label volume %s can't be resampled on grayscale volume %s."
+                         % (labelNode.GetName(), grayscaleNode.GetName()))
+      labelNode = resampledLabelNode
+      labelImage = labelNode.GetImageData()
 
-      if stat1.GetVoxelCount() > 0:
-        # add an entry to the LabelStats list
-        self.labelStats["Labels"].append(i)
-        self.labelStats[i,"Index"] = i
-        self.labelStats[i,"Count"] = stat1.GetVoxelCount()
-        self.labelStats[i,"Volume mm^3"] = self.labelStats[i,"Count"] * cubicMMPerVoxel
-        self.labelStats[i,"Volume cc"] = self.labelStats[i,"Volume mm^3"] * ccPerCubicMM
-        self.labelStats[i,"Min"] = stat1.GetMin()[0]
-        self.labelStats[i,"Max"] = stat1.GetMax()[0]
-        self.labelStats[i,"Mean"] = stat1.GetMean()[0]
-        self.labelStats[i,"StdDev"] = stat1.GetStandardDeviation()[0]
+    cubicMMPerVoxel = reduce(lambda x,y: x*y, labelNode.GetSpacing())
 
-        # this.InvokeEvent(vtkLabelStatisticsLogic::LabelStatsInnerLoop, (void*)"1")
+    if labelImage.GetScalarType() in (vtk.VTK_FLOAT, vtk.VTK_DOUBLE):
+      self.warnings.append("Label volume %s has floating point values, "
+                           "they are truncated to integer labels." % self.labelNode.GetName())
+      print("Warning: %s" % self.warnings[-1])
 
-    # this.InvokeEvent(vtkLabelStatisticsLogic::EndLabelStats, (void*)"end label stats")
+    # all the labels are measured in a single pass over the images
+    stats = slicer.vtkLabelStatisticsLogic()
+    stats.SetGrayscaleImageData(grayscaleImage)
+    stats.SetLabelImageData(labelImage)
+    computed = stats.ComputeStatistics()
+    if resampledLabelNode:
+      slicer.mrmlScene.RemoveNode(resampledLabelNode)
+    if not computed:
+      raise ValueError("Label statistics of grayscale volume %s with label volume %s "
+                       "can't be computed, the volumes don't match."
+                       % (grayscaleNode.GetName(), self.labelNode.GetName()))
+
+    for n in xrange(stats.GetNumberOfLabels()):
+      i = int(stats.GetNthLabel(n))
+      # add an entry to the LabelStats list
+      self.labelStats["Labels"].append(i)
+      self.labelStats[i,"Index"] = i
+      self.labelStats[i,"Count"] = stats.GetNthCount(n)
+      self.labelStats[i,"Volume mm^3"] = self.labelStats[i,"Count"] * cubicMMPerVoxel
+      self.labelStats[i,"Volume cc"] = self.labelStats[i,"Volume mm^3"] * ccPerCubicMM
+      self.labelStats[i,"Min"] = stats.GetNthMin(n)
+      self.labelStats[i,"Max"] = stats.GetNthMax(n)
+      self.labelStats[i,"Mean"] = stats.GetNthMean(n)
+      self.labelStats[i,"StdDev"] = stats.GetNthStandardDeviation(n)
 
   def createStatsChart(self, labelNode, valueToPlot, ignoreZero=False):
     """Make a MRML chart of the current stats
@@ -478,6 +465,13 @@ class LabelStatisticsTest(unittest.TestCase):
 
     self.assertTrue( warnings != "" )
 
+    # the label volume is resampled on the grayscale volume
+    logic = LabelStatisticsLogic(ctChest, mrHeadLabel)
+    ctChestDimensions = ctChest.GetImageData().GetDimensions()
+    self.assertEqual( logic.labelStats["Labels"], [0] )
+    self.assertEqual( logic.labelStats[0,"Count"],
+                      reduce(lambda x,y: x*y, ctChestDimensions) )
+
     warnings = volumesLogic.CheckForLabelVolumeValidity(mrHead, mrHeadLabel)
 
     self.delayDisplay("Warnings for match:\n%s" % warnings)
@@ -0,0 +1,318 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// LabelStatistics includes
+#include "vtkLabelStatisticsLogic.h"
+
+// VTK includes
+#include <vtkCommand.h>
+#include <vtkImageData.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkLabelStatisticsLogic);
+vtkCxxSetObjectMacro(vtkLabelStatisticsLogic, GrayscaleImageData, vtkImageData);
+vtkCxxSetObjectMacro(vtkLabelStatisticsLogic, LabelImageData, vtkImageData);
+
+//----------------------------------------------------------------------------
+vtkLabelStatisticsLogic::LabelStatistics::LabelStatistics()
+{
+  this->Label = 0;
+  this->Count = 0;
+  this->Min = VTK_DOUBLE_MAX;
+  this->Max = VTK_DOUBLE_MIN;
+  this->Mean = 0.;
+  this->SumOfSquaredDeviations = 0.;
+}
+
+//----------------------------------------------------------------------------
+inline void vtkLabelStatisticsLogic::LabelStatistics::Add(double value)
+{
+  ++this->Count;
+  this->Min = std::min(this->Min, value);
+  this->Max = std::max(this->Max, value);
+  // Welford's update, no cancellation for large values of small variance
+  const double deviation = value - this->Mean;
+  this->Mean += deviation / this->Count;
+  this->SumOfSquaredDeviations += deviation * (value - this->Mean);
+}
+
+//----------------------------------------------------------------------------
+void vtkLabelStatisticsLogic::LabelStatistics::Add(const LabelStatistics& statistics)
+{
+  if (statistics.Count == 0)
+    {
+    return;
+    }
+  // Pairwise combination of the means and squared deviations (Chan et al.)
+  const vtkIdType count = this->Count + statistics.Count;
+  const double deviation = statistics.Mean - this->Mean;
+  this->Mean += deviation * statistics.Count / count;
+  this->SumOfSquaredDeviations += statistics.SumOfSquaredDeviations +
+    deviation * deviation * this->Count * statistics.Count / count;
+  this->Count = count;
+  this->Min = std::min(this->Min, statistics.Min);
+  this->Max = std::max(this->Max, statistics.Max);
+}
+
+//----------------------------------------------------------------------------
+vtkLabelStatisticsLogic::vtkLabelStatisticsLogic()
+{
+  this->GrayscaleImageData = 0;
+  this->LabelImageData = 0;
+  this->MultiThreader = vtkMultiThreader::New();
+  this->NumberOfThreads = this->MultiThreader->GetNumberOfThreads();
+}
+
+//----------------------------------------------------------------------------
+vtkLabelStatisticsLogic::~vtkLabelStatisticsLogic()
+{
+  this->SetGrayscaleImageData(0);
+  this->SetLabelImageData(0);
+  this->MultiThreader->Delete();
+}
+
+//----------------------------------------------------------------------------
+void vtkLabelStatisticsLogic::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "GrayscaleImageData: " << this->GrayscaleImageData << "\n";
+  os << indent << "LabelImageData: " << this->LabelImageData << "\n";
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+  os << indent << "NumberOfLabels: " << this->GetNumberOfLabels() << "\n";
+}
+
+//----------------------------------------------------------------------------
+template <class TGray, class TLabel>
+void vtkLabelStatisticsLogicAccumulate(const TGray* gray, int grayComponents,
+                                       const TLabel* label, int labelComponents,
+                                       vtkIdType begin, vtkIdType end,
+                                       vtkLabelStatisticsLogic::LabelStatisticsMap& statistics)
+{
+  gray += begin * grayComponents;
+  label += begin * labelComponents;
+  vtkLabelStatisticsLogic::LabelStatistics* labelStatistics = 0;
+  vtkIdType currentLabel = 0;
+  for (vtkIdType i = begin; i < end; ++i)
+    {
+    const vtkIdType voxelLabel = static_cast<vtkIdType>(*label);
+    // Labels come in runs, the map is only searched when the label changes
+    if (!labelStatistics || voxelLabel != currentLabel)
+      {
+      labelStatistics = &statistics[voxelLabel];
+      labelStatistics->Label = voxelLabel;
+      currentLabel = voxelLabel;
+      }
+    labelStatistics->Add(static_cast<double>(*gray));
+    gray += grayComponents;
+    label += labelComponents;
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class TLabel>
+void vtkLabelStatisticsLogicAccumulateLabel(vtkImageData* grayImage,
+                                            const TLabel* label, int labelComponents,
+                                            vtkIdType begin, vtkIdType end,
+                                            vtkLabelStatisticsLogic::LabelStatisticsMap& statistics)
+{
+  const int grayComponents = grayImage->GetNumberOfScalarComponents();
+  switch (grayImage->GetScalarType())
+    {
+    vtkTemplateMacro(vtkLabelStatisticsLogicAccumulate(
+      static_cast<const VTK_TT*>(grayImage->GetScalarPointer()), grayComponents,
+      label, labelComponents, begin, end, statistics));
+    default:
+      break;
+    }
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkLabelStatisticsLogic::ThreadedExecute(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkLabelStatisticsLogic* self = static_cast<vtkLabelStatisticsLogic*>(info->UserData);
+  self->ComputeThreadStatistics(info->ThreadID, info->NumberOfThreads);
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+void vtkLabelStatisticsLogic::ComputeThreadStatistics(int threadId, int numberOfThreads)
+{
+  const vtkIdType numberOfVoxels = this->LabelImageData->GetNumberOfPoints();
+  const vtkIdType begin = numberOfVoxels * threadId / numberOfThreads;
+  const vtkIdType end = numberOfVoxels * (threadId + 1) / numberOfThreads;
+  const int labelComponents = this->LabelImageData->GetNumberOfScalarComponents();
+  LabelStatisticsMap& statistics = this->ThreadStatistics[threadId];
+  switch (this->LabelImageData->GetScalarType())
+    {
+    vtkTemplateMacro(vtkLabelStatisticsLogicAccumulateLabel(
+      this->GrayscaleImageData,
+      static_cast<const VTK_TT*>(this->LabelImageData->GetScalarPointer()),
+      labelComponents, begin, end, statistics));
+    default:
+      break;
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkLabelStatisticsLogic::ComputeStatistics()
+{
+  this->Statistics.clear();
+  if (!this->GrayscaleImageData || !this->LabelImageData ||
+      !this->GrayscaleImageData->GetPointData()->GetScalars() ||
+      !this->LabelImageData->GetPointData()->GetScalars())
+    {
+    vtkErrorMacro("ComputeStatistics: grayscale and label images are needed");
+    return false;
+    }
+  int grayDimensions[3];
+  int labelDimensions[3];
+  this->GrayscaleImageData->GetDimensions(grayDimensions);
+  this->LabelImageData->GetDimensions(labelDimensions);
+  if (grayDimensions[0] != labelDimensions[0] ||
+      grayDimensions[1] != labelDimensions[1] ||
+      grayDimensions[2] != labelDimensions[2])
+    {
+    vtkErrorMacro("ComputeStatistics: grayscale dimensions "
+                  << grayDimensions[0] << "x" << grayDimensions[1] << "x" << grayDimensions[2]
+                  << " don't match the label dimensions "
+                  << labelDimensions[0] << "x" << labelDimensions[1] << "x" << labelDimensions[2]);
+    return false;
+    }
+
+  this->InvokeEvent(vtkCommand::StartEvent);
+
+  // Don't start more threads than rows
+  const int numberOfThreads = std::max(1, std::min(this->NumberOfThreads,
+    labelDimensions[1] * labelDimensions[2]));
+  this->ThreadStatistics.assign(numberOfThreads, LabelStatisticsMap());
+  this->MultiThreader->SetNumberOfThreads(numberOfThreads);
+  this->MultiThreader->SetSingleMethod(vtkLabelStatisticsLogic::ThreadedExecute, this);
+  this->MultiThreader->SingleMethodExecute();
+
+  // Merge the statistics of the threads, sorted by label
+  LabelStatisticsMap statistics;
+  for (int thread = 0; thread < numberOfThreads; ++thread)
+    {
+    for (LabelStatisticsMap::const_iterator it = this->ThreadStatistics[thread].begin();
+         it != this->ThreadStatistics[thread].end(); ++it)
+      {
+      LabelStatistics& labelStatistics = statistics[it->first];
+      labelStatistics.Label = it->first;
+      labelStatistics.Add(it->second);
+      }
+    }
+  this->ThreadStatistics.clear();
+  for (LabelStatisticsMap::const_iterator it = statistics.begin();
+       it != statistics.end(); ++it)
+    {
+    this->Statistics.push_back(it->second);
+    }
+
+  this->InvokeEvent(vtkCommand::EndEvent);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+int vtkLabelStatisticsLogic::GetNumberOfLabels()const
+{
+  return static_cast<int>(this->Statistics.size());
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkLabelStatisticsLogic::GetNthLabel(int n)const
+{
+  if (n < 0 || n >= this->GetNumberOfLabels())
+    {
+    return 0;
+    }
+  return this->Statistics[n].Label;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkLabelStatisticsLogic::GetNthCount(int n)const
+{
+  if (n < 0 || n >= this->GetNumberOfLabels())
+    {
+    return 0;
+    }
+  return this->Statistics[n].Count;
+}
+
+//----------------------------------------------------------------------------
+double vtkLabelStatisticsLogic::GetNthMin(int n)const
+{
+  if (n < 0 || n >= this->GetNumberOfLabels())
+    {
+    return 0.;
+    }
+  return this->Statistics[n].Min;
+}
+
+//----------------------------------------------------------------------------
+double vtkLabelStatisticsLogic::GetNthMax(int n)const
+{
+  if (n < 0 || n >= this->GetNumberOfLabels())
+    {
+    return 0.;
+    }
+  return this->Statistics[n].Max;
+}
+
+//----------------------------------------------------------------------------
+double vtkLabelStatisticsLogic::GetNthMean(int n)const
+{
+  if (n < 0 || n >= this->GetNumberOfLabels())
+    {
+    return 0.;
+    }
+  return this->Statistics[n].Mean;
+}
+
+//----------------------------------------------------------------------------
+double vtkLabelStatisticsLogic::GetNthStandardDeviation(int n)const
+{
+  if (n < 0 || n >= this->GetNumberOfLabels() ||
+      this->Statistics[n].Count < 2)
+    {
+    return 0.;
+    }
+  const LabelStatistics& statistics = this->Statistics[n];
+  // same (unbiased) estimate as vtkImageAccumulate
+  return sqrt(statistics.SumOfSquaredDeviations / (statistics.Count - 1));
+}
+
+//----------------------------------------------------------------------------
+int vtkLabelStatisticsLogic::GetLabelIndex(vtkIdType label)const
+{
+  int first = 0;
+  int last = this->GetNumberOfLabels();
+  while (first < last)
+    {
+    const int middle = (first + last) / 2;
+    if (this->Statistics[middle].Label < label)
+      {
+      first = middle + 1;
+      }
+    else
+      {
+      last = middle;
+      }
+    }
+  return (first < this->GetNumberOfLabels() &&
+          this->Statistics[first].Label == label) ? first : -1;
+}
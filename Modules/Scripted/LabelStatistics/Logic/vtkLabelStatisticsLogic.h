@@ -0,0 +1,124 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+///  vtkLabelStatisticsLogic - Statistics of a grayscale image for each label
+///
+/// Computes the voxel count, min, max, mean and standard deviation of the
+/// grayscale values under each label of the label image in a single
+/// multi-threaded pass over the two images, instead of one thresholding and
+/// one vtkImageAccumulate pass per label value.
+/// The standard deviation is the sample standard deviation, like
+/// vtkImageAccumulate. The two images must have the same dimensions, only
+/// the first component of the grayscale image is used.
+/// The labels without voxel are not reported.
+
+#ifndef __vtkLabelStatisticsLogic_h
+#define __vtkLabelStatisticsLogic_h
+
+#include "vtkSlicerLabelStatisticsModuleLogicExport.h"
+
+// VTK includes
+#include <vtkMultiThreader.h>
+#include <vtkObject.h>
+
+// STD includes
+#include <map>
+#include <vector>
+
+class vtkImageData;
+
+class VTK_SLICER_LABELSTATISTICS_MODULE_LOGIC_EXPORT vtkLabelStatisticsLogic
+  : public vtkObject
+{
+public:
+  static vtkLabelStatisticsLogic *New();
+  vtkTypeMacro(vtkLabelStatisticsLogic, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  ///
+  /// Image whose values are measured.
+  void SetGrayscaleImageData(vtkImageData* imageData);
+  vtkGetObjectMacro(GrayscaleImageData, vtkImageData);
+
+  ///
+  /// Image of the labels, any scalar type (values are truncated to integers).
+  void SetLabelImageData(vtkImageData* imageData);
+  vtkGetObjectMacro(LabelImageData, vtkImageData);
+
+  ///
+  /// Number of threads to use, vtkMultiThreader's default by default.
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_MAX_THREADS);
+  vtkGetMacro(NumberOfThreads, int);
+
+  ///
+  /// Compute the statistics of all the labels.
+  /// Return false if the images are missing or don't match.
+  bool ComputeStatistics();
+
+  ///
+  /// Results of the last ComputeStatistics(), sorted by label value.
+  int GetNumberOfLabels()const;
+  vtkIdType GetNthLabel(int n)const;
+  vtkIdType GetNthCount(int n)const;
+  double GetNthMin(int n)const;
+  double GetNthMax(int n)const;
+  double GetNthMean(int n)const;
+  double GetNthStandardDeviation(int n)const;
+
+  ///
+  /// Index of the label in the results, -1 if the label has no voxel.
+  int GetLabelIndex(vtkIdType label)const;
+
+  //BTX
+  /// Running statistics of the grayscale values of a label, updated with
+  /// Welford's algorithm.
+  struct LabelStatistics
+  {
+    LabelStatistics();
+    void Add(double value);
+    void Add(const LabelStatistics& statistics);
+
+    vtkIdType Label;
+    vtkIdType Count;
+    double Min;
+    double Max;
+    double Mean;
+    /// Sum of the squared differences to the mean
+    double SumOfSquaredDeviations;
+  };
+  typedef std::map<vtkIdType, LabelStatistics> LabelStatisticsMap;
+  //ETX
+
+protected:
+  vtkLabelStatisticsLogic();
+  ~vtkLabelStatisticsLogic();
+
+  /// Called by the threads of ComputeStatistics()
+  void ComputeThreadStatistics(int threadId, int numberOfThreads);
+
+  vtkImageData* GrayscaleImageData;
+  vtkImageData* LabelImageData;
+  int NumberOfThreads;
+  vtkMultiThreader* MultiThreader;
+
+  //BTX
+  /// Statistics computed by each thread, merged in Statistics.
+  std::vector<LabelStatisticsMap> ThreadStatistics;
+  std::vector<LabelStatistics> Statistics;
+  //ETX
+
+private:
+  vtkLabelStatisticsLogic(const vtkLabelStatisticsLogic&); /// Not implemented.
+  void operator=(const vtkLabelStatisticsLogic&); /// Not implemented.
+
+  static VTK_THREAD_RETURN_TYPE ThreadedExecute(void* arg);
+};
+
+#endif